@@ -19,9 +19,18 @@
         __declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
     }
     #endif /* SLIC3R_GUI */
+    #ifdef SLIC3R_TBBMALLOC_PROXY
+        // On Windows the malloc replacement is only activated by referencing the proxy from the binary.
+        #include <tbb/tbbmalloc_proxy.h>
+    #endif /* SLIC3R_TBBMALLOC_PROXY */
 #endif /* WIN32 */
 
+#include <chrono>
 #include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <cstring>
 #include <iostream>
@@ -30,9 +39,12 @@
 #include <boost/filesystem.hpp>
 #include <boost/nowide/args.hpp>
 #include <boost/nowide/cenv.hpp>
+#include <boost/nowide/fstream.hpp>
 #include <boost/nowide/iostream.hpp>
 #include <boost/nowide/integration/filesystem.hpp>
 #include <boost/dll/runtime_symbol_info.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
 
 #include "unix/fhs.hpp"  // Generated by CMake from ../platform/unix/fhs.hpp.in
 
@@ -43,11 +55,15 @@
 #include "libslic3r/Config.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/GCode/PostProcessor.hpp"
+#include "libslic3r/GCode/ThumbnailRenderer.hpp"
 #include "libslic3r/Model.hpp"
 #include "libslic3r/CutUtils.hpp"
 #include "libslic3r/ModelArrange.hpp"
 #include "libslic3r/Platform.hpp"
 #include "libslic3r/Print.hpp"
+#include "libslic3r/PrintObjectCache.hpp"
+#include "libslic3r/Profiler.hpp"
+#include "libslic3r/Support/SupportCache.hpp"
 #include "libslic3r/SLAPrint.hpp"
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/Format/AMF.hpp"
@@ -73,6 +89,59 @@ static PrinterTechnology get_printer_technology(const DynamicConfig &config)
     return (opt == nullptr) ? ptUnknown : opt->value;
 }
 
+// Writes the slicing progress for --progress-json, one JSON object per line. Called from the worker threads.
+class ProgressJson
+{
+public:
+    explicit ProgressJson(std::ostream &os) : m_os(os), m_start(std::chrono::steady_clock::now()) {}
+
+    void status(const PrintBase::SlicingStatus &s) {
+        if (s.percent >= 0)
+            this->write("\"event\":\"status\",\"percent\":" + std::to_string(s.percent) + ",\"text\":" + quoted(s.text));
+    }
+    void step(const char *step, const PrintObjectBase *print_object, double duration, const Profiler::StepMemory &memory) {
+        std::ostringstream ss;
+        ss << "\"event\":\"step\",\"step\":" << quoted(step) << ",\"object\":"
+           << (print_object ? quoted(print_object->model_object()->name) : std::string("null"))
+           << ",\"duration\":" << std::fixed << std::setprecision(3) << duration;
+        if (Profiler::allocations_counted())
+            ss << ",\"allocations\":" << memory.allocations << ",\"allocated_bytes\":" << memory.allocated_bytes;
+        ss << ",\"peak_rss_increase\":" << memory.peak_rss_increase;
+        this->write(ss.str());
+    }
+
+private:
+    // Appends the time elapsed since the start and the peak memory to the fields of every record.
+    void write(const std::string &fields) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        std::ostringstream ss;
+        ss << "{" << fields << ",\"elapsed\":" << std::fixed << std::setprecision(3) << elapsed << ",\"peak_rss\":" << peak_memory_usage() << "}\n";
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_os << ss.str();
+        m_os.flush();
+    }
+
+    static std::string quoted(const std::string &str) {
+        std::string out = "\"";
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", int(c));
+                out += buf;
+            } else
+                out += c;
+        }
+        return out + "\"";
+    }
+
+    std::ostream                          &m_os;
+    std::mutex                             m_mutex;
+    std::chrono::steady_clock::time_point  m_start;
+};
+
 int CLI::run(int argc, char **argv)
 {
     // Mark the main thread for the debugger and for runtime checks.
@@ -110,10 +179,25 @@ int CLI::run(int argc, char **argv)
 	if (! this->setup(argc, argv))
 		return 1;
 
+    // Limit of the worker threads of the whole process, including all the jobs of the service.
+    if (const ConfigOptionInt *opt_threads = m_config.opt<ConfigOptionInt>("threads"); opt_threads != nullptr && opt_threads->value > 0)
+        set_max_threads(size_t(opt_threads->value));
+
+    if (m_config.opt_bool("serve"))
+        return this->serve();
+
+    return this->process(argc, argv);
+}
+
+int CLI::process(int argc, char **argv)
+{
     m_extra_config.apply(m_config, true);
     m_extra_config.normalize_fdm();
     
     PrinterTechnology printer_technology = get_printer_technology(m_config);
+    if (printer_technology == ptUnknown)
+        // Config files preloaded by the service.
+        printer_technology = get_printer_technology(m_print_config);
 
     bool							start_gui			= m_actions.empty() &&
         // cutting transformations are setting an "export" action.
@@ -141,38 +225,8 @@ int CLI::run(int argc, char **argv)
     const ForwardCompatibilitySubstitutionRule   config_substitution_rule = m_config.option<ConfigOptionEnum<ForwardCompatibilitySubstitutionRule>>("config_compatibility", true)->value;
 
     // load config files supplied via --load
-    for (auto const &file : load_configs) {
-        if (! boost::filesystem::exists(file)) {
-            if (m_config.opt_bool("ignore_nonexistent_config")) {
-                continue;
-            } else {
-                boost::nowide::cerr << "No such file: " << file << std::endl;
-                return 1;
-            }
-        }
-        DynamicPrintConfig  config;
-        ConfigSubstitutions config_substitutions;
-        try {
-            config_substitutions = config.load(file, config_substitution_rule);
-        } catch (std::exception &ex) {
-            boost::nowide::cerr << "Error while reading config file \"" << file << "\": " << ex.what() << std::endl;
-            return 1;
-        }
-        if (! config_substitutions.empty()) {
-            boost::nowide::cout << "The following configuration values were substituted when loading \" << file << \":\n";
-            for (const ConfigSubstitution &subst : config_substitutions)
-                boost::nowide::cout << "\tkey = \"" << subst.opt_def->opt_key << "\"\t loaded = \"" << subst.old_value << "\tsubstituted = \"" << subst.new_value->serialize() << "\"\n";
-        }
-        config.normalize_fdm();
-        PrinterTechnology other_printer_technology = get_printer_technology(config);
-        if (printer_technology == ptUnknown) {
-            printer_technology = other_printer_technology;
-        } else if (printer_technology != other_printer_technology && other_printer_technology != ptUnknown) {
-            boost::nowide::cerr << "Mixing configurations for FFF and SLA technologies" << std::endl;
-            return 1;
-        }
-        m_print_config.apply(config);
-    }
+    if (! this->load_print_configs(printer_technology))
+        return 1;
 
 #if ENABLE_GL_CORE_PROFILE
     // search for special keys into command line parameters
@@ -238,7 +292,7 @@ int CLI::run(int argc, char **argv)
             }
             if (!boost::filesystem::exists(file)) {
                 boost::nowide::cerr << "No such file: " << file << std::endl;
-                exit(1);
+                return 1;
             }
             Model model;
             try {
@@ -279,6 +333,11 @@ int CLI::run(int argc, char **argv)
     if (!start_gui) {
         const auto* post_process = m_print_config.opt<ConfigOptionStrings>("post_process");
         if (post_process != nullptr && !post_process->values.empty()) {
+            if (m_service_job) {
+                // There is nobody to confirm the scripts, the standard input is reserved for the jobs.
+                boost::nowide::cerr << "error: post-processing scripts are not allowed in the service mode" << std::endl;
+                return 1;
+            }
             boost::nowide::cout << "\nA post-processing script has been detected in the config data:\n\n";
             for (const auto& s : post_process->values) {
                 boost::nowide::cout << "> " << s << "\n";
@@ -527,6 +586,32 @@ int CLI::run(int argc, char **argv)
             for (auto &o : model.objects)
                 o->ensure_on_bed();
 
+    const std::string profile_report = m_config.opt_string("profile_report");
+    const std::string profile_trace  = m_config.opt_string("profile_trace");
+    Profiler::set_enabled(! profile_report.empty() || ! profile_trace.empty());
+    // Don't report the data of the previous service jobs.
+    Profiler::clear();
+    const std::string progress_json = m_config.opt_string("progress_json");
+    boost::nowide::ofstream       progress_file;
+    std::unique_ptr<ProgressJson> progress;
+    if (progress_json == "-")
+        progress = std::make_unique<ProgressJson>(boost::nowide::cout);
+    else if (! progress_json.empty()) {
+        progress_file.open(progress_json);
+        if (! progress_file) {
+            boost::nowide::cerr << "error: failed to open the progress output " << progress_json << std::endl;
+            return 1;
+        }
+        progress = std::make_unique<ProgressJson>(progress_file);
+    }
+    const std::string cache_dir         = m_config.opt_string("cache_dir");
+    const std::string support_cache_dir = m_config.opt_string("support_cache_dir");
+    // The directories are global, they are only set when changed, as the service jobs may run concurrently.
+    if (PrintObjectCache::directory() != cache_dir)
+        PrintObjectCache::set_directory(cache_dir);
+    if (const std::string &dir = support_cache_dir.empty() ? cache_dir : support_cache_dir; FFFSupport::SupportCache::directory() != dir)
+        FFFSupport::SupportCache::set_directory(dir);
+
     // loop through action options
     for (auto const &opt_key : m_actions) {
         if (opt_key == "help") {
@@ -588,10 +673,18 @@ int CLI::run(int argc, char **argv)
                             [](const PrintBase::SlicingStatus& s)
                 {
                     if(s.percent >= 0) // FIXME: is this sufficient?
-                        printf("%3d%s %s\n", s.percent, "% =>", s.text.c_str());
+                        boost::nowide::cout << std::setw(3) << s.percent << "% => " << s.text << std::endl;
                 });
 
                 PrintBase  *print = (printer_technology == ptFFF) ? static_cast<PrintBase*>(&fff_print) : static_cast<PrintBase*>(&sla_print);
+                if (progress) {
+                    print->set_status_callback([&progress](const PrintBase::SlicingStatus &s) { progress->status(s); });
+                    print->set_step_callback([&progress](const char *step, const PrintObjectBase *print_object, double duration, const Profiler::StepMemory &memory) {
+                        progress->step(step, print_object, duration, memory);
+                    });
+                }
+                fff_print.set_release_intermediate_data(m_config.opt_bool("release_intermediate_data"));
+                fff_print.set_memory_budget(size_t(std::max(0, m_config.opt_int("memory_budget"))) << 20);
                 if (! m_config.opt_bool("dont_arrange")) {
                     if (user_center_specified) {
                         Vec2d c = m_config.option<ConfigOptionPoint>("center")->value;
@@ -617,7 +710,9 @@ int CLI::run(int argc, char **argv)
                         print->process();
                         if (printer_technology == ptFFF) {
                             // The outfile is processed by a PlaceholderParser.
-                            outfile = fff_print.export_gcode(outfile, nullptr, nullptr);
+                            outfile = fff_print.export_gcode(outfile, nullptr, [&fff_print](const ThumbnailsParams &params) {
+                                return GCodeThumbnails::render_thumbnails(fff_print.model(), fff_print.full_print_config(), params);
+                            });
                             outfile_final = fff_print.print_statistics().finalize_output_path(outfile);
                         } else {
                             outfile = sla_print.output_filepath(outfile);
@@ -677,6 +772,20 @@ int CLI::run(int argc, char **argv)
     }
 
 
+    if (! profile_report.empty() && ! Profiler::write_json(profile_report)) {
+        boost::nowide::cerr << "error: failed to write the profiling report to " << profile_report << std::endl;
+        return 1;
+    }
+    if (! profile_trace.empty() && ! Profiler::write_chrome_trace(profile_trace)) {
+        boost::nowide::cerr << "error: failed to write the profiling trace to " << profile_trace << std::endl;
+        return 1;
+    }
+
+    if (start_gui && m_service_job) {
+        boost::nowide::cerr << "error: the GUI cannot be started by a service job" << std::endl;
+        return 1;
+    }
+
     if (start_gui) {
 #ifdef SLIC3R_GUI
     #if !defined(_WIN32) && !defined(__APPLE__)
@@ -784,6 +893,11 @@ bool CLI::setup(int argc, char **argv)
     set_sys_shapes_dir((path_resources / "shapes").string());
     set_custom_gcodes_dir((path_resources / "custom_gcodes").string());
 
+    return this->parse_cli(argc, argv);
+}
+
+bool CLI::parse_cli(int argc, char **argv)
+{
     // Parse all command line options into a DynamicConfig.
     // If any option is unsupported, print usage and abort immediately.
     t_config_option_keys opt_order;
@@ -826,6 +940,158 @@ bool CLI::setup(int argc, char **argv)
     return true;
 }
 
+bool CLI::load_print_configs(PrinterTechnology &printer_technology)
+{
+    const std::vector<std::string>              &load_configs             = m_config.option<ConfigOptionStrings>("load", true)->values;
+    const ForwardCompatibilitySubstitutionRule   config_substitution_rule = m_config.option<ConfigOptionEnum<ForwardCompatibilitySubstitutionRule>>("config_compatibility", true)->value;
+
+    for (auto const &file : load_configs) {
+        if (! boost::filesystem::exists(file)) {
+            if (m_config.opt_bool("ignore_nonexistent_config")) {
+                continue;
+            } else {
+                boost::nowide::cerr << "No such file: " << file << std::endl;
+                return false;
+            }
+        }
+        DynamicPrintConfig  config;
+        ConfigSubstitutions config_substitutions;
+        try {
+            config_substitutions = config.load(file, config_substitution_rule);
+        } catch (std::exception &ex) {
+            boost::nowide::cerr << "Error while reading config file \"" << file << "\": " << ex.what() << std::endl;
+            return false;
+        }
+        if (! config_substitutions.empty()) {
+            boost::nowide::cout << "The following configuration values were substituted when loading \" << file << \":\n";
+            for (const ConfigSubstitution &subst : config_substitutions)
+                boost::nowide::cout << "\tkey = \"" << subst.opt_def->opt_key << "\"\t loaded = \"" << subst.old_value << "\tsubstituted = \"" << subst.new_value->serialize() << "\"\n";
+        }
+        config.normalize_fdm();
+        PrinterTechnology other_printer_technology = get_printer_technology(config);
+        if (printer_technology == ptUnknown) {
+            printer_technology = other_printer_technology;
+        } else if (printer_technology != other_printer_technology && other_printer_technology != ptUnknown) {
+            boost::nowide::cerr << "Mixing configurations for FFF and SLA technologies" << std::endl;
+            return false;
+        }
+        m_print_config.apply(config);
+    }
+    return true;
+}
+
+int CLI::serve()
+{
+    namespace pt = boost::property_tree;
+
+    // The config files supplied to the service are loaded just once, they are the base config of all the jobs.
+    m_extra_config.apply(m_config, true);
+    m_extra_config.normalize_fdm();
+    PrinterTechnology printer_technology = get_printer_technology(m_config);
+    if (! this->load_print_configs(printer_technology))
+        return 1;
+    m_print_config.apply(m_extra_config, true);
+    if (printer_technology != ptUnknown)
+        m_print_config.option<ConfigOptionEnum<PrinterTechnology>>("printer_technology", true)->value = printer_technology;
+
+    // The jobs are processed concurrently, each one limited to its share of the CPU cores.
+    // All the TBB worker threads are set up before they are split among the jobs.
+    name_tbb_thread_pool_threads_set_locale();
+    const size_t   max_jobs = size_t(std::max(1, m_config.opt_int("jobs")));
+    int            max_concurrency = tbb::this_task_arena::max_concurrency();
+    if (const ConfigOptionInt *opt_threads = m_config.opt<ConfigOptionInt>("threads"); opt_threads != nullptr && opt_threads->value > 0)
+        max_concurrency = std::min(max_concurrency, opt_threads->value);
+    ConcurrentJobs jobs(max_jobs, max_concurrency);
+
+    // The standard output is reserved for the responses, the console output of the jobs goes to the standard error.
+    std::streambuf *cout_buf = boost::nowide::cout.rdbuf(boost::nowide::cerr.rdbuf());
+    std::ostream    responses(cout_buf);
+    std::mutex      responses_mutex;
+    auto respond = [&responses, &responses_mutex](const std::string &id, int result) {
+        pt::ptree response;
+        response.put("id", id);
+        response.put("result", result);
+        std::lock_guard<std::mutex> lock(responses_mutex);
+        pt::write_json(responses, response, false);
+        responses.flush();
+    };
+
+    std::string line;
+    while (std::getline(boost::nowide::cin, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        std::string              id;
+        std::vector<std::string> args { "prusa-slicer" };
+        std::shared_ptr<CLI>     job;
+        try {
+            pt::ptree          request;
+            std::istringstream is(line);
+            pt::read_json(is, request);
+            id = request.get<std::string>("id", "");
+            for (const pt::ptree::value_type &arg : request.get_child("args"))
+                args.emplace_back(arg.second.data());
+            job = this->create_job(args, max_jobs > 1);
+        } catch (const std::exception &ex) {
+            boost::nowide::cerr << "error: " << ex.what() << std::endl;
+        }
+        if (! job) {
+            respond(id, 1);
+            continue;
+        }
+
+        jobs.run([job, id, args = std::move(args), &respond]() {
+            int result = 1;
+            try {
+                std::vector<char*> argv;
+                for (const std::string &arg : args)
+                    argv.emplace_back(const_cast<char*>(arg.c_str()));
+                result = job->process(int(argv.size()), argv.data());
+            } catch (const std::exception &ex) {
+                boost::nowide::cerr << "error: " << ex.what() << std::endl;
+            }
+            boost::nowide::cerr.flush();
+            respond(id, result);
+        });
+    }
+
+    jobs.wait();
+    boost::nowide::cout.rdbuf(cout_buf);
+    return 0;
+}
+
+std::unique_ptr<CLI> CLI::create_job(const std::vector<std::string> &args, bool concurrent) const
+{
+    auto job = std::make_unique<CLI>();
+    job->m_service_job  = true;
+    job->m_print_config = m_print_config;
+    // The options of the service are the defaults of the jobs.
+    for (const char *opt_key : { "cache_dir", "support_cache_dir", "datadir" })
+        job->m_config.set_key_value(opt_key, m_config.option(opt_key)->clone());
+
+    std::vector<char*> argv;
+    for (const std::string &arg : args)
+        argv.emplace_back(const_cast<char*>(arg.c_str()));
+    if (! job->parse_cli(int(argv.size()), argv.data()))
+        return nullptr;
+
+    if (concurrent) {
+        // The profiler and the cache directories are global, the concurrent jobs have to share them.
+        for (const char *opt_key : { "cache_dir", "support_cache_dir" })
+            if (job->m_config.opt_string(opt_key) != m_config.opt_string(opt_key)) {
+                boost::nowide::cerr << "error: " << opt_key << " of a job has to match the service when the jobs run concurrently" << std::endl;
+                return nullptr;
+            }
+        for (const char *opt_key : { "profile_report", "profile_trace" })
+            if (! job->m_config.opt_string(opt_key).empty()) {
+                boost::nowide::cerr << "error: " << opt_key << " is not supported when the jobs run concurrently" << std::endl;
+                return nullptr;
+            }
+    }
+
+    return job;
+}
+
 void CLI::print_help(bool include_print_options, PrinterTechnology printer_technology) const
 {
     boost::nowide::cout
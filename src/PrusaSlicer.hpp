@@ -4,6 +4,8 @@
 #include "libslic3r/Config.hpp"
 #include "libslic3r/Model.hpp"
 
+#include <memory>
+
 namespace Slic3r {
 
 namespace IO {
@@ -29,8 +31,22 @@ private:
     std::vector<std::string>    m_actions;
     std::vector<std::string>    m_transforms;
     std::vector<Model>          m_models;
+    // Job of a CLI started with --serve: no GUI and no interaction on the standard input.
+    bool                        m_service_job { false };
 
     bool setup(int argc, char **argv);
+    /// Parses the command line options, the actions and the transformations.
+    bool parse_cli(int argc, char **argv);
+    /// Executes the actions on the models after the setup.
+    int  process(int argc, char **argv);
+    /// Loads the config files supplied via --load into m_print_config.
+    bool load_print_configs(PrinterTechnology &printer_technology);
+
+    /// Processes the jobs read from the standard input, one JSON object per line, until the input is closed.
+    int  serve();
+    /// Creates a job of the service from its command line, the service config files are shared.
+    /// Returns nullptr if the command line is not valid.
+    std::unique_ptr<CLI> create_job(const std::vector<std::string> &args, bool concurrent) const;
     
     /// Prints usage of the CLI.
     void print_help(bool include_print_options = false, PrinterTechnology printer_technology = ptAny) const;
@@ -768,16 +768,52 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   if ((Closed && highI < 2) || (!Closed && highI < 1))
     return false;
 
-  // Allocate a new edge array.
-  Edges edges(highI + 1);
+  // Allocate a new edge array, possibly reusing an edge array retained by Clear().
+  Edges edges = AllocateEdges(highI + 1);
   // Fill in the edge array.
   bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
   if (result)
     // Success, remember the edge array.
     m_edges.emplace_back(std::move(edges));
+  else
+    ReleaseEdges(std::move(edges));
   return result;
 }
 
+ClipperBase::Edges ClipperBase::AllocateEdges(size_t num_edges)
+{
+  Edges edges;
+  if (! m_edgesFree.empty()) {
+    // Take the smallest retained edge array large enough, or the largest one.
+    auto it = std::lower_bound(m_edgesFree.begin(), m_edgesFree.end(), num_edges,
+      [](const Edges &e, size_t capacity) { return e.capacity() < capacity; });
+    if (it == m_edgesFree.end())
+      -- it;
+    edges = std::move(*it);
+    m_edgesFree.erase(it);
+  }
+  // Value initialize the edges, the same as a newly allocated edge array.
+  edges.resize(num_edges);
+  return edges;
+}
+
+void ClipperBase::ReleaseEdges(Edges &&edges)
+{
+  if (edges.capacity() == 0)
+    return;
+  edges.clear();
+  // Keep m_edgesFree sorted by capacity, so that the largest arrays are reused first.
+  auto it = std::lower_bound(m_edgesFree.begin(), m_edgesFree.end(), edges.capacity(),
+    [](const Edges &e, size_t capacity) { return e.capacity() < capacity; });
+  if (m_edgesFree.size() < m_edgesFreeMax)
+    m_edgesFree.insert(it, std::move(edges));
+  else if (it != m_edgesFree.begin()) {
+    // Replace the smallest retained array.
+    std::move(m_edgesFree.begin() + 1, it, m_edgesFree.begin());
+    *(it - 1) = std::move(edges);
+  }
+}
+
 bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
 {
 #ifdef use_lines
@@ -963,6 +999,8 @@ bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, b
 void ClipperBase::Clear()
 {
   m_MinimaList.clear();
+  for (Edges &edges : m_edges)
+    ReleaseEdges(std::move(edges));
   m_edges.clear();
 #ifndef CLIPPERLIB_INT32
   m_UseFullRange = false;
@@ -1046,6 +1084,7 @@ IntRect ClipperBase::GetBounds()
 Clipper::Clipper(int initOptions) : 
   ClipperBase(),
   m_OutPtsFree(nullptr),
+  m_OutPtsChunks(0),
   m_OutPtsChunkLast(m_OutPtsChunkSize),
   m_ActiveEdges(nullptr),
   m_SortedEdges(nullptr)
@@ -1063,7 +1102,7 @@ Clipper::Clipper(int initOptions) :
 void Clipper::Reset()
 {
   ClipperBase::Reset();
-  m_Scanbeam = std::priority_queue<cInt, cInts>{};
+  m_Scanbeam.clear();
   m_Maxima.clear();
   m_ActiveEdges = 0;
   m_SortedEdges = 0;
@@ -1178,19 +1217,21 @@ OutPt* Clipper::AllocateOutPt()
     m_OutPtsFree = pt->Next;
   } else if (m_OutPtsChunkLast < m_OutPtsChunkSize) {
     // Get a point from the last chunk.
-    pt = &m_OutPts.back()[m_OutPtsChunkLast ++];
+    pt = &m_OutPts[m_OutPtsChunks - 1][m_OutPtsChunkLast ++];
   } else {
-    // The last chunk is full. Allocate a new one.
-    m_OutPts.emplace_back();
+    // The last chunk is full. Reuse a chunk retained from the previous Execute() or allocate a new one.
+    if (m_OutPtsChunks == m_OutPts.size())
+      m_OutPts.emplace_back();
     m_OutPtsChunkLast = 1;
-    pt = &m_OutPts.back().front();
+    pt = &m_OutPts[m_OutPtsChunks ++].front();
   }
   return pt;
 }
 
 void Clipper::DisposeAllOutRecs()
 {
-  m_OutPts.clear();
+  // Keep the chunks of output points allocated.
+  m_OutPtsChunks = 0;
   m_OutPtsFree = nullptr;
   m_OutPtsChunkLast = m_OutPtsChunkSize;
   m_PolyOuts.clear();
@@ -3322,8 +3363,10 @@ DoublePoint GetUnitNormal(const IntPoint &pt1, const IntPoint &pt2)
 
 void ClipperOffset::Clear()
 {
-  for (int i = 0; i < m_polyNodes.ChildCount(); ++i)
-    delete m_polyNodes.Childs[i];
+  for (int i = 0; i < m_polyNodes.ChildCount(); ++i) {
+    m_polyNodes.Childs[i]->Contour.clear();
+    m_freeNodes.emplace_back(m_polyNodes.Childs[i]);
+  }
   m_polyNodes.Childs.clear();
   m_lowest.x() = -1;
 }
@@ -3333,7 +3376,13 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
 {
   int highI = (int)path.size() - 1;
   if (highI < 0) return;
-  PolyNode* newNode = new PolyNode();
+  PolyNode* newNode;
+  if (m_freeNodes.empty())
+    newNode = new PolyNode();
+  else {
+    newNode = m_freeNodes.back();
+    m_freeNodes.pop_back();
+  }
   newNode->m_jointype = joinType;
   newNode->m_endtype = endType;
 
@@ -3373,7 +3422,8 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
   }
   if (endType == etClosedPolygon && j < 2)
   {
-    delete newNode;
+    newNode->Contour.clear();
+    m_freeNodes.emplace_back(newNode);
     return;
   }
   m_polyNodes.AddChild(*newNode);
@@ -3426,7 +3476,9 @@ void ClipperOffset::Execute(Paths& solution, double delta)
   DoOffset(delta);
   
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -3457,7 +3509,9 @@ void ClipperOffset::Execute(PolyTree& solution, double delta)
   DoOffset(delta);
 
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -3522,7 +3576,12 @@ void ClipperOffset::DoOffset(double delta)
   for (int i = 0; i < m_polyNodes.ChildCount(); i++)
   {
     PolyNode& node = *m_polyNodes.Childs[i];
-    m_srcPoly = node.Contour;
+    // Borrow the contour instead of copying it, it is returned to the node at the end of this iteration.
+    struct ContourGuard {
+      Path &src, &dst;
+      ~ContourGuard() { src.swap(dst); }
+    } contour_guard { m_srcPoly, node.Contour };
+    m_srcPoly.swap(node.Contour);
 
     int len = (int)m_srcPoly.size();
     if (len == 0 || (delta <= 0 && (len < 3 || node.m_endtype != etClosedPolygon)))
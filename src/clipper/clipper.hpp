@@ -359,8 +359,8 @@ public:
     if (num_edges_total == 0)
       return false;
 
-    // Allocate a new edge array.
-    std::vector<TEdge, Allocator<TEdge>> edges(num_edges_total);
+    // Allocate a new edge array, possibly reusing an edge array retained by Clear().
+    Edges edges = AllocateEdges(num_edges_total);
     // Fill in the edge array.
     bool result = false;
     TEdge *p_edge = edges.data();
@@ -378,9 +378,13 @@ public:
     if (result)
       // At least some edges were generated. Remember the edge array.
       m_edges.emplace_back(std::move(edges));
+    else
+      ReleaseEdges(std::move(edges));
     return result;
   }
 
+  // Remove all paths. The memory allocated for the edges is retained to be reused by the following AddPath() / AddPaths() calls,
+  // so that a single Clipper instance may be reused for many boolean operations without reallocating its buffers.
   void Clear();
   IntRect GetBounds();
   // By default, when three or more vertices are collinear in input polygons (subject or clip), the Clipper object removes the 'inner' vertices before clipping.
@@ -409,6 +413,12 @@ protected:
   // A vector of edges per each input path.
   using Edges = std::vector<TEdge, Allocator<TEdge>>;
   std::vector<Edges, Allocator<Edges>> m_edges;
+  // Edge arrays released by Clear(), cleared but keeping their capacity.
+  std::vector<Edges, Allocator<Edges>> m_edgesFree;
+  // Maximum number of edge arrays kept in m_edgesFree.
+  static constexpr const size_t m_edgesFreeMax = 16;
+  Edges AllocateEdges(size_t num_edges);
+  void  ReleaseEdges(Edges &&edges);
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -454,10 +464,13 @@ private:
   // Output polygons.
   std::deque<OutRec, Allocator<OutRec>>  m_PolyOuts;
   // Output points, allocated by a continuous sets of m_OutPtsChunkSize.
+  // The chunks are retained by DisposeAllOutRecs() to be reused by the next Execute().
   static constexpr const size_t m_OutPtsChunkSize = 32;
   std::deque<std::array<OutPt, m_OutPtsChunkSize>, Allocator<std::array<OutPt, m_OutPtsChunkSize>>> m_OutPts;
   // List of free output points, to be used before taking a point from m_OutPts or allocating a new chunk.
   OutPt                *m_OutPtsFree;
+  // Number of chunks of m_OutPts in use, the last one of them filled up to m_OutPtsChunkLast.
+  size_t                m_OutPtsChunks;
   size_t                m_OutPtsChunkLast;
 
   std::vector<Join, Allocator<Join>>     m_Joins;
@@ -466,7 +479,11 @@ private:
   ClipType              m_ClipType;
   // A priority queue (a binary heap) of Y coordinates.
   using cInts = std::vector<cInt, Allocator<cInt>>;
-  std::priority_queue<cInt, cInts> m_Scanbeam;
+  struct Scanbeam : public std::priority_queue<cInt, cInts> {
+    // Clear the heap while retaining its memory.
+    void clear() { this->c.clear(); }
+  };
+  Scanbeam              m_Scanbeam;
   // Maxima are collected by ProcessEdgesAtTopOfScanbeam(), consumed by ProcessHorizontal().
   cInts                 m_Maxima;
   TEdge                *m_ActiveEdges;
@@ -541,7 +558,7 @@ class ClipperOffset
 public:
   ClipperOffset(double miterLimit = 2.0, double roundPrecision = 0.25, double shortestEdgeLength = 0.) :
     MiterLimit(miterLimit), ArcTolerance(roundPrecision), ShortestEdgeLength(shortestEdgeLength), m_lowest(-1, 0) {}
-  ~ClipperOffset() { Clear(); }
+  ~ClipperOffset() { Clear(); for (PolyNode *node : m_freeNodes) delete node; }
   void AddPath(const Path& path, JoinType joinType, EndType endType);
   template<typename PathsProvider>
   void AddPaths(PathsProvider &&paths, JoinType joinType, EndType endType) {
@@ -550,6 +567,8 @@ public:
   }
   void Execute(Paths& solution, double delta);
   void Execute(PolyTree& solution, double delta);
+  // Remove all paths. Memory of the internal Clipper used to clean up the offset contours
+  // and of the path nodes is retained.
   void Clear();
   double MiterLimit;
   double ArcTolerance;
@@ -566,6 +585,10 @@ private:
   // y: index of the lowest point in the lowest contour
   IntPoint m_lowest;
   PolyNode m_polyNodes;
+  // Nodes released by Clear(), reused by AddPath() together with their contour buffers.
+  PolyNodes m_freeNodes;
+  // Clipper to clean up the offset contours, reused by subsequent Execute() calls.
+  Clipper  m_clipper;
 
   void FixOrientations();
   void DoOffset(double delta);
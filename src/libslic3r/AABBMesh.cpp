@@ -53,6 +53,15 @@ public:
                                                  m_tree, s, dir, hits, m_triangle_ray_epsilon);
     }
 
+    void intersect_rays(const indexed_triangle_set &its,
+                        const std::vector<Vec3d> &  sources,
+                        const std::vector<Vec3d> &  dirs,
+                        std::vector<igl::Hit> &     hits)
+    {
+        AABBTreeIndirect::intersect_rays_first_hit(its.vertices, its.indices,
+                                                   m_tree, sources, dirs, hits, m_triangle_ray_epsilon);
+    }
+
     double squared_distance(const indexed_triangle_set & its,
                             const Vec3d &                point,
                             int &                        i,
@@ -181,6 +190,40 @@ AABBMesh::query_ray_hit(const Vec3d &s, const Vec3d &dir) const
     return ret;
 }
 
+std::vector<AABBMesh::hit_result>
+AABBMesh::query_ray_hit(const std::vector<Vec3d> &sources, const std::vector<Vec3d> &dirs) const
+{
+    assert(sources.size() == dirs.size() || sources.size() == 1);
+    std::vector<AABBMesh::hit_result> outs;
+    outs.reserve(dirs.size());
+
+#ifdef SLIC3R_HOLE_RAYCASTER
+    if (! m_holes.empty()) {
+        for (size_t i = 0; i < dirs.size(); ++ i)
+            outs.emplace_back(query_ray_hit(sources.size() == 1 ? sources.front() : sources[i], dirs[i]));
+        return outs;
+    }
+#endif
+
+    std::vector<igl::Hit> hits;
+    m_aabb->intersect_rays(*m_tm, sources, dirs, hits);
+    for (size_t i = 0; i < dirs.size(); ++ i) {
+        assert(is_approx(dirs[i].norm(), 1.));
+        const igl::Hit &hit = hits[i];
+        hit_result ret(*this);
+        ret.m_dir = dirs[i];
+        ret.m_source = sources.size() == 1 ? sources.front() : sources[i];
+        if (hit.id != -1) {
+            ret.m_t = double(hit.t);
+            ret.m_normal = this->normal_by_face_id(hit.id);
+            ret.m_face_id = hit.id;
+        }
+        outs.emplace_back(ret);
+    }
+
+    return outs;
+}
+
 std::vector<AABBMesh::hit_result>
 AABBMesh::query_ray_hits(const Vec3d &s, const Vec3d &dir) const
 {
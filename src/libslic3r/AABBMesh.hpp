@@ -120,6 +120,11 @@ public:
 
     // Casting a ray on the mesh, returns the distance where the hit occures.
     hit_result query_ray_hit(const Vec3d &s, const Vec3d &dir) const;
+
+    // Casting multiple rays on the mesh at once, either from a common source (sources.size() == 1)
+    // or one source per ray. The rays are traced in packets, which pays off for coherent rays,
+    // like the rays sampling a cone. Returns the same results as query_ray_hit() for each ray.
+    std::vector<hit_result> query_ray_hit(const std::vector<Vec3d> &sources, const std::vector<Vec3d> &dirs) const;
     
     // Casts a ray on the mesh and returns all hits
     std::vector<hit_result> query_ray_hits(const Vec3d &s, const Vec3d &dir) const;
@@ -11,6 +11,8 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -474,6 +476,113 @@ namespace detail {
 		}
 	}
 
+    // Packet of up to 64 rays with the origins and directions stored as structure of arrays,
+    // so that the slab test of a single AABB node against all rays of the packet vectorizes.
+    template<typename Scalar>
+    struct RayPacket {
+        static constexpr size_t max_size = 64;
+        size_t size { 0 };
+        alignas(32) Scalar origin[3][max_size];
+        alignas(32) Scalar dir[3][max_size];
+        alignas(32) Scalar invdir[3][max_size];
+        // Parameter of the closest hit found so far.
+        alignas(32) Scalar min_t[max_size];
+    };
+
+    // Returns a bit mask of the rays of the packet, which are active (active_mask) and which intersect the box
+    // before their closest hit found so far.
+    template<typename Scalar, typename BoxType>
+    static inline uint64_t ray_packet_box_intersect(const RayPacket<Scalar> &packet, const BoxType &box, uint64_t active_mask)
+    {
+        const Scalar bmin[3] { Scalar(box.min().x()), Scalar(box.min().y()), Scalar(box.min().z()) };
+        const Scalar bmax[3] { Scalar(box.max().x()), Scalar(box.max().y()), Scalar(box.max().z()) };
+        // Branchless slab test over the whole packet.
+        bool hit[RayPacket<Scalar>::max_size];
+        for (size_t i = 0; i < packet.size; ++ i) {
+            Scalar tmin = Scalar(0);
+            Scalar tmax = packet.min_t[i];
+            for (int axis = 0; axis < 3; ++ axis) {
+                Scalar t1 = (bmin[axis] - packet.origin[axis][i]) * packet.invdir[axis][i];
+                Scalar t2 = (bmax[axis] - packet.origin[axis][i]) * packet.invdir[axis][i];
+                tmin = std::max(tmin, std::min(t1, t2));
+                tmax = std::min(tmax, std::max(t1, t2));
+            }
+            hit[i] = tmin <= tmax;
+        }
+        uint64_t mask = 0;
+        for (size_t i = 0; i < packet.size; ++ i)
+            mask |= uint64_t(hit[i]) << i;
+        return mask & active_mask;
+    }
+
+    inline size_t popcount(uint64_t mask) { size_t n = 0; for (; mask != 0; mask &= mask - 1) ++ n; return n; }
+    inline size_t lowest_bit(uint64_t mask) { size_t i = 0; for (; (mask & 1) == 0; mask >>= 1) ++ i; return i; }
+    // Below this number of rays intersecting a node, the rays are traced one by one.
+    static constexpr size_t packet_split_threshold = 8;
+
+    // Traverse the tree once for a whole packet of rays, descending into the nodes intersected by at least one ray.
+    template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+    static inline void intersect_ray_packet_first_hit(
+        const std::vector<VertexType>       &vertices,
+        const std::vector<IndexedFaceType>  &faces,
+        const TreeType                      &tree,
+        RayPacket<typename VectorType::Scalar> &packet,
+        igl::Hit                            *hits,
+        const double                         eps)
+    {
+        const uint64_t all_rays = packet.size == 64 ? ~uint64_t(0) : (uint64_t(1) << packet.size) - 1;
+        // The tree is balanced, thus its depth is logarithmic, and a fixed stack is sufficient.
+        std::pair<size_t, uint64_t> stack[128];
+        size_t stack_size = 0;
+        stack[stack_size ++] = { 0, all_rays };
+        while (stack_size > 0) {
+            auto [node_idx, mask] = stack[-- stack_size];
+            const auto &node = tree.node(node_idx);
+            assert(node.is_valid());
+            // Rays may have found closer hits since the node was pushed.
+            mask = ray_packet_box_intersect(packet, node.bbox, mask);
+            if (mask == 0)
+                continue;
+            if (popcount(mask) <= packet_split_threshold) {
+                // Rays of the packet diverged, the shared slab tests would mostly be wasted. Finish the remaining rays one by one.
+                for (; mask != 0; mask &= mask - 1) {
+                    size_t i = lowest_bit(mask);
+                    const VectorType origin(packet.origin[0][i], packet.origin[1][i], packet.origin[2][i]);
+                    const VectorType dir(packet.dir[0][i], packet.dir[1][i], packet.dir[2][i]);
+                    auto ray_intersector = RayIntersector<VertexType, IndexedFaceType, TreeType, VectorType> {
+                        vertices, faces, tree, origin, dir, VectorType(packet.invdir[0][i], packet.invdir[1][i], packet.invdir[2][i]), eps
+                    };
+                    igl::Hit hit;
+                    if (intersect_ray_recursive_first_hit(ray_intersector, node_idx, packet.min_t[i], hit) && hit.t < packet.min_t[i]) {
+                        packet.min_t[i] = hit.t;
+                        hits[i] = hit;
+                    }
+                }
+                continue;
+            }
+            if (node.is_leaf()) {
+                auto face = faces[node.idx];
+                for (; mask != 0; mask &= mask - 1) {
+                    size_t i = lowest_bit(mask);
+                    const VectorType origin(packet.origin[0][i], packet.origin[1][i], packet.origin[2][i]);
+                    const VectorType dir(packet.dir[0][i], packet.dir[1][i], packet.dir[2][i]);
+                    double t, u, v;
+                    if (intersect_triangle(origin, dir, vertices[face(0)], vertices[face(1)], vertices[face(2)], t, u, v, eps) &&
+                        t > 0. && t < packet.min_t[i]) {
+                        packet.min_t[i] = typename VectorType::Scalar(t);
+                        hits[i] = igl::Hit { int(node.idx), -1, float(u), float(v), float(t) };
+                    }
+                }
+            } else {
+                // Left / right child node index. The left child is processed first, as with intersect_ray_recursive_first_hit().
+                size_t left  = node_idx * 2 + 1;
+                assert(stack_size + 2 <= std::size(stack));
+                stack[stack_size ++] = { left + 1, mask };
+                stack[stack_size ++] = { left, mask };
+            }
+        }
+    }
+
     // Real-time collision detection, Ericson, Chapter 5
     template<typename Vector>
     static inline Vector closest_point_to_triangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
@@ -791,6 +900,69 @@ inline bool intersect_ray_all_hits(
 	return ! hits.empty();
 }
 
+// Find the first intersections of multiple rays with indexed triangle set, for example of rays sampling
+// a hemisphere above a surface point or of rays sampling a cone.
+// The rays are processed in packets: The AABB tree is traversed once per packet and the ray-box tests
+// of all rays of a packet against a node are evaluated together. The more coherent the rays are, the better.
+// hits[i] receives the first intersection of the ray origins[i], dirs[i], hits[i].id is -1 if the ray misses.
+// Returns the number of rays hitting the triangle set.
+// Intersection test is calculated with the accuracy of VectorType::Scalar
+// even if the triangle mesh and the AABB Tree are built with floats.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline size_t intersect_rays_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays, either one per ray or a single common origin.
+	const std::vector<VectorType>		&origins,
+	// Directions of the rays.
+	const std::vector<VectorType>		&dirs,
+	// First intersections of the rays with the indexed triangle set.
+	std::vector<igl::Hit> 				&hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+    using Scalar = typename VectorType::Scalar;
+    assert(origins.size() == dirs.size() || origins.size() == 1);
+    hits.assign(dirs.size(), igl::Hit { -1, -1, 0.f, 0.f, 0.f });
+    if (tree.empty())
+        return 0;
+    detail::RayPacket<Scalar> packet;
+    for (size_t begin = 0; begin < dirs.size(); begin += packet.max_size) {
+        packet.size = std::min(packet.max_size, dirs.size() - begin);
+        for (size_t i = 0; i < packet.size; ++ i) {
+            const VectorType &origin = origins.size() == 1 ? origins.front() : origins[begin + i];
+            const VectorType &dir    = dirs[begin + i];
+            for (int axis = 0; axis < 3; ++ axis) {
+                packet.origin[axis][i] = origin[axis];
+                packet.dir[axis][i]    = dir[axis];
+                packet.invdir[axis][i] = Scalar(1) / dir[axis];
+            }
+            packet.min_t[i] = std::numeric_limits<Scalar>::infinity();
+        }
+        detail::intersect_ray_packet_first_hit<VertexType, IndexedFaceType, TreeType, VectorType>(vertices, faces, tree, packet, hits.data() + begin, eps);
+    }
+    return std::count_if(hits.begin(), hits.end(), [](const igl::Hit &hit) { return hit.id != -1; });
+}
+
+// Find the first intersections of multiple rays sharing a common origin with indexed triangle set.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline size_t intersect_rays_first_hit(
+	const std::vector<VertexType> 		&vertices,
+	const std::vector<IndexedFaceType> 	&faces,
+	const TreeType 						&tree,
+	// Common origin of the rays.
+	const VectorType					&origin,
+	const std::vector<VectorType>		&dirs,
+	std::vector<igl::Hit> 				&hits,
+	const double 						 eps = 0.000001)
+{
+    return intersect_rays_first_hit(vertices, faces, tree, std::vector<VectorType>{ origin }, dirs, hits, eps);
+}
+
 // Finding a closest triangle, its closest point and squared distance to the closest point
 // on a 3D indexed triangle set using a pre-built AABBTreeIndirect::Tree.
 // Closest point to triangle test will be performed with the accuracy of VectorType::Scalar
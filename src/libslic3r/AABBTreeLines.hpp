@@ -15,6 +15,9 @@
 #include <type_traits>
 #include <vector>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace Slic3r { namespace AABBTreeLines {
 
 namespace detail {
@@ -345,7 +348,7 @@ public:
         tree = AABBTreeLines::build_aabb_tree_over_indexed_lines(this->lines);
     }
 
-    explicit LinesDistancer(std::vector<LineType> &&lines) : lines(lines)
+    explicit LinesDistancer(std::vector<LineType> &&lines) : lines(std::move(lines))
     {
         tree = AABBTreeLines::build_aabb_tree_over_indexed_lines(this->lines);
     }
@@ -382,6 +385,22 @@ public:
         return dist;
     }
 
+    // Batched version of distance_from_lines(), large batches of points are queried in parallel.
+    template<bool SIGNED_DISTANCE> std::vector<Floating> distances_from_lines(const std::vector<Vec<2, Scalar>> &points) const
+    {
+        std::vector<Floating> distances(points.size());
+        auto query = [this, &points, &distances](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++i)
+                distances[i] = this->distance_from_lines<SIGNED_DISTANCE>(points[i]);
+        };
+        static constexpr size_t grain_size = 1024;
+        if (points.size() > grain_size)
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, points.size(), grain_size), query);
+        else
+            query(tbb::blocked_range<size_t>(0, points.size()));
+        return distances;
+    }
+
     std::vector<size_t> all_lines_in_radius(const Vec<2, Scalar> &point, Floating radius) const
     {
         return AABBTreeLines::all_lines_in_radius(this->lines, this->tree, point.template cast<Floating>(), radius * radius);
@@ -11,6 +11,8 @@
 
 #include <numeric>
 
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 namespace Algorithm {
 
@@ -381,8 +383,8 @@ static Polygons propagate_wave_from_boundary(
     assert(! seed.empty() && seed.front().size() >= 2);
     Polygons clipping = ClipperUtils::clip_clipper_polygons_with_subject_bbox(boundary, get_extents<true>(seed).inflated(max_inflation));
     ClipperLib::Paths polygons = wavefront_clip(wavefront_initial(co, seed, initial_step), clipping);
-    // Now offset the remaining 
-    for (size_t ioffset = 0; ioffset < num_other_steps; ++ ioffset)
+    // Now offset the remaining. An empty wavefront stays empty, skip the remaining Clipper passes.
+    for (size_t ioffset = 0; ioffset < num_other_steps && ! polygons.empty(); ++ ioffset)
         polygons = wavefront_clip(wavefront_step(co, polygons, other_step), clipping);
     return to_polygons(polygons);
 }
@@ -390,22 +392,37 @@ static Polygons propagate_wave_from_boundary(
 // Resulting regions are sorted by boundary id and source id.
 std::vector<RegionExpansion> propagate_waves(const WaveSeeds &seeds, const ExPolygons &boundary, const RegionExpansionParameters &params)
 {
+    // Ranges of seeds sharing the same boundary and source. The waves of the ranges propagate independently, thus in parallel.
+    std::vector<std::pair<size_t, size_t>> seed_ranges;
+    for (size_t i = 0; i < seeds.size();) {
+        size_t j = i + 1;
+        for (; j < seeds.size() && seeds[j].boundary == seeds[i].boundary && seeds[j].src == seeds[i].src; ++ j) ;
+        seed_ranges.emplace_back(i, j);
+        i = j;
+    }
+
+    std::vector<Polygons> expanded(seed_ranges.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, seed_ranges.size()), [&seeds, &boundary, &params, &seed_ranges, &expanded](const tbb::blocked_range<size_t> &range) {
+        ClipperLib::Paths         paths;
+        ClipperLib::ClipperOffset co;
+        co.ArcTolerance       = params.arc_tolerance;
+        co.ShortestEdgeLength = params.shortest_edge_length;
+        for (size_t range_idx = range.begin(); range_idx < range.end(); ++ range_idx) {
+            const auto [begin, end] = seed_ranges[range_idx];
+            paths.clear();
+            for (size_t i = begin; i < end; ++ i)
+                paths.emplace_back(seeds[i].path);
+            // Propagate the wavefront while clipping it with the trimmed boundary.
+            expanded[range_idx] = propagate_wave_from_boundary(co, paths, boundary[seeds[begin].boundary], params.initial_step, params.other_step, params.num_other_steps, params.max_inflation);
+        }
+    });
+
+    // Collect the expanded polygons in the order of the seeds.
     std::vector<RegionExpansion> out;
-    ClipperLib::Paths            paths;
-    ClipperLib::ClipperOffset co;
-    co.ArcTolerance       = params.arc_tolerance;
-    co.ShortestEdgeLength = params.shortest_edge_length;
-    for (auto it_seed = seeds.begin(); it_seed != seeds.end();) {
-        auto it = it_seed;
-        paths.clear();
-        for (; it != seeds.end() && it->boundary == it_seed->boundary && it->src == it_seed->src; ++ it)
-            paths.emplace_back(it->path);
-        // Propagate the wavefront while clipping it with the trimmed boundary.
-        // Collect the expanded polygons, merge them with the source polygons.
-        RegionExpansion re;
-        for (Polygon &polygon : propagate_wave_from_boundary(co, paths, boundary[it_seed->boundary], params.initial_step, params.other_step, params.num_other_steps, params.max_inflation))
-            out.push_back({ std::move(polygon), it_seed->src, it_seed->boundary });
-        it_seed = it;
+    for (size_t range_idx = 0; range_idx < seed_ranges.size(); ++ range_idx) {
+        const WaveSeed &seed = seeds[seed_ranges[range_idx].first];
+        for (Polygon &polygon : expanded[range_idx])
+            out.push_back({ std::move(polygon), seed.src, seed.boundary });
     }
 
     return out;
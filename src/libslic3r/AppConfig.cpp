@@ -70,9 +70,14 @@ void AppConfig::set_defaults()
         // Disable background processing by default as it is not stable.
         if (get("background_processing").empty())
             set("background_processing", "0");
+        if (get("speculative_slicing").empty())
+            set("speculative_slicing", "0");
         // Enable support issues alerts by default
         if (get("alert_when_supports_needed").empty())
             set("alert_when_supports_needed", "1");
+        // Maximum number of print host uploads performed concurrently, each of them to a different host.
+        if (get("printhost_max_concurrent_uploads").empty())
+            set("printhost_max_concurrent_uploads", "4");
         // If set, the "Controller" tab for the control of the printer over serial line and the serial port settings are hidden.
         // By default, Prusa has the controller hidden.
         if (get("no_controller").empty())
@@ -96,6 +101,9 @@ void AppConfig::set_defaults()
         if (get("export_sources_full_pathnames").empty())
             set("export_sources_full_pathnames", "0");
 
+        if (get("export_binary_meshes_3mf").empty())
+            set("export_binary_meshes_3mf", "0");
+
 #ifdef _WIN32
         if (get("associate_3mf").empty())
             set("associate_3mf", "0");
@@ -186,6 +194,17 @@ void AppConfig::set_defaults()
     if (get("seq_top_layer_only").empty())
         set("seq_top_layer_only", "1");
 
+    if (get("compact_toolpaths").empty())
+        set("compact_toolpaths", "0");
+
+    // gpu memory budget of the toolpaths in preview, in MB, 0 to keep all the toolpaths in the gpu memory
+    if (get("toolpaths_gpu_budget").empty())
+        set("toolpaths_gpu_budget", "0");
+
+    // maximum number of threads used by slicing and G-code export, 0 to use all the CPU cores
+    if (get("max_threads").empty())
+        set("max_threads", "0");
+
     if (get("use_perspective_camera").empty())
         set("use_perspective_camera", "1");
 
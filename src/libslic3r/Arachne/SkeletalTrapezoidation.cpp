@@ -439,8 +439,9 @@ void SkeletalTrapezoidation::computeSegmentCellRange(vd_t::cell_type& cell, Poin
 SkeletalTrapezoidation::SkeletalTrapezoidation(const Polygons& polys, const BeadingStrategy& beading_strategy,
                                                double transitioning_angle, coord_t discretization_step_size,
                                                coord_t transition_filter_dist, coord_t allowed_filter_deviation,
-                                               coord_t beading_propagation_transition_dist
+                                               coord_t beading_propagation_transition_dist, std::function<void()> throw_on_cancel
     ): transitioning_angle(transitioning_angle),
+    throw_on_cancel(std::move(throw_on_cancel)),
     discretization_step_size(discretization_step_size),
     transition_filter_dist(transition_filter_dist),
     allowed_filter_deviation(allowed_filter_deviation),
@@ -620,8 +621,7 @@ inline static std::pair<PointMap, double> try_to_fix_degenerated_voronoi_diagram
             for (size_t point_idx = 0; point_idx < polys_rotated[poly_idx].size(); point_idx++)
                 segments.emplace_back(&polys_rotated, poly_idx, point_idx);
 
-        voronoi_diagram.clear();
-        construct_voronoi(segments.begin(), segments.end(), &voronoi_diagram);
+        voronoi_diagram.construct(segments.begin(), segments.end());
 
 #ifdef ARACHNE_DEBUG_VORONOI
         {
@@ -670,8 +670,9 @@ void SkeletalTrapezoidation::constructFromPolygons(const Polygons& polys)
     }
 #endif
 
-    Geometry::VoronoiDiagram voronoi_diagram;
-    construct_voronoi(segments.begin(), segments.end(), &voronoi_diagram);
+    Geometry::ThreadLocalVoronoiDiagram voronoi_diagram_tls;
+    Geometry::VoronoiDiagram           &voronoi_diagram = *voronoi_diagram_tls;
+    voronoi_diagram.construct(segments.begin(), segments.end());
 
 #ifdef ARACHNE_DEBUG_VORONOI
     {
@@ -711,6 +712,7 @@ void SkeletalTrapezoidation::constructFromPolygons(const Polygons& polys)
 
 process_voronoi_diagram:
     assert(this->graph.edges.empty() && this->graph.nodes.empty() && this->vd_edge_to_he_edge.empty() && this->vd_node_to_he_node.empty());
+    throw_on_cancel();
     for (vd_t::cell_type cell : voronoi_diagram.cells()) {
         if (!cell.incident_edge())
             continue; // There is no spoon
@@ -860,6 +862,7 @@ void SkeletalTrapezoidation::generateToolpaths(std::vector<VariableWidthLines> &
     p_generated_toolpaths = &generated_toolpaths;
 
     updateIsCentral();
+    throw_on_cancel();
 
 #ifdef ARACHNE_DEBUG
     export_graph_to_svg(debug_out_path("ST-updateIsCentral-final-%d.svg", iRun), this->graph, this->outline);
@@ -875,6 +878,7 @@ void SkeletalTrapezoidation::generateToolpaths(std::vector<VariableWidthLines> &
         filterOuterCentral();
 
     updateBeadCount();
+    throw_on_cancel();
 
 #ifdef ARACHNE_DEBUG
     export_graph_to_svg(debug_out_path("ST-updateBeadCount-final-%d.svg", iRun), this->graph, this->outline);
@@ -887,12 +891,14 @@ void SkeletalTrapezoidation::generateToolpaths(std::vector<VariableWidthLines> &
 #endif
 
     generateTransitioningRibs();
+    throw_on_cancel();
 
 #ifdef ARACHNE_DEBUG
     export_graph_to_svg(debug_out_path("ST-generateTransitioningRibs-final-%d.svg", iRun), this->graph, this->outline);
 #endif
 
     generateExtraRibs();
+    throw_on_cancel();
 
 #ifdef ARACHNE_DEBUG
     export_graph_to_svg(debug_out_path("ST-generateExtraRibs-final-%d.svg", iRun), this->graph, this->outline);
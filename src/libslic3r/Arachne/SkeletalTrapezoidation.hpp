@@ -6,6 +6,7 @@
 
 #include <boost/polygon/voronoi.hpp>
 
+#include <functional>
 #include <memory> // smart pointers
 #include <utility> // pair
 
@@ -64,6 +65,7 @@ class SkeletalTrapezoidation
     using ptr_vector_t = std::vector<std::shared_ptr<T>>;
 
     double  transitioning_angle; //!< How pointy a region should be before we apply the method. Equals 180* - limit_bisector_angle
+    std::function<void()> throw_on_cancel; //!< Throws when the slicing was canceled.
     coord_t discretization_step_size; //!< approximate size of segments when parabolic VD edges get discretized (and vertex-vertex edges)
     coord_t transition_filter_dist; //!< Filter transition mids (i.e. anchors) closer together than this
     coord_t allowed_filter_deviation; //!< The allowed line width deviation induced by filtering
@@ -102,6 +104,9 @@ public:
      * \param beading_propagation_transition_dist When there are different
      * beadings propagated from below and from above, use this transitioning
      * distance.
+     * \param throw_on_cancel Called between the phases of the skeleton
+     * construction and of the toolpath generation, throws when the slicing
+     * was canceled.
      */
     SkeletalTrapezoidation(const Polygons& polys,
                            const BeadingStrategy& beading_strategy,
@@ -109,7 +114,8 @@ public:
     , coord_t discretization_step_size
     , coord_t transition_filter_dist
     , coord_t allowed_filter_deviation
-    , coord_t beading_propagation_transition_dist);
+    , coord_t beading_propagation_transition_dist
+    , std::function<void()> throw_on_cancel = [](){});
 
     /*!
      * A skeletal graph through the polygons that we need to fill with beads.
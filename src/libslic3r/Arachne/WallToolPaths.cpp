@@ -7,6 +7,7 @@
 
 #include "SkeletalTrapezoidation.hpp"
 #include "../ClipperUtils.hpp"
+#include "../ProfilerTracy.hpp"
 #include "utils/linearAlg2D.hpp"
 #include "EdgeGrid.hpp"
 #include "utils/SparseLineGrid.hpp"
@@ -17,6 +18,8 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 //#define ARACHNE_STITCH_PATCH_DEBUG
 
 namespace Slic3r::Arachne
@@ -24,7 +27,8 @@ namespace Slic3r::Arachne
 
 WallToolPaths::WallToolPaths(const Polygons& outline, const coord_t bead_width_0, const coord_t bead_width_x,
                              const size_t inset_count, const coord_t wall_0_inset, const coordf_t layer_height,
-                             const PrintObjectConfig &print_object_config, const PrintConfig &print_config)
+                             const PrintObjectConfig &print_object_config, const PrintConfig &print_config,
+                             std::function<void()> throw_on_cancel)
     : outline(outline)
     , bead_width_0(bead_width_0)
     , bead_width_x(bead_width_x)
@@ -39,6 +43,7 @@ WallToolPaths::WallToolPaths(const Polygons& outline, const coord_t bead_width_0
     , wall_transition_length(scaled<coord_t>(print_object_config.wall_transition_length.value))
     , toolpaths_generated(false)
     , print_object_config(print_object_config)
+    , throw_on_cancel(std::move(throw_on_cancel))
 {
     assert(!print_config.nozzle_diameter.empty());
     this->min_nozzle_diameter = float(*std::min_element(print_config.nozzle_diameter.values.begin(), print_config.nozzle_diameter.values.end()));
@@ -449,6 +454,7 @@ void removeColinearEdges(Polygons &thiss, const double max_deviation_angle = 0.0
 
 const std::vector<VariableWidthLines> &WallToolPaths::generate()
 {
+    SLIC3R_PROFILE_ZONE();
     if (this->inset_count < 1)
         return toolpaths;
 
@@ -475,6 +481,7 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
     // Clipper union also fixed an issue in Arachne that in post-processing Voronoi diagram, some edges
     // didn't have twin edges. (a non-planar Voronoi diagram probably caused this).
     prepared_outline = union_(prepared_outline);
+    throw_on_cancel();
 
     if (area(prepared_outline) <= 0) {
         assert(toolpaths.empty());
@@ -506,17 +513,41 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
         );
     const coord_t transition_filter_dist   = scaled<coord_t>(100.f);
     const coord_t allowed_filter_deviation = wall_transition_filter_deviation;
-    SkeletalTrapezoidation wall_maker
-    (
-        prepared_outline,
-        *beading_strat,
-        beading_strat->getTransitioningAngle(),
-        discretization_step_size,
-        transition_filter_dist,
-        allowed_filter_deviation,
-        wall_transition_length
-    );
-    wall_maker.generateToolpaths(toolpaths);
+    auto generate_toolpaths = [&](const Polygons &polygons, std::vector<VariableWidthLines> &out) {
+        SkeletalTrapezoidation wall_maker
+        (
+            polygons,
+            *beading_strat,
+            beading_strat->getTransitioningAngle(),
+            discretization_step_size,
+            transition_filter_dist,
+            allowed_filter_deviation,
+            wall_transition_length,
+            throw_on_cancel
+        );
+        wall_maker.generateToolpaths(out);
+    };
+
+    if (size_t num_contours = std::count_if(prepared_outline.begin(), prepared_outline.end(), [](const Polygon &p) { return p.is_counter_clockwise(); });
+        num_contours > 1) {
+        // The skeleton inside an island only depends on the boundary of that island, thus the islands are processed
+        // by independent skeletal trapezoidations in parallel. Complex layers (lattices, text) may have thousands of islands.
+        ExPolygons islands = union_ex(prepared_outline);
+        std::vector<std::vector<VariableWidthLines>> island_toolpaths(islands.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, islands.size()), [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t island_idx = range.begin(); island_idx < range.end(); ++ island_idx)
+                generate_toolpaths(to_polygons(islands[island_idx]), island_toolpaths[island_idx]);
+        });
+        // Merge the toolpaths of the islands, keeping them indexed by inset_idx.
+        for (std::vector<VariableWidthLines> &island : island_toolpaths) {
+            if (toolpaths.size() < island.size())
+                toolpaths.resize(island.size());
+            for (size_t inset_idx = 0; inset_idx < island.size(); ++ inset_idx)
+                append(toolpaths[inset_idx], std::move(island[inset_idx]));
+        }
+    } else
+        generate_toolpaths(prepared_outline, toolpaths);
+    throw_on_cancel();
 
     stitchToolPaths(toolpaths, this->bead_width_x);
 
@@ -4,6 +4,7 @@
 #ifndef CURAENGINE_WALLTOOLPATHS_H
 #define CURAENGINE_WALLTOOLPATHS_H
 
+#include <functional>
 #include <memory>
 
 #include <ankerl/unordered_dense.h>
@@ -31,8 +32,10 @@ public:
      * \param bead_width_x The bead width of the inner walls used in the generation of the toolpaths
      * \param inset_count The maximum number of parallel extrusion lines that make up the wall
      * \param wall_0_inset How far to inset the outer wall, to make it adhere better to other walls.
+     * \param throw_on_cancel Called repeatedly during the generation, throws when the slicing was canceled.
      */
-    WallToolPaths(const Polygons& outline, coord_t bead_width_0, coord_t bead_width_x, size_t inset_count, coord_t wall_0_inset, coordf_t layer_height, const PrintObjectConfig &print_object_config, const PrintConfig &print_config);
+    WallToolPaths(const Polygons& outline, coord_t bead_width_0, coord_t bead_width_x, size_t inset_count, coord_t wall_0_inset, coordf_t layer_height, const PrintObjectConfig &print_object_config, const PrintConfig &print_config,
+                  std::function<void()> throw_on_cancel = [](){});
 
     /*!
      * Generates the Toolpaths
@@ -124,6 +127,7 @@ private:
     std::vector<VariableWidthLines> toolpaths; //<! The generated toolpaths
     Polygons inner_contour;  //<! The inner contour of the generated toolpaths
     const PrintObjectConfig &print_object_config;
+    std::function<void()> throw_on_cancel; //<! Throws when the slicing was canceled
 };
 
 } // namespace Slic3r::Arachne
@@ -5,24 +5,245 @@
 #define UTILS_HALF_EDGE_GRAPH_H
 
 
-#include <list>
 #include <cassert>
-
-
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
 
 #include "HalfEdge.hpp"
 #include "HalfEdgeNode.hpp"
 
 namespace Slic3r::Arachne
 {
+
+/*!
+ * Pooled storage of half-edges or nodes of a HalfEdgeGraph with the interface of the subset of std::list used by the graph.
+ *
+ * Elements are allocated from fixed size blocks, thus they never move in memory once created and the pointers kept
+ * by the half-edges stay valid, as they did with std::list. The elements are chained by 32bit indices, which keep
+ * the iteration order of std::list (including emplace_front() / emplace_back() while iterating and erase() returning
+ * the next element), while consecutively created elements end up next to each other in memory. Slots of erased
+ * elements are recycled through a free list.
+ */
+template<typename T>
+class HalfEdgeStorage
+{
+    static constexpr uint32_t BLOCK_BITS = 8;
+    static constexpr uint32_t BLOCK_SIZE = uint32_t(1) << BLOCK_BITS;
+    static constexpr uint32_t INVALID    = std::numeric_limits<uint32_t>::max();
+
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+        uint32_t prev;
+        uint32_t next;
+
+        T&       value()       { return *std::launder(reinterpret_cast<T*>(storage)); }
+        const T& value() const { return *std::launder(reinterpret_cast<const T*>(storage)); }
+    };
+
+    template<bool IsConst>
+    class Iterator
+    {
+        using storage_t = std::conditional_t<IsConst, const HalfEdgeStorage, HalfEdgeStorage>;
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = std::conditional_t<IsConst, const T*, T*>;
+        using reference         = std::conditional_t<IsConst, const T&, T&>;
+
+        Iterator() = default;
+        Iterator(storage_t *storage, uint32_t idx) : m_storage(storage), m_idx(idx) {}
+        // Conversion of iterator to const_iterator.
+        template<bool C = IsConst, typename = std::enable_if_t<C>>
+        Iterator(const Iterator<false> &rhs) : m_storage(rhs.m_storage), m_idx(rhs.m_idx) {}
+
+        reference operator*() const { return m_storage->slot(m_idx).value(); }
+        pointer   operator->() const { return &m_storage->slot(m_idx).value(); }
+
+        Iterator& operator++() { m_idx = m_storage->slot(m_idx).next; return *this; }
+        Iterator  operator++(int) { Iterator out = *this; ++ *this; return out; }
+        Iterator& operator--() { m_idx = m_idx == INVALID ? m_storage->m_tail : m_storage->slot(m_idx).prev; return *this; }
+        Iterator  operator--(int) { Iterator out = *this; -- *this; return out; }
+
+        bool operator==(const Iterator &rhs) const { return m_idx == rhs.m_idx; }
+        bool operator!=(const Iterator &rhs) const { return m_idx != rhs.m_idx; }
+
+    private:
+        storage_t *m_storage = nullptr;
+        uint32_t   m_idx     = INVALID;
+
+        friend class HalfEdgeStorage;
+        friend class Iterator<true>;
+    };
+
+public:
+    using value_type     = T;
+    using iterator       = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    HalfEdgeStorage() = default;
+    HalfEdgeStorage(const HalfEdgeStorage &) = delete;
+    HalfEdgeStorage(HalfEdgeStorage &&rhs) noexcept
+        : m_blocks(std::move(rhs.m_blocks))
+        , m_head(std::exchange(rhs.m_head, INVALID))
+        , m_tail(std::exchange(rhs.m_tail, INVALID))
+        , m_free(std::exchange(rhs.m_free, INVALID))
+        , m_allocated(std::exchange(rhs.m_allocated, 0))
+        , m_size(std::exchange(rhs.m_size, 0))
+    {
+        rhs.m_blocks.clear();
+    }
+    ~HalfEdgeStorage() { this->clear(); }
+
+    HalfEdgeStorage& operator=(const HalfEdgeStorage &) = delete;
+    HalfEdgeStorage& operator=(HalfEdgeStorage &&rhs) noexcept
+    {
+        if (this != &rhs) {
+            this->clear();
+            m_blocks    = std::move(rhs.m_blocks);
+            m_head      = std::exchange(rhs.m_head, INVALID);
+            m_tail      = std::exchange(rhs.m_tail, INVALID);
+            m_free      = std::exchange(rhs.m_free, INVALID);
+            m_allocated = std::exchange(rhs.m_allocated, 0);
+            m_size      = std::exchange(rhs.m_size, 0);
+            rhs.m_blocks.clear();
+        }
+        return *this;
+    }
+
+    iterator       begin()        { return { this, m_head }; }
+    iterator       end()          { return { this, INVALID }; }
+    const_iterator begin()  const { return { this, m_head }; }
+    const_iterator end()    const { return { this, INVALID }; }
+    const_iterator cbegin() const { return this->begin(); }
+    const_iterator cend()   const { return this->end(); }
+
+    size_t size()  const { return m_size; }
+    bool   empty() const { return m_size == 0; }
+
+    T&       front()       { assert(! this->empty()); return this->slot(m_head).value(); }
+    const T& front() const { assert(! this->empty()); return this->slot(m_head).value(); }
+    T&       back()        { assert(! this->empty()); return this->slot(m_tail).value(); }
+    const T& back()  const { assert(! this->empty()); return this->slot(m_tail).value(); }
+
+    template<typename... Args>
+    T& emplace_front(Args&&... args)
+    {
+        const uint32_t idx  = this->construct(std::forward<Args>(args)...);
+        Slot          &slot = this->slot(idx);
+        slot.prev = INVALID;
+        slot.next = m_head;
+        if (m_head == INVALID)
+            m_tail = idx;
+        else
+            this->slot(m_head).prev = idx;
+        m_head = idx;
+        return slot.value();
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        const uint32_t idx  = this->construct(std::forward<Args>(args)...);
+        Slot          &slot = this->slot(idx);
+        slot.prev = m_tail;
+        slot.next = INVALID;
+        if (m_tail == INVALID)
+            m_head = idx;
+        else
+            this->slot(m_tail).next = idx;
+        m_tail = idx;
+        return slot.value();
+    }
+
+    // Returns iterator following the erased element.
+    iterator erase(const_iterator it)
+    {
+        const uint32_t idx  = it.m_idx;
+        Slot          &slot = this->slot(idx);
+        const uint32_t next = slot.next;
+        if (slot.prev == INVALID)
+            m_head = next;
+        else
+            this->slot(slot.prev).next = next;
+        if (next == INVALID)
+            m_tail = slot.prev;
+        else
+            this->slot(next).prev = slot.prev;
+        slot.value().~T();
+        slot.next = m_free;
+        m_free    = idx;
+        -- m_size;
+        return { this, next };
+    }
+
+    // Destroys all elements, the allocated blocks are kept for reuse.
+    void clear()
+    {
+        for (uint32_t idx = m_head; idx != INVALID;) {
+            Slot &slot = this->slot(idx);
+            idx = slot.next;
+            slot.value().~T();
+        }
+        m_head = m_tail = m_free = INVALID;
+        m_allocated = 0;
+        m_size      = 0;
+    }
+
+private:
+    Slot&       slot(uint32_t idx)       { return m_blocks[idx >> BLOCK_BITS][idx & (BLOCK_SIZE - 1)]; }
+    const Slot& slot(uint32_t idx) const { return m_blocks[idx >> BLOCK_BITS][idx & (BLOCK_SIZE - 1)]; }
+
+    // Constructs a new unlinked element in a recycled or a fresh slot, returns its index.
+    template<typename... Args>
+    uint32_t construct(Args&&... args)
+    {
+        uint32_t idx;
+        bool     recycled = m_free != INVALID;
+        if (recycled) {
+            idx = m_free;
+        } else {
+            assert(m_allocated < INVALID);
+            if (m_allocated == m_blocks.size() * BLOCK_SIZE)
+                // Default initialization, the slots are not zeroed.
+                m_blocks.emplace_back(new Slot[BLOCK_SIZE]);
+            idx = m_allocated;
+        }
+        Slot &slot = this->slot(idx);
+        new (slot.storage) T(std::forward<Args>(args)...);
+        // Only take the slot once the element was constructed successfully.
+        if (recycled)
+            m_free = slot.next;
+        else
+            ++ m_allocated;
+        ++ m_size;
+        return idx;
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> m_blocks;
+    uint32_t                             m_head      = INVALID;
+    uint32_t                             m_tail      = INVALID;
+    // Head of the singly linked list of recycled slots chained through Slot::next.
+    uint32_t                             m_free      = INVALID;
+    // Number of slots handed out from m_blocks, both alive and recycled.
+    uint32_t                             m_allocated = 0;
+    size_t                               m_size      = 0;
+};
+
 template<class node_data_t, class edge_data_t, class derived_node_t, class derived_edge_t> // types of data contained in nodes and edges
 class HalfEdgeGraph
 {
 public:
     using edge_t = derived_edge_t;
     using node_t = derived_node_t;
-    using Edges = std::list<edge_t>;
-    using Nodes = std::list<node_t>;
+    using Edges = HalfEdgeStorage<edge_t>;
+    using Nodes = HalfEdgeStorage<node_t>;
     Edges edges;
     Nodes nodes;
 };
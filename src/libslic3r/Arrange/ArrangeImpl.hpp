@@ -16,6 +16,7 @@
 #include "Core/NFP/Kernels/TMArrangeKernel.hpp"
 #include "Core/NFP/Kernels/GravityKernel.hpp"
 #include "Core/NFP/RectangleOverfitPackingStrategy.hpp"
+#include "Core/Raster/PackStrategyRaster.hpp"
 #include "Core/Beds.hpp"
 
 #include "Items/MutableItemTraits.hpp"
@@ -265,6 +266,10 @@ class DefaultArranger: public Arranger<ArrItem> {
 
     static constexpr auto Accuracy = 1.;
 
+    // Above this count of items, the nfp based packing is too slow and the
+    // raster based bottom-left fill is used instead.
+    static constexpr size_t RasterPackingItemCount = 500;
+
     template<class It, class FixIt, class Bed>
     void arrange_(
         const Range<It>     &items,
@@ -323,12 +328,17 @@ class DefaultArranger: public Arranger<ArrItem> {
                                                return is_wipe_tower(itm);
                                            });
 
-        // With rectange bed, and no fixed items, let's use an infinite bed
-        // with RectangleOverfitKernelWrapper. It produces better results than
-        // a pure RectangleBed with inner-fit polygon calculation.
-        if (!with_wipe_tower &&
+        if (items.size() >= RasterPackingItemCount &&
+            !std::is_convertible_v<Bed, InfiniteBed>) {
+            PackStrategyRaster ps{ep, stop_cond};
+
+            arr2::arrange(sel, ps, items, fixed, bed);
+        } else if (!with_wipe_tower &&
             m_settings.get_arrange_strategy() == ArrangeSettingsView::asAuto &&
             std::is_convertible_v<Bed, RectangleBed>) {
+            // With rectange bed, and no fixed items, let's use an infinite bed
+            // with RectangleOverfitKernelWrapper. It produces better results than
+            // a pure RectangleBed with inner-fit polygon calculation.
             PackStrategyNFP base_strategy{std::move(kernel), ep, Accuracy, stop_cond};
 
             RectangleOverfitPackingStrategy final_strategy{std::move(base_strategy)};
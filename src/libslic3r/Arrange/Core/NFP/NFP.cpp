@@ -10,6 +10,9 @@
 
 #include "NFPConcave_Tesselate.hpp"
 
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+
 #if !defined(_MSC_VER) && defined(__SIZEOF_INT128__) && !defined(__APPLE__)
 namespace Slic3r { using LargeInt = __int128; }
 #else
@@ -170,14 +173,11 @@ ExPolygons ifp_convex(const arr2::IrregularBed &bed, const Polygon &convexpoly)
     Polygon rect = arr2::to_rectangle(bb);
 
     ExPolygons blueprint = diff_ex(rect, bed.poly);
-    Polygons ifp;
-    for (const ExPolygon &part : blueprint) {
-        Polygons triangles = Slic3r::convex_decomposition_tess(part);
-        for (const Polygon &tr : triangles) {
-            Polygon subifp = nfp_convex_convex_legacy(tr, convexpoly);
-            ifp.emplace_back(std::move(subifp));
-        }
-    }
+    Polygons triangles = Slic3r::convex_decomposition_tess(blueprint);
+    Polygons ifp(triangles.size());
+    execution::for_each(ex_tbb, size_t(0), triangles.size(), [&](size_t i) {
+        ifp[i] = nfp_convex_convex_legacy(triangles[i], convexpoly);
+    }, 64);
 
     ifp = union_(ifp);
 
@@ -315,6 +315,25 @@ Polygon nfp_convex_convex(const Polygon &fixed, const Polygon &movable)
     return ret;
 }
 
+ExPolygons nfp_concave_concave(const Polygons &fixed_decomp,
+                               const Polygons &movable_decomp,
+                               const Vec2crd  &movable_ref)
+{
+    auto refs_mv = reserve_vector<Vec2crd>(movable_decomp.size());
+    for (const Polygon &p : movable_decomp)
+        refs_mv.emplace_back(reference_vertex(p));
+
+    Polygons nfps(fixed_decomp.size() * movable_decomp.size());
+    execution::for_each(ex_tbb, size_t(0), nfps.size(), [&](size_t i) {
+        size_t mvi = i % movable_decomp.size();
+        Polygon &subnfp = nfps[i];
+        nfp_convex_convex(fixed_decomp[i / movable_decomp.size()], movable_decomp[mvi], subnfp);
+        subnfp.translate(movable_ref - refs_mv[mvi]);
+    }, 64);
+
+    return union_ex(nfps);
+}
+
 static void buildPolygon(const std::vector<Line>& edgelist,
                          Polygon& rpoly,
                          Point& top_nfp)
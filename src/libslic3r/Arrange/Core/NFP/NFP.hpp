@@ -23,6 +23,15 @@ Polygon nfp_convex_convex(const Polygon &fixed, const Polygon &movable);
 void nfp_convex_convex(const Polygon &fixed, const Polygon &movable, Polygon &out);
 Polygon nfp_convex_convex_legacy(const Polygon &fixed, const Polygon &movable);
 
+// Concave-Concave nfp of shapes given by their convex decompositions. The
+// decomposition is the expensive part, so it can be computed once per shape
+// and reused for all the nfps of that shape. The convex sub-nfps are computed
+// in parallel and merged with a single union. movable_ref is the reference
+// vertex of the whole movable shape.
+ExPolygons nfp_concave_concave(const Polygons &fixed_decomp,
+                               const Polygons &movable_decomp,
+                               const Vec2crd  &movable_ref);
+
 Polygon ifp_convex_convex(const Polygon &fixed, const Polygon &movable);
 
 ExPolygons ifp_convex(const arr2::RectangleBed &bed, const Polygon &convexpoly);
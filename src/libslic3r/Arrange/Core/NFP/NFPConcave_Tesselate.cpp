@@ -48,27 +48,7 @@ ExPolygons nfp_concave_concave_tess(const ExPolygon &fixed,
     Polygons fixed_decomp = convex_decomposition_tess(fixed);
     Polygons movable_decomp = convex_decomposition_tess(movable);
 
-    auto refs_mv = reserve_vector<Vec2crd>(movable_decomp.size());
-
-    for (const Polygon &p : movable_decomp)
-        refs_mv.emplace_back(reference_vertex(p));
-
-    auto nfps = reserve_polygons(fixed_decomp.size() * movable_decomp.size());
-
-    Vec2crd ref_whole = reference_vertex(movable);
-    for (const Polygon &fixed_part : fixed_decomp) {
-        size_t mvi = 0;
-        for (const Polygon &movable_part : movable_decomp) {
-            Polygon subnfp = nfp_convex_convex(fixed_part, movable_part);
-            const Vec2crd &ref_mp = refs_mv[mvi];
-            auto d = ref_whole - ref_mp;
-            subnfp.translate(d);
-            nfps.emplace_back(subnfp);
-            mvi++;
-        }
-    }
-
-    return union_ex(nfps);
+    return nfp_concave_concave(fixed_decomp, movable_decomp, reference_vertex(movable));
 }
 
 } // namespace Slic3r
@@ -0,0 +1,161 @@
+///|/ Copyright (c) Prusa Research 2023 Tomáš Mészáros @tamasmeszaros
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef PACKSTRATEGYRASTER_HPP
+#define PACKSTRATEGYRASTER_HPP
+
+#include "libslic3r/Arrange/Core/ArrangeBase.hpp"
+#include "libslic3r/Arrange/Core/Beds.hpp"
+#include "libslic3r/Arrange/Core/NFP/NFPArrangeItemTraits.hpp"
+
+#include "libslic3r/Execution/ExecutionSeq.hpp"
+
+#include "RasterGrid.hpp"
+
+namespace Slic3r { namespace arr2 {
+
+// Fast packing for a huge number of items: the bed and the packed items are
+// rasterized into an occupancy grid and each new item is placed to the lowest
+// and leftmost free spot where its raster fits (bottom-left fill). The result
+// is less dense than with PackStrategyNFP, but the cost does not grow with
+// the complexity of the nfp of all the packed items.
+struct RasterPackingTag {};
+
+template<class ExecPolicy = ExecutionSeq,
+         class StopCond   = DefaultStopCondition>
+struct PackStrategyRaster {
+    ExecPolicy ep;
+
+    // Size of the raster cell, zero to derive it from the bed size
+    coord_t cell_size = 0;
+
+    StopCond stop_condition;
+
+    PackStrategyRaster(ExecPolicy execpolicy = {},
+                       StopCond stop_cond = {},
+                       coord_t cell = 0)
+        : ep{std::move(execpolicy)},
+          cell_size{cell},
+          stop_condition{std::move(stop_cond)}
+    {}
+};
+
+template<class...Args>
+struct PackStrategyTag_<PackStrategyRaster<Args...>>
+{
+    using Tag = RasterPackingTag;
+};
+
+// Packing context keeping the occupancy grid of one bed up to date with the
+// fixed and packed items.
+template<class ArrItem>
+class RasterPackingContext : public DefaultPackingContext<ArrItem>
+{
+    RasterGrid m_grid;
+
+public:
+    explicit RasterPackingContext(RasterGrid grid) : m_grid{std::move(grid)} {}
+
+    const RasterGrid &grid() const noexcept { return m_grid; }
+
+    void rasterize(const ArrItem &itm) { m_grid.fill(fixed_outline(itm)); }
+};
+
+template<class... Args>
+struct PackStrategyTraits_<PackStrategyRaster<Args...>> {
+    template<class ArrItem>
+    using Context = RasterPackingContext<StripCVRef<ArrItem>>;
+
+    template<class ArrItem, class Bed>
+    static Context<ArrItem> create_context(PackStrategyRaster<Args...> &ps,
+                                           const Bed &bed,
+                                           int bed_index)
+    {
+        return Context<ArrItem>{
+            RasterGrid::create_bed_grid(to_expolygons(bed), ps.cell_size)};
+    }
+};
+
+template<class ArrItem>
+struct PackingContextTraits_<RasterPackingContext<ArrItem>>
+    : public PackingContextTraits_<DefaultPackingContext<ArrItem>>
+{
+    static void add_fixed_item(RasterPackingContext<ArrItem> &ctx, const ArrItem &itm)
+    {
+        ctx.add_fixed_item(itm);
+        ctx.rasterize(itm);
+    }
+
+    static void add_packed_item(RasterPackingContext<ArrItem> &ctx, ArrItem &itm)
+    {
+        ctx.add_packed_item(itm);
+        ctx.rasterize(itm);
+    }
+};
+
+template<class Strategy, class ArrItem, class Bed, class RemIt>
+bool pack(Strategy &strategy,
+          const Bed &bed,
+          ArrItem &item,
+          const PackStrategyContext<Strategy, ArrItem> &packing_context,
+          const Range<RemIt> &remaining_items,
+          const RasterPackingTag &)
+{
+    const RasterGrid &grid = packing_context.grid();
+    if (grid.empty() || strategy.stop_condition())
+        return false;
+
+    double  orig_rot = get_rotation(item);
+    Vec2crd orig_tr  = get_translation(item);
+
+    // Changing the rotation modifies the item, so the outlines of all the
+    // allowed rotations are collected first and the spots are searched in
+    // parallel afterwards.
+    const auto &rotations = allowed_rotations(item);
+    auto rots     = reserve_vector<double>(rotations.size());
+    auto outlines = reserve_vector<Polygons>(rotations.size());
+    for (double rot : rotations) {
+        set_rotation(item, orig_rot + rot);
+        rots.emplace_back(rot);
+        outlines.emplace_back(envelope_outline(item));
+    }
+
+    std::vector<RasterGrid> masks(outlines.size());
+    std::vector<std::optional<RasterGrid::Position>> spots(outlines.size());
+    execution::for_each(strategy.ep, size_t(0), outlines.size(), [&](size_t i) {
+        if (strategy.stop_condition())
+            return;
+
+        masks[i] = RasterGrid::create_mask(outlines[i], grid.cell_size());
+        spots[i] = grid.find_bottom_left(masks[i]);
+    }, 1);
+
+    // Prefer the spot with the lowest top edge, then with the leftmost
+    // right edge.
+    auto spot_key = [&masks, &spots](size_t i) {
+        return std::make_pair(spots[i]->y() + masks[i].rows(),
+                              spots[i]->x() + masks[i].cols());
+    };
+
+    std::optional<size_t> best;
+    for (size_t i = 0; i < spots.size(); ++i)
+        if (spots[i] && (!best || spot_key(i) < spot_key(*best)))
+            best = i;
+
+    bool packed = best && !strategy.stop_condition();
+    if (packed) {
+        const RasterGrid &mask = masks[*best];
+        set_rotation(item, orig_rot + rots[*best]);
+        set_translation(item, orig_tr + grid.coords(*spots[*best]) - mask.origin());
+    } else {
+        set_rotation(item, orig_rot);
+        set_translation(item, orig_tr);
+    }
+
+    return packed;
+}
+
+}} // namespace Slic3r::arr2
+
+#endif // PACKSTRATEGYRASTER_HPP
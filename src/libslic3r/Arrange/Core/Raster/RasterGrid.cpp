@@ -0,0 +1,175 @@
+///|/ Copyright (c) Prusa Research 2023 Tomáš Mészáros @tamasmeszaros
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "RasterGrid.hpp"
+
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+
+namespace Slic3r { namespace arr2 {
+
+// Cells are sampled in their centers. A polygon touching a cell is at most
+// half of the cell diagonal (0.707 of the cell size) away from its center,
+// so the polygons are inflated by a bit more than that before sampling.
+static constexpr double InflationRatio = 0.75;
+
+// Limits for the automatic cell size of a bed grid
+static constexpr double MaxBedCellCount = 1 << 18;
+static constexpr double MinCellSizeMM = 0.2;
+
+RasterGrid::RasterGrid(const BoundingBox &bb, coord_t cell_size)
+    : m_origin{bb.min}, m_cell{std::max(cell_size, coord_t(1))}
+{
+    Vec2crd size = bb.size();
+    m_cols = std::max(size_t(1), size_t((size.x() + m_cell - 1) / m_cell));
+    m_rows = std::max(size_t(1), size_t((size.y() + m_cell - 1) / m_cell));
+    m_row_words = (m_cols + WordBits - 1) / WordBits + 1;
+    m_words.assign(m_rows * m_row_words, Word(0));
+}
+
+RasterGrid RasterGrid::create_bed_grid(const ExPolygons &bed, coord_t cell_size)
+{
+    BoundingBox bb = get_extents(bed);
+    if (!bb.defined)
+        return {};
+
+    if (cell_size <= 0) {
+        Vec2d size = unscaled(bb.size());
+        double cell = std::max(MinCellSizeMM, std::sqrt(size.x() * size.y() / MaxBedCellCount));
+        cell_size = scaled(cell);
+    }
+
+    RasterGrid grid{bb, cell_size};
+
+    // Everything outside of the bed is occupied
+    BoundingBox frame = bb;
+    frame.offset(2 * cell_size);
+    grid.fill(diff_ex(frame.polygon(), bed));
+
+    return grid;
+}
+
+RasterGrid RasterGrid::create_mask(const Polygons &outline, coord_t cell_size)
+{
+    BoundingBox bb = get_extents(outline);
+    if (!bb.defined)
+        return {};
+
+    // Room for the inflation of the outline
+    bb.offset(cell_size);
+    RasterGrid mask{bb, cell_size};
+    mask.fill(outline);
+
+    return mask;
+}
+
+void RasterGrid::set_span(size_t row, size_t col_from, size_t col_to)
+{
+    Word *data = row_data(row);
+    size_t w_from = col_from / WordBits;
+    size_t w_to   = col_to / WordBits;
+    Word first = ~Word(0) << (col_from % WordBits);
+    Word last  = ~Word(0) >> (WordBits - 1 - col_to % WordBits);
+    if (w_from == w_to) {
+        data[w_from] |= first & last;
+        return;
+    }
+
+    data[w_from] |= first;
+    for (size_t w = w_from + 1; w < w_to; ++w)
+        data[w] = ~Word(0);
+    data[w_to] |= last;
+}
+
+void RasterGrid::fill(const Polygons &polys)
+{
+    if (empty() || polys.empty())
+        return;
+
+    Polygons inflated = expand(polys, float(InflationRatio * m_cell));
+
+    // Scanline through the cell centers of each row, the crossings of the
+    // edges are paired by the even-odd rule.
+    const double cell = m_cell;
+    const double ox = m_origin.x(), oy = m_origin.y();
+    const double max_row = double(m_rows - 1), max_col = double(m_cols - 1);
+    std::vector<std::vector<double>> crossings(m_rows);
+    for (const Polygon &poly : inflated) {
+        for (size_t i = 0; i < poly.size(); ++i) {
+            const Point &a = poly[i];
+            const Point &b = poly[i + 1 == poly.size() ? 0 : i + 1];
+            if (a.y() == b.y())
+                continue;
+
+            // rows with center in <ymin, ymax)
+            double ymin = std::min(a.y(), b.y()), ymax = std::max(a.y(), b.y());
+            double row_from = std::max(0., std::ceil((ymin - oy) / cell - 0.5));
+            double row_to   = std::min(max_row, std::ceil((ymax - oy) / cell - 0.5) - 1.);
+            for (double r = row_from; r <= row_to; r += 1.) {
+                double y = oy + (r + 0.5) * cell;
+                double x = a.x() + (y - a.y()) * double(b.x() - a.x()) / double(b.y() - a.y());
+                crossings[size_t(r)].emplace_back(x);
+            }
+        }
+    }
+
+    for (size_t row = 0; row < m_rows; ++row) {
+        std::vector<double> &xs = crossings[row];
+        std::sort(xs.begin(), xs.end());
+        for (size_t i = 0; i + 1 < xs.size(); i += 2) {
+            double col_from = std::max(0., std::ceil((xs[i] - ox) / cell - 0.5));
+            double col_to   = std::min(max_col, std::floor((xs[i + 1] - ox) / cell - 0.5));
+            if (col_from <= col_to)
+                set_span(row, size_t(col_from), size_t(col_to));
+        }
+    }
+}
+
+bool RasterGrid::overlaps(const RasterGrid &mask, const Position &pos) const
+{
+    assert(pos.x() + mask.m_cols <= m_cols && pos.y() + mask.m_rows <= m_rows);
+
+    size_t mask_words = mask.m_row_words - 1;
+    for (size_t r = 0; r < mask.m_rows; ++r) {
+        const Word *mask_row = mask.row_data(r);
+        for (size_t w = 0; w < mask_words; ++w)
+            if (mask_row[w] && (window(pos.y() + r, pos.x() + w * WordBits) & mask_row[w]))
+                return true;
+    }
+
+    return false;
+}
+
+std::optional<RasterGrid::Position> RasterGrid::find_bottom_left(const RasterGrid &mask) const
+{
+    if (empty() || mask.empty() || mask.m_cols > m_cols || mask.m_rows > m_rows)
+        return {};
+
+    constexpr size_t NotFound = std::numeric_limits<size_t>::max();
+    const size_t row_cnt = m_rows - mask.m_rows + 1;
+    const size_t col_cnt = m_cols - mask.m_cols + 1;
+
+    // The rows are searched in parallel in batches, the first batch with
+    // a free spot contains the lowest one.
+    const size_t batch = 4 * execution::max_concurrency(ex_tbb);
+    std::vector<size_t> found_cols(batch);
+    for (size_t from = 0; from < row_cnt; from += batch) {
+        size_t to = std::min(from + batch, row_cnt);
+        execution::for_each(ex_tbb, from, to, [&](size_t row) {
+            size_t &found = found_cols[row - from];
+            found = NotFound;
+            for (size_t col = 0; col < col_cnt && found == NotFound; ++col)
+                if (!overlaps(mask, Position{col, row}))
+                    found = col;
+        }, 1);
+
+        for (size_t row = from; row < to; ++row)
+            if (found_cols[row - from] != NotFound)
+                return Position{found_cols[row - from], row};
+    }
+
+    return {};
+}
+
+}} // namespace Slic3r::arr2
@@ -0,0 +1,94 @@
+///|/ Copyright (c) Prusa Research 2023 Tomáš Mészáros @tamasmeszaros
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef RASTERGRID_HPP
+#define RASTERGRID_HPP
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/BoundingBox.hpp>
+
+namespace Slic3r { namespace arr2 {
+
+// Occupancy bitmap with square cells. The cells of a row are packed into
+// 64 bit words, so that the overlap of an item mask with the grid at an
+// arbitrary position is tested a whole word at a time.
+//
+// Rasterization is conservative: every cell touched by a polygon is marked
+// as occupied, so items placed on free cells never collide.
+class RasterGrid {
+public:
+    using Word = uint64_t;
+    static constexpr size_t WordBits = 64;
+
+    // Position of a mask in the grid (column, row)
+    using Position = Vec<2, size_t>;
+
+    RasterGrid() = default;
+
+    // Grid with all cells free covering bb, the origin is bb.min
+    RasterGrid(const BoundingBox &bb, coord_t cell_size);
+
+    // Grid of a bed: cells not fully inside the bed are occupied.
+    // With zero cell_size, the cell size is derived from the bed size.
+    static RasterGrid create_bed_grid(const ExPolygons &bed, coord_t cell_size = 0);
+
+    // Mask of an outline with the given cell size
+    static RasterGrid create_mask(const Polygons &outline, coord_t cell_size);
+
+    const Vec2crd &origin() const noexcept { return m_origin; }
+    coord_t cell_size() const noexcept { return m_cell; }
+    size_t cols() const noexcept { return m_cols; }
+    size_t rows() const noexcept { return m_rows; }
+    bool empty() const noexcept { return m_cols == 0 || m_rows == 0; }
+
+    bool is_occupied(size_t col, size_t row) const
+    {
+        return (row_data(row)[col / WordBits] >> (col % WordBits)) & Word(1);
+    }
+
+    // Mark all cells touched by the polygons as occupied
+    void fill(const Polygons &polys);
+    void fill(const ExPolygons &expolys) { fill(to_polygons(expolys)); }
+
+    // True if the mask placed with its first cell at pos hits an occupied
+    // cell. The mask has to fit into the grid at pos.
+    bool overlaps(const RasterGrid &mask, const Position &pos) const;
+
+    // Lowest row, then leftmost column where the mask fits on free cells
+    std::optional<Position> find_bottom_left(const RasterGrid &mask) const;
+
+    // Coordinates of the cell corner at pos
+    Vec2crd coords(const Position &pos) const
+    {
+        return m_origin + Vec2crd{coord_t(pos.x()) * m_cell, coord_t(pos.y()) * m_cell};
+    }
+
+private:
+    // Each row has one extra zero word, so that a window of bits starting
+    // anywhere inside of the row can be read without bound checks.
+    const Word *row_data(size_t row) const { return m_words.data() + row * m_row_words; }
+    Word *row_data(size_t row) { return m_words.data() + row * m_row_words; }
+
+    Word window(size_t row, size_t bit) const
+    {
+        const Word *data = row_data(row) + bit / WordBits;
+        size_t shift = bit % WordBits;
+        return shift == 0 ? data[0] : (data[0] >> shift) | (data[1] << (WordBits - shift));
+    }
+
+    void set_span(size_t row, size_t col_from, size_t col_to);
+
+    Vec2crd m_origin = Vec2crd::Zero();
+    coord_t m_cell = 1;
+    size_t m_cols = 0, m_rows = 0, m_row_words = 0;
+    std::vector<Word> m_words;
+};
+
+}} // namespace Slic3r::arr2
+
+#endif // RASTERGRID_HPP
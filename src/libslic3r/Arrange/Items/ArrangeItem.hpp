@@ -26,6 +26,10 @@
 #include "libslic3r/Arrange/Items/ArbitraryDataStore.hpp"
 
 #include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
 
 namespace Slic3r { namespace arr2 {
 
@@ -286,57 +290,116 @@ static Polygons calculate_nfp_unnormalized(const ArrangeItem    &item,
                                            const Range<FixedIt> &fixed_items,
                                            StopCond &&stop_cond = {})
 {
-    size_t cap = 0;
-
-    for (const ArrangeItem &fixitem : fixed_items) {
-        const Polygons &outlines = fixitem.shape().transformed_outline();
-        cap += outlines.size();
-    }
-
     const Polygons &item_outlines = item.envelope().transformed_outline();
 
-    auto nfps = reserve_polygons(cap * item_outlines.size());
-
     Vec2crd ref_whole = item.envelope().reference_vertex();
-    Polygon subnfp;
+
+    // The caches of the item are not thread safe, they are filled here.
+    std::vector<Vec2crd> mrefs, min_movables;
+    mrefs.reserve(item_outlines.size());
+    min_movables.reserve(item_outlines.size());
+    for (size_t mi = 0; mi < item_outlines.size(); ++mi) {
+        mrefs.emplace_back(item.envelope().reference_vertex(mi));
+        min_movables.emplace_back(item.envelope().min_vertex(mi));
+    }
+
+    // The fixed polygons moved to their reference vertex. The nfp of a
+    // convex pair moves with the fixed polygon, so the repeated shapes, like
+    // the instances of the same object, share their nfps.
+    struct FixedPoly { size_t shape_id; Vec2crd ref; };
+    std::vector<Polygon>   shapes;
+    std::vector<FixedPoly> fixed_polys;
+    std::vector<size_t>    fixed_item_ends;
+    std::unordered_multimap<size_t, size_t> shape_ids;
 
     for (const ArrangeItem &fixed : fixed_items) {
         // fixed_polys should already be a set of strictly convex polygons,
         // as ArrangeItem stores convex-decomposed polygons
-        const Polygons & fixed_polys = fixed.shape().transformed_outline();
-
-        for (const Polygon &fixed_poly : fixed_polys) {
-            Point max_fixed = Slic3r::reference_vertex(fixed_poly);
-            for (size_t mi = 0; mi < item_outlines.size(); ++mi) {
-                const Polygon &movable = item_outlines[mi];
-                const Vec2crd &mref = item.envelope().reference_vertex(mi);
-                subnfp = nfp_convex_convex_legacy(fixed_poly, movable);
+        for (const Polygon &fixed_poly : fixed.shape().transformed_outline()) {
+            Vec2crd max_fixed = Slic3r::reference_vertex(fixed_poly);
+            Polygon shape = fixed_poly;
+            shape.translate(-max_fixed);
+
+            size_t hash = 0;
+            for (const Point &p : shape.points) {
+                boost::hash_combine(hash, p.x());
+                boost::hash_combine(hash, p.y());
+            }
 
-                Vec2crd min_movable = item.envelope().min_vertex(mi);
+            auto [from, to] = shape_ids.equal_range(hash);
+            auto it = std::find_if(from, to, [&shapes, &shape](const auto &id) {
+                return shapes[id.second].points == shape.points;
+            });
 
-                Vec2crd dtouch = max_fixed - min_movable;
-                Vec2crd top_other = mref + dtouch;
-                Vec2crd max_nfp = Slic3r::reference_vertex(subnfp);
-                auto dnfp = top_other - max_nfp;
+            size_t shape_id = shapes.size();
+            if (it == to) {
+                shape_ids.emplace(hash, shape_id);
+                shapes.emplace_back(std::move(shape));
+            } else {
+                shape_id = it->second;
+            }
 
-                auto d = ref_whole - mref + dnfp;
-                subnfp.translate(d);
-                nfps.emplace_back(subnfp);
+            fixed_polys.push_back({shape_id, max_fixed});
+        }
+        fixed_item_ends.emplace_back(fixed_polys.size());
+    }
+
+    // The nfps of the shapes with the movable outlines, placed as if the
+    // reference vertex of the fixed shape was at the origin.
+    std::vector<Polygon> shape_nfps(shapes.size() * item_outlines.size());
+    execution::for_each(ex_tbb, size_t(0), shape_nfps.size(), [&](size_t i) {
+        if (stop_cond())
+            return;
+
+        size_t mi = i % item_outlines.size();
+        const Polygon &movable = item_outlines[mi];
+        const Vec2crd &mref = mrefs[mi];
+        Polygon subnfp = nfp_convex_convex_legacy(shapes[i / item_outlines.size()], movable);
+
+        Vec2crd dtouch = -min_movables[mi];
+        Vec2crd top_other = mref + dtouch;
+        Vec2crd max_nfp = Slic3r::reference_vertex(subnfp);
+        auto dnfp = top_other - max_nfp;
+
+        auto d = ref_whole - mref + dnfp;
+        subnfp.translate(d);
+        shape_nfps[i] = std::move(subnfp);
+    }, execution::max_concurrency(ex_tbb));
+
+    // The nfps of the fixed items are merged in parallel in chunks, which
+    // are then merged together.
+    size_t chunk_cnt = std::min(fixed_item_ends.size(), 4 * execution::max_concurrency(ex_tbb));
+    std::vector<Polygons> chunk_nfps(chunk_cnt);
+    execution::for_each(ex_tbb, size_t(0), chunk_cnt, [&](size_t chunk_id) {
+        if (stop_cond())
+            return;
+
+        size_t from = chunk_id * fixed_item_ends.size() / chunk_cnt;
+        size_t to   = (chunk_id + 1) * fixed_item_ends.size() / chunk_cnt;
+        size_t pfrom = from == 0 ? 0 : fixed_item_ends[from - 1];
+        size_t pto   = to == 0 ? 0 : fixed_item_ends[to - 1];
+
+        Polygons &nfps = chunk_nfps[chunk_id];
+        nfps.reserve((pto - pfrom) * item_outlines.size());
+        for (size_t pi = pfrom; pi < pto; ++pi) {
+            const FixedPoly &fp = fixed_polys[pi];
+            for (size_t mi = 0; mi < item_outlines.size(); ++mi) {
+                nfps.emplace_back(shape_nfps[fp.shape_id * item_outlines.size() + mi]);
+                nfps.back().translate(fp.ref);
             }
+        }
 
-            if (stop_cond())
-                break;
+        nfps = union_(nfps);
+    }, 1);
 
-            nfps = union_(nfps);
-        }
+    if (stop_cond())
+        return {};
 
-        if (stop_cond()) {
-            nfps.clear();
-            break;
-        }
-    }
+    Polygons nfps;
+    for (Polygons &chunk : chunk_nfps)
+        append(nfps, std::move(chunk));
 
-    return nfps;
+    return chunk_cnt > 1 ? union_(nfps) : nfps;
 }
 
 template<> struct NFPArrangeItemTraits_<ArrangeItem> {
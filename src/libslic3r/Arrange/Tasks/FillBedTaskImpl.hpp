@@ -9,6 +9,9 @@
 
 #include "Arrange/Core/NFP/NFPArrangeItemTraits.hpp"
 
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/Execution/ExecutionTBB.hpp"
+
 #include <boost/log/trivial.hpp>
 
 namespace Slic3r { namespace arr2 {
@@ -127,6 +130,161 @@ void extract(FillBedTask<ArrItem> &task,
 }
 
 
+// Regular lattice of the bounding boxes of an item covering the bed.
+struct FillBedLattice
+{
+    double rotation = 0.;
+
+    // Bottom left corners of the cells usable for a copy of the item
+    std::vector<Vec2crd> cells;
+
+    // Number of the cells colliding with the bed boundary or the fixed items
+    size_t rejected = 0;
+};
+
+template<class ArrItem>
+FillBedLattice create_fill_bed_lattice(const ExPolygons &bed_shape,
+                                       const ArrItem &prototype,
+                                       double rotation,
+                                       const std::vector<ArrItem> &fixed)
+{
+    FillBedLattice ret;
+    ret.rotation = rotation;
+
+    ArrItem itm = prototype;
+    rotate(itm, rotation);
+    Polygons outline = fixed_outline(itm);
+    BoundingBox itmbb = get_extents(outline);
+    BoundingBox bedbb = get_extents(bed_shape);
+    Vec2crd d = itmbb.size();
+    if (!itmbb.defined || !bedbb.defined || d.x() <= 0 || d.y() <= 0)
+        return ret;
+
+    coord_t nx = bedbb.size().x() / d.x();
+    coord_t ny = bedbb.size().y() / d.y();
+    if (nx == 0 || ny == 0)
+        return ret;
+
+    // Center the lattice on the bed
+    Vec2crd start = bedbb.min + (bedbb.size() - Vec2crd{nx * d.x(), ny * d.y()}) / 2;
+
+    // The cells of a rectangular bed are inside of it by construction
+    bool is_rect_bed = bed_shape.size() == 1 && bed_shape.front().holes.empty() &&
+                       bed_shape.front().contour.size() == 4 &&
+                       std::abs(bed_shape.front().area() - area(bedbb)) < SCALED_EPSILON;
+
+    struct Obstacle { BoundingBox bb; Polygons outline; };
+    std::vector<Obstacle> obstacles;
+    for (const ArrItem &fixed_itm : fixed)
+        if (get_bed_index(fixed_itm) == PhysicalBedId)
+            obstacles.push_back({fixed_bounding_box(fixed_itm), fixed_outline(fixed_itm)});
+
+    // The cells are independent, validate them in parallel
+    std::vector<char> usable(size_t(nx * ny), false);
+    execution::for_each(ex_tbb, size_t(0), usable.size(), [&](size_t i) {
+        Vec2crd cellmin = start + Vec2crd{coord_t(i % nx) * d.x(), coord_t(i / nx) * d.y()};
+        BoundingBox cellbb{cellmin, cellmin + d};
+        Polygons placed = outline;
+        for (Polygon &p : placed)
+            p.translate(cellmin - itmbb.min);
+
+        if (!is_rect_bed && !diff(placed, bed_shape).empty())
+            return;
+
+        for (const Obstacle &obstacle : obstacles)
+            if (obstacle.bb.overlap(cellbb) && !intersection(placed, obstacle.outline).empty())
+                return;
+
+        usable[i] = true;
+    }, 16);
+
+    for (size_t i = 0; i < usable.size(); ++i) {
+        if (usable[i])
+            ret.cells.emplace_back(start + Vec2crd{coord_t(i % nx) * d.x(), coord_t(i / nx) * d.y()});
+        else
+            ++ret.rejected;
+    }
+
+    return ret;
+}
+
+// Outline of the item moved to the origin, to compare the shape of items
+template<class ArrItem> Polygons normalized_outline(const ArrItem &itm)
+{
+    Polygons ret = fixed_outline(itm);
+    Vec2crd d = -get_extents(ret).min;
+    for (Polygon &p : ret)
+        p.translate(d);
+
+    return ret;
+}
+
+// With a lot of copies to add, the arranger would place them one by one,
+// each against all the already packed items. As all the copies have the
+// same shape, most of the bed is covered by a regular lattice instead, the
+// arranger is then used only for the rest. Returns the number of items at
+// the front of task.selected which are placed onto the lattice.
+template<class ArrItem>
+size_t place_on_lattice(FillBedTask<ArrItem> &task)
+{
+    // Below this count of new copies, the arranger is fast enough and the
+    // result is denser
+    constexpr size_t LatticeItemCount = 50;
+
+    size_t new_count = (task.selected.size() - task.selected_existing_count) / 2;
+    if (!task.prototype_item || new_count < LatticeItemCount)
+        return 0;
+
+    ExPolygons bed_shape;
+    visit_bed([&bed_shape](auto &rawbed) {
+        if constexpr (!std::is_convertible_v<decltype(rawbed), InfiniteBed>)
+            bed_shape = to_expolygons(rawbed);
+    }, task.bed);
+
+    if (bed_shape.empty())
+        return 0;
+
+    // The existing copies are rearranged along with the new ones, which is
+    // possible only if they are all of the same shape
+    Polygons shape = normalized_outline(*task.prototype_item);
+    for (size_t i = 0; i < task.selected_existing_count; ++i) {
+        Polygons itmshape = normalized_outline(task.selected[i]);
+        if (itmshape.size() != shape.size() ||
+            !std::equal(itmshape.begin(), itmshape.end(), shape.begin(),
+                        [](const Polygon &a, const Polygon &b) { return a.points == b.points; }))
+            return 0;
+    }
+
+    FillBedLattice lattice = create_fill_bed_lattice(bed_shape, *task.prototype_item, 0., task.unselected);
+    if (task.settings.is_rotation_enabled()) {
+        FillBedLattice rotated = create_fill_bed_lattice(bed_shape, *task.prototype_item, PI / 2., task.unselected);
+        if (rotated.cells.size() > lattice.cells.size())
+            lattice = std::move(rotated);
+    }
+
+    size_t copy_count = task.selected_existing_count + new_count;
+    if (lattice.cells.size() < std::max(task.selected_existing_count, size_t(1)))
+        return 0;
+
+    size_t placed = std::min(lattice.cells.size(), copy_count);
+    for (size_t i = 0; i < placed; ++i) {
+        ArrItem &itm = task.selected[i];
+        rotate(itm, lattice.rotation);
+        translate(itm, lattice.cells[i] - fixed_bounding_box(itm).min);
+        set_bed_index(itm, PhysicalBedId);
+    }
+
+    // Only the rejected cells, at the bed boundary or around the fixed
+    // items, may have some room left for the arranger.
+    size_t rest   = std::min(copy_count - placed, lattice.rejected);
+    size_t filler = std::min(new_count, lattice.rejected);
+    auto filler_begin = task.selected.begin() + copy_count;
+    task.selected.erase(filler_begin + filler, task.selected.end());
+    task.selected.erase(task.selected.begin() + placed + rest, filler_begin);
+
+    return placed;
+}
+
 template<class ArrItem>
 std::unique_ptr<FillBedTask<ArrItem>> FillBedTask<ArrItem>::create(
     const Scene &sc, const ArrangeableToItemConverter<ArrItem> &converter)
@@ -182,7 +340,19 @@ std::unique_ptr<FillBedTaskResult> FillBedTask<ArrItem>::process_native(
 
     auto arranger = Arranger<ArrItem>::create(settings);
 
-    arranger->arrange(selected, unselected, bed, subctl);
+    size_t lattice_count = place_on_lattice(*this);
+    if (lattice_count > 0) {
+        // The copies on the lattice are fixed for the arrangement of the rest
+        std::vector<ArrItem> fixed = unselected;
+        fixed.insert(fixed.end(), selected.begin(), selected.begin() + lattice_count);
+        std::vector<ArrItem> rest(selected.begin() + lattice_count, selected.end());
+
+        arranger->arrange(rest, fixed, bed, subctl);
+
+        std::move(rest.begin(), rest.end(), selected.begin() + lattice_count);
+    } else {
+        arranger->arrange(selected, unselected, bed, subctl);
+    }
 
     auto arranged_range = Range{selected.begin(),
                                 selected.begin() + selected_existing_count};
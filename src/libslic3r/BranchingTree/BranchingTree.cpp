@@ -13,12 +13,51 @@
 
 namespace Slic3r { namespace branchingtree {
 
+// The candidate branch from node to the leaf or junction closest_node_id, if
+// there is any.
+static std::optional<Builder::Branch> make_branch(const PointCloud &nodes,
+                                                  const Node       &node,
+                                                  size_t            closest_node_id)
+{
+    std::optional<Builder::Branch> ret;
+
+    auto type = nodes.get_type(closest_node_id);
+    if (type != LEAF && type != JUNCTION)
+        return ret;
+
+    Node closest_node = nodes.get(closest_node_id);
+    closest_node.Rmin = std::max(node.Rmin, closest_node.Rmin);
+
+    auto max_slope = float(nodes.properties().max_slope());
+
+    if (auto mergept = find_merge_pt(node.pos, closest_node.pos, max_slope)) {
+
+        float mergedist_closest = (*mergept - closest_node.pos).norm();
+        float mergedist_node = (*mergept - node.pos).norm();
+        float Wsum = std::max(node.weight, closest_node.weight);
+        float distsum = std::max(mergedist_closest, mergedist_node);
+        float w = Wsum + distsum;
+
+        if (mergedist_closest > EPSILON && mergedist_node > EPSILON) {
+            Node mergenode{*mergept, closest_node.Rmin};
+            mergenode.weight = w;
+            ret = Builder::Branch{node, closest_node, mergenode};
+        } else if (closest_node.pos.z() < node.pos.z() &&
+                   (closest_node.left == Node::ID_NONE ||
+                    closest_node.right == Node::ID_NONE)) {
+            closest_node.weight = w;
+            ret = Builder::Branch{node, closest_node, {}};
+        }
+    }
+
+    return ret;
+}
+
 void build_tree(PointCloud &nodes, Builder &builder)
 {
     constexpr size_t initK = 5;
 
     auto ptsqueue = nodes.start_queue();
-    auto &properties = nodes.properties();
 
     struct NodeDistance
     {
@@ -67,6 +106,19 @@ void build_tree(PointCloud &nodes, Builder &builder)
         prev_dist_max = dmax;
         K *= 2;
 
+        // The branches to the closest leafs and junctions are checked by the
+        // builder in one batch, only the ones passing are tried in order.
+        constexpr size_t NoBranch = size_t(-1);
+        auto branches   = reserve_vector<Builder::Branch>(distances.size());
+        auto branch_ids = std::vector<size_t>(distances.size(), NoBranch);
+        for (size_t i = 0; i < distances.size(); ++i)
+            if (auto branch = make_branch(nodes, node, distances[i].node_id)) {
+                branch_ids[i] = branches.size();
+                branches.emplace_back(std::move(*branch));
+            }
+
+        std::vector<bool> branch_ok = builder.check_branches(branches);
+
         auto closest_it = distances.begin();
         routed = false;
         while (closest_it != distances.end() && !routed && builder.is_valid()) {
@@ -113,47 +165,36 @@ void build_tree(PointCloud &nodes, Builder &builder)
             }
             case LEAF:
             case JUNCTION: {
-                auto max_slope = float(properties.max_slope());
-
-                if (auto mergept = find_merge_pt(node.pos, closest_node.pos, max_slope)) {
-
-                    float mergedist_closest = (*mergept - closest_node.pos).norm();
-                    float mergedist_node = (*mergept - node.pos).norm();
-                    float Wnode = nodes.get(node_id).weight;
-                    float Wclosest = nodes.get(closest_node_id).weight;
-                    float Wsum = std::max(Wnode, Wclosest);
-                    float distsum = std::max(mergedist_closest, mergedist_node);
-                    w = Wsum + distsum;
-
-                    if (mergedist_closest > EPSILON && mergedist_node > EPSILON) {
-                        Node mergenode{*mergept, closest_node.Rmin};
-                        mergenode.weight = w;
-                        mergenode.id = int(nodes.next_junction_id());
-
-                        if ((routed = builder.add_merger(node, closest_node, mergenode))) {
-                            mergenode.left = node_id;
-                            mergenode.right = closest_node_id;
-                            size_t new_idx = nodes.insert_junction(mergenode);
-                            ptsqueue.push(new_idx);
-                            size_t qid = nodes.get_queue_idx(closest_node_id);
-
-                            if (qid != PointCloud::Unqueued)
-                                ptsqueue.remove(nodes.get_queue_idx(closest_node_id));
-
-                            nodes.mark_unreachable(closest_node_id);
-                        }
-                    } else if (closest_node.pos.z() < node.pos.z() &&
-                               (closest_node.left == Node::ID_NONE ||
-                                closest_node.right == Node::ID_NONE)) {
-                        closest_node.weight = w;
-                        if ((routed = builder.add_bridge(node, closest_node))) {
-                            if (closest_node.left == Node::ID_NONE)
-                                closest_node.left = node_id;
-                            else if (closest_node.right == Node::ID_NONE)
-                                closest_node.right = node_id;
-
-                            nodes.get(closest_node_id) = closest_node;
-                        }
+                size_t branch_id = branch_ids[closest_it - distances.begin()];
+                if (branch_id == NoBranch || !branch_ok[branch_id])
+                    break;
+
+                const Builder::Branch &branch = branches[branch_id];
+                if (branch.merge) {
+                    Node mergenode = *branch.merge;
+                    mergenode.id = int(nodes.next_junction_id());
+
+                    if ((routed = builder.add_merger(node, branch.to, mergenode))) {
+                        mergenode.left = node_id;
+                        mergenode.right = closest_node_id;
+                        size_t new_idx = nodes.insert_junction(mergenode);
+                        ptsqueue.push(new_idx);
+                        size_t qid = nodes.get_queue_idx(closest_node_id);
+
+                        if (qid != PointCloud::Unqueued)
+                            ptsqueue.remove(nodes.get_queue_idx(closest_node_id));
+
+                        nodes.mark_unreachable(closest_node_id);
+                    }
+                } else {
+                    closest_node = branch.to;
+                    if ((routed = builder.add_bridge(node, closest_node))) {
+                        if (closest_node.left == Node::ID_NONE)
+                            closest_node.left = node_id;
+                        else if (closest_node.right == Node::ID_NONE)
+                            closest_node.right = node_id;
+
+                        nodes.get(closest_node_id) = closest_node;
                     }
                 }
 
@@ -5,6 +5,8 @@
 #ifndef SUPPORTTREEBRANCHING_HPP
 #define SUPPORTTREEBRANCHING_HPP
 
+#include <optional>
+
 // For indexed_triangle_set
 #include <admesh/stl.h>
 
@@ -93,6 +95,14 @@ class Builder
 public:
     virtual ~Builder() = default;
 
+    // A candidate branch from node 'from' either directly to 'to' or, if
+    // 'merge' is set, merged with 'to' into the merge node.
+    struct Branch
+    {
+        Node from, to;
+        std::optional<Node> merge;
+    };
+
     // A simple bridge from junction to junction.
     virtual bool add_bridge(const Node &from, const Node &to) = 0;
 
@@ -115,6 +125,14 @@ public:
         return {};
     }
 
+    // Check a batch of candidate branches ahead of trying them one by one with
+    // add_bridge() or add_merger(), possibly in parallel. Returns false for
+    // each branch which would be rejected by add_bridge() or add_merger().
+    virtual std::vector<bool> check_branches(const std::vector<Branch> &branches)
+    {
+        return std::vector<bool>(branches.size(), true);
+    }
+
     // Report nodes that can not be routed to an endpoint (model or ground)
     virtual void report_unroutable(const Node &j) = 0;
 
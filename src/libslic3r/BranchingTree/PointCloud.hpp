@@ -195,6 +195,12 @@ public:
     {
         assert(node_id < m_searchable_indices.size());
 
+        // Remove the consumed point from the index, otherwise the nearest
+        // neighbour queries have to filter out more and more of them as the
+        // tree grows.
+        if (m_searchable_indices[node_id])
+            m_ktree.remove(PointIndexEl{get(node_id).pos, unsigned(node_id)});
+
         m_searchable_indices[node_id] = false;
         m_queue_indices[node_id] = Unqueued;
         --m_reachable_cnt;
@@ -9,6 +9,8 @@
 #include "Geometry.hpp"
 #include <algorithm>
 
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 BridgeDetector::BridgeDetector(
@@ -102,54 +104,56 @@ bool BridgeDetector::detect_angle(double bridge_direction_override)
         bridge in several directions and then sum the length of lines having both
         endpoints within anchors */
         
-    bool have_coverage = false;
-    for (size_t i_angle = 0; i_angle < candidates.size(); ++ i_angle)
-    {
-        const double angle = candidates[i_angle].angle;
+    // The candidate angles are evaluated independently, in parallel.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, candidates.size()), [this, &candidates, &clip_area](const tbb::blocked_range<size_t> &range) {
+        for (size_t i_angle = range.begin(); i_angle < range.end(); ++ i_angle) {
+            const double angle = candidates[i_angle].angle;
 
-        Lines lines;
-        {
-            // Get an oriented bounding box around _anchor_regions.
-            BoundingBox bbox = get_extents_rotated(this->_anchor_regions, - angle);
-            // Cover the region with line segments.
-            lines.reserve((bbox.max(1) - bbox.min(1) + this->spacing) / this->spacing);
-            double s = sin(angle);
-            double c = cos(angle);
-            //FIXME Vojtech: The lines shall be spaced half the line width from the edge, but then 
-            // some of the test cases fail. Need to adjust the test cases then?
+            Lines lines;
+            {
+                // Get an oriented bounding box around _anchor_regions.
+                BoundingBox bbox = get_extents_rotated(this->_anchor_regions, - angle);
+                // Cover the region with line segments.
+                lines.reserve((bbox.max(1) - bbox.min(1) + this->spacing) / this->spacing);
+                double s = sin(angle);
+                double c = cos(angle);
+                //FIXME Vojtech: The lines shall be spaced half the line width from the edge, but then 
+                // some of the test cases fail. Need to adjust the test cases then?
 //            for (coord_t y = bbox.min(1) + this->spacing / 2; y <= bbox.max(1); y += this->spacing)
-            for (coord_t y = bbox.min(1); y <= bbox.max(1); y += this->spacing)
-                lines.push_back(Line(
-                    Point((coord_t)round(c * bbox.min(0) - s * y), (coord_t)round(c * y + s * bbox.min(0))),
-                    Point((coord_t)round(c * bbox.max(0) - s * y), (coord_t)round(c * y + s * bbox.max(0)))));
-        }
+                for (coord_t y = bbox.min(1); y <= bbox.max(1); y += this->spacing)
+                    lines.push_back(Line(
+                        Point((coord_t)round(c * bbox.min(0) - s * y), (coord_t)round(c * y + s * bbox.min(0))),
+                        Point((coord_t)round(c * bbox.max(0) - s * y), (coord_t)round(c * y + s * bbox.max(0)))));
+            }
 
-        double total_length = 0;
-        double max_length = 0;
-        {
-            Lines clipped_lines = intersection_ln(lines, clip_area);
-            for (size_t i = 0; i < clipped_lines.size(); ++i) {
-                const Line &line = clipped_lines[i];
-                if (expolygons_contain(this->_anchor_regions, line.a) && expolygons_contain(this->_anchor_regions, line.b)) {
-                    // This line could be anchored.
-                    double len = line.length();
-                    total_length += len;
-                    max_length = std::max(max_length, len);
-                }
-            }        
+            double total_length = 0;
+            double max_length = 0;
+            {
+                Lines clipped_lines = intersection_ln(lines, clip_area);
+                for (size_t i = 0; i < clipped_lines.size(); ++i) {
+                    const Line &line = clipped_lines[i];
+                    if (expolygons_contain(this->_anchor_regions, line.a) && expolygons_contain(this->_anchor_regions, line.b)) {
+                        // This line could be anchored.
+                        double len = line.length();
+                        total_length += len;
+                        max_length = std::max(max_length, len);
+                    }
+                }        
+            }
+            if (total_length == 0.)
+                continue;
+
+            // Sum length of bridged lines.
+            candidates[i_angle].coverage = total_length;
+            /*  The following produces more correct results in some cases and more broken in others.
+                TODO: investigate, as it looks more reliable than line clipping. */
+            // $directions_coverage{$angle} = sum(map $_->area, @{$self->coverage($angle)}) // 0;
+            // max length of bridged lines
+            candidates[i_angle].max_length = max_length;
         }
-        if (total_length == 0.)
-            continue;
-
-        have_coverage = true;
-        // Sum length of bridged lines.
-        candidates[i_angle].coverage = total_length;
-        /*  The following produces more correct results in some cases and more broken in others.
-            TODO: investigate, as it looks more reliable than line clipping. */
-        // $directions_coverage{$angle} = sum(map $_->area, @{$self->coverage($angle)}) // 0;
-        // max length of bridged lines
-        candidates[i_angle].max_length = max_length;
-    }
+    });
+
+    bool have_coverage = std::any_of(candidates.begin(), candidates.end(), [](const BridgeDirection &candidate) { return candidate.coverage > 0.; });
 
     // if no direction produced coverage, then there's no bridge direction
     if (! have_coverage)
@@ -384,4 +388,79 @@ BridgeDetector::unsupported_edges(double angle) const
     return pp;
 }
 
+//return ideal bridge direction and unsupported bridge endpoints distance.
+std::tuple<Vec2d, double> detect_bridging_direction(const Lines &floating_edges, const Polygons &overhang_area)
+{
+    if (floating_edges.empty()) {
+        // consider this area anchored from all sides, pick bridging direction that will likely yield shortest bridges
+        auto [pc1, pc2] = compute_principal_components(overhang_area);
+        if (pc2 == Vec2f::Zero()) { // overhang may be smaller than resolution. In this case, any direction is ok
+            return {Vec2d{1.0,0.0}, 0.0};
+        } else {
+            return {pc2.normalized().cast<double>(), 0.0};
+        }
+    }
+
+    // Overhang is not fully surrounded by anchors, in that case, find such direction that will minimize the number of bridge ends/180turns in the air
+    std::unordered_map<double, Vec2d> directions{};
+    for (const Line &l : floating_edges) {
+        Vec2d normal = l.normal().cast<double>().normalized();
+        double quantized_angle = std::ceil(std::atan2(normal.y(),normal.x()) * 1000.0);
+        directions.emplace(quantized_angle, normal);
+    }
+    std::vector<std::pair<Vec2d, double>> direction_costs{};
+    // it is acutally cost of a perpendicular bridge direction - we find the minimal cost and then return the perpendicular dir
+    for (const auto& d : directions) {
+        direction_costs.emplace_back(d.second, 0.0);
+    }
+
+    // The edge vectors are stored by coordinates, a block of directions is scored in a single pass over the edges.
+    // Each cost is still summed in the order of the edges, the accumulators of a block are independent and vectorize.
+    std::vector<double> edge_x, edge_y;
+    edge_x.reserve(floating_edges.size());
+    edge_y.reserve(floating_edges.size());
+    for (const Line &l : floating_edges) {
+        edge_x.emplace_back(double(l.b.x() - l.a.x()));
+        edge_y.emplace_back(double(l.b.y() - l.a.y()));
+    }
+    static constexpr const size_t block_size = 4;
+    auto score_block = [&edge_x, &edge_y, &direction_costs](size_t first) {
+        const size_t num = std::min(block_size, direction_costs.size() - first);
+        double dx[block_size] = { 0. }, dy[block_size] = { 0. }, cost[block_size] = { 0. };
+        for (size_t i = 0; i < num; ++ i) {
+            dx[i] = direction_costs[first + i].first.x();
+            dy[i] = direction_costs[first + i].first.y();
+        }
+        for (size_t j = 0; j < edge_x.size(); ++ j)
+            for (size_t i = 0; i < block_size; ++ i)
+                // the dot product already contains the length of the line. the direction is normalized.
+                cost[i] += std::abs(edge_x[j] * dx[i] + edge_y[j] * dy[i]);
+        for (size_t i = 0; i < num; ++ i)
+            direction_costs[first + i].second = cost[i];
+    };
+    const size_t num_blocks = (direction_costs.size() + block_size - 1) / block_size;
+    if (direction_costs.size() * edge_x.size() < 65536) {
+        for (size_t block = 0; block < num_blocks; ++ block)
+            score_block(block * block_size);
+    } else {
+        // Large overhang: Score the blocks of directions in parallel.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks), [&score_block](const tbb::blocked_range<size_t> &range) {
+            for (size_t block = range.begin(); block < range.end(); ++ block)
+                score_block(block * block_size);
+        });
+    }
+
+    Vec2d  result_dir = Vec2d::Ones();
+    double min_cost   = std::numeric_limits<double>::max();
+    for (const auto &cost : direction_costs) {
+        if (cost.second < min_cost) {
+            // now flip the orientation back and return the direction of the bridge extrusions
+            result_dir = Vec2d{cost.first.y(), -cost.first.x()};
+            min_cost   = cost.second;
+        }
+    }
+
+    return {result_dir, min_cost};
+}
+
 }
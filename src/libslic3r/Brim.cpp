@@ -136,25 +136,32 @@ static ConstPrintObjectPtrs get_top_level_objects_with_brim(const Print &print,
 
 static Polygons top_level_outer_brim_islands(const ConstPrintObjectPtrs &top_level_objects_with_brim, const double scaled_resolution)
 {
-    Polygons islands;
-    for (const PrintObject *object : top_level_objects_with_brim) {
-        if (!object->has_brim())
-            continue;
-
-        //FIXME how about the brim type?
-        auto     brim_separation = float(scale_(object->config().brim_separation.value));
-        Polygons islands_object;
-        for (const ExPolygon &ex_poly : get_print_object_bottom_layer_expolygons(*object)) {
-            Polygons contour_offset = offset(ex_poly.contour, brim_separation, ClipperLib::jtSquare);
-            for (Polygon &poly : contour_offset)
-                poly.douglas_peucker(scaled_resolution);
-
-            polygons_append(islands_object, std::move(contour_offset));
-        }
+    // Offset the islands of each object once in parallel, the instances share them by translation.
+    std::vector<Polygons> islands_objects(top_level_objects_with_brim.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, top_level_objects_with_brim.size()),
+        [&top_level_objects_with_brim, &islands_objects, scaled_resolution](const tbb::blocked_range<size_t> &range) {
+            for (size_t object_idx = range.begin(); object_idx < range.end(); ++ object_idx) {
+                const PrintObject *object = top_level_objects_with_brim[object_idx];
+                if (!object->has_brim())
+                    continue;
+
+                //FIXME how about the brim type?
+                auto      brim_separation = float(scale_(object->config().brim_separation.value));
+                Polygons &islands_object  = islands_objects[object_idx];
+                for (const ExPolygon &ex_poly : get_print_object_bottom_layer_expolygons(*object)) {
+                    Polygons contour_offset = offset(ex_poly.contour, brim_separation, ClipperLib::jtSquare);
+                    for (Polygon &poly : contour_offset)
+                        poly.douglas_peucker(scaled_resolution);
+
+                    polygons_append(islands_object, std::move(contour_offset));
+                }
+            }
+        });
 
-        for (const PrintInstance &instance : object->instances())
-            append_and_translate(islands, islands_object, instance);
-    }
+    Polygons islands;
+    for (size_t object_idx = 0; object_idx < top_level_objects_with_brim.size(); ++ object_idx)
+        for (const PrintInstance &instance : top_level_objects_with_brim[object_idx]->instances())
+            append_and_translate(islands, islands_objects[object_idx], instance);
     return islands;
 }
 
@@ -169,42 +176,49 @@ static ExPolygons top_level_outer_brim_area(const Print                   &print
     for (const PrintObject *object : top_level_objects_with_brim)
         top_level_objects_idx.insert(object->id().id);
 
+    // Areas of the individual objects are calculated in parallel, the instances share them by translation.
+    std::vector<ExPolygons> brim_area_objects(print.objects().size());
+    std::vector<ExPolygons> no_brim_area_objects(print.objects().size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print.objects().size()),
+        [&print, &bottom_layers_expolygons, &top_level_objects_idx, &brim_area_objects, &no_brim_area_objects, no_brim_offset](const tbb::blocked_range<size_t> &range) {
+            for (size_t print_object_idx = range.begin(); print_object_idx < range.end(); ++ print_object_idx) {
+                const PrintObject *object            = print.objects()[print_object_idx];
+                const BrimType     brim_type         = object->config().brim_type.value;
+                const float        brim_separation   = scale_(object->config().brim_separation.value);
+                const float        brim_width        = scale_(object->config().brim_width.value);
+                const bool         is_top_outer_brim = top_level_objects_idx.find(object->id().id) != top_level_objects_idx.end();
+
+                ExPolygons &brim_area_object    = brim_area_objects[print_object_idx];
+                ExPolygons &no_brim_area_object = no_brim_area_objects[print_object_idx];
+                for (const ExPolygon &ex_poly : bottom_layers_expolygons[print_object_idx]) {
+                    if ((brim_type == BrimType::btOuterOnly || brim_type == BrimType::btOuterAndInner) && is_top_outer_brim)
+                        append(brim_area_object, diff_ex(offset(ex_poly.contour, brim_width + brim_separation, ClipperLib::jtSquare), offset(ex_poly.contour, brim_separation, ClipperLib::jtSquare)));
+
+                    // After 7ff76d07684858fd937ef2f5d863f105a10f798e offset and shrink don't work with CW polygons (holes), so let's make it CCW.
+                    Polygons ex_poly_holes_reversed = ex_poly.holes;
+                    polygons_reverse(ex_poly_holes_reversed);
+                    if (brim_type == BrimType::btOuterOnly || brim_type == BrimType::btNoBrim)
+                        append(no_brim_area_object, shrink_ex(ex_poly_holes_reversed, no_brim_offset, ClipperLib::jtSquare));
+
+                    if (brim_type == BrimType::btInnerOnly || brim_type == BrimType::btNoBrim)
+                        append(no_brim_area_object, diff_ex(offset(ex_poly.contour, no_brim_offset, ClipperLib::jtSquare), ex_poly_holes_reversed));
+
+                    if (brim_type != BrimType::btNoBrim)
+                        append(no_brim_area_object, offset_ex(ExPolygon(ex_poly.contour), brim_separation, ClipperLib::jtSquare));
+
+                    no_brim_area_object.emplace_back(ex_poly.contour);
+                }
+            }
+        });
+
     ExPolygons brim_area;
     ExPolygons no_brim_area;
-    for(size_t print_object_idx = 0; print_object_idx < print.objects().size(); ++print_object_idx) {
-        const PrintObject *object            = print.objects()[print_object_idx];
-        const BrimType     brim_type         = object->config().brim_type.value;
-        const float        brim_separation   = scale_(object->config().brim_separation.value);
-        const float        brim_width        = scale_(object->config().brim_width.value);
-        const bool         is_top_outer_brim = top_level_objects_idx.find(object->id().id) != top_level_objects_idx.end();
-
-        ExPolygons brim_area_object;
-        ExPolygons no_brim_area_object;
-        for (const ExPolygon &ex_poly : bottom_layers_expolygons[print_object_idx]) {
-            if ((brim_type == BrimType::btOuterOnly || brim_type == BrimType::btOuterAndInner) && is_top_outer_brim)
-                append(brim_area_object, diff_ex(offset(ex_poly.contour, brim_width + brim_separation, ClipperLib::jtSquare), offset(ex_poly.contour, brim_separation, ClipperLib::jtSquare)));
-
-            // After 7ff76d07684858fd937ef2f5d863f105a10f798e offset and shrink don't work with CW polygons (holes), so let's make it CCW.
-            Polygons ex_poly_holes_reversed = ex_poly.holes;
-            polygons_reverse(ex_poly_holes_reversed);
-            if (brim_type == BrimType::btOuterOnly || brim_type == BrimType::btNoBrim)
-                append(no_brim_area_object, shrink_ex(ex_poly_holes_reversed, no_brim_offset, ClipperLib::jtSquare));
-
-            if (brim_type == BrimType::btInnerOnly || brim_type == BrimType::btNoBrim)
-                append(no_brim_area_object, diff_ex(offset(ex_poly.contour, no_brim_offset, ClipperLib::jtSquare), ex_poly_holes_reversed));
-
-            if (brim_type != BrimType::btNoBrim)
-                append(no_brim_area_object, offset_ex(ExPolygon(ex_poly.contour), brim_separation, ClipperLib::jtSquare));
-
-            no_brim_area_object.emplace_back(ex_poly.contour);
+    for (size_t print_object_idx = 0; print_object_idx < print.objects().size(); ++ print_object_idx)
+        for (const PrintInstance &instance : print.objects()[print_object_idx]->instances()) {
+            append_and_translate(brim_area, brim_area_objects[print_object_idx], instance);
+            append_and_translate(no_brim_area, no_brim_area_objects[print_object_idx], instance);
         }
 
-        for (const PrintInstance &instance : object->instances()) {
-            append_and_translate(brim_area, brim_area_object, instance);
-            append_and_translate(no_brim_area, no_brim_area_object, instance);
-        }
-    }
-
     return diff_ex(brim_area, no_brim_area);
 }
 
@@ -289,68 +303,89 @@ static std::vector<InnerBrimExPolygons> inner_brim_area(const Print
     for (const PrintObject *object : top_level_objects_with_brim)
         top_level_objects_idx.insert(object->id().id);
 
-    std::vector<ExPolygons> brim_area_innermost(print.objects().size());
-    ExPolygons              brim_area;
-    ExPolygons              no_brim_area;
-    Polygons                holes_reversed;
-
     // polygon_idx must correspond to idx generated inside has_polygons_nothing_inside()
-    size_t polygon_idx = 0;
-    for(size_t print_object_idx = 0; print_object_idx < print.objects().size(); ++print_object_idx) {
-        const PrintObject *object          = print.objects()[print_object_idx];
-        const BrimType     brim_type       = object->config().brim_type.value;
-        const float        brim_separation = scale_(object->config().brim_separation.value);
-        const float        brim_width      = scale_(object->config().brim_width.value);
-        const bool         top_outer_brim  = top_level_objects_idx.find(object->id().id) != top_level_objects_idx.end();
-
-        ExPolygons brim_area_innermost_object;
-        ExPolygons brim_area_object;
-        ExPolygons no_brim_area_object;
-        Polygons   holes_reversed_object;
-        for (const ExPolygon &ex_poly : bottom_layers_expolygons[print_object_idx]) {
-            if (brim_type == BrimType::btOuterOnly || brim_type == BrimType::btOuterAndInner) {
-                if (top_outer_brim)
-                    no_brim_area_object.emplace_back(ex_poly);
-                else
-                    append(brim_area_object, diff_ex(offset(ex_poly.contour, brim_width + brim_separation, ClipperLib::jtSquare), offset(ex_poly.contour, brim_separation, ClipperLib::jtSquare)));
-            }
+    // First polygon_idx of each object, so that the objects could be processed in parallel.
+    std::vector<size_t> polygon_idx_first(print.objects().size() + 1, 0);
+    for (size_t print_object_idx = 0; print_object_idx < print.objects().size(); ++ print_object_idx) {
+        size_t num_polygons = 0;
+        for (const ExPolygon &ex_poly : bottom_layers_expolygons[print_object_idx])
+            num_polygons += 1 + ex_poly.holes.size();
+        polygon_idx_first[print_object_idx + 1] = polygon_idx_first[print_object_idx] + num_polygons * print.objects()[print_object_idx]->instances().size();
+    }
+    assert(polygon_idx_first.back() == has_nothing_inside.size());
 
-            // After 7ff76d07684858fd937ef2f5d863f105a10f798e offset and shrink don't work with CW polygons (holes), so let's make it CCW.
-            Polygons ex_poly_holes_reversed = ex_poly.holes;
-            polygons_reverse(ex_poly_holes_reversed);
-            for ([[maybe_unused]] const PrintInstance &instance : object->instances()) {
-                ++polygon_idx; // Increase idx because of the contour of the ExPolygon.
-
-                if (brim_type == BrimType::btInnerOnly || brim_type == BrimType::btOuterAndInner)
-                    for(const Polygon &hole : ex_poly_holes_reversed) {
-                        size_t hole_idx = &hole - &ex_poly_holes_reversed.front();
-                        if (has_nothing_inside[polygon_idx + hole_idx])
-                            append(brim_area_innermost_object, shrink_ex({hole}, brim_separation, ClipperLib::jtSquare));
+    struct ObjectBrimAreas {
+        ExPolygons brim_area_innermost;
+        ExPolygons brim_area;
+        ExPolygons no_brim_area;
+        Polygons   holes_reversed;
+    };
+    std::vector<ObjectBrimAreas> object_brim_areas(print.objects().size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print.objects().size()),
+        [&print, &bottom_layers_expolygons, &top_level_objects_idx, &has_nothing_inside, &polygon_idx_first, &object_brim_areas, no_brim_offset](const tbb::blocked_range<size_t> &range) {
+            for (size_t print_object_idx = range.begin(); print_object_idx < range.end(); ++ print_object_idx) {
+                const PrintObject *object          = print.objects()[print_object_idx];
+                const BrimType     brim_type       = object->config().brim_type.value;
+                const float        brim_separation = scale_(object->config().brim_separation.value);
+                const float        brim_width      = scale_(object->config().brim_width.value);
+                const bool         top_outer_brim  = top_level_objects_idx.find(object->id().id) != top_level_objects_idx.end();
+
+                ExPolygons &brim_area_innermost_object = object_brim_areas[print_object_idx].brim_area_innermost;
+                ExPolygons &brim_area_object           = object_brim_areas[print_object_idx].brim_area;
+                ExPolygons &no_brim_area_object        = object_brim_areas[print_object_idx].no_brim_area;
+                Polygons   &holes_reversed_object      = object_brim_areas[print_object_idx].holes_reversed;
+                size_t      polygon_idx                = polygon_idx_first[print_object_idx];
+                for (const ExPolygon &ex_poly : bottom_layers_expolygons[print_object_idx]) {
+                    if (brim_type == BrimType::btOuterOnly || brim_type == BrimType::btOuterAndInner) {
+                        if (top_outer_brim)
+                            no_brim_area_object.emplace_back(ex_poly);
                         else
-                            append(brim_area_object, diff_ex(shrink_ex({hole}, brim_separation, ClipperLib::jtSquare), shrink_ex({hole}, brim_width + brim_separation, ClipperLib::jtSquare)));
+                            append(brim_area_object, diff_ex(offset(ex_poly.contour, brim_width + brim_separation, ClipperLib::jtSquare), offset(ex_poly.contour, brim_separation, ClipperLib::jtSquare)));
                     }
 
-                polygon_idx += ex_poly.holes.size(); // Increase idx for every hole of the ExPolygon.
-            }
+                    // After 7ff76d07684858fd937ef2f5d863f105a10f798e offset and shrink don't work with CW polygons (holes), so let's make it CCW.
+                    Polygons ex_poly_holes_reversed = ex_poly.holes;
+                    polygons_reverse(ex_poly_holes_reversed);
+                    for ([[maybe_unused]] const PrintInstance &instance : object->instances()) {
+                        ++polygon_idx; // Increase idx because of the contour of the ExPolygon.
+
+                        if (brim_type == BrimType::btInnerOnly || brim_type == BrimType::btOuterAndInner)
+                            for(const Polygon &hole : ex_poly_holes_reversed) {
+                                size_t hole_idx = &hole - &ex_poly_holes_reversed.front();
+                                if (has_nothing_inside[polygon_idx + hole_idx])
+                                    append(brim_area_innermost_object, shrink_ex({hole}, brim_separation, ClipperLib::jtSquare));
+                                else
+                                    append(brim_area_object, diff_ex(shrink_ex({hole}, brim_separation, ClipperLib::jtSquare), shrink_ex({hole}, brim_width + brim_separation, ClipperLib::jtSquare)));
+                            }
+
+                        polygon_idx += ex_poly.holes.size(); // Increase idx for every hole of the ExPolygon.
+                    }
 
-            if (brim_type == BrimType::btInnerOnly || brim_type == BrimType::btNoBrim)
-                append(no_brim_area_object, diff_ex(offset(ex_poly.contour, no_brim_offset, ClipperLib::jtSquare), ex_poly_holes_reversed));
+                    if (brim_type == BrimType::btInnerOnly || brim_type == BrimType::btNoBrim)
+                        append(no_brim_area_object, diff_ex(offset(ex_poly.contour, no_brim_offset, ClipperLib::jtSquare), ex_poly_holes_reversed));
 
-            if (brim_type == BrimType::btOuterOnly || brim_type == BrimType::btNoBrim)
-                append(no_brim_area_object, diff_ex(ex_poly.contour, shrink_ex(ex_poly_holes_reversed, no_brim_offset, ClipperLib::jtSquare)));
+                    if (brim_type == BrimType::btOuterOnly || brim_type == BrimType::btNoBrim)
+                        append(no_brim_area_object, diff_ex(ex_poly.contour, shrink_ex(ex_poly_holes_reversed, no_brim_offset, ClipperLib::jtSquare)));
 
-            append(holes_reversed_object, ex_poly_holes_reversed);
-        }
-        append(no_brim_area_object, offset_ex(bottom_layers_expolygons[print_object_idx], brim_separation, ClipperLib::jtSquare));
+                    append(holes_reversed_object, ex_poly_holes_reversed);
+                }
+                append(no_brim_area_object, offset_ex(bottom_layers_expolygons[print_object_idx], brim_separation, ClipperLib::jtSquare));
+                assert(polygon_idx == polygon_idx_first[print_object_idx + 1]);
+            }
+        });
 
-        for (const PrintInstance &instance : object->instances()) {
-            append_and_translate(brim_area_innermost[print_object_idx], brim_area_innermost_object, instance);
-            append_and_translate(brim_area, brim_area_object, instance);
-            append_and_translate(no_brim_area, no_brim_area_object, instance);
-            append_and_translate(holes_reversed, holes_reversed_object, instance);
+    std::vector<ExPolygons> brim_area_innermost(print.objects().size());
+    ExPolygons              brim_area;
+    ExPolygons              no_brim_area;
+    Polygons                holes_reversed;
+    for (size_t print_object_idx = 0; print_object_idx < print.objects().size(); ++ print_object_idx)
+        for (const PrintInstance &instance : print.objects()[print_object_idx]->instances()) {
+            const ObjectBrimAreas &areas = object_brim_areas[print_object_idx];
+            append_and_translate(brim_area_innermost[print_object_idx], areas.brim_area_innermost, instance);
+            append_and_translate(brim_area, areas.brim_area, instance);
+            append_and_translate(no_brim_area, areas.no_brim_area, instance);
+            append_and_translate(holes_reversed, areas.holes_reversed, instance);
         }
-    }
-    assert(polygon_idx == has_nothing_inside.size());
 
     ExPolygons brim_area_innermost_merged;
     // Append all innermost brim areas.
@@ -515,12 +550,23 @@ ExtrusionEntityCollection make_brim(const Print &print, PrintTryCancel try_cance
 
     Polygons        loops;
     size_t          num_loops = size_t(floor(max_brim_width(print.objects()) / flow.spacing()));
-    for (size_t i = 0; i < num_loops; ++i) {
-        try_cancel();
-        islands = expand(islands, float(flow.scaled_spacing()), ClipperLib::jtSquare);
-        for (Polygon &poly : islands) 
-            poly.douglas_peucker(scaled_resolution);
-        polygons_append(loops, shrink(islands, 0.5f * float(flow.scaled_spacing())));
+    {
+        // Each expansion depends on the previous one, while the loops are shrunk from the expanded islands in parallel.
+        std::vector<Polygons> islands_expanded(num_loops);
+        for (size_t i = 0; i < num_loops; ++i) {
+            try_cancel();
+            islands = expand(islands, float(flow.scaled_spacing()), ClipperLib::jtSquare);
+            for (Polygon &poly : islands) 
+                poly.douglas_peucker(scaled_resolution);
+            islands_expanded[i] = islands;
+        }
+        std::vector<Polygons> loops_expanded(num_loops);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_loops), [&islands_expanded, &loops_expanded, &flow](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                loops_expanded[i] = shrink(std::move(islands_expanded[i]), 0.5f * float(flow.scaled_spacing()));
+        });
+        for (Polygons &loops_expanded_level : loops_expanded)
+            polygons_append(loops, std::move(loops_expanded_level));
     }
     loops = union_pt_chained_outside_in(loops);
 
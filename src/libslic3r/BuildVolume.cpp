@@ -217,6 +217,9 @@ BuildVolume::ObjectState object_state_templ(const indexed_triangle_set &its, con
                 ++ num_above;
                 if (is_inside(pt))
                     ++ num_inside;
+                if (num_inside > 0 && num_inside < num_above)
+                    // Some vertices above the print bed are inside, some outside. Testing the rest will not change the result.
+                    return BuildVolume::ObjectState::Colliding;
             }
         }
 
@@ -259,12 +262,15 @@ BuildVolume::ObjectState object_state_templ(const indexed_triangle_set &its, con
     {
         // Much simpler and faster code, not clipping the object with the print bed.
         assert(! may_be_below_bed);
-        num_above = its.vertices.size();
         for (const stl_vertex &v : its.vertices) {
             const stl_vertex pt = trafo * v;
             assert(pt.z() >= world_min_z);
+            ++ num_above;
             if (is_inside(pt))
                 ++ num_inside;
+            if (num_inside > 0 && num_inside < num_above)
+                // Early exit, the object is colliding.
+                break;
         }
         inside  = num_inside > 0;
         outside = num_inside < num_above;
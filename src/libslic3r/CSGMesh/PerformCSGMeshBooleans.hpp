@@ -16,21 +16,32 @@
 
 namespace Slic3r { namespace csg {
 
+// Backend of perform_csgmesh_booleans().
+enum class BooleanBackend {
+    // All the operations are performed by CGAL corefinement in exact arithmetic.
+    CGAL,
+    // The operations on meshes with non intersecting surfaces are resolved by MeshBoolean::fast,
+    // only the operations on intersecting surfaces fall back to CGAL.
+    Fast
+};
+
+template<class CSGPartT>
+indexed_triangle_set get_transformed_mesh(const CSGPartT &csgpart)
+{
+    const indexed_triangle_set *its = csg::get_mesh(csgpart);
+    indexed_triangle_set m = its ? *its : indexed_triangle_set{};
+    its_transform(m, get_transform(csgpart), true);
+    return m;
+}
+
 // This method can be overriden when a specific CSGPart type supports caching
 // of the voxel grid
 template<class CSGPartT>
 MeshBoolean::cgal::CGALMeshPtr get_cgalmesh(const CSGPartT &csgpart)
 {
-    const indexed_triangle_set *its = csg::get_mesh(csgpart);
-    indexed_triangle_set dummy;
-
-    if (!its)
-        its = &dummy;
-
     MeshBoolean::cgal::CGALMeshPtr ret;
 
-    indexed_triangle_set m = *its;
-    its_transform(m, get_transform(csgpart), true);
+    indexed_triangle_set m = get_transformed_mesh(csgpart);
 
     try {
         ret = MeshBoolean::cgal::triangle_mesh_to_cgal(m);
@@ -86,6 +97,52 @@ std::vector<CGALMeshPtr> get_cgalptrs(Ex policy, const Range<It> &csgrange)
 
 } // namespace detail
 
+namespace detail_fast {
+
+// Result of an operation. The CGAL mesh is only valid after an operation had to fall back to CGAL,
+// then it is converted back to the indexed triangle set lazily by the next operation.
+struct FastMesh {
+    indexed_triangle_set            its;
+    MeshBoolean::cgal::CGALMeshPtr  cgal;
+
+    indexed_triangle_set& get_its()
+    {
+        if (cgal) {
+            its = MeshBoolean::cgal::cgal_to_indexed_triangle_set(*cgal);
+            cgal.reset();
+        }
+        return its;
+    }
+};
+
+inline void perform_csg(CSGType op, FastMesh &dst, FastMesh &src)
+{
+    indexed_triangle_set &A = dst.get_its();
+    indexed_triangle_set &B = src.get_its();
+
+    bool done = false;
+    switch (op) {
+    case CSGType::Union:        done = MeshBoolean::fast::plus(A, B); break;
+    case CSGType::Difference:   done = MeshBoolean::fast::minus(A, B); break;
+    case CSGType::Intersection: done = MeshBoolean::fast::intersect(A, B); break;
+    }
+
+    if (! done) {
+        // The surfaces intersect, perform the exact boolean.
+        MeshBoolean::cgal::CGALMeshPtr cgal_a = MeshBoolean::cgal::triangle_mesh_to_cgal(A);
+        MeshBoolean::cgal::CGALMeshPtr cgal_b = MeshBoolean::cgal::triangle_mesh_to_cgal(B);
+        switch (op) {
+        case CSGType::Union:        MeshBoolean::cgal::plus(*cgal_a, *cgal_b); break;
+        case CSGType::Difference:   MeshBoolean::cgal::minus(*cgal_a, *cgal_b); break;
+        case CSGType::Intersection: MeshBoolean::cgal::intersect(*cgal_a, *cgal_b); break;
+        }
+        dst.cgal = std::move(cgal_a);
+        A.clear();
+    }
+}
+
+} // namespace detail_fast
+
 // Process the sequence of CSG parts with CGAL.
 template<class It>
 void perform_csgmesh_booleans(MeshBoolean::cgal::CGALMeshPtr &cgalm,
@@ -202,6 +259,56 @@ MeshBoolean::cgal::CGALMeshPtr perform_csgmesh_booleans(const Range<It> &csgpart
     return ret;
 }
 
+// Process the sequence of CSG parts with the selected backend. Throws if a CGAL boolean failed.
+template<class It>
+indexed_triangle_set perform_csgmesh_booleans(const Range<It> &csgparts, BooleanBackend backend)
+{
+    if (backend == BooleanBackend::CGAL) {
+        auto cgalm = perform_csgmesh_booleans(csgparts);
+        return cgalm ? MeshBoolean::cgal::cgal_to_indexed_triangle_set(*cgalm) : indexed_triangle_set{};
+    }
+
+    using namespace detail_fast;
+
+    struct Frame {
+        CSGType op; FastMesh mesh;
+        explicit Frame(CSGType csgop = CSGType::Union) : op{csgop} {}
+    };
+
+    std::stack opstack{std::vector<Frame>{}};
+
+    opstack.push(Frame{});
+
+    std::vector<FastMesh> meshes(csgparts.size());
+    execution::for_each(ex_tbb, size_t(0), csgparts.size(),
+                        [&csgparts, &meshes](size_t i) {
+        auto it = csgparts.begin();
+        std::advance(it, i);
+        meshes[i].its = get_transformed_mesh(*it);
+    });
+
+    size_t csgidx = 0;
+    for (auto &csgpart : csgparts) {
+        FastMesh &mesh = meshes[csgidx++];
+
+        if (get_stack_operation(csgpart) == CSGStackOp::Push)
+            opstack.push(Frame{get_operation(csgpart)});
+
+        Frame *top = &opstack.top();
+
+        perform_csg(get_operation(csgpart), top->mesh, mesh);
+
+        if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
+            FastMesh src = std::move(top->mesh);
+            auto popop = opstack.top().op;
+            opstack.pop();
+            perform_csg(popop, opstack.top().mesh, src);
+        }
+    }
+
+    return std::move(opstack.top().mesh.get_its());
+}
+
 } // namespace csg
 } // namespace Slic3r
 
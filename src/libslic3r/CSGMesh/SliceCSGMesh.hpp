@@ -17,38 +17,28 @@ namespace Slic3r { namespace csg {
 
 namespace detail {
 
-inline void merge_slices(csg::CSGType op, size_t i,
-                  std::vector<ExPolygons> &target,
-                  std::vector<ExPolygons> &source)
+inline void merge_slices(csg::CSGType op, ExPolygons &target, ExPolygons &&source)
 {
     switch(op) {
     case CSGType::Union:
-        for (ExPolygon &expoly : source[i])
-            target[i].emplace_back(std::move(expoly));
+        for (ExPolygon &expoly : source)
+            target.emplace_back(std::move(expoly));
         break;
     case CSGType::Difference:
-        target[i] = diff_ex(target[i], source[i]);
+        if (! target.empty() && ! source.empty())
+            target = diff_ex(target, source);
         break;
     case CSGType::Intersection:
-        target[i] = intersection_ex(target[i], source[i]);
+        target = source.empty() || target.empty() ? ExPolygons{} : intersection_ex(target, source);
         break;
     }
 }
 
-inline void collect_nonempty_indices(csg::CSGType                   op,
-                              const std::vector<float>      &slicegrid,
-                              const std::vector<ExPolygons> &slices,
-                              std::vector<size_t>           &indices)
-{
-    indices.clear();
-    for (size_t i = 0; i < slicegrid.size(); ++i) {
-        if (op == CSGType::Intersection || !slices[i].empty())
-            indices.emplace_back(i);
-    }
-}
-
 } // namespace detail
 
+// Evaluate the CSG stack on the slices of the parts. All the parts are sliced first, in parallel,
+// then the stack of operations is evaluated for each layer independently with Clipper,
+// thus no 3D mesh booleans are performed.
 template<class ItCSG>
 std::vector<ExPolygons> slice_csgmesh_ex(
     const Range<ItCSG>          &csgrange,
@@ -58,75 +48,69 @@ std::vector<ExPolygons> slice_csgmesh_ex(
 {
     using namespace detail;
 
-    struct Frame { CSGType op; std::vector<ExPolygons> slices; };
-
-    std::stack opstack{std::vector<Frame>{}};
-
-    MeshSlicingParamsEx params_cpy = params;
-    auto trafo = params.trafo;
-    auto nonempty_indices = reserve_vector<size_t>(slicegrid.size());
+    // Slices of each part, empty for the stack operations without a mesh.
+    std::vector<std::vector<ExPolygons>> part_slices(csgrange.size());
+    execution::for_each(ex_tbb, size_t(0), csgrange.size(),
+        [&csgrange, &slicegrid, &params, &throw_on_cancel, &part_slices](size_t i) {
+            auto it = csgrange.begin();
+            std::advance(it, i);
+            if (const indexed_triangle_set *its = csg::get_mesh(*it); its) {
+                MeshSlicingParamsEx params_cpy = params;
+                params_cpy.trafo = params.trafo * csg::get_transform(*it).template cast<double>();
+                part_slices[i] = slice_mesh_ex(*its, slicegrid, params_cpy, throw_on_cancel);
+                assert(part_slices[i].size() == slicegrid.size());
+            }
+        });
 
-    opstack.push({CSGType::Union, std::vector<ExPolygons>(slicegrid.size())});
+    std::vector<ExPolygons> ret(slicegrid.size());
+    execution::for_each(ex_tbb, size_t(0), slicegrid.size(),
+        [&csgrange, &part_slices, &throw_on_cancel, &ret](size_t layer_id) {
+            throw_on_cancel();
 
-    for (const auto &csgpart : csgrange) {
-        const indexed_triangle_set *its = csg::get_mesh(csgpart);
+            struct Frame { CSGType op; ExPolygons slices; };
 
-        auto op = get_operation(csgpart);
+            std::stack opstack{std::vector<Frame>{}};
 
-        if (get_stack_operation(csgpart) == CSGStackOp::Push) {
-            opstack.push({op, std::vector<ExPolygons>(slicegrid.size())});
-            op = CSGType::Union;
-        }
+            opstack.push({CSGType::Union, {}});
 
-        Frame *top = &opstack.top();
+            size_t part_idx = 0;
+            for (const auto &csgpart : csgrange) {
+                std::vector<ExPolygons> &slices = part_slices[part_idx ++];
 
-        if (its) {
-            params_cpy.trafo = trafo * csg::get_transform(csgpart).template cast<double>();
-            std::vector<ExPolygons> slices = slice_mesh_ex(*its,
-                                                           slicegrid, params_cpy,
-                                                           throw_on_cancel);
+                auto op = get_operation(csgpart);
 
-            assert(slices.size() == slicegrid.size());
+                if (get_stack_operation(csgpart) == CSGStackOp::Push) {
+                    opstack.push({op, {}});
+                    op = CSGType::Union;
+                }
 
-            collect_nonempty_indices(op, slicegrid, slices, nonempty_indices);
+                Frame *top = &opstack.top();
 
-            execution::for_each(
-                ex_tbb, nonempty_indices.begin(), nonempty_indices.end(),
-                [op, &slices, &top](size_t i) {
-                    merge_slices(op, i, top->slices, slices);
-                }, execution::max_concurrency(ex_tbb));
-        }
+                if (! slices.empty())
+                    merge_slices(op, top->slices, std::move(slices[layer_id]));
 
-        if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
-            std::vector<ExPolygons> popslices = std::move(top->slices);
-            auto popop = opstack.top().op;
-            opstack.pop();
-            std::vector<ExPolygons> &prev_slices = opstack.top().slices;
+                if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
+                    ExPolygons popslices = std::move(top->slices);
+                    auto popop = opstack.top().op;
+                    opstack.pop();
+                    merge_slices(popop, opstack.top().slices, std::move(popslices));
+                }
+            }
 
-            collect_nonempty_indices(popop, slicegrid, popslices, nonempty_indices);
+            ExPolygons &slice = ret[layer_id];
+            slice = std::move(opstack.top().slices);
 
-            execution::for_each(
-                ex_tbb, nonempty_indices.begin(), nonempty_indices.end(),
-                [&popslices, &prev_slices, popop](size_t i) {
-                    merge_slices(popop, i, prev_slices, popslices);
-                }, execution::max_concurrency(ex_tbb));
-        }
-    }
+            // TODO: verify if this part can be omitted or not.
+            auto it = std::remove_if(slice.begin(), slice.end(), [](const ExPolygon &p){
+                return p.area() < double(SCALED_EPSILON) * double(SCALED_EPSILON);
+            });
 
-    std::vector<ExPolygons> ret = std::move(opstack.top().slices);
-
-    // TODO: verify if this part can be omitted or not.
-    execution::for_each(ex_tbb, ret.begin(), ret.end(), [](ExPolygons &slice) {
-        auto it = std::remove_if(slice.begin(), slice.end(), [](const ExPolygon &p){
-            return p.area() < double(SCALED_EPSILON) * double(SCALED_EPSILON);
+            // Hopefully, ExPolygons are moved, not copied to new positions
+            // and that is cheap for expolygons
+            slice.erase(it, slice.end());
+            slice = union_ex(slice);
         });
 
-        // Hopefully, ExPolygons are moved, not copied to new positions
-        // and that is cheap for expolygons
-        slice.erase(it, slice.end());
-        slice = union_ex(slice);
-    }, execution::max_concurrency(ex_tbb));
-
     return ret;
 }
 
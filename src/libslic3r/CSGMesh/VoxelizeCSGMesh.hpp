@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <stack>
+#include <iterator>
 
 #include "CSGMesh.hpp"
 #include "libslic3r/OpenVDBUtils.hpp"
@@ -56,6 +57,31 @@ inline void perform_csg(CSGType op, VoxelGridPtr &dst, VoxelGridPtr &src)
     }
 }
 
+// Combine the grids into the first one by a parallel tree reduction, pairing
+// the grids at distance 1, 2, 4 ... so that the result does not depend on the
+// thread count. Missing grids are skipped, as perform_csg() does.
+template<class CancelFn>
+void reduce_grids(CSGType op, std::vector<VoxelGridPtr *> &grids, CancelFn &&cancelfn)
+{
+    for (size_t stride = 1; stride < grids.size(); stride *= 2) {
+        if (cancelfn())
+            return;
+
+        size_t pairs = (grids.size() + 2 * stride - 1) / (2 * stride);
+        execution::for_each(ex_tbb, size_t(0), pairs, [&](size_t pairidx) {
+            size_t i = pairidx * 2 * stride, j = i + stride;
+            if (j >= grids.size())
+                return;
+
+            VoxelGridPtr &dst = *grids[i], &src = *grids[j];
+            if (!dst)
+                dst = std::move(src);
+            else
+                perform_csg(op, dst, src);
+        }, execution::max_concurrency(ex_tbb));
+    }
+}
+
 } // namespace detail
 
 template<class It>
@@ -84,14 +110,41 @@ VoxelGridPtr voxelize_csgmesh(const Range<It>      &csgrange,
 
     opstack.push({CSGType::Union, mesh_to_grid({}, params)});
 
-    for (auto &csgpart : csgrange) {
-        if (params.statusfn() && params.statusfn()(-1))
+    auto cancelfn = [&params] { return params.statusfn() && params.statusfn()(-1); };
+
+    std::vector<VoxelGridPtr *> run;
+    for (auto partit = csgrange.begin(); partit != csgrange.end(); ++partit, ++csgidx) {
+        if (cancelfn())
             break;
 
-        auto &partgrid = grids[csgidx++];
+        auto &csgpart = *partit;
+        auto &partgrid = grids[csgidx];
 
         auto op = get_operation(csgpart);
 
+        if (get_stack_operation(csgpart) == CSGStackOp::Continue) {
+            // A run of parts applying the same operation to the same stack
+            // frame is combined first: the unions and the subtracted parts
+            // are united, the intersected parts are intersected. The run is
+            // then applied to the frame at once.
+            run.clear();
+            run.emplace_back(&partgrid);
+            auto nextit = std::next(partit);
+            while (nextit != csgrange.end() &&
+                   get_stack_operation(*nextit) == CSGStackOp::Continue &&
+                   get_operation(*nextit) == op) {
+                run.emplace_back(&grids[csgidx + run.size()]);
+                ++nextit;
+            }
+
+            if (run.size() > 1) {
+                reduce_grids(op == CSGType::Intersection ? CSGType::Intersection : CSGType::Union,
+                             run, cancelfn);
+                csgidx += run.size() - 1;
+                std::advance(partit, run.size() - 1);
+            }
+        }
+
         if (get_stack_operation(csgpart) == CSGStackOp::Push) {
             opstack.push({op, mesh_to_grid({}, params)});
             op = CSGType::Union;
@@ -0,0 +1,279 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "CacheIO.hpp"
+
+#include "ExtrusionEntityCollection.hpp"
+#include "Model.hpp"
+
+#include <iterator>
+#include <optional>
+#include <typeinfo>
+
+#include <boost/algorithm/hex.hpp>
+
+namespace Slic3r {
+
+static void hash_facets(CacheHasher &hasher, const FacetsAnnotation &annotation)
+{
+    const auto &[facets, bits] = annotation.get_data();
+    hasher.add(uint64_t(facets.size()));
+    for (const std::pair<int, int> &facet : facets) {
+        hasher.add(int32_t(facet.first));
+        hasher.add(int32_t(facet.second));
+    }
+    hasher.add(uint64_t(bits.size()));
+    for (bool bit : bits)
+        hasher.add(uint8_t(bit));
+}
+
+void CacheHasher::add(const ModelObject &model_object)
+{
+    this->add(uint64_t(model_object.volumes.size()));
+    for (const ModelVolume *volume : model_object.volumes) {
+        this->add(int32_t(volume->type()));
+        this->add(volume->get_matrix());
+        const indexed_triangle_set &its = volume->mesh().its;
+        this->add(uint64_t(its.vertices.size()));
+        this->add_bytes(its.vertices.data(), its.vertices.size() * sizeof(stl_vertex));
+        this->add(uint64_t(its.indices.size()));
+        this->add_bytes(its.indices.data(), its.indices.size() * sizeof(stl_triangle_vertex_indices));
+        hash_facets(*this, volume->supported_facets);
+        hash_facets(*this, volume->seam_facets);
+        hash_facets(*this, volume->mmu_segmentation_facets);
+        this->add(volume->config.get());
+    }
+    this->add(model_object.config.get());
+    this->add(uint64_t(model_object.layer_config_ranges.size()));
+    for (const auto &[range, config] : model_object.layer_config_ranges) {
+        this->add(range.first);
+        this->add(range.second);
+        this->add(config.get());
+    }
+    const std::vector<coordf_t> &layer_height_profile = model_object.layer_height_profile.get();
+    this->add(uint64_t(layer_height_profile.size()));
+    for (coordf_t z : layer_height_profile)
+        this->add(double(z));
+}
+
+std::string CacheHasher::hex_digest()
+{
+    using boost::uuids::detail::md5;
+    md5::digest_type digest{};
+    m_md5.get_digest(digest);
+    std::string out;
+    boost::algorithm::hex(digest, digest + std::size(digest), std::back_inserter(out));
+    return out;
+}
+
+void CacheWriter::write(const Points &points)
+{
+    this->write(uint32_t(points.size()));
+    for (const Point &pt : points) {
+        this->write(int64_t(pt.x()));
+        this->write(int64_t(pt.y()));
+    }
+}
+
+void CacheWriter::write(const ExPolygon &expoly)
+{
+    this->write(expoly.contour.points);
+    this->write(uint32_t(expoly.holes.size()));
+    for (const Polygon &hole : expoly.holes)
+        this->write(hole.points);
+}
+
+void CacheWriter::write(const ExPolygons &expolys)
+{
+    this->write(uint32_t(expolys.size()));
+    for (const ExPolygon &expoly : expolys)
+        this->write(expoly);
+}
+
+void CacheWriter::write(const BoundingBox &bbox)
+{
+    this->write(int64_t(bbox.min.x()));
+    this->write(int64_t(bbox.min.y()));
+    this->write(int64_t(bbox.max.x()));
+    this->write(int64_t(bbox.max.y()));
+    this->write(uint8_t(bbox.defined));
+}
+
+void CacheWriter::write(const ExtrusionPath &path)
+{
+    uint16_t role = 0;
+    for (int i = 0; i < int(ExtrusionRoleModifier::Count); ++ i)
+        if (path.role().has(ExtrusionRoleModifier(i)))
+            role |= uint16_t(1) << i;
+    this->write(role);
+    this->write(path.mm3_per_mm());
+    this->write(path.width());
+    this->write(path.height());
+    const std::optional<OverhangAttributes> &overhang = path.attributes().overhang_attributes;
+    this->write(uint8_t(overhang.has_value()));
+    if (overhang) {
+        this->write(overhang->start_distance_from_prev_layer);
+        this->write(overhang->end_distance_from_prev_layer);
+        this->write(overhang->proximity_to_curled_lines);
+    }
+    this->write(path.polyline.points);
+}
+
+void CacheWriter::write(const ExtrusionPaths &paths)
+{
+    this->write(uint32_t(paths.size()));
+    for (const ExtrusionPath &path : paths)
+        this->write(path);
+}
+
+bool CacheWriter::write(const ExtrusionEntity &entity)
+{
+    const std::type_info &type = typeid(entity);
+    if (type == typeid(ExtrusionEntityCollection)) {
+        const auto &collection = static_cast<const ExtrusionEntityCollection&>(entity);
+        this->write(uint8_t(EntityCollection));
+        this->write(uint8_t(collection.no_sort));
+        this->write(uint32_t(collection.entities.size()));
+        for (const ExtrusionEntity *child : collection.entities)
+            if (! this->write(*child))
+                return false;
+    } else if (type == typeid(ExtrusionPath)) {
+        this->write(uint8_t(EntityPath));
+        this->write(static_cast<const ExtrusionPath&>(entity));
+    } else if (type == typeid(ExtrusionPathOriented)) {
+        this->write(uint8_t(EntityPathOriented));
+        this->write(static_cast<const ExtrusionPath&>(entity));
+    } else if (type == typeid(ExtrusionMultiPath)) {
+        this->write(uint8_t(EntityMultiPath));
+        this->write(static_cast<const ExtrusionMultiPath&>(entity).paths);
+    } else if (type == typeid(ExtrusionLoop)) {
+        const auto &loop = static_cast<const ExtrusionLoop&>(entity);
+        this->write(uint8_t(EntityLoop));
+        this->write(uint8_t(loop.loop_role()));
+        this->write(loop.paths);
+    } else
+        return false;
+    return true;
+}
+
+Points CacheReader::read_points()
+{
+    Points out(this->read_count(2 * sizeof(int64_t)));
+    for (Point &pt : out) {
+        pt.x() = coord_t(this->read<int64_t>());
+        pt.y() = coord_t(this->read<int64_t>());
+    }
+    return out;
+}
+
+ExPolygon CacheReader::read_expolygon()
+{
+    ExPolygon out;
+    out.contour.points = this->read_points();
+    out.holes.resize(this->read_count(sizeof(uint32_t)));
+    for (Polygon &hole : out.holes)
+        hole.points = this->read_points();
+    return out;
+}
+
+ExPolygons CacheReader::read_expolygons()
+{
+    ExPolygons out(this->read_count(2 * sizeof(uint32_t)));
+    for (ExPolygon &expoly : out)
+        expoly = this->read_expolygon();
+    return out;
+}
+
+BoundingBox CacheReader::read_bbox()
+{
+    BoundingBox out;
+    out.min.x() = coord_t(this->read<int64_t>());
+    out.min.y() = coord_t(this->read<int64_t>());
+    out.max.x() = coord_t(this->read<int64_t>());
+    out.max.y() = coord_t(this->read<int64_t>());
+    out.defined = this->read<uint8_t>() != 0;
+    return out;
+}
+
+ExtrusionPath CacheReader::read_path()
+{
+    ExtrusionRoleModifiers role;
+    auto role_bits = this->read<uint16_t>();
+    for (int i = 0; i < int(ExtrusionRoleModifier::Count); ++ i)
+        if (role_bits & (uint16_t(1) << i))
+            role = role | ExtrusionRoleModifier(i);
+    ExtrusionAttributes attributes{ ExtrusionRole(role) };
+    attributes.mm3_per_mm = this->read<double>();
+    attributes.width      = this->read<float>();
+    attributes.height     = this->read<float>();
+    if (this->read<uint8_t>()) {
+        OverhangAttributes overhang;
+        overhang.start_distance_from_prev_layer = this->read<float>();
+        overhang.end_distance_from_prev_layer   = this->read<float>();
+        overhang.proximity_to_curled_lines      = this->read<float>();
+        attributes.overhang_attributes = overhang;
+    }
+    ExtrusionPath out(attributes);
+    out.polyline.points = this->read_points();
+    return out;
+}
+
+ExtrusionPaths CacheReader::read_paths()
+{
+    ExtrusionPaths out;
+    uint32_t n = this->read_count(sizeof(uint16_t) + sizeof(double) + 2 * sizeof(float) + sizeof(uint8_t) + sizeof(uint32_t));
+    out.reserve(n);
+    for (uint32_t i = 0; i < n && ! this->failed(); ++ i)
+        out.emplace_back(this->read_path());
+    return out;
+}
+
+std::unique_ptr<ExtrusionEntity> CacheReader::read_entity()
+{
+    std::unique_ptr<ExtrusionEntity> out;
+    switch (this->read<uint8_t>()) {
+    case CacheWriter::EntityCollection:
+    {
+        auto collection = std::make_unique<ExtrusionEntityCollection>();
+        collection->no_sort = this->read<uint8_t>() != 0;
+        this->read_entities(collection->entities);
+        out = std::move(collection);
+        break;
+    }
+    case CacheWriter::EntityPath:
+        out = std::make_unique<ExtrusionPath>(this->read_path());
+        break;
+    case CacheWriter::EntityPathOriented:
+    {
+        ExtrusionPath path = this->read_path();
+        out = std::make_unique<ExtrusionPathOriented>(std::move(path.polyline), path.attributes());
+        break;
+    }
+    case CacheWriter::EntityMultiPath:
+        out = std::make_unique<ExtrusionMultiPath>(this->read_paths());
+        break;
+    case CacheWriter::EntityLoop:
+    {
+        auto loop_role = ExtrusionLoopRole(this->read<uint8_t>());
+        out = std::make_unique<ExtrusionLoop>(this->read_paths(), loop_role);
+        break;
+    }
+    default:
+        m_failed = true;
+    }
+    if (this->failed())
+        out.reset();
+    return out;
+}
+
+void CacheReader::read_entities(ExtrusionEntitiesPtr &dst)
+{
+    uint32_t n = this->read_count(sizeof(uint8_t));
+    dst.reserve(n);
+    for (uint32_t i = 0; i < n && ! this->failed(); ++ i)
+        if (std::unique_ptr<ExtrusionEntity> entity = this->read_entity(); entity)
+            dst.emplace_back(entity.release());
+}
+
+} // namespace Slic3r
@@ -0,0 +1,131 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_CacheIO_hpp_
+#define slic3r_CacheIO_hpp_
+
+// Hashing of the slicing inputs and binary serialization of the slicing results
+// for the persistent caches (FFFSupport::SupportCache, PrintObjectCache).
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+//FIXME replace with <boost/md5.hpp> after it becomes mainstream.
+#include <boost/uuid/detail/md5.hpp>
+
+#include "BoundingBox.hpp"
+#include "Config.hpp"
+#include "ExPolygon.hpp"
+#include "ExtrusionEntity.hpp"
+#include "Point.hpp"
+
+namespace Slic3r {
+
+class ModelObject;
+
+// The key has to be the same on all platforms, thus the values are hashed by their binary (little endian) representation,
+// not by std::hash().
+class CacheHasher
+{
+public:
+    void add_bytes(const void *data, size_t size) { m_md5.process_bytes(data, size); }
+    template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    void add(const T &value) { this->add_bytes(&value, sizeof(T)); }
+    void add(const std::string &value) { this->add(uint64_t(value.size())); this->add_bytes(value.data(), value.size()); }
+    void add(const Transform3d &trafo) { this->add_bytes(trafo.matrix().data(), sizeof(double) * 16); }
+    // Options are hashed by their serialized values.
+    void add(const ConfigBase &config, const t_config_option_keys &keys) {
+        for (const t_config_option_key &key : keys) {
+            this->add(key);
+            this->add(config.opt_serialize(key));
+        }
+    }
+    void add(const ConfigBase &config) { this->add(config, config.keys()); }
+    // Meshes, transformations, painted facets and configs of all ModelVolumes,
+    // the object config, the layer range modifiers and the variable layer height profile.
+    void add(const ModelObject &model_object);
+
+    std::string hex_digest();
+
+private:
+    boost::uuids::detail::md5 m_md5;
+};
+
+// Binary file with native (little endian) byte order.
+class CacheWriter
+{
+public:
+    explicit CacheWriter(std::ostream &os) : m_os(os) {}
+
+    template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    void write(const T &value) { m_os.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+    void write(const std::string &value) { this->write(uint32_t(value.size())); m_os.write(value.data(), value.size()); }
+    void write(const Points &points);
+    void write(const ExPolygon &expoly);
+    void write(const ExPolygons &expolys);
+    void write(const BoundingBox &bbox);
+    void write(const ExtrusionPath &path);
+    void write(const ExtrusionPaths &paths);
+    // Returns false if the entity is of a type, which is not serialized.
+    [[nodiscard]] bool write(const ExtrusionEntity &entity);
+
+    enum EntityType : uint8_t {
+        EntityCollection,
+        EntityPath,
+        EntityPathOriented,
+        EntityMultiPath,
+        EntityLoop,
+    };
+
+private:
+    std::ostream &m_os;
+};
+
+// Reader of the CacheWriter output. Sets the failed flag on a read error or on invalid data, then the values read are undefined.
+class CacheReader
+{
+public:
+    // size: Size of the input stream, used to validate the counts of items.
+    CacheReader(std::istream &is, size_t size) : m_is(is), m_remaining(size) {}
+
+    bool failed() const { return m_failed || ! m_is; }
+    void set_failed() { m_failed = true; }
+
+    template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    T read() { T value{}; m_is.read(reinterpret_cast<char*>(&value), sizeof(T)); return value; }
+    // Read a count of items, each taking at least min_item_size bytes. Protects against excessive allocations on corrupted files.
+    uint32_t read_count(size_t min_item_size) {
+        auto n = this->read<uint32_t>();
+        if (n > m_remaining / min_item_size)
+            m_failed = true;
+        return this->failed() ? 0 : n;
+    }
+    std::string read_string() {
+        std::string out(this->read_count(1), 0);
+        m_is.read(out.data(), out.size());
+        return out;
+    }
+    Points          read_points();
+    ExPolygon       read_expolygon();
+    ExPolygons      read_expolygons();
+    BoundingBox     read_bbox();
+    ExtrusionPath   read_path();
+    ExtrusionPaths  read_paths();
+    // Returns nullptr on failure.
+    std::unique_ptr<ExtrusionEntity> read_entity();
+    void            read_entities(ExtrusionEntitiesPtr &dst);
+
+private:
+    std::istream &m_is;
+    size_t        m_remaining;
+    bool          m_failed { false };
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_CacheIO_hpp_
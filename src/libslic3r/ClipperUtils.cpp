@@ -10,10 +10,16 @@
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
 #include "ClipperUtils.hpp"
+#include "AABBTreeIndirect.hpp"
+#include "BoundingBox.hpp"
 #include "Geometry.hpp"
+#include "Profiler.hpp"
+#include "ProfilerTracy.hpp"
 #include "ShortestPath.hpp"
 #include "Utils.hpp"
 
+#include <memory>
+
 // #define CLIPPER_UTILS_TIMING
 
 #ifdef CLIPPER_UTILS_TIMING
@@ -183,6 +189,52 @@ namespace ClipperUtils {
             out.end());
         return out;
     }
+
+    struct IndexedPolygons::Tree : public AABBTreeIndirect::Tree<2, coord_t> {};
+
+    IndexedPolygons::IndexedPolygons(const Polygons &polygons)
+    {
+        m_paths.reserve(polygons.size());
+        for (const Polygon &polygon : polygons)
+            m_paths.emplace_back(&polygon.points);
+        this->build();
+    }
+
+    IndexedPolygons::IndexedPolygons(const ExPolygons &expolygons)
+    {
+        m_paths.reserve(number_polygons(expolygons));
+        for (const ExPolygon &expolygon : expolygons) {
+            m_paths.emplace_back(&expolygon.contour.points);
+            for (const Polygon &hole : expolygon.holes)
+                m_paths.emplace_back(&hole.points);
+        }
+        this->build();
+    }
+
+    IndexedPolygons::IndexedPolygons(IndexedPolygons &&) = default;
+    IndexedPolygons::~IndexedPolygons() = default;
+
+    void IndexedPolygons::build()
+    {
+        std::vector<AABBTreeIndirect::BoundingBoxWrapper> bboxes;
+        bboxes.reserve(m_paths.size());
+        for (size_t i = 0; i < m_paths.size(); ++ i)
+            if (! m_paths[i]->empty())
+                bboxes.emplace_back(i, get_extents<true>(*m_paths[i]));
+        m_tree = std::make_unique<Tree>();
+        m_tree->build_modify_input(bboxes);
+    }
+
+    void IndexedPolygons::paths_overlapping(const BoundingBox &bbox, std::vector<const Points*> &out) const
+    {
+        AABBTreeIndirect::traverse(*m_tree,
+            AABBTreeIndirect::intersecting(Tree::BoundingBox(bbox.min, bbox.max)),
+            [this, &out](const Tree::Node &node) {
+                out.emplace_back(m_paths[node.idx]);
+                // Continue traversal.
+                return true;
+            });
+    }
 }
 
 static ExPolygons PolyTreeToExPolygons(ClipperLib::PolyTree &&polytree)
@@ -280,14 +332,82 @@ bool has_duplicate_points(const ClipperLib::PolyTree &polytree)
 }
 #endif
 
+// Report a Clipper operation with the number of its input vertices to the Profiler.
+template<typename... PathsProviders>
+static inline void profiler_count_clipper_call(const PathsProviders&... paths)
+{
+    if (Profiler::enabled()) {
+        size_t num_points = 0;
+        auto   add_points = [&num_points](const auto &provider) { for (const auto &path : provider) num_points += path.size(); };
+        (add_points(paths), ...);
+        Profiler::count_clipper_call(num_points);
+    }
+}
+
+// Constructing a Clipper or ClipperOffset engine for each boolean operation allocates its edge arrays,
+// local minima list, scanbeam heap and output point pool from scratch. ClipperEngine leases an engine
+// from a small thread local pool instead: the engine is reset to its default settings and cleared
+// after use, but it retains its memory for the next operation running on the same thread.
+// Nested operations (for example a PathsProvider calling into ClipperUtils) lease their own engines.
+template<typename Engine>
+class ClipperEngine
+{
+public:
+    ClipperEngine() {
+        std::vector<std::unique_ptr<Engine>> &pool = ClipperEngine::pool();
+        if (pool.empty())
+            m_engine = std::make_unique<Engine>();
+        else {
+            m_engine = std::move(pool.back());
+            pool.pop_back();
+            reset(*m_engine);
+        }
+    }
+    ~ClipperEngine() {
+        m_engine->Clear();
+        if (std::vector<std::unique_ptr<Engine>> &pool = ClipperEngine::pool(); pool.size() < max_pooled)
+            pool.emplace_back(std::move(m_engine));
+    }
+    ClipperEngine(const ClipperEngine&) = delete;
+    ClipperEngine& operator=(const ClipperEngine&) = delete;
+
+    Engine& operator*()  { return *m_engine; }
+    Engine* operator->() { return m_engine.get(); }
+
+private:
+    // Maximum number of idle engines of a type retained per thread.
+    static constexpr const size_t max_pooled = 4;
+
+    static std::vector<std::unique_ptr<Engine>>& pool() {
+        static thread_local std::vector<std::unique_ptr<Engine>> engines;
+        return engines;
+    }
+    static void reset(ClipperLib::Clipper &clipper) {
+        clipper.ReverseSolution(false);
+        clipper.StrictlySimple(false);
+        clipper.PreserveCollinear(false);
+    }
+    static void reset(ClipperLib::ClipperOffset &co) {
+        // Defaults of the ClipperOffset constructor.
+        co.MiterLimit         = 2.;
+        co.ArcTolerance       = 0.25;
+        co.ShortestEdgeLength = 0.;
+    }
+
+    std::unique_ptr<Engine> m_engine;
+};
+
 // Offset CCW contours outside, CW contours (holes) inside.
 // Don't calculate union of the output paths.
 template<typename PathsProvider>
 static ClipperLib::Paths raw_offset(PathsProvider &&paths, float offset, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType endType = ClipperLib::etClosedPolygon)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
+    profiler_count_clipper_call(paths);
 
-    ClipperLib::ClipperOffset co;
+    ClipperEngine<ClipperLib::ClipperOffset> engine;
+    ClipperLib::ClipperOffset &co = *engine;
     ClipperLib::Paths out;
     out.reserve(paths.size());
     ClipperLib::Paths out_this;
@@ -329,8 +449,11 @@ TResult clipper_do(
     const ClipperLib::PolyFillType fillType)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
+    profiler_count_clipper_call(subject, clip);
 
-    ClipperLib::Clipper clipper;
+    ClipperEngine<ClipperLib::Clipper> engine;
+    ClipperLib::Clipper &clipper = *engine;
     clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
     clipper.AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
     TResult retval;
@@ -360,8 +483,11 @@ TResult clipper_union(
     const ClipperLib::PolyFillType fillType = ClipperLib::pftNonZero)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
+    profiler_count_clipper_call(subject);
 
-    ClipperLib::Clipper clipper;
+    ClipperEngine<ClipperLib::Clipper> engine;
+    ClipperLib::Clipper &clipper = *engine;
     clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
     TResult retval;
     clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
@@ -400,11 +526,13 @@ template<class TResult, typename PathsProvider>
 static TResult shrink_paths(PathsProvider &&paths, float offset, ClipperLib::JoinType joinType, double miterLimit)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     assert(offset > 0);
     TResult out;
     if (auto raw = raw_offset(std::forward<PathsProvider>(paths), - offset, joinType, miterLimit); ! raw.empty()) {
-        ClipperLib::Clipper clipper;
+        ClipperEngine<ClipperLib::Clipper> engine;
+        ClipperLib::Clipper &clipper = *engine;
         clipper.AddPaths(raw, ClipperLib::ptSubject, true);
         ClipperLib::IntRect r = clipper.GetBounds();
         clipper.AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
@@ -448,11 +576,13 @@ Polygons contour_to_polygons(const Polygons &polygons, const float line_width, C
 static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::Paths &out)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     // 1) Offset the outer contour.
     ClipperLib::Paths contours;
     {
-        ClipperLib::ClipperOffset co;
+        ClipperEngine<ClipperLib::ClipperOffset> engine;
+        ClipperLib::ClipperOffset &co = *engine;
         if (joinType == jtRound)
             co.ArcTolerance = miterLimit;
         else
@@ -472,13 +602,15 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
         // 2) Offset the holes one by one, collect the offsetted holes.
         ClipperLib::Paths holes;
         {
+            ClipperEngine<ClipperLib::ClipperOffset> engine;
+            ClipperLib::ClipperOffset &co = *engine;
+            if (joinType == jtRound)
+                co.ArcTolerance = miterLimit;
+            else
+                co.MiterLimit = miterLimit;
+            co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
             for (const Polygon &hole : expoly.holes) {
-                ClipperLib::ClipperOffset co;
-                if (joinType == jtRound)
-                    co.ArcTolerance = miterLimit;
-                else
-                    co.MiterLimit = miterLimit;
-                co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
+                co.Clear();
                 co.AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
                 ClipperLib::Paths out2;
                 // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
@@ -658,6 +790,7 @@ inline ClipperLib::PolyTree clipper_do_polytree(
     const ClipperLib::PolyFillType   fillType)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     // Perform the operation with the output to input_subject.
     // This pass does not generate a PolyTree, which is a very expensive operation with the current Clipper library
@@ -681,10 +814,74 @@ inline ClipperLib::PolyTree clipper_do_polytree(
         clipper_do_polytree(clipType, std::forward<PathProvider1>(subject), std::forward<PathProvider2>(clip), fillType);
 }
 
+// Bounding box of all paths including the degenerate ones, undefined if there are no points.
+template<typename PathsProvider>
+static BoundingBox get_extents_paths(const PathsProvider &paths)
+{
+    BoundingBox bbox;
+    for (const Points &path : paths)
+        if (! path.empty())
+            bbox.merge(get_extents<true>(path));
+    return bbox;
+}
+
+// Collect paths overlapping bbox into out, accumulate their bounding box into out_bbox.
+// A closed path has zero winding number outside of its bounding box, therefore the paths not overlapping bbox
+// do not change the fill of any point inside bbox, whatever the fill type.
+// Returns true if some path was dropped.
+template<typename PathsProvider>
+static bool cull_paths_outside_bbox(const PathsProvider &paths, const BoundingBox &bbox, std::vector<const Points*> &out, BoundingBox &out_bbox)
+{
+    out.reserve(paths.size());
+    for (const Points &path : paths)
+        if (! path.empty())
+            if (BoundingBox path_bbox = get_extents<true>(path); path_bbox.overlap(bbox)) {
+                out.emplace_back(&path);
+                out_bbox.merge(path_bbox);
+            }
+    return out.size() < paths.size();
+}
+
+// Pre-pass of intersection and difference dropping the operands, which cannot contribute to the result,
+// before they are passed to Clipper. Both operations produce a subset of the subject, thus
+// 1) clipping paths not overlapping the bounding box of the subject are dropped,
+// 2) for intersection, subject paths not overlapping the bounding box of the remaining clipping paths are dropped.
+// Returns fn(subject, clip) called with either the source paths providers or with the culled paths.
+template<typename TSubj, typename TClip, typename Fn>
+static auto clipper_cull_operands(ClipperLib::ClipType clipType, TSubj &&subject, TClip &&clip, ApplySafetyOffset do_safety_offset, Fn &&fn)
+{
+    if ((clipType == ClipperLib::ctIntersection || clipType == ClipperLib::ctDifference) && clip.size() > 0) {
+        if (BoundingBox subject_bbox = get_extents_paths(subject); subject_bbox.defined) {
+            // Safety offset grows the clipping paths with mitered corners.
+            const coordf_t inflate = do_safety_offset == ApplySafetyOffset::Yes ? std::ceil(ClipperSafetyOffset * DefaultMiterLimit) + 1. : 0.;
+            std::vector<const Points*> clip_culled;
+            BoundingBox                clip_bbox;
+            const bool                 clip_was_culled = cull_paths_outside_bbox(clip, subject_bbox.inflated(inflate), clip_culled, clip_bbox);
+            if (clipType == ClipperLib::ctIntersection) {
+                if (clip_culled.empty())
+                    // Nothing to intersect with.
+                    return fn(ClipperUtils::EmptyPathsProvider(), ClipperUtils::EmptyPathsProvider());
+                std::vector<const Points*> subject_culled;
+                BoundingBox                subject_culled_bbox;
+                if (cull_paths_outside_bbox(subject, clip_bbox.inflated(inflate), subject_culled, subject_culled_bbox))
+                    return clip_was_culled ? 
+                        fn(ClipperUtils::PathPtrsProvider(subject_culled), ClipperUtils::PathPtrsProvider(clip_culled)) :
+                        fn(ClipperUtils::PathPtrsProvider(subject_culled), std::forward<TClip>(clip));
+            }
+            if (clip_was_culled)
+                return fn(std::forward<TSubj>(subject), ClipperUtils::PathPtrsProvider(clip_culled));
+        }
+    }
+    return fn(std::forward<TSubj>(subject), std::forward<TClip>(clip));
+}
+
 template<class TSubj, class TClip>
 static inline Polygons _clipper(ClipperLib::ClipType clipType, TSubj &&subject, TClip &&clip, ApplySafetyOffset do_safety_offset)
 {
-    return to_polygons(clipper_do<ClipperLib::Paths>(clipType, std::forward<TSubj>(subject), std::forward<TClip>(clip), ClipperLib::pftNonZero, do_safety_offset));
+    return clipper_cull_operands(clipType, std::forward<TSubj>(subject), std::forward<TClip>(clip), do_safety_offset,
+        [clipType, do_safety_offset](auto &&subject_paths, auto &&clip_paths) {
+            return to_polygons(clipper_do<ClipperLib::Paths>(clipType, std::forward<decltype(subject_paths)>(subject_paths), std::forward<decltype(clip_paths)>(clip_paths), ClipperLib::pftNonZero, do_safety_offset));
+        });
 }
 
 Slic3r::Polygons diff(const Slic3r::Polygon &subject, const Slic3r::Polygon &clip, ApplySafetyOffset do_safety_offset)
@@ -739,7 +936,22 @@ Slic3r::Polygons union_(const Slic3r::Polygons &subject, const Slic3r::ExPolygon
 
 template <typename TSubject, typename TClip>
 static ExPolygons _clipper_ex(ClipperLib::ClipType clipType, TSubject &&subject,  TClip &&clip, ApplySafetyOffset do_safety_offset, ClipperLib::PolyFillType fill_type = ClipperLib::pftNonZero)
-    { return PolyTreeToExPolygons(clipper_do_polytree(clipType, std::forward<TSubject>(subject), std::forward<TClip>(clip), fill_type, do_safety_offset)); }
+{
+    return clipper_cull_operands(clipType, std::forward<TSubject>(subject), std::forward<TClip>(clip), do_safety_offset,
+        [clipType, do_safety_offset, fill_type](auto &&subject_paths, auto &&clip_paths) {
+            return PolyTreeToExPolygons(clipper_do_polytree(clipType, std::forward<decltype(subject_paths)>(subject_paths), std::forward<decltype(clip_paths)>(clip_paths), fill_type, do_safety_offset));
+        });
+}
+
+// Clipping paths of the index overlapping the bounding box of the subject, inflated by the safety offset.
+template<typename PathsProvider>
+static std::vector<const Points*> indexed_paths_overlapping(const PathsProvider &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset)
+{
+    std::vector<const Points*> out;
+    if (BoundingBox bbox = get_extents_paths(subject); bbox.defined)
+        clip.paths_overlapping(do_safety_offset == ApplySafetyOffset::Yes ? bbox.inflated(std::ceil(ClipperSafetyOffset * DefaultMiterLimit) + 1.) : bbox, out);
+    return out;
+}
 
 Slic3r::ExPolygons diff_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset)
     { return _clipper_ex(ClipperLib::ctDifference, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), do_safety_offset); }
@@ -769,6 +981,12 @@ Slic3r::ExPolygons diff_ex(const Slic3r::SurfacesPtr &subject, const Slic3r::Pol
     { return _clipper_ex(ClipperLib::ctDifference, ClipperUtils::SurfacesPtrProvider(subject), ClipperUtils::PolygonsProvider(clip), do_safety_offset); }
 Slic3r::ExPolygons diff_ex(const Slic3r::SurfacesPtr &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset)
     { return _clipper_ex(ClipperLib::ctDifference, ClipperUtils::SurfacesPtrProvider(subject), ClipperUtils::ExPolygonsProvider(clip), do_safety_offset); }
+Slic3r::Polygons diff(const Slic3r::Polygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper(ClipperLib::ctDifference, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PathPtrsProvider(indexed_paths_overlapping(ClipperUtils::PolygonsProvider(subject), clip, do_safety_offset)), do_safety_offset); }
+Slic3r::ExPolygons diff_ex(const Slic3r::Polygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex(ClipperLib::ctDifference, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PathPtrsProvider(indexed_paths_overlapping(ClipperUtils::PolygonsProvider(subject), clip, do_safety_offset)), do_safety_offset); }
+Slic3r::ExPolygons diff_ex(const Slic3r::ExPolygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex(ClipperLib::ctDifference, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PathPtrsProvider(indexed_paths_overlapping(ClipperUtils::ExPolygonsProvider(subject), clip, do_safety_offset)), do_safety_offset); }
 
 Slic3r::ExPolygons intersection_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset)
     { return _clipper_ex(ClipperLib::ctIntersection, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), do_safety_offset); }
@@ -788,6 +1006,12 @@ Slic3r::ExPolygons intersection_ex(const Slic3r::Surfaces &subject, const Slic3r
     { return _clipper_ex(ClipperLib::ctIntersection, ClipperUtils::SurfacesProvider(subject), ClipperUtils::SurfacesProvider(clip), do_safety_offset); }
 Slic3r::ExPolygons intersection_ex(const Slic3r::SurfacesPtr &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset)
     { return _clipper_ex(ClipperLib::ctIntersection, ClipperUtils::SurfacesPtrProvider(subject), ClipperUtils::ExPolygonsProvider(clip), do_safety_offset); }
+Slic3r::Polygons intersection(const Slic3r::Polygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper(ClipperLib::ctIntersection, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PathPtrsProvider(indexed_paths_overlapping(ClipperUtils::PolygonsProvider(subject), clip, do_safety_offset)), do_safety_offset); }
+Slic3r::ExPolygons intersection_ex(const Slic3r::Polygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex(ClipperLib::ctIntersection, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PathPtrsProvider(indexed_paths_overlapping(ClipperUtils::PolygonsProvider(subject), clip, do_safety_offset)), do_safety_offset); }
+Slic3r::ExPolygons intersection_ex(const Slic3r::ExPolygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex(ClipperLib::ctIntersection, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PathPtrsProvider(indexed_paths_overlapping(ClipperUtils::ExPolygonsProvider(subject), clip, do_safety_offset)), do_safety_offset); }
 // May be used to "heal" unusual models (3DLabPrints etc.) by providing fill_type (pftEvenOdd, pftNonZero, pftPositive, pftNegative).
 Slic3r::ExPolygons union_ex(const Slic3r::Polygons &subject, ClipperLib::PolyFillType fill_type)
     { return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No, fill_type); }
@@ -808,8 +1032,10 @@ template<typename PathsProvider1, typename PathsProvider2>
 Polylines _clipper_pl_open(ClipperLib::ClipType clipType, PathsProvider1 &&subject, PathsProvider2 &&clip)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
-    ClipperLib::Clipper clipper;
+    ClipperEngine<ClipperLib::Clipper> engine;
+    ClipperLib::Clipper &clipper = *engine;
     clipper.AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
     clipper.AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
     ClipperLib::PolyTree retval;
@@ -995,6 +1221,7 @@ Polygons union_pt_chained_outside_in(const Polygons &subject)
 Polygons simplify_polygons(const Polygons &subject)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     ClipperLib::Paths output;
     ClipperLib::Clipper c;
@@ -1011,6 +1238,7 @@ Polygons simplify_polygons(const Polygons &subject)
 ExPolygons simplify_polygons_ex(const Polygons &subject, bool preserve_collinear)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     ClipperLib::PolyTree polytree;
     ClipperLib::Clipper c;
@@ -1027,6 +1255,7 @@ ExPolygons simplify_polygons_ex(const Polygons &subject, bool preserve_collinear
 Polygons top_level_islands(const Slic3r::Polygons &polygons)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     // init Clipper
     ClipperLib::Clipper clipper;
@@ -1052,6 +1281,7 @@ ClipperLib::Paths fix_after_outer_offset(
 	bool 						 reverse_result)	// = false
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
   	ClipperLib::Paths solution;
   	if (! input.empty()) {
@@ -1072,6 +1302,7 @@ ClipperLib::Paths fix_after_inner_offset(
 	bool 						 reverse_result) 	// = true
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
   	ClipperLib::Paths solution;
   	if (! input.empty()) {
@@ -1094,6 +1325,7 @@ ClipperLib::Paths fix_after_inner_offset(
 ClipperLib::Path mittered_offset_path_scaled(const Points &contour, const std::vector<float> &deltas, double miter_limit)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
 	assert(contour.size() == deltas.size());
 
@@ -1236,6 +1468,7 @@ ClipperLib::Path mittered_offset_path_scaled(const Points &contour, const std::v
 static void variable_offset_inner_raw(const ExPolygon &expoly, const std::vector<std::vector<float>> &deltas, double miter_limit, ClipperLib::Paths &contours, ClipperLib::Paths &holes)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
 #ifndef NDEBUG
     // Verify that the deltas are all non positive.
@@ -1271,6 +1504,7 @@ static void variable_offset_inner_raw(const ExPolygon &expoly, const std::vector
 Polygons variable_offset_inner(const ExPolygon &expoly, const std::vector<std::vector<float>> &deltas, double miter_limit)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     ClipperLib::Paths contours, holes;
     variable_offset_inner_raw(expoly, deltas, miter_limit, contours, holes);
@@ -1295,6 +1529,7 @@ Polygons variable_offset_inner(const ExPolygon &expoly, const std::vector<std::v
 ExPolygons variable_offset_inner_ex(const ExPolygon &expoly, const std::vector<std::vector<float>> &deltas, double miter_limit)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     ClipperLib::Paths contours, holes;
     variable_offset_inner_raw(expoly, deltas, miter_limit, contours, holes);
@@ -1323,6 +1558,7 @@ ExPolygons variable_offset_inner_ex(const ExPolygon &expoly, const std::vector<s
 static void variable_offset_outer_raw(const ExPolygon &expoly, const std::vector<std::vector<float>> &deltas, double miter_limit, ClipperLib::Paths &contours, ClipperLib::Paths &holes)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
 #ifndef NDEBUG
     // Verify that the deltas are all non positive.
@@ -1360,6 +1596,7 @@ static void variable_offset_outer_raw(const ExPolygon &expoly, const std::vector
 Polygons variable_offset_outer(const ExPolygon &expoly, const std::vector<std::vector<float>> &deltas, double miter_limit)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     ClipperLib::Paths contours, holes;
     variable_offset_outer_raw(expoly, deltas, miter_limit, contours, holes);
@@ -1383,6 +1620,7 @@ Polygons variable_offset_outer(const ExPolygon &expoly, const std::vector<std::v
 ExPolygons variable_offset_outer_ex(const ExPolygon &expoly, const std::vector<std::vector<float>> &deltas, double miter_limit)
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
+    SLIC3R_PROFILE_ZONE();
 
     ClipperLib::Paths contours, holes;
     variable_offset_outer_raw(expoly, deltas, miter_limit, contours, holes);
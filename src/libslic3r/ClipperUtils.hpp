@@ -320,6 +320,56 @@ namespace ClipperUtils {
         size_t             m_size;
     };
 
+    // Paths referenced by pointers, for example a subset of paths selected from a larger set.
+    class PathPtrsProvider {
+    public:
+        PathPtrsProvider(const std::vector<const Points*> &paths) : m_paths(paths) {}
+
+        struct iterator : public PathsProviderIteratorBase {
+        public:
+            explicit iterator(std::vector<const Points*>::const_iterator it) : m_it(it) {}
+            const Points& operator*() const { return **m_it; }
+            bool operator==(const iterator &rhs) const { return m_it == rhs.m_it; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            const Points& operator++(int) { return **(m_it ++); }
+            iterator& operator++() { ++ m_it; return *this; }
+        private:
+            std::vector<const Points*>::const_iterator m_it;
+        };
+
+        iterator cbegin() const { return iterator(m_paths.begin()); }
+        iterator begin()  const { return this->cbegin(); }
+        iterator cend()   const { return iterator(m_paths.end()); }
+        iterator end()    const { return this->cend(); }
+        size_t   size()   const { return m_paths.size(); }
+
+    private:
+        const std::vector<const Points*> &m_paths;
+    };
+
+    // Clipping polygons indexed by an AABB tree over bounding boxes of their contours and holes.
+    // To be built once for a large set of clipping polygons (for example a whole layer) and reused for many
+    // intersections or differences with small subjects: only the clipping paths overlapping the bounding box
+    // of a subject are passed to Clipper. The source polygons are referenced, they have to outlive the index.
+    class IndexedPolygons {
+    public:
+        explicit IndexedPolygons(const Polygons &polygons);
+        explicit IndexedPolygons(const ExPolygons &expolygons);
+        IndexedPolygons(IndexedPolygons &&);
+        ~IndexedPolygons();
+
+        // Collect the paths with bounding boxes overlapping bbox.
+        void   paths_overlapping(const BoundingBox &bbox, std::vector<const Points*> &out) const;
+        size_t size() const { return m_paths.size(); }
+
+    private:
+        void   build();
+
+        std::vector<const Points*>  m_paths;
+        struct Tree;
+        std::unique_ptr<Tree>       m_tree;
+    };
+
     // For ClipperLib with Z coordinates.
     using ZPoint = Vec3i32;
     using ZPoints = std::vector<Vec3i32>;
@@ -448,6 +498,10 @@ Slic3r::ExPolygons diff_ex(const Slic3r::ExPolygons &subject, const Slic3r::Surf
 Slic3r::ExPolygons diff_ex(const Slic3r::Surfaces &subject, const Slic3r::Surfaces &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
 Slic3r::ExPolygons diff_ex(const Slic3r::SurfacesPtr &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
 Slic3r::ExPolygons diff_ex(const Slic3r::SurfacesPtr &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+// Only the clipping paths of the index overlapping the subject are considered.
+Slic3r::Polygons   diff(const Slic3r::Polygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+Slic3r::ExPolygons diff_ex(const Slic3r::Polygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+Slic3r::ExPolygons diff_ex(const Slic3r::ExPolygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
 Slic3r::Polylines  diff_pl(const Slic3r::Polyline &subject, const Slic3r::Polygons &clip);
 Slic3r::Polylines  diff_pl(const Slic3r::Polylines &subject, const Slic3r::Polygons &clip);
 Slic3r::Polylines  diff_pl(const Slic3r::Polyline &subject, const Slic3r::ExPolygon &clip);
@@ -482,6 +536,10 @@ Slic3r::ExPolygons intersection_ex(const Slic3r::Surfaces &subject, const Slic3r
 Slic3r::ExPolygons intersection_ex(const Slic3r::Surfaces &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
 Slic3r::ExPolygons intersection_ex(const Slic3r::Surfaces &subject, const Slic3r::Surfaces &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
 Slic3r::ExPolygons intersection_ex(const Slic3r::SurfacesPtr &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+// Only the clipping paths of the index overlapping the subject are considered.
+Slic3r::Polygons   intersection(const Slic3r::Polygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+Slic3r::ExPolygons intersection_ex(const Slic3r::Polygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+Slic3r::ExPolygons intersection_ex(const Slic3r::ExPolygons &subject, const ClipperUtils::IndexedPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
 Slic3r::Polylines  intersection_pl(const Slic3r::Polylines &subject, const Slic3r::Polygon &clip);
 Slic3r::Polylines  intersection_pl(const Slic3r::Polyline &subject, const Slic3r::ExPolygon &clip);
 Slic3r::Polylines  intersection_pl(const Slic3r::Polylines &subject, const Slic3r::ExPolygon &clip);
@@ -57,6 +57,29 @@ void set_skip_for_out_of_aoi(std::vector<bool>          &skip_indicies,
                              const Project              &projection,
                              const BoundingBox          &shapes_bb);
 
+/// <summary>
+/// Bounding boxes of separate shape islands.
+/// Overlapping boxes are merged together.
+/// </summary>
+/// <param name="shapes">Shapes to cut</param>
+/// <returns>Disjoint bounding boxes covering all shapes,
+/// empty when there is too much islands to be worth of test</returns>
+BoundingBoxes create_islands_bbs(const ExPolygons &shapes);
+
+/// <summary>
+/// Set true for indices out of area of interest of all islands
+/// Tighter than set_skip_for_out_of_aoi when shapes are spread
+/// e.g. letters of multiline text on curved surface
+/// </summary>
+/// <param name="skip_indicies">Flag to convert triangle to cgal</param>
+/// <param name="its">model</param>
+/// <param name="projection">Convert 2d point to pair of 3d points</param>
+/// <param name="islands_bbs">2d bounding boxes define AOIs</param>
+void set_skip_for_out_of_islands(std::vector<bool>          &skip_indicies,
+                                 const indexed_triangle_set &its,
+                                 const Project              &projection,
+                                 const BoundingBoxes        &islands_bbs);
+
 /// <summary>
 /// Set true for indicies outward and almost parallel together.
 /// Note: internally calculate normals
@@ -549,21 +572,27 @@ SurfaceCut Slic3r::cut_surface(const ExPolygons &shapes,
 
     // for filttrate opposite triangles and a little more
     const float max_angle = 89.9f;
-    priv::CutMeshes cgal_models; // source for patch
-    priv::CutMeshes cgal_neg_models; // model used for differenciate patches
-    cgal_models.reserve(models.size());
-    for (const indexed_triangle_set &its : models) {
+    // separate islands of shapes (e.g. lines of text) allow to skip triangles between them
+    BoundingBoxes islands_bbs = priv::create_islands_bbs(shapes);
+    priv::CutMeshes cgal_models(models.size()); // source for patch
+    priv::CutMeshes cgal_neg_models(models.size()); // model used for differenciate patches
+    // models are independent, convert them in parallel
+    tbb::parallel_for(size_t(0), models.size(), [&](size_t model_index) {
+        const indexed_triangle_set &its = models[model_index];
         std::vector<bool> skip_indicies(its.indices.size(), {false});
         priv::set_skip_for_out_of_aoi(skip_indicies, its, projection, shapes_bb);
 
         // create model for differenciate cutted patches
+        // NOTE: keep whole AOI, it is used for ray cast of inside test
         bool flip = true;
-        cgal_neg_models.push_back(priv::to_cgal(its, skip_indicies, flip));
+        cgal_neg_models[model_index] = priv::to_cgal(its, skip_indicies, flip);
         
+        // only triangles under some island could be part of patch
+        priv::set_skip_for_out_of_islands(skip_indicies, its, projection, islands_bbs);
         // cut out more than only opposit triangles 
         priv::set_skip_by_angle(skip_indicies, its, projection, max_angle);
-        cgal_models.push_back(priv::to_cgal(its, skip_indicies));
-    }
+        cgal_models[model_index] = priv::to_cgal(its, skip_indicies);
+    });
 #ifdef DEBUG_OUTPUT_DIR
     priv::store(cgal_models, DEBUG_OUTPUT_DIR + "model/");// model[0-N].off
     priv::store(cgal_neg_models, DEBUG_OUTPUT_DIR + "model_neg/"); // model[0-N].off
@@ -708,6 +737,37 @@ using IsOnSides = std::vector<std::array<bool, 4>>;
 /// <returns>True when triangle is out of one of plane</returns>
 bool is_all_on_one_side(const Vec3i &t, const IsOnSides& is_on_sides);
 
+/// <summary>
+/// Create planes bounding the projection of 2d bounding box
+/// Normals point out of the bounding box
+/// </summary>
+/// <param name="bb">2d bounding box</param>
+/// <param name="projection">Convert 2d point to pair of 3d points</param>
+/// <returns>Planes: 0 .. under, 1 .. left, 2 .. above, 3 .. right</returns>
+PointNormals create_point_normals(const BoundingBox &bb, const Project &projection);
+
+/// <summary>
+/// Check if triangle has all vertices out of one of planes
+/// </summary>
+/// <param name="t">Triangle</param>
+/// <param name="vertices">Vertices of model</param>
+/// <param name="point_normals">Planes bounding AOI</param>
+/// <returns>True when triangle can't intersect AOI</returns>
+bool is_out_of(const Vec3i &t, const std::vector<Vec3f> &vertices, const PointNormals &point_normals);
+
+// Skip flags are stored in std::vector<bool>, which packs them to machine words.
+// Parallel writes have to touch disjoint words, so split work to aligned chunks.
+template<typename Fn>
+void for_each_skip_chunk(size_t count, Fn fn)
+{
+    constexpr size_t chunk = 1024;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, (count + chunk - 1) / chunk),
+    [count, &fn](const tbb::blocked_range<size_t> &range) {
+        for (size_t c = range.begin(); c < range.end(); ++c)
+            fn(c * chunk, std::min((c + 1) * chunk, count));
+    });
+}
+
 } // namespace priv
 
 bool priv::is_out_of(const Vec3d &v, const PointNormal &point_normal)
@@ -732,12 +792,8 @@ bool priv::is_all_on_one_side(const Vec3i &t, const IsOnSides& is_on_sides) {
     return false;
 }
 
-void priv::set_skip_for_out_of_aoi(std::vector<bool>          &skip_indicies,
-                                   const indexed_triangle_set &its,
-                                   const Project              &projection,
-                                   const BoundingBox          &shapes_bb)
+priv::PointNormals priv::create_point_normals(const BoundingBox &bb, const Project &projection)
 {
-    assert(skip_indicies.size() == its.indices.size());
     //   1`*----* 2`
     //    /  2 /|
     // 1 *----* |
@@ -745,12 +801,12 @@ void priv::set_skip_for_out_of_aoi(std::vector<bool>          &skip_indicies,
     //   |    |/
     // 0 *----* 3
     //////////////////
-    std::array<std::pair<Vec3d, Vec3d>, 4> bb;
+    std::array<std::pair<Vec3d, Vec3d>, 4> front_back;
     int index = 0;
     for (Point v :
-         {shapes_bb.min, Point{shapes_bb.min.x(), shapes_bb.max.y()},
-          shapes_bb.max, Point{shapes_bb.max.x(), shapes_bb.min.y()}})
-        bb[index++] = projection.create_front_back(v);
+         {bb.min, Point{bb.min.x(), bb.max.y()},
+          bb.max, Point{bb.max.x(), bb.min.y()}})
+        front_back[index++] = projection.create_front_back(v);
 
     // define planes to test
     // 0 .. under
@@ -761,9 +817,9 @@ void priv::set_skip_for_out_of_aoi(std::vector<bool>          &skip_indicies,
     // plane is defined by point and normal
     PointNormals point_normals;
     for (size_t i = 0; i < 4; i++) {
-        const Vec3d &p1 = bb[i].first;
-        const Vec3d &p2 = bb[i].second;
-        const Vec3d &p3 = bb[prev_i].first;
+        const Vec3d &p1 = front_back[i].first;
+        const Vec3d &p2 = front_back[i].second;
+        const Vec3d &p3 = front_back[prev_i].first;
         prev_i = i;
 
         Vec3d v1 = p2 - p1;
@@ -783,7 +839,31 @@ void priv::set_skip_for_out_of_aoi(std::vector<bool>          &skip_indicies,
         // projection is reflected so normals are reflected
         for (auto &pn : point_normals)
             pn.second *= -1;
-    }    
+    }
+    return point_normals;
+}
+
+bool priv::is_out_of(const Vec3i &t, const std::vector<Vec3f> &vertices, const PointNormals &point_normals)
+{
+    for (const PointNormal &point_normal : point_normals) {
+        bool result = true;
+        for (auto vi : t)
+            if (!is_out_of(vertices[vi].cast<double>(), point_normal)) {
+                result = false;
+                break;
+            }
+        if (result) return true;
+    }
+    return false;
+}
+
+void priv::set_skip_for_out_of_aoi(std::vector<bool>          &skip_indicies,
+                                   const indexed_triangle_set &its,
+                                   const Project              &projection,
+                                   const BoundingBox          &shapes_bb)
+{
+    assert(skip_indicies.size() == its.indices.size());
+    PointNormals point_normals = create_point_normals(shapes_bb, projection);
 
     // same meaning as point normal
     IsOnSides is_on_sides(its.vertices.size(), {false,false,false,false});    
@@ -813,15 +893,73 @@ void priv::set_skip_for_out_of_aoi(std::vector<bool>          &skip_indicies,
     }); // END parallel for
 
     // inspect all triangles, when it is out of bounding box
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()),
-    [&its, &is_on_sides, &skip_indicies](const tbb::blocked_range<size_t> &range) {
-        for (size_t i = range.begin(); i < range.end(); ++i) {
+    for_each_skip_chunk(its.indices.size(), 
+    [&its, &is_on_sides, &skip_indicies](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
             if (is_all_on_one_side(its.indices[i], is_on_sides)) 
                 skip_indicies[i] = true;
         }
     }); // END parallel for
 }
 
+BoundingBoxes priv::create_islands_bbs(const ExPolygons &shapes)
+{
+    // Per island test cost grows with count of islands,
+    // with too much islands coarse AOI is good enough
+    const size_t max_islands = 64;
+    BoundingBoxes bbs;
+    bbs.reserve(shapes.size());
+    for (const ExPolygon &shape : shapes)
+        bbs.push_back(get_extents(shape));
+
+    // merge overlapping boxes until all are disjoint
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t i = 0; i < bbs.size(); ++i)
+            for (size_t j = i + 1; j < bbs.size(); ++j) {
+                if (!bbs[i].overlap(bbs[j]))
+                    continue;
+                bbs[i].merge(bbs[j]);
+                bbs[j] = bbs.back();
+                bbs.pop_back();
+                merged = true;
+                --j;
+            }
+    }
+    // one island is same as whole shapes bounding box
+    if (bbs.size() <= 1 || bbs.size() > max_islands)
+        return {};
+    return bbs;
+}
+
+void priv::set_skip_for_out_of_islands(std::vector<bool>          &skip_indicies,
+                                       const indexed_triangle_set &its,
+                                       const Project              &projection,
+                                       const BoundingBoxes        &islands_bbs)
+{
+    assert(skip_indicies.size() == its.indices.size());
+    if (islands_bbs.empty())
+        return;
+
+    std::vector<PointNormals> islands;
+    islands.reserve(islands_bbs.size());
+    for (const BoundingBox &bb : islands_bbs)
+        islands.push_back(create_point_normals(bb, projection));
+
+    // Only triangles inside of coarse AOI are tested, so it is cheap to test each island
+    for_each_skip_chunk(its.indices.size(), 
+    [&its, &islands, &skip_indicies](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (skip_indicies[i])
+                continue;
+            const Vec3i &t = its.indices[i];
+            if (std::all_of(islands.begin(), islands.end(),
+                    [&t, &its](const PointNormals &point_normals) { return is_out_of(t, its.vertices, point_normals); }))
+                skip_indicies[i] = true;
+        }
+    }); // END parallel for
+}
+
 indexed_triangle_set Slic3r::its_mask(const indexed_triangle_set &its,
                                       const std::vector<bool>    &mask)
 {
@@ -881,21 +1019,24 @@ void priv::set_skip_by_angle(std::vector<bool>          &skip_indicies,
     assert(max_angle < 90. && max_angle > 89.);
     assert(skip_indicies.size() == its.indices.size());
     float threshold = static_cast<float>(cos(max_angle / 180. * M_PI));
-    for (const stl_triangle_vertex_indices& face : its.indices) {
-        size_t index = &face - &its.indices.front();
-        if (skip_indicies[index]) continue;
-        Vec3f n = its_face_normal(its, face);
-        const Vec3f& v = its.vertices[face[0]];
-        const Vec3d vd = v.cast<double>();
-        // Improve: For Orthogonal Projection it is same for each vertex
-        Vec3d projectedd  = projection.project(vd);
-        Vec3f projected   = projectedd.cast<float>();
-        Vec3f project_dir = projected - v;
-        project_dir.normalize();
-        float cos_alpha = project_dir.dot(n);
-        if (cos_alpha > threshold) continue;
-        skip_indicies[index] = true;
-    }
+    for_each_skip_chunk(its.indices.size(), 
+    [&its, &projection, threshold, &skip_indicies](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; ++index) {
+            if (skip_indicies[index]) continue;
+            const stl_triangle_vertex_indices &face = its.indices[index];
+            Vec3f n = its_face_normal(its, face);
+            const Vec3f& v = its.vertices[face[0]];
+            const Vec3d vd = v.cast<double>();
+            // Improve: For Orthogonal Projection it is same for each vertex
+            Vec3d projectedd  = projection.project(vd);
+            Vec3f projected   = projectedd.cast<float>();
+            Vec3f project_dir = projected - v;
+            project_dir.normalize();
+            float cos_alpha = project_dir.dot(n);
+            if (cos_alpha > threshold) continue;
+            skip_indicies[index] = true;
+        }
+    }); // END parallel for
 }
 
 priv::CutMesh priv::to_cgal(const indexed_triangle_set &its,
@@ -3,12 +3,15 @@
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
 #include <algorithm>
+#include <numeric>
 #include <vector>
 #include <float.h>
 #include <unordered_map>
 
 #include <png.h>
 
+#include <tbb/parallel_for.h>
+
 #include "libslic3r.h"
 #include "ClipperUtils.hpp"
 #include "EdgeGrid.hpp"
@@ -164,6 +167,49 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 	m_rows = (m_bbox.max(1) - m_bbox.min(1) + m_resolution - 1) / m_resolution;
 	m_cells.assign(m_rows * m_cols, Cell());
 
+	if (size_t num_segments = std::accumulate(m_contours.begin(), m_contours.end(), size_t(0), 
+			[](size_t acc, const Contour &contour) { return acc + contour.num_segments(); });
+		num_segments >= 16384) {
+		// Large input: Rasterize the contours in parallel, then fill in the cells in the order of the contours and their segments,
+		// producing the same m_cell_data as the sequential rasterization below.
+		// Pairs of (cell index, segment index) per contour, in the order of the segments.
+		std::vector<std::vector<std::pair<size_t, size_t>>> contour_cells(m_contours.size());
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, m_contours.size()), [this, &contour_cells](const tbb::blocked_range<size_t> &range) {
+			struct Visitor {
+				inline bool operator()(coord_t iy, coord_t ix) {
+					cells.emplace_back(iy * cols + ix, j);
+					// Continue traversing the grid along the edge.
+					return true;
+				}
+				std::vector<std::pair<size_t, size_t>> &cells;
+				size_t 									cols;
+				size_t 									j;
+			};
+			for (size_t i = range.begin(); i < range.end(); ++ i) {
+				const Contour &contour = m_contours[i];
+				Visitor visitor { contour_cells[i], m_cols, 0 };
+				visitor.cells.reserve(contour.num_segments() * 2);
+				for (; visitor.j < contour.num_segments(); ++ visitor.j)
+					this->visit_cells_intersecting_line(contour.segment_start(visitor.j), contour.segment_end(visitor.j), visitor);
+			}
+		});
+		// Count the edges per grid cell, prefix sum them and fill in m_cell_data.
+		for (const std::vector<std::pair<size_t, size_t>> &cells : contour_cells)
+			for (const std::pair<size_t, size_t> &cell : cells)
+				++ m_cells[cell.first].end;
+		size_t cnt = 0;
+		for (Cell &cell : m_cells) {
+			cell.begin = cnt;
+			cnt       += cell.end;
+			cell.end   = cell.begin;
+		}
+		m_cell_data.assign(cnt, std::pair<size_t, size_t>(size_t(-1), size_t(-1)));
+		for (size_t i = 0; i < contour_cells.size(); ++ i)
+			for (const std::pair<size_t, size_t> &cell : contour_cells[i])
+				m_cell_data[m_cells[cell.first].end ++] = std::pair<size_t, size_t>(i, cell.second);
+		return;
+	}
+
 	// 3) First round of contour rasterization, count the edges per grid cell.
 	for (size_t i = 0; i < m_contours.size(); ++ i) {
 		const Contour &contour = m_contours[i];
@@ -1046,6 +1092,16 @@ float EdgeGrid::Grid::signed_distance_bilinear(const Point &pt) const
 	return f;
 }
 
+std::vector<EdgeGrid::Grid::ClosestPointResult> EdgeGrid::Grid::closest_points_signed_distance(const Points &pts, coord_t search_radius) const
+{
+	std::vector<ClosestPointResult> out(pts.size());
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, pts.size(), 256), [this, &pts, search_radius, &out](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i)
+			out[i] = this->closest_point_signed_distance(pts[i], search_radius);
+	});
+	return out;
+}
+
 EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point_signed_distance(const Point &pt, coord_t search_radius) const 
 {
 	BoundingBox bbox;
@@ -151,6 +151,8 @@ public:
 		bool valid() const { return contour_idx != size_t(-1); }
 	};
 	ClosestPointResult closest_point_signed_distance(const Point &pt, coord_t search_radius) const;
+	// Batched closest_point_signed_distance(), the points are queried in parallel.
+	std::vector<ClosestPointResult> closest_points_signed_distance(const Points &pts, coord_t search_radius) const;
 
 	// Only call this function for closed contours!
 	bool signed_distance_edges(const Point &pt, coord_t search_radius, coordf_t &result_min_dist, bool *pon_segment = nullptr) const;
@@ -23,6 +23,9 @@
 #include "libslic3r/Line.hpp"
 #include "libslic3r/BoundingBox.hpp"
 
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 // Experimentaly suggested ration of font ascent by multiple fonts
 // to get approx center of normal text line
 const double ASCENT_CENTER = 1/3.; // 0.5 is above small letter
@@ -1336,7 +1339,44 @@ HealedExPolygons Emboss::text2shapes(FontFileWithCache &font_with_cache, const c
     ExPolygonsWithIds vshapes = text2vshapes(font_with_cache, text_w, font_prop, was_canceled);
 
     float delta = static_cast<float>(1. / SHAPE_SCALE);
-    return union_with_delta(vshapes, delta, MAX_HEAL_ITERATION_OF_TEXT);
+
+    // Split the text to lines, which may be united in parallel if their extents do not overlap.
+    std::vector<ExPolygonsWithIds> lines(1);
+    for (ExPolygonsWithId &shape : vshapes)
+        if (shape.id == ENTER_UNICODE)
+            lines.emplace_back();
+        else
+            lines.back().push_back(std::move(shape));
+    if (lines.size() < 2)
+        return union_with_delta(lines.front(), delta, MAX_HEAL_ITERATION_OF_TEXT);
+
+    BoundingBoxes line_bbs;
+    line_bbs.reserve(lines.size());
+    for (const ExPolygonsWithIds &line : lines)
+        if (BoundingBox bb = get_extents(line); bb.defined)
+            line_bbs.push_back(bb.inflated(2. * delta));
+    bool overlap = false;
+    for (size_t i = 0; i < line_bbs.size() && ! overlap; ++i)
+        for (size_t j = i + 1; j < line_bbs.size() && ! overlap; ++j)
+            overlap = line_bbs[i].overlap(line_bbs[j]);
+    if (overlap) {
+        ExPolygonsWithIds all_lines;
+        for (ExPolygonsWithIds &line : lines)
+            append(all_lines, std::move(line));
+        return union_with_delta(all_lines, delta, MAX_HEAL_ITERATION_OF_TEXT);
+    }
+
+    std::vector<HealedExPolygons> healed_lines(lines.size());
+    tbb::parallel_for(size_t(0), lines.size(), [&lines, &healed_lines, delta](size_t line_index) {
+        healed_lines[line_index] = union_with_delta(lines[line_index], delta, MAX_HEAL_ITERATION_OF_TEXT);
+    });
+    HealedExPolygons result;
+    result.is_healed = true;
+    for (HealedExPolygons &healed_line : healed_lines) {
+        append(result.expolygons, std::move(healed_line.expolygons));
+        result.is_healed &= healed_line.is_healed;
+    }
+    return result;
 }
 
 namespace {
@@ -1663,8 +1703,8 @@ indexed_triangle_set polygons2model_duplicit(
 }
 } // namespace
 
-indexed_triangle_set Emboss::polygons2model(const ExPolygons &shape2d,
-                                            const IProjection &projection)
+namespace {
+indexed_triangle_set polygons2model_chunk(const ExPolygons &shape2d, const IProjection &projection)
 {
     Points points = to_points(shape2d);    
     Points duplicits = collect_duplicates(points);
@@ -1672,6 +1712,41 @@ indexed_triangle_set Emboss::polygons2model(const ExPolygons &shape2d,
         polygons2model_unique(shape2d, projection, points) :
         polygons2model_duplicit(shape2d, projection, points, duplicits);
 }
+} // namespace
+
+indexed_triangle_set Emboss::polygons2model(const ExPolygons &shape2d,
+                                            const IProjection &projection)
+{
+    // Long texts are triangulated in parallel, by chunks of whole expolygons.
+    // Vertices shared by expolygons of different chunks are not merged.
+    const size_t min_points_in_chunk = 4096;
+    size_t count_point = count_points(shape2d);
+    size_t count_chunks = std::min({shape2d.size(), count_point / min_points_in_chunk, 
+                                    4 * size_t(tbb::this_task_arena::max_concurrency())});
+    if (count_chunks < 2)
+        return polygons2model_chunk(shape2d, projection);
+
+    std::vector<size_t> chunk_starts{0};
+    for (size_t i = 0, points_in_chunk = 0; i + 1 < shape2d.size(); ++i) {
+        points_in_chunk += count_points(shape2d[i]);
+        if (points_in_chunk * count_chunks >= count_point) {
+            chunk_starts.push_back(i + 1);
+            points_in_chunk = 0;
+        }
+    }
+    chunk_starts.push_back(shape2d.size());
+
+    std::vector<indexed_triangle_set> chunks(chunk_starts.size() - 1);
+    tbb::parallel_for(size_t(0), chunks.size(), [&shape2d, &projection, &chunk_starts, &chunks](size_t chunk_index) {
+        ExPolygons chunk(shape2d.begin() + chunk_starts[chunk_index], shape2d.begin() + chunk_starts[chunk_index + 1]);
+        chunks[chunk_index] = polygons2model_chunk(chunk, projection);
+    });
+
+    indexed_triangle_set result;
+    for (indexed_triangle_set &chunk : chunks)
+        its_merge(result, std::move(chunk));
+    return result;
+}
 
 std::pair<Vec3d, Vec3d> Emboss::ProjectZ::create_front_back(const Point &p) const
 {
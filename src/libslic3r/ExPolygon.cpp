@@ -222,6 +222,11 @@ void ExPolygon::simplify(double tolerance, ExPolygons* expolygons) const
 
 void ExPolygon::medial_axis(double min_width, double max_width, ThickPolylines* polylines) const
 {
+    // Twice the distance of an inner point to the contour is limited by the smaller side of the bounding box.
+    // Skip building the Voronoi diagram if no part of the expolygon is at least min_width wide.
+    if (Vec2crd size = this->contour.bounding_box().size(); double(std::min(size.x(), size.y())) < min_width)
+        return;
+
     // init helper object
     Slic3r::Geometry::MedialAxis ma(min_width, max_width, *this);
     
@@ -61,7 +61,9 @@ public:
                     size_t     granularity = 1
                     )
     {
-        return tbb::parallel_reduce(
+        // The range is always split the same way and the partial results are merged in the same order,
+        // thus reductions of floating point values give identical results run to run.
+        return tbb::parallel_deterministic_reduce(
             tbb::blocked_range{from, to, granularity}, init,
             [&](const auto &range, T subinit) {
                 T acc = subinit;
@@ -74,6 +74,9 @@ public:
     double retract_restart_extra_toolchange() const;
 
 private:
+    // GCodeWriter rebinds m_config when being copied.
+    friend class GCodeWriter;
+
     // Private constructor to create a key for a search in std::set.
     Extruder(unsigned int id) : m_id(id) {}
 
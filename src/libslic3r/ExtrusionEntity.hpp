@@ -62,6 +62,9 @@ public:
     virtual Polylines as_polylines() const { Polylines dst; this->collect_polylines(dst); return dst; }
     virtual double length() const = 0;
     virtual double total_volume() const = 0;
+    // Release the excess capacity of the point vectors once the extrusions are final,
+    // extrusions of large prints are kept in memory until the G-code is exported.
+    virtual void shrink_to_fit() {}
 };
 
 using ExtrusionEntitiesPtr = std::vector<ExtrusionEntity*>;
@@ -195,6 +198,7 @@ public:
     void        collect_polylines(Polylines &dst) const override { if (! this->polyline.empty()) dst.emplace_back(this->polyline); }
     void        collect_points(Points &dst) const override { append(dst, this->polyline.points); }
     double      total_volume() const override { return m_attributes.mm3_per_mm * unscale<double>(length()); }
+    void        shrink_to_fit() override { this->polyline.points.shrink_to_fit(); }
 
 private:
     void        _inflate_collection(const Polylines &polylines, ExtrusionEntityCollection* collection) const;
@@ -267,6 +271,7 @@ public:
             append(dst, p.polyline.points);
     }
     double total_volume() const override { double volume =0.; for (const auto& path : paths) volume += path.total_volume(); return volume; }
+    void shrink_to_fit() override { this->paths.shrink_to_fit(); for (ExtrusionPath &path : this->paths) path.shrink_to_fit(); }
 };
 
 // Single continuous extrusion loop, possibly with varying extrusion thickness, extrusion height or bridging / non bridging.
@@ -337,6 +342,7 @@ public:
             append(dst, p.polyline.points);
     }
     double total_volume() const override { double volume =0.; for (const auto& path : paths) volume += path.total_volume(); return volume; }
+    void shrink_to_fit() override { this->paths.shrink_to_fit(); for (ExtrusionPath &path : this->paths) path.shrink_to_fit(); }
 
 #ifndef NDEBUG
 	bool validate() const {
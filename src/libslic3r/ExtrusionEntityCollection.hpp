@@ -129,6 +129,7 @@ public:
     ExtrusionEntityCollection flatten(bool preserve_ordering = false) const;
     double min_mm3_per_mm() const override;
     double total_volume() const override { double volume=0.; for (const auto& ent : entities) volume+=ent->total_volume(); return volume; }
+    void shrink_to_fit() override { this->entities.shrink_to_fit(); for (ExtrusionEntity *ent : entities) ent->shrink_to_fit(); }
 
     // Following methods shall never be called on an ExtrusionEntityCollection.
     Polyline as_polyline() const override {
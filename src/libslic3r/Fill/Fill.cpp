@@ -11,6 +11,9 @@
 #include <stdio.h>
 #include <memory>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include "../ClipperUtils.hpp"
 #include "../Geometry.hpp"
 #include "../Layer.hpp"
@@ -21,6 +24,7 @@
 #include "../PerimeterGenerator.hpp"
 
 #include "FillBase.hpp"
+#include "FillPlanePath.hpp"
 #include "FillRectilinear.hpp"
 #include "FillLightning.hpp"
 #include "FillConcentric.hpp"
@@ -442,7 +446,7 @@ void Layer::clear_fills()
 			island.fills.clear();
 }
 
-void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree, FillLightning::Generator* lightning_generator)
+void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree, FillLightning::Generator* lightning_generator, FillLinesCache* fill_lines_cache)
 {
 	this->clear_fills();
 
@@ -480,6 +484,11 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
         if (surface_fill.params.pattern == ipLightning)
             dynamic_cast<FillLightning::Filler*>(f.get())->generator = lightning_generator;
 
+        if (auto *fill_rectilinear = dynamic_cast<FillRectilinear*>(f.get()); fill_rectilinear)
+            fill_rectilinear->fill_lines_cache = fill_lines_cache;
+        else if (auto *fill_plane_path = dynamic_cast<FillPlanePath*>(f.get()); fill_plane_path)
+            fill_plane_path->fill_lines_cache = fill_lines_cache;
+
         if (surface_fill.params.pattern == ipEnsuring) {
             auto *fill_ensuring = dynamic_cast<FillEnsuring *>(f.get());
             assert(fill_ensuring != nullptr);
@@ -713,7 +722,78 @@ Polylines Layer::generate_sparse_infill_polylines_for_anchoring(FillAdaptive::Oc
     return sparse_infill_polylines;
 }
 
-// Create ironing extrusions over top surfaces.
+// Is the region to be ironed at this layer?
+static bool ironing_enabled(const LayerRegion &layerm)
+{
+	const PrintRegionConfig &config = layerm.region().config();
+	return config.ironing &&
+		(config.ironing_type == IroningType::AllSolid ||
+		 	(config.top_solid_layers > 0 &&
+				(config.ironing_type == IroningType::TopSurfaces ||
+			 	(config.ironing_type == IroningType::TopmostOnly && layerm.layer()->upper_layer == nullptr))));
+}
+
+// Calculate the areas to be ironed for each region, trimmed with half the nozzle diameter.
+// The areas are cached in LayerRegion, so that make_ironing() regenerates the ironing extrusions
+// without recalculating the areas if just the ironing flow, spacing or speed change.
+void Layer::make_ironing_areas()
+{
+	// Top surfaces trimmed with half the nozzle diameter, shared by the regions ironed with the same nozzle.
+	double   trim_nozzle_dmr = -1.;
+	Polygons trim_polygons;
+	for (LayerRegion *layerm : m_regions) {
+		layerm->m_ironing_areas.clear();
+		if (layerm->slices().empty() || ! ironing_enabled(*layerm))
+			continue;
+		const PrintRegionConfig  &region_config   = layerm->region().config();
+		bool					  iron_everything = region_config.ironing_type == IroningType::AllSolid;
+		bool					  iron_completely = iron_everything;
+		if (iron_everything) {
+			// Check whether there is any non-solid hole in the regions.
+			bool internal_infill_solid = region_config.fill_density.value > 95.;
+			for (const Surface &surface : layerm->fill_surfaces())
+				if ((! internal_infill_solid && surface.surface_type == stInternal) || surface.surface_type == stInternalBridge || surface.surface_type == stInternalVoid) {
+					// Some fill region is not quite solid. Don't iron over the whole surface.
+					iron_completely = false;
+					break;
+				}
+		}
+		Polygons polys;
+		if (iron_completely) {
+			// Iron everything. This is likely only good for solid transparent objects.
+			for (const Surface &surface : layerm->slices())
+				polygons_append(polys, surface.expolygon);
+		} else {
+			for (const Surface &surface : layerm->slices())
+				if (surface.surface_type == stTop || (iron_everything && surface.surface_type == stBottom))
+					// stBottomBridge is not being ironed on purpose, as it would likely destroy the bridges.
+					polygons_append(polys, surface.expolygon);
+		}
+		if (iron_everything && ! iron_completely) {
+			// Add solid fill surfaces. This may not be ideal, as one will not iron perimeters touching these
+			// solid fill surfaces, but it is likely better than nothing.
+			// For IroningType::AllSolid only:
+			// Add solid infill areas for layers, that contain some non-ironable infil (sparse infill, bridge infill).
+			size_t num_polys = polys.size();
+			for (const Surface &surface : layerm->fill_surfaces())
+				if (surface.surface_type == stInternalSolid)
+					polygons_append(polys, surface.expolygon);
+			if (polys.size() > num_polys)
+				polys = union_safety_offset(polys);
+		}
+		if (polys.empty())
+			continue;
+		// Trim the top surfaces with half the nozzle diameter.
+		double nozzle_dmr = this->object()->print()->config().nozzle_diameter.values[region_config.solid_infill_extruder - 1];
+		if (nozzle_dmr != trim_nozzle_dmr) {
+			trim_nozzle_dmr = nozzle_dmr;
+			trim_polygons   = offset(this->lslices, - float(scale_(0.5 * nozzle_dmr)));
+		}
+		layerm->m_ironing_areas = intersection_ex(polys, trim_polygons);
+	}
+}
+
+// Create ironing extrusions over the areas calculated by make_ironing_areas().
 void Layer::make_ironing()
 {
 	// LayerRegion::slices contains surfaces marked with SurfaceType.
@@ -787,33 +867,20 @@ void Layer::make_ironing()
     double default_layer_height = this->object()->config().layer_height;
 
 	for (uint32_t region_id = 0; region_id < uint32_t(this->regions().size()); ++region_id)
-		if (LayerRegion *layerm = this->get_region(region_id); ! layerm->slices().empty()) {
-			IroningParams ironing_params;
+		if (LayerRegion *layerm = this->get_region(region_id); ! layerm->m_ironing_areas.empty()) {
 			const PrintRegionConfig &config = layerm->region().config();
-			if (config.ironing && 
-				(config.ironing_type == IroningType::AllSolid ||
-				 	(config.top_solid_layers > 0 && 
-						(config.ironing_type == IroningType::TopSurfaces ||
-					 	(config.ironing_type == IroningType::TopmostOnly && layerm->layer()->upper_layer == nullptr))))) {
-				if (config.perimeter_extruder == config.solid_infill_extruder || config.perimeters == 0) {
-					// Iron the whole face.
-					ironing_params.extruder = config.solid_infill_extruder;
-				} else {
-					// Iron just the infill.
-					ironing_params.extruder = config.solid_infill_extruder;
-				}
-			}
-			if (ironing_params.extruder != -1) {
-				//TODO just_infill is currently not used.
-				ironing_params.just_infill 	= false;
-				ironing_params.line_spacing = config.ironing_spacing;
-				ironing_params.height 		= default_layer_height * 0.01 * config.ironing_flowrate;
-				ironing_params.speed 		= config.ironing_speed;
-				ironing_params.angle 		= config.fill_angle * M_PI / 180.;
-				ironing_params.layerm 		= layerm;
-				ironing_params.region_id    = region_id;
-				by_extruder.emplace_back(ironing_params);
-			}
+			IroningParams ironing_params;
+			// Ironing the whole face or just the infill, in both cases with the solid infill extruder.
+			ironing_params.extruder 	= config.solid_infill_extruder;
+			//TODO just_infill is currently not used.
+			ironing_params.just_infill 	= false;
+			ironing_params.line_spacing = config.ironing_spacing;
+			ironing_params.height 		= default_layer_height * 0.01 * config.ironing_flowrate;
+			ironing_params.speed 		= config.ironing_speed;
+			ironing_params.angle 		= config.fill_angle * M_PI / 180.;
+			ironing_params.layerm 		= layerm;
+			ironing_params.region_id    = region_id;
+			by_extruder.emplace_back(ironing_params);
 		}
 	std::sort(by_extruder.begin(), by_extruder.end());
 
@@ -839,58 +906,13 @@ void Layer::make_ironing()
 		// Create the ironing extrusions for regions <i, j)
 		ExPolygons ironing_areas;
 		double nozzle_dmr = this->object()->print()->config().nozzle_diameter.values[ironing_params.extruder - 1];
-		if (ironing_params.just_infill) {
-			//TODO just_infill is currently not used.
-			// Just infill.
+		if (j == i + 1) {
+			ironing_areas = ironing_params.layerm->m_ironing_areas;
 		} else {
-			// Infill and perimeter.
-			// Merge top surfaces with the same ironing parameters.
-			Polygons polys;
-			Polygons infills;
-			for (size_t k = i; k < j; ++ k) {
-				const IroningParams		 &ironing_params  = by_extruder[k];
-				const PrintRegionConfig  &region_config   = ironing_params.layerm->region().config();
-				bool					  iron_everything = region_config.ironing_type == IroningType::AllSolid;
-				bool					  iron_completely = iron_everything;
-				if (iron_everything) {
-					// Check whether there is any non-solid hole in the regions.
-					bool internal_infill_solid = region_config.fill_density.value > 95.;
-					for (const Surface &surface : ironing_params.layerm->fill_surfaces())
-						if ((! internal_infill_solid && surface.surface_type == stInternal) || surface.surface_type == stInternalBridge || surface.surface_type == stInternalVoid) {
-							// Some fill region is not quite solid. Don't iron over the whole surface.
-							iron_completely = false;
-							break;
-						}
-				}
-				if (iron_completely) {
-					// Iron everything. This is likely only good for solid transparent objects.
-					for (const Surface &surface : ironing_params.layerm->slices())
-						polygons_append(polys, surface.expolygon);
-				} else {
-					for (const Surface &surface : ironing_params.layerm->slices())
-						if (surface.surface_type == stTop || (iron_everything && surface.surface_type == stBottom))
-							// stBottomBridge is not being ironed on purpose, as it would likely destroy the bridges.
-							polygons_append(polys, surface.expolygon);
-				}
-				if (iron_everything && ! iron_completely) {
-					// Add solid fill surfaces. This may not be ideal, as one will not iron perimeters touching these
-					// solid fill surfaces, but it is likely better than nothing.
-					for (const Surface &surface : ironing_params.layerm->fill_surfaces())
-						if (surface.surface_type == stInternalSolid)
-							polygons_append(infills, surface.expolygon);
-				}
-			}
-
-			if (! infills.empty() || j > i + 1) {
-				// Ironing over more than a single region or over solid internal infill.
-				if (! infills.empty())
-					// For IroningType::AllSolid only:
-					// Add solid infill areas for layers, that contain some non-ironable infil (sparse infill, bridge infill).
-					append(polys, std::move(infills));
-				polys = union_safety_offset(polys);
-			}
-			// Trim the top surfaces with half the nozzle diameter.
-			ironing_areas = intersection_ex(polys, offset(this->lslices, - float(scale_(0.5 * nozzle_dmr))));
+			// Ironing over more than a single region: Merge the areas of the regions with the same ironing parameters.
+			for (size_t k = i; k < j; ++ k)
+				append(ironing_areas, by_extruder[k].layerm->m_ironing_areas);
+			ironing_areas = union_safety_offset_ex(ironing_areas);
 		}
 
         // Create the filler object.
@@ -900,15 +922,21 @@ void Layer::make_ironing()
 		double extrusion_height = ironing_params.height * fill.spacing / nozzle_dmr;
 		float  extrusion_width  = Flow::rounded_rectangle_extrusion_width_from_spacing(float(nozzle_dmr), float(extrusion_height));
 		double flow_mm3_per_mm = nozzle_dmr * extrusion_height;
-        Surface surface_fill(stTop, ExPolygon());
-        for (ExPolygon &expoly : ironing_areas) {
-			surface_fill.expolygon = std::move(expoly);
-			Polylines polylines;
-			try {
-                assert(!fill_params.use_arachne);
-				polylines = fill.fill_surface(&surface_fill, fill_params);
-			} catch (InfillFailedException &) {
+		// Fill the islands in parallel, each task with its own copy of the filler, as Fill::fill_surface() is not const.
+		std::vector<Polylines> polylines_by_island(ironing_areas.size());
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, ironing_areas.size()), [&fill, &fill_params, &ironing_areas, &polylines_by_island](const tbb::blocked_range<size_t> &range) {
+			FillRectilinear fill_island = fill;
+			Surface         surface_fill(stTop, ExPolygon());
+			for (size_t island_idx = range.begin(); island_idx < range.end(); ++ island_idx) {
+				surface_fill.expolygon = std::move(ironing_areas[island_idx]);
+				try {
+					assert(!fill_params.use_arachne);
+					polylines_by_island[island_idx] = fill_island.fill_surface(&surface_fill, fill_params);
+				} catch (InfillFailedException &) {
+				}
 			}
+		});
+        for (Polylines &polylines : polylines_by_island) {
 	        if (! polylines.empty()) {
 		        // Save into layer.
 				auto fill_begin = uint32_t(ironing_params.layerm->fills().size());
@@ -930,4 +958,29 @@ void Layer::make_ironing()
 	}
 }
 
+// Remove the ironing extrusions produced by make_ironing() from the regions and from the layer islands, keep the other fills.
+void Layer::clear_ironing()
+{
+	// The ironing extrusions are appended after the other fills of a region.
+	std::vector<uint32_t> fills_end(m_regions.size(), 0);
+	for (size_t region_id = 0; region_id < m_regions.size(); ++ region_id) {
+		ExtrusionEntitiesPtr &fills = m_regions[region_id]->m_fills.entities;
+		size_t 				  end   = fills.size();
+		while (end > 0 && fills[end - 1]->role() == ExtrusionRole::Ironing)
+			-- end;
+		for (size_t k = end; k < fills.size(); ++ k)
+			delete fills[k];
+		fills.erase(fills.begin() + end, fills.end());
+		fills_end[region_id] = uint32_t(end);
+	}
+	for (LayerSlice &lslice : lslices_ex)
+		for (LayerIsland &island : lslice.islands) {
+			size_t k = 0;
+			for (const LayerExtrusionRange &range : island.fills)
+				if (uint32_t end = std::min(*range.end(), fills_end[range.region()]); *range.begin() < end)
+					island.fills[k ++] = { range.region(), { *range.begin(), end } };
+			island.fills.erase(island.fills.begin() + k, island.fills.end());
+		}
+}
+
 } // namespace Slic3r
@@ -20,9 +20,7 @@
 #include <algorithm>
 #include <numeric>
 
-// Boost pool: Don't use mutexes to synchronize memory allocation.
-#define BOOST_POOL_NO_MT
-#include <boost/pool/object_pool.hpp>
+#include <tbb/parallel_for.h>
 
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point.hpp>
@@ -239,14 +237,25 @@ static constexpr std::array<std::array<int, 8>, 3> child_traversal_order {
     std::array<int, 8>{ 1, 5, 0, 4, 3, 7, 2, 6 },
 };
 
+// Node of the octree. The cubes are stored linearly in Octree::cubes, the children of a cube are stored consecutively
+// in the order of their child indices and only the existing children are stored. The centers of the cubes are not stored,
+// they are calculated from the center of the root cube and from Octree::child_offsets when traversing the octree.
 struct Cube
 {
-    Vec3d center;
-#ifndef NDEBUG
-    Vec3d center_octree;
-#endif // NDEBUG
-    std::array<Cube*, 8> children {}; // initialized to nullptrs
-    Cube(const Vec3d &center) : center(center) {}
+    // Index of the first child in Octree::cubes.
+    uint32_t children_begin { 0 };
+    // Bit mask of the existing children.
+    uint8_t  children_mask  { 0 };
+
+    bool     has_child(int child_idx) const { return (children_mask >> child_idx) & 1; }
+    // Index of an existing child in Octree::cubes.
+    uint32_t child(int child_idx) const {
+        assert(this->has_child(child_idx));
+        uint32_t idx = children_begin;
+        for (unsigned int mask = children_mask & ((1u << child_idx) - 1); mask != 0; mask &= mask - 1)
+            ++ idx;
+        return idx;
+    }
 };
 
 struct CubeProperties
@@ -260,17 +269,16 @@ struct CubeProperties
 
 struct Octree
 {
-    // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
-    // perfect for building up our octree.
-    boost::object_pool<Cube>    pool;
-    Cube*                       root_cube { nullptr };
-    Vec3d                       origin;
-    std::vector<CubeProperties> cubes_properties;
+    // All cubes of the octree, the first one is the root cube.
+    std::vector<Cube>                   cubes;
+    // Center of the root cube.
+    Vec3d                               origin;
+    std::vector<CubeProperties>         cubes_properties;
+    // Offsets of the centers of the child cubes from the center of their parent cube, indexed by the depth of the child cubes.
+    std::vector<std::array<Vec3d, 8>>   child_offsets;
 
     Octree(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties)
-        : root_cube(pool.construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
-
-    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+        : cubes(1), origin(origin), cubes_properties(cubes_properties) {}
 };
 
 void OctreeDeleter::operator()(Octree *p) {
@@ -372,6 +380,8 @@ struct FillContext
     };
 
     FillContext(const Octree &octree, double z_position, int direction_idx) :
+        cubes(octree.cubes),
+        child_offsets(octree.child_offsets),
         cubes_properties(octree.cubes_properties),
         z_position(z_position),
         traversal_order(child_traversal_order[direction_idx]),
@@ -385,7 +395,9 @@ struct FillContext
     // Rotate the point, uses the same convention as Point::rotate().
     Vec2d rotate(const Vec2d& v) { return Vec2d(this->cos_a * v.x() - this->sin_a * v.y(), this->sin_a * v.x() + this->cos_a * v.y()); }
 
-    const std::vector<CubeProperties>  &cubes_properties;
+    const std::vector<Cube>                 &cubes;
+    const std::vector<std::array<Vec3d, 8>> &child_offsets;
+    const std::vector<CubeProperties>       &cubes_properties;
     // Top of the current layer.
     const double                        z_position;
     // Order of traversal for this line direction.
@@ -418,7 +430,7 @@ Eigen::Quaterniond transform_to_octree()
 // therefore the infill line may get extended with O(1) time & space complexity.
 static bool verify_traversal_order(
     FillContext  &context,
-    const Cube   *cube,
+    const Vec3d  &center,
     int           depth,
     const Vec2d  &line_from,
     const Vec2d  &line_to)
@@ -427,9 +439,7 @@ static bool verify_traversal_order(
     Eigen::Quaterniond to_world = transform_to_world();
     for (int i = 0; i < 8; ++i) {
         int j = context.traversal_order[i];
-        Vec3d cntr = to_world * (cube->center_octree + (child_centers[j] * (context.cubes_properties[depth].edge_length / 4.)));
-        assert(!cube->children[j] || cube->children[j]->center.isApprox(cntr));
-        c[i] = cntr;
+        c[i] = center + to_world * (child_centers[j] * (context.cubes_properties[depth].edge_length / 4.));
     }
     std::array<Vec3d, 10> dirs = {
         c[1] - c[0], c[2] - c[0], c[3] - c[1], c[3] - c[2], c[3] - c[0],
@@ -452,15 +462,14 @@ static bool verify_traversal_order(
 
 static void generate_infill_lines_recursive(
     FillContext     &context,
-    const Cube      *cube,
+    const Cube      &cube,
+    const Vec3d     &center,
     // Address of this wall in the octree,  used to address context.temp_lines.
     int              address,
     int              depth)
 {
-    assert(cube != nullptr);
-
     const std::vector<CubeProperties> &cubes_properties = context.cubes_properties;
-    const double z_diff     = context.z_position - cube->center.z();
+    const double z_diff     = context.z_position - center.z();
     const double z_diff_abs = std::abs(z_diff);
 
     if (z_diff_abs > cubes_properties[depth].height / 2.)
@@ -476,12 +485,12 @@ static void generate_infill_lines_recursive(
         from = context.rotate(from);
         to   = context.rotate(to);
         // Relative to cube center
-        const Vec2d offset(cube->center.x(), cube->center.y());
+        const Vec2d offset(center.x(), center.y());
         from += offset;
         to   += offset;
         // Verify that the traversal order of the octree children matches the line direction,
         // therefore the infill line may get extended with O(1) time & space complexity.
-        assert(verify_traversal_order(context, cube, depth, from, to));
+        assert(verify_traversal_order(context, center, depth, from, to));
         // Either extend an existing line or start a new one.
         Line &last_line = context.temp_lines[address];
         Line  new_line(Point::new_scale(from), Point::new_scale(to));
@@ -499,9 +508,8 @@ static void generate_infill_lines_recursive(
     -- depth;
     size_t i = 0;
     for (const int child_idx : context.traversal_order) {
-        const Cube *child = cube->children[child_idx];
-        if (child != nullptr)
-            generate_infill_lines_recursive(context, child, address, depth);
+        if (cube.has_child(child_idx))
+            generate_infill_lines_recursive(context, context.cubes[cube.child(child_idx)], center + context.child_offsets[depth][child_idx], address, depth);
         if (++ i == 4)
             // right child index
             ++ address;
@@ -1341,7 +1349,7 @@ void Filler::_fill_surface_single(
         // Generate the infill lines along the octree cells, merge touching lines of the same direction.
         size_t num_lines = 0;
         for (auto &context : contexts) {
-            generate_infill_lines_recursive(context, adapt_fill_octree->root_cube, 0, int(adapt_fill_octree->cubes_properties.size()) - 1);
+            generate_infill_lines_recursive(context, adapt_fill_octree->cubes.front(), adapt_fill_octree->origin, 0, int(adapt_fill_octree->cubes_properties.size()) - 1);
             num_lines += context.output_lines.size() + context.temp_lines.size();
         }
 
@@ -1455,15 +1463,150 @@ static inline bool is_overhang_triangle(const Vec3d &a, const Vec3d &b, const Ve
     return n.dot(up) > 0.707 * n.norm();
 }
 
-static void transform_center(Cube *current_cube, const Eigen::Matrix3d &rot)
+// Slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
+// We will rather densify the octree a bit more than necessary instead of missing a triangle.
+static BoundingBoxf3 child_bbox(const BoundingBoxf3 &bbox, const Vec3d &center, int child_idx)
 {
-#ifndef NDEBUG
-    current_cube->center_octree = current_cube->center;
-#endif // NDEBUG
-    current_cube->center = rot * current_cube->center;
-    for (auto *child : current_cube->children)
-        if (child)
-            transform_center(child, rot);
+    const Vec3d  &child_center_dir = child_centers[child_idx];
+    BoundingBoxf3 out;
+    for (int k = 0; k < 3; ++ k) {
+        if (child_center_dir[k] == -1.) {
+            out.min[k] = bbox.min[k];
+            out.max[k] = center[k] + EPSILON;
+        } else {
+            out.min[k] = center[k] - EPSILON;
+            out.max[k] = bbox.max[k];
+        }
+    }
+    return out;
+}
+
+// Triangles of the mesh followed by the overhang triangles, addressed by a single index.
+struct OctreeTriangles
+{
+    const indexed_triangle_set  &mesh;
+    const std::vector<Vec3d>    &overhang_triangles;
+
+    std::array<Vec3d, 3> operator()(uint32_t idx) const {
+        if (idx < mesh.indices.size()) {
+            const stl_triangle_vertex_indices &tri = mesh.indices[idx];
+            return { mesh.vertices[tri[0]].cast<double>(), mesh.vertices[tri[1]].cast<double>(), mesh.vertices[tri[2]].cast<double>() };
+        }
+        idx = 3 * (idx - uint32_t(mesh.indices.size()));
+        return { overhang_triangles[idx], overhang_triangles[idx + 1], overhang_triangles[idx + 2] };
+    }
+};
+
+// Cubes of an octree under construction with their children addressed by their indices, zero for a missing child.
+using CubesUnderConstruction = std::vector<std::array<uint32_t, 8>>;
+
+static void insert_triangle(
+    CubesUnderConstruction              &cubes,
+    const std::vector<CubeProperties>   &cubes_properties,
+    const std::array<Vec3d, 3>          &triangle,
+    uint32_t                             cube_idx,
+    const Vec3d                         &center,
+    const BoundingBoxf3                 &bbox,
+    int                                  depth)
+{
+    assert(depth > 0);
+
+    --depth;
+
+    for (int i = 0; i < 8; ++ i) {
+        BoundingBoxf3 bbox_child = child_bbox(bbox, center, i);
+        if (triangle_AABB_intersects(triangle[0], triangle[1], triangle[2], bbox_child)) {
+            if (cubes[cube_idx][i] == 0) {
+                cubes[cube_idx][i] = uint32_t(cubes.size());
+                cubes.emplace_back();
+            }
+            if (depth > 0)
+                insert_triangle(cubes, cubes_properties, triangle, cubes[cube_idx][i],
+                    center + child_centers[i] * (cubes_properties[depth].edge_length / 2.), bbox_child, depth);
+        }
+    }
+}
+
+// Store the cubes breadth first, so that the children of each cube are stored consecutively.
+static std::vector<Cube> compact_cubes(const CubesUnderConstruction &cubes)
+{
+    std::vector<Cube>     out(1);
+    // Index of out[i] in cubes.
+    std::vector<uint32_t> map { 0 };
+    for (size_t i = 0; i < out.size(); ++ i) {
+        const std::array<uint32_t, 8> &children = cubes[map[i]];
+        Cube cube;
+        cube.children_begin = uint32_t(out.size());
+        for (int j = 0; j < 8; ++ j)
+            if (children[j] != 0) {
+                cube.children_mask |= uint8_t(1 << j);
+                out.emplace_back();
+                map.emplace_back(children[j]);
+            }
+        if (cube.children_mask == 0)
+            cube.children_begin = 0;
+        out[i] = cube;
+    }
+    return out;
+}
+
+// Build the cubes of a subtree rooted at a cube at the given depth from the triangles intersecting the cube.
+// The first cube returned is the root of the subtree. For the first parallel_levels levels, the triangles are split
+// among the child cubes and the subtrees of the child cubes are built in parallel.
+static std::vector<Cube> build_subtree(
+    const OctreeTriangles               &triangles,
+    const std::vector<uint32_t>         &triangle_indices,
+    const std::vector<CubeProperties>   &cubes_properties,
+    const Vec3d                         &center,
+    const BoundingBoxf3                 &bbox,
+    int                                  depth,
+    int                                  parallel_levels)
+{
+    assert(depth > 0);
+
+    if (parallel_levels == 0 || depth < 2) {
+        CubesUnderConstruction cubes(1);
+        for (uint32_t idx : triangle_indices)
+            insert_triangle(cubes, cubes_properties, triangles(idx), 0, center, bbox, depth);
+        return compact_cubes(cubes);
+    }
+
+    std::array<std::vector<Cube>, 8> subtrees;
+    tbb::parallel_for(0, 8, [&](int i) {
+        BoundingBoxf3 bbox_child = child_bbox(bbox, center, i);
+        std::vector<uint32_t> child_triangle_indices;
+        for (uint32_t idx : triangle_indices)
+            if (const std::array<Vec3d, 3> triangle = triangles(idx); triangle_AABB_intersects(triangle[0], triangle[1], triangle[2], bbox_child))
+                child_triangle_indices.emplace_back(idx);
+        if (! child_triangle_indices.empty())
+            subtrees[i] = build_subtree(triangles, child_triangle_indices, cubes_properties,
+                center + child_centers[i] * (cubes_properties[depth - 1].edge_length / 2.), bbox_child, depth - 1, parallel_levels - 1);
+    });
+
+    // The roots of the subtrees are the children of this cube, thus they are stored consecutively first,
+    // followed by the other cubes of the subtrees.
+    std::vector<Cube> out(1);
+    for (int i = 0; i < 8; ++ i)
+        if (! subtrees[i].empty()) {
+            out.front().children_mask |= uint8_t(1 << i);
+            out.emplace_back();
+        }
+    if (out.front().children_mask != 0)
+        out.front().children_begin = 1;
+    size_t child_idx = 1;
+    for (const std::vector<Cube> &subtree : subtrees)
+        if (! subtree.empty()) {
+            // Cubes of the subtree except for its root are appended, their indices shift by the same amount.
+            auto relocate = [shift = uint32_t(out.size() - 1)](Cube cube) {
+                if (cube.children_mask != 0)
+                    cube.children_begin += shift;
+                return cube;
+            };
+            out[child_idx ++] = relocate(subtree.front());
+            for (auto it = subtree.begin() + 1; it != subtree.end(); ++ it)
+                out.emplace_back(relocate(*it));
+        }
+    return out;
 }
 
 OctreePtr build_octree(
@@ -1484,73 +1627,35 @@ OctreePtr build_octree(
     auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
 
     if (cubes_properties.size() > 1) {
-        Octree *octree_ptr = octree.get();
+        OctreeTriangles       triangles { triangle_mesh, overhang_triangles };
+        std::vector<uint32_t> triangle_indices;
+        triangle_indices.reserve(triangle_mesh.indices.size() + overhang_triangles.size() / 3);
+        auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
+        for (uint32_t idx = 0; idx < uint32_t(triangle_mesh.indices.size()); ++ idx)
+            if (const std::array<Vec3d, 3> triangle = triangles(idx); ! support_overhangs_only || is_overhang_triangle(triangle[0], triangle[1], triangle[2], up_vector))
+                triangle_indices.emplace_back(idx);
+        for (size_t i = 0; i < overhang_triangles.size(); i += 3)
+            triangle_indices.emplace_back(uint32_t(triangle_mesh.indices.size() + i / 3));
+
         double edge_length_half = 0.5 * cubes_properties.back().edge_length;
         Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
         int    max_depth = int(cubes_properties.size()) - 1;
-        auto process_triangle = [octree_ptr, max_depth, diag_half](const Vec3d &a, const Vec3d &b, const Vec3d &c) {
-            octree_ptr->insert_triangle(
-                a, b, c,
-                octree_ptr->root_cube,
-                BoundingBoxf3(octree_ptr->root_cube->center - diag_half, octree_ptr->root_cube->center + diag_half),
-                max_depth);
-        };
-        auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
-        for (auto &tri : triangle_mesh.indices) {
-            auto a = triangle_mesh.vertices[tri[0]].cast<double>();
-            auto b = triangle_mesh.vertices[tri[1]].cast<double>();
-            auto c = triangle_mesh.vertices[tri[2]].cast<double>();
-            if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector))
-                process_triangle(a, b, c);
-        }
-        for (size_t i = 0; i < overhang_triangles.size(); i += 3)
-            process_triangle(overhang_triangles[i], overhang_triangles[i + 1], overhang_triangles[i + 2]);
+        // Splitting the first two levels yields up to 64 subtrees built in parallel.
+        octree->cubes = build_subtree(triangles, triangle_indices, cubes_properties,
+            cube_center, BoundingBoxf3(cube_center - diag_half, cube_center + diag_half), max_depth, 2);
         {
             // Transform the octree to world coordinates to reduce computation when extracting infill lines.
             auto rot = transform_to_world().toRotationMatrix();
-            transform_center(octree->root_cube, rot);
             octree->origin = rot * octree->origin;
+            octree->child_offsets.assign(cubes_properties.size(), {});
+            for (size_t depth = 0; depth < cubes_properties.size(); ++ depth)
+                for (int i = 0; i < 8; ++ i)
+                    octree->child_offsets[depth][i] = rot * (child_centers[i] * (cubes_properties[depth].edge_length / 2.));
         }
     }
 
     return octree;
 }
 
-void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
-{
-    assert(current_cube);
-    assert(depth > 0);
-
-    --depth;
-
-    // Squared radius of a sphere around the child cube.
-    // const double r2_cube = Slic3r::sqr(0.5 * this->cubes_properties[depth].height + EPSILON);
-
-    for (size_t i = 0; i < 8; ++ i) {
-        const Vec3d &child_center_dir = child_centers[i];
-        // Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
-        // We will rather densify the octree a bit more than necessary instead of missing a triangle.
-        BoundingBoxf3 bbox;
-        for (int k = 0; k < 3; ++ k) {
-            if (child_center_dir[k] == -1.) {
-                bbox.min[k] = current_bbox.min[k];
-                bbox.max[k] = current_cube->center[k] + EPSILON;
-            } else {
-                bbox.min[k] = current_cube->center[k] - EPSILON;
-                bbox.max[k] = current_bbox.max[k];
-            }
-        }
-        Vec3d child_center = current_cube->center + (child_center_dir * (this->cubes_properties[depth].edge_length / 2.));
-        //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
-        // dist2_to_triangle and r2_cube are commented out too.
-        if (triangle_AABB_intersects(a, b, c, bbox)) {
-            if (! current_cube->children[i])
-                current_cube->children[i] = this->pool.construct(child_center);
-            if (depth > 0)
-                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth);
-        }
-    }
-}
-
 } // namespace FillAdaptive
 } // namespace Slic3r
@@ -9,6 +9,7 @@
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <optional>
 
 #include "FillGyroid.hpp"
 
@@ -34,34 +35,55 @@ static inline double f(double x, double z_sin, double z_cos, bool vertical, bool
     }
 }
 
+// Only the samples of the wave between x_min and x_max are emitted, together with the first sample outside
+// of that range on either side, so that the polyline still spans the whole interval.
 static inline Polyline make_wave(
     const std::vector<Vec2d>& one_period, double width, double height, double offset, double scaleFactor,
-    double z_cos, double z_sin, bool vertical, bool flip)
+    double z_cos, double z_sin, bool vertical, bool flip, double x_min, double x_max)
 {
-    std::vector<Vec2d> points = one_period;
-    double period = points.back()(0);
-    if (width != period) // do not extend if already truncated
-    {
-        points.reserve(one_period.size() * size_t(floor(width / period)));
-        points.pop_back();
-
-        size_t n = points.size();
-        do {
-            points.emplace_back(points[points.size()-n].x() + period, points[points.size()-n].y());
-        } while (points.back()(0) < width - EPSILON);
-
-        points.emplace_back(Vec2d(width, f(width, z_sin, z_cos, vertical, flip)));
-    }
-
-    // and construct the final polyline to return:
     Polyline polyline;
-    polyline.points.reserve(points.size());
-    for (auto& point : points) {
+    std::optional<Vec2d> prev;
+    auto emit = [&](Vec2d point) {
         point(1) += offset;
         point(1) = std::clamp(double(point.y()), 0., height);
         if (vertical)
             std::swap(point(0), point(1));
         polyline.points.emplace_back((point * scaleFactor).cast<coord_t>());
+    };
+    // Returns false once the wave left the range.
+    auto add = [&](const Vec2d &point) {
+        if (point.x() < x_min) {
+            prev = point;
+            return true;
+        }
+        if (prev) {
+            emit(*prev);
+            prev.reset();
+        }
+        emit(point);
+        return point.x() <= x_max;
+    };
+
+    double period = one_period.back()(0);
+    if (width == period) { // do not extend if already truncated
+        for (const Vec2d &point : one_period)
+            if (! add(point))
+                break;
+    } else {
+        // Repeat the period, accumulating the x coordinates of the samples period by period.
+        size_t              n = one_period.size() - 1;
+        std::vector<double> x(n);
+        for (size_t i = 0; i < n; ++ i)
+            if (x[i] = one_period[i].x(); ! add(one_period[i]))
+                return polyline;
+        for (size_t i = 0;; i = (i + 1) % n) {
+            Vec2d point(x[i] += period, one_period[i].y());
+            if (! add(point))
+                return polyline;
+            if (point.x() >= width - EPSILON)
+                break;
+        }
+        add(Vec2d(width, f(width, z_sin, z_cos, vertical, flip)));
     }
 
     return polyline;
@@ -107,7 +129,34 @@ static std::vector<Vec2d> make_one_period(double width, double scaleFactor, doub
     return points;
 }
 
-static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height)
+// Extend [x_min, x_max] by the x range of the part of segment a, b with y_min <= y <= y_max.
+static inline void extend_by_segment_in_band(const Vec2d &a, const Vec2d &b, double y_min, double y_max, double &x_min, double &x_max)
+{
+    double t0 = 0.;
+    double t1 = 1.;
+    if (double dy = b.y() - a.y(); dy == 0.) {
+        if (a.y() < y_min || a.y() > y_max)
+            return;
+    } else {
+        double ta = (y_min - a.y()) / dy;
+        double tb = (y_max - a.y()) / dy;
+        if (ta > tb)
+            std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+        if (t0 > t1)
+            return;
+    }
+    double xa = a.x() + t0 * (b.x() - a.x());
+    double xb = a.x() + t1 * (b.x() - a.x());
+    x_min = std::min(x_min, std::min(xa, xb));
+    x_max = std::max(x_max, std::max(xa, xb));
+}
+
+// Generate the waves covering the contour (in scaled coordinates, relative to the origin of the pattern).
+// Each wave is trimmed to the extent of the contour inside the horizontal band covered by the wave,
+// so that the samples far outside of the fill area are neither generated nor clipped later.
+static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height, const Polygon &contour, const Point &origin)
 {
     const double scaleFactor = scale_(line_spacing) / density_adjusted;
 
@@ -135,15 +184,49 @@ static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double
     std::vector<Vec2d> one_period_odd = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance); // creates one period of the waves, so it doesn't have to be recalculated all the time
     flip = !flip;                                                                   // even polylines are a bit shifted
     std::vector<Vec2d> one_period_even = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance);
-    Polylines result;
+    // The last point of both the odd and the even waves.
+    const double       end_y           = f(width, z_sin, z_cos, vertical, flip);
 
+    // The contour in the coordinates of the waves.
+    std::vector<Vec2d> contour_waves;
+    contour_waves.reserve(contour.size());
+    for (const Point &pt : contour.points) {
+        Vec2d p = (pt - origin).cast<double>() / scaleFactor;
+        if (vertical)
+            std::swap(p(0), p(1));
+        contour_waves.emplace_back(p);
+    }
+    // A few scaled units to cover the rounding of the wave samples.
+    const double margin = 2. / scaleFactor;
+    auto add_wave = [&](Polylines &out, const std::vector<Vec2d> &one_period, double y0) {
+        // The waves are piecewise linear, thus they stay within the range of their samples.
+        double y_min = end_y;
+        double y_max = end_y;
+        for (const Vec2d &pt : one_period) {
+            y_min = std::min(y_min, pt.y());
+            y_max = std::max(y_max, pt.y());
+        }
+        y_min = std::clamp(y_min + y0, 0., height) - margin;
+        y_max = std::clamp(y_max + y0, 0., height) + margin;
+        double x_min = std::numeric_limits<double>::max();
+        double x_max = std::numeric_limits<double>::lowest();
+        if (! contour_waves.empty())
+            for (size_t i = 0, j = contour_waves.size() - 1; i < contour_waves.size(); j = i ++)
+                extend_by_segment_in_band(contour_waves[j], contour_waves[i], y_min, y_max, x_min, x_max);
+        if (x_min <= x_max)
+            if (Polyline wave = make_wave(one_period, width, height, y0, scaleFactor, z_cos, z_sin, vertical, flip, x_min - margin, x_max + margin);
+                wave.size() >= 2)
+                out.emplace_back(std::move(wave));
+    };
+
+    Polylines result;
     for (double y0 = lower_bound; y0 < upper_bound + EPSILON; y0 += M_PI) {
         // creates odd polylines
-        result.emplace_back(make_wave(one_period_odd, width, height, y0, scaleFactor, z_cos, z_sin, vertical, flip));
+        add_wave(result, one_period_odd, y0);
         // creates even polylines
         y0 += M_PI;
         if (y0 < upper_bound + EPSILON) {
-            result.emplace_back(make_wave(one_period_even, width, height, y0, scaleFactor, z_cos, z_sin, vertical, flip));
+            add_wave(result, one_period_even, y0);
         }
     }
 
@@ -179,7 +262,9 @@ void FillGyroid::_fill_surface_single(
         density_adjusted,
         this->spacing,
         ceil(bb.size()(0) / distance) + 1.,
-        ceil(bb.size()(1) / distance) + 1.);
+        ceil(bb.size()(1) / distance) + 1.,
+        expolygon.contour,
+        bb.min);
 
 	// shift the polyline to the grid origin
 	for (Polyline &pl : polylines)
@@ -8,71 +8,188 @@
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
 #include "../ClipperUtils.hpp"
+#include "../EdgeGrid.hpp"
+#include "../Line.hpp"
 #include "../ShortestPath.hpp"
 #include "../Surface.hpp"
 
 #include "FillPlanePath.hpp"
 
+#include <typeinfo>
+#include <unordered_map>
+
 namespace Slic3r {
 
-class InfillPolylineClipper : public FillPlanePath::InfillPolylineOutput {
-public:
-    InfillPolylineClipper(const BoundingBox bbox, const double scale_out) : FillPlanePath::InfillPolylineOutput(scale_out), m_bbox(bbox) {}
+std::shared_ptr<const FillLinesCache::Curve> FillPlanePath::curve(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const double resolution, const double scale_out)
+{
+    // The curve depends on the pattern, on the bounding box and the resolution in the units of line spacing and on the line spacing.
+    std::string key;
+    if (this->fill_lines_cache) {
+        key = typeid(*this).name();
+        for (coord_t v : { min_x, min_y, max_x, max_y })
+            key.append(reinterpret_cast<const char*>(&v), sizeof(v));
+        for (double v : { resolution, scale_out })
+            key.append(reinterpret_cast<const char*>(&v), sizeof(v));
+        if (std::shared_ptr<const FillLinesCache::Curve> cached = this->fill_lines_cache->find_curve(key); cached)
+            return cached;
+    }
 
-    void            add_point(const Vec2d &pt);
-    Points&&        result() { return std::move(m_out); }
-    bool            clips() const override { return true; }
+    auto out = std::make_shared<FillLinesCache::Curve>();
+    InfillPolylineOutput output(scale_out);
+    this->generate(min_x, min_y, max_x, max_y, resolution, output);
+    out->points = std::move(output.result());
+    constexpr const size_t chunk_size = FillLinesCache::Curve::chunk_size;
+    for (size_t begin = 0; begin + 1 < out->points.size(); begin += chunk_size) {
+        size_t      end = std::min(begin + chunk_size, out->points.size() - 1);
+        BoundingBox bbox(out->points[begin], out->points[begin]);
+        for (size_t i = begin + 1; i <= end; ++ i)
+            bbox.merge(out->points[i]);
+        out->chunk_bboxes.emplace_back(bbox);
+    }
+    if (this->fill_lines_cache)
+        this->fill_lines_cache->insert_curve(std::move(key), out);
+    return out;
+}
 
-private:
-    enum class Side {
-        Left   = 1,
-        Right  = 2,
-        Top    = 4,
-        Bottom = 8
-    };
+// Clip the curve with the expolygon. Only the chunks of the curve crossing the boundary of the expolygon are clipped by Clipper,
+// the chunks inside are taken, the chunks outside are dropped. The boundary chunks are found with an EdgeGrid over the expolygon.
+static Polylines clip_curve(const FillLinesCache::Curve &curve, const ExPolygon &expolygon, coord_t grid_resolution)
+{
+    constexpr const size_t chunk_size = FillLinesCache::Curve::chunk_size;
+    const Points          &points     = curve.points;
+    const size_t           num_chunks = curve.chunk_bboxes.size();
+    auto                   chunk_end  = [&points](size_t chunk) { return std::min((chunk + 1) * chunk_size, points.size() - 1); };
 
-    int sides(const Point &p) const {
-        return int(p.x() < m_bbox.min.x()) * int(Side::Left) +
-               int(p.x() > m_bbox.max.x()) * int(Side::Right) +
-               int(p.y() < m_bbox.min.y()) * int(Side::Bottom) +
-               int(p.y() > m_bbox.max.y()) * int(Side::Top);
+    // 1) Classify the chunks, collect the chunks crossing the boundary.
+    enum class ChunkType : unsigned char {
+        // Bounding box of the chunk does not overlap the expolygon.
+        Outside,
+        // The chunk does not cross the expolygon boundary, it is either completely inside or completely outside.
+        NoBoundary,
+        Boundary
     };
+    const BoundingBox      bbox = get_extents(expolygon);
+    EdgeGrid::Grid         grid;
+    grid.create(expolygon, grid_resolution);
+    std::vector<ChunkType> chunk_types(num_chunks, ChunkType::Outside);
+    Polylines              boundary_chunks;
+    for (size_t chunk = 0; chunk < num_chunks; ++ chunk)
+        if (const BoundingBox &chunk_bbox = curve.chunk_bboxes[chunk]; chunk_bbox.overlap(bbox)) {
+            bool boundary = false;
+            auto visitor  = [&grid, &boundary](coord_t iy, coord_t ix) {
+                auto [begin, end] = grid.cell_data_range(iy, ix);
+                boundary = begin != end;
+                return ! boundary;
+            };
+            grid.visit_cells_intersecting_box(chunk_bbox.inflated(SCALED_EPSILON), visitor);
+            chunk_types[chunk] = boundary ? ChunkType::Boundary : ChunkType::NoBoundary;
+            if (boundary)
+                boundary_chunks.emplace_back(Points(points.begin() + chunk * chunk_size, points.begin() + chunk_end(chunk) + 1));
+        }
 
-    // Bounding box to clip the polyline with.
-    BoundingBox m_bbox;
-
-    // Classification of the two last points processed.
-    int         m_sides_prev;
-    int         m_sides_this;
-};
-
-void InfillPolylineClipper::add_point(const Vec2d &fpt)
-{
-    const Point pt{ this->scaled(fpt) };
+    // Clipper mangles the open paths starting or ending with a horizontal segment inside the clipping polygon, it swaps or drops
+    // their end points. Nudge such end points by a single unit and put them back after clipping.
+    std::unordered_map<Point, Point, PointHash> nudged;
+    auto nudge = [&nudged](Point &pt, const Point &next) {
+        if (pt.y() == next.y()) {
+            Point moved(pt.x(), pt.y() + 1);
+            nudged.emplace(moved, pt);
+            pt = moved;
+        }
+    };
+    for (Polyline &pl : boundary_chunks) {
+        nudge(pl.points.front(), pl.points[1]);
+        nudge(pl.points.back(), pl.points[pl.size() - 2]);
+    }
+    Polylines pieces = intersection_pl(boundary_chunks, expolygon);
+    if (! nudged.empty())
+        for (Polyline &piece : pieces)
+            for (Point *pt : { &piece.points.front(), &piece.points.back() })
+                if (auto it = nudged.find(*pt); it != nudged.end())
+                    *pt = it->second;
+    // End points of the clipped pieces. Clipper keeps the points of the chunks inside the expolygon, thus the chunks are joined
+    // with their neighbors at their end points.
+    std::unordered_multimap<Point, size_t, PointHash> piece_ends;
+    for (size_t i = 0; i < pieces.size(); ++ i) {
+        piece_ends.emplace(pieces[i].first_point(), i);
+        piece_ends.emplace(pieces[i].last_point(), i);
+    }
+    std::vector<bool> piece_used(pieces.size(), false);
+    // Find a piece starting or ending with pt. If next is provided, the piece has to continue from pt along the curve segment (pt, next),
+    // as the end point of a chunk is shared with the neighbor chunk. The end points of the segments clipped by Clipper are rounded.
+    auto find_piece = [&pieces, &piece_ends, &piece_used](const Point &pt, const Point *next) -> int {
+        auto [begin, end] = piece_ends.equal_range(pt);
+        for (auto it = begin; it != end; ++ it)
+            if (const Polyline &piece = pieces[it->second]; next == nullptr)
+                return int(it->second);
+            else if (! piece_used[it->second]) {
+                const Point &neighbor = piece.first_point() == pt ? piece.points[1] : piece.points[piece.size() - 2];
+                if (Line(pt, *next).distance_to_squared(neighbor) <= 4.)
+                    return int(it->second);
+            }
+        return -1;
+    };
 
-    if (m_out.size() < 2) {
-        // Collect the two first points and their status.
-        (m_out.empty() ? m_sides_prev : m_sides_this) = sides(pt);
-        m_out.emplace_back(pt);
-    } else {
-        // Classify the last inserted point, possibly remove it.
-        int sides_next = sides(pt);
-        if (// This point is inside. Take it.
-            m_sides_this == 0 ||
-            // Either this point is outside and previous or next is inside, or
-            // the edge possibly cuts corner of the bounding box.
-            (m_sides_prev & m_sides_this & sides_next) == 0) {
-            // Keep the last point.
-            m_sides_prev = m_sides_this;
-        } else {
-            // All the three points (this, prev, next) are outside at the same side.
-            // Ignore the last point.
-            m_out.pop_back();
+    // 2) Chain the chunks inside with the clipped pieces in the order of the curve.
+    Polylines out;
+    // Does out.back() end with the first point of the chunk being processed?
+    bool      open   = false;
+    // Is the first point of a chunk not crossing the boundary inside the expolygon?
+    bool      inside = false;
+    for (size_t chunk = 0; chunk < num_chunks; ++ chunk) {
+        const Point &start = points[chunk * chunk_size];
+        const Point &end   = points[chunk_end(chunk)];
+        switch (chunk_types[chunk]) {
+        case ChunkType::Outside:
+            open = false;
+            break;
+        case ChunkType::NoBoundary:
+            if (chunk == 0)
+                inside = expolygon.contains(start);
+            else if (chunk_types[chunk - 1] == ChunkType::Outside)
+                inside = false;
+            else if (chunk_types[chunk - 1] == ChunkType::Boundary)
+                inside = find_piece(start, nullptr) != -1;
+            if (inside) {
+                if (! open)
+                    out.push_back(Polyline(Points{ start }));
+                out.back().points.insert(out.back().points.end(), points.begin() + chunk * chunk_size + 1, points.begin() + chunk_end(chunk) + 1);
+                open = true;
+            } else
+                open = false;
+            break;
+        case ChunkType::Boundary:
+        {
+            int first = find_piece(start, &points[chunk * chunk_size + 1]);
+            if (first != -1) {
+                Polyline &piece = pieces[first];
+                piece_used[first] = true;
+                if (piece.first_point() != start)
+                    piece.reverse();
+                if (open)
+                    out.back().points.insert(out.back().points.end(), piece.points.begin() + 1, piece.points.end());
+                else
+                    out.emplace_back(std::move(piece));
+            }
+            open = first != -1 && out.back().last_point() == end;
+            if (! open)
+                if (int last = find_piece(end, &points[chunk_end(chunk) - 1]); last != -1) {
+                    Polyline &piece = pieces[last];
+                    piece_used[last] = true;
+                    if (piece.last_point() != end)
+                        piece.reverse();
+                    out.emplace_back(std::move(piece));
+                    open = true;
+                }
+            break;
+        }
         }
-        // And save the current point.
-        m_out.emplace_back(pt);
-        m_sides_this = sides_next;
     }
+    // The pieces not touching the ends of their chunks.
+    for (size_t i = 0; i < pieces.size(); ++ i)
+        if (! piece_used[i])
+            out.emplace_back(std::move(pieces[i]));
+    return out;
 }
 
 void FillPlanePath::_fill_surface_single(
@@ -104,7 +221,7 @@ void FillPlanePath::_fill_surface_single(
     expolygon.translate(-shift.x(), -shift.y());
     bounding_box.translate(-shift.x(), -shift.y());
 
-    Polyline polyline;
+    Polylines polylines;
     {
         auto distance_between_lines = scaled<double>(this->spacing) / params.density;
         auto min_x = coord_t(ceil(coordf_t(bounding_box.min.x()) / distance_between_lines));
@@ -112,22 +229,13 @@ void FillPlanePath::_fill_surface_single(
         auto max_x = coord_t(ceil(coordf_t(bounding_box.max.x()) / distance_between_lines));
         auto max_y = coord_t(ceil(coordf_t(bounding_box.max.y()) / distance_between_lines));
         auto resolution = scaled<double>(params.resolution) / distance_between_lines;
-        if (align) {
-            // Filling in a bounding box over the whole object, clip generated polyline against the snug bounding box.
-            snug_bounding_box.translate(-shift.x(), -shift.y());
-            InfillPolylineClipper output(snug_bounding_box, distance_between_lines);
-            this->generate(min_x, min_y, max_x, max_y, resolution, output);
-            polyline.points = std::move(output.result());
-        } else {
-            // Filling in a snug bounding box, no need to clip.
-            InfillPolylineOutput output(distance_between_lines);
-            this->generate(min_x, min_y, max_x, max_y, resolution, output);
-            polyline.points = std::move(output.result());
-        }
+        // When aligned, the curve is generated over the whole object and it is shared by all the layers through fill_lines_cache.
+        // Only the chunks of the curve close to the expolygon are considered for clipping.
+        std::shared_ptr<const FillLinesCache::Curve> curve = this->curve(min_x, min_y, max_x, max_y, resolution, distance_between_lines);
+        polylines = clip_curve(*curve, expolygon, std::max<coord_t>(1, coord_t(4. * distance_between_lines)));
     }
 
-    if (polyline.size() >= 2) {
-        Polylines polylines = intersection_pl(polyline, expolygon);
+    if (! polylines.empty()) {
         Polylines chained;
         if (params.dont_connect() || params.density > 0.5 || polylines.size() <= 1)
             chained = chain_polylines(std::move(polylines));
@@ -167,10 +275,7 @@ static void generate_archimedean_chords(coord_t min_x, coord_t min_y, coord_t ma
 
 void FillArchimedeanChords::generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const double resolution, InfillPolylineOutput &output)
 {
-    if (output.clips())
-        generate_archimedean_chords(min_x, min_y, max_x, max_y, resolution, static_cast<InfillPolylineClipper&>(output));
-    else
-        generate_archimedean_chords(min_x, min_y, max_x, max_y, resolution, output);
+    generate_archimedean_chords(min_x, min_y, max_x, max_y, resolution, output);
 }
 
 // Adapted from 
@@ -242,10 +347,7 @@ static void generate_hilbert_curve(coord_t min_x, coord_t min_y, coord_t max_x,
 
 void FillHilbertCurve::generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const double /* resolution */, InfillPolylineOutput &output)
 {
-    if (output.clips())
-        generate_hilbert_curve(min_x, min_y, max_x, max_y, static_cast<InfillPolylineClipper&>(output));
-    else
-        generate_hilbert_curve(min_x, min_y, max_x, max_y, output);
+    generate_hilbert_curve(min_x, min_y, max_x, max_y, output);
 }
 
 template<typename Output>
@@ -282,10 +384,7 @@ static void generate_octagram_spiral(coord_t min_x, coord_t min_y, coord_t max_x
 
 void FillOctagramSpiral::generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const double /* resolution */, InfillPolylineOutput &output)
 {
-    if (output.clips())
-        generate_octagram_spiral(min_x, min_y, max_x, max_y, static_cast<InfillPolylineClipper&>(output));
-    else
-        generate_octagram_spiral(min_x, min_y, max_x, max_y, output);
+    generate_octagram_spiral(min_x, min_y, max_x, max_y, output);
 }
 
 } // namespace Slic3r
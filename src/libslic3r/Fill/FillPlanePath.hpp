@@ -11,10 +11,12 @@
 #define slic3r_FillPlanePath_hpp_
 
 #include <map>
+#include <memory>
 
 #include "../libslic3r.h"
 
 #include "FillBase.hpp"
+#include "FillRectilinear.hpp"
 
 namespace Slic3r {
 
@@ -27,6 +29,9 @@ class FillPlanePath : public Fill
 public:
     ~FillPlanePath() override = default;
 
+    // Optional, shared by the fillers of all layers of a PrintObject.
+    FillLinesCache *fill_lines_cache = nullptr;
+
 protected:
     void _fill_surface_single(
         const FillParams                &params, 
@@ -38,7 +43,6 @@ protected:
     float _layer_angle(size_t idx) const override { return 0.f; }
     virtual bool centered() const = 0;
 
-    friend class InfillPolylineClipper;
     class InfillPolylineOutput {
     public:
         InfillPolylineOutput(const double scale_out) : m_scale_out(scale_out) {}
@@ -46,7 +50,6 @@ protected:
         void            reserve(size_t n) { m_out.reserve(n); }
         void            add_point(const Vec2d& pt) { m_out.emplace_back(this->scaled(pt)); }
         Points&& result() { return std::move(m_out); }
-        virtual bool    clips() const { return false; }
 
     protected:
         const Point     scaled(const Vec2d &fpt) const { return { coord_t(floor(fpt.x() * m_scale_out + 0.5)), coord_t(floor(fpt.y() * m_scale_out + 0.5)) }; }
@@ -60,6 +63,10 @@ protected:
     };
 
     virtual void generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const double resolution, InfillPolylineOutput &output) = 0;
+
+private:
+    // Generate the curve over the bounding box in the units of line spacing, or take it from fill_lines_cache.
+    std::shared_ptr<const FillLinesCache::Curve> curve(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const double resolution, const double scale_out);
 };
 
 class FillArchimedeanChords : public FillPlanePath
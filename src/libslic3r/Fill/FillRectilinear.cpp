@@ -1055,10 +1055,58 @@ bool validate_segment_intersection_connectivity(const std::vector<SegmentedInter
 // Connect each contour / vertical line intersection point with another two contour / vertical line intersection points.
 // (fill in SegmentIntersection::{prev_on_contour, prev_on_contour_vertical, next_on_contour, next_on_contour_vertical}.
 // These contour points are either on the same vertical line, or on the vertical line left / right to the current one.
+// Indices of the intersections of a vertical line sorted by their contour, type and position along the vertical line,
+// so that the intersections of a single contour and orientation are found in logarithmic time.
+// Without this index, connecting the intersections of a region with many holes is quadratic in the number of holes.
+class IntersectionsByContour
+{
+public:
+    explicit IntersectionsByContour(const SegmentedIntersectionLine &il) : m_il(&il) {
+        m_sorted.reserve(il.intersections.size());
+        for (int i = 0; i < int(il.intersections.size()); ++ i)
+            m_sorted.emplace_back(i);
+        // Stable sort keeps the intersections of the same contour and type ordered along the vertical line.
+        std::stable_sort(m_sorted.begin(), m_sorted.end(), [this](int i1, int i2) { return this->key(i1) < this->key(i2); });
+    }
+
+    // Indices of the intersections of contour iContour of the given type, in ascending order.
+    std::pair<std::vector<int>::const_iterator, std::vector<int>::const_iterator> find(size_t iContour, SegmentIntersection::SegmentIntersectionType type) const {
+        struct Less {
+            const IntersectionsByContour &self;
+            bool operator()(int i, const Key &k) const { return self.key(i) < k; }
+            bool operator()(const Key &k, int i) const { return k < self.key(i); }
+        };
+        return std::equal_range(m_sorted.begin(), m_sorted.end(), Key{ iContour, type }, Less{ *this });
+    }
+
+private:
+    using Key = std::pair<size_t, SegmentIntersection::SegmentIntersectionType>;
+    Key key(int i) const { const SegmentIntersection &itsct = m_il->intersections[i]; return { itsct.iContour, itsct.type }; }
+
+    const SegmentedIntersectionLine *m_il;
+    std::vector<int>                 m_sorted;
+};
+
+static inline SegmentIntersection::SegmentIntersectionType opposite_type(SegmentIntersection::SegmentIntersectionType type)
+{
+    switch (type) {
+    case SegmentIntersection::OUTER_LOW:  return SegmentIntersection::OUTER_HIGH;
+    case SegmentIntersection::OUTER_HIGH: return SegmentIntersection::OUTER_LOW;
+    case SegmentIntersection::INNER_LOW:  return SegmentIntersection::INNER_HIGH;
+    case SegmentIntersection::INNER_HIGH: return SegmentIntersection::INNER_LOW;
+    default:                              assert(false); return type;
+    }
+}
+
 static void connect_segment_intersections_by_contours(
 	const ExPolygonWithOffset &poly_with_offset, std::vector<SegmentedIntersectionLine> &segs,
 	const FillParams &params, const coord_t link_max_length)
 {
+    std::vector<IntersectionsByContour> by_contour;
+    by_contour.reserve(segs.size());
+    for (const SegmentedIntersectionLine &il : segs)
+        by_contour.emplace_back(il);
+
     for (size_t i_vline = 0; i_vline < segs.size(); ++ i_vline) {
 	    SegmentedIntersectionLine       &il      = segs[i_vline];
 	    const SegmentedIntersectionLine *il_prev = i_vline > 0 ? &segs[i_vline - 1] : nullptr;
@@ -1073,20 +1121,17 @@ static void connect_segment_intersections_by_contours(
 		    // Find an intersection point on il_prev, intersecting i_intersection
 		    // at the same orientation as i_intersection, and being closest to i_intersection
 		    // in the number of contour segments, when following the direction of the contour.
-            //FIXME this has O(n) time complexity. Likely an O(log(n)) scheme is possible.
+            // Only the intersection points lying on the same contour and having the same orientation are considered.
 		    int iprev  = -1;
             int d_prev = std::numeric_limits<int>::max();
 		    if (il_prev) {
-                for (int i = 0; i < int(il_prev->intersections.size()); ++ i) {
-			        const SegmentIntersection &itsct2 = il_prev->intersections[i];
-			        if (itsct.iContour == itsct2.iContour && itsct.type == itsct2.type) {
-			            // The intersection points lie on the same contour and have the same orientation.
-			            // Find the intersection point with a shortest path in the direction of the contour.
-			            int d = distance_of_segmens(poly, itsct2.iSegment, itsct.iSegment, forward);
-			            if (d < d_prev) {
-			                iprev = i;
-                            d_prev = d;
-			            }
+                for (auto [it, it_end] = by_contour[i_vline - 1].find(itsct.iContour, itsct.type); it != it_end; ++ it) {
+			        const SegmentIntersection &itsct2 = il_prev->intersections[*it];
+			        // Find the intersection point with a shortest path in the direction of the contour.
+			        int d = distance_of_segmens(poly, itsct2.iSegment, itsct.iSegment, forward);
+			        if (d < d_prev) {
+			            iprev = *it;
+                        d_prev = d;
 			        }
 			    }
 			}
@@ -1095,16 +1140,13 @@ static void connect_segment_intersections_by_contours(
 		    int inext  = -1;
             int d_next = std::numeric_limits<int>::max();
             if (il_next) {
-                for (int i = 0; i < int(il_next->intersections.size()); ++ i) {
-			        const SegmentIntersection &itsct2 = il_next->intersections[i];
-			        if (itsct.iContour == itsct2.iContour && itsct.type == itsct2.type) {
-			            // The intersection points lie on the same contour and have the same orientation.
-			            // Find the intersection point with a shortest path in the direction of the contour.
-			            int d = distance_of_segmens(poly, itsct.iSegment, itsct2.iSegment, forward);
-			            if (d < d_next) {
-			                inext = i;
-                            d_next = d;
-			            }
+                for (auto [it, it_end] = by_contour[i_vline + 1].find(itsct.iContour, itsct.type); it != it_end; ++ it) {
+			        const SegmentIntersection &itsct2 = il_next->intersections[*it];
+			        // Find the intersection point with a shortest path in the direction of the contour.
+			        int d = distance_of_segmens(poly, itsct.iSegment, itsct2.iSegment, forward);
+			        if (d < d_next) {
+			            inext = *it;
+                        d_next = d;
 			        }
 			    }
 			}
@@ -1113,9 +1155,10 @@ static void connect_segment_intersections_by_contours(
             bool same_prev = false;
             bool same_next = false;
             // Does the perimeter intersect the current vertical line above intrsctn?
-            for (int i = 0; i < int(il.intersections.size()); ++ i)
-                if (const SegmentIntersection &it2 = il.intersections[i];
-                    i != i_intersection && it2.iContour == itsct.iContour && it2.type != itsct.type) {
+            // A contour is either outer or inner, thus the intersections of the same contour with a different type have the opposite orientation.
+            for (auto [it_idx, it_idx_end] = by_contour[i_vline].find(itsct.iContour, opposite_type(itsct.type)); it_idx != it_idx_end; ++ it_idx)
+                if (const int i = *it_idx; i != i_intersection) {
+                    const SegmentIntersection &it2 = il.intersections[i];
                     int d = distance_of_segmens(poly, it2.iSegment, itsct.iSegment, forward);
                     if (d < d_prev) {
                         iprev     = i;
@@ -2744,6 +2787,85 @@ static void polylines_from_paths(const std::vector<MonotonicRegionLink> &path, c
     }
 }
 
+std::shared_ptr<const FillLinesCache::Lines> FillLinesCache::find(const std::string &key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_lines.find(key);
+    return it == m_lines.end() ? nullptr : it->second;
+}
+
+void FillLinesCache::insert(std::string &&key, std::shared_ptr<const Lines> lines)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Another thread may have filled the same region in the meantime.
+    if (auto [it, inserted] = m_lines.emplace(std::move(key), std::move(lines)); inserted) {
+        m_order.emplace_back(&it->first);
+        if (m_order.size() > max_entries) {
+            m_lines.erase(m_lines.find(*m_order.front()));
+            m_order.pop_front();
+        }
+    }
+}
+
+std::shared_ptr<const FillLinesCache::Curve> FillLinesCache::find_curve(const std::string &key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_curves.find(key);
+    return it == m_curves.end() ? nullptr : it->second;
+}
+
+void FillLinesCache::insert_curve(std::string &&key, std::shared_ptr<const Curve> curve)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (auto [it, inserted] = m_curves.emplace(std::move(key), std::move(curve)); inserted) {
+        m_curves_order.emplace_back(&it->first);
+        if (m_curves_order.size() > max_curves) {
+            m_curves.erase(m_curves.find(*m_curves_order.front()));
+            m_curves_order.pop_front();
+        }
+    }
+}
+
+template<typename T>
+static inline void append_to_cache_key(std::string &key, const T &value)
+{
+    static_assert(std::is_arithmetic_v<T>);
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static inline void append_to_cache_key(std::string &key, const Points &points)
+{
+    append_to_cache_key(key, uint32_t(points.size()));
+    for (const Point &pt : points) {
+        append_to_cache_key(key, pt.x());
+        append_to_cache_key(key, pt.y());
+    }
+}
+
+// Exact binary representation of the inputs shared by FillRectilinear::fill_surface_by_lines() and fill_surface_by_multilines(),
+// so that no hash collisions need to be considered. The callers append their pattern shifts and sweep angles.
+static std::string fill_lines_cache_key(const Fill &fill, const Surface &surface, const FillParams &params, const std::pair<float, Point> &rotate_vector)
+{
+    std::string key;
+    append_to_cache_key(key, fill.spacing);
+    append_to_cache_key(key, fill.overlap);
+    append_to_cache_key(key, fill.link_max_length);
+    append_to_cache_key(key, params.density);
+    append_to_cache_key(key, params.anchor_length);
+    append_to_cache_key(key, params.anchor_length_max);
+    append_to_cache_key(key, params.resolution);
+    append_to_cache_key(key, params.dont_adjust);
+    append_to_cache_key(key, params.monotonic);
+    append_to_cache_key(key, rotate_vector.first);
+    append_to_cache_key(key, rotate_vector.second.x());
+    append_to_cache_key(key, rotate_vector.second.y());
+    append_to_cache_key(key, surface.expolygon.contour.points);
+    append_to_cache_key(key, uint32_t(surface.expolygon.holes.size()));
+    for (const Polygon &hole : surface.expolygon.holes)
+        append_to_cache_key(key, hole.points);
+    return key;
+}
+
 bool FillRectilinear::fill_surface_by_lines(const Surface *surface, const FillParams &params, float angleBase, float pattern_shift, Polylines &polylines_out)
 {
     // At the end, only the new polylines will be rotated back.
@@ -2758,6 +2880,17 @@ bool FillRectilinear::fill_surface_by_lines(const Surface *surface, const FillPa
     std::pair<float, Point> rotate_vector = this->_infill_direction(surface);
     rotate_vector.first += angleBase;
 
+    std::string cache_key;
+    if (this->fill_lines_cache) {
+        cache_key = fill_lines_cache_key(*this, *surface, params, rotate_vector);
+        append_to_cache_key(cache_key, pattern_shift);
+        if (std::shared_ptr<const FillLinesCache::Lines> cached = this->fill_lines_cache->find(cache_key); cached) {
+            append(polylines_out, cached->polylines);
+            this->spacing = cached->spacing;
+            return true;
+        }
+    }
+
     assert(params.density > 0.0001f && params.density <= 1.f);
     coord_t line_spacing = coord_t(scale_(this->spacing) / params.density);
 
@@ -2891,6 +3024,10 @@ bool FillRectilinear::fill_surface_by_lines(const Surface *surface, const FillPa
         assert(! polyline.has_duplicate_points());
 #endif /* SLIC3R_DEBUG */
 
+    if (this->fill_lines_cache)
+        this->fill_lines_cache->insert(std::move(cache_key), std::make_shared<const FillLinesCache::Lines>(
+            FillLinesCache::Lines{ Polylines(polylines_out.begin() + n_polylines_out_initial, polylines_out.end()), this->spacing }));
+
     return true;
 }
 
@@ -2945,10 +3082,24 @@ bool FillRectilinear::fill_surface_by_multilines(const Surface *surface, FillPar
         // Not a single infill line fits.
         return true;
 
+    std::pair<float, Point> rotate_vector = this->_infill_direction(surface);
+    std::string             cache_key;
+    if (this->fill_lines_cache) {
+        cache_key = fill_lines_cache_key(*this, *surface, params, rotate_vector);
+        for (const SweepParams &sweep : sweep_params) {
+            append_to_cache_key(cache_key, sweep.angle_base);
+            append_to_cache_key(cache_key, sweep.pattern_shift);
+        }
+        if (std::shared_ptr<const FillLinesCache::Lines> cached = this->fill_lines_cache->find(cache_key); cached) {
+            append(polylines_out, cached->polylines);
+            return true;
+        }
+    }
+    size_t n_polylines_out_initial = polylines_out.size();
+
     Polylines fill_lines;
     coord_t line_width   = coord_t(scale_(this->spacing));
     coord_t line_spacing = coord_t(scale_(this->spacing) / params.density);
-    std::pair<float, Point> rotate_vector = this->_infill_direction(surface);
     for (const SweepParams &sweep : sweep_params) {
         // Rotate polygons so that we can work with vertical lines here
         float angle = rotate_vector.first + sweep.angle_base;
@@ -2962,6 +3113,10 @@ bool FillRectilinear::fill_surface_by_multilines(const Surface *surface, FillPar
     } else
         connect_infill(std::move(fill_lines), poly_with_offset_base.polygons_outer, get_extents(surface->expolygon.contour), polylines_out, this->spacing, params);
 
+    if (this->fill_lines_cache)
+        this->fill_lines_cache->insert(std::move(cache_key), std::make_shared<const FillLinesCache::Lines>(
+            FillLinesCache::Lines{ Polylines(polylines_out.begin() + n_polylines_out_initial, polylines_out.end()), this->spacing }));
+
     return true;
 }
 
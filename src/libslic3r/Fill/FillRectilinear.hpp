@@ -13,6 +13,12 @@
 
 #include "../libslic3r.h"
 
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #include "FillBase.hpp"
 
 namespace Slic3r {
@@ -20,6 +26,52 @@ namespace Slic3r {
 class PrintRegionConfig;
 class Surface;
 
+// Infill lines generated by FillRectilinear and its descendants, shared by the layers of a PrintObject
+// while its infill is being generated. Many layers of prismatic objects share the same fill regions,
+// which are then filled with the same lines as long as the infill angle, spacing and pattern shift repeat,
+// for example on every other layer.
+// Also the curves generated by FillPlanePath over a bounding box, which are the same for all the layers
+// of a sparse infill aligned to the object bounding box. Thread safe.
+class FillLinesCache
+{
+public:
+    struct Lines {
+        Polylines polylines;
+        // Spacing as adjusted by the filler.
+        coordf_t  spacing;
+    };
+
+    // Curve generated by FillPlanePath before being clipped with the surface to fill.
+    struct Curve {
+        // Number of segments of a chunk.
+        static constexpr const size_t chunk_size = 32;
+        Points        points;
+        // Bounding boxes of the chunks of points. Chunk i spans points i * chunk_size to min((i + 1) * chunk_size, points.size() - 1)
+        // including, thus the neighbor chunks share their end points.
+        BoundingBoxes chunk_bboxes;
+    };
+
+    // Returns nullptr if not cached.
+    std::shared_ptr<const Lines> find(const std::string &key) const;
+    void                         insert(std::string &&key, std::shared_ptr<const Lines> lines);
+    std::shared_ptr<const Curve> find_curve(const std::string &key) const;
+    void                         insert_curve(std::string &&key, std::shared_ptr<const Curve> curve);
+
+private:
+    // Only the most recently inserted entries are kept, distant layers rarely share their fill regions.
+    static constexpr const size_t max_entries = 256;
+    // A curve over the bounding box of a large object is big, only a few of them are kept.
+    static constexpr const size_t max_curves  = 8;
+
+    mutable std::mutex                                           m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const Lines>> m_lines;
+    // Keys of m_lines in the order of insertion.
+    std::deque<const std::string*>                               m_order;
+    std::unordered_map<std::string, std::shared_ptr<const Curve>> m_curves;
+    // Keys of m_curves in the order of insertion.
+    std::deque<const std::string*>                               m_curves_order;
+};
+
 class FillRectilinear : public Fill
 {
 public:
@@ -27,6 +79,9 @@ public:
     ~FillRectilinear() override = default;
     Polylines fill_surface(const Surface *surface, const FillParams &params) override;
 
+    // Optional, shared by the fillers of all layers of a PrintObject.
+    FillLinesCache *fill_lines_cache = nullptr;
+
 protected:
     // Fill by single directional lines, interconnect the lines along perimeters.
 	bool fill_surface_by_lines(const Surface *surface, const FillParams &params, float angleBase, float pattern_shift, Polylines &polylines_out);
@@ -2,12 +2,16 @@
 //CuraEngine is released under the terms of the AGPLv3 or higher.
 
 #include "Generator.hpp"
+#include "DistanceField.hpp"
 #include "TreeNode.hpp"
 
 #include "../../ClipperUtils.hpp"
 #include "../../Layer.hpp"
 #include "../../Print.hpp"
 
+#include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
+
 /* Possible future tasks/optimizations,etc.:
  * - Improve connecting heuristic to favor connecting to shorter trees
  * - Change which node of a tree is the root when that would be better in reconnectRoots.
@@ -48,33 +52,46 @@ Generator::Generator(const PrintObject &print_object, const coordf_t fill_densit
     m_prune_length                                    = coord_t(layer_thickness * std::tan(lightning_infill_prune_angle));
     m_straightening_max_distance                      = coord_t(layer_thickness * std::tan(lightning_infill_straightening_angle));
 
-    generateInitialInternalOverhangs(print_object, throw_on_cancel_callback);
-    generateTrees(print_object, throw_on_cancel_callback);
+    // The infill areas are shared by the overhang detection and by the tree generation.
+    const std::vector<Polygons> infill_outlines = collectInfillOutlines(print_object, throw_on_cancel_callback);
+    generateInitialInternalOverhangs(infill_outlines, throw_on_cancel_callback);
+    generateTrees(infill_outlines, throw_on_cancel_callback);
 }
 
-void Generator::generateInitialInternalOverhangs(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+std::vector<Polygons> Generator::collectInfillOutlines(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
 {
-    m_overhang_per_layer.resize(print_object.layers().size());
+    std::vector<Polygons> infill_outlines(print_object.layers().size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layers().size()), [&print_object, &infill_outlines, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+            throw_on_cancel_callback();
+            Polygons infill_area;
+            for (const LayerRegion *layerm : print_object.get_layer(int(layer_id))->regions())
+                for (const Surface &surface : layerm->fill_surfaces())
+                    if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
+                        append(infill_area, to_polygons(surface.expolygon));
+            infill_outlines[layer_id] = union_(infill_area);
+        }
+    });
+    return infill_outlines;
+}
 
-    Polygons infill_area_above;
-    // Iterate from top to bottom, to subtract the overhang areas above from the overhang areas on the layer below, to get only overhang in the top layer where it is overhanging.
-    for (int layer_nr = int(print_object.layers().size()) - 1; layer_nr >= 0; --layer_nr) {
-        throw_on_cancel_callback();
-        Polygons infill_area_here;
-        for (const LayerRegion* layerm : print_object.get_layer(layer_nr)->regions())
-            for (const Surface& surface : layerm->fill_surfaces())
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    append(infill_area_here, to_polygons(surface.expolygon));
-
-        infill_area_here = union_(infill_area_here);
-        // Remove the part of the infill area that is already supported by the walls.
-        Polygons overhang = diff(offset(infill_area_here, -float(m_wall_supporting_radius)), infill_area_above);
-        // Filter out unprintable polygons and near degenerated polygons (three almost collinear points and so).
-        overhang = opening(overhang, float(SCALED_EPSILON), float(SCALED_EPSILON));
-
-        m_overhang_per_layer[layer_nr] = overhang;
-        infill_area_above = std::move(infill_area_here);
-    }
+void Generator::generateInitialInternalOverhangs(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback)
+{
+    m_overhang_per_layer.resize(infill_outlines.size());
+
+    // Subtract the infill area above from the infill area of each layer to get only overhang in the top layer where it is overhanging.
+    // The layers are independent of each other once the infill areas are known.
+    const Polygons no_infill_above;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, infill_outlines.size()), [this, &infill_outlines, &no_infill_above, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+            throw_on_cancel_callback();
+            // Remove the part of the infill area that is already supported by the walls.
+            const Polygons &infill_area_above = layer_id + 1 < infill_outlines.size() ? infill_outlines[layer_id + 1] : no_infill_above;
+            Polygons overhang = diff(offset(infill_outlines[layer_id], -float(m_wall_supporting_radius)), infill_area_above);
+            // Filter out unprintable polygons and near degenerated polygons (three almost collinear points and so).
+            m_overhang_per_layer[layer_id] = opening(overhang, float(SCALED_EPSILON), float(SCALED_EPSILON));
+        }
+    });
 }
 
 const Layer& Generator::getTreesForLayer(const size_t& layer_id) const
@@ -83,31 +100,36 @@ const Layer& Generator::getTreesForLayer(const size_t& layer_id) const
     return m_lightning_layers[layer_id];
 }
 
-void Generator::generateTrees(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+void Generator::generateTrees(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback)
 {
-    m_lightning_layers.resize(print_object.layers().size());
-
-    std::vector<Polygons> infill_outlines(print_object.layers().size(), Polygons());
-
-    // For-each layer from top to bottom:
-    for (int layer_id = int(print_object.layers().size()) - 1; layer_id >= 0; layer_id--) {
-        throw_on_cancel_callback();
-        for (const LayerRegion *layerm : print_object.get_layer(layer_id)->regions())
-            for (const Surface &surface : layerm->fill_surfaces())
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    append(infill_outlines[layer_id], to_polygons(surface.expolygon));
-
-        infill_outlines[layer_id] = union_(infill_outlines[layer_id]);
-    }
+    m_lightning_layers.resize(infill_outlines.size());
+    if (infill_outlines.empty())
+        return;
 
     // For various operations its beneficial to quickly locate nearby features on the polygon:
-    const size_t top_layer_id = print_object.layers().size() - 1;
+    const size_t top_layer_id = infill_outlines.size() - 1;
     EdgeGrid::Grid outlines_locator(get_extents(infill_outlines[top_layer_id]).inflated(SCALED_EPSILON));
     outlines_locator.create(infill_outlines[top_layer_id], locator_cell_size);
 
+    // The distance field of a layer depends just on the infill area and on the overhang of that layer, not on the trees
+    // propagated from the layer above. Thus the distance field of the layer below is built by a background task
+    // while the trees of the current layer are being generated.
+    auto make_distance_field = [this, &infill_outlines](size_t layer_id) {
+        return std::make_unique<DistanceField>(m_supporting_radius, infill_outlines[layer_id], get_extents(infill_outlines[layer_id]), m_overhang_per_layer[layer_id]);
+    };
+    std::unique_ptr<DistanceField> distance_field = make_distance_field(top_layer_id);
+    std::unique_ptr<DistanceField> distance_field_below;
+    // Declared after the distance fields, so that it waits for the background task before they are released on cancellation.
+    tbb::task_group                prepare_layer_below;
+
     // For-each layer from top to bottom:
     for (int layer_id = int(top_layer_id); layer_id >= 0; layer_id--) {
         throw_on_cancel_callback();
+        if (layer_id > 0)
+            prepare_layer_below.run([&make_distance_field, &distance_field_below, layer_id]() {
+                distance_field_below = make_distance_field(layer_id - 1);
+            });
+
         Layer             &current_lightning_layer = m_lightning_layers[layer_id];
         const Polygons    &current_outlines        = infill_outlines[layer_id];
         const BoundingBox &current_outlines_bbox   = get_extents(current_outlines);
@@ -115,7 +137,7 @@ void Generator::generateTrees(const PrintObject &print_object, const std::functi
         // register all trees propagated from the previous layer as to-be-reconnected
         std::vector<NodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
 
-        current_lightning_layer.generateNewTrees(m_overhang_per_layer[layer_id], current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
+        current_lightning_layer.generateNewTrees(*distance_field, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
         current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius);
 
         // Initialize trees for next lower layer from the current one.
@@ -136,6 +158,9 @@ void Generator::generateTrees(const PrintObject &print_object, const std::functi
         std::vector<NodeSPtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
         for (auto& tree : current_lightning_layer.tree_roots)
             tree->propagateToNextLayer(lower_trees, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, locator_cell_size / 2);
+
+        prepare_layer_below.wait();
+        distance_field = std::move(distance_field_below);
     }
 }
 
@@ -68,12 +68,17 @@ protected:
      * only when support is generated. For this pattern, we also need to
      * generate overhang areas for the inside of the model.
      */
-    void generateInitialInternalOverhangs(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
+    void generateInitialInternalOverhangs(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback);
 
     /*!
      * Calculate the tree structure of all layers.
      */
-    void generateTrees(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
+    void generateTrees(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback);
+
+    /*!
+     * Collect the sparse infill areas of all layers, processing the layers in parallel.
+     */
+    static std::vector<Polygons> collectInfillOutlines(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
 
     float m_infill_extrusion_width;
 
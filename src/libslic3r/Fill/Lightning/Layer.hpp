@@ -17,6 +17,7 @@ namespace Slic3r::FillLightning
 {
 
 class Node;
+class DistanceField;
 using NodeSPtr = std::shared_ptr<Node>;
 using SparseNodeGrid = std::unordered_multimap<Point, std::weak_ptr<Node>, PointHash>;
 
@@ -37,9 +38,14 @@ class Layer
 public:
     std::vector<NodeSPtr> tree_roots;
 
+    /*!
+     * Support the overhang sampled by \p distance_field , which has to be built
+     * from the overhang of this layer and \p current_outlines_bbox . The distance
+     * field is consumed by the call.
+     */
     void generateNewTrees
     (
-        const Polygons& current_overhang,
+        DistanceField& distance_field,
         const Polygons& current_outlines,
         const BoundingBox& current_outlines_bbox,
         const EdgeGrid::Grid& outline_locator,
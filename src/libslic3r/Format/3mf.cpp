@@ -38,6 +38,8 @@ namespace pt = boost::property_tree;
 
 #include <expat.h>
 #include <Eigen/Dense>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include "miniz_extension.hpp"
 
 #include "TextConfiguration.hpp"
@@ -90,6 +92,9 @@ const std::string SLA_SUPPORT_POINTS_FILE = "Metadata/Slic3r_PE_sla_support_poin
 const std::string SLA_DRAIN_HOLES_FILE = "Metadata/Slic3r_PE_sla_drain_holes.txt";
 const std::string CUSTOM_GCODE_PER_PRINT_Z_FILE = "Metadata/Prusa_Slicer_custom_gcode_per_print_z.xml";
 const std::string CUT_INFORMATION_FILE = "Metadata/Prusa_Slicer_cut_information.xml";
+// Optional binary copies of the meshes stored in the model file, named by the 3MF object ID, see BinaryMeshHeader.
+const std::string BINARY_MESH_FILE_PREFIX = "Metadata/Prusa_Slicer_mesh_";
+const std::string BINARY_MESH_FILE_EXTENSION = ".bin";
 
 static constexpr const char* MODEL_TAG = "model";
 static constexpr const char* RESOURCES_TAG = "resources";
@@ -231,22 +236,33 @@ std::string get_attribute_value_string(const char** attributes, unsigned int att
     return (text != nullptr) ? text : "";
 }
 
-float get_attribute_value_float(const char** attributes, unsigned int attributes_size, const char* attribute_key)
+// Invalid values are parsed as ZERO.
+static inline float parse_attribute_float(const char* text)
 {
     float value = 0.0f;
-    if (const char *text = get_attribute_value_charptr(attributes, attributes_size, attribute_key); text != nullptr)
-        fast_float::from_chars(text, text + strlen(text), value);
+    fast_float::from_chars(text, text + strlen(text), value);
     return value;
 }
 
-int get_attribute_value_int(const char** attributes, unsigned int attributes_size, const char* attribute_key)
+static inline int parse_attribute_int(const char* text)
 {
     int value = 0;
-    if (const char *text = get_attribute_value_charptr(attributes, attributes_size, attribute_key); text != nullptr)
-        boost::spirit::qi::parse(text, text + strlen(text), boost::spirit::qi::int_, value);
+    boost::spirit::qi::parse(text, text + strlen(text), boost::spirit::qi::int_, value);
     return value;
 }
 
+float get_attribute_value_float(const char** attributes, unsigned int attributes_size, const char* attribute_key)
+{
+    const char *text = get_attribute_value_charptr(attributes, attributes_size, attribute_key);
+    return (text != nullptr) ? parse_attribute_float(text) : 0.0f;
+}
+
+int get_attribute_value_int(const char** attributes, unsigned int attributes_size, const char* attribute_key)
+{
+    const char *text = get_attribute_value_charptr(attributes, attributes_size, attribute_key);
+    return (text != nullptr) ? parse_attribute_int(text) : 0;
+}
+
 bool get_attribute_value_bool(const char** attributes, unsigned int attributes_size, const char* attribute_key)
 {
     const char* text = get_attribute_value_charptr(attributes, attributes_size, attribute_key);
@@ -334,6 +350,23 @@ namespace Slic3r {
         }
     };
 
+    // Header of a binary mesh file, followed by the vertices (3x float) and the vertex indices of the triangles (3x int32) in native (little endian) byte order.
+    // The binary mesh is an exact copy of the vertices and triangles of an object stored in the model file, which is kept for the other applications.
+    // PrusaSlicer then reads the binary mesh instead of parsing the vertices and triangles.
+    struct BinaryMeshHeader
+    {
+        static constexpr uint32_t current_version = 1;
+
+        char     magic[4] { 'P', 'S', 'M', 'B' };
+        uint32_t version { current_version };
+        uint32_t vertices_count { 0 };
+        uint32_t triangles_count { 0 };
+
+        bool valid() const { return ::memcmp(magic, BinaryMeshHeader().magic, sizeof(magic)) == 0 && version == current_version; }
+        size_t file_size() const { return sizeof(BinaryMeshHeader) + size_t(vertices_count) * sizeof(Vec3f) + size_t(triangles_count) * sizeof(Vec3i); }
+    };
+    static_assert(sizeof(Vec3f) == 3 * sizeof(float) && sizeof(Vec3i) == 3 * sizeof(int32_t), "Binary mesh layout");
+
     class _3MF_Importer : public _3MF_Base
     {
         struct Component
@@ -384,6 +417,9 @@ namespace Slic3r {
             Geometry geometry;
             ModelObject* object;
             ComponentsList components;
+            // Binary copy of the mesh, if stored. Then the vertices are just counted and the vertex indices of the triangles are not parsed.
+            indexed_triangle_set* binary_mesh;
+            size_t vertices_count;
 
             CurrentObject() { reset(); }
 
@@ -393,6 +429,8 @@ namespace Slic3r {
                 geometry.reset();
                 object = nullptr;
                 components.clear();
+                binary_mesh = nullptr;
+                vertices_count = 0;
             }
         };
 
@@ -475,6 +513,7 @@ namespace Slic3r {
         typedef std::map<int, CutObjectInfo>         IdToCutObjectInfoMap;
         typedef std::map<int, std::vector<sla::SupportPoint>> IdToSlaSupportPointsMap;
         typedef std::map<int, std::vector<sla::DrainHole>> IdToSlaDrainHolesMap;
+        typedef std::map<int, indexed_triangle_set> IdToBinaryMeshMap;
         using PathToEmbossShapeFileMap = std::map<std::string, std::shared_ptr<std::string>>;
         // Version of the 3mf file
         unsigned int m_version;
@@ -498,6 +537,7 @@ namespace Slic3r {
         IdToAliasesMap m_objects_aliases;
         InstancesList m_instances;
         IdToGeometryMap m_geometries;
+        IdToBinaryMeshMap m_binary_meshes;
         CurrentConfig m_curr_config;
         IdToMetadataMap m_objects_metadata;
         IdToCutObjectInfoMap m_cut_object_infos;
@@ -545,6 +585,7 @@ namespace Slic3r {
         void _extract_print_config_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat, DynamicPrintConfig& config, ConfigSubstitutionContext& subs_context, const std::string& archive_filename);
         bool _extract_model_config_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat, Model& model);
         void _extract_embossed_svg_shape_file(const std::string &filename, mz_zip_archive &archive, const mz_zip_archive_file_stat &stat);
+        void _extract_binary_mesh_from_archive(const std::string &filename, mz_zip_archive &archive, const mz_zip_archive_file_stat &stat);
 
         // handlers to parse the .model file
         void _handle_start_model_xml_element(const char* name, const char** attributes);
@@ -615,7 +656,11 @@ namespace Slic3r {
         bool _handle_start_config_metadata(const char** attributes, unsigned int num_attributes);
         bool _handle_end_config_metadata();
 
+        // Split the meshes of the volumes out of the imported geometry. Does not modify the importer, thus it may be called
+        // in parallel for multiple objects. Returns an error message on failure.
+        std::optional<std::string> _split_volume_meshes(const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>& meshes) const;
         bool _generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions);
+        bool _generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>&& meshes, ConfigSubstitutionContext& config_substitutions);
 
         // callbacks to parse the .model file
         static void XMLCALL _handle_start_model_xml_element(void* userData, const char* name, const char** attributes);
@@ -705,6 +750,16 @@ namespace Slic3r {
 
         m_name = boost::filesystem::path(filename).stem().string();
 
+        // the binary meshes are read before the .model file, so that parsing of their vertices and triangles is skipped
+        for (mz_uint i = 0; i < num_entries; ++i) {
+            if (mz_zip_reader_file_stat(&archive, i, &stat)) {
+                std::string name(stat.m_filename);
+                std::replace(name.begin(), name.end(), '\\', '/');
+                if (boost::algorithm::starts_with(name, BINARY_MESH_FILE_PREFIX) && boost::algorithm::ends_with(name, BINARY_MESH_FILE_EXTENSION))
+                    _extract_binary_mesh_from_archive(name, archive, stat);
+            }
+        }
+
         // we first loop the entries to read from the archive the .model file only, in order to extract the version from it
         for (mz_uint i = 0; i < num_entries; ++i) {
             if (mz_zip_reader_file_stat(&archive, i, &stat)) {
@@ -826,17 +881,48 @@ namespace Slic3r {
             }
         }
 
+        // Select the volumes of the objects and split their meshes out of the imported geometries in parallel.
+        // Calculating the connectivity and statistics of the meshes takes most of the time of loading a project with large meshes.
+        struct ObjectVolumes
+        {
+            const Geometry*                     geometry { nullptr };
+            // Volumes detected from the config data saved by PrusaSlicer, or the entire geometry as a single volume.
+            ObjectMetadata::VolumeMetadataList* volumes { nullptr };
+            ObjectMetadata::VolumeMetadataList  single_volume;
+            std::vector<TriangleMesh>           meshes;
+            std::optional<std::string>          error;
+        };
+        std::vector<ObjectVolumes> objects_volumes;
+        objects_volumes.reserve(m_objects.size());
         for (const IdToModelObjectMap::value_type& object : m_objects) {
             if (object.second >= int(m_model->objects.size())) {
                 add_error("Unable to find object");
                 return false;
             }
-            ModelObject* model_object = m_model->objects[object.second];
             IdToGeometryMap::const_iterator obj_geometry = m_geometries.find(object.first);
             if (obj_geometry == m_geometries.end()) {
                 add_error("Unable to find object geometry");
                 return false;
             }
+            ObjectVolumes& object_volumes = objects_volumes.emplace_back();
+            object_volumes.geometry = &obj_geometry->second;
+            if (IdToMetadataMap::iterator obj_metadata = m_objects_metadata.find(object.first); obj_metadata != m_objects_metadata.end())
+                object_volumes.volumes = &obj_metadata->second.volumes;
+            else {
+                object_volumes.single_volume.emplace_back(0, (int)obj_geometry->second.triangles.size() - 1);
+                object_volumes.volumes = &object_volumes.single_volume;
+            }
+        }
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, objects_volumes.size(), 1), [this, &objects_volumes](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                ObjectVolumes& object_volumes = objects_volumes[i];
+                object_volumes.error = _split_volume_meshes(*object_volumes.geometry, *object_volumes.volumes, object_volumes.meshes);
+            }
+        });
+
+        auto object_volumes = objects_volumes.begin();
+        for (const IdToModelObjectMap::value_type& object : m_objects) {
+            ModelObject* model_object = m_model->objects[object.second];
 
             // m_layer_heights_profiles are indexed by a 1 based model object index.
             IdToLayerHeightsProfileMap::iterator obj_layer_heights_profile = m_layer_heights_profiles.find(object.second + 1);
@@ -860,9 +946,6 @@ namespace Slic3r {
                 model_object->sla_drain_holes = std::move(obj_drain_holes->second);
             }
 
-            ObjectMetadata::VolumeMetadataList volumes;
-            ObjectMetadata::VolumeMetadataList* volumes_ptr = nullptr;
-
             IdToMetadataMap::iterator obj_metadata = m_objects_metadata.find(object.first);
             if (obj_metadata != m_objects_metadata.end()) {
                 // config data has been found, this model was saved using slic3r pe
@@ -874,22 +957,17 @@ namespace Slic3r {
                     else
                         model_object->config.set_deserialize(metadata.key, metadata.value, config_substitutions);
                 }
-
-                // select object's detected volumes
-                volumes_ptr = &obj_metadata->second.volumes;
             }
-            else {
-                // config data not found, this model was not saved using slic3r pe
-
-                // add the entire geometry as the single volume to generate
-                volumes.emplace_back(0, (int)obj_geometry->second.triangles.size() - 1);
+            // otherwise config data not found, this model was not saved using slic3r pe,
+            // the entire geometry was selected as the single volume to generate
 
-                // select as volumes
-                volumes_ptr = &volumes;
+            if (object_volumes->error) {
+                add_error(*object_volumes->error);
+                return false;
             }
-
-            if (!_generate_volumes(*model_object, obj_geometry->second, *volumes_ptr, config_substitutions))
+            if (!_generate_volumes(*model_object, *object_volumes->geometry, *object_volumes->volumes, std::move(object_volumes->meshes), config_substitutions))
                 return false;
+            ++ object_volumes;
 
             // Apply cut information for object if any was loaded
             // m_cut_object_ids are indexed by a 1 based model object index.
@@ -1386,6 +1464,34 @@ namespace Slic3r {
         }
     }
 
+    void _3MF_Importer::_extract_binary_mesh_from_archive(const std::string &filename, mz_zip_archive &archive, const mz_zip_archive_file_stat &stat)
+    {
+        const int object_id = ::atoi(filename.c_str() + BINARY_MESH_FILE_PREFIX.size());
+        mz_zip_reader_extract_iter_state *state = mz_zip_reader_extract_iter_new(&archive, stat.m_file_index, 0);
+        if (state == nullptr) {
+            add_error("Error while reading binary mesh data from ZIP archive");
+            return;
+        }
+        // The vertices and triangles are read directly into the buffers of the mesh.
+        BinaryMeshHeader     header;
+        indexed_triangle_set its;
+        bool valid = mz_zip_reader_extract_iter_read(state, &header, sizeof(header)) == sizeof(header) && header.valid() && header.file_size() == stat.m_uncomp_size;
+        if (valid) {
+            its.vertices.resize(header.vertices_count);
+            its.indices.resize(header.triangles_count);
+            const size_t vertices_size  = its.vertices.size() * sizeof(Vec3f);
+            const size_t triangles_size = its.indices.size() * sizeof(Vec3i);
+            valid = mz_zip_reader_extract_iter_read(state, its.vertices.data(), vertices_size) == vertices_size &&
+                    mz_zip_reader_extract_iter_read(state, its.indices.data(), triangles_size) == triangles_size;
+        }
+        mz_zip_reader_extract_iter_free(state);
+        // An invalid binary mesh is reported and ignored, the mesh is parsed from the model file then.
+        if (valid)
+            m_binary_meshes[object_id] = std::move(its);
+        else
+            add_error("Found invalid binary mesh");
+    }
+
     void _3MF_Importer::_extract_embossed_svg_shape_file(const std::string &filename, mz_zip_archive &archive, const mz_zip_archive_file_stat &stat){
         assert(m_path_to_emboss_shape_files.find(filename) == m_path_to_emboss_shape_files.end());
         auto file = std::make_unique<std::string>(stat.m_uncomp_size, '\0');
@@ -1707,6 +1813,8 @@ namespace Slic3r {
                 m_curr_object.object->name = m_name + "_" + std::to_string(m_model->objects.size());
 
             m_curr_object.id = get_attribute_value_int(attributes, num_attributes, ID_ATTR);
+            if (IdToBinaryMeshMap::iterator binary_mesh = m_binary_meshes.find(m_curr_object.id); binary_mesh != m_binary_meshes.end())
+                m_curr_object.binary_mesh = &binary_mesh->second;
         }
 
         return true;
@@ -1762,7 +1870,20 @@ namespace Slic3r {
 
     bool _3MF_Importer::_handle_end_mesh()
     {
-        // do nothing
+        if (indexed_triangle_set *binary_mesh = m_curr_object.binary_mesh; binary_mesh != nullptr) {
+            // Take the vertices and the vertex indices of the triangles skipped while parsing from the binary mesh.
+            Geometry &geometry = m_curr_object.geometry;
+            if (binary_mesh->vertices.size() != m_curr_object.vertices_count || binary_mesh->indices.size() != geometry.triangles.size()) {
+                add_error("Binary mesh does not match the model file");
+                return false;
+            }
+            geometry.vertices  = std::move(binary_mesh->vertices);
+            geometry.triangles = std::move(binary_mesh->indices);
+            if (m_unit_factor != 1.f)
+                for (Vec3f &vertex : geometry.vertices)
+                    vertex *= m_unit_factor;
+            m_curr_object.binary_mesh = nullptr;
+        }
         return true;
     }
 
@@ -1783,10 +1904,22 @@ namespace Slic3r {
     {
         // appends the vertex coordinates
         // missing values are set equal to ZERO
-        m_curr_object.geometry.vertices.emplace_back(
-            m_unit_factor * get_attribute_value_float(attributes, num_attributes, X_ATTR),
-            m_unit_factor * get_attribute_value_float(attributes, num_attributes, Y_ATTR),
-            m_unit_factor * get_attribute_value_float(attributes, num_attributes, Z_ATTR));
+        // Vertices and triangles make up most of the model file, thus their attributes are looked up in a single pass
+        // and parsed in place into the geometry.
+        if (m_curr_object.binary_mesh != nullptr) {
+            ++ m_curr_object.vertices_count;
+            return true;
+        }
+        Vec3f &vertex = m_curr_object.geometry.vertices.emplace_back(Vec3f::Zero());
+        for (unsigned int a = 0; a + 1 < num_attributes; a += 2) {
+            const char *key = attributes[a];
+            if (::strcmp(key, X_ATTR) == 0)
+                vertex.x() = m_unit_factor * parse_attribute_float(attributes[a + 1]);
+            else if (::strcmp(key, Y_ATTR) == 0)
+                vertex.y() = m_unit_factor * parse_attribute_float(attributes[a + 1]);
+            else if (::strcmp(key, Z_ATTR) == 0)
+                vertex.z() = m_unit_factor * parse_attribute_float(attributes[a + 1]);
+        }
         return true;
     }
 
@@ -1820,14 +1953,31 @@ namespace Slic3r {
 
         // appends the triangle's vertices indices
         // missing values are set equal to ZERO
-        m_curr_object.geometry.triangles.emplace_back(
-            get_attribute_value_int(attributes, num_attributes, V1_ATTR),
-            get_attribute_value_int(attributes, num_attributes, V2_ATTR),
-            get_attribute_value_int(attributes, num_attributes, V3_ATTR));
-
-        m_curr_object.geometry.custom_supports.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SUPPORTS_ATTR));
-        m_curr_object.geometry.custom_seam.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SEAM_ATTR));
-        m_curr_object.geometry.mmu_segmentation.push_back(get_attribute_value_string(attributes, num_attributes, MMU_SEGMENTATION_ATTR));
+        Geometry    &geometry         = m_curr_object.geometry;
+        Vec3i       &triangle         = geometry.triangles.emplace_back(Vec3i::Zero());
+        std::string &custom_supports  = geometry.custom_supports.emplace_back();
+        std::string &custom_seam      = geometry.custom_seam.emplace_back();
+        std::string &mmu_segmentation = geometry.mmu_segmentation.emplace_back();
+        // The vertex indices are taken from the binary mesh if stored.
+        const bool   parse_indices    = m_curr_object.binary_mesh == nullptr;
+        for (unsigned int a = 0; a + 1 < num_attributes; a += 2) {
+            const char *key   = attributes[a];
+            const char *value = attributes[a + 1];
+            if (::strcmp(key, CUSTOM_SUPPORTS_ATTR) == 0)
+                custom_supports = value;
+            else if (::strcmp(key, CUSTOM_SEAM_ATTR) == 0)
+                custom_seam = value;
+            else if (::strcmp(key, MMU_SEGMENTATION_ATTR) == 0)
+                mmu_segmentation = value;
+            else if (parse_indices) {
+                if (::strcmp(key, V1_ATTR) == 0)
+                    triangle[0] = parse_attribute_int(value);
+                else if (::strcmp(key, V2_ATTR) == 0)
+                    triangle[1] = parse_attribute_int(value);
+                else if (::strcmp(key, V3_ATTR) == 0)
+                    triangle[2] = parse_attribute_int(value);
+            }
+        }
         return true;
     }
 
@@ -2230,51 +2380,29 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions)
+    std::optional<std::string> _3MF_Importer::_split_volume_meshes(const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>& meshes) const
     {
-        if (!object.volumes.empty()) {
-            add_error("Found invalid volumes count");
-            return false;
-        }
-
         unsigned int geo_tri_count = (unsigned int)geometry.triangles.size();
-        unsigned int renamed_volumes_count = 0;
 
+        meshes.clear();
+        meshes.reserve(volumes.size());
         for (const ObjectMetadata::VolumeMetadata& volume_data : volumes) {
-            if (geo_tri_count <= volume_data.first_triangle_id || geo_tri_count <= volume_data.last_triangle_id || volume_data.last_triangle_id < volume_data.first_triangle_id) {
-                add_error("Found invalid triangle id");
-                return false;
-            }
-
-            Transform3d volume_matrix_to_object = Transform3d::Identity();
-            bool        has_transform 		    = false;
-            // extract the volume transformation from the volume's metadata, if present
-            for (const Metadata& metadata : volume_data.metadata) {
-                if (metadata.key == MATRIX_KEY) {
-                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
-                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
-                    break;
-                }
-            }
+            if (geo_tri_count <= volume_data.first_triangle_id || geo_tri_count <= volume_data.last_triangle_id || volume_data.last_triangle_id < volume_data.first_triangle_id)
+                return "Found invalid triangle id";
 
             // splits volume out of imported geometry
             indexed_triangle_set its;
             its.indices.assign(geometry.triangles.begin() + volume_data.first_triangle_id, geometry.triangles.begin() + volume_data.last_triangle_id + 1);
-            const size_t triangles_count = its.indices.size();
-            if (triangles_count == 0) {
-                add_error("An empty triangle mesh found");
-                return false;
-            }
+            if (its.indices.empty())
+                return "An empty triangle mesh found";
 
             {
                 int min_id = its.indices.front()[0];
                 int max_id = min_id;
                 for (const Vec3i& face : its.indices) {
                     for (const int tri_id : face) {
-                        if (tri_id < 0 || tri_id >= int(geometry.vertices.size())) {
-                            add_error("Found invalid vertex id");
-                            return false;
-                        }
+                        if (tri_id < 0 || tri_id >= int(geometry.vertices.size()))
+                            return "Found invalid vertex id";
                         min_id = std::min(min_id, tri_id);
                         max_id = std::max(max_id, tri_id);
                     }
@@ -2294,7 +2422,52 @@ namespace Slic3r {
                 // Remove the vertices, that are not referenced by any face.
                 its_compactify_vertices(its, true);
 
-            TriangleMesh triangle_mesh(std::move(its), volume_data.mesh_stats);
+            // Calculates the mesh statistics including the face connectivity, which takes most of the time of loading large meshes.
+            meshes.emplace_back(std::move(its), volume_data.mesh_stats);
+        }
+
+        return std::nullopt;
+    }
+
+    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions)
+    {
+        if (!object.volumes.empty()) {
+            add_error("Found invalid volumes count");
+            return false;
+        }
+
+        std::vector<TriangleMesh> meshes;
+        if (std::optional<std::string> error = _split_volume_meshes(geometry, volumes, meshes); error) {
+            add_error(*error);
+            return false;
+        }
+        return _generate_volumes(object, geometry, volumes, std::move(meshes), config_substitutions);
+    }
+
+    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>&& meshes, ConfigSubstitutionContext& config_substitutions)
+    {
+        if (!object.volumes.empty()) {
+            add_error("Found invalid volumes count");
+            return false;
+        }
+        assert(meshes.size() == volumes.size());
+
+        unsigned int renamed_volumes_count = 0;
+
+        for (const ObjectMetadata::VolumeMetadata& volume_data : volumes) {
+            Transform3d volume_matrix_to_object = Transform3d::Identity();
+            bool        has_transform 		    = false;
+            // extract the volume transformation from the volume's metadata, if present
+            for (const Metadata& metadata : volume_data.metadata) {
+                if (metadata.key == MATRIX_KEY) {
+                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
+                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
+                    break;
+                }
+            }
+
+            TriangleMesh triangle_mesh = std::move(meshes[&volume_data - volumes.data()]);
+            const size_t triangles_count = triangle_mesh.its.indices.size();
 
             if (m_version == 0) {
                 // if the 3mf was not produced by PrusaSlicer and there is only one instance,
@@ -2461,12 +2634,17 @@ namespace Slic3r {
 
         typedef std::vector<BuildItem> BuildItemsList;
         typedef std::map<int, ObjectData> IdToObjectDataMap;
+        typedef std::map<unsigned int, std::string> IdToBinaryMeshMap;
 
         bool m_fullpath_sources{ true };
         bool m_zip64 { true };
+        int  m_compression_level { MZ_DEFAULT_LEVEL };
+        bool m_binary_meshes { false };
+        // Binary meshes produced while writing the model file, written into the archive after the model file is finished.
+        IdToBinaryMeshMap m_binary_mesh_files;
 
     public:
-        bool save_model_to_file(const std::string& filename, Model& model, const DynamicPrintConfig* config, bool fullpath_sources, const ThumbnailData* thumbnail_data, bool zip64);
+        bool save_model_to_file(const std::string& filename, Model& model, const DynamicPrintConfig* config, bool fullpath_sources, const ThumbnailData* thumbnail_data, bool zip64, bool fast_compression, bool binary_meshes);
         static void add_transformation(std::stringstream &stream, const Transform3d &tr);
     private:
         void _publish(Model &model);
@@ -2475,8 +2653,9 @@ namespace Slic3r {
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data);
-        bool _add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);        
+        bool _add_object_to_model_stream(MZ_ParallelStagedWriter &writer, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_mesh_to_object_stream(MZ_ParallelStagedWriter &writer, ModelObject& object, VolumeToOffsetsMap& volumes_offsets, std::string* binary_mesh);
+        bool _add_binary_mesh_files_to_archive(mz_zip_archive& archive);        
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
         bool _add_cut_information_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2488,11 +2667,14 @@ namespace Slic3r {
         bool _add_custom_gcode_per_print_z_file_to_archive(mz_zip_archive& archive, Model& model, const DynamicPrintConfig* config);
     };
 
-    bool _3MF_Exporter::save_model_to_file(const std::string& filename, Model& model, const DynamicPrintConfig* config, bool fullpath_sources, const ThumbnailData* thumbnail_data, bool zip64)
+    bool _3MF_Exporter::save_model_to_file(const std::string& filename, Model& model, const DynamicPrintConfig* config, bool fullpath_sources, const ThumbnailData* thumbnail_data, bool zip64, bool fast_compression, bool binary_meshes)
     {
         clear_errors();
         m_fullpath_sources = fullpath_sources;
         m_zip64 = zip64;
+        m_compression_level = fast_compression ? MZ_BEST_SPEED : MZ_DEFAULT_LEVEL;
+        m_binary_meshes = binary_meshes;
+        m_binary_mesh_files.clear();
         return _save_model_to_file(filename, model, config, thumbnail_data);
     }
 
@@ -2541,6 +2723,13 @@ namespace Slic3r {
             return false;
         }
 
+        // Adds the optional binary copies of the meshes stored in the model file ("Metadata/Prusa_Slicer_mesh_<object id>.bin").
+        if (!_add_binary_mesh_files_to_archive(archive)) {
+            close_zip_writer(&archive);
+            boost::filesystem::remove(filename);
+            return false;
+        }
+
         // Adds file with information for object cut ("Metadata/Slic3r_PE_cut_information.txt").
         // All information for object cut of all ModelObjects are stored here, indexed by 1 based index of the ModelObject in Model.
         // The index differes from the index of an object ID of an object instance of a 3MF file!
@@ -2636,7 +2825,7 @@ namespace Slic3r {
 
         std::string out = stream.str();
 
-        if (!mz_zip_writer_add_mem(&archive, CONTENT_TYPES_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+        if (!mz_zip_writer_add_mem(&archive, CONTENT_TYPES_FILE.c_str(), (const void*)out.data(), out.length(), m_compression_level)) {
             add_error("Unable to add content types file to archive");
             return false;
         }
@@ -2651,7 +2840,7 @@ namespace Slic3r {
         size_t png_size = 0;
         void* png_data = tdefl_write_image_to_png_file_in_memory_ex((const void*)thumbnail_data.pixels.data(), thumbnail_data.width, thumbnail_data.height, 4, &png_size, MZ_DEFAULT_LEVEL, 1);
         if (png_data != nullptr) {
-            res = mz_zip_writer_add_mem(&archive, THUMBNAIL_FILE.c_str(), (const void*)png_data, png_size, MZ_DEFAULT_COMPRESSION);
+            res = mz_zip_writer_add_mem(&archive, THUMBNAIL_FILE.c_str(), (const void*)png_data, png_size, m_compression_level);
             mz_free(png_data);
         }
 
@@ -2672,7 +2861,7 @@ namespace Slic3r {
 
         std::string out = stream.str();
 
-        if (!mz_zip_writer_add_mem(&archive, RELATIONSHIPS_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+        if (!mz_zip_writer_add_mem(&archive, RELATIONSHIPS_FILE.c_str(), (const void*)out.data(), out.length(), m_compression_level)) {
             add_error("Unable to add relationships file to archive");
             return false;
         }
@@ -2702,10 +2891,12 @@ namespace Slic3r {
                 // Maximum expected 3MF file size is 4GB-1. This is a workaround for interoperability with Windows 10 3D model fixing API, see
                 // GH issue #6193.
                 (uint64_t(1) << 32) - 1,
-            nullptr, nullptr, 0, MZ_DEFAULT_COMPRESSION, nullptr, 0, nullptr, 0)) {
+            nullptr, nullptr, 0, m_compression_level, nullptr, 0, nullptr, 0)) {
             add_error("Unable to add model file to archive");
             return false;
         }
+        // The model file contains the meshes and it makes up most of the archive, compress it in parallel.
+        MZ_ParallelStagedWriter writer(context, m_compression_level);
 
         {
             std::stringstream stream;
@@ -2737,8 +2928,7 @@ namespace Slic3r {
             stream << " <" << METADATA_TAG << " name=\"ModificationDate\">" << date << "</" << METADATA_TAG << ">\n";
             stream << " <" << METADATA_TAG << " name=\"Application\">" << SLIC3R_APP_KEY << "-" << SLIC3R_VERSION << "</" << METADATA_TAG << ">\n";
             stream << " <" << RESOURCES_TAG << ">\n";
-            std::string buf = stream.str();
-            if (! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) {
+            if (! writer.add(stream.str())) {
                 add_error("Unable to add model file to archive");
                 return false;
             }
@@ -2761,9 +2951,9 @@ namespace Slic3r {
             // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
             // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(context, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
+            if (!_add_object_to_model_stream(writer, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
                 add_error("Unable to add object to archive");
-                mz_zip_writer_add_staged_finish(&context);
+                writer.finish();
                 return false;
             }
         }
@@ -2776,16 +2966,13 @@ namespace Slic3r {
             // Store the transformations of all the ModelInstances of all ModelObjects, indexed in a linear fashion.
             if (!_add_build_to_model_stream(stream, build_items)) {
                 add_error("Unable to add build to archive");
-                mz_zip_writer_add_staged_finish(&context);
+                writer.finish();
                 return false;
             }
 
             stream << "</" << MODEL_TAG << ">\n";
-           
-            std::string buf = stream.str();
 
-            if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                ! mz_zip_writer_add_staged_finish(&context)) {
+            if (! writer.add(stream.str()) || ! writer.finish()) {
                 add_error("Unable to add model file to archive");
                 return false;
             }
@@ -2794,7 +2981,7 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_object_to_model_stream(MZ_ParallelStagedWriter &writer, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
     {
         std::stringstream stream;
         reset_stream(stream);
@@ -2810,8 +2997,8 @@ namespace Slic3r {
             if (id == 0) {
                 std::string buf = stream.str();
                 reset_stream(stream);
-                if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                    ! _add_mesh_to_object_stream(context, object, volumes_offsets)) {
+                std::string *binary_mesh = m_binary_meshes ? &m_binary_mesh_files[instance_id] : nullptr;
+                if (! writer.add(buf) || ! _add_mesh_to_object_stream(writer, object, volumes_offsets, binary_mesh)) {
                     add_error("Unable to add mesh to archive");
                     return false;
                 }
@@ -2833,8 +3020,7 @@ namespace Slic3r {
         }
 
         object_id += id;
-        std::string buf = stream.str();
-        return buf.empty() || mz_zip_writer_add_staged_data(&context, buf.data(), buf.size());
+        return writer.add(stream.str());
     }
 
 #if EXPORT_3MF_USE_SPIRIT_KARMA_FP
@@ -2857,8 +3043,22 @@ namespace Slic3r {
     using coordinate_type_scientific = boost::spirit::karma::real_generator<float, coordinate_policy_scientific<float>>;
 #endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
 
-    bool _3MF_Exporter::_add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_mesh_to_object_stream(MZ_ParallelStagedWriter &writer, ModelObject& object, VolumeToOffsetsMap& volumes_offsets, std::string* binary_mesh)
     {
+        BinaryMeshHeader binary_mesh_header;
+        if (binary_mesh) {
+            // The header is updated with the counts of vertices and triangles at the end.
+            binary_mesh->assign(reinterpret_cast<const char*>(&binary_mesh_header), sizeof(binary_mesh_header));
+            size_t num_vertices  = 0;
+            size_t num_triangles = 0;
+            for (const ModelVolume* volume : object.volumes)
+                if (volume != nullptr) {
+                    num_vertices  += volume->mesh().its.vertices.size();
+                    num_triangles += volume->mesh().its.indices.size();
+                }
+            binary_mesh->reserve(sizeof(binary_mesh_header) + num_vertices * sizeof(Vec3f) + num_triangles * sizeof(Vec3i));
+        }
+
         std::string output_buffer;
         output_buffer += "   <";
         output_buffer += MESH_TAG;
@@ -2866,9 +3066,9 @@ namespace Slic3r {
         output_buffer += VERTICES_TAG;
         output_buffer += ">\n";
 
-        auto flush = [this, &output_buffer, &context](bool force = false) {
+        auto flush = [this, &output_buffer, &writer](bool force = false) {
             if ((force && ! output_buffer.empty()) || output_buffer.size() >= 65536 * 16) {
-                if (! mz_zip_writer_add_staged_data(&context, output_buffer.data(), output_buffer.size())) {
+                if (! writer.add(output_buffer)) {
                     add_error("Error during writing or compression");
                     return false;
                 }
@@ -2926,6 +3126,8 @@ namespace Slic3r {
             const Transform3d& matrix = volume->get_matrix();
             for (const auto& vertex: its.vertices) {
                 Vec3f v = (matrix * vertex.cast<double>()).cast<float>();
+                if (binary_mesh)
+                    binary_mesh->append(reinterpret_cast<const char*>(v.data()), sizeof(Vec3f));
                 char *ptr = buf;
                 boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << VERTEX_TAG << " x=\"");
                 ptr = format_coordinate(v.x(), ptr);
@@ -2964,6 +3166,14 @@ namespace Slic3r {
             volume_it->second.last_triangle_id = triangles_count - 1;
 
             for (int i = 0; i < int(its.indices.size()); ++ i) {
+                if (binary_mesh) {
+                    const Vec3i &idx = its.indices[i];
+                    const Vec3i  triangle(
+                        idx[is_left_handed ? 2 : 0] + volume_it->second.first_vertex_id,
+                        idx[1] + volume_it->second.first_vertex_id,
+                        idx[is_left_handed ? 0 : 2] + volume_it->second.first_vertex_id);
+                    binary_mesh->append(reinterpret_cast<const char*>(triangle.data()), sizeof(Vec3i));
+                }
                 {
                     const Vec3i &idx = its.indices[i];
                     char *ptr = buf;
@@ -3018,10 +3228,30 @@ namespace Slic3r {
         output_buffer += MESH_TAG;
         output_buffer += ">\n";
 
+        if (binary_mesh) {
+            binary_mesh_header.vertices_count  = vertices_count;
+            binary_mesh_header.triangles_count = triangles_count;
+            memcpy(binary_mesh->data(), &binary_mesh_header, sizeof(binary_mesh_header));
+            assert(binary_mesh->size() == binary_mesh_header.file_size());
+        }
+
         // Force flush.
         return flush(true);
     }
 
+    bool _3MF_Exporter::_add_binary_mesh_files_to_archive(mz_zip_archive& archive)
+    {
+        for (const auto &[object_id, binary_mesh] : m_binary_mesh_files) {
+            const std::string name = BINARY_MESH_FILE_PREFIX + std::to_string(object_id) + BINARY_MESH_FILE_EXTENSION;
+            if (! add_mem_parallel(archive, name, binary_mesh.data(), binary_mesh.size(), m_compression_level)) {
+                add_error("Unable to add binary mesh file to archive");
+                return false;
+            }
+        }
+        m_binary_mesh_files.clear();
+        return true;
+    }
+
     void _3MF_Exporter::add_transformation(std::stringstream &stream, const Transform3d &tr)
     {
         for (unsigned c = 0; c < 4; ++c) {
@@ -3107,7 +3337,7 @@ namespace Slic3r {
         }
 
         if (!out.empty()) {
-            if (!mz_zip_writer_add_mem(&archive, CUT_INFORMATION_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, CUT_INFORMATION_FILE.c_str(), (const void*)out.data(), out.length(), m_compression_level)) {
                 add_error("Unable to add cut information file to archive");
                 return false;
             }
@@ -3141,7 +3371,7 @@ namespace Slic3r {
         }
 
         if (!out.empty()) {
-            if (!mz_zip_writer_add_mem(&archive, LAYER_HEIGHTS_PROFILE_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, LAYER_HEIGHTS_PROFILE_FILE.c_str(), (const void*)out.data(), out.length(), m_compression_level)) {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
             }
@@ -3199,7 +3429,7 @@ namespace Slic3r {
         }
 
         if (!out.empty()) {
-            if (!mz_zip_writer_add_mem(&archive, LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)out.data(), out.length(), m_compression_level)) {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
             }
@@ -3235,7 +3465,7 @@ namespace Slic3r {
             // Adds version header at the beginning:
             out = std::string("support_points_format_version=") + std::to_string(support_points_format_version) + std::string("\n") + out;
 
-            if (!mz_zip_writer_add_mem(&archive, SLA_SUPPORT_POINTS_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, SLA_SUPPORT_POINTS_FILE.c_str(), (const void*)out.data(), out.length(), m_compression_level)) {
                 add_error("Unable to add sla support points file to archive");
                 return false;
             }
@@ -3286,7 +3516,7 @@ namespace Slic3r {
             // Adds version header at the beginning:
             out = std::string("drain_holes_format_version=") + std::to_string(drain_holes_format_version) + std::string("\n") + out;
             
-            if (!mz_zip_writer_add_mem(&archive, SLA_DRAIN_HOLES_FILE.c_str(), static_cast<const void*>(out.data()), out.length(), mz_uint(MZ_DEFAULT_COMPRESSION))) {
+            if (!mz_zip_writer_add_mem(&archive, SLA_DRAIN_HOLES_FILE.c_str(), static_cast<const void*>(out.data()), out.length(), mz_uint(m_compression_level))) {
                 add_error("Unable to add sla support points file to archive");
                 return false;
             }
@@ -3306,7 +3536,7 @@ namespace Slic3r {
                 out += "; " + key + " = " + config.opt_serialize(key) + "\n";
 
         if (!out.empty()) {
-            if (!mz_zip_writer_add_mem(&archive, PRINT_CONFIG_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, PRINT_CONFIG_FILE.c_str(), (const void*)out.data(), out.length(), m_compression_level)) {
                 add_error("Unable to add print config file to archive");
                 return false;
             }
@@ -3441,7 +3671,7 @@ namespace Slic3r {
 
         std::string out = stream.str();
 
-        if (!mz_zip_writer_add_mem(&archive, MODEL_CONFIG_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+        if (!mz_zip_writer_add_mem(&archive, MODEL_CONFIG_FILE.c_str(), (const void*)out.data(), out.length(), m_compression_level)) {
             add_error("Unable to add model config file to archive");
             return false;
         }
@@ -3492,7 +3722,7 @@ bool _3MF_Exporter::_add_custom_gcode_per_print_z_file_to_archive( mz_zip_archiv
     } 
 
     if (!out.empty()) {
-        if (!mz_zip_writer_add_mem(&archive, CUSTOM_GCODE_PER_PRINT_Z_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+        if (!mz_zip_writer_add_mem(&archive, CUSTOM_GCODE_PER_PRINT_Z_FILE.c_str(), (const void*)out.data(), out.length(), m_compression_level)) {
             add_error("Unable to add custom Gcodes per print_z file to archive");
             return false;
         }
@@ -3575,7 +3805,7 @@ bool load_3mf(const char* path, DynamicPrintConfig& config, ConfigSubstitutionCo
     return !model->objects.empty() || !config.empty();
 }
 
-bool store_3mf(const char* path, Model* model, const DynamicPrintConfig* config, bool fullpath_sources, const ThumbnailData* thumbnail_data, bool zip64)
+bool store_3mf(const char* path, Model* model, const DynamicPrintConfig* config, bool fullpath_sources, const ThumbnailData* thumbnail_data, bool zip64, bool fast_compression, bool binary_meshes)
 {
     // All export should use "C" locales for number formatting.
     CNumericLocalesSetter locales_setter;
@@ -3584,7 +3814,7 @@ bool store_3mf(const char* path, Model* model, const DynamicPrintConfig* config,
         return false;
 
     _3MF_Exporter exporter;
-    bool res = exporter.save_model_to_file(path, *model, config, fullpath_sources, thumbnail_data, zip64);
+    bool res = exporter.save_model_to_file(path, *model, config, fullpath_sources, thumbnail_data, zip64, fast_compression, binary_meshes);
     if (!res)
         exporter.log_errors();
 
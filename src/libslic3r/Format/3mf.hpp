@@ -41,7 +41,9 @@ namespace Slic3r {
 
     // Save the given model and the config data contained in the given Print into a 3mf file.
     // The model could be modified during the export process if meshes are not repaired or have no shared vertices
-    extern bool store_3mf(const char* path, Model* model, const DynamicPrintConfig* config, bool fullpath_sources, const ThumbnailData* thumbnail_data = nullptr, bool zip64 = true);
+    // fast_compression trades the size of the file for the speed of compression, intended for temporary files.
+    // binary_meshes stores a binary copy of each mesh next to the model file, which PrusaSlicer loads instead of parsing the XML.
+    extern bool store_3mf(const char* path, Model* model, const DynamicPrintConfig* config, bool fullpath_sources, const ThumbnailData* thumbnail_data = nullptr, bool zip64 = true, bool fast_compression = false, bool binary_meshes = false);
 
 } // namespace Slic3r
 
@@ -39,52 +39,47 @@
 
 namespace Slic3r {
 
-static void anycubicsla_get_pixel_span(const std::uint8_t* ptr, const std::uint8_t* end,
-                               std::uint8_t& pixel, size_t& span_len)
-{
-    size_t max_len;
-
-    span_len = 0;
-    pixel = (*ptr) & 0xF0;
-    // the maximum length of the span depends on the pixel color
-    max_len = (pixel == 0 || pixel == 0xF0) ? 0xFFF : 0xF;
-    while (ptr < end && span_len < max_len && ((*ptr) & 0xF0) == pixel) {
-        span_len++;
-        ptr++;
-    }
-}
-
 struct AnycubicSLARasterEncoder
 {
-    sla::EncodedRaster operator()(const void *ptr,
-                                  size_t      w,
-                                  size_t      h,
-                                  size_t      num_components)
+    sla::EncodedRaster operator()(const sla::RasterRuns &runs,
+                                  size_t                 /*w*/,
+                                  size_t                 /*h*/)
     {
         std::vector<uint8_t> dst;
-        size_t               span_len;
-        std::uint8_t         pixel;
-        auto                 size = w * h * num_components;
-        dst.reserve(size);
-
-        const std::uint8_t *src = reinterpret_cast<const std::uint8_t *>(ptr);
-        const std::uint8_t *src_end = src + size;
-        while (src < src_end) {
-            anycubicsla_get_pixel_span(src, src_end, pixel, span_len);
-            src += span_len;
-            // fully transparent of fully opaque pixel
-            if (pixel == 0 || pixel == 0xF0) {
-                pixel = pixel | (span_len >> 8);
-                std::copy(&pixel, (&pixel) + 1, std::back_inserter(dst));
-                pixel = span_len & 0xFF;
-                std::copy(&pixel, (&pixel) + 1, std::back_inserter(dst));
+        dst.reserve(LAYER_SIZE_ESTIMATE);
+
+        // Emit a span of pixels, split by the maximum span length, which
+        // depends on the pixel color.
+        auto emit_span = [&dst](std::uint8_t pixel, size_t span_len) {
+            const bool   solid   = pixel == 0 || pixel == 0xF0;
+            const size_t max_len = solid ? 0xFFF : 0xF;
+            while (span_len > 0) {
+                size_t len = std::min(span_len, max_len);
+                // fully transparent of fully opaque pixel
+                if (solid) {
+                    dst.emplace_back(std::uint8_t(pixel | (len >> 8)));
+                    dst.emplace_back(std::uint8_t(len & 0xFF));
+                }
+                // antialiased pixel
+                else
+                    dst.emplace_back(std::uint8_t(pixel | len));
+                span_len -= len;
             }
-            // antialiased pixel
-            else {
-                pixel = pixel | span_len;
-                std::copy(&pixel, (&pixel) + 1, std::back_inserter(dst));
+        };
+
+        // Merge the runs of the pixels with the same 4 bit color.
+        std::uint8_t pixel    = 0;
+        size_t       span_len = 0;
+        runs.for_each_run([&](std::uint8_t value, size_t len) {
+            value &= 0xF0;
+            if (span_len > 0 && value != pixel) {
+                emit_span(pixel, span_len);
+                span_len = 0;
             }
-        }
+            pixel = value;
+            span_len += len;
+        });
+        emit_span(pixel, span_len);
 
         return sla::EncodedRaster(std::move(dst), "pwimg");
     }
@@ -401,12 +396,20 @@ std::unique_ptr<sla::RasterBase> AnycubicSLAArchive::create_raster() const
 
     double gamma = m_cfg.gamma_correction.getFloat();
 
-    return sla::create_raster_grayscale_aa(res, pxdim, gamma, tr);
+    // The layers are run length encoded, there is no need for a pixel buffer.
+    return sla::create_raster_grayscale_aa_runs(res, pxdim, gamma, tr);
 }
 
 sla::RasterEncoder AnycubicSLAArchive::get_encoder() const
 {
-    return AnycubicSLARasterEncoder{};
+    return [](const void *ptr, size_t w, size_t h, size_t num_components) {
+        return AnycubicSLARasterEncoder{}(sla::PixelBufferRuns{ptr, w * h * num_components}, w, h);
+    };
+}
+
+sla::EncodedRaster AnycubicSLAArchive::encode_raster(const sla::RasterBase &rst) const
+{
+    return rst.encode_runs(AnycubicSLARasterEncoder{});
 }
 
 // Endian safe write of little endian 32bit ints
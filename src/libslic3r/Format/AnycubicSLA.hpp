@@ -27,6 +27,7 @@ class AnycubicSLAArchive: public SLAArchiveWriter {
 protected:
     std::unique_ptr<sla::RasterBase> create_raster() const override;
     sla::RasterEncoder get_encoder() const override;
+    sla::EncodedRaster encode_raster(const sla::RasterBase &rst) const override;
 
     SLAPrinterConfig & cfg() { return m_cfg; }
     const SLAPrinterConfig & cfg() const { return m_cfg; }
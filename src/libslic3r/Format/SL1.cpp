@@ -211,14 +211,12 @@ void SL1Archive::export_print(Zipper               &zipper,
         zipper.add_entry("prusaslicer.ini");
         zipper << to_ini(slicerconf);
 
-        size_t i = 0;
-        for (const sla::EncodedRaster &rst : m_layers) {
-
-            std::string imgname = project + string_printf("%.5d", i++) + "." +
+        stream_layers(print, [&zipper, &project](size_t idx, sla::EncodedRaster &&rst) {
+            std::string imgname = project + string_printf("%.5d", idx) + "." +
                                   rst.extension();
 
             zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
-        }
+        });
 
         for (const ThumbnailData& data : thumbnails)
             if (data.is_valid())
@@ -355,13 +353,15 @@ ExPolygons rings_to_expolygons(const std::vector<marchsq::Ring> &rings,
     return union_ex(polys);
 }
 
+// The layer images are read from the archive one after another and decoded
+// and vectorized in parallel, holding just a few of them in memory at a time.
 std::vector<ExPolygons> extract_slices_from_sla_archive(
-    ZipperArchive           &arch,
+    ZipperArchiveReader     &arch,
     const RasterParams      &rstp,
     const marchsq::Coord    &win,
     std::function<bool(int)> progr)
 {
-    std::vector<ExPolygons> slices(arch.entries.size());
+    std::vector<ExPolygons> slices(arch.num_entries());
 
     struct Status
     {
@@ -370,13 +370,12 @@ std::vector<ExPolygons> extract_slices_from_sla_archive(
         execution::SpinningMutex<ExecutionTBB> mutex = {};
     } st{100. / slices.size(), 0., 0.};
 
-    execution::for_each(
-        ex_tbb, size_t(0), arch.entries.size(),
-        [&arch, &slices, &st, &rstp, &win, progr](size_t i) {
+    arch.process_entries(
+        [&slices, &st, &rstp, &win, progr](size_t i, EntryBuffer &&entry) {
             // Status indication guarded with the spinlock
             {
                 std::lock_guard lck(st.mutex);
-                if (st.stop) return;
+                if (st.stop) return false;
 
                 st.val += st.incr;
                 double curr = std::round(st.val);
@@ -387,9 +386,8 @@ std::vector<ExPolygons> extract_slices_from_sla_archive(
             }
 
             png::ImageGreyscale img;
-            png::ReadBuf        rb{arch.entries[i].buf.data(),
-                            arch.entries[i].buf.size()};
-            if (!png::decode_png(rb, img)) return;
+            png::ReadBuf        rb{entry.buf.data(), entry.buf.size()};
+            if (!png::decode_png(rb, img)) return true;
 
             constexpr uint8_t isoval = 128;
             auto              rings = marchsq::execute(img, isoval, win);
@@ -400,8 +398,8 @@ std::vector<ExPolygons> extract_slices_from_sla_archive(
             invert_raster_trafo(expolys, rstp.trafo, rstp.width, rstp.height);
 
             slices[i] = std::move(expolys);
-        },
-        execution::max_concurrency(ex_tbb));
+            return true;
+        });
 
     if (st.stop) slices = {};
 
@@ -430,8 +428,8 @@ ConfigSubstitutions SL1Reader::read(std::vector<ExPolygons> &slices,
 
     std::vector<std::string> includes = { "ini", "png"};
     std::vector<std::string> excludes = { "thumbnail" };
-    ZipperArchive arch = read_zipper_archive(m_fname, includes, excludes);
-    auto [profile_use, config_substitutions] = extract_profile(arch, profile_out);
+    ZipperArchiveReader arch(m_fname, includes, excludes);
+    auto [profile_use, config_substitutions] = extract_profile(arch.metadata(), profile_out);
 
     RasterParams   rstp = get_raster_params(profile_use);
     marchsq::Coord win  = {windowsize.y(), windowsize.x()};
@@ -32,6 +32,8 @@ protected:
 
 public:
 
+    bool streams_layers() const override { return true; }
+
     SL1Archive() = default;
     explicit SL1Archive(const SLAPrinterConfig &cfg): m_cfg(cfg) {}
     explicit SL1Archive(SLAPrinterConfig &&cfg): m_cfg(std::move(cfg)) {}
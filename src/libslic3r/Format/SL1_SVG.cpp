@@ -8,6 +8,7 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/BoundingBox.hpp"
 #include "libslic3r/Format/ZipperArchiveImport.hpp"
+#include "libslic3r/Execution/ExecutionTBB.hpp"
 
 #define NANOSVG_IMPLEMENTATION
 #include "nanosvg/nanosvg.h"
@@ -259,8 +260,8 @@ ConfigSubstitutions SL1_SVGReader::read(std::vector<ExPolygons> &slices,
                                         DynamicPrintConfig      &profile_out)
 {
     std::vector<std::string> includes = { CONFIG_FNAME, PROFILE_FNAME, "svg"};
-    ZipperArchive arch = read_zipper_archive(m_fname, includes, {});
-    auto [profile_use, config_substitutions] = extract_profile(arch, profile_out);
+    ZipperArchiveReader arch(m_fname, includes, {});
+    auto [profile_use, config_substitutions] = extract_profile(arch.metadata(), profile_out);
 
     RasterParams rstp = get_raster_params(profile_use);
 
@@ -268,16 +269,24 @@ ConfigSubstitutions SL1_SVGReader::read(std::vector<ExPolygons> &slices,
     {
         double                                 incr, val, prev;
         bool                                   stop  = false;
-    } st{100. / arch.entries.size(), 0., 0.};
-
-    for (const EntryBuffer &entry : arch.entries) {
-        if (st.stop) break;
-
-        st.val += st.incr;
-        double curr = std::round(st.val);
-        if (curr > st.prev) {
-            st.prev = curr;
-            st.stop = !m_progr(int(curr));
+        execution::SpinningMutex<ExecutionTBB> mutex = {};
+    } st{100. / arch.num_entries(), 0., 0.};
+
+    // The layers are read one after another and parsed in parallel.
+    size_t first_slice = slices.size();
+    slices.resize(first_slice + arch.num_entries());
+    arch.process_entries([this, &slices, first_slice, &st, &rstp](size_t idx, EntryBuffer &&entry) {
+        // Status indication guarded with the spinlock
+        {
+            std::lock_guard lck(st.mutex);
+            if (st.stop) return false;
+
+            st.val += st.incr;
+            double curr = std::round(st.val);
+            if (curr > st.prev) {
+                st.prev = curr;
+                st.stop = !m_progr(int(curr));
+            }
         }
 
         // Don't want to use dirty casts for the buffer to be usable in
@@ -305,8 +314,12 @@ ConfigSubstitutions SL1_SVGReader::read(std::vector<ExPolygons> &slices,
         // but if it's different, the file is probably corrupted anyways.
         ExPolygons expolys = union_ex(polys, ClipperLib::pftNonZero);
         invert_raster_trafo(expolys, rstp.trafo, rstp.width, rstp.height);
-        slices.emplace_back(expolys);
-    }
+        slices[first_slice + idx] = std::move(expolys);
+        return true;
+    });
+
+    if (st.stop)
+        slices.resize(first_slice);
 
     // Compile error without the move
     return std::move(config_substitutions);
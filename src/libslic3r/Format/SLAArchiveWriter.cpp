@@ -6,8 +6,74 @@
 #include "SLAArchiveWriter.hpp"
 #include "SLAArchiveFormatRegistry.hpp"
 
+#include "libslic3r/SLAPrint.hpp"
+
+#include <tbb/task_arena.h>
+
+// Intel redesigned some TBB interface considerably when merging TBB with their oneAPI set of libraries, see GH #7332.
+// We are using quite an old TBB 2017 U7. Before we update our build servers, let's use the old API, which is deprecated in up to date TBB.
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if ! defined(TBB_VERSION_MAJOR)
+    static_assert(false, "TBB_VERSION_MAJOR not defined");
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
+void SLAArchiveWriter::stream_layers(const SLAPrint &print, const WriteLayerFn &writefn) const
+{
+    struct Layer {
+        size_t                           idx;
+        std::unique_ptr<sla::RasterBase> raster;
+        sla::EncodedRaster               encoded;
+    };
+
+    const std::vector<SLAPrint::PrintLayer> &layers = print.print_layers();
+    size_t next_idx = 0;
+
+    const auto generator = tbb::make_filter<void, std::shared_ptr<Layer>>(slic3r_tbb_filtermode::serial_in_order,
+        [&layers, &print, &next_idx](tbb::flow_control &fc) -> std::shared_ptr<Layer> {
+            if (next_idx == layers.size() || print.canceled()) {
+                fc.stop();
+                return {};
+            }
+            auto layer = std::make_shared<Layer>();
+            layer->idx = next_idx ++;
+            return layer;
+        });
+    const auto rasterize = tbb::make_filter<std::shared_ptr<Layer>, std::shared_ptr<Layer>>(slic3r_tbb_filtermode::parallel,
+        [this, &layers](std::shared_ptr<Layer> layer) -> std::shared_ptr<Layer> {
+            layer->raster = create_raster();
+            layers[layer->idx].draw(*layer->raster);
+            return layer;
+        });
+    const auto encode = tbb::make_filter<std::shared_ptr<Layer>, std::shared_ptr<Layer>>(slic3r_tbb_filtermode::parallel,
+        [this](std::shared_ptr<Layer> layer) -> std::shared_ptr<Layer> {
+            layer->encoded = encode_raster(*layer->raster);
+            layer->raster.reset();
+            return layer;
+        });
+    const auto output = tbb::make_filter<std::shared_ptr<Layer>, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&writefn, &print](std::shared_ptr<Layer> layer) {
+            if (! print.canceled())
+                writefn(layer->idx, std::move(layer->encoded));
+        });
+
+    // The number of live tokens bounds the number of rasters and encoded layers in memory.
+    tbb::parallel_pipeline(2 * size_t(tbb::this_task_arena::max_concurrency()), generator & rasterize & encode & output);
+
+    if (print.canceled())
+        throw CanceledException();
+}
+
 std::unique_ptr<SLAArchiveWriter>
 SLAArchiveWriter::create(const std::string &archtype, const SLAPrinterConfig &cfg)
 {
@@ -6,6 +6,7 @@
 #define SLAARCHIVE_HPP
 
 #include <vector>
+#include <functional>
 
 #include "libslic3r/SLA/RasterBase.hpp"
 #include "libslic3r/Execution/ExecutionTBB.hpp"
@@ -23,9 +24,29 @@ protected:
     virtual std::unique_ptr<sla::RasterBase> create_raster() const = 0;
     virtual sla::RasterEncoder get_encoder() const = 0;
 
+    // Encode a raster created by create_raster(). Archives with run length
+    // encoded layers may override it to consume the runs of the raster.
+    virtual sla::EncodedRaster encode_raster(const sla::RasterBase &rst) const
+    {
+        return rst.encode(get_encoder());
+    }
+
+    using WriteLayerFn = std::function<void(size_t layer_idx, sla::EncodedRaster &&layer)>;
+
+    // Rasterize and encode the print layers in parallel and pass them to
+    // writefn in the order of the layers, while the next layers are being
+    // rasterized. Only a few layers per thread are held in memory at once.
+    // Throws CanceledException if the print gets canceled.
+    void stream_layers(const SLAPrint &print, const WriteLayerFn &writefn) const;
+
 public:
     virtual ~SLAArchiveWriter() = default;
 
+    // An archive streaming its layers rasterizes them in export_print() using
+    // stream_layers() instead of keeping all of the encoded layers rendered
+    // by draw_layers() in memory. draw_layers() is not called for it.
+    virtual bool streams_layers() const { return false; }
+
     // Fn have to be thread safe: void(sla::RasterBase& raster, size_t lyrid);
     template<class Fn, class CancelFn, class EP = ExecutionTBB>
     void draw_layers(
@@ -43,7 +64,7 @@ public:
                 sla::EncodedRaster &enc = m_layers[idx];
                 auto                rst = create_raster();
                 drawfn(*rst, idx);
-                enc = rst->encode(get_encoder());
+                enc = encode_raster(*rst);
             },
             execution::max_concurrency(ep));
     }
@@ -12,6 +12,23 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <atomic>
+
+#include <tbb/task_arena.h>
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if ! defined(TBB_VERSION_MAJOR)
+    static_assert(false, "TBB_VERSION_MAJOR not defined");
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
 namespace {
@@ -32,46 +49,31 @@ boost::property_tree::ptree read_ini(const mz_zip_archive_file_stat &entry,
     return tree;
 }
 
-// Read an arbitrary file into EntryBuffer
-EntryBuffer read_entry(const mz_zip_archive_file_stat &entry,
-                       MZ_Archive                     &zip,
-                       const std::string              &name)
-{
-    std::vector<uint8_t> buf(entry.m_uncomp_size);
-
-    if (!mz_zip_reader_extract_to_mem(&zip.arch, entry.m_file_index,
-                                           buf.data(), buf.size(), 0))
-        throw Slic3r::FileIOError(zip.get_errorstr());
-
-    return {std::move(buf), (name.empty() ? entry.m_filename : name)};
-}
-
 } // namespace
 
-ZipperArchive read_zipper_archive(const std::string &zipfname,
-                                  const std::vector<std::string> &includes,
-                                  const std::vector<std::string> &excludes)
+// Little RAII
+struct ZipperArchiveReader::Zip : public MZ_Archive
 {
-    ZipperArchive arch;
-
-    // Little RAII
-    struct Arch : public MZ_Archive
+    Zip(const std::string &fname)
     {
-        Arch(const std::string &fname)
-        {
-            if (!open_zip_reader(&arch, fname))
-                throw Slic3r::FileIOError(get_errorstr());
-        }
+        if (!open_zip_reader(&arch, fname))
+            throw Slic3r::FileIOError(get_errorstr());
+    }
 
-        ~Arch() { close_zip_reader(&arch); }
-    } zip(zipfname);
+    ~Zip() { close_zip_reader(&arch); }
+};
 
-    mz_uint num_entries = mz_zip_reader_get_num_files(&zip.arch);
+ZipperArchiveReader::ZipperArchiveReader(const std::string              &zipfname,
+                                         const std::vector<std::string> &includes,
+                                         const std::vector<std::string> &excludes)
+    : m_zip(std::make_unique<Zip>(zipfname))
+{
+    mz_uint num_entries = mz_zip_reader_get_num_files(&m_zip->arch);
 
     for (mz_uint i = 0; i < num_entries; ++i) {
         mz_zip_archive_file_stat entry;
 
-        if (mz_zip_reader_file_stat(&zip.arch, i, &entry)) {
+        if (mz_zip_reader_file_stat(&m_zip->arch, i, &entry)) {
             std::string name = entry.m_filename;
             boost::algorithm::to_lower(name);
 
@@ -88,26 +90,88 @@ ZipperArchive read_zipper_archive(const std::string &zipfname,
                 continue;
 
             if (name == CONFIG_FNAME)  {
-                arch.config = read_ini(entry, zip);
+                m_metadata.config = read_ini(entry, *m_zip);
                 continue;
             }
 
             if (name == PROFILE_FNAME) {
-                arch.profile = read_ini(entry, zip);
+                m_metadata.profile = read_ini(entry, *m_zip);
                 continue;
             }
 
-            auto it = std::lower_bound(
-                arch.entries.begin(), arch.entries.end(),
-                EntryBuffer{{}, name},
-                [](const EntryBuffer &r1, const EntryBuffer &r2) {
-                    return std::less<std::string>()(r1.fname, r2.fname);
-                });
-
-            arch.entries.insert(it, read_entry(entry, zip, name));
+            m_entries.push_back({std::move(name), entry.m_file_index, size_t(entry.m_uncomp_size)});
         }
     }
 
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [](const Entry &e1, const Entry &e2) {
+                         return std::less<std::string>()(e1.fname, e2.fname);
+                     });
+}
+
+ZipperArchiveReader::~ZipperArchiveReader() = default;
+
+EntryBuffer ZipperArchiveReader::read_entry(size_t idx)
+{
+    const Entry         &entry = m_entries[idx];
+    std::vector<uint8_t> buf(entry.size);
+
+    if (!mz_zip_reader_extract_to_mem(&m_zip->arch, entry.file_index,
+                                           buf.data(), buf.size(), 0))
+        throw Slic3r::FileIOError(m_zip->get_errorstr());
+
+    return {std::move(buf), entry.fname};
+}
+
+bool ZipperArchiveReader::process_entries(const std::function<bool(size_t, EntryBuffer &&)> &process_fn,
+                                          size_t max_buffered)
+{
+    struct Item {
+        size_t      idx;
+        EntryBuffer entry;
+    };
+
+    if (max_buffered == 0)
+        max_buffered = 2 * size_t(tbb::this_task_arena::max_concurrency());
+
+    std::atomic<bool> stop     = false;
+    size_t            next_idx = 0;
+
+    // The zip reader is not thread safe, the entries are read sequentially.
+    const auto reader = tbb::make_filter<void, std::shared_ptr<Item>>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &next_idx, &stop](tbb::flow_control &fc) -> std::shared_ptr<Item> {
+            if (next_idx == m_entries.size() || stop) {
+                fc.stop();
+                return {};
+            }
+            auto item = std::make_shared<Item>();
+            item->idx   = next_idx;
+            item->entry = this->read_entry(next_idx ++);
+            return item;
+        });
+
+    const auto process = tbb::make_filter<std::shared_ptr<Item>, void>(slic3r_tbb_filtermode::parallel,
+        [&process_fn, &stop](std::shared_ptr<Item> item) {
+            if (! stop && ! process_fn(item->idx, std::move(item->entry)))
+                stop = true;
+        });
+
+    tbb::parallel_pipeline(max_buffered, reader & process);
+
+    return ! stop;
+}
+
+ZipperArchive read_zipper_archive(const std::string &zipfname,
+                                  const std::vector<std::string> &includes,
+                                  const std::vector<std::string> &excludes)
+{
+    ZipperArchiveReader reader(zipfname, includes, excludes);
+
+    ZipperArchive arch = reader.metadata();
+    arch.entries.reserve(reader.num_entries());
+    for (size_t i = 0; i < reader.num_entries(); ++ i)
+        arch.entries.emplace_back(reader.read_entry(i));
+
     return arch;
 }
 
@@ -8,6 +8,8 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <functional>
+#include <memory>
 
 #include <boost/property_tree/ptree.hpp>
 
@@ -45,6 +47,51 @@ ZipperArchive read_zipper_archive(const std::string &zipfname,
                                   const std::vector<std::string> &includes,
                                   const std::vector<std::string> &excludes);
 
+// Reader of an archive written using the Zipper class, which reads just the
+// metadata when opened and the other entries on demand. Archives with
+// thousands of layer images need not to be held in memory all at once.
+class ZipperArchiveReader
+{
+public:
+    // Opens the archive and reads CONFIG_FNAME and PROFILE_FNAME, the includes
+    // and excludes filter the other entries as with read_zipper_archive().
+    // Throws FileIOError.
+    ZipperArchiveReader(const std::string              &zipfname,
+                        const std::vector<std::string> &includes,
+                        const std::vector<std::string> &excludes);
+    ~ZipperArchiveReader();
+
+    // ZipperArchive::entries of the metadata are empty.
+    const ZipperArchive &metadata() const { return m_metadata; }
+
+    // The entries passing the filters are indexed in the order of their names.
+    size_t num_entries() const { return m_entries.size(); }
+
+    // Read an entry into memory. Throws FileIOError. Not thread safe.
+    EntryBuffer read_entry(size_t idx);
+
+    // Read the entries one after another and hand them over to
+    // process_fn(idx, entry), which is called in parallel. At most max_buffered
+    // entries are held in memory at a time, zero for a default derived from
+    // the number of threads. Once process_fn returns false, no other entries
+    // are processed and false is returned.
+    bool process_entries(const std::function<bool(size_t, EntryBuffer &&)> &process_fn,
+                         size_t max_buffered = 0);
+
+private:
+    struct Zip;
+    struct Entry
+    {
+        std::string  fname;
+        unsigned int file_index;
+        size_t       size;
+    };
+
+    std::unique_ptr<Zip> m_zip;
+    ZipperArchive        m_metadata;
+    std::vector<Entry>   m_entries;
+};
+
 // Extract the print profile form the archive into 'out'.
 // Returns a profile that has correct parameters to use for model reconstruction
 // even if the needed parameters were not fully found in the archive's metadata.
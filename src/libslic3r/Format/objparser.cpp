@@ -5,9 +5,16 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include "objparser.hpp"
 
 #include "libslic3r/LocalesUtils.hpp"
@@ -29,7 +36,17 @@ static double strtod_clocale(const char* str, char const** str_end)
 	return val;
 }
 
-static bool obj_parseline(const char *line, ObjData &data)
+// Indices of ObjData::vertices, which referenced the coordinates, normals or texture coordinates relative to the end
+// of the data parsed so far. Filled in when parsing a chunk of a file, as the references have to be shifted by the number
+// of items parsed from the preceding chunks.
+struct ObjRelativeReferences
+{
+	std::vector<size_t> coords;
+	std::vector<size_t> normals;
+	std::vector<size_t> textureCoords;
+};
+
+static bool obj_parseline(const char *line, ObjData &data, ObjRelativeReferences *relative_refs = nullptr)
 {
 #define EATWS() while (*line == ' ' || *line == '\t') ++ line
 
@@ -236,17 +253,23 @@ static bool obj_parseline(const char *line, ObjData &data)
 					line = endptr;
 				}
 			}
-			if (vertex.coordIdx < 0)
+			if (vertex.coordIdx < 0) {
                 vertex.coordIdx += (int)data.coordinates.size() / 4;
-            else
+				if (relative_refs)
+					relative_refs->coords.push_back(data.vertices.size());
+			} else
 				-- vertex.coordIdx;
-			if (vertex.normalIdx < 0)
+			if (vertex.normalIdx < 0) {
                 vertex.normalIdx += (int)data.normals.size() / 3;
-            else
+				if (relative_refs)
+					relative_refs->normals.push_back(data.vertices.size());
+			} else
 				-- vertex.normalIdx;
-			if (vertex.textureCoordIdx < 0)
+			if (vertex.textureCoordIdx < 0) {
                 vertex.textureCoordIdx += (int)data.textureCoordinates.size() / 3;
-            else
+				if (relative_refs)
+					relative_refs->textureCoords.push_back(data.vertices.size());
+			} else
 				-- vertex.textureCoordIdx;
 			data.vertices.push_back(vertex);
 			EATWS();
@@ -343,48 +366,118 @@ static bool obj_parseline(const char *line, ObjData &data)
 	return true;
 }
 
+// Parse the lines of a chunk of a memory mapped file. The chunk starts at the beginning of a line.
+static bool obj_parse_chunk(const char *begin, const char *end, ObjData &data, ObjRelativeReferences &relative_refs)
+{
+	Slic3r::CNumericLocalesSetter locales_setter;
+	std::vector<char> line;
+	try {
+		for (const char *line_begin = begin; line_begin < end;) {
+			const char *line_end = std::find_if(line_begin, end, [](char c) { return c == '\r' || c == '\n'; });
+			if (line_end - line_begin > 65536) {
+				BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
+				return false;
+			}
+			line.assign(line_begin, line_end);
+			line.emplace_back(0);
+			const char *c = line.data();
+			while (*c == ' ' || *c == '\t')
+				++ c;
+			//FIXME check the return value and exit on error?
+			// Will it break parsing of some obj files?
+			obj_parseline(c, data, &relative_refs);
+			line_begin = line_end + 1;
+		}
+	} catch (std::bad_alloc&) {
+		BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
+	}
+	return true;
+}
+
+template<typename T>
+static void append_vector(std::vector<T> &dst, std::vector<T> &src)
+{
+	dst.insert(dst.end(), src.begin(), src.end());
+	src = std::vector<T>();
+}
+
+template<typename T>
+static void append_vector_shift_vertex_idx(std::vector<T> &dst, std::vector<T> &src, int vertex_idx_offset)
+{
+	size_t first = dst.size();
+	append_vector(dst, src);
+	for (size_t i = first; i < dst.size(); ++ i)
+		dst[i].vertexIdxFirst += vertex_idx_offset;
+}
+
+// The file is memory mapped and split into chunks at line boundaries, which are parsed in parallel
+// and then concatenated. Relative references of the faces are shifted by the items parsed from the preceding chunks.
 bool objparse(const char *path, ObjData &data)
 {
-    Slic3r::CNumericLocalesSetter locales_setter;
+	boost::iostreams::mapped_file_source mapped;
+	try {
+		if (boost::filesystem::file_size(boost::filesystem::path(path)) == 0)
+			return true;
+		mapped.open(boost::filesystem::path(path));
+	} catch (const std::exception &ex) {
+		BOOST_LOG_TRIVIAL(error) << "ObjParser: Couldn't open " << path << ": " << ex.what();
+		return false;
+	}
 
-	FILE *pFile = boost::nowide::fopen(path, "rt");
-	if (pFile == 0)
+	const char   *begin      = mapped.data();
+	const char   *end        = begin + mapped.size();
+	static constexpr const size_t chunk_size = 4 * 1024 * 1024;
+	const size_t  num_chunks = (mapped.size() + chunk_size - 1) / chunk_size;
+	std::vector<const char*> chunk_begins(num_chunks + 1, end);
+	for (size_t i = 0; i < num_chunks; ++ i) {
+		// Start each chunk at the beginning of a line.
+		const char *p = begin + i * chunk_size;
+		while (p > begin && p < end && p[-1] != '\r' && p[-1] != '\n')
+			++ p;
+		chunk_begins[i] = std::max(p, i == 0 ? begin : chunk_begins[i - 1]);
+	}
+
+	struct Chunk {
+		ObjData					data;
+		ObjRelativeReferences	relative_refs;
+		bool					ok { true };
+	};
+	std::vector<Chunk> chunks(num_chunks);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1), [&chunks, &chunk_begins](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i)
+			chunks[i].ok = obj_parse_chunk(chunk_begins[i], chunk_begins[i + 1], chunks[i].data, chunks[i].relative_refs);
+	});
+	if (std::any_of(chunks.begin(), chunks.end(), [](const Chunk &chunk) { return ! chunk.ok; }))
 		return false;
 
 	try {
-		char buf[65536 * 2];
-		size_t len = 0;
-		size_t lenPrev = 0;
-		while ((len = ::fread(buf + lenPrev, 1, 65536, pFile)) != 0) {
-			len += lenPrev;
-			size_t lastLine = 0;
-			for (size_t i = 0; i < len; ++ i)
-				if (buf[i] == '\r' || buf[i] == '\n') {
-					buf[i] = 0;
-					char *c = buf + lastLine;
-					while (*c == ' ' || *c == '\t')
-						++ c;
-					//FIXME check the return value and exit on error?
-					// Will it break parsing of some obj files?
-					obj_parseline(c, data);
-					lastLine = i + 1;
-				}
-			lenPrev = len - lastLine;
-			if (lenPrev > 65536) {
-		    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
-				::fclose(pFile);
-				return false;
-			}
-			memmove(buf, buf + lastLine, lenPrev);
+		for (Chunk &chunk : chunks) {
+			const int coord_offset         = int(data.coordinates.size() / 4);
+			const int normal_offset        = int(data.normals.size() / 3);
+			const int texture_coord_offset = int(data.textureCoordinates.size() / 3);
+			const int vertex_offset        = int(data.vertices.size());
+			for (size_t idx : chunk.relative_refs.coords)
+				chunk.data.vertices[idx].coordIdx += coord_offset;
+			for (size_t idx : chunk.relative_refs.normals)
+				chunk.data.vertices[idx].normalIdx += normal_offset;
+			for (size_t idx : chunk.relative_refs.textureCoords)
+				chunk.data.vertices[idx].textureCoordIdx += texture_coord_offset;
+			chunk.relative_refs = ObjRelativeReferences();
+			append_vector(data.coordinates, chunk.data.coordinates);
+			append_vector(data.textureCoordinates, chunk.data.textureCoordinates);
+			append_vector(data.normals, chunk.data.normals);
+			append_vector(data.parameters, chunk.data.parameters);
+			append_vector(data.mtllibs, chunk.data.mtllibs);
+			append_vector_shift_vertex_idx(data.usemtls, chunk.data.usemtls, vertex_offset);
+			append_vector_shift_vertex_idx(data.objects, chunk.data.objects, vertex_offset);
+			append_vector_shift_vertex_idx(data.groups, chunk.data.groups, vertex_offset);
+			append_vector_shift_vertex_idx(data.smoothingGroups, chunk.data.smoothingGroups, vertex_offset);
+			append_vector(data.vertices, chunk.data.vertices);
 		}
-    }
-    catch (std::bad_alloc&) {
-    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
+	} catch (std::bad_alloc&) {
+		BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
 	}
-	::fclose(pFile);
 
-	// printf("vertices: %d\r\n", data.vertices.size() / 4);
-	// printf("coords: %d\r\n", data.coordinates.size());
 	return true;
 }
 
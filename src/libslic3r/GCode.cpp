@@ -24,6 +24,7 @@
 #include "libslic3r.h"
 #include "GCode/ExtrusionProcessor.hpp"
 #include "I18N.hpp"
+#include "ProfilerTracy.hpp"
 #include "GCode.hpp"
 #include "Exception.hpp"
 #include "ExtrusionEntity.hpp"
@@ -50,6 +51,7 @@
 #include <chrono>
 #include <math.h>
 #include <optional>
+#include <set>
 #include <string>
 #include <string_view>
 
@@ -66,6 +68,7 @@
 #include "SVG.hpp"
 
 #include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 
 // Intel redesigned some TBB interface considerably when merging TBB with their oneAPI set of libraries, see GH #7332.
 // We are using quite an old TBB 2017 U7. Before we update our build servers, let's use the old API, which is deprecated in up to date TBB.
@@ -543,8 +546,10 @@ namespace DoExport {
     }
 } // namespace DoExport
 
-void GCodeGenerator::do_export(Print* print, const char* path, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb)
+void GCodeGenerator::do_export(Print* print, const char* path, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb,
+                               GCodeProcessorResultCallback preview_cb)
 {
+    SLIC3R_PROFILE_ZONE();
     CNumericLocalesSetter locales_setter;
 
     // Does the file exist? If so, we hope that it is still valid.
@@ -579,26 +584,45 @@ void GCodeGenerator::do_export(Print* print, const char* path, GCodeProcessorRes
     std::string path_tmp(path);
     path_tmp += ".tmp";
 
-    m_processor.initialize(path_tmp);
+    // The G-code is written twice: first by the G-code generator, then by the G-code processor, which inserts the remaining
+    // print times and the filament statistics known only once the whole G-code was generated. The first pass is written
+    // into the local temporary directory, so that only the final G-code is written to the target storage,
+    // which may be a slow removable or network drive.
+    std::string path_first_pass;
+    {
+        boost::system::error_code ec;
+        boost::filesystem::path   tmp_dir = boost::filesystem::temp_directory_path(ec);
+        if (! ec)
+            path_first_pass = (tmp_dir / boost::filesystem::unique_path("." SLIC3R_APP_KEY ".gcode.%%%%-%%%%-%%%%-%%%%")).string();
+    }
+    FILE *fp = path_first_pass.empty() ? nullptr : boost::nowide::fopen(path_first_pass.c_str(), "wb");
+    if (fp == nullptr) {
+        // No usable temporary directory. Write the first pass next to the target and post-process it in place.
+        path_first_pass = path_tmp;
+        fp = boost::nowide::fopen(path_first_pass.c_str(), "wb");
+    }
+
+    m_processor.initialize(path_first_pass);
     m_processor.set_print(print);
     m_processor.get_binary_data() = bgcode::binarize::BinaryData();
-    GCodeOutputStream file(boost::nowide::fopen(path_tmp.c_str(), "wb"), m_processor);
+    GCodeOutputStream file(fp, m_processor);
     if (! file.is_open())
         throw Slic3r::RuntimeError(std::string("G-code export to ") + path + " failed.\nCannot open the file for writing.\n");
+    file.set_preview_callback(std::move(preview_cb));
 
     try {
         this->_do_export(*print, file, thumbnail_cb);
         file.flush();
         if (file.is_error()) {
             file.close();
-            boost::nowide::remove(path_tmp.c_str());
+            boost::nowide::remove(path_first_pass.c_str());
             throw Slic3r::RuntimeError(std::string("G-code export to ") + path + " failed\nIs the disk full?\n");
         }
     } catch (std::exception & /* ex */) {
         // Rethrow on any exception. std::runtime_exception and CanceledException are expected to be thrown.
         // Close and remove the file.
         file.close();
-        boost::nowide::remove(path_tmp.c_str());
+        boost::nowide::remove(path_first_pass.c_str());
         throw;
     }
     file.close();
@@ -610,7 +634,7 @@ void GCodeGenerator::do_export(Print* print, const char* path, GCodeProcessorRes
         for (const auto &name_and_error : m_placeholder_parser_integration.failed_templates)
             msg += name_and_error.first + "\n" + name_and_error.second + "\n";
         msg += "\nPlease inspect the file ";
-        msg += path_tmp + " for error messages enclosed between\n";
+        msg += path_first_pass + " for error messages enclosed between\n";
         msg += "        !!!!! Failed to process the custom G-code template ...\n";
         msg += "and\n";
         msg += "        !!!!! End of an error report for the custom G-code template ...\n";
@@ -619,8 +643,13 @@ void GCodeGenerator::do_export(Print* print, const char* path, GCodeProcessorRes
     }
 
     BOOST_LOG_TRIVIAL(debug) << "Start processing gcode, " << log_memory_info();
-    // Post-process the G-code to update time stamps.
-    m_processor.finalize(true);
+    // Post-process the G-code to update time stamps, writing the final G-code to path_tmp.
+    try {
+        m_processor.finalize(true, path_first_pass == path_tmp ? std::string() : path_tmp);
+    } catch (std::exception & /* ex */) {
+        boost::nowide::remove(path_first_pass.c_str());
+        throw;
+    }
 //    DoExport::update_print_estimated_times_stats(m_processor, print->m_print_statistics);
     DoExport::update_print_estimated_stats(m_processor, m_writer.extruders(), print->m_print_statistics);
     if (result != nullptr) {
@@ -862,6 +891,13 @@ static inline GCode::SmoothPathCache smooth_path_interpolate_global(const Print&
     return out;
 }
 
+// Number of layers in flight in the G-code generator pipeline. Smooth path interpolation runs in parallel,
+// thus let it run ahead of the serial G-code generator by a couple of layers per worker thread.
+static inline size_t process_layers_max_tokens()
+{
+    return std::max<size_t>(12, 2 * size_t(tbb::this_task_arena::max_concurrency()));
+}
+
 void GCodeGenerator::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGeneratorCallback thumbnail_cb)
 {
     const bool export_to_binary_gcode = print.full_print_config().option<ConfigOptionBool>("gcode_binary")->value;
@@ -1239,6 +1275,9 @@ void GCodeGenerator::_do_export(Print& print, GCodeOutputStream &file, Thumbnail
         const PrintObject *prev_object = (*print_object_instance_sequential_active)->print_object;
         for (; print_object_instance_sequential_active != print_object_instances_ordering.end(); ++ print_object_instance_sequential_active) {
             const PrintObject &object = *(*print_object_instance_sequential_active)->print_object;
+            if (&object != prev_object)
+                // The boundaries of AvoidCrossingPerimeters are retained for the other instances of the same object only.
+                m_avoid_crossing_perimeters.layer_boundaries_cache().clear();
             if (&object != prev_object || tool_ordering.first_extruder() != final_extruder_id) {
                 tool_ordering = ToolOrdering(object, final_extruder_id);
                 unsigned int new_extruder_id = tool_ordering.first_extruder();
@@ -1332,11 +1371,35 @@ void GCodeGenerator::_do_export(Print& print, GCodeOutputStream &file, Thumbnail
             }
             print.throw_if_canceled();
         }
-        // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
-        // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
-        // and export G-code into file.
-        this->process_layers(print, tool_ordering, print_object_instances_ordering, layers_to_print, 
-            smooth_path_cache_global, file);
+        // The G-code of the layers generated by the previous export is reused if no input of the layer loop changed.
+        // The wipe tower keeps its own state, which is consumed at the end of the print, thus it is not cached.
+        GCode::LayerResultCache *layer_cache = nullptr;
+        size_t                   layer_cache_key = 0;
+        if (has_wipe_tower)
+            print.m_gcode_layer_cache.reset();
+        else {
+            if (! print.m_gcode_layer_cache)
+                print.m_gcode_layer_cache = std::make_shared<GCode::LayerResultCache>();
+            layer_cache     = print.m_gcode_layer_cache.get();
+            layer_cache_key = layer_results_cache_key(print);
+        }
+        if (layer_cache && layer_cache->valid && layer_cache->key == layer_cache_key) {
+            BOOST_LOG_TRIVIAL(debug) << "Exporting G-code of " << layer_cache->layer_results.size() << " layers cached by the previous export" << log_memory_info();
+            this->process_cached_layers(*layer_cache, file);
+            this->restore_layer_loop_state(*layer_cache);
+        } else {
+            if (layer_cache) {
+                layer_cache->clear();
+                layer_cache->key = layer_cache_key;
+            }
+            // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
+            // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
+            // and export G-code into file.
+            this->process_layers(print, tool_ordering, print_object_instances_ordering, layers_to_print, 
+                smooth_path_cache_global, layer_cache, file);
+            if (layer_cache && layer_cache->gcode_size <= GCode::LayerResultCache::max_gcode_size)
+                this->store_layer_loop_state(*layer_cache);
+        }
         if (m_wipe_tower)
             // Purge the extruder, pull out the active filament.
             file.write(m_wipe_tower->finalize(*this));
@@ -1437,14 +1500,62 @@ void GCodeGenerator::smooth_path_interpolate(
     const GCode::SmoothPathCache::InterpolationParameters   &params, 
     GCode::SmoothPathCache                                  &out)
 {
+    SLIC3R_PROFILE_ZONE();
+    // Collect all the paths of the layer first to fit them in parallel at once.
+    std::vector<const ExtrusionPath*> paths;
     if (const Layer *layer = object_layer_to_print.object_layer; layer) {
         for (const LayerRegion *layerm : layer->regions()) {
-            out.interpolate_add(layerm->perimeters(), params);
-            out.interpolate_add(layerm->fills(), params);
+            GCode::SmoothPathCache::collect_paths(layerm->perimeters(), paths);
+            GCode::SmoothPathCache::collect_paths(layerm->fills(), paths);
         }
     }
     if (const SupportLayer *layer = object_layer_to_print.support_layer; layer)
-        out.interpolate_add(layer->support_fills, params);
+        GCode::SmoothPathCache::collect_paths(layer->support_fills, paths);
+    out.interpolate_add(paths, params);
+}
+
+// Data of a layer prepared by the parallel stage of process_layers() ahead of the serial G-code generator.
+struct PreparedLayer {
+    size_t                                          layer_idx;
+    GCode::SmoothPathCache                          smooth_path_cache;
+    // Boundaries for AvoidCrossingPerimeters, not yet in its layer_boundaries_cache().
+    AvoidCrossingPerimeters::LayerBoundariesCache   layer_boundaries;
+};
+
+static void build_layer_boundaries(
+    const GCodeGenerator::ObjectLayerToPrint            &object_layer_to_print,
+    const AvoidCrossingPerimeters::LayerBoundariesCache &cached,
+    AvoidCrossingPerimeters::LayerBoundariesCache       &out)
+{
+    if (const Layer *layer = object_layer_to_print.layer(); layer && cached.find(layer) == cached.end())
+        out[layer] = AvoidCrossingPerimeters::build_layer_boundaries(*layer);
+}
+
+// Cooling buffer as a sequence of pipeline filters: The G-code of the layers is tokenized and the layers are slowed down
+// in parallel, only the G-code parser state machine and the fan state are passed from layer to layer serially.
+static tbb::filter<LayerResult, std::string> cooling_filters(CoolingBuffer &cooling_buffer)
+{
+    using CoolingLayerPtr = std::shared_ptr<CoolingLayer>;
+    const auto tokenize = tbb::make_filter<LayerResult, CoolingLayerPtr>(slic3r_tbb_filtermode::parallel,
+        [&cooling_buffer](LayerResult in) -> CoolingLayerPtr {
+            // A nop layer result passes the cooling buffer as an empty layer, which is not flushed.
+            return cooling_buffer.tokenize_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush && ! in.nop_layer_result);
+        });
+    const auto parse = tbb::make_filter<CoolingLayerPtr, CoolingLayerPtr>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer](CoolingLayerPtr layer) -> CoolingLayerPtr {
+            cooling_buffer.parse_layer(*layer);
+            return layer;
+        });
+    const auto cool_down = tbb::make_filter<CoolingLayerPtr, CoolingLayerPtr>(slic3r_tbb_filtermode::parallel,
+        [&cooling_buffer](CoolingLayerPtr layer) -> CoolingLayerPtr {
+            cooling_buffer.cool_down_layer(*layer);
+            return layer;
+        });
+    const auto finalize = tbb::make_filter<CoolingLayerPtr, std::string>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer](CoolingLayerPtr layer) -> std::string {
+            return cooling_buffer.finalize_layer(*layer);
+        });
+    return tokenize & parse & cool_down & finalize;
 }
 
 // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
@@ -1456,34 +1567,45 @@ void GCodeGenerator::process_layers(
     const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
     const std::vector<std::pair<coordf_t, ObjectsLayerToPrint>>         &layers_to_print,
     const GCode::SmoothPathCache                                        &smooth_path_cache_global,
+    GCode::LayerResultCache                                             *layer_cache,
     GCodeOutputStream                                                   &output_stream)
 {
     size_t layer_to_print_idx = 0;
     const GCode::SmoothPathCache::InterpolationParameters interpolation_params = interpolation_parameters(print.config());
-    const auto smooth_path_interpolator = tbb::make_filter<void, std::pair<size_t, GCode::SmoothPathCache>>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &layers_to_print, &layer_to_print_idx, &interpolation_params](tbb::flow_control &fc) -> std::pair<size_t, GCode::SmoothPathCache> {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    return { layer_to_print_idx ++, {} };
-                }
-            } else {
-                print.throw_if_canceled();
-                size_t idx = layer_to_print_idx ++;
-                GCode::SmoothPathCache smooth_path_cache;
-                for (const ObjectLayerToPrint &l : layers_to_print[idx].second)
-                    GCodeGenerator::smooth_path_interpolate(l, interpolation_params, smooth_path_cache);
-                return { idx, std::move(smooth_path_cache) };
+    // Only the layer index is produced serially, the layer index past the last layer is a NOP layer
+    // for the pressure equalizer.
+    const auto layer_index_source = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &layers_to_print, &layer_to_print_idx](tbb::flow_control &fc) -> size_t {
+            if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
+                fc.stop();
+                return 0;
+            }
+            return layer_to_print_idx ++;
+        });
+    // Fitting of arches / decimation of paths does not depend on the state of the G-code generator,
+    // thus it runs in parallel for multiple layers ahead of the serial G-code generator.
+    // The boundaries of AvoidCrossingPerimeters are independent of the G-code generator state as well.
+    // They are shared by all instances of an object printed at the same layer.
+    const bool avoid_crossing_perimeters = print.config().avoid_crossing_perimeters;
+    const auto smooth_path_interpolator = tbb::make_filter<size_t, PreparedLayer>(slic3r_tbb_filtermode::parallel,
+        [&print, &layers_to_print, &interpolation_params, avoid_crossing_perimeters](size_t idx) -> PreparedLayer {
+            if (idx >= layers_to_print.size())
+                // Pressure equalizer need insert empty input. Because it returns one layer back.
+                // Insert NOP (no operation) layer;
+                return { idx, {}, {} };
+            print.throw_if_canceled();
+            PreparedLayer out { idx, {}, {} };
+            for (const ObjectLayerToPrint &l : layers_to_print[idx].second) {
+                GCodeGenerator::smooth_path_interpolate(l, interpolation_params, out.smooth_path_cache);
+                if (avoid_crossing_perimeters)
+                    build_layer_boundaries(l, {}, out.layer_boundaries);
             }
+            return out;
         });
-    const auto generator = tbb::make_filter<std::pair<size_t, GCode::SmoothPathCache>, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+    const auto generator = tbb::make_filter<PreparedLayer, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &smooth_path_cache_global](
-            std::pair<size_t, GCode::SmoothPathCache> in) -> LayerResult {
-            size_t layer_to_print_idx = in.first;
+            PreparedLayer in) -> LayerResult {
+            size_t layer_to_print_idx = in.layer_idx;
             if (layer_to_print_idx == layers_to_print.size()) {
                 // Pressure equalizer need insert empty input. Because it returns one layer back.
                 // Insert NOP (no operation) layer;
@@ -1494,8 +1616,10 @@ void GCodeGenerator::process_layers(
                 if (m_wipe_tower && layer_tools.has_wipe_tower)
                     m_wipe_tower->next_layer();
                 print.throw_if_canceled();
+                // Only the layers of this print_z are needed from now on.
+                m_avoid_crossing_perimeters.layer_boundaries_cache() = std::move(in.layer_boundaries);
                 return this->process_layer(print, layer.second, layer_tools, 
-                    GCode::SmoothPathCaches{ smooth_path_cache_global, in.second }, 
+                    GCode::SmoothPathCaches{ smooth_path_cache_global, in.smooth_path_cache }, 
                     &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
             }
         });
@@ -1511,26 +1635,39 @@ void GCodeGenerator::process_layers(
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
             return pressure_equalizer->process_layer(std::move(in));
         });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [cooling_buffer = this->m_cooling_buffer.get()](LayerResult in) -> std::string {
-             if (in.nop_layer_result)
-                return in.gcode;
-
-             return cooling_buffer->process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+    // Retain the layers for the next G-code export, unless they grow too big.
+    const auto store_to_cache = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [layer_cache](LayerResult in) -> LayerResult {
+            if (layer_cache->gcode_size <= GCode::LayerResultCache::max_gcode_size) {
+                layer_cache->gcode_size += in.gcode.size();
+                if (layer_cache->gcode_size <= GCode::LayerResultCache::max_gcode_size)
+                    layer_cache->layer_results.emplace_back(in);
+                else
+                    layer_cache->layer_results = {};
+            }
+            return in;
         });
-    const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
+    const auto cooling = cooling_filters(*this->m_cooling_buffer);
+    const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::parallel,
         [find_replace = this->m_find_replace.get()](std::string s) -> std::string {
             return find_replace->process_layer(std::move(s));
         });
-    const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+    // Parsing of the G-code text by the G-code processor is split: The lines are tokenized in parallel,
+    // the output filter only runs the G-code processor state machine.
+    const auto tokenizer = tbb::make_filter<std::string, GCodeOutputStream::TokenizedGCode>(slic3r_tbb_filtermode::parallel,
+        [&output_stream](std::string s) { return output_stream.tokenize(std::move(s)); }
+    );
+    const auto output = tbb::make_filter<GCodeOutputStream::TokenizedGCode, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&output_stream](GCodeOutputStream::TokenizedGCode s) { output_stream.write(std::move(s)); }
     );
 
-    tbb::filter<void, LayerResult> pipeline_to_layerresult = smooth_path_interpolator & generator;
+    tbb::filter<void, LayerResult> pipeline_to_layerresult = layer_index_source & smooth_path_interpolator & generator;
     if (m_spiral_vase)
         pipeline_to_layerresult = pipeline_to_layerresult & spiral_vase;
     if (m_pressure_equalizer)
         pipeline_to_layerresult = pipeline_to_layerresult & pressure_equalizer;
+    if (layer_cache)
+        pipeline_to_layerresult = pipeline_to_layerresult & store_to_cache;
 
     tbb::filter<LayerResult, std::string> pipeline_to_string = cooling;
     if (m_find_replace)
@@ -1541,10 +1678,134 @@ void GCodeGenerator::process_layers(
     TBBLocalesSetter locales_setter;
     // The pipeline elements are joined using const references, thus no copying is performed.
     output_stream.find_replace_supress();
-    tbb::parallel_pipeline(12, pipeline_to_layerresult & pipeline_to_string & output);
+    tbb::parallel_pipeline(process_layers_max_tokens(), pipeline_to_layerresult & pipeline_to_string & tokenizer & output);
+    output_stream.find_replace_enable();
+}
+
+void GCodeGenerator::process_cached_layers(const GCode::LayerResultCache &layer_cache, GCodeOutputStream &output_stream)
+{
+    size_t layer_result_idx = 0;
+    const auto cached_layers = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [&layer_cache, &layer_result_idx](tbb::flow_control &fc) -> LayerResult {
+            if (layer_result_idx == layer_cache.layer_results.size()) {
+                fc.stop();
+                return {};
+            }
+            return layer_cache.layer_results[layer_result_idx ++];
+        });
+    const auto cooling = cooling_filters(*this->m_cooling_buffer);
+    const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::parallel,
+        [find_replace = this->m_find_replace.get()](std::string s) -> std::string {
+            return find_replace->process_layer(std::move(s));
+        });
+    const auto tokenizer = tbb::make_filter<std::string, GCodeOutputStream::TokenizedGCode>(slic3r_tbb_filtermode::parallel,
+        [&output_stream](std::string s) { return output_stream.tokenize(std::move(s)); }
+    );
+    const auto output = tbb::make_filter<GCodeOutputStream::TokenizedGCode, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&output_stream](GCodeOutputStream::TokenizedGCode s) { output_stream.write(std::move(s)); }
+    );
+
+    tbb::filter<LayerResult, std::string> pipeline_to_string = cooling;
+    if (m_find_replace)
+        pipeline_to_string = pipeline_to_string & find_replace;
+
+    TBBLocalesSetter locales_setter;
+    output_stream.find_replace_supress();
+    tbb::parallel_pipeline(process_layers_max_tokens(), cached_layers & pipeline_to_string & tokenizer & output);
     output_stream.find_replace_enable();
 }
 
+size_t GCodeGenerator::layer_results_cache_key(const Print &print)
+{
+    // Configuration values, which are consumed after the G-code generator layer loop only:
+    // by the CoolingBuffer, by the G-code find / replace post-processor, by the end G-code
+    // or by the output file writer and post-processing scripts.
+    static const std::set<std::string> keys_after_layer_loop {
+        "bridge_fan_speed", "cooling", "disable_fan_first_layers", "end_filament_gcode", "end_gcode",
+        "fan_always_on", "fan_below_layer_time", "full_fan_speed_layer", "gcode_binary", "gcode_substitutions",
+        "max_fan_speed", "min_fan_speed", "min_print_speed", "output_filename_format", "post_process",
+        "slowdown_below_layer_time", "thumbnails", "thumbnails_format"
+    };
+    auto hash_config = [](size_t &seed, const ConfigBase &config) {
+        for (const std::string &key : config.keys())
+            if (keys_after_layer_loop.find(key) == keys_after_layer_loop.end()) {
+                boost::hash_combine(seed, key);
+                boost::hash_combine(seed, config.option(key)->hash());
+            }
+    };
+
+    size_t seed = 0;
+    hash_config(seed, print.full_print_config());
+    for (const PrintRegion *region : print.m_print_regions)
+        boost::hash_combine(seed, region->config_hash());
+    for (PrintStep step : { psWipeTower, psSkirtBrim })
+        boost::hash_combine(seed, print.step_state_with_timestamp(step).timestamp);
+    for (const PrintObject *object : print.objects()) {
+        boost::hash_combine(seed, object->model_object()->id().id);
+        boost::hash_combine(seed, object->config().hash());
+        // Any change of the slicing results is reflected by a new time stamp of the respective step.
+        for (int step = 0; step < int(posCount); ++ step)
+            boost::hash_combine(seed, object->step_state_with_timestamp(PrintObjectStep(step)).timestamp);
+        for (const PrintInstance &instance : object->instances()) {
+            boost::hash_combine(seed, instance.shift.x());
+            boost::hash_combine(seed, instance.shift.y());
+        }
+    }
+    for (const CustomGCode::Item &item : print.model().custom_gcode_per_print_z.gcodes) {
+        boost::hash_combine(seed, item.print_z);
+        boost::hash_combine(seed, int(item.type));
+        boost::hash_combine(seed, item.extruder);
+        boost::hash_combine(seed, item.color);
+        boost::hash_combine(seed, item.extra);
+    }
+    boost::hash_combine(seed, int(print.model().custom_gcode_per_print_z.mode));
+    return seed;
+}
+
+void GCodeGenerator::store_layer_loop_state(GCode::LayerResultCache &layer_cache) const
+{
+    layer_cache.writer                        = m_writer;
+    layer_cache.config                        = m_config;
+    layer_cache.wipe                          = m_wipe;
+    layer_cache.origin                        = m_origin;
+    layer_cache.last_pos                      = m_last_pos;
+    layer_cache.last_pos_defined              = m_last_pos_defined;
+    layer_cache.layer_index                   = m_layer_index;
+    layer_cache.last_height                   = m_last_height;
+    layer_cache.last_layer_z                  = m_last_layer_z;
+    layer_cache.max_layer_z                   = m_max_layer_z;
+    layer_cache.last_width                    = m_last_width;
+    layer_cache.last_extrusion_role           = m_last_extrusion_role;
+    layer_cache.last_processor_extrusion_role = m_last_processor_extrusion_role;
+    layer_cache.placeholder_parser_config     = m_placeholder_parser_integration.parser.config();
+    layer_cache.placeholder_parser_global_config.clear();
+    if (m_placeholder_parser_integration.context.global_config)
+        layer_cache.placeholder_parser_global_config = *m_placeholder_parser_integration.context.global_config;
+    layer_cache.valid                         = true;
+}
+
+void GCodeGenerator::restore_layer_loop_state(const GCode::LayerResultCache &layer_cache)
+{
+    assert(layer_cache.valid);
+    m_writer                        = layer_cache.writer;
+    m_config                        = layer_cache.config;
+    m_wipe                          = layer_cache.wipe;
+    m_origin                        = layer_cache.origin;
+    m_last_pos                      = layer_cache.last_pos;
+    m_last_pos_defined              = layer_cache.last_pos_defined;
+    m_layer_index                   = layer_cache.layer_index;
+    m_last_height                   = layer_cache.last_height;
+    m_last_layer_z                  = layer_cache.last_layer_z;
+    m_max_layer_z                   = layer_cache.max_layer_z;
+    m_last_width                    = layer_cache.last_width;
+    m_last_extrusion_role           = layer_cache.last_extrusion_role;
+    m_last_processor_extrusion_role = layer_cache.last_processor_extrusion_role;
+    // Overwrite the values, don't replace the options: The placeholder parser integration keeps pointers to some of them.
+    m_placeholder_parser_integration.parser.config_writable().apply(layer_cache.placeholder_parser_config);
+    if (m_placeholder_parser_integration.context.global_config)
+        *m_placeholder_parser_integration.context.global_config = layer_cache.placeholder_parser_global_config;
+}
+
 // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
 // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
 // and export G-code into file.
@@ -1558,28 +1819,36 @@ void GCodeGenerator::process_layers(
 {
     size_t layer_to_print_idx = 0;
     const GCode::SmoothPathCache::InterpolationParameters interpolation_params = interpolation_parameters(print.config());
-    const auto smooth_path_interpolator = tbb::make_filter<void, std::pair<size_t, GCode::SmoothPathCache>> (slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &layers_to_print, &layer_to_print_idx, interpolation_params](tbb::flow_control &fc) -> std::pair<size_t, GCode::SmoothPathCache> {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    return { layer_to_print_idx ++, {} };
-                }
-            } else {
-                print.throw_if_canceled();
-                size_t idx = layer_to_print_idx ++;
-                GCode::SmoothPathCache smooth_path_cache;
-                GCodeGenerator::smooth_path_interpolate(layers_to_print[idx], interpolation_params, smooth_path_cache);
-                return { idx, std::move(smooth_path_cache) };
+    const auto layer_index_source = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &layers_to_print, &layer_to_print_idx](tbb::flow_control &fc) -> size_t {
+            if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
+                fc.stop();
+                return 0;
             }
+            return layer_to_print_idx ++;
         });
-    const auto generator = tbb::make_filter<std::pair<size_t, GCode::SmoothPathCache>, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &smooth_path_cache_global, single_object_idx](std::pair<size_t, GCode::SmoothPathCache> in) -> LayerResult {
-            size_t layer_to_print_idx = in.first;
+    // The generator below moves the layer out of layers_to_print only after its smooth paths were interpolated,
+    // and the parallel interpolator only touches layers not yet consumed by the generator.
+    // The boundaries of AvoidCrossingPerimeters built for the previous instances of this object are reused,
+    // the parallel stage only reads a copy of the cache, which is being extended by the generator.
+    const bool avoid_crossing_perimeters = print.config().avoid_crossing_perimeters;
+    const AvoidCrossingPerimeters::LayerBoundariesCache layer_boundaries_cached = m_avoid_crossing_perimeters.layer_boundaries_cache();
+    const auto smooth_path_interpolator = tbb::make_filter<size_t, PreparedLayer>(slic3r_tbb_filtermode::parallel,
+        [&print, &layers_to_print, &interpolation_params, avoid_crossing_perimeters, &layer_boundaries_cached](size_t idx) -> PreparedLayer {
+            if (idx >= layers_to_print.size())
+                // Pressure equalizer need insert empty input. Because it returns one layer back.
+                // Insert NOP (no operation) layer;
+                return { idx, {}, {} };
+            print.throw_if_canceled();
+            PreparedLayer out { idx, {}, {} };
+            GCodeGenerator::smooth_path_interpolate(layers_to_print[idx], interpolation_params, out.smooth_path_cache);
+            if (avoid_crossing_perimeters)
+                build_layer_boundaries(layers_to_print[idx], layer_boundaries_cached, out.layer_boundaries);
+            return out;
+        });
+    const auto generator = tbb::make_filter<PreparedLayer, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &tool_ordering, &layers_to_print, &smooth_path_cache_global, single_object_idx](PreparedLayer in) -> LayerResult {
+            size_t layer_to_print_idx = in.layer_idx;
             if (layer_to_print_idx == layers_to_print.size()) {
                 // Pressure equalizer need insert empty input. Because it returns one layer back.
                 // Insert NOP (no operation) layer;
@@ -1587,8 +1856,9 @@ void GCodeGenerator::process_layers(
             } else {
                 ObjectLayerToPrint &layer = layers_to_print[layer_to_print_idx];
                 print.throw_if_canceled();
+                m_avoid_crossing_perimeters.layer_boundaries_cache().merge(in.layer_boundaries);
                 return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), 
-                    GCode::SmoothPathCaches{ smooth_path_cache_global, in.second }, 
+                    GCode::SmoothPathCaches{ smooth_path_cache_global, in.smooth_path_cache }, 
                     &layer == &layers_to_print.back(), nullptr, single_object_idx);
             }
         });
@@ -1604,21 +1874,19 @@ void GCodeGenerator::process_layers(
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
              return pressure_equalizer->process_layer(std::move(in));
         });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [cooling_buffer = this->m_cooling_buffer.get()](LayerResult in)->std::string {
-            if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer->process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
-        });
-    const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
+    const auto cooling = cooling_filters(*this->m_cooling_buffer);
+    const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::parallel,
         [find_replace = this->m_find_replace.get()](std::string s) -> std::string {
             return find_replace->process_layer(std::move(s));
         });
-    const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+    const auto tokenizer = tbb::make_filter<std::string, GCodeOutputStream::TokenizedGCode>(slic3r_tbb_filtermode::parallel,
+        [&output_stream](std::string s) { return output_stream.tokenize(std::move(s)); }
+    );
+    const auto output = tbb::make_filter<GCodeOutputStream::TokenizedGCode, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&output_stream](GCodeOutputStream::TokenizedGCode s) { output_stream.write(std::move(s)); }
     );
 
-    tbb::filter<void, LayerResult> pipeline_to_layerresult = smooth_path_interpolator & generator;
+    tbb::filter<void, LayerResult> pipeline_to_layerresult = layer_index_source & smooth_path_interpolator & generator;
     if (m_spiral_vase)
         pipeline_to_layerresult = pipeline_to_layerresult & spiral_vase;
     if (m_pressure_equalizer)
@@ -1633,7 +1901,7 @@ void GCodeGenerator::process_layers(
     TBBLocalesSetter locales_setter;
     // The pipeline elements are joined using const references, thus no copying is performed.
     output_stream.find_replace_supress();
-    tbb::parallel_pipeline(12, pipeline_to_layerresult & pipeline_to_string & output);
+    tbb::parallel_pipeline(process_layers_max_tokens(), pipeline_to_layerresult & pipeline_to_string & tokenizer & output);
     output_stream.find_replace_enable();
 }
 
@@ -2105,6 +2373,7 @@ LayerResult GCodeGenerator::process_layer(
     // Otherwise print a single copy of a single object.
     const size_t                     		 single_object_instance_idx)
 {
+    SLIC3R_PROFILE_ZONE();
     assert(! layers.empty());
     // Either printing all copies of all objects, or just a single copy of a single object.
     assert(single_object_instance_idx == size_t(-1) || layers.size() == 1);
@@ -2841,6 +3110,31 @@ void GCodeGenerator::GCodeOutputStream::write(const char *what)
     }
 }
 
+GCodeGenerator::GCodeOutputStream::TokenizedGCode GCodeGenerator::GCodeOutputStream::tokenize(std::string &&gcode) const
+{
+    SLIC3R_PROFILE_ZONE();
+    TokenizedGCode out;
+    out.gcode = std::make_shared<const std::string>(std::move(gcode));
+    m_processor.tokenize_buffer(*out.gcode, out.lines);
+    return out;
+}
+
+void GCodeGenerator::GCodeOutputStream::write(TokenizedGCode &&what)
+{
+    SLIC3R_PROFILE_ZONE();
+    assert(m_find_replace == nullptr);
+    fwrite(what.gcode->c_str(), 1, what.gcode->size(), this->f);
+    m_processor.process_tokenized_buffer(what.lines);
+    if (m_preview_cb) {
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_preview_last >= preview_interval) {
+            m_preview_cb(m_processor.partial_result());
+            // Don't count the time spent by copying the moves.
+            m_preview_last = std::chrono::steady_clock::now();
+        }
+    }
+}
+
 void GCodeGenerator::GCodeOutputStream::writeln(const std::string &what)
 {
     if (! what.empty())
@@ -3058,7 +3352,7 @@ std::string GCodeGenerator::_extrude(
     }
 
     // F is mm per minute.
-    gcode += m_writer.set_speed(F, "", cooling_marker_setspeed_comments);
+    m_writer.set_speed(gcode, F, "", cooling_marker_setspeed_comments);
     if (dynamic_speed_and_fan_speed.second >= 0)
         gcode += ";_SET_FAN_SPEED" + std::to_string(int(dynamic_speed_and_fan_speed.second)) + "\n";
     double path_length = 0.;
@@ -3097,7 +3391,7 @@ std::string GCodeGenerator::_extrude(
                 // Extrude line segment.
                 if (const double line_length = (p - prev).norm(); line_length > 0) {
                     path_length += line_length;
-                    gcode += m_writer.extrude_to_xy(p, e_per_mm * line_length, comment);
+                    m_writer.extrude_to_xy(gcode, p, e_per_mm * line_length, comment);
                 }
             } else {
                 double angle = Geometry::ArcWelder::arc_angle(prev.cast<double>(), p.cast<double>(), double(radius));
@@ -3106,7 +3400,7 @@ std::string GCodeGenerator::_extrude(
                 path_length += line_length;
                 const double dE = e_per_mm * line_length;
                 assert(dE > 0);
-                gcode += m_writer.extrude_to_xy_G2G3IJ(p, ij, it->ccw(), dE, comment);
+                m_writer.extrude_to_xy_G2G3IJ(gcode, p, ij, it->ccw(), dE, comment);
             }
             prev = p;
             prev_exact = p_exact;
@@ -3195,7 +3489,7 @@ std::string GCodeGenerator::travel_to(const Point &point, ExtrusionRole role, st
         gcode += m_writer.set_travel_acceleration((unsigned int)(m_config.travel_acceleration.value + 0.5));
 
         for (size_t i = 1; i < travel.size(); ++ i)
-            gcode += m_writer.travel_to_xy(this->point_to_gcode(travel.points[i]), comment);
+            m_writer.travel_to_xy(gcode, this->point_to_gcode(travel.points[i]), comment);
 
         if (! GCodeWriter::supports_separate_travel_acceleration(config().gcode_flavor)) {
             // In case that this flavor does not support separate print and travel acceleration,
@@ -41,6 +41,7 @@
 #include "EdgeGrid.hpp"
 #include "GCode/ThumbnailData.hpp"
 
+#include <chrono>
 #include <memory>
 #include <map>
 #include <string>
@@ -88,6 +89,49 @@ struct LayerResult {
     static LayerResult make_nop_layer_result() { return {"", std::numeric_limits<coord_t>::max(), false, false, true}; }
 };
 
+namespace GCode {
+
+// G-code of all layers of the last G-code export as it was passed to the CoolingBuffer, retained by Print
+// to be reused by the next G-code export if neither the slicing results nor any configuration value
+// consumed by the G-code generator layer loop changed, for example if only the end G-code,
+// the cooling & fan settings or the G-code substitutions were modified.
+// Together with the layers, the state of the G-code generator at the end of the layer loop is stored,
+// which is consumed by the end G-code and the print statistics.
+struct LayerResultCache
+{
+    // Hash of the inputs of the G-code generator layer loop.
+    size_t                   key { 0 };
+    // Were all layers of the last export stored and is the generator state valid?
+    bool                     valid { false };
+    std::vector<LayerResult> layer_results;
+    // Sum of layer_results[i].gcode sizes.
+    size_t                   gcode_size { 0 };
+    // Don't retain the layers if their G-code is bigger than this.
+    static constexpr const size_t max_gcode_size = 256 * 1024 * 1024;
+
+    // State of the G-code generator at the end of the layer loop.
+    GCodeWriter              writer;
+    FullPrintConfig          config;
+    Wipe                     wipe;
+    Vec2d                    origin { Vec2d::Zero() };
+    Point                    last_pos { Point::Zero() };
+    bool                     last_pos_defined { false };
+    int                      layer_index { -1 };
+    float                    last_height { 0.f };
+    float                    last_layer_z { 0.f };
+    float                    max_layer_z { 0.f };
+    float                    last_width { 0.f };
+    GCodeExtrusionRole       last_extrusion_role { GCodeExtrusionRole::None };
+    GCodeExtrusionRole       last_processor_extrusion_role { GCodeExtrusionRole::None };
+    // Placeholder parser variables as modified by the custom G-codes of the layer loop.
+    DynamicConfig            placeholder_parser_config;
+    DynamicConfig            placeholder_parser_global_config;
+
+    void clear() { *this = LayerResultCache(); }
+};
+
+} // namespace GCode
+
 class GCodeGenerator {
 
 public:        
@@ -117,7 +161,9 @@ public:
 
     // throws std::runtime_exception on error,
     // throws CanceledException through print->throw_if_canceled().
-    void            do_export(Print* print, const char* path, GCodeProcessorResult* result = nullptr, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
+    // If preview_cb is set, it receives snapshots of the G-code processed so far while the layers are being exported.
+    void            do_export(Print* print, const char* path, GCodeProcessorResult* result = nullptr, ThumbnailsGeneratorCallback thumbnail_cb = nullptr,
+                              GCodeProcessorResultCallback preview_cb = nullptr);
 
     // Exported for the helper classes (OozePrevention, Wipe) and for the Perl binding for unit tests.
     const Vec2d&    origin() const { return m_origin; }
@@ -186,6 +232,14 @@ private:
         void find_replace_enable() { m_find_replace = m_find_replace_backup; }
         void find_replace_supress() { m_find_replace = nullptr; }
 
+        // Pass snapshots of the G-code processed so far to preview_cb after a layer is written,
+        // at most once per preview_interval, as copying the moves and loading them into the G-code viewer is not cheap.
+        void set_preview_callback(GCodeProcessorResultCallback preview_cb) {
+            m_preview_cb = std::move(preview_cb);
+            m_preview_last = std::chrono::steady_clock::now();
+        }
+        static constexpr std::chrono::milliseconds preview_interval { 1000 };
+
         bool is_open() const { return f; }
         bool is_error() const;
         
@@ -196,6 +250,19 @@ private:
         void write(const std::string& what) { this->write(what.c_str()); }
         void write(const char* what);
 
+        // G-code together with its lines tokenized for the G-code processor.
+        struct TokenizedGCode {
+            // The lines reference the G-code text, which is held by a pointer to keep it at the same address
+            // when TokenizedGCode is moved around.
+            std::shared_ptr<const std::string>   gcode;
+            std::vector<GCodeReader::GCodeLine>  lines;
+        };
+        // Tokenize G-code for write(TokenizedGCode&&). Thread safe, to be called by a parallel filter of process_layers().
+        TokenizedGCode tokenize(std::string &&gcode) const;
+        // Write G-code tokenized by tokenize() into a file, the G-code processor skips parsing the text.
+        // The find-replace post-processor is not applied, it is expected to be suppressed.
+        void write(TokenizedGCode &&what);
+
         // Write a string into a file. 
         // Add a newline, if the string does not end with a newline already.
         // Used to export a custom G-code section processed by the PlaceholderParser.
@@ -211,6 +278,8 @@ private:
         // If suppressed, the backoup holds m_find_replace.
         GCodeFindReplace *m_find_replace_backup { nullptr };
         GCodeProcessor   &m_processor;
+        GCodeProcessorResultCallback           m_preview_cb;
+        std::chrono::steady_clock::time_point  m_preview_last;
     };
     void            _do_export(Print &print, GCodeOutputStream &file, ThumbnailsGeneratorCallback thumbnail_cb);
 
@@ -232,13 +301,23 @@ private:
     // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
     // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
     // and export G-code into file.
+    // If layer_cache is set, the layers passed to the CoolingBuffer are retained there.
     void process_layers(
         const Print                                                   &print,
         const ToolOrdering                                            &tool_ordering,
         const std::vector<const PrintInstance*>                       &print_object_instances_ordering,
         const std::vector<std::pair<coordf_t, ObjectsLayerToPrint>>   &layers_to_print,
         const GCode::SmoothPathCache                                  &smooth_path_cache_global,
+        GCode::LayerResultCache                                       *layer_cache,
         GCodeOutputStream                                             &output_stream);
+    // Instead of process_layers(), run the layers retained by the previous G-code export
+    // through the cooling buffer and the find / replace filter and export them into file.
+    void process_cached_layers(const GCode::LayerResultCache &layer_cache, GCodeOutputStream &output_stream);
+    // Hash of all inputs of the non-sequential G-code generator layer loop, see GCode::LayerResultCache.
+    static size_t layer_results_cache_key(const Print &print);
+    // Store / restore the G-code generator state at the end of the layer loop.
+    void store_layer_loop_state(GCode::LayerResultCache &layer_cache) const;
+    void restore_layer_loop_state(const GCode::LayerResultCache &layer_cache);
     // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
     // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
     // and export G-code into file.
@@ -1187,21 +1187,29 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCodeGenerator &gcodegen, cons
     Vec2d endf   = end  .cast<double>();
 
     bool is_support_layer = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel)))) {
-        // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty())
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer())));
-
+    if (! m_layer_boundaries)
+        this->init_layer(*gcodegen.layer());
+    const LayerBoundaries &layer_boundaries = *m_layer_boundaries;
+    const Boundary        &internal         = layer_boundaries.internal;
+    if (!use_external && (is_support_layer || (!layer_boundaries.lslices_offset.empty() &&
+        !any_expolygon_contains(layer_boundaries.lslices_offset, layer_boundaries.lslices_offset_bboxes, layer_boundaries.grid_lslices_offset, travel)))) {
+        // Route the travel only if no other instance of this object did the same travel at this layer.
+        auto [it_routed, inserted] = layer_boundaries.routed_travels.try_emplace({ start, end });
+        LayerBoundaries::RoutedTravel &routed = it_routed->second;
         // Trim the travel line by the bounding box.
-        if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
-            result_pl.points.front()  = start;
-            result_pl.points.back()   = end;
+        if (inserted && !internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, internal.bbox)) {
+            routed.intersection_count = avoid_perimeters(internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), routed.path);
+            routed.path.points.front() = start;
+            routed.path.points.back()  = end;
         }
+        result_pl                 = routed.path;
+        travel_intersection_count = routed.intersection_count;
     } else if(use_external) {
         // Initialize m_external only when exist any external travel for the current layer.
-        if (m_external.boundaries.empty())
+        if (m_external_layer != gcodegen.layer()) {
             init_boundary(&m_external, get_boundary_external(*gcodegen.layer()));
+            m_external_layer = gcodegen.layer();
+        }
 
         // Trim the travel line by the bounding box.
         if (!m_external.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_external.bbox)) {
@@ -1237,32 +1245,40 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCodeGenerator &gcodegen, cons
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, layer_boundaries.lslices_offset, layer_boundaries.lslices_offset_bboxes, layer_boundaries.grid_lslices_offset, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+AvoidCrossingPerimeters::LayerBoundariesPtr AvoidCrossingPerimeters::build_layer_boundaries(const Layer &layer)
 {
-    m_internal.clear();
-    m_external.clear();
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
+    auto out = std::make_shared<LayerBoundaries>();
 
     float perimeter_offset = -get_external_perimeter_width(layer) / float(2.);
-    m_lslices_offset        = offset_ex(layer.lslices, perimeter_offset);
+    out->lslices_offset    = offset_ex(layer.lslices, perimeter_offset);
 
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const ExPolygon &ex_poly : m_lslices_offset)
-        m_lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
+    out->lslices_offset_bboxes.reserve(out->lslices_offset.size());
+    for (const ExPolygon &ex_poly : out->lslices_offset)
+        out->lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
 
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslices_offset.set_bbox(bbox_slice);
-    m_grid_lslices_offset.create(m_lslices_offset, coord_t(scale_(1.)));
+    out->grid_lslices_offset.set_bbox(bbox_slice);
+    out->grid_lslices_offset.create(out->lslices_offset, coord_t(scale_(1.)));
+
+    init_boundary(&out->internal, to_polygons(get_boundary(layer)));
+    return out;
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+{
+    if (auto it = m_layer_boundaries_cache.find(&layer); it != m_layer_boundaries_cache.end())
+        m_layer_boundaries = it->second;
+    else
+        m_layer_boundaries = m_layer_boundaries_cache[&layer] = build_layer_boundaries(layer);
 }
 
 #if 0
@@ -8,6 +8,11 @@
 #include "../libslic3r.h"
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
+#include "../Polyline.hpp"
+
+#include <map>
+#include <memory>
+#include <unordered_map>
 
 namespace Slic3r {
 
@@ -27,6 +32,7 @@ public:
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
+    // Use the boundaries of the layer from layer_boundaries_cache() if available, otherwise build and cache them.
     void        init_layer(const Layer &layer);
 
     Polyline    travel_to(const GCodeGenerator &gcodegen, const Point& point)
@@ -54,6 +60,39 @@ public:
         }
     };
 
+    // Boundaries of a single object or support layer. They depend on the layer only, not on the instance being printed
+    // nor on the G-code generator state, thus they are built ahead of the G-code generator in parallel
+    // and shared by all instances of the object printed at the layer.
+    struct LayerBoundaries {
+        // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid           grid_lslices_offset;
+        // Store all needed data for travels inside object
+        Boundary                 internal;
+
+        struct RoutedTravel {
+            Polyline             path;
+            size_t               intersection_count { 0 };
+        };
+        struct TravelHash {
+            size_t operator()(const std::pair<Point, Point> &travel) const noexcept
+                { return PointHash{}(travel.first) * 31 + PointHash{}(travel.second); }
+        };
+        // Travels inside the object routed around the perimeters, in the object coordinate system. All instances
+        // of the object printed at this layer mostly repeat the same travels, only the first instance routes them.
+        // Filled in by the serial G-code generator, not thread safe.
+        mutable std::unordered_map<std::pair<Point, Point>, RoutedTravel, TravelHash> routed_travels;
+    };
+    using LayerBoundariesPtr   = std::shared_ptr<const LayerBoundaries>;
+    using LayerBoundariesCache = std::map<const Layer*, LayerBoundariesPtr>;
+
+    // Thread safe.
+    static LayerBoundariesPtr   build_layer_boundaries(const Layer &layer);
+    // Boundaries of the layers printed recently or about to be printed, filled in by the G-code generator.
+    LayerBoundariesCache&       layer_boundaries_cache() { return m_layer_boundaries_cache; }
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -62,15 +101,13 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid           m_grid_lslices_offset;
-    // Store all needed data for travels inside object
-    Boundary m_internal;
+    // Boundaries of the current layer.
+    LayerBoundariesPtr       m_layer_boundaries;
+    LayerBoundariesCache     m_layer_boundaries_cache;
     // Store all needed data for travels outside object
-    Boundary m_external;
+    Boundary                 m_external;
+    // Layer m_external was built for.
+    const Layer             *m_external_layer { nullptr };
 };
 
 } // namespace Slic3r
@@ -6,12 +6,14 @@
 #include "ConflictChecker.hpp"
 
 #include <tbb/parallel_for.h>
-#include <tbb/concurrent_vector.h>
 
 #include <map>
+#include <unordered_map>
 #include <functional>
 #include <atomic>
 
+#include <boost/functional/hash.hpp>
+
 namespace Slic3r {
 
 namespace RasterizationImpl {
@@ -275,18 +277,38 @@ std::pair<std::vector<ExtrusionPaths>, std::vector<ExtrusionPaths>> getAllLayers
 ConflictComputeOpt ConflictChecker::find_inter_of_lines(const LineWithIDs &lines)
 {
     using namespace RasterizationImpl;
-    std::map<IndexPair, std::vector<int>> indexToLine;
+
+    // Lines of a single instance never conflict.
+    if (std::all_of(lines.begin(), lines.end(), [&lines](const LineWithID &l) { return l._obj_id == lines.front()._obj_id && l._inst_id == lines.front()._inst_id; }))
+        return {};
+
+    struct GridCell {
+        std::vector<int> lines;
+        // Object and instance of the lines in this cell, valid if not mixed.
+        int              obj_id  = -1;
+        int              inst_id = -1;
+        bool             mixed   = false;
+    };
+    std::unordered_map<IndexPair, GridCell, boost::hash<IndexPair>> indexToLine;
 
     for (int i = 0; i < (int)lines.size(); ++i) {
         const LineWithID &l1      = lines[i];
         auto              indexes = line_rasterization(l1._line);
         for (auto index : indexes) {
-            const auto &possibleIntersectIdxs = indexToLine[index];
-            for (auto possibleIntersectIdx : possibleIntersectIdxs) {
-                const LineWithID &l2 = lines[possibleIntersectIdx];
-                if (auto interRes = line_intersect(l1, l2); interRes.has_value()) { return interRes; }
+            GridCell &cell = indexToLine[index];
+            if (cell.lines.empty()) {
+                cell.obj_id  = l1._obj_id;
+                cell.inst_id = l1._inst_id;
+            } else if (cell.mixed || cell.obj_id != l1._obj_id || cell.inst_id != l1._inst_id) {
+                // Only cells shared by multiple instances may contain a conflict. Most cells are covered
+                // by a single instance, whose lines are not tested against each other.
+                cell.mixed = true;
+                for (auto possibleIntersectIdx : cell.lines) {
+                    const LineWithID &l2 = lines[possibleIntersectIdx];
+                    if (auto interRes = line_intersect(l1, l2); interRes.has_value()) { return interRes; }
+                }
             }
-            indexToLine[index].push_back(i);
+            cell.lines.push_back(i);
         }
     }
     return {};
@@ -329,28 +351,23 @@ ConflictResultOpt ConflictChecker::find_inter_of_lines_in_diff_objs(SpanOfConstP
         layersLines.push_back(std::move(lines));
     }
 
-    bool                                   find = false;
-    tbb::concurrent_vector<std::pair<ConflictComputeResult,double>> conflict;
+    // Only the lowest conflict is reported. Once a conflict is found, the layers above it are not checked.
+    std::atomic<size_t>             first_conflict_layer { layersLines.size() };
+    std::vector<ConflictComputeOpt> conflicts(layersLines.size());
 
     tbb::parallel_for(tbb::blocked_range<size_t>(0, layersLines.size()), [&](tbb::blocked_range<size_t> range) {
-        for (size_t i = range.begin(); i < range.end(); i++) {
-            auto interRes = find_inter_of_lines(layersLines[i]);
-            if (interRes.has_value()) {
-                find = true;
-                conflict.emplace_back(*interRes, heights[i]);
+        for (size_t i = range.begin(); i < range.end() && i < first_conflict_layer.load(std::memory_order_relaxed); i++) {
+            if (conflicts[i] = find_inter_of_lines(layersLines[i]); conflicts[i].has_value()) {
+                for (size_t first = first_conflict_layer.load(); i < first && ! first_conflict_layer.compare_exchange_weak(first, i); ) ;
                 break;
             }
         }
     });
 
-    if (find) {
-        std::sort(conflict.begin(), conflict.end(), [](const std::pair<ConflictComputeResult, double>& i1, const std::pair<ConflictComputeResult, double>& i2) {
-            return i1.second < i2.second;
-        });
-
-        const void *ptr1           = conflictQueue.idToObjsPtr(conflict[0].first._obj1);
-        const void *ptr2           = conflictQueue.idToObjsPtr(conflict[0].first._obj2);
-        double      conflictHeight = conflict[0].second;
+    if (size_t first = first_conflict_layer.load(); first < layersLines.size()) {
+        const void *ptr1           = conflictQueue.idToObjsPtr(conflicts[first]->_obj1);
+        const void *ptr2           = conflictQueue.idToObjsPtr(conflicts[first]->_obj2);
+        double      conflictHeight = heights[first];
         if (ptr1 == &wtptr || ptr2 == &wtptr) {
             assert(! wipe_tower_data.z_and_depth_pairs.empty());
             if (ptr2 == &wtptr) { std::swap(ptr1, ptr2); }
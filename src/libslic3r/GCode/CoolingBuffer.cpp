@@ -10,6 +10,7 @@
 ///|/
 #include "../GCode.hpp"
 #include "CoolingBuffer.hpp"
+#include "../ProfilerTracy.hpp"
 #include <algorithm>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/replace.hpp>
@@ -321,52 +322,128 @@ finished:
 	return new_feedrate;
 }
 
+// A G-code line of interest for the cooling buffer, as tokenized from the G-code text.
+struct CoolingToken
+{
+    // CoolingLine::Type flags, which are known from the text of the line.
+    uint32_t type;
+    // Start and end of this line at the G-code snippet.
+    size_t   line_start;
+    size_t   line_end;
+    // Bit mask of the axes with their values provided by a G0, G1, G2, G3 or G92 line.
+    uint32_t axes;
+    // Values of the provided axes, feedrate converted to mm/sec.
+    std::array<float, 9> pos;
+    // Tool of a tool change line or fan speed of the ";_SET_FAN_SPEED" line.
+    unsigned int value;
+    // Duration of the G4 line.
+    float    time;
+};
+
+// A layer of G-code passed through the stages of the cooling buffer.
+struct CoolingLayer
+{
+    std::string                         gcode;
+    size_t                              layer_id;
+    // Is the layer cooled down or is it collected for the next layer?
+    bool                                flush;
+    std::vector<CoolingToken>           tokens;
+    // Extruder at the start of the layer.
+    unsigned int                        extruder;
+    std::vector<PerExtruderAdjustments> per_extruder_adjustments;
+    // Fan speed set at the start of the layer, the length of its G-code at the start of the layer
+    // and the fan speed at the end of the layer.
+    int                                 fan_speed_start;
+    size_t                              fan_speed_start_length;
+    int                                 fan_speed_end;
+};
+
+CoolingBuffer::~CoolingBuffer() = default;
+
 std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, bool flush)
 {
+    std::shared_ptr<CoolingLayer> layer = this->tokenize_layer(std::move(gcode), layer_id, flush);
+    this->parse_layer(*layer);
+    this->cool_down_layer(*layer);
+    return this->finalize_layer(*layer);
+}
+
+std::shared_ptr<CoolingLayer> CoolingBuffer::tokenize_layer(std::string &&gcode, size_t layer_id, bool flush) const
+{
+    SLIC3R_PROFILE_ZONE();
+    auto layer = std::make_shared<CoolingLayer>();
+    layer->gcode    = std::move(gcode);
+    layer->layer_id = layer_id;
+    layer->flush    = flush;
+    layer->tokens   = this->tokenize_layer_gcode(layer->gcode);
+    return layer;
+}
+
+void CoolingBuffer::parse_layer(CoolingLayer &layer)
+{
+    SLIC3R_PROFILE_ZONE();
     // Cache the input G-code.
-    if (m_gcode.empty())
-        m_gcode = std::move(gcode);
-    else
-        m_gcode += gcode;
+    if (m_gcode.empty()) {
+        m_gcode  = std::move(layer.gcode);
+        m_tokens = std::move(layer.tokens);
+    } else {
+        size_t offset = m_gcode.size();
+        m_gcode += layer.gcode;
+        m_tokens.reserve(m_tokens.size() + layer.tokens.size());
+        for (CoolingToken &token : layer.tokens) {
+            token.line_start += offset;
+            token.line_end   += offset;
+            m_tokens.emplace_back(token);
+        }
+    }
+    layer.gcode.clear();
+    layer.tokens.clear();
 
-    std::string out;
-    if (flush) {
+    if (layer.flush) {
         // This is either an object layer or the very last print layer. Calculate cool down over the collected support layers
         // and one object layer.
-        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_current_pos);
-        float layer_time_stretched = this->calculate_layer_slowdown(per_extruder_adjustments);
-        out = this->apply_layer_cooldown(m_gcode, layer_id, layer_time_stretched, per_extruder_adjustments);
+        layer.extruder = m_current_extruder;
+        layer.per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_tokens, m_current_pos, m_current_extruder);
+        layer.gcode = std::move(m_gcode);
         m_gcode.clear();
+        m_tokens.clear();
     }
-    return out;
 }
 
-// Parse the layer G-code for the moves, which could be adjusted.
-// Return the list of parsed lines, bucketed by an extruder.
-std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::array<float, 5> &current_pos) const
+void CoolingBuffer::cool_down_layer(CoolingLayer &layer) const
 {
-    std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
-    std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
-    for (size_t i = 0; i < m_extruder_ids.size(); ++ i) {
-        PerExtruderAdjustments &adj         = per_extruder_adjustments[i];
-        unsigned int            extruder_id = m_extruder_ids[i];
-        adj.extruder_id               = extruder_id;
-        adj.cooling_slow_down_enabled = m_config.cooling.get_at(extruder_id);
-        adj.slowdown_below_layer_time = float(m_config.slowdown_below_layer_time.get_at(extruder_id));
-        adj.min_print_speed           = float(m_config.min_print_speed.get_at(extruder_id));
-        map_extruder_to_per_extruder_adjustment[extruder_id] = i;
+    SLIC3R_PROFILE_ZONE();
+    if (layer.flush) {
+        float layer_time_stretched = this->calculate_layer_slowdown(layer.per_extruder_adjustments);
+        // The fan speed at the start of the layer is not known yet, the layer starts with setting the fan speed.
+        layer.fan_speed_end = -1;
+        layer.gcode = this->apply_layer_cooldown(layer.gcode, layer.layer_id, layer_time_stretched, layer.per_extruder_adjustments,
+            layer.extruder, layer.fan_speed_end, layer.fan_speed_start, layer.fan_speed_start_length);
+        layer.per_extruder_adjustments.clear();
     }
+}
 
-    unsigned int      current_extruder  = m_current_extruder;
-    PerExtruderAdjustments *adjustment  = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
+std::string CoolingBuffer::finalize_layer(CoolingLayer &layer)
+{
+    SLIC3R_PROFILE_ZONE();
+    if (! layer.flush)
+        return {};
+    if (layer.fan_speed_start == m_fan_speed)
+        // The fan is already running at this speed.
+        layer.gcode.erase(0, layer.fan_speed_start_length);
+    m_fan_speed = layer.fan_speed_end;
+    return std::move(layer.gcode);
+}
+
+// Tokenize the layer G-code for the lines, which are of interest for the cooling buffer.
+// The tokens do not depend on the preceding layers.
+std::vector<CoolingToken> CoolingBuffer::tokenize_layer_gcode(const std::string &gcode) const
+{
+    std::vector<CoolingToken> tokens;
     const char       *line_start = gcode.c_str();
     const char       *line_end   = line_start;
     const char        extrusion_axis = get_extrusion_axis(m_config)[0];
-    // Index of an existing CoolingLine of the current adjustment, which holds the feedrate setting command
-    // for a sequence of extrusion moves.
-    size_t            active_speed_modifier = size_t(-1);
 
-    std::array<float, AxisIdx::Count> new_pos;
     for (; *line_start != 0; line_start = line_end) 
     {
         while (*line_end != '\n' && *line_end != 0)
@@ -376,24 +453,24 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
         // CoolingLine will contain the trailing '\n'.
         if (*line_end == '\n')
             ++ line_end;
-        CoolingLine line(0, line_start - gcode.c_str(), line_end - gcode.c_str());
+        // The tags of the G-code generator are all placed in the comment of the line,
+        // the rest of the line does not need to be searched for them.
+        std::string_view comment = sline.substr(std::min(sline.find(';'), sline.size()));
+        CoolingToken token { 0, size_t(line_start - gcode.c_str()), size_t(line_end - gcode.c_str()), 0, {}, 0, 0.f };
         if (boost::starts_with(sline, "G0 "))
-            line.type = CoolingLine::TYPE_G0;
+            token.type = CoolingLine::TYPE_G0;
         else if (boost::starts_with(sline, "G1 "))
-            line.type = CoolingLine::TYPE_G1;
+            token.type = CoolingLine::TYPE_G1;
         else if (boost::starts_with(sline, "G2 "))
             // Arc, clockwise.
-            line.type = CoolingLine::TYPE_G2G3;
+            token.type = CoolingLine::TYPE_G2G3;
         else if (boost::starts_with(sline, "G3 "))
             // Arc, counter-clockwise.
-            line.type = CoolingLine::TYPE_G2G3 | CoolingLine::TYPE_G2G3_CCW;
+            token.type = CoolingLine::TYPE_G2G3 | CoolingLine::TYPE_G2G3_CCW;
         else if (boost::starts_with(sline, "G92 "))
-            line.type = CoolingLine::TYPE_G92;
-        if (line.type) {
+            token.type = CoolingLine::TYPE_G92;
+        if (token.type) {
             // G0, G1, G2, G3 or G92
-            // Initialize current_pos from new_pos, set IJKR to zero.
-            std::fill(std::copy(std::begin(current_pos), std::end(current_pos), std::begin(new_pos)),
-                std::end(new_pos), 0.f);
             // Parse the G-code line.
             for (auto c = sline.begin() + 3;;) {
                 // Skip whitespaces.
@@ -408,36 +485,116 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                               (*c == 'R') ? AxisIdx::R : size_t(-1);
                 if (axis != size_t(-1)) {
                     //auto [pend, ec] = 
-                        fast_float::from_chars(&*(++ c), sline.data() + sline.size(), new_pos[axis]);
+                        fast_float::from_chars(&*(++ c), sline.data() + sline.size(), token.pos[axis]);
+                    token.axes |= 1 << axis;
                     if (axis == AxisIdx::F) {
                         // Convert mm/min to mm/sec.
-                        new_pos[AxisIdx::F] /= 60.f;
-                        if ((line.type & CoolingLine::TYPE_G92) == 0)
+                        token.pos[AxisIdx::F] /= 60.f;
+                        if ((token.type & CoolingLine::TYPE_G92) == 0)
                             // This is G0 or G1 line and it sets the feedrate. This mark is used for reducing the duplicate F calls.
-                            line.type |= CoolingLine::TYPE_HAS_F;
+                            token.type |= CoolingLine::TYPE_HAS_F;
                     } else if (axis >= AxisIdx::I && axis <= AxisIdx::J)
-                        line.type |= CoolingLine::TYPE_G2G3_IJ;
+                        token.type |= CoolingLine::TYPE_G2G3_IJ;
                     else if (axis == AxisIdx::R)
-                        line.type |= CoolingLine::TYPE_G2G3_R;
+                        token.type |= CoolingLine::TYPE_G2G3_R;
                 }
                 // Skip this word.
                 for (; c != sline.end() && *c != ' ' && *c != '\t'; ++ c);
             }
             // If G2 or G3, then either center of the arc or radius has to be defined.
-            assert(! (line.type & CoolingLine::TYPE_G2G3) ||
-                (line.type & (CoolingLine::TYPE_G2G3_IJ | CoolingLine::TYPE_G2G3_R)));
+            assert(! (token.type & CoolingLine::TYPE_G2G3) ||
+                (token.type & (CoolingLine::TYPE_G2G3_IJ | CoolingLine::TYPE_G2G3_R)));
             // Arc is defined either by IJ or by R, not by both.
-            assert(! ((line.type & CoolingLine::TYPE_G2G3_IJ) && (line.type & CoolingLine::TYPE_G2G3_R)));
-            bool external_perimeter = boost::contains(sline, ";_EXTERNAL_PERIMETER");
-            bool wipe               = boost::contains(sline, ";_WIPE");
+            assert(! ((token.type & CoolingLine::TYPE_G2G3_IJ) && (token.type & CoolingLine::TYPE_G2G3_R)));
+            bool external_perimeter = boost::contains(comment, ";_EXTERNAL_PERIMETER");
+            bool wipe               = boost::contains(comment, ";_WIPE");
             if (external_perimeter)
-                line.type |= CoolingLine::TYPE_EXTERNAL_PERIMETER;
+                token.type |= CoolingLine::TYPE_EXTERNAL_PERIMETER;
             if (wipe)
-                line.type |= CoolingLine::TYPE_WIPE;
-            if (boost::contains(sline, ";_EXTRUDE_SET_SPEED") && ! wipe) {
-                line.type |= CoolingLine::TYPE_ADJUSTABLE;
-                active_speed_modifier = adjustment->lines.size();
+                token.type |= CoolingLine::TYPE_WIPE;
+            if (boost::contains(comment, ";_EXTRUDE_SET_SPEED") && ! wipe)
+                token.type |= CoolingLine::TYPE_ADJUSTABLE;
+        } else if (boost::starts_with(sline, ";_EXTRUDE_END")) {
+            // Closing a block of non-zero length extrusion moves.
+            token.type = CoolingLine::TYPE_EXTRUDE_END;
+        } else if (boost::starts_with(sline, m_toolchange_prefix)) {
+            auto res = std::from_chars(sline.data() + m_toolchange_prefix.size(), sline.data() + sline.size(), token.value);
+            if (res.ec != std::errc::invalid_argument)
+                // Only a meaningful tool number changes the extruder, see parse_layer_gcode().
+                token.type = CoolingLine::TYPE_SET_TOOL;
+        } else if (boost::starts_with(sline, ";_BRIDGE_FAN_START")) {
+            token.type = CoolingLine::TYPE_BRIDGE_FAN_START;
+        } else if (boost::starts_with(sline, ";_BRIDGE_FAN_END")) {
+            token.type = CoolingLine::TYPE_BRIDGE_FAN_END;
+        } else if (boost::starts_with(sline, "G4 ")) {
+            // Parse the wait time.
+            token.type = CoolingLine::TYPE_G4;
+            size_t pos_S = sline.find('S', 3);
+            size_t pos_P = sline.find('P', 3);
+            bool   has_S = pos_S > 0;
+            bool   has_P = pos_P > 0;
+            if (has_S || has_P) {
+                //auto [pend, ec] = 
+                    fast_float::from_chars(sline.data() + (has_S ? pos_S : pos_P) + 1, sline.data() + sline.size(), token.time);
+                if (has_P)
+                    token.time *= 0.001f;
+            } else
+                token.time = 0;
+        } else if (boost::contains(comment, ";_SET_FAN_SPEED")) {
+            auto speed_start = sline.find_last_of('D');
+            int  speed       = 0;
+            for (char num : sline.substr(speed_start + 1)) {
+                speed = speed * 10 + (num - '0');
             }
+            token.type  = CoolingLine::TYPE_SET_FAN_SPEED;
+            token.value = speed;
+        } else if (boost::contains(comment, ";_RESET_FAN_SPEED")) {
+            token.type = CoolingLine::TYPE_RESET_FAN_SPEED;
+        }
+
+        if (token.type != 0)
+            tokens.emplace_back(token);
+    }
+
+    return tokens;
+}
+
+// Parse the tokenized layer G-code for the moves, which could be adjusted.
+// Return the list of parsed lines, bucketed by an extruder.
+std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(
+    const std::string &gcode, const std::vector<CoolingToken> &tokens, std::array<float, 5> &current_pos, unsigned int &current_extruder) const
+{
+    std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
+    std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
+    for (size_t i = 0; i < m_extruder_ids.size(); ++ i) {
+        PerExtruderAdjustments &adj         = per_extruder_adjustments[i];
+        unsigned int            extruder_id = m_extruder_ids[i];
+        adj.extruder_id               = extruder_id;
+        adj.cooling_slow_down_enabled = m_config.cooling.get_at(extruder_id);
+        adj.slowdown_below_layer_time = float(m_config.slowdown_below_layer_time.get_at(extruder_id));
+        adj.min_print_speed           = float(m_config.min_print_speed.get_at(extruder_id));
+        map_extruder_to_per_extruder_adjustment[extruder_id] = i;
+    }
+
+    PerExtruderAdjustments *adjustment  = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
+    // Index of an existing CoolingLine of the current adjustment, which holds the feedrate setting command
+    // for a sequence of extrusion moves.
+    size_t            active_speed_modifier = size_t(-1);
+
+    std::array<float, AxisIdx::Count> new_pos;
+    for (const CoolingToken &token : tokens)
+    {
+        CoolingLine line(token.type, token.line_start, token.line_end);
+        if (line.type & (CoolingLine::TYPE_G0 | CoolingLine::TYPE_G1 | CoolingLine::TYPE_G2G3 | CoolingLine::TYPE_G92)) {
+            // G0, G1, G2, G3 or G92
+            // Initialize current_pos from new_pos, set IJKR to zero.
+            std::fill(std::copy(std::begin(current_pos), std::end(current_pos), std::begin(new_pos)),
+                std::end(new_pos), 0.f);
+            for (size_t axis = 0; axis < new_pos.size(); ++ axis)
+                if (token.axes & (1 << axis))
+                    new_pos[axis] = token.pos[axis];
+            if (line.type & CoolingLine::TYPE_ADJUSTABLE)
+                active_speed_modifier = adjustment->lines.size();
             if ((line.type & CoolingLine::TYPE_G92) == 0) {
                 // G0, G1, G2, G3. Calculate the duration.
                 assert((line.type & CoolingLine::TYPE_G0) != 0 + (line.type & CoolingLine::TYPE_G1) != 0 + (line.type & CoolingLine::TYPE_G2G3) != 0 == 1);
@@ -503,9 +660,8 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                 }
             }
             std::copy(std::begin(new_pos), std::begin(new_pos) + 5, std::begin(current_pos));
-        } else if (boost::starts_with(sline, ";_EXTRUDE_END")) {
+        } else if (line.type & CoolingLine::TYPE_EXTRUDE_END) {
             // Closing a block of non-zero length extrusion moves.
-            line.type = CoolingLine::TYPE_EXTRUDE_END;
             if (active_speed_modifier != size_t(-1)) {
                 assert(active_speed_modifier < adjustment->lines.size());
                 CoolingLine &sm = adjustment->lines[active_speed_modifier];
@@ -522,54 +678,29 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                 }
             }
             active_speed_modifier = size_t(-1);
-        } else if (boost::starts_with(sline, m_toolchange_prefix)) {
-            unsigned int new_extruder = 0;
-            auto res = std::from_chars(sline.data() + m_toolchange_prefix.size(), sline.data() + sline.size(), new_extruder);
-            if (res.ec != std::errc::invalid_argument) {
-                // Only change extruder in case the number is meaningful. User could provide an out-of-range index through custom gcodes - those shall be ignored.
-                if (new_extruder < map_extruder_to_per_extruder_adjustment.size()) {
-                    if (new_extruder != current_extruder) {
-                        // Switch the tool.
-                        line.type = CoolingLine::TYPE_SET_TOOL;
-                        current_extruder = new_extruder;
-                        adjustment         = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
-                    }
-                }
-                else {
-                    // Only log the error in case of MM printer. Single extruder printers likely ignore any T anyway.
-                    if (map_extruder_to_per_extruder_adjustment.size() > 1)
-                        BOOST_LOG_TRIVIAL(error) << "CoolingBuffer encountered an invalid toolchange, maybe from a custom gcode: " << sline;
+        } else if (line.type & CoolingLine::TYPE_SET_TOOL) {
+            unsigned int new_extruder = token.value;
+            line.type = 0;
+            // Only change extruder in case the number is meaningful. User could provide an out-of-range index through custom gcodes - those shall be ignored.
+            if (new_extruder < map_extruder_to_per_extruder_adjustment.size()) {
+                if (new_extruder != current_extruder) {
+                    // Switch the tool.
+                    line.type = CoolingLine::TYPE_SET_TOOL;
+                    current_extruder = new_extruder;
+                    adjustment         = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
                 }
             }
-        } else if (boost::starts_with(sline, ";_BRIDGE_FAN_START")) {
-            line.type = CoolingLine::TYPE_BRIDGE_FAN_START;
-        } else if (boost::starts_with(sline, ";_BRIDGE_FAN_END")) {
-            line.type = CoolingLine::TYPE_BRIDGE_FAN_END;
-        } else if (boost::starts_with(sline, "G4 ")) {
-            // Parse the wait time.
-            line.type = CoolingLine::TYPE_G4;
-            size_t pos_S = sline.find('S', 3);
-            size_t pos_P = sline.find('P', 3);
-            bool   has_S = pos_S > 0;
-            bool   has_P = pos_P > 0;
-            if (has_S || has_P) {
-                //auto [pend, ec] = 
-                    fast_float::from_chars(sline.data() + (has_S ? pos_S : pos_P) + 1, sline.data() + sline.size(), line.time);
-                if (has_P)
-                    line.time *= 0.001f;
-            } else
-                line.time = 0;
-            line.time_max = line.time;
-        } else if (boost::contains(sline, ";_SET_FAN_SPEED")) {
-            auto speed_start = sline.find_last_of('D');
-            int  speed       = 0;
-            for (char num : sline.substr(speed_start + 1)) {
-                speed = speed * 10 + (num - '0');
+            else {
+                // Only log the error in case of MM printer. Single extruder printers likely ignore any T anyway.
+                if (map_extruder_to_per_extruder_adjustment.size() > 1)
+                    BOOST_LOG_TRIVIAL(error) << "CoolingBuffer encountered an invalid toolchange, maybe from a custom gcode: " <<
+                        std::string_view(gcode.data() + token.line_start, token.line_end - token.line_start);
             }
-            line.type = CoolingLine::TYPE_SET_FAN_SPEED;
-            line.fan_speed = speed;
-        } else if (boost::contains(sline, ";_RESET_FAN_SPEED")) {
-            line.type = CoolingLine::TYPE_RESET_FAN_SPEED;
+        } else if (line.type & CoolingLine::TYPE_G4) {
+            line.time     = token.time;
+            line.time_max = line.time;
+        } else if (line.type & CoolingLine::TYPE_SET_FAN_SPEED) {
+            line.fan_speed = int(token.value);
         }
 
         if (line.type != 0)
@@ -716,7 +847,7 @@ static inline void extruder_range_slow_down_non_proportional(
 }
 
 // Calculate slow down for all the extruders.
-float CoolingBuffer::calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments)
+float CoolingBuffer::calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments) const
 {
     // Sort the extruders by an increasing slowdown_below_layer_time.
     // The layers with a lower slowdown_below_layer_time are slowed down
@@ -785,7 +916,14 @@ std::string CoolingBuffer::apply_layer_cooldown(
     // Total time of this layer after slow down, used to control the fan.
     float                                   layer_time,
     // Per extruder list of G-code lines and their cool down attributes.
-    std::vector<PerExtruderAdjustments>    &per_extruder_adjustments)
+    std::vector<PerExtruderAdjustments>    &per_extruder_adjustments,
+    // Extruder at the start of the layer.
+    unsigned int                            current_extruder,
+    // Current fan speed or -1 if not known, updated to the fan speed at the end of the layer.
+    int                                    &fan_speed,
+    // Fan speed set at the start of the layer and the length of the G-code setting it.
+    int                                    &fan_speed_start,
+    size_t                                 &fan_speed_start_length) const
 {
     // First sort the adjustment lines by of multiple extruders by their position in the source G-code.
     std::vector<const CoolingLine*> lines;
@@ -804,8 +942,8 @@ std::string CoolingBuffer::apply_layer_cooldown(
     new_gcode.reserve(gcode.size() * 2);
     bool bridge_fan_control = false;
     int  bridge_fan_speed   = 0;
-    auto change_extruder_set_fan = [this, layer_id, layer_time, &new_gcode, &bridge_fan_control, &bridge_fan_speed]() {
-#define EXTRUDER_CONFIG(OPT) m_config.OPT.get_at(m_current_extruder)
+    auto change_extruder_set_fan = [this, layer_id, layer_time, &current_extruder, &fan_speed, &new_gcode, &bridge_fan_control, &bridge_fan_speed]() {
+#define EXTRUDER_CONFIG(OPT) m_config.OPT.get_at(current_extruder)
         int min_fan_speed = EXTRUDER_CONFIG(min_fan_speed);
         int fan_speed_new = EXTRUDER_CONFIG(fan_always_on) ? min_fan_speed : 0;
         std::pair<int, int> custom_fan_speed_limits{fan_speed_new, 100 };
@@ -850,9 +988,9 @@ std::string CoolingBuffer::apply_layer_cooldown(
             fan_speed_new      = 0;
             custom_fan_speed_limits.second = 0;
         }
-        if (fan_speed_new != m_fan_speed) {
-            m_fan_speed = fan_speed_new;
-            new_gcode  += GCodeWriter::set_fan(m_config.gcode_flavor, m_config.gcode_comments, m_fan_speed);
+        if (fan_speed_new != fan_speed) {
+            fan_speed  = fan_speed_new;
+            new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_config.gcode_comments, fan_speed);
         }
         custom_fan_speed_limits.first = std::min(custom_fan_speed_limits.first, custom_fan_speed_limits.second);
         return custom_fan_speed_limits;
@@ -861,6 +999,8 @@ std::string CoolingBuffer::apply_layer_cooldown(
     const char         *pos               = gcode.c_str();
     int                 current_feedrate  = 0;
     std::pair<int,int> fan_speed_limits = change_extruder_set_fan();
+    fan_speed_start        = fan_speed;
+    fan_speed_start_length = new_gcode.size();
     for (const CoolingLine *line : lines) {
         const char *line_start  = gcode.c_str() + line->line_start;
         const char *line_end    = gcode.c_str() + line->line_end;
@@ -869,16 +1009,16 @@ std::string CoolingBuffer::apply_layer_cooldown(
         if (line->type & CoolingLine::TYPE_SET_TOOL) {
             unsigned int new_extruder = 0;
             auto res = std::from_chars(line_start + m_toolchange_prefix.size(), line_end, new_extruder);
-            if (res.ec != std::errc::invalid_argument && new_extruder != m_current_extruder) {
-                m_current_extruder = new_extruder;
+            if (res.ec != std::errc::invalid_argument && new_extruder != current_extruder) {
+                current_extruder = new_extruder;
                 fan_speed_limits = change_extruder_set_fan();
             }
             new_gcode.append(line_start, line_end - line_start);
         } else if (line->type & CoolingLine::TYPE_SET_FAN_SPEED) {
             int new_speed = std::clamp(line->fan_speed, fan_speed_limits.first, fan_speed_limits.second);
-            if (m_fan_speed != new_speed) {
+            if (fan_speed != new_speed) {
                 new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_config.gcode_comments, new_speed);
-                m_fan_speed = new_speed;
+                fan_speed = new_speed;
             }
         } else if (line->type & CoolingLine::TYPE_RESET_FAN_SPEED){
             fan_speed_limits = change_extruder_set_fan();
@@ -887,7 +1027,7 @@ std::string CoolingBuffer::apply_layer_cooldown(
                 new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_config.gcode_comments, bridge_fan_speed);
         } else if (line->type & CoolingLine::TYPE_BRIDGE_FAN_END) {
             if (bridge_fan_control)
-                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_config.gcode_comments, m_fan_speed);
+                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_config.gcode_comments, fan_speed);
         } else if (line->type & CoolingLine::TYPE_EXTRUDE_END) {
             // Just remove this comment.
         } else if (line->type & (CoolingLine::TYPE_ADJUSTABLE | CoolingLine::TYPE_ADJUSTABLE_EMPTY | CoolingLine::TYPE_EXTERNAL_PERIMETER | CoolingLine::TYPE_WIPE | CoolingLine::TYPE_HAS_F)) {
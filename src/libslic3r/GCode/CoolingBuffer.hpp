@@ -13,13 +13,17 @@
 
 #include "../libslic3r.h"
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace Slic3r {
 
 class GCodeGenerator;
 class Layer;
 struct PerExtruderAdjustments;
+struct CoolingToken;
+struct CoolingLayer;
 
 // A standalone G-code filter, to control cooling of the print.
 // The G-code is processed per layer. Once a layer is collected, fan start / stop commands are edited
@@ -33,22 +37,38 @@ struct PerExtruderAdjustments;
 class CoolingBuffer {
 public:
     CoolingBuffer(GCodeGenerator &gcodegen);
+    ~CoolingBuffer();
     void        reset(const Vec3d &position);
     void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; }
     std::string process_layer(std::string &&gcode, size_t layer_id, bool flush);
     std::string process_layer(const std::string &gcode, size_t layer_id, bool flush)
         { return this->process_layer(std::string(gcode), layer_id, flush); }
 
+    // process_layer() split into stages to be run by the filters of a pipeline. Only parse_layer() and finalize_layer()
+    // pass the state from layer to layer and they have to process the layers serially in order. tokenize_layer()
+    // parses the G-code text and cool_down_layer() slows down the layer and edits its G-code, both may process
+    // multiple layers in parallel.
+    std::shared_ptr<CoolingLayer> tokenize_layer(std::string &&gcode, size_t layer_id, bool flush) const;
+    void        parse_layer(CoolingLayer &layer);
+    void        cool_down_layer(CoolingLayer &layer) const;
+    // Returns the adjusted G-code of a flushed layer, an empty string if the layer is collected for the next one.
+    std::string finalize_layer(CoolingLayer &layer);
+
 private:
 	CoolingBuffer& operator=(const CoolingBuffer&) = delete;
-    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, std::array<float, 5> &current_pos) const;
-    float       calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
+    std::vector<CoolingToken> tokenize_layer_gcode(const std::string &gcode) const;
+    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, const std::vector<CoolingToken> &tokens,
+        std::array<float, 5> &current_pos, unsigned int &current_extruder) const;
+    float       calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments) const;
     // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
     // Returns the adjusted G-code.
-    std::string apply_layer_cooldown(const std::string &gcode, size_t layer_id, float layer_time, std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
+    std::string apply_layer_cooldown(const std::string &gcode, size_t layer_id, float layer_time, std::vector<PerExtruderAdjustments> &per_extruder_adjustments,
+        unsigned int current_extruder, int &fan_speed, int &fan_speed_start, size_t &fan_speed_start_length) const;
 
     // G-code snippet cached for the support layers preceding an object layer.
     std::string                 m_gcode;
+    // Tokens of m_gcode.
+    std::vector<CoolingToken>   m_tokens;
     // Internal data.
     std::vector<char>           m_axis;
     enum AxisIdx : int {
@@ -66,6 +86,7 @@ private:
     // Referencs GCodeGenerator::m_config, which is FullPrintConfig. While the PrintObjectConfig slice of FullPrintConfig is being modified,
     // the PrintConfig slice of FullPrintConfig is constant, thus no thread synchronization is required.
     const PrintConfig          &m_config;
+    // Extruder at the end of the G-code parsed so far.
     unsigned int                m_current_extruder;
 
     // Old logic: proportional.
@@ -43,83 +43,88 @@ struct ExtendedPoint
     float curvature;
 };
 
+// Distances of the points from the previous layer offset by boundary_offset, queried from the distancer in a single batch.
+template<bool SIGNED_DISTANCE, typename L>
+void estimate_points_distances(std::vector<ExtendedPoint>             &points,
+                               const std::vector<size_t>              &indices,
+                               const AABBTreeLines::LinesDistancer<L> &unscaled_prev_layer,
+                               float                                   boundary_offset)
+{
+    using AABBScalar = typename AABBTreeLines::LinesDistancer<L>::Scalar;
+    std::vector<Vec<2, AABBScalar>> positions;
+    positions.reserve(indices.size());
+    for (size_t idx : indices)
+        positions.emplace_back(points[idx].position.template cast<AABBScalar>());
+    auto distances = unscaled_prev_layer.template distances_from_lines<SIGNED_DISTANCE>(positions);
+    for (size_t i = 0; i < indices.size(); ++ i)
+        points[indices[i]].distance = float(distances[i] + boundary_offset);
+}
+
 template<bool SCALED_INPUT, bool ADD_INTERSECTIONS, bool PREV_LAYER_BOUNDARY_OFFSET, bool SIGNED_DISTANCE, typename POINTS, typename L>
 std::vector<ExtendedPoint> estimate_points_properties(const POINTS                           &input_points,
                                                       const AABBTreeLines::LinesDistancer<L> &unscaled_prev_layer,
                                                       float                                   flow_width,
                                                       float                                   max_line_length = -1.0f)
 {
-    bool   looped     = input_points.front() == input_points.back();
-    std::function<size_t(size_t,size_t)> get_prev_index = [](size_t idx, size_t count) {
-        if (idx > 0) {
-            return idx - 1;
-        } else
-            return idx;
-    };
-    if (looped) {
-        get_prev_index = [](size_t idx, size_t count) {
-            if (idx == 0)
-                idx = count;
-            return --idx;
-        };
-    };
-    std::function<size_t(size_t,size_t)> get_next_index = [](size_t idx, size_t size) {
-        if (idx + 1 < size) {
-            return idx + 1;
-        } else
-            return idx;
-    };
-    if (looped) {
-        get_next_index = [](size_t idx, size_t count) {
-            if (++idx == count)
-                idx = 0;
-            return idx;
-        };
-    };
-
     using P = typename POINTS::value_type;
 
     using AABBScalar = typename AABBTreeLines::LinesDistancer<L>::Scalar;
     if (input_points.empty())
         return {};
+    const bool looped = input_points.front() == input_points.back();
+    auto get_prev_index = [looped](size_t idx, size_t count) {
+        if (idx > 0)
+            return idx - 1;
+        return looped ? count - 1 : idx;
+    };
+    auto get_next_index = [looped](size_t idx, size_t count) {
+        if (idx + 1 < count)
+            return idx + 1;
+        return looped ? 0 : idx;
+    };
     float boundary_offset = PREV_LAYER_BOUNDARY_OFFSET ? 0.5 * flow_width : 0.0f;
     auto  maybe_unscale   = [](const P &p) { return SCALED_INPUT ? unscaled(p) : p.template cast<double>(); };
 
     std::vector<ExtendedPoint> points;
     points.reserve(input_points.size() * (ADD_INTERSECTIONS ? 1.5 : 1));
+    // Indices of the points, which distances are not known yet.
+    std::vector<size_t>        queries;
 
     {
-        ExtendedPoint start_point{maybe_unscale(input_points.front())};
-        auto [distance, nearest_line,
-              x] = unscaled_prev_layer.template distance_from_lines_extra<SIGNED_DISTANCE>(start_point.position.cast<AABBScalar>());
-        start_point.distance = distance + boundary_offset;
-        points.push_back(start_point);
-    }
-    for (size_t i = 1; i < input_points.size(); i++) {
-        ExtendedPoint next_point{maybe_unscale(input_points[i])};
-        auto [distance, nearest_line,
-              x] = unscaled_prev_layer.template distance_from_lines_extra<SIGNED_DISTANCE>(next_point.position.cast<AABBScalar>());
-        next_point.distance = distance + boundary_offset;
-
-        if (ADD_INTERSECTIONS &&
-            ((points.back().distance > boundary_offset + EPSILON) != (next_point.distance > boundary_offset + EPSILON))) {
-            const ExtendedPoint &prev_point    = points.back();
-            auto                 intersections = unscaled_prev_layer.template intersections_with_line<true>(
-                L{prev_point.position.cast<AABBScalar>(), next_point.position.cast<AABBScalar>()});
-            for (const auto &intersection : intersections) {
-                ExtendedPoint p{};
-                p.position = intersection.first.template cast<double>();
-                p.distance = boundary_offset;
-                points.push_back(p);
-            }
+        std::vector<ExtendedPoint> input_extended;
+        input_extended.reserve(input_points.size());
+        queries.reserve(input_points.size());
+        for (const P &p : input_points) {
+            queries.emplace_back(input_extended.size());
+            input_extended.push_back({ maybe_unscale(p) });
         }
-        points.push_back(next_point);
+        estimate_points_distances<SIGNED_DISTANCE>(input_extended, queries, unscaled_prev_layer, boundary_offset);
+        if (ADD_INTERSECTIONS) {
+            points.push_back(input_extended.front());
+            for (size_t i = 1; i < input_extended.size(); i++) {
+                const ExtendedPoint &next_point = input_extended[i];
+                if ((points.back().distance > boundary_offset + EPSILON) != (next_point.distance > boundary_offset + EPSILON)) {
+                    const ExtendedPoint &prev_point    = points.back();
+                    auto                 intersections = unscaled_prev_layer.template intersections_with_line<true>(
+                        L{prev_point.position.cast<AABBScalar>(), next_point.position.cast<AABBScalar>()});
+                    for (const auto &intersection : intersections) {
+                        ExtendedPoint p{};
+                        p.position = intersection.first.template cast<double>();
+                        p.distance = boundary_offset;
+                        points.push_back(p);
+                    }
+                }
+                points.push_back(next_point);
+            }
+        } else
+            points = std::move(input_extended);
     }
 
     if (PREV_LAYER_BOUNDARY_OFFSET && ADD_INTERSECTIONS) {
         std::vector<ExtendedPoint> new_points;
         new_points.reserve(points.size() * 2);
         new_points.push_back(points.front());
+        queries.clear();
         for (int point_idx = 0; point_idx < int(points.size()) - 1; ++point_idx) {
             const ExtendedPoint &curr = points[point_idx];
             const ExtendedPoint &next = points[point_idx + 1];
@@ -134,33 +139,25 @@ std::vector<ExtendedPoint> estimate_points_properties(const POINTS
                     double t1 = std::max(a0, a1);
 
                     if (t0 < 1.0) {
-                        auto p0     = curr.position + t0 * (next.position - curr.position);
-                        auto [p0_dist, p0_near_l,
-                              p0_x] = unscaled_prev_layer.template distance_from_lines_extra<SIGNED_DISTANCE>(p0.cast<AABBScalar>());
-                        ExtendedPoint new_p{};
-                        new_p.position = p0;
-                        new_p.distance = float(p0_dist + boundary_offset);
-                        new_points.push_back(new_p);
+                        queries.emplace_back(new_points.size());
+                        new_points.push_back({ curr.position + t0 * (next.position - curr.position) });
                     }
                     if (t1 > 0.0) {
-                        auto p1     = curr.position + t1 * (next.position - curr.position);
-                        auto [p1_dist, p1_near_l,
-                              p1_x] = unscaled_prev_layer.template distance_from_lines_extra<SIGNED_DISTANCE>(p1.cast<AABBScalar>());
-                        ExtendedPoint new_p{};
-                        new_p.position = p1;
-                        new_p.distance = float(p1_dist + boundary_offset);
-                        new_points.push_back(new_p);
+                        queries.emplace_back(new_points.size());
+                        new_points.push_back({ curr.position + t1 * (next.position - curr.position) });
                     }
                 }
             }
             new_points.push_back(next);
         }
+        estimate_points_distances<SIGNED_DISTANCE>(new_points, queries, unscaled_prev_layer, boundary_offset);
         points = std::move(new_points);
     }
 
     if (max_line_length > 0) {
         std::vector<ExtendedPoint> new_points;
         new_points.reserve(points.size() * 2);
+        queries.clear();
         {
             for (size_t i = 0; i + 1 < points.size(); i++) {
                 const ExtendedPoint &curr = points[i];
@@ -170,27 +167,26 @@ std::vector<ExtendedPoint> estimate_points_properties(const POINTS
                 double t               = sqrt((max_line_length * max_line_length) / len);
                 size_t new_point_count = 1.0 / t;
                 for (size_t j = 1; j < new_point_count + 1; j++) {
-                    Vec2d pos  = curr.position * (1.0 - j * t) + next.position * (j * t);
-                    auto [p_dist, p_near_l,
-                          p_x] = unscaled_prev_layer.template distance_from_lines_extra<SIGNED_DISTANCE>(pos.cast<AABBScalar>());
-                    ExtendedPoint new_p{};
-                    new_p.position = pos;
-                    new_p.distance = float(p_dist + boundary_offset);
-                    new_points.push_back(new_p);
+                    queries.emplace_back(new_points.size());
+                    new_points.push_back({ curr.position * (1.0 - j * t) + next.position * (j * t) });
                 }
             }
             new_points.push_back(points.back());
         }
+        estimate_points_distances<SIGNED_DISTANCE>(new_points, queries, unscaled_prev_layer, boundary_offset);
         points = std::move(new_points);
     }
 
+    // Lengths and directions of the segments ending at each point, the window walks below only index them.
     float accumulated_distance = 0;
     std::vector<float> distances_for_curvature(points.size());
+    std::vector<Vec2d> directions_for_curvature(points.size());
     for (size_t point_idx = 0; point_idx < points.size(); ++point_idx) {
         const ExtendedPoint &a = points[point_idx];
         const ExtendedPoint &b = points[get_prev_index(point_idx, points.size())];
 
-        distances_for_curvature[point_idx] = (b.position - a.position).norm();
+        distances_for_curvature[point_idx]  = (b.position - a.position).norm();
+        directions_for_curvature[point_idx] = (b.position - a.position).normalized();
         accumulated_distance += distances_for_curvature[point_idx];
     }
 
@@ -207,10 +203,7 @@ std::vector<ExtendedPoint> estimate_points_properties(const POINTS
                         float line_dist = distances_for_curvature[get_prev_index(back_point_index, points.size())];
                         if (dist_backwards + line_dist > window_size * 0.5) {
                             back_position = points[back_point_index].position +
-                                            (window_size * 0.5 - dist_backwards) *
-                                                (points[get_prev_index(back_point_index, points.size())].position -
-                                                 points[back_point_index].position)
-                                                    .normalized();
+                                            (window_size * 0.5 - dist_backwards) * directions_for_curvature[back_point_index];
                             dist_backwards += window_size * 0.5 - dist_backwards + EPSILON;
                         } else {
                             dist_backwards += line_dist;
@@ -226,11 +219,9 @@ std::vector<ExtendedPoint> estimate_points_properties(const POINTS
                     while (dist_forwards < window_size * 0.5 && front_point_index != get_next_index(front_point_index, points.size())) {
                         float line_dist = distances_for_curvature[front_point_index];
                         if (dist_forwards + line_dist > window_size * 0.5) {
-                            front_position = points[front_point_index].position +
-                                             (window_size * 0.5 - dist_forwards) *
-                                                 (points[get_next_index(front_point_index, points.size())].position -
-                                                  points[front_point_index].position)
-                                                     .normalized();
+                            size_t next_index = get_next_index(front_point_index, points.size());
+                            front_position = points[front_point_index].position -
+                                             (window_size * 0.5 - dist_forwards) * directions_for_curvature[next_index];
                             dist_forwards += window_size * 0.5 - dist_forwards + EPSILON;
                         } else {
                             dist_forwards += line_dist;
@@ -4,8 +4,11 @@
 ///|/
 #include "FindReplace.hpp"
 #include "../Utils.hpp"
+#include "../ProfilerTracy.hpp"
 
+#include <algorithm>
 #include <cctype> // isalpha
+#include <string_view>
 #include <boost/algorithm/string/replace.hpp>
 
 namespace Slic3r {
@@ -57,6 +60,121 @@ GCodeFindReplace::GCodeFindReplace(const std::vector<std::string> &gcode_substit
         }
         m_substitutions.emplace_back(std::move(out));
     }
+
+    // Group consecutive plain substitutions into runs to be applied at once.
+    for (size_t i = 0; i < m_substitutions.size(); ++ i) {
+        if (! m_runs.empty() && m_runs.back().end == i && can_join_run(m_runs.back(), i))
+            ++ m_runs.back().end;
+        else
+            m_runs.push_back({ i, i + 1 });
+    }
+    for (SubstitutionRun &run : m_runs)
+        if (run.end - run.begin > 1)
+            this->build_automaton(run);
+}
+
+static inline unsigned char fold_case(unsigned char c)
+{
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+static inline bool equal_folded(std::string_view a, std::string_view b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+        [](char ca, char cb) { return fold_case(ca) == fold_case(cb); });
+}
+
+// Could an occurrence of b in a text overlap with or adjoin an occurrence of a?
+// Conservative: Compared case insensitive.
+static bool may_overlap(std::string_view a, std::string_view b)
+{
+    // Removing a joins its neighbors, which may then match b.
+    if (a.empty() || b.empty())
+        return true;
+    auto contains = [](std::string_view haystack, std::string_view needle) {
+        for (size_t i = 0; i + needle.size() <= haystack.size(); ++ i)
+            if (equal_folded(haystack.substr(i, needle.size()), needle))
+                return true;
+        return false;
+    };
+    if (contains(a, b) || contains(b, a))
+        return true;
+    for (size_t len = 1; len < std::min(a.size(), b.size()); ++ len)
+        if (equal_folded(a.substr(a.size() - len), b.substr(0, len)) || equal_folded(b.substr(b.size() - len), a.substr(0, len)))
+            return true;
+    return false;
+}
+
+// Applying the substitutions of a run one after the other produces the same output as applying them at once in a single pass,
+// if the patterns do not overlap and if no pattern overlaps the replacement of a preceding substitution.
+bool GCodeFindReplace::can_join_run(const SubstitutionRun &run, size_t idx) const
+{
+    auto plain = [](const Substitution &substitution) {
+        return ! substitution.regexp && ! substitution.whole_word && ! substitution.plain_pattern.empty();
+    };
+    const Substitution &substitution = m_substitutions[idx];
+    if (! plain(substitution))
+        return false;
+    for (size_t i = run.begin; i < run.end; ++ i) {
+        const Substitution &other = m_substitutions[i];
+        if (! plain(other) || may_overlap(other.plain_pattern, substitution.plain_pattern) || may_overlap(other.format, substitution.plain_pattern))
+            return false;
+    }
+    return true;
+}
+
+// Build Aho-Corasick automaton matching the patterns of a run case insensitive.
+// Case sensitive patterns are verified once matched.
+void GCodeFindReplace::build_automaton(SubstitutionRun &run) const
+{
+    // Trie of the patterns. Transition to the root state 0 means no transition, the root is not a child of any state.
+    std::vector<uint32_t> &transitions = run.transitions;
+    std::vector<int>      &matches     = run.matches;
+    transitions.assign(256, 0);
+    matches.assign(1, -1);
+    for (size_t i = run.begin; i < run.end; ++ i) {
+        uint32_t state = 0;
+        for (char c : m_substitutions[i].plain_pattern) {
+            uint32_t &next = transitions[state * 256 + fold_case(c)];
+            if (next == 0) {
+                next = uint32_t(matches.size());
+                transitions.resize(transitions.size() + 256, 0);
+                matches.emplace_back(-1);
+            }
+            state = transitions[state * 256 + fold_case(c)];
+        }
+        matches[state] = int(i);
+    }
+
+    // Breadth first: Calculate the failure links, complete the transitions and propagate the matches along the failure links.
+    // No pattern of a run is a suffix of another pattern, thus at most one pattern ends at a state.
+    std::vector<uint32_t> failure(matches.size(), 0);
+    std::vector<uint32_t> queue;
+    queue.reserve(matches.size());
+    for (int c = 0; c < 256; ++ c)
+        if (fold_case(c) == c && transitions[c] != 0)
+            queue.emplace_back(transitions[c]);
+    for (size_t head = 0; head < queue.size(); ++ head) {
+        uint32_t state = queue[head];
+        if (matches[state] == -1)
+            matches[state] = matches[failure[state]];
+        for (int c = 0; c < 256; ++ c)
+            if (fold_case(c) == c) {
+                uint32_t &next = transitions[state * 256 + c];
+                uint32_t  fail = transitions[failure[state] * 256 + c];
+                if (next == 0)
+                    next = fail;
+                else {
+                    failure[next] = fail;
+                    queue.emplace_back(next);
+                }
+            }
+    }
+
+    // Upper case characters transition the same as the lower case ones.
+    for (size_t state = 0; state < matches.size(); ++ state)
+        for (int c = 'A'; c <= 'Z'; ++ c)
+            transitions[state * 256 + c] = transitions[state * 256 + fold_case(c)];
 }
 
 class ToStringIterator 
@@ -109,46 +227,72 @@ static void find_and_replace_whole_word(std::string &inout, const std::string &m
     }
 }
 
-std::string GCodeFindReplace::process_layer(const std::string &ain)
+std::string GCodeFindReplace::process_layer(const std::string &ain) const
 {
+    SLIC3R_PROFILE_ZONE();
     std::string out;
     const std::string *in = &ain;
     std::string temp;
     temp.reserve(in->size());
 
-    for (const Substitution &substitution : m_substitutions) {
-        if (substitution.regexp) {
+    for (const SubstitutionRun &run : m_runs) {
+        if (! run.transitions.empty()) {
+            // Plain substitutions of the run applied in a single pass.
             temp.clear();
             temp.reserve(in->size());
-            boost::regex_replace(ToStringIterator(temp), in->begin(), in->end(),
-                substitution.regexp_pattern, substitution.format, 
-                (substitution.single_line ? boost::match_single_line | boost::match_default : boost::match_not_dot_newline | boost::match_default) | boost::format_all);
+            size_t   last  = 0;
+            uint32_t state = 0;
+            for (size_t i = 0; i < in->size(); ++ i) {
+                state = run.transitions[state * 256 + (unsigned char)(*in)[i]];
+                if (int idx = run.matches[state]; idx != -1) {
+                    const Substitution &substitution = m_substitutions[idx];
+                    size_t              start        = i + 1 - substitution.plain_pattern.size();
+                    if (substitution.case_insensitive || in->compare(start, substitution.plain_pattern.size(), substitution.plain_pattern) == 0) {
+                        temp.append(*in, last, start - last);
+                        temp.append(substitution.format);
+                        last  = i + 1;
+                        // Matches must not overlap, start matching from scratch.
+                        state = 0;
+                    }
+                }
+            }
+            temp.append(*in, last, std::string::npos);
             std::swap(out, temp);
         } else {
-            if (in == &ain)
-                out = ain;
-            // Plain substitution
-            if (substitution.case_insensitive) {
-                if (substitution.whole_word)
-                    find_and_replace_whole_word(out, substitution.plain_pattern, substitution.format,
-                        [](const std::string &str, size_t start_pos, const std::string &match) {
-                            auto begin = str.begin() + start_pos;
-                            boost::iterator_range<std::string::const_iterator> r1(begin, str.end());
-                            boost::iterator_range<std::string::const_iterator> r2(match.begin(), match.end());
-                            auto res = boost::ifind_first(r1, r2);
-                            return res ? std::make_pair(size_t(res.begin() - str.begin()), size_t(res.end() - str.begin())) : std::make_pair(std::string::npos, std::string::npos);
-                        });
-                else
-                    boost::ireplace_all(out, substitution.plain_pattern, substitution.format);
+            const Substitution &substitution = m_substitutions[run.begin];
+            if (substitution.regexp) {
+                temp.clear();
+                temp.reserve(in->size());
+                boost::regex_replace(ToStringIterator(temp), in->begin(), in->end(),
+                    substitution.regexp_pattern, substitution.format, 
+                    (substitution.single_line ? boost::match_single_line | boost::match_default : boost::match_not_dot_newline | boost::match_default) | boost::format_all);
+                std::swap(out, temp);
             } else {
-                if (substitution.whole_word)
-                    find_and_replace_whole_word(out, substitution.plain_pattern, substitution.format,
-                        [](const std::string &str, size_t start_pos, const std::string &match) { 
-                            size_t pos = str.find(match, start_pos);
-                            return std::make_pair(pos, pos + (pos == std::string::npos ? 0 : match.size()));
-                        });
-                else
-                    boost::replace_all(out, substitution.plain_pattern, substitution.format);
+                if (in == &ain)
+                    out = ain;
+                // Plain substitution
+                if (substitution.case_insensitive) {
+                    if (substitution.whole_word)
+                        find_and_replace_whole_word(out, substitution.plain_pattern, substitution.format,
+                            [](const std::string &str, size_t start_pos, const std::string &match) {
+                                auto begin = str.begin() + start_pos;
+                                boost::iterator_range<std::string::const_iterator> r1(begin, str.end());
+                                boost::iterator_range<std::string::const_iterator> r2(match.begin(), match.end());
+                                auto res = boost::ifind_first(r1, r2);
+                                return res ? std::make_pair(size_t(res.begin() - str.begin()), size_t(res.end() - str.begin())) : std::make_pair(std::string::npos, std::string::npos);
+                            });
+                    else
+                        boost::ireplace_all(out, substitution.plain_pattern, substitution.format);
+                } else {
+                    if (substitution.whole_word)
+                        find_and_replace_whole_word(out, substitution.plain_pattern, substitution.format,
+                            [](const std::string &str, size_t start_pos, const std::string &match) { 
+                                size_t pos = str.find(match, start_pos);
+                                return std::make_pair(pos, pos + (pos == std::string::npos ? 0 : match.size()));
+                            });
+                    else
+                        boost::replace_all(out, substitution.plain_pattern, substitution.format);
+                }
             }
         }
         in = &out;
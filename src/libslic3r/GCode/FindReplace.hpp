@@ -17,8 +17,9 @@ public:
     GCodeFindReplace(const std::vector<std::string> &gcode_substitutions);
 
 
-    std::string process_layer(const std::string &gcode);
-    
+    // Does not modify the state of GCodeFindReplace, thus multiple layers may be processed in parallel.
+    std::string process_layer(const std::string &gcode) const;
+
 private:
     struct Substitution {
         std::string     plain_pattern;
@@ -32,6 +33,23 @@ private:
         bool            single_line { false };
     };
     std::vector<Substitution> m_substitutions;
+
+    // The substitutions are applied one after the other. A run of consecutive plain substitutions, which could not interact
+    // with each other, is applied at once in a single pass over the G-code using an Aho-Corasick automaton of their patterns.
+    struct SubstitutionRun {
+        // Range of m_substitutions.
+        size_t                  begin;
+        size_t                  end;
+        // Transitions of the automaton, 256 per state, empty for a single substitution.
+        // Upper case characters transition the same as the lower case characters.
+        std::vector<uint32_t>   transitions;
+        // Per state: Index of the substitution, which pattern ends at this state, or -1.
+        std::vector<int>        matches;
+    };
+    std::vector<SubstitutionRun> m_runs;
+
+    bool can_join_run(const SubstitutionRun &run, size_t idx) const;
+    void build_automaton(SubstitutionRun &run) const;
 };
 
 }
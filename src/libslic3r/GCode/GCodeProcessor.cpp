@@ -7,10 +7,12 @@
 #include "libslic3r/Print.hpp"
 #include "libslic3r/LocalesUtils.hpp"
 #include "libslic3r/format.hpp"
+#include "libslic3r/ProfilerTracy.hpp"
 #include "libslic3r/I18N.hpp"
 #include "libslic3r/GCode/GCodeWriter.hpp"
 #include "libslic3r/I18N.hpp"
 #include "libslic3r/Geometry/ArcWelder.hpp"
+#include "libslic3r/Thread.hpp"
 #include "GCodeProcessor.hpp"
 
 #include <boost/algorithm/string/case_conv.hpp>
@@ -30,6 +32,9 @@
 #endif
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 static const float DEFAULT_TOOLPATH_WIDTH = 0.4f;
 static const float DEFAULT_TOOLPATH_HEIGHT = 0.2f;
@@ -203,8 +208,98 @@ void GCodeProcessor::TimeMachine::CustomGCodeTime::reset()
     times = std::vector<std::pair<CustomGCode::Type, float>>();
 }
 
+// Serial executor of the tasks of one TimeMachine. The parser thread only creates the blocks,
+// planning them and accumulating the times is left to this thread, so that the time estimation
+// of all the machines runs in parallel with the parsing.
+// The queue is bounded: when the parser gets too far ahead, it waits for the planner.
+class GCodeProcessor::TimeMachine::Worker
+{
+public:
+    using Task = std::function<void()>;
+
+    static constexpr size_t queue_capacity = 16;
+
+    Worker() { m_thread = create_thread([this] { this->run(); }); }
+
+    // The tasks not yet started are dropped
+    ~Worker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void submit(Task task)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return m_tasks.size() < queue_capacity; });
+        m_tasks.emplace_back(std::move(task));
+        lock.unlock();
+        m_condition.notify_all();
+    }
+
+    // Waits for all the submitted tasks, rethrows the first exception thrown by any of them
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return m_tasks.empty() && !m_busy; });
+        if (m_error)
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_condition.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+            if (m_stop)
+                break;
+
+            Task task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            // Once a task failed, the following ones would work on inconsistent data
+            const bool skip = m_error != nullptr;
+            m_busy = true;
+            lock.unlock();
+            m_condition.notify_all();
+
+            std::exception_ptr error;
+            try {
+                if (!skip)
+                    task();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            task = nullptr;
+
+            lock.lock();
+            if (error)
+                m_error = error;
+            m_busy = false;
+            m_condition.notify_all();
+        }
+    }
+
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Task>        m_tasks;
+    bool                    m_busy{ false };
+    bool                    m_stop{ false };
+    std::exception_ptr      m_error;
+    boost::thread           m_thread;
+};
+
 void GCodeProcessor::TimeMachine::reset()
 {
+    // stop the planning of the previous job first, the tasks access the data reset below
+    worker.reset();
+
     enabled = false;
     acceleration = 0.0f;
     max_acceleration = 0.0f;
@@ -220,18 +315,53 @@ void GCodeProcessor::TimeMachine::reset()
     prev.reset();
     gcode_time.reset();
     blocks = std::vector<TimeBlock>();
+    new_blocks = std::vector<TimeBlock>();
+    planner_blocks_count = 0;
     g1_times_cache = std::vector<G1LinesCacheItem>();
     std::fill(moves_time.begin(), moves_time.end(), 0.0f);
     std::fill(roles_time.begin(), roles_time.end(), 0.0f);
     layers_time = std::vector<float>();
 }
 
+void GCodeProcessor::TimeMachine::append_block(const TimeBlock& block)
+{
+    if (new_blocks.empty())
+        new_blocks.reserve(TimeProcessor::Planner::refresh_threshold);
+    new_blocks.push_back(block);
+
+    if (++planner_blocks_count > TimeProcessor::Planner::refresh_threshold) {
+        submit([](TimeMachine& machine) { machine.calculate_time(TimeProcessor::Planner::queue_size); });
+        planner_blocks_count = TimeProcessor::Planner::queue_size;
+    }
+}
+
 void GCodeProcessor::TimeMachine::simulate_st_synchronize(float additional_time)
 {
     if (!enabled)
         return;
 
-    calculate_time(0, additional_time);
+    submit([additional_time](TimeMachine& machine) { machine.calculate_time(0, additional_time); });
+    // calculate_time() leaves a single block in the planner
+    if (planner_blocks_count > 1)
+        planner_blocks_count = 0;
+}
+
+void GCodeProcessor::TimeMachine::submit(std::function<void(TimeMachine&)> task)
+{
+    if (worker == nullptr)
+        worker = std::make_shared<Worker>();
+
+    worker->submit([this, batch = std::move(new_blocks), task = std::move(task)]() {
+        blocks.insert(blocks.end(), batch.begin(), batch.end());
+        task(*this);
+    });
+    new_blocks.clear();
+}
+
+void GCodeProcessor::TimeMachine::synchronize()
+{
+    if (worker != nullptr)
+        worker->wait();
 }
 
 static void planner_forward_pass_kernel(GCodeProcessor::TimeBlock& prev, GCodeProcessor::TimeBlock& curr)
@@ -512,7 +642,7 @@ bool GCodeProcessor::contains_reserved_tag(const std::string& gcode, std::string
 
     GCodeReader parser;
     parser.parse_buffer(gcode, [&ret, &found_tag](GCodeReader& parser, const GCodeReader::GCodeLine& line) {
-        std::string comment = line.raw();
+        std::string comment(line.raw());
         if (comment.length() > 2 && comment.front() == ';') {
             comment = comment.substr(1);
             for (const std::string& s : Reserved_Tags) {
@@ -539,7 +669,7 @@ bool GCodeProcessor::contains_reserved_tags(const std::string& gcode, unsigned i
 
     GCodeReader parser;
     parser.parse_buffer(gcode, [&ret, &found_tag, max_count](GCodeReader& parser, const GCodeReader::GCodeLine& line) {
-        std::string comment = line.raw();
+        std::string comment(line.raw());
         if (comment.length() > 2 && comment.front() == ';') {
             comment = comment.substr(1);
             for (const std::string& s : Reserved_Tags) {
@@ -1049,6 +1179,7 @@ static inline const char* remove_eols(const char *begin, const char *end) {
 // throws CanceledException through print->throw_if_canceled() (sent by the caller as callback).
 void GCodeProcessor::process_file(const std::string& filename, std::function<void()> cancel_callback)
 {
+    SLIC3R_PROFILE_ZONE();
     FILE* file = boost::nowide::fopen(filename.c_str(), "rb");
     if (file == nullptr)
         throw Slic3r::RuntimeError(format("Error opening file %1%", filename));
@@ -1119,7 +1250,9 @@ void GCodeProcessor::process_ascii_file(const std::string& filename, std::functi
     m_result.id = ++s_result_id;
     initialize_result_moves();
     size_t parse_line_callback_cntr = 10000;
-    m_parser.parse_file(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
+    m_result.lines_ends.assign(1, std::vector<size_t>());
+    // The lines are tokenized in parallel, while process_gcode_line() is called serially in the order of the lines.
+    if (! m_parser.parse_file_parallel(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (-- parse_line_callback_cntr == 0) {
             // Don't call the cancel_callback() too often, do it every at every 10000'th line.
             parse_line_callback_cntr = 10000;
@@ -1127,7 +1260,8 @@ void GCodeProcessor::process_ascii_file(const std::string& filename, std::functi
                 cancel_callback();
         }
         this->process_gcode_line(line, true);
-    }, m_result.lines_ends);
+    }, &m_result.lines_ends.front()))
+        throw Slic3r::RuntimeError(format("Error reading file %1%", filename));
 
     // Don't post-process the G-code to update time stamps.
     this->finalize(false);
@@ -1298,14 +1432,23 @@ void GCodeProcessor::initialize(const std::string& filename)
 
 void GCodeProcessor::process_buffer(const std::string &buffer)
 {
+    SLIC3R_PROFILE_ZONE();
     //FIXME maybe cache GCodeLine gline to be over multiple parse_buffer() invocations.
     m_parser.parse_buffer(buffer, [this](GCodeReader&, const GCodeReader::GCodeLine& line) { 
         this->process_gcode_line(line, false);
     });
 }
 
-void GCodeProcessor::finalize(bool perform_post_process)
+void GCodeProcessor::process_tokenized_buffer(std::vector<GCodeReader::GCodeLine>& lines)
 {
+    m_parser.parse_tokenized(lines, [this](GCodeReader&, const GCodeReader::GCodeLine& line) {
+        this->process_gcode_line(line, false);
+    });
+}
+
+void GCodeProcessor::finalize(bool perform_post_process, const std::string& output_filename)
+{
+    SLIC3R_PROFILE_ZONE();
     m_result.z_offset = m_z_offset;
 
     // update width/height of wipe moves
@@ -1317,12 +1460,19 @@ void GCodeProcessor::finalize(bool perform_post_process)
     }
 
     // process the time blocks
-    for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
-        TimeMachine& machine = m_time_processor.machines[i];
-        TimeMachine::CustomGCodeTime& gcode_time = machine.gcode_time;
-        machine.calculate_time();
-        if (gcode_time.needed && gcode_time.cache != 0.0f)
-            gcode_time.times.push_back({ CustomGCode::ColorChange, gcode_time.cache });
+    for (TimeMachine& machine : m_time_processor.machines) {
+        if (!machine.enabled)
+            continue;
+
+        machine.submit([](TimeMachine& machine) {
+            TimeMachine::CustomGCodeTime& gcode_time = machine.gcode_time;
+            machine.calculate_time();
+            if (gcode_time.needed && gcode_time.cache != 0.0f)
+                gcode_time.times.push_back({ CustomGCode::ColorChange, gcode_time.cache });
+        });
+    }
+    for (TimeMachine& machine : m_time_processor.machines) {
+        machine.synchronize();
     }
 
     m_used_filaments.process_caches(this);
@@ -1337,12 +1487,29 @@ void GCodeProcessor::finalize(bool perform_post_process)
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
 
     if (perform_post_process)
-        post_process();
+        post_process(output_filename);
 #if ENABLE_GCODE_VIEWER_STATISTICS
     m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - m_start_time).count();
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 }
 
+GCodeProcessorResult GCodeProcessor::partial_result() const
+{
+    GCodeProcessorResult out = m_result;
+    out.id = ++s_result_id;
+    out.filename.clear();
+    out.lines_ends.clear();
+    out.z_offset = m_z_offset;
+    // see finalize()
+    for (GCodeProcessorResult::MoveVertex& move : out.moves) {
+        if (move.type == EMoveType::Wipe) {
+            move.width = Wipe_Width;
+            move.height = Wipe_Height;
+        }
+    }
+    return out;
+}
+
 float GCodeProcessor::get_time(PrintEstimatedStatistics::ETimeMode mode) const
 {
     return (mode < PrintEstimatedStatistics::ETimeMode::Count) ? m_time_processor.machines[static_cast<size_t>(mode)].time : 0.0f;
@@ -1805,7 +1972,7 @@ void GCodeProcessor::process_gcode_line(const GCodeReader::GCodeLine& line, bool
         }
     }
     else {
-        const std::string &comment = line.raw();
+        const std::string_view comment = line.raw();
         if (comment.length() > 2 && comment.front() == ';')
             // Process tags embedded into comments. Tag comments always start at the start of a line
             // with a comment and continue with a tag without any whitespace separator.
@@ -2713,7 +2880,6 @@ void GCodeProcessor::process_G1(const std::array<std::optional<double>, 4>& axes
 
         TimeMachine::State& curr = machine.curr;
         TimeMachine::State& prev = machine.prev;
-        std::vector<TimeBlock>& blocks = machine.blocks;
 
         curr.feedrate = (delta_pos[E] == 0.0f) ? minimum_travel_feedrate(static_cast<PrintEstimatedStatistics::ETimeMode>(i), m_feedrate) :
             minimum_feedrate(static_cast<PrintEstimatedStatistics::ETimeMode>(i), m_feedrate);
@@ -2778,7 +2944,7 @@ void GCodeProcessor::process_G1(const std::array<std::optional<double>, 4>& axes
 
         // calculates block entry feedrate
         float vmax_junction = curr.safe_feedrate;
-        if (!blocks.empty() && prev.feedrate > PREVIOUS_FEEDRATE_THRESHOLD) {
+        if (machine.planner_blocks_count > 0 && prev.feedrate > PREVIOUS_FEEDRATE_THRESHOLD) {
             const bool prev_speed_larger = prev.feedrate > block.feedrate_profile.cruise;
             const float smaller_speed_factor = prev_speed_larger ? (block.feedrate_profile.cruise / prev.feedrate) : (prev.feedrate / block.feedrate_profile.cruise);
             // Pick the smaller of the nominal speeds. Higher speed shall not be achieved at the junction during coasting.
@@ -2848,10 +3014,7 @@ void GCodeProcessor::process_G1(const std::array<std::optional<double>, 4>& axes
         // updates previous
         prev = curr;
 
-        blocks.push_back(block);
-
-        if (blocks.size() > TimeProcessor::Planner::refresh_threshold)
-            machine.calculate_time(TimeProcessor::Planner::queue_size);
+        machine.append_block(block);
     }
 
     if (m_seams_detector.is_active()) {
@@ -3344,9 +3507,9 @@ void GCodeProcessor::process_M108(const GCodeReader::GCodeLine& line)
     if (m_flavor != gcfSailfish)
         return;
 
-    std::string cmd = line.raw();
-    size_t pos = cmd.find("T");
-    if (pos != std::string::npos)
+    const std::string_view cmd = line.raw();
+    size_t pos = cmd.find('T');
+    if (pos != std::string_view::npos)
         process_T(cmd.substr(pos));
 }
 
@@ -3399,9 +3562,9 @@ void GCodeProcessor::process_M135(const GCodeReader::GCodeLine& line)
     if (m_flavor != gcfMakerWare)
         return;
 
-    std::string cmd = line.raw();
-    size_t pos = cmd.find("T");
-    if (pos != std::string::npos)
+    const std::string_view cmd = line.raw();
+    size_t pos = cmd.find('T');
+    if (pos != std::string_view::npos)
         process_T(cmd.substr(pos));
 }
 
@@ -3666,14 +3829,14 @@ void GCodeProcessor::process_T(const std::string_view command)
     }
 }
 
-void GCodeProcessor::post_process()
+void GCodeProcessor::post_process(const std::string& output_filename)
 {
     FilePtr in{ boost::nowide::fopen(m_result.filename.c_str(), "rb") };
     if (in.f == nullptr)
         throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for reading.\n"));
 
-    // temporary file to contain modified gcode
-    std::string out_path = m_result.filename + ".postprocess";
+    // temporary file to contain modified gcode, unless the caller asked for the modified gcode to be written elsewhere
+    const std::string out_path = output_filename.empty() ? m_result.filename + ".postprocess" : output_filename;
     FilePtr out{ boost::nowide::fopen(out_path.c_str(), "wb") };
     if (out.f == nullptr)
         throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for writing.\n"));
@@ -4275,7 +4438,7 @@ void GCodeProcessor::post_process()
                         reader.parse_line(line, [&gline](GCodeReader& reader, const GCodeReader::GCodeLine& l) { gline = l; });
 
                         float val;
-                        if (gline.has_value('T', val) && gline.raw().find("cooldown") != std::string::npos && m_is_XL_printer) {
+                        if (gline.has_value('T', val) && gline.raw().find("cooldown") != std::string_view::npos && m_is_XL_printer) {
                             if (static_cast<int>(val) == tool_number)
                                 return std::string("; removed M104\n");
                         }
@@ -4390,7 +4553,10 @@ void GCodeProcessor::post_process()
     else
         export_lines.synchronize_moves(m_result);
 
-    if (rename_file(out_path, result_filename))
+    if (! output_filename.empty()) {
+        boost::nowide::remove(result_filename.c_str());
+        m_result.filename = output_filename;
+    } else if (rename_file(out_path, result_filename))
         throw Slic3r::RuntimeError(std::string("Failed to rename the output G-code file from ") + out_path + " to " + result_filename + '\n' +
             "Is " + out_path + " locked?" + '\n');
 }
@@ -4426,7 +4592,9 @@ void GCodeProcessor::store_move_vertex(EMoveType type, bool internal_only)
             if (!machine.enabled)
                 continue;
 
-            machine.stop_times.push_back({ m_g1_line_id, 0.0f });
+            machine.submit([g1_line_id = m_g1_line_id](TimeMachine& machine) {
+                machine.stop_times.push_back({ g1_line_id, 0.0f });
+            });
         }
     }
 }
@@ -4564,15 +4732,17 @@ void GCodeProcessor::process_custom_gcode_time(CustomGCode::Type code)
         if (!machine.enabled)
             continue;
 
-        TimeMachine::CustomGCodeTime& gcode_time = machine.gcode_time;
-        gcode_time.needed = true;
         //FIXME this simulates st_synchronize! is it correct?
         // The estimated time may be longer than the real print time.
         machine.simulate_st_synchronize();
-        if (gcode_time.cache != 0.0f) {
-            gcode_time.times.push_back({ code, gcode_time.cache });
-            gcode_time.cache = 0.0f;
-        }
+        machine.submit([code](TimeMachine& machine) {
+            TimeMachine::CustomGCodeTime& gcode_time = machine.gcode_time;
+            gcode_time.needed = true;
+            if (gcode_time.cache != 0.0f) {
+                gcode_time.times.push_back({ code, gcode_time.cache });
+                gcode_time.cache = 0.0f;
+            }
+        });
     }
 }
 
@@ -21,6 +21,8 @@
 #include <string>
 #include <string_view>
 #include <optional>
+#include <functional>
+#include <memory>
 
 namespace Slic3r {
 
@@ -178,6 +180,8 @@ namespace Slic3r {
         void reset();
     };
 
+    // Receives snapshots of the G-code processed so far while the G-code is being exported, see GCodeProcessor::partial_result().
+    using GCodeProcessorResultCallback = std::function<void(GCodeProcessorResult &&partial_result)>;
 
     class GCodeProcessor
     {
@@ -347,17 +351,33 @@ namespace Slic3r {
             State curr;
             State prev;
             CustomGCodeTime gcode_time;
+            // Blocks in the planner, owned by the worker thread
             std::vector<TimeBlock> blocks;
+            // Blocks created by the parser, not yet handed over to the worker thread
+            std::vector<TimeBlock> new_blocks;
+            // Number of blocks in the planner as seen from the parser thread
+            size_t planner_blocks_count;
             std::vector<G1LinesCacheItem> g1_times_cache;
             std::array<float, static_cast<size_t>(EMoveType::Count)> moves_time;
             std::array<float, static_cast<size_t>(GCodeExtrusionRole::Count)> roles_time;
             std::vector<float> layers_time;
 
+            // Plans the blocks on its own thread, see GCodeProcessor.cpp
+            class Worker;
+            std::shared_ptr<Worker> worker;
+
             void reset();
 
+            // Appends the block to the planner, the time is calculated asynchronously
+            void append_block(const TimeBlock& block);
             // Simulates firmware st_synchronize() call
             void simulate_st_synchronize(float additional_time = 0.0f);
             void calculate_time(size_t keep_last_n_blocks = 0, float additional_time = 0.0f);
+            // Runs the task on the worker thread once the blocks appended so far are in the planner.
+            // The tasks run in the order of submission, the time data are valid after synchronize().
+            void submit(std::function<void(TimeMachine&)> task);
+            // Waits for all the submitted tasks to finish
+            void synchronize();
         };
 
         struct TimeProcessor
@@ -657,6 +677,10 @@ namespace Slic3r {
 
         const GCodeProcessorResult& get_result() const { return m_result; }
         GCodeProcessorResult&& extract_result() { return std::move(m_result); }
+        // Copy of the moves processed so far by the streaming interface, to be shown by the G-code viewer while the G-code
+        // is still being exported. The estimated times are not filled in and the G-code file is not referenced.
+        // Each snapshot receives a new id, so that the G-code viewer does not skip loading the final result.
+        GCodeProcessorResult partial_result() const;
 
         // Load a G-code into a stand-alone G-code viewer.
         // throws CanceledException through print->throw_if_canceled() (sent by the caller as callback).
@@ -670,7 +694,14 @@ namespace Slic3r {
             m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
         }
         void process_buffer(const std::string& buffer);
-        void finalize(bool post_process);
+        // Tokenize a G-code buffer to be processed by process_tokenized_buffer() later.
+        // May be called from another thread while the processor is processing the previously emitted G-code.
+        void tokenize_buffer(const std::string& buffer, std::vector<GCodeReader::GCodeLine>& lines) const { m_parser.tokenize_buffer(buffer, lines); }
+        // Same as process_buffer() for a buffer tokenized by tokenize_buffer().
+        void process_tokenized_buffer(std::vector<GCodeReader::GCodeLine>& lines);
+        // If output_filename is not empty, the post-processed G-code is written there and the processed file is removed,
+        // otherwise the processed file is replaced by the post-processed G-code.
+        void finalize(bool post_process, const std::string& output_filename = std::string());
 
         float get_time(PrintEstimatedStatistics::ETimeMode mode) const;
         std::string get_time_dhm(PrintEstimatedStatistics::ETimeMode mode) const;
@@ -822,7 +853,8 @@ namespace Slic3r {
         // post process the file with the given filename to:
         // 1) add remaining time lines M73 and update moves' gcode ids accordingly
         // 2) update used filament data
-        void post_process();
+        // The result is written to output_filename if not empty, otherwise it replaces the processed file.
+        void post_process(const std::string& output_filename);
 
         void store_move_vertex(EMoveType type, bool internal_only = false);
 
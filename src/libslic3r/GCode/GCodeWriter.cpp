@@ -21,10 +21,6 @@
 #include <assert.h>
 #include <string_view>
 
-#ifdef __APPLE__
-    #include <boost/spirit/include/karma.hpp>
-#endif
-
 #define FLAVOR_IS(val) this->config.gcode_flavor == val
 #define FLAVOR_IS_NOT(val) this->config.gcode_flavor != val
 
@@ -52,6 +48,33 @@ void GCodeWriter::apply_print_config(const PrintConfig &print_config)
         print_config.machine_max_acceleration_travel.values.front() : 0));
 }
 
+GCodeWriter& GCodeWriter::operator=(const GCodeWriter &rhs)
+{
+    if (this == &rhs)
+        return *this;
+    this->config                     = rhs.config;
+    this->multiple_extruders         = rhs.multiple_extruders;
+    m_extruders                      = rhs.m_extruders;
+    m_extrusion_axis                 = rhs.m_extrusion_axis;
+    m_single_extruder_multi_material = rhs.m_single_extruder_multi_material;
+    m_last_acceleration              = rhs.m_last_acceleration;
+    m_last_travel_acceleration       = rhs.m_last_travel_acceleration;
+    m_max_acceleration               = rhs.m_max_acceleration;
+    m_max_travel_acceleration        = rhs.m_max_travel_acceleration;
+    m_last_bed_temperature           = rhs.m_last_bed_temperature;
+    m_last_bed_temperature_reached   = rhs.m_last_bed_temperature_reached;
+    m_lifted                         = rhs.m_lifted;
+    m_pos                            = rhs.m_pos;
+    // Rebind the extruders to our own config and find the active extruder in our own extruder list.
+    m_extruder = nullptr;
+    for (Extruder &extruder : m_extruders) {
+        extruder.m_config = &this->config;
+        if (rhs.m_extruder != nullptr && extruder.id() == rhs.m_extruder->id())
+            m_extruder = &extruder;
+    }
+    return *this;
+}
+
 void GCodeWriter::set_extruders(std::vector<unsigned int> extruder_ids)
 {
     std::sort(extruder_ids.begin(), extruder_ids.end());
@@ -262,7 +285,7 @@ std::string GCodeWriter::toolchange(unsigned int extruder_id)
     return gcode.str();
 }
 
-std::string GCodeWriter::set_speed(double F, const std::string_view comment, const std::string_view cooling_marker) const
+void GCodeWriter::set_speed(std::string &out, double F, const std::string_view comment, const std::string_view cooling_marker) const
 {
     assert(F > 0.);
     assert(F < 100000.);
@@ -271,10 +294,10 @@ std::string GCodeWriter::set_speed(double F, const std::string_view comment, con
     w.emit_f(F);
     w.emit_comment(this->config.gcode_comments, comment);
     w.emit_string(cooling_marker);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string_view comment)
+void GCodeWriter::travel_to_xy(std::string &out, const Vec2d &point, const std::string_view comment)
 {
     m_pos.head<2>() = point.head<2>();
     
@@ -282,7 +305,7 @@ std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string_view
     w.emit_xy(point);
     w.emit_f(this->config.travel_speed.value * 60.0);
     w.emit_comment(this->config.gcode_comments, comment);
-    return w.string();
+    w.append_to(out);
 }
 
 std::string GCodeWriter::travel_to_xy_G2G3IJ(const Vec2d &point, const Vec2d &ij, const bool ccw, const std::string_view comment)
@@ -381,7 +404,7 @@ bool GCodeWriter::will_move_z(double z) const
     return true;
 }
 
-std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std::string_view comment)
+void GCodeWriter::extrude_to_xy(std::string &out, const Vec2d &point, double dE, const std::string_view comment)
 {
     assert(dE != 0);
     assert(std::abs(dE) < 1000.0);
@@ -392,10 +415,10 @@ std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std:
     w.emit_xy(point);
     w.emit_e(m_extrusion_axis, m_extruder->extrude(dE).second);
     w.emit_comment(this->config.gcode_comments, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::extrude_to_xy_G2G3IJ(const Vec2d &point, const Vec2d &ij, const bool ccw, double dE, const std::string_view comment)
+void GCodeWriter::extrude_to_xy_G2G3IJ(std::string &out, const Vec2d &point, const Vec2d &ij, const bool ccw, double dE, const std::string_view comment)
 {
     assert(std::abs(dE) < 1000.0);
     assert(dE != 0);
@@ -412,7 +435,7 @@ std::string GCodeWriter::extrude_to_xy_G2G3IJ(const Vec2d &point, const Vec2d &i
     w.emit_ij(ij);
     w.emit_e(m_extrusion_axis, m_extruder->extrude(dE).second);
     w.emit_comment(this->config.gcode_comments, comment);
-    return w.string();
+    w.append_to(out);
 }
 
 #if 0
@@ -599,46 +622,38 @@ std::string GCodeWriter::set_fan(unsigned int speed) const
 
 void GCodeFormatter::emit_axis(const char axis, const double v, size_t digits) {
     assert(digits <= 9);
-    static constexpr const std::array<int, 10> pow_10{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    static constexpr const std::array<uint64_t, 10> pow_10{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
     *ptr_err.ptr++ = ' '; *ptr_err.ptr++ = axis;
 
     char *base_ptr = this->ptr_err.ptr;
     auto  v_int    = int64_t(std::round(v * pow_10[digits]));
-    // Older stdlib on macOS doesn't support std::from_chars at all, so it is used boost::spirit::karma::generate instead of it.
-    // That is a little bit slower than std::to_chars but not much.
-#ifdef __APPLE__
-    boost::spirit::karma::generate(this->ptr_err.ptr, boost::spirit::karma::int_generator<int64_t>(), v_int);
-#else
-    // this->buf_end minus 1 because we need space for adding the extra decimal point.
-    this->ptr_err = std::to_chars(this->ptr_err.ptr, this->buf_end - 1, v_int);
-#endif
-    size_t writen_digits = (this->ptr_err.ptr - base_ptr) - (v_int < 0 ? 1 : 0);
-    if (writen_digits < digits) {
-        // Number is smaller than 10^digits, so that we will pad it with zeros.
-        size_t remaining_digits = digits - writen_digits;
-        // Move all newly inserted chars by remaining_digits to allocate space for padding with zeros.
-        for (char *from_ptr = this->ptr_err.ptr - 1, *to_ptr = from_ptr + remaining_digits; from_ptr >= this->ptr_err.ptr - writen_digits; --to_ptr, --from_ptr)
-            *to_ptr = *from_ptr;
-
-        memset(this->ptr_err.ptr - writen_digits, '0', remaining_digits);
-        this->ptr_err.ptr += remaining_digits;
+    // Format the fixed point number directly: The integer part is omitted if zero, the fractional part is emitted
+    // without the trailing zeros, zero is emitted as "0".
+    uint64_t v_abs      = v_int < 0 ? uint64_t(- v_int) : uint64_t(v_int);
+    uint64_t v_integer  = v_abs / pow_10[digits];
+    uint64_t v_fraction = v_abs % pow_10[digits];
+    char    *ptr        = base_ptr;
+    if (v_int < 0)
+        *ptr ++ = '-';
+    if (v_integer != 0 || v_fraction == 0) {
+        size_t num_digits = 1;
+        for (uint64_t rest = v_integer; rest >= 10; rest /= 10)
+            ++ num_digits;
+        for (char *p = ptr + num_digits; p != ptr; v_integer /= 10)
+            *-- p = char('0' + v_integer % 10);
+        ptr += num_digits;
     }
-
-    // Move all newly inserted chars by one to allocate space for a decimal point.
-    for (char *to_ptr = this->ptr_err.ptr, *from_ptr = to_ptr - 1; from_ptr >= this->ptr_err.ptr - digits; --to_ptr, --from_ptr)
-        *to_ptr = *from_ptr;
-
-    *(this->ptr_err.ptr - digits) = '.';
-    for (size_t i = 0; i < digits; ++i) {
-        if (*this->ptr_err.ptr != '0')
-            break;
-        this->ptr_err.ptr--;
+    if (v_fraction != 0) {
+        size_t num_digits = digits;
+        for (; v_fraction % 10 == 0; v_fraction /= 10)
+            -- num_digits;
+        *ptr ++ = '.';
+        for (char *p = ptr + num_digits; p != ptr; v_fraction /= 10)
+            *-- p = char('0' + v_fraction % 10);
+        ptr += num_digits;
     }
-    if (*this->ptr_err.ptr == '.')
-        this->ptr_err.ptr--;
-    if ((this->ptr_err.ptr + 1) == base_ptr || *this->ptr_err.ptr == '-')
-        *(++this->ptr_err.ptr) = '0';
-    this->ptr_err.ptr++;
+    assert(ptr < this->buf_end);
+    this->ptr_err.ptr = ptr;
 
 #if 0 // #ifndef NDEBUG
     {
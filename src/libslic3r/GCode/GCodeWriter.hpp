@@ -33,6 +33,9 @@ public:
         m_last_bed_temperature(0), m_last_bed_temperature_reached(true), 
         m_lifted(0)
         {}
+    // The extruders of a copy are bound to the config of the copy.
+    GCodeWriter(const GCodeWriter &rhs) { *this = rhs; }
+    GCodeWriter& operator=(const GCodeWriter &rhs);
     Extruder*            extruder()             { return m_extruder; }
     const Extruder*      extruder()     const   { return m_extruder; }
 
@@ -66,14 +69,24 @@ public:
     // printed with the same extruder.
     std::string toolchange_prefix() const;
     std::string toolchange(unsigned int extruder_id);
-    std::string set_speed(double F, const std::string_view comment = {}, const std::string_view cooling_marker = {}) const;
-    std::string travel_to_xy(const Vec2d &point, const std::string_view comment = {});
+    std::string set_speed(double F, const std::string_view comment = {}, const std::string_view cooling_marker = {}) const
+        { std::string out; this->set_speed(out, F, comment, cooling_marker); return out; }
+    std::string travel_to_xy(const Vec2d &point, const std::string_view comment = {})
+        { std::string out; this->travel_to_xy(out, point, comment); return out; }
     std::string travel_to_xy_G2G3IJ(const Vec2d &point, const Vec2d &ij, const bool ccw, const std::string_view comment = {});
     std::string travel_to_xyz(const Vec3d &point, const std::string_view comment = {});
     std::string travel_to_z(double z, const std::string_view comment = {});
     bool        will_move_z(double z) const;
-    std::string extrude_to_xy(const Vec2d &point, double dE, const std::string_view comment = {});
-    std::string extrude_to_xy_G2G3IJ(const Vec2d &point, const Vec2d &ij, const bool ccw, double dE, const std::string_view comment);
+    std::string extrude_to_xy(const Vec2d &point, double dE, const std::string_view comment = {})
+        { std::string out; this->extrude_to_xy(out, point, dE, comment); return out; }
+    std::string extrude_to_xy_G2G3IJ(const Vec2d &point, const Vec2d &ij, const bool ccw, double dE, const std::string_view comment)
+        { std::string out; this->extrude_to_xy_G2G3IJ(out, point, ij, ccw, dE, comment); return out; }
+    // Variants of the above appending the G-code line to out, to be used when emitting long sequences of moves
+    // without creating a temporary string for each line.
+    void        set_speed(std::string &out, double F, const std::string_view comment = {}, const std::string_view cooling_marker = {}) const;
+    void        travel_to_xy(std::string &out, const Vec2d &point, const std::string_view comment = {});
+    void        extrude_to_xy(std::string &out, const Vec2d &point, double dE, const std::string_view comment = {});
+    void        extrude_to_xy_G2G3IJ(std::string &out, const Vec2d &point, const Vec2d &ij, const bool ccw, double dE, const std::string_view comment);
 //    std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string_view comment = {});
     std::string retract(bool before_wipe = false);
     std::string retract_for_toolchange(bool before_wipe = false);
@@ -221,6 +234,12 @@ public:
         return std::string(this->buf, ptr_err.ptr - buf);
     }
 
+    // Terminate the line and append it to out.
+    void append_to(std::string &out) {
+        *ptr_err.ptr ++ = '\n';
+        out.append(this->buf, ptr_err.ptr - buf);
+    }
+
 protected:
     static constexpr const size_t   buflen = 256;
     char                            buf[buflen];
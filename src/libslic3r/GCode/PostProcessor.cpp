@@ -63,23 +63,27 @@ static void quote_argv_winapi(const std::wstring &argument, std::wstring &commma
 	}
 }
 
-static DWORD execute_process_winapi(const std::wstring &command_line)
+// Extract the current environment to be passed to a child process.
+static std::wstring environment_strings_winapi()
 {
-    // Extract the current environment to be passed to the child process.
 	std::wstring envstr;
-	{
-		wchar_t *env = GetEnvironmentStrings();
-		assert(env != nullptr);
-		const wchar_t* var = env;
-		size_t totallen = 0;
-		size_t len;
-		while ((len = wcslen(var)) > 0) {
-			totallen += len + 1;
-			var += len + 1;
-		}
-		envstr = std::wstring(env, totallen);
-		FreeEnvironmentStrings(env);
+	wchar_t *env = GetEnvironmentStrings();
+	assert(env != nullptr);
+	const wchar_t* var = env;
+	size_t totallen = 0;
+	size_t len;
+	while ((len = wcslen(var)) > 0) {
+		totallen += len + 1;
+		var += len + 1;
 	}
+	envstr = std::wstring(env, totallen);
+	FreeEnvironmentStrings(env);
+	return envstr;
+}
+
+static DWORD execute_process_winapi(const std::wstring &command_line)
+{
+	std::wstring envstr = environment_strings_winapi();
 
 	STARTUPINFOW startup_info;
 	memset(&startup_info, 0, sizeof(startup_info));
@@ -147,6 +151,82 @@ static int run_script(const std::string &script, const std::string &gcode, std::
     return (int)execute_process_winapi(command_line);
 }
 
+// Run a chain of filter scripts through the command line interpreter. The first script reads in_path from its standard input,
+// each script writes to the standard input of the next one through a pipe and the last one writes to out_path.
+// The scripts run concurrently. Returns the exit code of the last failed script and its index in failed_script, zero on success.
+static int run_filter_scripts(const std::vector<std::string> &scripts, const std::string &in_path, const std::string &out_path, size_t &failed_script, std::string &/*std_err*/)
+{
+	assert(! scripts.empty());
+	SECURITY_ATTRIBUTES security_attributes;
+	memset(&security_attributes, 0, sizeof(security_attributes));
+	security_attributes.nLength        = sizeof(security_attributes);
+	security_attributes.bInheritHandle = TRUE;
+	HANDLE file_in  = ::CreateFileW(boost::nowide::widen(in_path).c_str(), GENERIC_READ, FILE_SHARE_READ, &security_attributes, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_in == INVALID_HANDLE_VALUE)
+		throw Slic3r::RuntimeError(std::string("Failed opening ") + in_path + " for the post-processing scripts, Win32 error: " + std::to_string(int(::GetLastError())));
+	HANDLE file_out = ::CreateFileW(boost::nowide::widen(out_path).c_str(), GENERIC_WRITE, 0, &security_attributes, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_out == INVALID_HANDLE_VALUE) {
+		::CloseHandle(file_in);
+		throw Slic3r::RuntimeError(std::string("Failed creating ") + out_path + " for the post-processing scripts, Win32 error: " + std::to_string(int(::GetLastError())));
+	}
+
+	std::wstring        envstr = environment_strings_winapi();
+	std::vector<HANDLE> processes;
+	std::string         error;
+	// Standard input of the next script to be started, owned by this process.
+	HANDLE              std_in = file_in;
+	for (size_t i = 0; i < scripts.size() && error.empty(); ++ i) {
+		HANDLE std_out   = file_out;
+		HANDLE next_pipe = nullptr;
+		if (i + 1 < scripts.size() && ! ::CreatePipe(&next_pipe, &std_out, &security_attributes, 0)) {
+			error = std::string("Failed creating a pipe for the post-processing script ") + scripts[i] + ", Win32 error: " + std::to_string(int(::GetLastError()));
+			break;
+		}
+		// The pipe end read by the next script shall not be inherited by this script.
+		if (next_pipe != nullptr)
+			::SetHandleInformation(next_pipe, HANDLE_FLAG_INHERIT, 0);
+		STARTUPINFOW startup_info;
+		memset(&startup_info, 0, sizeof(startup_info));
+		startup_info.cb         = sizeof(STARTUPINFO);
+		startup_info.dwFlags    = STARTF_USESTDHANDLES;
+		startup_info.hStdInput  = std_in;
+		startup_info.hStdOutput = std_out;
+		startup_info.hStdError  = ::GetStdHandle(STD_ERROR_HANDLE);
+		std::wstring command_line = L"cmd.exe /C " + boost::nowide::widen(scripts[i]);
+		PROCESS_INFORMATION process_info;
+		if (::CreateProcessW(
+				nullptr /* lpApplicationName */, (LPWSTR)command_line.c_str(), nullptr /* lpProcessAttributes */, nullptr /* lpThreadAttributes */, true /* bInheritHandles */,
+				CREATE_UNICODE_ENVIRONMENT /* dwCreationFlags */, (LPVOID)envstr.c_str(), nullptr /* lpCurrentDirectory */, &startup_info, &process_info)) {
+			::CloseHandle(process_info.hThread);
+			processes.emplace_back(process_info.hProcess);
+		} else
+			error = std::string("Failed starting the script ") + scripts[i] + ", Win32 error: " + std::to_string(int(::GetLastError()));
+		// Only the child processes hold the pipe ends now, thus a script sees the end of its input once the preceding one exits.
+		::CloseHandle(std_in);
+		if (std_out != file_out)
+			::CloseHandle(std_out);
+		std_in = next_pipe;
+	}
+	if (std_in != nullptr)
+		::CloseHandle(std_in);
+	::CloseHandle(file_out);
+
+	int rc = 0;
+	for (size_t i = 0; i < processes.size(); ++ i) {
+		::WaitForSingleObject(processes[i], INFINITE);
+		DWORD process_rc = 0;
+		::GetExitCodeProcess(processes[i], &process_rc);
+		::CloseHandle(processes[i]);
+		if (process_rc != 0) {
+			rc            = int(process_rc);
+			failed_script = i;
+		}
+	}
+	if (! error.empty())
+		throw Slic3r::RuntimeError(error);
+	return rc;
+}
+
 #else
     // POSIX
 
@@ -188,10 +268,88 @@ static int run_script(const std::string &script, const std::string &gcode, std::
     return child.exit_code();
 }
 
+// Run a chain of filter scripts through the shell. The first script reads in_path from its standard input,
+// each script writes to the standard input of the next one through a pipe and the last one writes to out_path.
+// The scripts run concurrently. Returns the exit code of the last failed script and its index in failed_script, zero on success.
+static int run_filter_scripts(const std::vector<std::string> &scripts, const std::string &in_path, const std::string &out_path, size_t &failed_script, std::string &std_err)
+{
+    assert(! scripts.empty());
+    const char *shell = ::getenv("SHELL");
+    if (shell == nullptr) { shell = "/bin/sh"; }
+
+    // Standard error outputs are redirected to files, a script blocked on writing its standard error would block the whole chain.
+    std::vector<std::string> err_paths;
+    for (size_t i = 0; i < scripts.size(); ++ i)
+        err_paths.emplace_back(out_path + ".stderr" + std::to_string(i));
+    std::vector<process::pipe>  pipes(scripts.size() - 1);
+    std::vector<process::child> children;
+    children.reserve(scripts.size());
+    try {
+        for (size_t i = 0; i < scripts.size(); ++ i) {
+            BOOST_LOG_TRIVIAL(debug) << boost::format("Executing filter script, shell: %1%, command: %2%") % shell % scripts[i];
+            if (scripts.size() == 1)
+                children.emplace_back(shell, "-c", scripts[i], process::std_in < in_path, process::std_out > out_path, process::std_err > err_paths[i]);
+            else if (i == 0)
+                children.emplace_back(shell, "-c", scripts[i], process::std_in < in_path, process::std_out > pipes[i], process::std_err > err_paths[i]);
+            else if (i + 1 == scripts.size())
+                children.emplace_back(shell, "-c", scripts[i], process::std_in < pipes[i - 1], process::std_out > out_path, process::std_err > err_paths[i]);
+            else
+                children.emplace_back(shell, "-c", scripts[i], process::std_in < pipes[i - 1], process::std_out > pipes[i], process::std_err > err_paths[i]);
+        }
+    } catch (...) {
+        // Close the pipes to let the already started scripts finish.
+        for (process::pipe &pipe : pipes)
+            pipe.close();
+        for (process::child &child : children)
+            child.wait();
+        for (const std::string &err_path : err_paths) {
+            boost::system::error_code ec;
+            boost::filesystem::remove(err_path, ec);
+        }
+        throw;
+    }
+    // Only the child processes hold the pipe ends now, thus a script sees the end of its input once the preceding one exits.
+    for (process::pipe &pipe : pipes)
+        pipe.close();
+
+    int rc = 0;
+    for (size_t i = 0; i < children.size(); ++ i) {
+        children[i].wait();
+        if (int child_rc = children[i].exit_code(); child_rc != 0) {
+            // A script failing downstream breaks the pipe of the preceding scripts, report the last failed script.
+            rc            = child_rc;
+            failed_script = i;
+        }
+    }
+    std_err.clear();
+    for (size_t i = 0; i < err_paths.size(); ++ i) {
+        if (rc != 0 && i == failed_script) {
+            boost::nowide::ifstream f(err_paths[i]);
+            std_err.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        }
+        boost::system::error_code ec;
+        boost::filesystem::remove(err_paths[i], ec);
+    }
+    return rc;
+}
+
 #endif
 
 namespace Slic3r {
 
+// A post-processing script line starting with '|' is a filter: It reads the G-code from its standard input
+// and writes the post-processed G-code to its standard output.
+static bool is_filter_script(const std::string &script)
+{
+    return ! script.empty() && script.front() == '|';
+}
+
+static std::string filter_script_command(const std::string &script)
+{
+    assert(is_filter_script(script));
+    return boost::trim_copy(script.substr(1));
+}
+
 // Run post processing script / scripts if defined.
 // Returns true if a post-processing script was executed.
 // Returns false if no post-processing script was defined.
@@ -211,8 +369,24 @@ bool run_post_process_scripts(std::string &src_path, bool make_copy, const std::
         post_process->values.empty())
         return false;
 
+    std::vector<std::string> scripts;
+    for (const std::string &script_lines : post_process->values) {
+        std::vector<std::string> lines;
+        boost::split(lines, script_lines, boost::is_any_of("\r\n"));
+        for (std::string &script : lines) {
+            // Ignore empty post processing script lines.
+            boost::trim(script);
+            if (! script.empty())
+                scripts.emplace_back(std::move(script));
+        }
+    }
+    // Filter scripts starting the post-processing write the copy of the G-code while reading the source G-code.
+    const bool filter_makes_copy = make_copy && ! scripts.empty() && is_filter_script(scripts.front());
+
     std::string path;
-    if (make_copy) {
+    if (filter_makes_copy) {
+        path = src_path + ".pp";
+    } else if (make_copy) {
         // Don't run the post-processing script on the input file, it will be memory mapped by the G-code viewer.
         // Make a copy.
         path = src_path + ".pp";
@@ -243,7 +417,7 @@ bool run_post_process_scripts(std::string &src_path, bool make_copy, const std::
     };
 
     auto gcode_file = boost::filesystem::path(path);
-    if (! boost::filesystem::exists(gcode_file))
+    if (! boost::filesystem::exists(filter_makes_copy ? boost::filesystem::path(src_path) : gcode_file))
         throw Slic3r::RuntimeError(std::string("Post-processor can't find exported gcode file"));
 
     // Store print configuration into environment variables.
@@ -268,33 +442,54 @@ bool run_post_process_scripts(std::string &src_path, bool make_copy, const std::
     remove_output_name_file();
 
     try {
-        for (const std::string &scripts : post_process->values) {
-    		std::vector<std::string> lines;
-    		boost::split(lines, scripts, boost::is_any_of("\r\n"));
-            for (std::string script : lines) {
-                // Ignore empty post processing script lines.
-                boost::trim(script);
-                if (script.empty())
-                    continue;
-                BOOST_LOG_TRIVIAL(info) << "Executing script " << script << " on file " << path;
+        for (size_t i = 0; i < scripts.size();) {
+            if (is_filter_script(scripts[i])) {
+                // Consecutive filter scripts are chained through pipes and run at once.
+                const bool               writes_copy = filter_makes_copy && i == 0;
+                std::vector<std::string> filters;
+                for (; i < scripts.size() && is_filter_script(scripts[i]); ++ i)
+                    filters.emplace_back(filter_script_command(scripts[i]));
+                const std::string  in_path     = writes_copy ? src_path : path;
+                const std::string  out_path    = writes_copy ? path : path + ".filtered";
+                BOOST_LOG_TRIVIAL(info) << "Executing filter scripts " << boost::join(filters, " | ") << " on file " << in_path;
                 std::string std_err;
-                const int result = run_script(script, gcode_file.string(), std_err);
+                size_t      failed_script = 0;
+                const int   result        = run_filter_scripts(filters, in_path, out_path, failed_script, std_err);
                 if (result != 0) {
+                    const std::string &script = filters[failed_script];
                     const std::string msg = std_err.empty() ? (boost::format("Post-processing script %1% on file %2% failed.\nError code: %3%") % script % path % result).str()
                         : (boost::format("Post-processing script %1% on file %2% failed.\nError code: %3%\nOutput:\n%4%") % script % path % result % std_err).str();
                     BOOST_LOG_TRIVIAL(error) << msg;
+                    if (! writes_copy) {
+                        boost::system::error_code ec;
+                        boost::filesystem::remove(out_path, ec);
+                    }
                     delete_copy();
                     throw Slic3r::RuntimeError(msg);
                 }
-                if (! boost::filesystem::exists(gcode_file)) {
-                    const std::string msg = (boost::format(_u8L(
-                        "Post-processing script %1% failed.\n\n"
-                        "The post-processing script is expected to change the G-code file %2% in place, but the G-code file was deleted and likely saved under a new name.\n"
-                        "Please adjust the post-processing script to change the G-code in place and consult the manual on how to optionally rename the post-processed G-code file.\n"))
-                        % script % path).str();
-                    BOOST_LOG_TRIVIAL(error) << msg;
-                    throw Slic3r::RuntimeError(msg);
-                }
+                if (! writes_copy)
+                    boost::filesystem::rename(out_path, path);
+                continue;
+            }
+            const std::string &script = scripts[i ++];
+            BOOST_LOG_TRIVIAL(info) << "Executing script " << script << " on file " << path;
+            std::string std_err;
+            const int result = run_script(script, gcode_file.string(), std_err);
+            if (result != 0) {
+                const std::string msg = std_err.empty() ? (boost::format("Post-processing script %1% on file %2% failed.\nError code: %3%") % script % path % result).str()
+                    : (boost::format("Post-processing script %1% on file %2% failed.\nError code: %3%\nOutput:\n%4%") % script % path % result % std_err).str();
+                BOOST_LOG_TRIVIAL(error) << msg;
+                delete_copy();
+                throw Slic3r::RuntimeError(msg);
+            }
+            if (! boost::filesystem::exists(gcode_file)) {
+                const std::string msg = (boost::format(_u8L(
+                    "Post-processing script %1% failed.\n\n"
+                    "The post-processing script is expected to change the G-code file %2% in place, but the G-code file was deleted and likely saved under a new name.\n"
+                    "Please adjust the post-processing script to change the G-code in place and consult the manual on how to optionally rename the post-processed G-code file.\n"))
+                    % script % path).str();
+                BOOST_LOG_TRIVIAL(error) << msg;
+                throw Slic3r::RuntimeError(msg);
             }
         }
         if (boost::filesystem::exists(path_output_name)) {
@@ -6,11 +6,13 @@
 #include <memory.h>
 #include <cstring>
 #include <cfloat>
+#include <string_view>
 
 #include "../libslic3r.h"
 #include "../PrintConfig.hpp"
 #include "../LocalesUtils.hpp"
 #include "../GCode.hpp"
+#include "../ProfilerTracy.hpp"
 
 #include "PressureEqualizer.hpp"
 #include "fast_float/fast_float.h"
@@ -106,6 +108,7 @@ void PressureEqualizer::process_layer(const std::string &gcode)
 
 LayerResult PressureEqualizer::process_layer(LayerResult &&input)
 {
+    SLIC3R_PROFILE_ZONE();
     const bool   is_first_layer       = m_layer_results.empty();
     const size_t next_layer_first_idx = m_gcode_lines.size();
 
@@ -129,7 +132,7 @@ LayerResult PressureEqualizer::process_layer(LayerResult &&input)
     m_gcode_lines.erase(m_gcode_lines.begin(), m_gcode_lines.begin() + int(next_layer_first_idx));
 
     if (output_buffer_length > 0)
-        prev_layer_result->gcode = std::string(output_buffer.data());
+        prev_layer_result->gcode = std::string(output_buffer.data(), output_buffer_length);
 
     assert(!input.nop_layer_result || m_layer_results.empty());
     LayerResult out = *prev_layer_result;
@@ -218,9 +221,11 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
     buf.max_volumetric_extrusion_rate_slope_negative = 0.f;
 	buf.extrusion_role = m_current_extrusion_role;
 
-    std::string str_line(line, line_end);
-    const bool found_extrude_set_speed_tag = boost::contains(str_line, EXTRUDE_SET_SPEED_TAG);
-    const bool found_extrude_end_tag = boost::contains(str_line, EXTRUDE_END_TAG);
+    // The tags are placed in the comment of the line, search them there without copying the line.
+    std::string_view comment(line, len);
+    comment = comment.substr(std::min(comment.find(';'), len));
+    const bool found_extrude_set_speed_tag = boost::contains(comment, EXTRUDE_SET_SPEED_TAG);
+    const bool found_extrude_end_tag = boost::contains(comment, EXTRUDE_END_TAG);
     assert(!found_extrude_set_speed_tag || !found_extrude_end_tag);
 
     if (found_extrude_set_speed_tag)
@@ -683,7 +688,7 @@ inline void PressureEqualizer::push_to_output(const char *text, const size_t len
     output_buffer[output_buffer_length] = 0;
 }
 
-inline bool is_just_line_with_extrude_set_speed_tag(const std::string &line)
+inline bool is_just_line_with_extrude_set_speed_tag(std::string_view line)
 {
     if (line.empty() && !boost::starts_with(line, "G1 ") && !boost::ends_with(line, EXTRUDE_SET_SPEED_TAG))
         return false;
@@ -706,8 +711,8 @@ void PressureEqualizer::push_line_to_output(const size_t line_idx, const float n
 {
     const GCodeLine &line = m_gcode_lines[line_idx];
     if (line_idx > 0 && output_buffer_length > 0) {
-        const std::string prev_line_str = std::string(output_buffer.begin() + int(this->output_buffer_prev_length),
-                                                      output_buffer.begin() + int(this->output_buffer_length) + 1);
+        const std::string_view prev_line_str(output_buffer.data() + this->output_buffer_prev_length,
+                                             this->output_buffer_length + 1 - this->output_buffer_prev_length);
         if (is_just_line_with_extrude_set_speed_tag(prev_line_str))
             this->output_buffer_length = this->output_buffer_prev_length; // Remove the last line because it only sets the speed for an empty block of g-code lines, so it is useless.
         else
@@ -160,6 +160,7 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                     &raycasting_tree, &result, &samples](tbb::blocked_range<size_t> r) {
                 // Maintaining hits memory outside of the loop, so it does not have to be reallocated for each query.
                 std::vector<igl::Hit> hits;
+                std::vector<Vec3d> ray_dirs;
                 for (size_t s_idx = r.begin(); s_idx < r.end(); ++s_idx) {
                     result[s_idx] = 1.0f;
                     constexpr float decrease_step = 1.0f
@@ -171,49 +172,56 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                     Frame f;
                     f.set_from_z(normal);
 
-                    for (const auto &dir : precomputed_sample_directions) {
-                        Vec3f final_ray_dir = (f.to_world(dir));
-                        if (!model_contains_negative_parts) {
-                            igl::Hit hitpoint;
-                            // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                            // direction.
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            bool hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices,
-                                    triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
-                            if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) {
+                    if (!model_contains_negative_parts) {
+                        // All rays of a sample start at the same point, thus they are cast together as a packet,
+                        // traversing the AABB tree once.
+                        // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
+                        // direction.
+                        ray_dirs.clear();
+                        for (const auto &dir : precomputed_sample_directions)
+                            ray_dirs.emplace_back(f.to_world(dir).cast<double>());
+                        Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                        AABBTreeIndirect::intersect_rays_first_hit(triangles.vertices,
+                                triangles.indices, raycasting_tree, ray_origin_d, ray_dirs, hits);
+                        for (size_t ray_idx = 0; ray_idx < ray_dirs.size(); ++ray_idx)
+                            if (const igl::Hit &hitpoint = hits[ray_idx];
+                                hitpoint.id != -1 && its_face_normal(triangles, hitpoint.id).dot(ray_dirs[ray_idx].cast<float>()) <= 0) {
                                 result[s_idx] -= decrease_step;
                             }
-                        } else { //TODO improve logic for order based boolean operations - consider order of volumes
-                            bool casting_from_negative_volume = samples.triangle_indices[s_idx]
-                                    >= negative_volumes_start_index;
-
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
-                                final_ray_dir = -1.0 * final_ray_dir;
-                                ray_origin_d = (center - normal * 0.01f).cast<double>();
-                            }
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
-                                    triangles.indices, raycasting_tree,
-                                    ray_origin_d, final_ray_dir_d, hits);
-                            if (some_hit) {
-                                int counter = 0;
-                                // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
-                                //  It cannot be inside model, and it cannot be inside negative volume
-                                for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
-                                    Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
-                                    if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
-                                        counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
-                                        // which in reverse hit analysis means, that we are entering negative space :) and vice versa
-                                    } else {
-                                        counter += sgn(face_normal.dot(final_ray_dir));
-                                    }
-                                }
-                                if (counter == 0) {
-                                    result[s_idx] -= decrease_step;
+                        continue;
+                    }
+
+                    for (const auto &dir : precomputed_sample_directions) {
+                        Vec3f final_ray_dir = (f.to_world(dir));
+                        //TODO improve logic for order based boolean operations - consider order of volumes
+                        bool casting_from_negative_volume = samples.triangle_indices[s_idx]
+                                >= negative_volumes_start_index;
+
+                        Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                        if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
+                            final_ray_dir = -1.0 * final_ray_dir;
+                            ray_origin_d = (center - normal * 0.01f).cast<double>();
+                        }
+                        Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
+                        bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
+                                triangles.indices, raycasting_tree,
+                                ray_origin_d, final_ray_dir_d, hits);
+                        if (some_hit) {
+                            int counter = 0;
+                            // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
+                            //  It cannot be inside model, and it cannot be inside negative volume
+                            for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
+                                Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
+                                if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
+                                    counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
+                                    // which in reverse hit analysis means, that we are entering negative space :) and vice versa
+                                } else {
+                                    counter += sgn(face_normal.dot(final_ray_dir));
                                 }
                             }
+                            if (counter == 0) {
+                                result[s_idx] -= decrease_step;
+                            }
                         }
                     }
                 }
@@ -1008,7 +1016,7 @@ void pick_random_seam_point(const std::vector<SeamCandidate> &perimeter_points,
 // Store results in the SeamPlacer variables m_seam_per_object
 void SeamPlacer::gather_seam_candidates(const PrintObject *po, const SeamPlacerImpl::GlobalModelInfo &global_model_info) {
     using namespace SeamPlacerImpl;
-    PrintObjectSeamData &seam_data = m_seam_per_object.emplace(po, PrintObjectSeamData { }).first->second;
+    PrintObjectSeamData &seam_data = *m_seam_per_object.emplace(po, std::make_shared<PrintObjectSeamData>()).first->second;
     seam_data.layers.resize(po->layer_count());
 
     tbb::parallel_for(tbb::blocked_range<size_t>(0, po->layers().size()),
@@ -1038,7 +1046,7 @@ void SeamPlacer::calculate_candidates_visibility(const PrintObject *po,
         const SeamPlacerImpl::GlobalModelInfo &global_model_info) {
     using namespace SeamPlacerImpl;
 
-    std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+    std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po]->layers;
     tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
             [&layers, &global_model_info](tbb::blocked_range<size_t> r) {
                 for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
@@ -1054,7 +1062,7 @@ void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po)
     using namespace SeamPlacerImpl;
     using PerimeterDistancer = AABBTreeLines::LinesDistancer<Linef>;
 
-    std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+    std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po]->layers;
     tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
             [po, &layers](tbb::blocked_range<size_t> r) {
                 std::unique_ptr<PerimeterDistancer> prev_layer_distancer;
@@ -1169,7 +1177,7 @@ std::optional<std::pair<size_t, size_t>> SeamPlacer::find_next_seam_in_layer(
 
 std::vector<std::pair<size_t, size_t>> SeamPlacer::find_seam_string(const PrintObject *po,
         std::pair<size_t, size_t> start_seam, const SeamPlacerImpl::SeamComparator &comparator) const {
-    const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.find(po)->second.layers;
+    const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.find(po)->second->layers;
     int layer_idx = start_seam.first;
 
     //initialize searching for seam string - cluster of nearby seams on previous and next layers
@@ -1249,7 +1257,7 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
 #endif
 
     //gather vector of all seams on the print_object - pair of layer_index and seam__index within that layer
-    const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+    const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po]->layers;
     std::vector<std::pair<size_t, size_t>> seams;
     for (size_t layer_idx = 0; layer_idx < layers.size(); ++layer_idx) {
         const std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
@@ -1416,13 +1424,20 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
 
 }
 
-void SeamPlacer::init(const Print &print, std::function<void(void)> throw_if_canceled_func) {
+void SeamPlacer::init(Print &print, std::function<void(void)> throw_if_canceled_func) {
     using namespace SeamPlacerImpl;
     m_seam_per_object.clear();
 
-    for (const PrintObject *po : print.objects()) {
+    for (PrintObject *po : print.objects_mutable()) {
         throw_if_canceled_func();
         SeamPosition configured_seam_preference = po->config().seam_position.value;
+        if (const std::shared_ptr<PrintObjectSeamData> &seam_data = po->seam_data();
+            seam_data && seam_data->seam_position == configured_seam_preference) {
+            // Neither the perimeters nor the painted seams changed since the last G-code export.
+            BOOST_LOG_TRIVIAL(debug) << "SeamPlacer: reusing seam data of " << po->model_object()->name;
+            m_seam_per_object.emplace(po, seam_data);
+            continue;
+        }
         SeamComparator comparator { configured_seam_preference };
 
         {
@@ -1458,7 +1473,7 @@ void SeamPlacer::init(const Print &print, std::function<void(void)> throw_if_can
             BOOST_LOG_TRIVIAL(debug)
             << "SeamPlacer: pick_seam_point : start";
             //pick seam point
-            std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+            std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po]->layers;
             tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
                     [&layers, configured_seam_preference, comparator](tbb::blocked_range<size_t> r) {
                         for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
@@ -1484,8 +1499,10 @@ void SeamPlacer::init(const Print &print, std::function<void(void)> throw_if_can
         }
 
 #ifdef DEBUG_FILES
-        debug_export_points(m_seam_per_object[po].layers, po->bounding_box(), comparator);
+        debug_export_points(m_seam_per_object[po]->layers, po->bounding_box(), comparator);
 #endif
+        m_seam_per_object[po]->seam_position = configured_seam_preference;
+        po->set_seam_data(m_seam_per_object[po]);
     }
 }
 
@@ -1511,7 +1528,7 @@ Point SeamPlacer::place_seam(const Layer *layer, const ExtrusionLoop &loop, bool
     };
 
     const PrintObjectSeamData::LayerSeams &layer_perimeters =
-            m_seam_per_object.find(layer->object())->second.layers[layer_index];
+            m_seam_per_object.find(layer->object())->second->layers[layer_index];
 
     // Find the closest perimeter in the SeamPlacer to this loop.
     // Repeat search until two consecutive points of the loop are found, that result in the same closest_perimeter
@@ -103,6 +103,9 @@ struct PrintObjectSeamData
     std::vector<LayerSeams> layers;
     // Map of PrintObjects (PO) -> vector of layers of PO -> unique_ptr to KD
     // tree of all points of the given layer
+    // Seam position the seam points were picked for. The seam position only invalidates the G-code export,
+    // thus the data retained by PrintObject is only reused if the seam position did not change.
+    SeamPosition seam_position { spAligned };
 
     void clear()
     {
@@ -141,9 +144,12 @@ public:
     static constexpr size_t seam_align_mm_per_segment = 4.0f;
 
     //The following data structures hold all perimeter points for all PrintObject.
-    std::unordered_map<const PrintObject*, PrintObjectSeamData> m_seam_per_object;
+    //The data are shared with PrintObject::seam_data() to be reused by the next G-code export.
+    std::unordered_map<const PrintObject*, std::shared_ptr<PrintObjectSeamData>> m_seam_per_object;
 
-    void init(const Print &print, std::function<void(void)> throw_if_canceled_func);
+    // Reuses the seam data of PrintObjects, which were not invalidated since the last G-code export,
+    // computes the seam data of the other PrintObjects and stores it to them.
+    void init(Print &print, std::function<void(void)> throw_if_canceled_func);
 
     Point place_seam(const Layer *layer, const ExtrusionLoop &loop, bool external_first, const Point &last_pos) const;
 
@@ -3,6 +3,9 @@
 #include "../ExtrusionEntity.hpp"
 #include "../ExtrusionEntityCollection.hpp"
 
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
 namespace Slic3r::GCode {
 
 // Length of a smooth path.
@@ -133,7 +136,7 @@ double clip_end(SmoothPath &path, double distance, double min_point_distance_thr
     return distance;
 }
 
-void SmoothPathCache::interpolate_add(const ExtrusionPath &path, const InterpolationParameters &params)
+static double interpolation_tolerance(const ExtrusionPath &path, const SmoothPathCache::InterpolationParameters &params)
 {
     double tolerance = params.tolerance;
     if (path.role().is_sparse_infill())
@@ -146,7 +149,12 @@ void SmoothPathCache::interpolate_add(const ExtrusionPath &path, const Interpola
         // Brim is currently marked as skirt.
         // Use 4x lower resolution than the object fine detail for skirt & brim.
         tolerance *= 4.;
-    m_cache[&path.polyline] = Slic3r::Geometry::ArcWelder::fit_path(path.polyline.points, tolerance, params.fit_circle_tolerance);
+    return tolerance;
+}
+
+void SmoothPathCache::interpolate_add(const ExtrusionPath &path, const InterpolationParameters &params)
+{
+    m_cache[&path.polyline] = Slic3r::Geometry::ArcWelder::fit_path(path.polyline.points, interpolation_tolerance(path, params), params.fit_circle_tolerance);
 }
 
 void SmoothPathCache::interpolate_add(const ExtrusionMultiPath &multi_path, const InterpolationParameters &params)
@@ -162,16 +170,39 @@ void SmoothPathCache::interpolate_add(const ExtrusionLoop &loop, const Interpola
 }
 
 void SmoothPathCache::interpolate_add(const ExtrusionEntityCollection &eec, const InterpolationParameters &params)
+{
+    std::vector<const ExtrusionPath*> paths;
+    collect_paths(eec, paths);
+    this->interpolate_add(paths, params);
+}
+
+void SmoothPathCache::interpolate_add(const std::vector<const ExtrusionPath*> &paths, const InterpolationParameters &params)
+{
+    // Fitting of the paths is independent, only the cache is updated serially.
+    std::vector<Geometry::ArcWelder::Path> fitted(paths.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, paths.size(), 16),
+        [&paths, &params, &fitted](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                fitted[i] = Slic3r::Geometry::ArcWelder::fit_path(paths[i]->polyline.points, interpolation_tolerance(*paths[i], params), params.fit_circle_tolerance);
+        });
+    m_cache.reserve(m_cache.size() + paths.size());
+    for (size_t i = 0; i < paths.size(); ++ i)
+        m_cache[&paths[i]->polyline] = std::move(fitted[i]);
+}
+
+void SmoothPathCache::collect_paths(const ExtrusionEntityCollection &eec, std::vector<const ExtrusionPath*> &out)
 {
     for (const ExtrusionEntity *ee : eec) {
         if (ee->is_collection())
-            this->interpolate_add(*static_cast<const ExtrusionEntityCollection*>(ee), params);
+            collect_paths(*static_cast<const ExtrusionEntityCollection*>(ee), out);
         else if (const ExtrusionPath *path = dynamic_cast<const ExtrusionPath*>(ee); path)
-            this->interpolate_add(*path, params);
+            out.emplace_back(path);
         else if (const ExtrusionMultiPath *multi_path = dynamic_cast<const ExtrusionMultiPath*>(ee); multi_path)
-            this->interpolate_add(*multi_path, params);
+            for (const ExtrusionPath &path : multi_path->paths)
+                out.emplace_back(&path);
         else if (const ExtrusionLoop *loop = dynamic_cast<const ExtrusionLoop*>(ee); loop)
-            this->interpolate_add(*loop, params);
+            for (const ExtrusionPath &path : loop->paths)
+                out.emplace_back(&path);
         else
             assert(false);
     }
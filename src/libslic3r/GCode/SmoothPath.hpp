@@ -45,6 +45,10 @@ public:
     void interpolate_add(const ExtrusionMultiPath        &ee,  const InterpolationParameters &params);
     void interpolate_add(const ExtrusionLoop             &ee,  const InterpolationParameters &params);
     void interpolate_add(const ExtrusionEntityCollection &eec, const InterpolationParameters &params);
+    // Fit the paths in parallel.
+    void interpolate_add(const std::vector<const ExtrusionPath*> &paths, const InterpolationParameters &params);
+    // Collect the paths of an extrusion entity collection recursively to be fitted at once by interpolate_add().
+    static void collect_paths(const ExtrusionEntityCollection &eec, std::vector<const ExtrusionPath*> &out);
 
     const Geometry::ArcWelder::Path* resolve(const Polyline      *pl) const;
     const Geometry::ArcWelder::Path* resolve(const ExtrusionPath &path) const;
@@ -8,12 +8,22 @@
 ///|/
 #include "SpiralVase.hpp"
 #include "GCode.hpp"
+#include "GCodeWriter.hpp"
+#include "ProfilerTracy.hpp"
+#include <optional>
 #include <sstream>
 
 namespace Slic3r {
 
+namespace {
+    inline bool is_end_of_word(char c) { return c == ' ' || c == '\t' || c == ';' || c == '\r' || c == '\n' || c == 0; }
+    inline const char* skip_whitespaces(const char *c, const char *end) { for (; c != end && (*c == ' ' || *c == '\t'); ++ c) ; return c; }
+    inline const char* skip_word(const char *c, const char *end) { for (; c != end && ! is_end_of_word(*c); ++ c) ; return c; }
+} // namespace
+
 std::string SpiralVase::process_layer(const std::string &gcode)
 {
+    SLIC3R_PROFILE_ZONE();
     /*  This post-processor relies on several assumptions:
         - all layers are processed through it, including those that are not supposed
           to be transformed, in order to update the reader with the XY positions
@@ -29,19 +39,21 @@ std::string SpiralVase::process_layer(const std::string &gcode)
         return gcode;
     }
     
-    // Get total XY length for this layer by summing all extrusion moves.
+    // Parse the layer once into a list of moves, get total XY length for this layer by summing all extrusion moves.
     float total_layer_length = 0;
     float layer_height = 0;
     float z = 0.f;
     
     {
-        //FIXME Performance warning: This copies the GCodeConfig of the reader.
-        GCodeReader r = m_reader;  // clone
         bool set_z = false;
-        r.parse_buffer(gcode, [&total_layer_length, &layer_height, &z, &set_z]
+        m_moves.clear();
+        m_reader.parse_buffer(gcode, [this, &total_layer_length, &layer_height, &z, &set_z]
             (GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+            Move &move = m_moves.emplace_back();
+            move.raw = line.raw();
             if (line.cmd_is("G1")) {
-                if (line.extruding(reader)) {
+                bool extruding = line.extruding(reader);
+                if (extruding) {
                     total_layer_length += line.dist_XY(reader);
                 } else if (line.has(Z)) {
                     layer_height += line.dist_Z(reader);
@@ -50,14 +62,23 @@ std::string SpiralVase::process_layer(const std::string &gcode)
                         set_z = true;
                     }
                 }
+                if (line.has_z()) {
+                    move.type = Move::Type::ZMove;
+                } else if (float dist_XY = line.dist_XY(reader); dist_XY > 0) {
+                    move.type    = extruding ? Move::Type::Extrude : Move::Type::Travel;
+                    move.dist_XY = dist_XY;
+                    move.has_e   = line.has(E);
+                    move.e       = line.value(E);
+                }
             }
         });
     }
     
-    // Remove layer height from initial Z.
+    // Remove layer height from initial Z.
     z -= layer_height;
     
     std::string new_gcode;
+    new_gcode.reserve(gcode.size() + gcode.size() / 8);
     //FIXME Tapering of the transition layer only works reliably with relative extruder distances.
     // For absolute extruder distances it will be switched off.
     // Tapering the absolute extruder distances requires to process every extrusion value after the first transition
@@ -65,39 +86,74 @@ std::string SpiralVase::process_layer(const std::string &gcode)
     bool  transition = m_transition_layer && m_config.use_relative_e_distances.value;
     float layer_height_factor = layer_height / total_layer_length;
     float len = 0.f;
-    m_reader.parse_buffer(gcode, [&new_gcode, &z, total_layer_length, layer_height_factor, transition, &len]
-        (GCodeReader &reader, GCodeReader::GCodeLine line) {
-        if (line.cmd_is("G1")) {
-            if (line.has_z()) {
-                // If this is the initial Z move of the layer, replace it with a
-                // (redundant) move to the last Z of previous layer.
-                line.set(reader, Z, z);
-                new_gcode += line.raw() + '\n';
-                return;
+    // Z of the last emitted line, which the reader continues from with the next layer.
+    std::optional<float> last_z;
+    const char extrusion_axis = m_reader.extrusion_axis();
+    // Emit the G1 line with the Z and optionally E values replaced, the other words are copied verbatim.
+    auto emit_g1 = [&new_gcode, extrusion_axis](std::string_view raw, float new_z, const float *new_e) {
+        GCodeG1Formatter out;
+        bool z_done = false;
+        // Skip the G1 command.
+        const char *end = raw.data() + raw.size();
+        const char *c   = skip_word(skip_whitespaces(raw.data(), end), end);
+        while (c != end && *c != ';') {
+            c = skip_whitespaces(c, end);
+            if (c == end || *c == ';')
+                break;
+            const char *word_end = skip_word(c, end);
+            if (*c == 'Z') {
+                out.emit_z(new_z);
+                z_done = true;
+            } else if (new_e && *c == extrusion_axis) {
+                out.emit_e(std::string_view(&extrusion_axis, 1), *new_e);
             } else {
-                float dist_XY = line.dist_XY(reader);
-                if (dist_XY > 0) {
-                    // horizontal move
-                    if (line.extruding(reader)) {
-                        len += dist_XY;
-                        line.set(reader, Z, z + len * layer_height_factor);
-                        if (transition && line.has(E))
-                            // Transition layer, modulate the amount of extrusion from zero to the final value.
-                            line.set(reader, E, line.value(E) * len / total_layer_length);
-                        new_gcode += line.raw() + '\n';
-                    }
-                    return;
-                
-                    /*  Skip travel moves: the move to first perimeter point will
-                        cause a visible seam when loops are not aligned in XY; by skipping
-                        it we blend the first loop move in the XY plane (although the smoothness
-                        of such blend depend on how long the first segment is; maybe we should
-                        enforce some minimum length?).  */
-                }
+                out.emit_string(" ");
+                out.emit_string(std::string_view(c, word_end - c));
             }
+            c = word_end;
         }
-        new_gcode += line.raw() + '\n';
-    });
+        if (! z_done)
+            out.emit_z(new_z);
+        if (c != end) {
+            out.emit_string(" ");
+            out.emit_string(std::string_view(c, end - c));
+        }
+        out.append_to(new_gcode);
+    };
+    for (const Move &move : m_moves) {
+        switch (move.type) {
+        case Move::Type::ZMove:
+            // If this is the initial Z move of the layer, replace it with a
+            // (redundant) move to the last Z of previous layer.
+            emit_g1(move.raw, z, nullptr);
+            last_z = z;
+            break;
+        case Move::Type::Extrude:
+        {
+            len += move.dist_XY;
+            float new_z = z + len * layer_height_factor;
+            // Transition layer, modulate the amount of extrusion from zero to the final value.
+            float new_e = move.e * len / total_layer_length;
+            emit_g1(move.raw, new_z, transition && move.has_e ? &new_e : nullptr);
+            last_z = new_z;
+            break;
+        }
+        case Move::Type::Travel:
+            /*  Skip travel moves: the move to first perimeter point will
+                cause a visible seam when loops are not aligned in XY; by skipping
+                it we blend the first loop move in the XY plane (although the smoothness
+                of such blend depend on how long the first segment is; maybe we should
+                enforce some minimum length?).  */
+            break;
+        case Move::Type::Other:
+            new_gcode += move.raw;
+            new_gcode += '\n';
+            break;
+        }
+    }
+    if (last_z)
+        m_reader.z() = *last_z;
+    m_moves.clear();
     
     return new_gcode;
 }
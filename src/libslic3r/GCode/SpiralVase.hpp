@@ -30,8 +30,29 @@ public:
     std::string process_layer(const std::string &gcode);
     
 private:
+    // Line of the layer G-code, as parsed by the single pass over the layer.
+    struct Move {
+        enum class Type : unsigned char {
+            // Copied verbatim.
+            Other,
+            // G1 with Z, the Z is replaced.
+            ZMove,
+            // Extruding horizontal G1, Z is interpolated, E is modulated on the transition layer.
+            Extrude,
+            // Travel in the XY plane, dropped.
+            Travel,
+        };
+        std::string_view raw;
+        Type             type { Type::Other };
+        float            dist_XY { 0.f };
+        float            e { 0.f };
+        bool             has_e { false };
+    };
+
     const PrintConfig  &m_config;
     GCodeReader 		m_reader;
+    // Reused by process_layer() to not reallocate for each layer.
+    std::vector<Move>   m_moves;
 
     bool 				m_enabled = false;
     // First spiral vase layer. Layer height has to be ramped up from zero to the target layer height.
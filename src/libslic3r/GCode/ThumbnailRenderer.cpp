@@ -0,0 +1,274 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "ThumbnailRenderer.hpp"
+
+#include "../BoundingBox.hpp"
+#include "../Color.hpp"
+#include "../Model.hpp"
+#include "../PrintConfig.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include <tbb/parallel_for.h>
+
+namespace Slic3r::GCodeThumbnails {
+
+// Lighting of the "gouraud_light" shader of the 3D scene, the light directions are in the camera space.
+static const Vec3f  light_top_dir        { -0.4574957f, 0.4574957f, 0.7624929f };
+static const Vec3f  light_front_dir      { 0.6985074f, 0.1397015f, 0.6985074f };
+static constexpr float intensity_correction = 0.6f;
+static constexpr float light_top_diffuse    = 0.8f * intensity_correction;
+static constexpr float light_top_specular   = 0.125f * intensity_correction;
+static constexpr float light_top_shininess  = 20.f;
+static constexpr float light_front_diffuse  = 0.3f * intensity_correction;
+static constexpr float intensity_ambient    = 0.3f;
+
+// Margin around the model, see Camera::DefaultZoomToBoxMarginFactor.
+static constexpr double margin_factor = 1.025;
+// The model is rendered at this multiple of the resolution of the largest thumbnail to antialias the edges.
+static constexpr double supersampling = 3.;
+static constexpr int    max_resolution = 4096;
+static constexpr int    band_height = 16;
+
+namespace {
+
+struct RenderTriangle {
+    // x, y in pixels of the rendered image, z growing towards the camera.
+    std::array<Vec3f, 3>            vertices;
+    std::array<unsigned char, 3>    color;
+};
+
+// RGBA image with premultiplied alpha, rows stored from the bottom like the OpenGL frame buffer.
+struct Image {
+    int                         width  { 0 };
+    int                         height { 0 };
+    std::vector<unsigned char>  pixels;
+};
+
+} // namespace
+
+static ColorRGB extruder_color(const DynamicPrintConfig &config, int extruder_id)
+{
+    ColorRGB color = ColorRGB::ORANGE();
+    size_t   idx   = size_t(std::max(extruder_id, 1) - 1);
+    for (const char *opt_key : { "extruder_colour", "filament_colour" })
+        if (auto *opt = config.option<ConfigOptionStrings>(opt_key); opt != nullptr && idx < opt->values.size() && decode_color(opt->values[idx], color))
+            break;
+    return color;
+}
+
+static std::array<unsigned char, 3> shade(const ColorRGB &color, const Vec3f &normal)
+{
+    // Orthographic view, the camera looks in the -Z direction of the camera space.
+    const Vec3f reflected = 2.f * normal.dot(light_top_dir) * normal - light_top_dir;
+    const float specular  = light_top_specular * std::pow(std::max(reflected.z(), 0.f), light_top_shininess);
+    const float diffuse   = intensity_ambient + std::max(normal.dot(light_top_dir), 0.f) * light_top_diffuse +
+                            std::max(normal.dot(light_front_dir), 0.f) * light_front_diffuse;
+    std::array<unsigned char, 3> out;
+    for (size_t i = 0; i < 3; ++ i)
+        out[i] = (unsigned char)std::clamp(std::lround(255.f * (specular + color.data()[i] * diffuse)), 0l, 255l);
+    return out;
+}
+
+// Triangles of the model parts facing the camera transformed by view.
+static std::vector<RenderTriangle> collect_triangles(const Model &model, const DynamicPrintConfig &config, const ThumbnailsParams &params, const Transform3d &view)
+{
+    std::vector<RenderTriangle> out;
+    for (const ModelObject *object : model.objects)
+        for (const ModelInstance *instance : object->instances) {
+            if (params.printable_only && ! instance->is_printable())
+                continue;
+            for (const ModelVolume *volume : object->volumes) {
+                if (! volume->is_model_part())
+                    continue;
+                const ColorRGB              color    = extruder_color(config, volume->extruder_id());
+                const Transform3f           trafo    = (view * instance->get_matrix() * volume->get_matrix()).cast<float>();
+                const bool                  mirrored = trafo.matrix().block<3, 3>(0, 0).determinant() < 0;
+                const indexed_triangle_set &its      = volume->mesh().its;
+                std::vector<RenderTriangle> triangles(its.indices.size());
+                std::vector<char>           visible(its.indices.size(), false);
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size(), 1024), [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i < range.end(); ++ i) {
+                        RenderTriangle &triangle = triangles[i];
+                        for (size_t j = 0; j < 3; ++ j)
+                            triangle.vertices[j] = trafo * its.vertices[its.indices[i][j]];
+                        Vec3f normal = (triangle.vertices[1] - triangle.vertices[0]).cross(triangle.vertices[2] - triangle.vertices[0]);
+                        if (mirrored)
+                            normal = - normal;
+                        // Back face culling.
+                        if (float len = normal.norm(); len > 0.f && normal.z() > 0.f) {
+                            triangle.color = shade(color, normal / len);
+                            visible[i] = true;
+                        }
+                    }
+                });
+                for (size_t i = 0; i < triangles.size(); ++ i)
+                    if (visible[i])
+                        out.emplace_back(triangles[i]);
+            }
+        }
+    return out;
+}
+
+// Rasterize the triangles with a depth buffer, the horizontal bands of the image in parallel.
+static Image rasterize(const std::vector<RenderTriangle> &triangles, int width, int height)
+{
+    Image image;
+    image.width  = width;
+    image.height = height;
+    image.pixels.assign(size_t(width) * size_t(height) * 4, 0);
+
+    const int num_bands = (height + band_height - 1) / band_height;
+    std::vector<std::vector<uint32_t>> triangles_per_band(num_bands);
+    for (uint32_t i = 0; i < triangles.size(); ++ i) {
+        const auto &v = triangles[i].vertices;
+        float ymin = std::min({ v[0].y(), v[1].y(), v[2].y() });
+        float ymax = std::max({ v[0].y(), v[1].y(), v[2].y() });
+        int   band_min = std::clamp(int(std::floor(ymin)) / band_height, 0, num_bands - 1);
+        int   band_max = std::clamp(int(std::floor(ymax)) / band_height, 0, num_bands - 1);
+        for (int band = band_min; band <= band_max; ++ band)
+            triangles_per_band[band].emplace_back(i);
+    }
+
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_bands), [&](const tbb::blocked_range<int> &range) {
+        std::vector<float> depth;
+        for (int band = range.begin(); band < range.end(); ++ band) {
+            const int row_min = band * band_height;
+            const int row_max = std::min(row_min + band_height, height);
+            depth.assign(size_t(width) * size_t(row_max - row_min), std::numeric_limits<float>::lowest());
+            for (uint32_t triangle_idx : triangles_per_band[band]) {
+                const RenderTriangle &triangle = triangles[triangle_idx];
+                const Vec3d a = triangle.vertices[0].cast<double>();
+                const Vec3d b = triangle.vertices[1].cast<double>();
+                const Vec3d c = triangle.vertices[2].cast<double>();
+                const double area = (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+                if (area == 0.)
+                    continue;
+                auto edge = [](const Vec3d &p0, const Vec3d &p1, double x, double y) {
+                    return (p1.x() - p0.x()) * (y - p0.y()) - (p1.y() - p0.y()) * (x - p0.x());
+                };
+                // Pixel centers inside the bounding box of the triangle.
+                int x0 = std::max(0,           int(std::ceil (std::min({ a.x(), b.x(), c.x() }) - 0.5)));
+                int x1 = std::min(width - 1,   int(std::floor(std::max({ a.x(), b.x(), c.x() }) - 0.5)));
+                int y0 = std::max(row_min,     int(std::ceil (std::min({ a.y(), b.y(), c.y() }) - 0.5)));
+                int y1 = std::min(row_max - 1, int(std::floor(std::max({ a.y(), b.y(), c.y() }) - 0.5)));
+                for (int y = y0; y <= y1; ++ y)
+                    for (int x = x0; x <= x1; ++ x) {
+                        const double px = x + 0.5, py = y + 0.5;
+                        const double w0 = edge(b, c, px, py) / area;
+                        const double w1 = edge(c, a, px, py) / area;
+                        const double w2 = edge(a, b, px, py) / area;
+                        if (w0 < 0. || w1 < 0. || w2 < 0.)
+                            continue;
+                        const auto z = float(w0 * a.z() + w1 * b.z() + w2 * c.z());
+                        float &d = depth[size_t(y - row_min) * width + x];
+                        if (z > d) {
+                            d = z;
+                            unsigned char *pixel = &image.pixels[(size_t(y) * width + x) * 4];
+                            pixel[0] = triangle.color[0];
+                            pixel[1] = triangle.color[1];
+                            pixel[2] = triangle.color[2];
+                            pixel[3] = 255;
+                        }
+                    }
+            }
+        }
+    });
+    return image;
+}
+
+// Area weighted downsampling of the image scaled by scale and centered in a thumbnail of width x height.
+static ThumbnailData downsample(const Image &image, unsigned int width, unsigned int height, double scale, bool transparent_background)
+{
+    ThumbnailData out;
+    out.set(width, height);
+    const double offset_x = 0.5 * (width  - image.width  * scale);
+    const double offset_y = 0.5 * (height - image.height * scale);
+    for (unsigned int y = 0; y < height; ++ y)
+        for (unsigned int x = 0; x < width; ++ x) {
+            // Footprint of the thumbnail pixel in the image.
+            const double sx0 = std::max(0., (x - offset_x) / scale), sx1 = std::min(double(image.width),  (x + 1 - offset_x) / scale);
+            const double sy0 = std::max(0., (y - offset_y) / scale), sy1 = std::min(double(image.height), (y + 1 - offset_y) / scale);
+            std::array<double, 4> sum { 0., 0., 0., 0. };
+            for (int sy = int(sy0); sy < sy1; ++ sy)
+                for (int sx = int(sx0); sx < sx1; ++ sx) {
+                    const double         weight = (std::min(sx1, sx + 1.) - std::max(sx0, double(sx))) * (std::min(sy1, sy + 1.) - std::max(sy0, double(sy)));
+                    const unsigned char *pixel  = &image.pixels[(size_t(sy) * image.width + sx) * 4];
+                    for (size_t i = 0; i < 4; ++ i)
+                        sum[i] += weight * pixel[i];
+                }
+            // The part of the footprint outside of the image is background.
+            const double weight_sum = 1. / (scale * scale);
+            unsigned char *pixel = &out.pixels[(size_t(y) * width + x) * 4];
+            const double alpha = sum[3] / weight_sum;
+            if (transparent_background) {
+                // Un-premultiply.
+                for (size_t i = 0; i < 3; ++ i)
+                    pixel[i] = alpha > 0. ? (unsigned char)std::clamp(std::lround(255. * sum[i] / sum[3]), 0l, 255l) : 0;
+                pixel[3] = (unsigned char)std::clamp(std::lround(alpha), 0l, 255l);
+            } else {
+                // Blend over white.
+                for (size_t i = 0; i < 3; ++ i)
+                    pixel[i] = (unsigned char)std::clamp(std::lround(sum[i] / weight_sum + 255. - alpha), 0l, 255l);
+                pixel[3] = 255;
+            }
+        }
+    return out;
+}
+
+ThumbnailsList render_thumbnails(const Model &model, const DynamicPrintConfig &config, const ThumbnailsParams &params)
+{
+    // Default isometric view of the 3D scene, see Camera::set_default_orientation().
+    const Transform3d view { Eigen::AngleAxisd(- 0.25 * M_PI, Vec3d::UnitX()) * Eigen::AngleAxisd(0.25 * M_PI, Vec3d::UnitZ()) };
+    std::vector<RenderTriangle> triangles = collect_triangles(model, config, params, view);
+    if (triangles.empty())
+        return {};
+
+    BoundingBoxf3 bbox;
+    for (const RenderTriangle &triangle : triangles)
+        for (const Vec3f &v : triangle.vertices)
+            bbox.merge(v.cast<double>());
+    const Vec2d center = 0.5 * (bbox.min + bbox.max).head<2>();
+    const Vec2d size   = margin_factor * (bbox.max - bbox.min).head<2>().cwiseMax(Vec2d(EPSILON, EPSILON));
+
+    // Pixels per unit of the largest thumbnail, each thumbnail fits the model into its width and height.
+    std::vector<Vec2i> thumbnail_sizes;
+    double             max_scale = 0.;
+    for (const Vec2d &thumbnail_size : params.sizes) {
+        const Vec2i isize(int(std::lround(thumbnail_size.x())), int(std::lround(thumbnail_size.y())));
+        thumbnail_sizes.emplace_back(isize);
+        if (isize.x() > 0 && isize.y() > 0)
+            max_scale = std::max(max_scale, std::min(isize.x() / size.x(), isize.y() / size.y()));
+    }
+    if (max_scale == 0.)
+        return {};
+
+    double scale = supersampling * max_scale;
+    scale = std::min(scale, max_resolution / std::max(size.x(), size.y()));
+    const int width  = std::max(1, int(std::ceil(size.x() * scale)));
+    const int height = std::max(1, int(std::ceil(size.y() * scale)));
+    const Vec2d origin = center - 0.5 * Vec2d(width, height) / scale;
+    for (RenderTriangle &triangle : triangles)
+        for (Vec3f &v : triangle.vertices)
+            v.head<2>() = ((v.head<2>().cast<double>() - origin) * scale).cast<float>();
+
+    const Image image = rasterize(triangles, width, height);
+
+    ThumbnailsList out(thumbnail_sizes.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, thumbnail_sizes.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            if (const Vec2i &isize = thumbnail_sizes[i]; isize.x() > 0 && isize.y() > 0)
+                out[i] = downsample(image, isize.x(), isize.y(),
+                    std::min(isize.x() / size.x(), isize.y() / size.y()) / scale, params.transparent_background);
+    });
+    // Leave out the invalid thumbnails like the GUI does.
+    out.erase(std::remove_if(out.begin(), out.end(), [](const ThumbnailData &data) { return ! data.is_valid(); }), out.end());
+    return out;
+}
+
+} // namespace Slic3r::GCodeThumbnails
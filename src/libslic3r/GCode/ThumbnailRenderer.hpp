@@ -0,0 +1,27 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_GCode_ThumbnailRenderer_hpp_
+#define slic3r_GCode_ThumbnailRenderer_hpp_
+
+#include "ThumbnailData.hpp"
+
+namespace Slic3r {
+
+class DynamicPrintConfig;
+class Model;
+
+namespace GCodeThumbnails {
+
+// Software renderer of the thumbnails for the command line slicer, which has no OpenGL context.
+// The model parts are rendered with the default isometric view and the lighting of the 3D scene of the GUI
+// in the colors of their extruders, the bed is not rendered.
+// The model is rendered just once at a resolution sufficient for the largest of params.sizes,
+// the thumbnails of all the sizes are downsampled from that image.
+ThumbnailsList render_thumbnails(const Model &model, const DynamicPrintConfig &config, const ThumbnailsParams &params);
+
+} // namespace GCodeThumbnails
+} // namespace Slic3r
+
+#endif // slic3r_GCode_ThumbnailRenderer_hpp_
@@ -10,9 +10,13 @@
 #include <jpeglib.h>
 #include <jerror.h>
 
-#include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <string>
 
+#include <boost/algorithm/string.hpp>
+
+#include <tbb/parallel_for.h>
+
 namespace Slic3r::GCodeThumbnails {
 
 using namespace std::literals;
@@ -124,6 +128,38 @@ std::unique_ptr<CompressedImageBuffer> compress_thumbnail(const ThumbnailData &d
     }
 }
 
+std::vector<CompressedThumbnail> compress_thumbnails(ThumbnailsGeneratorCallback &thumbnail_cb, const GCodeThumbnailDefinitionsList &thumbnails_list)
+{
+    Vec2ds sizes;
+    sizes.reserve(thumbnails_list.size());
+    for (const auto &[format, size] : thumbnails_list)
+        sizes.emplace_back(size);
+    const ThumbnailsList thumbnails = thumbnail_cb(ThumbnailsParams{ sizes, true, true, true, true });
+
+    // The thumbnails, which failed to render, are missing in the list, pair the rest with their definitions by size.
+    std::vector<CompressedThumbnail> out(thumbnails_list.size());
+    std::vector<const ThumbnailData*> data(thumbnails_list.size(), nullptr);
+    for (size_t i = 0, j = 0; i < thumbnails_list.size() && j < thumbnails.size(); ++ i) {
+        const Point isize(thumbnails_list[i].second); // round to ints
+        if (thumbnails[j].width == (unsigned int)isize.x() && thumbnails[j].height == (unsigned int)isize.y())
+            data[i] = &thumbnails[j ++];
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, out.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            if (data[i] != nullptr && data[i]->is_valid()) {
+                CompressedThumbnail &thumbnail = out[i];
+                thumbnail.format = thumbnails_list[i].first;
+                thumbnail.width  = data[i]->width;
+                thumbnail.height = data[i]->height;
+                thumbnail.image  = compress_thumbnail(*data[i], thumbnail.format);
+            }
+    });
+    out.erase(std::remove_if(out.begin(), out.end(), [](const CompressedThumbnail &thumbnail) {
+        return ! thumbnail.image || thumbnail.image->data == nullptr || thumbnail.image->size == 0; }), out.end());
+    return out;
+}
+
 std::pair<GCodeThumbnailDefinitionsList, ThumbnailErrors> make_and_check_thumbnail_list(const std::string& thumbnails_string, const std::string_view def_ext /*= "PNG"sv*/)
 {
     if (thumbnails_string.empty())
@@ -21,6 +21,8 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include <libslic3r.h>
 
 namespace Slic3r {
@@ -242,7 +244,10 @@ void ToolOrdering::collect_extruders(const PrintObject &object, const std::vecto
 	it_per_layer_extruder_override = per_layer_extruder_switches.begin();
     unsigned int extruder_override = 0;
 
-    // Collect the object extruders.
+    // Assign the object layers to LayerTools and store their extruder overrides, so that the extruders
+    // of the object layers may be collected in parallel.
+    std::vector<LayerTools*> layers_tools;
+    layers_tools.reserve(object.layers().size());
     for (auto layer : object.layers()) {
         LayerTools &layer_tools = this->tools_for_layer(layer->print_z);
 
@@ -252,61 +257,91 @@ void ToolOrdering::collect_extruders(const PrintObject &object, const std::vecto
 
         // Store the current extruder override (set to zero if no overriden), so that layer_tools.wiping_extrusions().is_overridable_and_mark() will use it.
         layer_tools.extruder_override = extruder_override;
+        layers_tools.emplace_back(&layer_tools);
+    }
+
+    // Extruders required to print a single object layer, to be merged into its LayerTools.
+    struct LayerExtruders {
+        std::vector<unsigned int> extruders;
+        bool                      has_object            { false };
+        bool                      something_overridable { false };
+    };
+    std::vector<LayerExtruders> layers_extruders(object.layers().size());
+
+    // Collect the object extruders.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, object.layers().size()), [this, &object, &layers_tools, &layers_extruders](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            const Layer        *layer             = object.layers()[layer_idx];
+            const LayerTools   &layer_tools       = *layers_tools[layer_idx];
+            const unsigned int  extruder_override = layer_tools.extruder_override;
+            LayerExtruders     &out               = layers_extruders[layer_idx];
+
+            // What extruders are required to print this object layer?
+            for (const LayerRegion *layerm : layer->regions()) {
+                const PrintRegion &region = layerm->region();
+
+                if (! layerm->perimeters().empty()) {
+                    bool something_nonoverriddable = true;
+
+                    if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
+                        something_nonoverriddable = false;
+                        for (const ExtrusionEntity *eec : layerm->perimeters()) // let's check if there are nonoverriddable entities
+                            if (is_overriddable(dynamic_cast<const ExtrusionEntityCollection&>(*eec), layer_tools, *m_print_config_ptr, object, region))
+                                out.something_overridable = true;
+                            else
+                                something_nonoverriddable = true;
+                    }
 
-        // What extruders are required to print this object layer?
-        for (const LayerRegion *layerm : layer->regions()) {
-            const PrintRegion &region = layerm->region();
+                    if (something_nonoverriddable)
+                        out.extruders.emplace_back(extruder_override == 0 ? region.config().perimeter_extruder.value : extruder_override);
 
-            if (! layerm->perimeters().empty()) {
-                bool something_nonoverriddable = true;
+                    out.has_object = true;
+                }
 
-                if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
-                    something_nonoverriddable = false;
-                    for (const ExtrusionEntity *eec : layerm->perimeters()) // let's check if there are nonoverriddable entities
-                        if (is_overriddable(dynamic_cast<const ExtrusionEntityCollection&>(*eec), layer_tools, *m_print_config_ptr, object, region))
-                            layer_tools.wiping_extrusions_nonconst().set_something_overridable();
+                bool has_infill       = false;
+                bool has_solid_infill = false;
+                bool something_nonoverriddable = false;
+                for (const ExtrusionEntity *ee : layerm->fills()) {
+                    // fill represents infill extrusions of a single island.
+                    const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                    ExtrusionRole role = fill->entities.empty() ? ExtrusionRole::None : fill->entities.front()->role();
+                    if (role.is_solid_infill())
+                        has_solid_infill = true;
+                    else if (role != ExtrusionRole::None)
+                        has_infill = true;
+
+                    if (m_print_config_ptr) {
+                        if (is_overriddable(*fill, layer_tools, *m_print_config_ptr, object, region))
+                            out.something_overridable = true;
                         else
                             something_nonoverriddable = true;
+                    }
                 }
 
-                if (something_nonoverriddable)
-               		layer_tools.extruders.emplace_back(extruder_override == 0 ? region.config().perimeter_extruder.value : extruder_override);
-
-                layer_tools.has_object = true;
-            }
-
-            bool has_infill       = false;
-            bool has_solid_infill = false;
-            bool something_nonoverriddable = false;
-            for (const ExtrusionEntity *ee : layerm->fills()) {
-                // fill represents infill extrusions of a single island.
-                const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                ExtrusionRole role = fill->entities.empty() ? ExtrusionRole::None : fill->entities.front()->role();
-                if (role.is_solid_infill())
-                    has_solid_infill = true;
-                else if (role != ExtrusionRole::None)
-                    has_infill = true;
-
-                if (m_print_config_ptr) {
-                    if (is_overriddable(*fill, layer_tools, *m_print_config_ptr, object, region))
-                        layer_tools.wiping_extrusions_nonconst().set_something_overridable();
-                    else
-                        something_nonoverriddable = true;
+                if (something_nonoverriddable || !m_print_config_ptr) {
+                    if (extruder_override == 0) {
+                        if (has_solid_infill)
+                            out.extruders.emplace_back(region.config().solid_infill_extruder);
+                        if (has_infill)
+                            out.extruders.emplace_back(region.config().infill_extruder);
+                    } else if (has_solid_infill || has_infill)
+                        out.extruders.emplace_back(extruder_override);
                 }
+                if (has_solid_infill || has_infill)
+                    out.has_object = true;
             }
-
-            if (something_nonoverriddable || !m_print_config_ptr) {
-            	if (extruder_override == 0) {
-	                if (has_solid_infill)
-	                    layer_tools.extruders.emplace_back(region.config().solid_infill_extruder);
-	                if (has_infill)
-	                    layer_tools.extruders.emplace_back(region.config().infill_extruder);
-            	} else if (has_solid_infill || has_infill)
-            		layer_tools.extruders.emplace_back(extruder_override);
-            }
-            if (has_solid_infill || has_infill)
-                layer_tools.has_object = true;
         }
+    });
+
+    // Merge the extruders of the object layers into their LayerTools.
+    for (size_t layer_idx = 0; layer_idx < layers_tools.size(); ++ layer_idx) {
+        LayerTools           &layer_tools = *layers_tools[layer_idx];
+        const LayerExtruders &in          = layers_extruders[layer_idx];
+        layer_tools.extruders.insert(layer_tools.extruders.end(), in.extruders.begin(), in.extruders.end());
+        if (in.has_object)
+            layer_tools.has_object = true;
+        if (in.something_overridable)
+            layer_tools.wiping_extrusions_nonconst().set_something_overridable();
     }
 
     for (auto& layer : m_layer_tools) {
@@ -112,7 +112,7 @@ std::string Wipe::wipe(GCodeGenerator &gcodegen, bool toolchange)
                 done = true;
             } else
                 p = p_quantized;
-            gcode += gcodegen.writer().extrude_to_xy(p, -dE, wipe_retract_comment);
+            gcodegen.writer().extrude_to_xy(gcode, p, -dE, wipe_retract_comment);
             retract_length -= dE;
             return done;
         };
@@ -157,8 +157,8 @@ std::string Wipe::wipe(GCodeGenerator &gcodegen, bool toolchange)
                     // Degenerated arc after quantization. Process it as if it was a line segment.
                     return wipe_linear(prev_quantized, p);
                 // The arc is valid.
-                gcode += gcodegen.writer().extrude_to_xy_G2G3IJ(
-                    p, ij, ccw, -dE, wipe_retract_comment);
+                gcodegen.writer().extrude_to_xy_G2G3IJ(
+                    gcode, p, ij, ccw, -dE, wipe_retract_comment);
             }
             retract_length -= dE;
             return done;
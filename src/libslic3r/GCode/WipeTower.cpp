@@ -1455,24 +1455,20 @@ void WipeTower::plan_tower()
 {
 	// Calculate m_wipe_tower_depth (maximum depth for all the layers) and propagate depths downwards
 	m_wipe_tower_depth = 0.f;
-	for (auto& layer : m_plan)
-		layer.depth = 0.f;
     m_wipe_tower_height = m_plan.empty() ? 0.f : m_plan.back().z;
     m_current_height = 0.f;
-	
+
+    // A layer has to be at least as deep as any layer above it. All the layers below the current one
+    // receive the same depth from the layers above, thus a single running maximum is propagated downwards.
+    float depth_above = 0.f;
     for (int layer_index = int(m_plan.size()) - 1; layer_index >= 0; --layer_index)
 	{
-		float this_layer_depth = std::max(m_plan[layer_index].depth, m_plan[layer_index].toolchanges_depth());
+		float this_layer_depth = std::max(depth_above, m_plan[layer_index].toolchanges_depth());
 		m_plan[layer_index].depth = this_layer_depth;
+		depth_above = this_layer_depth;
 		
 		if (this_layer_depth > m_wipe_tower_depth - m_perimeter_width)
 			m_wipe_tower_depth = this_layer_depth + m_perimeter_width;
-
-		for (int i = layer_index - 1; i >= 0 ; i--)
-		{
-			if (m_plan[i].depth - this_layer_depth < 2*m_perimeter_width )
-				m_plan[i].depth = this_layer_depth;
-		}
 	}
 }
 
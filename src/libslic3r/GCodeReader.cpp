@@ -13,9 +13,31 @@
 #include "Utils.hpp"
 
 #include "LocalesUtils.hpp"
+#include "Thread.hpp"
+
+#include <atomic>
+#include <memory>
 
 #include <fast_float/fast_float.h>
 
+#include <tbb/task_arena.h>
+
+// Intel redesigned some TBB interface considerably when merging TBB with their oneAPI set of libraries, see GH #7332.
+// We are using quite an old TBB 2017 U7. Before we update our build servers, let's use the old API, which is deprecated in up to date TBB.
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if ! defined(TBB_VERSION_MAJOR)
+    static_assert(false, "TBB_VERSION_MAJOR not defined");
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
 static inline char get_extrusion_axis_char(const GCodeConfig &config)
@@ -39,6 +61,19 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
 }
 
 const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
+{
+    const char *c = this->tokenize_line(ptr, end, gline, command);
+
+    if (gline.has(E) && m_config.use_relative_e_distances)
+        m_position[E] = 0;
+
+    if (m_verbose)
+        std::cout << gline.m_raw << std::endl;
+
+    return c;
+}
+
+const char* GCodeReader::tokenize_line(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command) const
 {
     assert(is_decimal_separator_point());
     
@@ -90,16 +125,13 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 c = skip_word(c);
         }
     }
-    
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
 
     // Skip the rest of the line.
     for (; ! is_end_of_line(*c); ++ c);
 
-    // Copy the raw string including the comment, without the trailing newlines.
-    if (c > ptr)
-        gline.m_raw.assign(ptr, c);
+    // Reference the raw string including the comment, without the trailing newlines.
+    // The line is not copied, the view is valid as long as the source buffer is.
+    gline.m_raw = std::string_view(ptr, c - ptr);
 
     // Skip the trailing newlines.
 	if (*c == '\r')
@@ -107,9 +139,6 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
 	if (*c == '\n')
 		++ c;
 
-    if (m_verbose)
-        std::cout << gline.m_raw << std::endl;
-
     return c;
 }
 
@@ -213,6 +242,110 @@ bool GCodeReader::parse_file_raw(const std::string &filename, raw_line_callback_
         [](size_t){});
 }
 
+void GCodeReader::tokenize_buffer(const std::string &buffer, std::vector<GCodeLine> &lines) const
+{
+    const char *ptr = buffer.c_str();
+    const char *end = ptr + buffer.size();
+    std::pair<const char*, const char*> cmd;
+    while (*ptr != 0)
+        ptr = this->tokenize_line(ptr, end, lines.emplace_back(), cmd);
+}
+
+bool GCodeReader::parse_file_parallel(const std::string &filename, callback_t callback, std::vector<size_t> *lines_ends)
+{
+    FilePtr in{ boost::nowide::fopen(filename.c_str(), "rb") };
+    if (in.f == nullptr)
+        return false;
+
+    // Block of the input file ending with a complete line, split into tokenized lines.
+    struct Block {
+        // File offset of the start of the block.
+        size_t                 file_pos { 0 };
+        std::vector<char>      data;
+        std::vector<GCodeLine> lines;
+        // Offsets of the lines in data, one past the last line.
+        std::vector<size_t>    line_ends;
+    };
+    // Large enough to amortize the pipeline overhead, small enough to keep the memory consumption low.
+    static constexpr const size_t block_size = 4 * 1024 * 1024;
+
+    bool              read_error = false;
+    bool              eof        = false;
+    size_t            file_pos   = 0;
+    // Incomplete last line of the previous block.
+    std::vector<char> tail;
+    std::atomic<bool> quit { false };
+    m_parsing = true;
+
+    const auto reader = tbb::make_filter<void, std::shared_ptr<Block>>(slic3r_tbb_filtermode::serial_in_order,
+        [&in, &read_error, &eof, &file_pos, &tail, &quit](tbb::flow_control &fc) -> std::shared_ptr<Block> {
+            if (eof || quit) {
+                fc.stop();
+                return {};
+            }
+            auto block = std::make_shared<Block>();
+            block->file_pos = file_pos - tail.size();
+            block->data = std::move(tail);
+            size_t old_size = block->data.size();
+            block->data.resize(old_size + block_size);
+            size_t cnt_read = ::fread(block->data.data() + old_size, 1, block_size, in.f);
+            if (::ferror(in.f)) {
+                read_error = true;
+                fc.stop();
+                return {};
+            }
+            file_pos += cnt_read;
+            block->data.resize(old_size + cnt_read);
+            tail.clear();
+            if (cnt_read < block_size)
+                eof = true;
+            else {
+                // Move the incomplete last line to the next block.
+                auto it = std::find_if(block->data.rbegin(), block->data.rend(), [](char c) { return c == '\n'; });
+                tail.assign(it.base(), block->data.end());
+                block->data.erase(it.base(), block->data.end());
+            }
+            // Zero terminate to stop the tokenizer at the end of the last line.
+            block->data.emplace_back(0);
+            return block;
+        });
+    const auto tokenizer = tbb::make_filter<std::shared_ptr<Block>, std::shared_ptr<Block>>(slic3r_tbb_filtermode::parallel,
+        [this](std::shared_ptr<Block> block) -> std::shared_ptr<Block> {
+            const char *begin = block->data.data();
+            const char *end   = begin + block->data.size() - 1;
+            std::pair<const char*, const char*> cmd;
+            for (const char *ptr = begin; ptr < end;) {
+                GCodeLine &gline = block->lines.emplace_back();
+                ptr = this->tokenize_line(ptr, end, gline, cmd);
+                block->line_ends.emplace_back(ptr - begin);
+            }
+            return block;
+        });
+    const auto consumer = tbb::make_filter<std::shared_ptr<Block>, void>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &callback, lines_ends, &quit](std::shared_ptr<Block> block) {
+            if (quit)
+                return;
+            for (size_t i = 0; i < block->lines.size(); ++ i) {
+                this->parse_tokenized_line(block->lines[i], callback);
+                if (lines_ends != nullptr) {
+                    size_t line_end = block->line_ends[i];
+                    if (line_end > 0 && block->data[line_end - 1] == '\n')
+                        lines_ends->emplace_back(block->file_pos + line_end);
+                }
+                if (! m_parsing) {
+                    // The callback wishes to exit.
+                    quit = true;
+                    return;
+                }
+            }
+        });
+
+    // Tokenizer threads need the "C" locales for parsing the decimal numbers.
+    TBBLocalesSetter locales_setter;
+    tbb::parallel_pipeline(2 * size_t(tbb::this_task_arena::max_concurrency()), reader & tokenizer & consumer);
+    return ! read_error;
+}
+
 const char* GCodeReader::axis_pos(const char *raw_str, char axis)
 {
     const char *c = raw_str;
@@ -237,14 +370,13 @@ const char* GCodeReader::axis_pos(const char *raw_str, char axis)
 
 bool GCodeReader::GCodeLine::has(char axis) const
 {
-    return GCodeReader::axis_pos(this->raw().c_str(), axis);
+    return GCodeReader::axis_pos(m_raw.data(), axis);
 }
 
 std::string_view GCodeReader::GCodeLine::axis_pos(char axis) const
 { 
-    const std::string &s = this->raw();
-    const char *c = GCodeReader::axis_pos(this->raw().c_str(), axis);
-    return c ? std::string_view{ c, s.size() - (c - s.data()) } : std::string_view();
+    const char *c = GCodeReader::axis_pos(m_raw.data(), axis);
+    return c ? m_raw.substr(c - m_raw.data()) : std::string_view();
 }
 
 bool GCodeReader::GCodeLine::has_value(std::string_view axis_pos, float &value)
@@ -306,17 +438,21 @@ void GCodeReader::GCodeLine::set(const GCodeReader &reader, const Axis axis, con
         match[1] = reader.extrusion_axis();
     }
 
+    // Copy the line referencing the parsed buffer before modifying it.
+    if (! this->owns_raw())
+        m_raw_owned.assign(m_raw.data(), m_raw.size());
     if (this->has(axis)) {
-        size_t pos = m_raw.find(match)+2;
-        size_t end = m_raw.find(' ', pos+1);
-        m_raw = m_raw.replace(pos, end-pos, ss.str());
+        size_t pos = m_raw_owned.find(match)+2;
+        size_t end = m_raw_owned.find(' ', pos+1);
+        m_raw_owned.replace(pos, end-pos, ss.str());
     } else {
-        size_t pos = m_raw.find(' ');
+        size_t pos = m_raw_owned.find(' ');
         if (pos == std::string::npos)
-            m_raw += std::string(match) + ss.str();
+            m_raw_owned += std::string(match) + ss.str();
         else
-            m_raw = m_raw.replace(pos, 0, std::string(match) + ss.str());
+            m_raw_owned.replace(pos, 0, std::string(match) + ss.str());
     }
+    m_raw = m_raw_owned;
     m_axis[axis] = new_value;
     m_mask |= 1 << int(axis);
 }
@@ -11,6 +11,7 @@
 #include <functional>
 #include <string>
 #include <string_view>
+#include <vector>
 #include "PrintConfig.hpp"
 
 namespace Slic3r {
@@ -20,15 +21,21 @@ public:
     class GCodeLine {
     public:
         GCodeLine() { reset(); }
-        void reset() { m_mask = 0; memset(m_axis, 0, sizeof(m_axis)); m_raw.clear(); }
-
-        const std::string&      raw() const { return m_raw; }
+        GCodeLine(const GCodeLine &rhs) { this->assign(rhs); }
+        GCodeLine(GCodeLine &&rhs) { this->assign(std::move(rhs)); }
+        GCodeLine& operator=(const GCodeLine &rhs) { this->assign(rhs); return *this; }
+        GCodeLine& operator=(GCodeLine &&rhs) { this->assign(std::move(rhs)); return *this; }
+        void reset() { m_mask = 0; memset(m_axis, 0, sizeof(m_axis)); m_raw_owned.clear(); m_raw = m_raw_owned; }
+
+        // The line without the trailing newlines. Unless modified by set(), it references the buffer being parsed,
+        // thus it is only valid as long as that buffer is alive and not modified.
+        std::string_view        raw() const { return m_raw; }
         const std::string_view  cmd() const { 
-            const char *cmd = GCodeReader::skip_whitespaces(m_raw.c_str());
+            const char *cmd = GCodeReader::skip_whitespaces(m_raw.data());
             return std::string_view(cmd, GCodeReader::skip_word(cmd) - cmd);
         }
         const std::string_view  comment() const
-            { size_t pos = m_raw.find(';'); return (pos == std::string::npos) ? std::string_view() : std::string_view(m_raw).substr(pos + 1); }
+            { size_t pos = m_raw.find(';'); return (pos == std::string_view::npos) ? std::string_view() : m_raw.substr(pos + 1); }
 
         // Return position in this->raw() string starting with the "axis" character.
         std::string_view axis_pos(char axis) const;
@@ -56,7 +63,7 @@ public:
             float y = this->has(Y) ? (this->y() - reader.y()) : 0;
             return sqrt(x*x + y*y);
         }
-        bool cmd_is(const char *cmd_test)          const { return cmd_is(m_raw, cmd_test); }
+        bool cmd_is(const char *cmd_test)          const { return this->cmd() == cmd_test; }
         bool extruding(const GCodeReader &reader)  const { return this->cmd_is("G1") && this->dist_E(reader) > 0; }
         bool retracting(const GCodeReader &reader) const { return this->cmd_is("G1") && this->dist_E(reader) < 0; }
         bool travel()     const { return this->cmd_is("G1") && ! this->has(E); }
@@ -85,14 +92,29 @@ public:
         }
 
         static std::string extract_cmd(const std::string& gcode_line) {
-            GCodeLine temp;
-            temp.m_raw = gcode_line;
-            const std::string_view cmd = temp.cmd();
-            return { cmd.begin(), cmd.end() };
+            const char *cmd = GCodeReader::skip_whitespaces(gcode_line.c_str());
+            return { cmd, GCodeReader::skip_word(cmd) };
         }
 
     private:
-        std::string      m_raw;
+        bool owns_raw() const { return m_raw.data() == m_raw_owned.data(); }
+        template<typename Line>
+        void assign(Line &&rhs) {
+            if (&rhs == this)
+                return;
+            // The view has to be redirected to our own copy if it referenced the storage of rhs.
+            bool owned = rhs.owns_raw();
+            m_raw_owned = std::forward<Line>(rhs).m_raw_owned;
+            m_raw       = owned ? std::string_view(m_raw_owned) : rhs.m_raw;
+            memcpy(m_axis, rhs.m_axis, sizeof(m_axis));
+            m_mask      = rhs.m_mask;
+        }
+
+        // Either a view into the parsed buffer or into m_raw_owned. The character following the view
+        // is always an end of line character (CR, LF or zero), the parser depends on it.
+        std::string_view m_raw;
+        // Storage of a line modified by set().
+        std::string      m_raw_owned;
         float            m_axis[NUM_AXES];
         uint32_t         m_mask;
         friend class GCodeReader;
@@ -122,6 +144,20 @@ public:
     void parse_buffer(const std::string &buffer)
         { this->parse_buffer(buffer, [](GCodeReader&, const GCodeReader::GCodeLine&){}); }
 
+    // Split the buffer into lines and tokenize them, to be consumed by parse_tokenized() later.
+    // Does not modify the state of the reader, thus it may be called from another thread than parse_tokenized().
+    // The lines reference the buffer, thus the buffer has to outlive them and its storage must not move.
+    void tokenize_buffer(const std::string &buffer, std::vector<GCodeLine> &lines) const;
+
+    // Same as parse_buffer(), but the lines were already tokenized by tokenize_buffer().
+    template<typename Callback>
+    void parse_tokenized(std::vector<GCodeLine> &lines, Callback callback)
+    {
+        m_parsing = true;
+        for (auto it = lines.begin(); m_parsing && it != lines.end(); ++ it)
+            this->parse_tokenized_line(*it, callback);
+    }
+
     template<typename Callback>
     const char* parse_line(const char *ptr, const char *end, GCodeLine &gline, Callback &callback)
     {
@@ -143,6 +179,10 @@ public:
     bool parse_file(const std::string& file, callback_t callback, std::vector<std::vector<size_t>>& lines_ends);
     // Just read the G-code file line by line, calls callback (const char *begin, const char *end). Returns false if reading the file failed.
     bool parse_file_raw(const std::string &file, raw_line_callback_t callback);
+    // Same as parse_file(), but the file is read in large blocks, which are split into lines and tokenized in parallel
+    // by multiple threads. The callback is called from a single thread at a time, in the order of the lines in the file.
+    // Returns false if reading the file failed.
+    bool parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> *lines_ends = nullptr);
 
     // To be called by the callback to stop parsing.
     void quit_parsing() { m_parsing = false; }
@@ -171,6 +211,19 @@ private:
     bool        parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
 
     const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
+    // The serial part of parse_line() for a line tokenized by tokenize_line().
+    template<typename Callback>
+    void        parse_tokenized_line(GCodeLine &gline, Callback &callback)
+    {
+        if (gline.has(E) && m_config.use_relative_e_distances)
+            m_position[E] = 0;
+        callback(*this, gline);
+        std::string_view cmd = gline.cmd();
+        std::pair<const char*, const char*> command { cmd.data(), cmd.data() + cmd.size() };
+        update_coordinates(gline, command);
+    }
+    // Tokenize a single line, does not modify the state of the reader, thus it may be called in parallel.
+    const char* tokenize_line(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command) const;
     void        update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command);
 
     static bool         is_whitespace(char c)           { return c == ' ' || c == '\t'; }
@@ -446,8 +446,22 @@ private:
     const Lines &lines;
 };
 
+struct MedialAxis::Workspace
+{
+    VD                      vd;
+    std::vector<EdgeData>   edge_data;
+};
+
+MedialAxis::Workspace& MedialAxis::workspace()
+{
+    // MedialAxis::build() does not spawn any tasks, thus a thread never uses the workspace by two MedialAxis instances at once.
+    static thread_local Workspace workspace;
+    return workspace;
+}
+
 MedialAxis::MedialAxis(double min_width, double max_width, const ExPolygon &expolygon) :
-    m_expolygon(expolygon), m_lines(expolygon.lines()), m_min_width(min_width), m_max_width(max_width)
+    m_expolygon(expolygon), m_lines(expolygon.lines()), m_min_width(min_width), m_max_width(max_width),
+    m_workspace(workspace()), m_vd(m_workspace.vd), m_edge_data(m_workspace.edge_data)
 {
     (void)m_expolygon; // supress unused variable warning
 }
@@ -467,7 +481,7 @@ void MedialAxis::build(ThickPolylines* polylines)
         test(l.b.y());
     }
 #endif // NDEBUG
-    construct_voronoi(m_lines.begin(), m_lines.end(), &m_vd);
+    m_vd.construct(m_lines.begin(), m_lines.end());
     Slic3r::Voronoi::annotate_inside_outside(m_vd, m_lines);
 //    static constexpr double threshold_alpha = M_PI / 12.; // 30 degrees
 //    std::vector<Vec2d> skeleton_edges = Slic3r::Voronoi::skeleton_edges_rough(vd, lines, threshold_alpha);
@@ -26,7 +26,12 @@ private:
 
     // Voronoi Diagram.
     using VD = VoronoiDiagram;
-    VD                   m_vd;
+    // The Voronoi diagram and the edge annotations are kept per thread
+    // and reused by the subsequent MedialAxis instances to save on memory allocations.
+    struct Workspace;
+    static Workspace&    workspace();
+    Workspace           &m_workspace;
+    VD                  &m_vd;
 
     // Annotations of the VD skeleton edges.
     struct EdgeData {
@@ -39,7 +44,7 @@ private:
         size_t edge_id = &edge - &m_vd.edges().front();
         return { m_edge_data[edge_id / 2], (edge_id & 1) != 0 };
     }
-    std::vector<EdgeData> m_edge_data;
+    std::vector<EdgeData> &m_edge_data;
 
     void process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* polyline);
     bool validate_edge(const VD::edge_type* edge);
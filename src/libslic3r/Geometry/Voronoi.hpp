@@ -8,6 +8,8 @@
 #include "../Line.hpp"
 #include "../Polyline.hpp"
 
+#include <memory>
+
 #define BOOST_VORONOI_USE_GMP 1
 
 #ifdef _MSC_VER
@@ -30,6 +32,62 @@ public:
     typedef boost::polygon::point_data<coordinate_type>     point_type;
     typedef boost::polygon::segment_data<coordinate_type>   segment_type;
     typedef boost::polygon::rectangle_data<coordinate_type> rect_type;
+
+    // Same as boost::polygon::construct_voronoi(first, last, this) for points or segments, however the memory
+    // of this diagram allocated by the previous construction is reused and the builder is kept per thread.
+    template<typename Iterator>
+    void construct(Iterator first, Iterator last) {
+        // The construction does not spawn any tasks, thus the builder is never used by two constructions at once.
+        static thread_local boost::polygon::default_voronoi_builder builder;
+        builder.clear();
+        boost::polygon::insert(first, last, &builder);
+        this->clear();
+        builder.construct(this);
+    }
+};
+
+// Voronoi diagram kept per thread, so that the repeated constructions of the Voronoi diagrams of the same thread
+// (one for each island and layer) do not allocate memory for the cells, edges and vertices again.
+// A nested ThreadLocalVoronoiDiagram on the same thread, for example from a task stolen by the thread,
+// gets its own temporary diagram.
+class ThreadLocalVoronoiDiagram {
+public:
+    ThreadLocalVoronoiDiagram() {
+        if (Slot &slot = ThreadLocalVoronoiDiagram::slot(); slot.in_use) {
+            m_temp = std::make_unique<VoronoiDiagram>();
+        } else {
+            slot.in_use = true;
+            m_slot = &slot;
+        }
+    }
+    ~ThreadLocalVoronoiDiagram() {
+        if (m_slot) {
+            // Don't keep the memory of an exceptionally large diagram for the whole life of the thread.
+            if (m_slot->vd->num_edges() > max_kept_edges)
+                m_slot->vd = std::make_unique<VoronoiDiagram>();
+            m_slot->in_use = false;
+        }
+    }
+    ThreadLocalVoronoiDiagram(const ThreadLocalVoronoiDiagram&) = delete;
+    ThreadLocalVoronoiDiagram& operator=(const ThreadLocalVoronoiDiagram&) = delete;
+
+    VoronoiDiagram& operator*()  { return m_slot ? *m_slot->vd : *m_temp; }
+    VoronoiDiagram* operator->() { return &**this; }
+
+private:
+    static constexpr size_t max_kept_edges = 1 << 22;
+
+    struct Slot {
+        std::unique_ptr<VoronoiDiagram> vd { std::make_unique<VoronoiDiagram>() };
+        bool                            in_use { false };
+    };
+    static Slot& slot() {
+        static thread_local Slot slot;
+        return slot;
+    }
+
+    Slot                            *m_slot { nullptr };
+    std::unique_ptr<VoronoiDiagram>  m_temp;
 };
 
 } } // namespace Slicer::Geometry
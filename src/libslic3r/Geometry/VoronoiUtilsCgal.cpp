@@ -256,9 +256,11 @@ static bool check_if_three_edges_are_ccw(const VD::edge_type &first, const VD::e
 
 bool VoronoiUtilsCgal::is_voronoi_diagram_planar_angle(const VoronoiDiagram &voronoi_diagram, const std::vector<VoronoiUtils::Segment> &segments)
 {
+    // Reused for all the vertices to not allocate for each of them.
+    std::vector<const VD::edge_type *> edges;
     for (const VD::vertex_type &vertex : voronoi_diagram.vertices()) {
-        std::vector<const VD::edge_type *> edges;
-        const VD::edge_type               *edge = vertex.incident_edge();
+        edges.clear();
+        const VD::edge_type *edge = vertex.incident_edge();
 
         do {
             if (edge->is_finite() && edge->vertex0() != nullptr && edge->vertex1() != nullptr &&
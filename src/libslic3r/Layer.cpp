@@ -22,6 +22,8 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 Layer::~Layer()
@@ -67,6 +69,7 @@ void Layer::make_slices()
     }
 
     this->lslice_indices_sorted_by_print_order = chain_expolygons(this->lslices);
+    m_lslices_distancer.reset();
 }
 
 // used by Layer::build_up_down_graph()
@@ -628,12 +631,6 @@ void Layer::make_perimeters()
     
     // keep track of regions whose perimeters we have already generated
     std::vector<unsigned char>                              done(m_regions.size(), false);
-    std::vector<uint32_t>                                   layer_region_ids;
-    std::vector<std::pair<ExtrusionRange, ExtrusionRange>>  perimeter_and_gapfill_ranges;
-    ExPolygons                                              fill_expolygons;
-    std::vector<ExPolygonRange>                             fill_expolygons_ranges;
-    SurfacesPtr                                             surfaces_to_merge;
-    SurfacesPtr                                             surfaces_to_merge_temp;
 
     auto layer_region_reset_perimeters = [](LayerRegion &layerm) {
         layerm.m_perimeters.clear();
@@ -649,21 +646,27 @@ void Layer::make_perimeters()
     for (LayerSlice &lslice : this->lslices_ex)
         lslice.islands.clear();
 
+    // Group the regions sharing the same parameters influencing the perimeters.
+    struct RegionGroup {
+        std::vector<uint32_t>                                   layer_region_ids;
+        // Outputs of the perimeter generator for this group.
+        SurfaceCollection                                       new_slices;
+        uint32_t                                                region_id_config;
+        std::vector<std::pair<ExtrusionRange, ExtrusionRange>>  perimeter_and_gapfill_ranges;
+        ExPolygons                                              fill_expolygons;
+        std::vector<ExPolygonRange>                             fill_expolygons_ranges;
+    };
+    std::vector<RegionGroup> groups;
+
     for (LayerRegionPtrs::iterator layerm = m_regions.begin(); layerm != m_regions.end(); ++ layerm)
         if (size_t region_id = layerm - m_regions.begin(); ! done[region_id]) {
             layer_region_reset_perimeters(**layerm);
             if (! (*layerm)->slices().empty()) {
-    	        BOOST_LOG_TRIVIAL(trace) << "Generating perimeters for layer " << this->id() << ", region " << region_id;
     	        done[region_id] = true;
     	        const PrintRegionConfig &config = (*layerm)->region().config();
-    	        
-                perimeter_and_gapfill_ranges.clear();
-                fill_expolygons.clear();
-                fill_expolygons_ranges.clear();
-                surfaces_to_merge.clear();
 
     	        // find compatible regions
-                layer_region_ids.clear();
+                std::vector<uint32_t> &layer_region_ids = groups.emplace_back().layer_region_ids;
     	        layer_region_ids.push_back(region_id);
     	        for (LayerRegionPtrs::const_iterator it = layerm + 1; it != m_regions.end(); ++it)
     	            if (! (*it)->slices().empty()) {
@@ -699,48 +702,69 @@ void Layer::make_perimeters()
     		                done[it - m_regions.begin()] = true;
     		            }
     		        }
-
-    	        if (layer_region_ids.size() == 1) {  // optimization
-    	            (*layerm)->make_perimeters((*layerm)->slices(), perimeter_and_gapfill_ranges, fill_expolygons, fill_expolygons_ranges);
-                    this->sort_perimeters_into_islands((*layerm)->slices(), region_id, perimeter_and_gapfill_ranges, std::move(fill_expolygons), fill_expolygons_ranges, layer_region_ids);
-    	        } else {
-    	            SurfaceCollection new_slices;
-    	            // Use the region with highest infill rate, as the make_perimeters() function below decides on the gap fill based on the infill existence.
-                    uint32_t     region_id_config = layer_region_ids.front();
-                    LayerRegion* layerm_config = m_regions[region_id_config];
-                    {
-    	                // Merge slices (surfaces) according to number of extra perimeters.
-    	                for (uint32_t region_id : layer_region_ids) {
-                            LayerRegion &layerm = *m_regions[region_id];
-    	                    for (const Surface &surface : layerm.slices())
-                                surfaces_to_merge.emplace_back(&surface);
-                            if (layerm.region().config().fill_density > layerm_config->region().config().fill_density) {
-                                region_id_config = region_id;
-                                layerm_config    = &layerm;
-                            }
-    	                }
-                        std::sort(surfaces_to_merge.begin(), surfaces_to_merge.end(), [](const Surface *l, const Surface *r){ return l->extra_perimeters < r->extra_perimeters; });
-                        for (size_t i = 0; i < surfaces_to_merge.size();) {
-                            size_t j = i;
-                            const Surface &first = *surfaces_to_merge[i];
-                            size_t extra_perimeters = first.extra_perimeters;
-                            for (; j < surfaces_to_merge.size() && surfaces_to_merge[j]->extra_perimeters == extra_perimeters; ++ j) ;
-                            if (i + 1 == j)
-                                // Nothing to merge, just copy.
-                                new_slices.surfaces.emplace_back(*surfaces_to_merge[i]);
-                            else {
-                                surfaces_to_merge_temp.assign(surfaces_to_merge.begin() + i, surfaces_to_merge.begin() + j);
-                                new_slices.append(offset_ex(surfaces_to_merge_temp, ClipperSafetyOffset), first);
-                            }
-                            i = j;
-                        }
-    	            }
-    	            // make perimeters
-    	            layerm_config->make_perimeters(new_slices, perimeter_and_gapfill_ranges, fill_expolygons, fill_expolygons_ranges);
-                    this->sort_perimeters_into_islands(new_slices, region_id_config, perimeter_and_gapfill_ranges, std::move(fill_expolygons), fill_expolygons_ranges, layer_region_ids);
-    	        }
     	    }
         }
+
+    // Generate the perimeters of the region groups. Each group stores its perimeters into its own LayerRegion, thus the groups
+    // of a layer painted with many materials or split by many modifiers are processed in parallel.
+    // The parallel loop nests into the per-layer loop of PrintObject::make_perimeters(), TBB does not oversubscribe the threads.
+    auto make_group_perimeters = [this](RegionGroup &group) {
+        const uint32_t region_id = group.layer_region_ids.front();
+        BOOST_LOG_TRIVIAL(trace) << "Generating perimeters for layer " << this->id() << ", region " << region_id;
+        group.region_id_config = region_id;
+        if (group.layer_region_ids.size() == 1) {  // optimization
+            LayerRegion *layerm = m_regions[region_id];
+            layerm->make_perimeters(layerm->slices(), group.perimeter_and_gapfill_ranges, group.fill_expolygons, group.fill_expolygons_ranges);
+        } else {
+            // Use the region with highest infill rate, as the make_perimeters() function below decides on the gap fill based on the infill existence.
+            LayerRegion *layerm_config = m_regions[group.region_id_config];
+            {
+                // Merge slices (surfaces) according to number of extra perimeters.
+                SurfacesPtr surfaces_to_merge;
+                SurfacesPtr surfaces_to_merge_temp;
+                for (uint32_t region_id : group.layer_region_ids) {
+                    LayerRegion &layerm = *m_regions[region_id];
+                    for (const Surface &surface : layerm.slices())
+                        surfaces_to_merge.emplace_back(&surface);
+                    if (layerm.region().config().fill_density > layerm_config->region().config().fill_density) {
+                        group.region_id_config = region_id;
+                        layerm_config          = &layerm;
+                    }
+                }
+                std::sort(surfaces_to_merge.begin(), surfaces_to_merge.end(), [](const Surface *l, const Surface *r){ return l->extra_perimeters < r->extra_perimeters; });
+                for (size_t i = 0; i < surfaces_to_merge.size();) {
+                    size_t j = i;
+                    const Surface &first = *surfaces_to_merge[i];
+                    size_t extra_perimeters = first.extra_perimeters;
+                    for (; j < surfaces_to_merge.size() && surfaces_to_merge[j]->extra_perimeters == extra_perimeters; ++ j) ;
+                    if (i + 1 == j)
+                        // Nothing to merge, just copy.
+                        group.new_slices.surfaces.emplace_back(*surfaces_to_merge[i]);
+                    else {
+                        surfaces_to_merge_temp.assign(surfaces_to_merge.begin() + i, surfaces_to_merge.begin() + j);
+                        group.new_slices.append(offset_ex(surfaces_to_merge_temp, ClipperSafetyOffset), first);
+                    }
+                    i = j;
+                }
+            }
+            // make perimeters
+            layerm_config->make_perimeters(group.new_slices, group.perimeter_and_gapfill_ranges, group.fill_expolygons, group.fill_expolygons_ranges);
+        }
+    };
+    if (groups.size() == 1)
+        make_group_perimeters(groups.front());
+    else
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, groups.size()), [&groups, &make_group_perimeters](const tbb::blocked_range<size_t> &range) {
+            for (size_t group_idx = range.begin(); group_idx < range.end(); ++ group_idx)
+                make_group_perimeters(groups[group_idx]);
+        });
+
+    // Sort the perimeters into the shared layer islands sequentially, in the order of the region groups.
+    for (RegionGroup &group : groups)
+        this->sort_perimeters_into_islands(
+            group.layer_region_ids.size() == 1 ? m_regions[group.region_id_config]->slices() : group.new_slices,
+            group.region_id_config, group.perimeter_and_gapfill_ranges, std::move(group.fill_expolygons), group.fill_expolygons_ranges, group.layer_region_ids);
+
     BOOST_LOG_TRIVIAL(trace) << "Generating perimeters for layer " << this->id() << " - Done";
 }
 
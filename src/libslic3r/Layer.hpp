@@ -35,10 +35,16 @@ namespace FillAdaptive {
     struct Octree;
 }
 
+namespace AABBTreeLines {
+    template<typename LineType> class LinesDistancer;
+}
+
 namespace FillLightning {
     class Generator;
 };
 
+class FillLinesCache;
+
 // Range of indices, providing support for range based loops.
 template<typename T>
 class IndexRange
@@ -180,6 +186,7 @@ public:
 protected:
     friend class Layer;
     friend class PrintObject;
+    friend class PrintObjectCache;
 
     LayerRegion(Layer *layer, const PrintRegion *region) : m_layer(layer), m_region(region) {}
     ~LayerRegion() = default;
@@ -235,6 +242,10 @@ private:
     // (this collection contains only ExtrusionEntityCollection objects)
     ExtrusionEntityCollection   m_fills;
 
+    // Areas to be ironed, calculated by Layer::make_ironing_areas() and kept to regenerate the ironing extrusions
+    // by Layer::make_ironing() if just the ironing flow, spacing or speed change.
+    ExPolygons                  m_ironing_areas;
+
     // collection of expolygons representing the bridged areas (thus not
     // needing support material)
 //  Polygons                    bridged;
@@ -349,6 +360,9 @@ public:
     ExPolygons 				lslices;
     std::vector<size_t>     lslice_indices_sorted_by_print_order;
     LayerSlices             lslices_ex;
+    // Distancer over the unscaled lines of lslices, shared by the support spots search, the curled extrusions estimation
+    // and the overhanging perimeters calculation. Built by PrintObject::build_lslices_distancers() once the lslices are final.
+    const AABBTreeLines::LinesDistancer<Linef>& lslices_distancer() const { assert(m_lslices_distancer); return *m_lslices_distancer; }
 
     size_t                  region_count() const { return m_regions.size(); }
     const LayerRegion*      get_region(int idx) const { return m_regions[idx]; }
@@ -378,13 +392,15 @@ public:
     }
     void                    make_perimeters();
     // Phony version of make_fills() without parameters for Perl integration only.
-    void                    make_fills() { this->make_fills(nullptr, nullptr, nullptr); }
+    void                    make_fills() { this->make_fills(nullptr, nullptr, nullptr, nullptr); }
     void                    make_fills(FillAdaptive::Octree     *adaptive_fill_octree,
                                        FillAdaptive::Octree     *support_fill_octree,
-                                       FillLightning::Generator *lightning_generator);
+                                       FillLightning::Generator *lightning_generator,
+                                       FillLinesCache           *fill_lines_cache);
     Polylines               generate_sparse_infill_polylines_for_anchoring(FillAdaptive::Octree *adaptive_fill_octree,
                                                                            FillAdaptive::Octree *support_fill_octree,
                                                                            FillLightning::Generator* lightning_generator) const;
+    void                    make_ironing_areas();
     void 					make_ironing();
 
     void                    export_region_slices_to_svg(const char *path) const;
@@ -399,6 +415,7 @@ public:
 
 protected:
     friend class PrintObject;
+    friend class PrintObjectCache;
     friend std::vector<Layer*> new_layers(PrintObject*, const std::vector<coordf_t>&);
     friend std::string fix_slicing_errors(LayerPtrs&, const std::function<void()>&);
 
@@ -410,6 +427,8 @@ protected:
     virtual ~Layer();
     // Clear fill extrusions, remove them from layer islands.
     void clear_fills();
+    // Clear ironing extrusions, remove them from layer islands.
+    void clear_ironing();
 
 private:
     void sort_perimeters_into_islands(
@@ -432,6 +451,8 @@ private:
     size_t              m_id;
     PrintObject        *m_object;
     LayerRegionPtrs     m_regions;
+    // Cached by PrintObject::build_lslices_distancers(), released by make_slices().
+    std::shared_ptr<const AABBTreeLines::LinesDistancer<Linef>> m_lslices_distancer;
 };
 
 class SupportLayer : public Layer 
@@ -108,6 +108,7 @@ void LayerRegion::make_perimeters(
         print_config,
         spiral_vase
     );
+    params.throw_on_cancel = [print = this->layer()->object()->print()]() { if (print->canceled()) throw CanceledException(); };
 
     // Cummulative sum of polygons over all the regions.
     const ExPolygons *lower_slices = this->layer()->lower_layer ? &this->layer()->lower_layer->lslices : nullptr;
@@ -115,6 +116,7 @@ void LayerRegion::make_perimeters(
     Polygons          lower_layer_polygons_cache;
 
     for (const Surface &surface : slices) {
+        params.throw_on_cancel();
         auto perimeters_begin      = uint32_t(m_perimeters.size());
         auto gap_fills_begin       = uint32_t(m_thin_fills.size());
         auto fill_expolygons_begin = uint32_t(fill_expolygons.size());
@@ -113,8 +113,15 @@ void MeasuringImpl::update_planes()
     // This part is still performed in mesh coordinate system.
     const size_t             num_of_facets = m_its.indices.size();
     m_face_to_plane.resize(num_of_facets, size_t(-1));
-    const std::vector<Vec3f> face_normals = its_face_normals(m_its);
-    const std::vector<Vec3i> face_neighbors = its_face_neighbors(m_its);
+    // The SurfaceMesh is needed to walk around the planes later. Reuse its face neighbors calculated in parallel
+    // instead of calculating them once more.
+    const SurfaceMesh        sm(m_its);
+    const std::vector<Vec3i> &face_neighbors = sm.face_neighbors();
+    std::vector<Vec3f>       face_normals(num_of_facets);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_of_facets), [this, &face_normals](const tbb::blocked_range<size_t> &range) {
+        for (size_t facet_idx = range.begin(); facet_idx != range.end(); ++ facet_idx)
+            face_normals[facet_idx] = its_face_normal(m_its, int(facet_idx));
+    });
     std::vector<int>         facet_queue(num_of_facets, 0);
     int                      facet_queue_cnt = 0;
     const stl_normal*        normal_ptr      = nullptr;
@@ -160,15 +167,12 @@ void MeasuringImpl::update_planes()
         }
 
         m_planes.back().normal = normal_ptr->cast<double>();
-        std::sort(m_planes.back().facets.begin(), m_planes.back().facets.end());
     }
     
     // Check that each facet is part of one of the planes.
     assert(std::none_of(m_face_to_plane.begin(), m_face_to_plane.end(), [](size_t val) { return val == size_t(-1); }));
 
     // Now we will walk around each of the planes and save vertices which form the border.
-    const SurfaceMesh sm(m_its);
-
     const auto& face_to_plane = m_face_to_plane;
     auto& planes = m_planes;
 
@@ -176,6 +180,8 @@ void MeasuringImpl::update_planes()
         [&planes, &face_to_plane, &face_neighbors, &sm](const tbb::blocked_range<size_t>& range) {
             for (size_t plane_id = range.begin(); plane_id != range.end(); ++plane_id) {
 
+        // Sorted for the binary search of the facets below.
+        std::sort(planes[plane_id].facets.begin(), planes[plane_id].facets.end());
         const auto& facets = planes[plane_id].facets;
         planes[plane_id].borders.clear();
         std::vector<std::array<bool, 3>> visited(facets.size(), {false, false, false});
@@ -6,6 +6,7 @@
 #include "MeshBoolean.hpp"
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/TryCatchSignal.hpp"
+#include "libslic3r/AABBTreeIndirect.hpp"
 #undef PI
 
 // Include igl first. It defines "L" macro which then clashes with our localization
@@ -18,6 +19,12 @@
 #include <CGAL/Surface_mesh.h>
 #include <CGAL/Cartesian_converter.h>
 
+#include <numeric>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
+
 namespace Slic3r {
 namespace MeshBoolean {
 
@@ -326,5 +333,280 @@ CGALMeshPtr clone(const CGALMesh &m)
 
 } // namespace cgal
 
+// /////////////////////////////////////////////////////////////////////////////
+// Booleans of meshes with non intersecting surfaces
+// /////////////////////////////////////////////////////////////////////////////
+
+namespace fast {
+
+using Tree = AABBTreeIndirect::Tree3f;
+
+// Sign of the orientation of d with respect to the plane of a, b, c evaluated in double precision, validated
+// with the static error bound of the first stage of Shewchuk's adaptive orient3d predicate.
+// Returns zero if the sign could not be decided or if the points are coplanar.
+static int orient3d_filtered(const Vec3d &a, const Vec3d &b, const Vec3d &c, const Vec3d &d)
+{
+    const Vec3d ad = a - d;
+    const Vec3d bd = b - d;
+    const Vec3d cd = c - d;
+    const double bdxcdy = bd.x() * cd.y();
+    const double cdxbdy = cd.x() * bd.y();
+    const double cdxady = cd.x() * ad.y();
+    const double adxcdy = ad.x() * cd.y();
+    const double adxbdy = ad.x() * bd.y();
+    const double bdxady = bd.x() * ad.y();
+    const double det = ad.z() * (bdxcdy - cdxbdy) + bd.z() * (cdxady - adxcdy) + cd.z() * (adxbdy - bdxady);
+    const double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * std::abs(ad.z()) +
+                             (std::abs(cdxady) + std::abs(adxcdy)) * std::abs(bd.z()) +
+                             (std::abs(adxbdy) + std::abs(bdxady)) * std::abs(cd.z());
+    // (7 + 56 * epsilon) * epsilon, epsilon = 2^-53
+    static constexpr const double errbound = 7.7715611723761027e-16;
+    return det > errbound * permanent ? 1 : det < - errbound * permanent ? -1 : 0;
+}
+
+using Triangle = std::array<Vec3d, 3>;
+
+static Triangle triangle(const indexed_triangle_set &its, size_t face_idx)
+{
+    const stl_triangle_vertex_indices &face = its.indices[face_idx];
+    return { its.vertices[face(0)].cast<double>(), its.vertices[face(1)].cast<double>(), its.vertices[face(2)].cast<double>() };
+}
+
+// Interval cut out of the line of intersection of the planes by triangle t straddling the other plane.
+// side contains the orientations of the vertices of t with respect to the other plane.
+static std::pair<double, double> triangle_interval_on_line(const Triangle &t, const std::array<int, 3> &side,
+    const Vec3d &plane_pt, const Vec3d &plane_normal, const Vec3d &line_dir)
+{
+    // Vertex alone on its side of the plane.
+    const int i = side[0] == side[1] ? 2 : side[0] == side[2] ? 1 : 0;
+    const Vec3d &v  = t[i];
+    const double d  = plane_normal.dot(v - plane_pt);
+    auto cut = [&v, d, &plane_pt, &plane_normal, &line_dir](const Vec3d &v2) {
+        const double d2 = plane_normal.dot(v2 - plane_pt);
+        double       r  = d / (d - d2);
+        // The filtered predicate and the plane equation may disagree close to the plane.
+        r = std::isfinite(r) ? std::clamp(r, 0., 1.) : 0.5;
+        return line_dir.dot(v + r * (v2 - v));
+    };
+    const double t1 = cut(t[(i + 1) % 3]);
+    const double t2 = cut(t[(i + 2) % 3]);
+    return std::minmax(t1, t2);
+}
+
+// Returns false if triangles p and q certainly do not intersect nor touch, true otherwise.
+static bool triangles_may_intersect(const Triangle &p, const Triangle &q)
+{
+    std::array<int, 3> side_q;
+    for (int i = 0; i < 3; ++ i)
+        if (side_q[i] = orient3d_filtered(p[0], p[1], p[2], q[i]); side_q[i] == 0)
+            return true;
+    if (side_q[0] == side_q[1] && side_q[1] == side_q[2])
+        return false;
+    std::array<int, 3> side_p;
+    for (int i = 0; i < 3; ++ i)
+        if (side_p[i] = orient3d_filtered(q[0], q[1], q[2], p[i]); side_p[i] == 0)
+            return true;
+    if (side_p[0] == side_p[1] && side_p[1] == side_p[2])
+        return false;
+    // Both triangles straddle the plane of the other triangle. They intersect if the segments they cut out
+    // of the line of intersection of both planes overlap.
+    const Vec3d  np  = (p[1] - p[0]).cross(p[2] - p[0]);
+    const Vec3d  nq  = (q[1] - q[0]).cross(q[2] - q[0]);
+    Vec3d        dir = np.cross(nq);
+    const double len = dir.norm();
+    if (len == 0. || ! std::isfinite(len))
+        return true;
+    dir /= len;
+    const auto [p_min, p_max] = triangle_interval_on_line(p, side_p, q[0], nq, dir);
+    const auto [q_min, q_max] = triangle_interval_on_line(q, side_q, p[0], np, dir);
+    // The intervals are calculated in floating point, be conservative.
+    const double scale = std::max({ p[0].cwiseAbs().maxCoeff(), p[1].cwiseAbs().maxCoeff(), p[2].cwiseAbs().maxCoeff(),
+                                    q[0].cwiseAbs().maxCoeff(), q[1].cwiseAbs().maxCoeff(), q[2].cwiseAbs().maxCoeff() });
+    const double eps   = 1e-9 * scale + 1e-6 * (p_max - p_min + q_max - q_min);
+    return std::max(p_min, q_min) <= std::min(p_max, q_max) + eps;
+}
+
+// Traverse both AABB trees simultaneously, test the pairs of triangles with overlapping bounding boxes.
+static bool surfaces_may_intersect(const indexed_triangle_set &A, const Tree &tree_a, const indexed_triangle_set &B, const Tree &tree_b)
+{
+    std::vector<std::pair<size_t, size_t>> stack{ { 0, 0 } };
+    while (! stack.empty()) {
+        const auto [ia, ib] = stack.back();
+        stack.pop_back();
+        const Tree::Node &na = tree_a.node(ia);
+        const Tree::Node &nb = tree_b.node(ib);
+        if (! na.bbox.intersects(nb.bbox))
+            continue;
+        if (na.is_leaf() && nb.is_leaf()) {
+            if (triangles_may_intersect(triangle(A, na.idx), triangle(B, nb.idx)))
+                return true;
+        } else if (nb.is_leaf() || (na.is_inner() && na.bbox.volume() > nb.bbox.volume())) {
+            stack.emplace_back(Tree::left_child_idx(ia), ib);
+            stack.emplace_back(Tree::right_child_idx(ia), ib);
+        } else {
+            stack.emplace_back(ia, Tree::left_child_idx(ib));
+            stack.emplace_back(ia, Tree::right_child_idx(ib));
+        }
+    }
+    return false;
+}
+
+// Generalized winding number of a closed mesh around a point, which is not on its surface:
+// Sum of the signed solid angles of its triangles (van Oosterom and Strackee) divided by 4 PI.
+static double winding_number(const indexed_triangle_set &its, const Vec3d &pt)
+{
+    // Deterministic reduction, so that a point close to the threshold is classified the same way run to run.
+    return tbb::parallel_deterministic_reduce(tbb::blocked_range<size_t>(0, its.indices.size(), 1024), 0.,
+        [&its, &pt](const tbb::blocked_range<size_t> &range, double sum) {
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                const Triangle t = triangle(its, face_idx);
+                const Vec3d    a = t[0] - pt;
+                const Vec3d    b = t[1] - pt;
+                const Vec3d    c = t[2] - pt;
+                const double   la = a.norm();
+                const double   lb = b.norm();
+                const double   lc = c.norm();
+                sum += 2. * std::atan2(a.dot(b.cross(c)), la * lb * lc + a.dot(b) * lc + a.dot(c) * lb + b.dot(c) * la);
+            }
+            return sum;
+        }, std::plus<double>()) / (4. * M_PI);
+}
+
+// Connected components of a mesh.
+struct Shells
+{
+    // Index of the shell of each face.
+    std::vector<int>    face_shell;
+    // A vertex of each shell.
+    std::vector<int>    vertex;
+};
+
+static Shells mesh_shells(const indexed_triangle_set &its)
+{
+    // Union-find over the vertices.
+    std::vector<int> parent(its.vertices.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](int i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    for (const stl_triangle_vertex_indices &face : its.indices)
+        for (int i = 1; i < 3; ++ i)
+            if (int r0 = find(face(0)), r = find(face(i)); r0 != r)
+                parent[std::max(r0, r)] = std::min(r0, r);
+
+    Shells out;
+    std::vector<int> root_shell(its.vertices.size(), -1);
+    out.face_shell.reserve(its.indices.size());
+    for (const stl_triangle_vertex_indices &face : its.indices) {
+        int &shell = root_shell[find(face(0))];
+        if (shell == -1) {
+            shell = int(out.vertex.size());
+            out.vertex.emplace_back(face(0));
+        }
+        out.face_shell.emplace_back(shell);
+    }
+    return out;
+}
+
+// Classify each shell of mesh as inside (true) or outside (false) of the closed mesh other.
+// Returns false if a winding number is not close to an integer.
+static bool classify_shells(const indexed_triangle_set &mesh, const Shells &shells,
+    const indexed_triangle_set &other, const BoundingBoxf3 &other_bbox, std::vector<bool> &inside)
+{
+    inside.assign(shells.vertex.size(), false);
+    for (size_t i = 0; i < shells.vertex.size(); ++ i) {
+        const Vec3d pt = mesh.vertices[shells.vertex[i]].cast<double>();
+        if (other_bbox.contains(pt)) {
+            const double w = winding_number(other, pt);
+            if (std::abs(w - std::round(w)) > 0.25)
+                return false;
+            inside[i] = std::round(w) > 0.;
+        }
+    }
+    return true;
+}
+
+static void append_shells(indexed_triangle_set &dst, const indexed_triangle_set &src, const Shells &shells,
+    const std::vector<bool> &keep, bool flip)
+{
+    const int offset = int(dst.vertices.size());
+    append(dst.vertices, src.vertices);
+    for (size_t face_idx = 0; face_idx < src.indices.size(); ++ face_idx)
+        if (keep[shells.face_shell[face_idx]]) {
+            stl_triangle_vertex_indices face = src.indices[face_idx] + stl_triangle_vertex_indices(offset, offset, offset);
+            if (flip)
+                std::swap(face(1), face(2));
+            dst.indices.emplace_back(face);
+        }
+}
+
+enum class Operation {
+    Difference,
+    Union,
+    Intersection
+};
+
+static bool boolean_operation(Operation op, indexed_triangle_set &A, const indexed_triangle_set &B)
+{
+    if (B.empty()) {
+        if (op == Operation::Intersection)
+            A.clear();
+        return true;
+    }
+    if (A.empty()) {
+        if (op == Operation::Union)
+            A = B;
+        return true;
+    }
+
+    const BoundingBoxf3 bbox_a = bounding_box(A);
+    const BoundingBoxf3 bbox_b = bounding_box(B);
+    const Shells        shells_a = mesh_shells(A);
+    const Shells        shells_b = mesh_shells(B);
+    // Shells of A inside B, shells of B inside A.
+    std::vector<bool>   a_in_b(shells_a.vertex.size(), false);
+    std::vector<bool>   b_in_a(shells_b.vertex.size(), false);
+    if ((bbox_a.min.cwiseMax(bbox_b.min).array() <= bbox_a.max.cwiseMin(bbox_b.max).array()).all()) {
+        Tree tree_a, tree_b;
+        tbb::parallel_invoke(
+            [&A, &tree_a] { tree_a = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(A.vertices, A.indices); },
+            [&B, &tree_b] { tree_b = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(B.vertices, B.indices); });
+        if (surfaces_may_intersect(A, tree_a, B, tree_b) ||
+            ! classify_shells(A, shells_a, B, bbox_b, a_in_b) ||
+            ! classify_shells(B, shells_b, A, bbox_a, b_in_a))
+            return false;
+    }
+
+    std::vector<bool> keep_a(a_in_b.size());
+    std::vector<bool> keep_b(b_in_a.size());
+    for (size_t i = 0; i < a_in_b.size(); ++ i)
+        keep_a[i] = op == Operation::Intersection ? a_in_b[i] : ! a_in_b[i];
+    for (size_t i = 0; i < b_in_a.size(); ++ i)
+        keep_b[i] = op == Operation::Union ? ! b_in_a[i] : b_in_a[i];
+
+    if (std::find(keep_a.begin(), keep_a.end(), false) == keep_a.end() &&
+        std::find(keep_b.begin(), keep_b.end(), true) == keep_b.end())
+        // A is the result.
+        return true;
+
+    indexed_triangle_set out;
+    out.vertices.reserve(A.vertices.size() + B.vertices.size());
+    out.indices.reserve(A.indices.size() + B.indices.size());
+    append_shells(out, A, shells_a, keep_a, false);
+    // The shells of B inside A bound cavities in the difference.
+    append_shells(out, B, shells_b, keep_b, op == Operation::Difference);
+    its_compactify_vertices(out);
+    A = std::move(out);
+    return true;
+}
+
+bool minus(indexed_triangle_set &A, const indexed_triangle_set &B) { return boolean_operation(Operation::Difference, A, B); }
+bool plus(indexed_triangle_set &A, const indexed_triangle_set &B) { return boolean_operation(Operation::Union, A, B); }
+bool intersect(indexed_triangle_set &A, const indexed_triangle_set &B) { return boolean_operation(Operation::Intersection, A, B); }
+
+} // namespace fast
+
 } // namespace MeshBoolean
 } // namespace Slic3r
@@ -71,6 +71,21 @@ bool empty(const CGALMesh &mesh);
 
 }
 
+// Booleans of closed, non self-intersecting meshes resolved without an exact kernel for the case where the surfaces
+// of A and B do not intersect. The triangles of A and B are tested for intersections using a pair of AABB trees
+// and floating point predicates with a static error bound. Then each shell (connected component) of A and B
+// is either kept as a whole, flipped (B inside A when subtracting) or dropped, based on its winding number
+// with respect to the other mesh.
+// Returns false and leaves A untouched if the surfaces intersect, touch or if the floating point predicates
+// could not decide, then the caller shall fall back to the exact MeshBoolean::cgal booleans.
+namespace fast {
+
+bool minus(indexed_triangle_set &A, const indexed_triangle_set &B);
+bool plus(indexed_triangle_set &A, const indexed_triangle_set &B);
+bool intersect(indexed_triangle_set &A, const indexed_triangle_set &B);
+
+}
+
 } // namespace MeshBoolean
 } // namespace Slic3r
 #endif // libslic3r_MeshBoolean_hpp_
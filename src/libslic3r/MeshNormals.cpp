@@ -90,7 +90,7 @@ Vec3d get_normal(const AABBMesh        &mesh,
             Vec3d nrm = mesh.normal_by_face_id(*it);
             auto oit = std::lower_bound(neigh.begin(), neigh.end(), nrm, cmpfn);
             if (oit == neigh.end() || !eqfn(*oit, nrm))
-                neigh.insert(oit, mesh.normal_by_face_id(*it));
+                neigh.insert(oit, nrm);
         }
     } else if (edge_idx >= 0) { // the point is on and edge
         size_t neighbor_face = mesh.face_neighbor_index()[faceid](edge_idx);
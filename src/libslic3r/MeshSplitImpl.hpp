@@ -9,6 +9,8 @@
 #include "libnest2d/tools/benchmark.h"
 #include "Execution/ExecutionTBB.hpp"
 
+#include <atomic>
+
 namespace Slic3r {
 
 template<class ExPolicy>
@@ -32,66 +34,56 @@ template<> struct ItsWithNeighborsIndex_<indexed_triangle_set> {
     }
 };
 
-// Discover connected patches of facets one by one.
+// Label the connected patches of faces by union-find over the face neighbors running in parallel.
+// The patches are numbered in the order of their lowest face index. Returns the number of patches.
 template<class NeighborIndex>
-struct NeighborVisitor {
-    NeighborVisitor(const indexed_triangle_set &its, const NeighborIndex &neighbor_index) : 
-        its(its), neighbor_index(neighbor_index) {
-        m_visited.assign(its.indices.size(), false);
-        m_facestack.reserve(its.indices.size());
-    }
-    NeighborVisitor(const indexed_triangle_set &its, NeighborIndex &&aneighbor_index) : 
-        its(its), neighbor_index(m_neighbor_index_data), m_neighbor_index_data(std::move(aneighbor_index)) {
-        m_visited.assign(its.indices.size(), false);
-        m_facestack.reserve(its.indices.size());
-    }
+size_t label_patches(const NeighborIndex &neighbor_index, size_t num_faces, std::vector<size_t> &face_patch)
+{
+    static constexpr size_t granularity = 4096;
+
+    // Parent of each face in the union-find forest. A root is only ever linked below a root with a lower index,
+    // thus the root of a patch is its lowest face index and a face is only ever re-linked to one of its ancestors.
+    std::vector<std::atomic<size_t>> parent(num_faces);
+    execution::for_each(ex_tbb, size_t(0), num_faces, [&parent](size_t face_idx) { parent[face_idx] = face_idx; }, granularity);
+
+    auto find_root = [&parent](size_t idx) {
+        for (size_t up = parent[idx]; up != idx; up = parent[idx]) {
+            // Path halving, storing an ancestor is safe even if racing with other threads.
+            size_t upper = parent[up];
+            parent[idx]  = upper;
+            idx          = upper;
+        }
+        return idx;
+    };
 
-    template<typename Visitor>
-    void visit(Visitor visitor)
-    {
-        // find the next unvisited facet and push the index
-        auto facet = std::find(m_visited.begin() + m_seed, m_visited.end(), false);
-        m_seed = facet - m_visited.begin();
-
-        if (facet != m_visited.end()) {
-            // Skip this element in the next round.
-            auto idx = m_seed ++;
-            if (! visitor(idx))
-                return;
-            this->push(idx);
-            m_visited[idx] = true;
-            while (! m_facestack.empty()) {
-                size_t facet_idx = this->pop();
-                for (auto neighbor_idx : neighbor_index[facet_idx]) {
-                    assert(neighbor_idx < int(m_visited.size()));
-                    if (neighbor_idx >= 0 && !m_visited[neighbor_idx]) {
-                        if (! visitor(size_t(neighbor_idx)))
-                            return;
-                        m_visited[neighbor_idx] = true;
-                        this->push(stack_el(neighbor_idx));
-                    }
-                }
+    execution::for_each(ex_tbb, size_t(0), num_faces, [&neighbor_index, &parent, &find_root](size_t face_idx) {
+        for (auto neighbor_idx : neighbor_index[face_idx]) {
+            // Each pair of neighbors is united once, from the face with the lower index.
+            if (neighbor_idx < 0 || size_t(neighbor_idx) <= face_idx)
+                continue;
+            for (size_t a = face_idx, b = size_t(neighbor_idx);;) {
+                a = find_root(a);
+                b = find_root(b);
+                if (a == b)
+                    break;
+                if (a > b)
+                    std::swap(a, b);
+                // Link the root with the higher index below the other root, unless some other thread linked it in the meantime.
+                if (size_t expected = b; parent[b].compare_exchange_strong(expected, a))
+                    break;
             }
         }
-    }
-
-    const indexed_triangle_set  &its;
-    const NeighborIndex         &neighbor_index;
-
-private:
-    // If initialized with &&neighbor_index, take the ownership of the data.
-    const NeighborIndex          m_neighbor_index_data;
+    }, granularity);
 
-    std::vector<char>            m_visited;
+    face_patch.assign(num_faces, 0);
+    execution::for_each(ex_tbb, size_t(0), num_faces, [&face_patch, &find_root](size_t face_idx) { face_patch[face_idx] = find_root(face_idx); }, granularity);
 
-    using                        stack_el = size_t;
-    std::vector<stack_el>        m_facestack;
-    void                         push(const stack_el &s) { m_facestack.emplace_back(s); }
-    stack_el                     pop() { stack_el ret = m_facestack.back(); m_facestack.pop_back(); return ret; }
-
-    // Last face visited.
-    size_t                       m_seed { 0 };
-};
+    // A root precedes all the other faces of its patch, thus its patch index is known once its faces are reached.
+    size_t num_patches = 0;
+    for (size_t face_idx = 0; face_idx < num_faces; ++ face_idx)
+        face_patch[face_idx] = face_patch[face_idx] == face_idx ? num_patches ++ : face_patch[face_patch[face_idx]];
+    return num_patches;
+}
 
 } // namespace meshsplit_detail
 
@@ -135,30 +127,39 @@ void its_split(const Its &m, OutputIt out_it)
 
     const indexed_triangle_set &its = ItsWithNeighborsIndex_<Its>::get_its(m);
 
+    std::vector<size_t> face_patch;
+    size_t              num_patches = label_patches(ItsWithNeighborsIndex_<Its>::get_index(m), its.indices.size(), face_patch);
+
+    // Sort the faces by their patches, keeping the faces of a patch in their original order.
+    std::vector<size_t> patch_faces_start(num_patches + 1, 0);
+    for (size_t part_id : face_patch)
+        ++ patch_faces_start[part_id + 1];
+    for (size_t part_id = 1; part_id <= num_patches; ++ part_id)
+        patch_faces_start[part_id] += patch_faces_start[part_id - 1];
+    std::vector<size_t> patch_faces(face_patch.size());
+    {
+        std::vector<size_t> patch_faces_end(patch_faces_start.begin(), patch_faces_start.end() - 1);
+        for (size_t face_id = 0; face_id < face_patch.size(); ++ face_id)
+            patch_faces[patch_faces_end[face_patch[face_id]] ++] = face_id;
+    }
+
     struct VertexConv {
         size_t part_id      = std::numeric_limits<size_t>::max();
         size_t vertex_image;
     };
     std::vector<VertexConv> vidx_conv(its.vertices.size());
 
-    meshsplit_detail::NeighborVisitor visitor(its, meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_index(m));
-    
-    std::vector<size_t> facets;
-    for (size_t part_id = 0;; ++part_id) {
-        // Collect all faces of the next patch.
-        facets.clear();
-        visitor.visit([&facets](size_t idx) { facets.emplace_back(idx); return true; });
-        if (facets.empty())
-            break;
+    for (size_t part_id = 0; part_id < num_patches; ++part_id) {
+        const size_t num_facets = patch_faces_start[part_id + 1] - patch_faces_start[part_id];
 
         // Create a new mesh for the part that was just split off.
         indexed_triangle_set mesh;
-        mesh.indices.reserve(facets.size());
-        mesh.vertices.reserve(std::min(facets.size() * 3, its.vertices.size()));
+        mesh.indices.reserve(num_facets);
+        mesh.vertices.reserve(std::min(num_facets * 3, its.vertices.size()));
 
         // Assign the facets to the new mesh.
-        for (size_t face_id : facets) {
-            const auto &face = its.indices[face_id];
+        for (size_t i = patch_faces_start[part_id]; i < patch_faces_start[part_id + 1]; ++ i) {
+            const auto &face = its.indices[patch_faces[i]];
             Vec3i       new_face;
             for (size_t v = 0; v < 3; ++v) {
                 auto vi = face(v);
@@ -188,34 +189,18 @@ std::vector<indexed_triangle_set> its_split(const Its &its)
     return ret;
 }
 
-template<class Its> 
-bool its_is_splittable(const Its &m)
+template<class Its>
+size_t its_number_of_patches(const Its &m)
 {
-    meshsplit_detail::NeighborVisitor visitor(meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_its(m), meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_index(m));
-    bool has_some = false;
-    bool has_some2 = false;
-    // Traverse the 1st patch fully.
-    visitor.visit([&has_some](size_t idx) { has_some = true; return true; });
-    if (has_some)
-        // Just check whether there is any face of the 2nd patch.
-        visitor.visit([&has_some2](size_t idx) { has_some2 = true; return false; });
-    return has_some && has_some2;
+    std::vector<size_t> face_patch;
+    return meshsplit_detail::label_patches(meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_index(m),
+        meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_its(m).indices.size(), face_patch);
 }
 
-template<class Its>
-size_t its_number_of_patches(const Its &m)
+template<class Its> 
+bool its_is_splittable(const Its &m)
 {
-    meshsplit_detail::NeighborVisitor visitor(meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_its(m), meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_index(m));
-    size_t num_patches = 0;
-    for (;;) {
-        bool has_some = false;
-        // Traverse the 1st patch fully.
-        visitor.visit([&has_some](size_t idx) { has_some = true; return true; });
-        if (! has_some)
-            break;
-        ++ num_patches;
-    }
-    return num_patches;
+    return its_number_of_patches(m) > 1;
 }
 
 template<class ExPolicy>
@@ -29,9 +29,12 @@
 #include "Format/STEP.hpp"
 
 #include <float.h>
+#include <string_view>
+#include <unordered_map>
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/replace.hpp>
+#include <boost/container_hash/hash.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/iostream.hpp>
@@ -148,6 +151,8 @@ Model Model::read_from_file(const std::string& input_file, DynamicPrintConfig* c
     
     for (ModelObject *o : model.objects)
         o->input_file = input_file;
+
+    model.share_identical_meshes();
     
     if (options & LoadAttribute::AddDefaultInstances)
         model.add_default_instances();
@@ -188,6 +193,8 @@ Model Model::read_from_archive(const std::string& input_file, DynamicPrintConfig
             o->input_file = input_file;
     }
 
+    model.share_identical_meshes();
+
     if (options & LoadAttribute::AddDefaultInstances)
         model.add_default_instances();
 
@@ -235,6 +242,21 @@ ModelObject* Model::add_object(const char *name, const char *path, TriangleMesh
     return new_object;
 }
 
+ModelObject* Model::add_object(const char *name, const char *path, TriangleMesh &&mesh, TriangleMesh &&convex_hull)
+{
+    ModelObject* new_object = new ModelObject(this);
+    this->objects.push_back(new_object);
+    new_object->name = name;
+    new_object->input_file = path;
+    ModelVolume *new_volume = new_object->add_volume(std::move(mesh), std::move(convex_hull));
+    new_volume->name = name;
+    new_volume->source.input_file = path;
+    new_volume->source.object_idx = (int)this->objects.size() - 1;
+    new_volume->source.volume_idx = (int)new_object->volumes.size() - 1;
+    new_object->invalidate_bounding_box();
+    return new_object;
+}
+
 ModelObject* Model::add_object(const ModelObject &other)
 {
 	ModelObject* new_object = ModelObject::new_clone(other);
@@ -337,6 +359,40 @@ bool Model::add_default_instances()
     return true;
 }
 
+size_t Model::share_identical_meshes()
+{
+    auto as_bytes = [](const auto &vec) {
+        return std::string_view(reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(typename std::decay_t<decltype(vec)>::value_type));
+    };
+    auto same_geometry = [&as_bytes](const indexed_triangle_set &l, const indexed_triangle_set &r) {
+        return as_bytes(l.vertices) == as_bytes(r.vertices) && as_bytes(l.indices) == as_bytes(r.indices);
+    };
+
+    // Hash of the vertices and indices -> volumes with a unique mesh.
+    std::unordered_multimap<size_t, ModelVolume*> unique_meshes;
+    size_t num_shared = 0;
+    for (ModelObject *object : this->objects)
+        for (ModelVolume *volume : object->volumes) {
+            const indexed_triangle_set &its = volume->mesh().its;
+            if (its.empty())
+                continue;
+            size_t seed = std::hash<std::string_view>{}(as_bytes(its.vertices));
+            boost::hash_combine(seed, std::hash<std::string_view>{}(as_bytes(its.indices)));
+            auto [it_begin, it_end] = unique_meshes.equal_range(seed);
+            auto it = std::find_if(it_begin, it_end, [volume, &same_geometry](const auto &kvp)
+                { return kvp.second->m_mesh == volume->m_mesh || same_geometry(kvp.second->mesh().its, volume->mesh().its); });
+            if (it == it_end)
+                unique_meshes.insert({ seed, volume });
+            else if (const ModelVolume *other = it->second; other->m_mesh != volume->m_mesh) {
+                volume->m_mesh = other->m_mesh;
+                if (other->m_convex_hull)
+                    volume->m_convex_hull = other->m_convex_hull;
+                ++ num_shared;
+            }
+        }
+    return num_shared;
+}
+
 // this returns the bounding box of the *transformed* instances
 BoundingBoxf3 Model::bounding_box_approx() const
 {
@@ -745,6 +801,15 @@ ModelVolume* ModelObject::add_volume(TriangleMesh &&mesh, ModelVolumeType type /
     return v;
 }
 
+ModelVolume* ModelObject::add_volume(TriangleMesh &&mesh, TriangleMesh &&convex_hull, ModelVolumeType type /*= ModelVolumeType::MODEL_PART*/)
+{
+    ModelVolume* v = new ModelVolume(this, std::move(mesh), std::move(convex_hull), type);
+    this->volumes.push_back(v);
+    v->center_geometry_after_creation();
+    this->invalidate_bounding_box();
+    return v;
+}
+
 ModelVolume* ModelObject::add_volume(const ModelVolume &other, ModelVolumeType type /*= ModelVolumeType::INVALID*/)
 {
     ModelVolume* v = new ModelVolume(this, other);
@@ -1075,8 +1140,26 @@ Polygon ModelObject::convex_hull_2d(const Transform3d& trafo_instance) const
     tbb::parallel_for(tbb::blocked_range<size_t>(0, volumes.size()), [&](const tbb::blocked_range<size_t>& range) {
         for (size_t i = range.begin(); i < range.end(); ++i) {
             const ModelVolume* v = volumes[i];
-            if (v->is_model_part())
-                chs.emplace_back(its_convex_hull_2d_above(v->mesh().its, (trafo_instance * v->get_matrix()).cast<float>(), 0.0f));
+            if (! v->is_model_part())
+                continue;
+            const Transform3f trafo = (trafo_instance * v->get_matrix()).cast<float>();
+            if (const std::shared_ptr<const TriangleMesh> &hull = v->get_convex_hull_shared_ptr(); hull && ! hull->empty()) {
+                // If the volume is fully above the print bed, the projection of its 3D convex hull is its 2D convex hull.
+                // The 3D convex hull is usually much smaller than the mesh.
+                Points pts;
+                pts.reserve(hull->its.vertices.size());
+                for (const stl_vertex &p : hull->its.vertices) {
+                    const Vec3f pt = trafo * p;
+                    if (pt.z() < 0.f)
+                        break;
+                    pts.emplace_back(scaled<coord_t>(pt.x()), scaled<coord_t>(pt.y()));
+                }
+                if (pts.size() == hull->its.vertices.size()) {
+                    chs.emplace_back(Geometry::convex_hull(std::move(pts)));
+                    continue;
+                }
+            }
+            chs.emplace_back(its_convex_hull_2d_above(v->mesh().its, trafo, 0.0f));
         }
     });
 
@@ -1570,7 +1653,10 @@ unsigned int ModelObject::update_instances_print_volume_state(const BuildVolume
         for (const ModelVolume* vol : this->volumes)
             if (vol->is_model_part()) {
                 const Transform3d matrix = model_instance->get_matrix() * vol->get_matrix();
-                BuildVolume::ObjectState state = build_volume.object_state(vol->mesh().its, matrix.cast<float>(), true /* may be below print bed */);
+                // The build volume is convex, thus testing the vertices of the convex hull is sufficient to tell whether the volume
+                // is completely inside. The convex hull is usually much smaller than the mesh.
+                const TriangleMesh &mesh = vol->get_convex_hull_shared_ptr() ? vol->get_convex_hull() : vol->mesh();
+                BuildVolume::ObjectState state = build_volume.object_state(mesh.its, matrix.cast<float>(), true /* may be below print bed */);
                 if (state == BuildVolume::ObjectState::Inside)
                     // Volume is completely inside.
                     inside_outside |= INSIDE;
@@ -2013,10 +2099,8 @@ void ModelInstance::transform_polygon(Polygon* polygon) const
 
 indexed_triangle_set FacetsAnnotation::get_facets(const ModelVolume& mv, EnforcerBlockerType type) const
 {
-    TriangleSelector selector(mv.mesh());
-    // Reset of TriangleSelector is done inside TriangleSelector's constructor, so we don't need it to perform it again in deserialize().
-    selector.deserialize(m_data, false);
-    return selector.get_facets(type);
+    // Expand the serialized data directly, constructing a TriangleSelector is only needed to triangulate the T-joints.
+    return TriangleSelector::get_facets(mv.mesh().its, m_data, type);
 }
 
 indexed_triangle_set FacetsAnnotation::get_facets_strict(const ModelVolume& mv, EnforcerBlockerType type) const
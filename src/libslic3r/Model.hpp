@@ -56,6 +56,8 @@ class ModelVolume;
 class ModelWipeTower;
 class Print;
 class SLAPrint;
+class SlicingAdaptive;
+struct SlicingAdaptiveFaces;
 class TriangleSelector;
 
 namespace UndoRedo {
@@ -381,6 +383,8 @@ public:
 
     ModelVolume*            add_volume(const TriangleMesh &mesh);
     ModelVolume*            add_volume(TriangleMesh &&mesh, ModelVolumeType type = ModelVolumeType::MODEL_PART);
+    // Add a volume with a precalculated convex hull of the mesh, for example by a background loading thread.
+    ModelVolume*            add_volume(TriangleMesh &&mesh, TriangleMesh &&convex_hull, ModelVolumeType type = ModelVolumeType::MODEL_PART);
     ModelVolume*            add_volume(const ModelVolume &volume, ModelVolumeType type = ModelVolumeType::INVALID);
     ModelVolume*            add_volume(const ModelVolume &volume, TriangleMesh &&mesh);
     void                    delete_volume(size_t idx);
@@ -606,6 +610,10 @@ private:
     mutable bool          m_raw_bounding_box_valid { false };
     mutable BoundingBoxf3 m_raw_mesh_bounding_box;
     mutable bool          m_raw_mesh_bounding_box_valid { false };
+    // Facets of the model parts sorted by Z for the adaptive layer height tool, cached by SlicingAdaptive::prepare().
+    // The cache is validated against the meshes and transformations it was calculated from, thus it is never invalidated explicitly.
+    mutable std::shared_ptr<const SlicingAdaptiveFaces> m_slicing_adaptive_faces;
+    friend class SlicingAdaptive;
 
     // Only use this method if now the source and dest ModelObjects are equal, for example they were synchronized by Print::apply().
     void copy_transformation_caches(const ModelObject &src) {
@@ -1288,6 +1296,7 @@ public:
     ModelObject* add_object();
     ModelObject* add_object(const char *name, const char *path, const TriangleMesh &mesh);
     ModelObject* add_object(const char *name, const char *path, TriangleMesh &&mesh);
+    ModelObject* add_object(const char *name, const char *path, TriangleMesh &&mesh, TriangleMesh &&convex_hull);
     ModelObject* add_object(const ModelObject &other);
     void         delete_object(size_t idx);
     bool         delete_object(ObjectID id);
@@ -1304,6 +1313,10 @@ public:
     void          delete_material(t_model_material_id material_id);
     void          clear_materials();
     bool          add_default_instances();
+    // Let the volumes with bitwise identical meshes share a single TriangleMesh and its convex hull
+    // to save memory, for example if a project contains many copies of an object as separate objects.
+    // Returns the number of volumes, which started to share a mesh with another volume.
+    size_t        share_identical_meshes();
     // Returns approximate axis aligned bounding box of this model.
     BoundingBoxf3 bounding_box_approx() const;
     // Returns exact axis aligned bounding box of this model.
@@ -13,12 +13,11 @@
 
 #include <utility>
 #include <cfloat>
+#include <numeric>
 #include <unordered_set>
 
 #include <boost/log/trivial.hpp>
 #include <tbb/parallel_for.h>
-#include <mutex>
-#include <boost/thread/lock_guard.hpp>
 
 namespace Slic3r {
 struct ColoredLine {
@@ -85,9 +84,16 @@ struct PaintedLine
     int    color;
 };
 
+// Painted triangle transformed into the object coordinate system, its vertices sorted by z.
+struct PaintedTriangle
+{
+    std::array<Vec3f, 3> facet;
+    int                  color;
+};
+
 struct PaintedLineVisitor
 {
-    PaintedLineVisitor(const EdgeGrid::Grid &grid, std::vector<PaintedLine> &painted_lines, std::mutex &painted_lines_mutex, size_t reserve) : grid(grid), painted_lines(painted_lines), painted_lines_mutex(painted_lines_mutex)
+    PaintedLineVisitor(const EdgeGrid::Grid &grid, std::vector<PaintedLine> &painted_lines, size_t reserve) : grid(grid), painted_lines(painted_lines)
     {
         painted_lines_set.reserve(reserve);
     }
@@ -129,10 +135,7 @@ struct PaintedLineVisitor
                             line_to_test_projected.reverse();
 
                         painted_lines_set.insert(*it_contour_and_segment);
-                        {
-                            boost::lock_guard<std::mutex> lock(painted_lines_mutex);
-                            painted_lines.push_back({it_contour_and_segment->first, it_contour_and_segment->second, line_to_test_projected, this->color});
-                        }
+                        painted_lines.push_back({it_contour_and_segment->first, it_contour_and_segment->second, line_to_test_projected, this->color});
                     }
                 }
             }
@@ -143,7 +146,6 @@ struct PaintedLineVisitor
 
     const EdgeGrid::Grid                                                                 &grid;
     std::vector<PaintedLine>                                                             &painted_lines;
-    std::mutex                                                                           &painted_lines_mutex;
     Line                                                                                  line_to_test;
     std::unordered_set<std::pair<size_t, size_t>, boost::hash<std::pair<size_t, size_t>>> painted_lines_set;
     int                                                                                   color             = -1;
@@ -884,7 +886,8 @@ static inline Line clip_finite_voronoi_edge(const Voronoi::VD::edge_type &edge,
 
 static MMU_Graph build_graph(size_t layer_idx, const std::vector<std::vector<ColoredLine>> &color_poly)
 {
-    Geometry::VoronoiDiagram vd;
+    Geometry::ThreadLocalVoronoiDiagram vd_tls;
+    Geometry::VoronoiDiagram           &vd = *vd_tls;
     std::vector<ColoredLine> lines_colored  = to_lines(color_poly);
     const Polygons           color_poly_tmp = colored_points_to_polygon(color_poly);
     const Points             points         = to_points(color_poly_tmp);
@@ -908,7 +911,7 @@ static MMU_Graph build_graph(size_t layer_idx, const std::vector<std::vector<Col
         force_edge_adding[&c_poly - &color_poly.front()] = force_edge;
     }
 
-    boost::polygon::construct_voronoi(lines_colored.begin(), lines_colored.end(), &vd);
+    vd.construct(lines_colored.begin(), lines_colored.end());
     MMU_Graph graph;
     graph.nodes.reserve(points.size() + vd.vertices().size());
     for (const Point &point : points)
@@ -1698,7 +1701,6 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
     std::vector<std::vector<ExPolygons>>  segmented_regions(num_layers);
     segmented_regions.assign(num_layers, std::vector<ExPolygons>(num_extruders + 1));
     std::vector<std::vector<PaintedLine>> painted_lines(num_layers);
-    std::array<std::mutex, 64>            painted_lines_mutex;
     std::vector<EdgeGrid::Grid>           edge_grids(num_layers);
     const SpanOfConstPtrs<Layer>          layers = print_object.layers();
     std::vector<ExPolygons>               input_expolygons(num_layers);
@@ -1760,86 +1762,112 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
     }
 
     BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - projection of painted triangles - begin";
+    // Collect the painted triangles of all volumes transformed into the object coordinate system.
+    std::vector<PaintedTriangle> painted_triangles;
     for (const ModelVolume *mv : print_object.model_object()->volumes) {
-        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_extruders + 1), [&mv, &print_object, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        if (!mv->is_model_part())
+            continue;
+        std::vector<std::vector<PaintedTriangle>> painted_triangles_by_extruder(num_extruders + 1);
+        const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
+        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_extruders + 1), [&mv, &tr, &painted_triangles_by_extruder, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
             for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
                 throw_on_cancel_callback();
                 const indexed_triangle_set custom_facets = mv->mmu_segmentation_facets.get_facets(*mv, EnforcerBlockerType(extruder_idx));
-                if (!mv->is_model_part() || custom_facets.indices.empty())
-                    continue;
+                std::vector<PaintedTriangle> &out = painted_triangles_by_extruder[extruder_idx];
+                out.reserve(custom_facets.indices.size());
+                for (const stl_triangle_vertex_indices &face : custom_facets.indices) {
+                    PaintedTriangle &painted = out.emplace_back();
+                    for (int p_idx = 0; p_idx < 3; ++p_idx)
+                        painted.facet[p_idx] = tr * custom_facets.vertices[face(p_idx)];
+                    // Sort the vertices by z-axis for simplification of projected_facet on slices
+                    std::sort(painted.facet.begin(), painted.facet.end(), [](const Vec3f &p1, const Vec3f &p2) { return p1.z() < p2.z(); });
+                    painted.color = int(extruder_idx);
+                }
+            }
+        }); // end of parallel_for
+        for (std::vector<PaintedTriangle> &triangles : painted_triangles_by_extruder)
+            append(painted_triangles, std::move(triangles));
+    }
 
-                const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
-                tbb::parallel_for(tbb::blocked_range<size_t>(0, custom_facets.indices.size()), [&tr, &custom_facets, &print_object, &layers, &edge_grids, &input_expolygons, &painted_lines, &painted_lines_mutex, &extruder_idx](const tbb::blocked_range<size_t> &range) {
-                    for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++facet_idx) {
-                        float min_z = std::numeric_limits<float>::max();
-                        float max_z = std::numeric_limits<float>::lowest();
-
-                        std::array<Vec3f, 3> facet;
-                        for (int p_idx = 0; p_idx < 3; ++p_idx) {
-                            facet[p_idx] = tr * custom_facets.vertices[custom_facets.indices[facet_idx](p_idx)];
-                            max_z        = std::max(max_z, facet[p_idx].z());
-                            min_z        = std::min(min_z, facet[p_idx].z());
-                        }
+    // Index of the painted triangles spanning each layer, stored in a compressed row format:
+    // Triangles of layer_idx are layer_triangles[layer_triangles_begin[layer_idx] .. layer_triangles_begin[layer_idx + 1]).
+    // Thanks to the index, the layers are processed in parallel, each layer filling its own painted lines without locking.
+    std::vector<std::pair<uint32_t, uint32_t>> triangle_layer_span(painted_triangles.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, painted_triangles.size()), [&painted_triangles, &layers, &triangle_layer_span](const tbb::blocked_range<size_t> &range) {
+        for (size_t triangle_idx = range.begin(); triangle_idx < range.end(); ++triangle_idx) {
+            const std::array<Vec3f, 3> &facet = painted_triangles[triangle_idx].facet;
+            // Find lowest slice not below the triangle.
+            auto first_layer = std::upper_bound(layers.begin(), layers.end(), float(facet[0].z() - EPSILON),
+                                                [](float z, const Layer *l1) { return z < l1->slice_z; });
+            auto last_layer  = std::upper_bound(layers.begin(), layers.end(), float(facet[2].z() + EPSILON),
+                                               [](float z, const Layer *l1) { return z < l1->slice_z; });
+            triangle_layer_span[triangle_idx] = { uint32_t(first_layer - layers.begin()), uint32_t(std::max(first_layer, last_layer) - layers.begin()) };
+        }
+    }); // end of parallel_for
+    std::vector<size_t> layer_triangles_begin(num_layers + 1, 0);
+    for (const auto &[first_layer_idx, last_layer_idx] : triangle_layer_span)
+        for (uint32_t layer_idx = first_layer_idx; layer_idx < last_layer_idx; ++layer_idx)
+            ++layer_triangles_begin[layer_idx + 1];
+    std::partial_sum(layer_triangles_begin.begin(), layer_triangles_begin.end(), layer_triangles_begin.begin());
+    std::vector<uint32_t> layer_triangles(layer_triangles_begin.back());
+    {
+        std::vector<size_t> layer_triangles_end(layer_triangles_begin.begin(), layer_triangles_begin.end() - 1);
+        for (uint32_t triangle_idx = 0; triangle_idx < uint32_t(triangle_layer_span.size()); ++triangle_idx)
+            for (uint32_t layer_idx = triangle_layer_span[triangle_idx].first; layer_idx < triangle_layer_span[triangle_idx].second; ++layer_idx)
+                layer_triangles[layer_triangles_end[layer_idx]++] = triangle_idx;
+    }
 
-                        // Sort the vertices by z-axis for simplification of projected_facet on slices
-                        std::sort(facet.begin(), facet.end(), [](const Vec3f &p1, const Vec3f &p2) { return p1.z() < p2.z(); });
-
-                        // Find lowest slice not below the triangle.
-                        auto first_layer = std::upper_bound(layers.begin(), layers.end(), float(min_z - EPSILON),
-                                                            [](float z, const Layer *l1) { return z < l1->slice_z; });
-                        auto last_layer  = std::upper_bound(layers.begin(), layers.end(), float(max_z + EPSILON),
-                                                           [](float z, const Layer *l1) { return z < l1->slice_z; });
-                        --last_layer;
-
-                        for (auto layer_it = first_layer; layer_it != (last_layer + 1); ++layer_it) {
-                            const Layer *layer     = *layer_it;
-                            size_t       layer_idx = layer_it - layers.begin();
-                            if (input_expolygons[layer_idx].empty() || facet[0].z() > layer->slice_z || layer->slice_z > facet[2].z())
-                                continue;
-
-                            // https://kandepet.com/3d-printing-slicing-3d-objects/
-                            float t            = (float(layer->slice_z) - facet[0].z()) / (facet[2].z() - facet[0].z());
-                            Vec3f line_start_f = facet[0] + t * (facet[2] - facet[0]);
-                            Vec3f line_end_f;
-
-                            if (facet[1].z() > layer->slice_z) {
-                                // [P0, P2] and [P0, P1]
-                                float t1   = (float(layer->slice_z) - facet[0].z()) / (facet[1].z() - facet[0].z());
-                                line_end_f = facet[0] + t1 * (facet[1] - facet[0]);
-                            } else {
-                                // [P0, P2] and [P1, P2]
-                                float t2   = (float(layer->slice_z) - facet[1].z()) / (facet[2].z() - facet[1].z());
-                                line_end_f = facet[1] + t2 * (facet[2] - facet[1]);
-                            }
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&print_object, &layers, &edge_grids, &input_expolygons, &painted_lines, &painted_triangles, &layer_triangles, &layer_triangles_begin, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            throw_on_cancel_callback();
+            const Layer *layer = layers[layer_idx];
+            if (input_expolygons[layer_idx].empty())
+                continue;
 
-                            Line line_to_test(Point(scale_(line_start_f.x()), scale_(line_start_f.y())),
-                                              Point(scale_(line_end_f.x()), scale_(line_end_f.y())));
-                            line_to_test.translate(-print_object.center_offset());
-
-                            // BoundingBoxes for EdgeGrids are computed from printable regions. It is possible that the painted line (line_to_test) could
-                            // be outside EdgeGrid's BoundingBox, for example, when the negative volume is used on the painted area (GH #7618).
-                            // To ensure that the painted line is always inside EdgeGrid's BoundingBox, it is clipped by EdgeGrid's BoundingBox in cases
-                            // when any of the endpoints of the line are outside the EdgeGrid's BoundingBox.
-                            if (const BoundingBox &edge_grid_bbox = edge_grids[layer_idx].bbox(); !edge_grid_bbox.contains(line_to_test.a) || !edge_grid_bbox.contains(line_to_test.b)) {
-                                // If the painted line (line_to_test) is entirely outside EdgeGrid's BoundingBox, skip this painted line.
-                                if (!edge_grid_bbox.overlap(BoundingBox(Points{line_to_test.a, line_to_test.b})) ||
-                                    !line_to_test.clip_with_bbox(edge_grid_bbox))
-                                    continue;
-                            }
+            PaintedLineVisitor visitor(edge_grids[layer_idx], painted_lines[layer_idx], 16);
+            for (size_t idx = layer_triangles_begin[layer_idx]; idx < layer_triangles_begin[layer_idx + 1]; ++idx) {
+                const PaintedTriangle      &painted = painted_triangles[layer_triangles[idx]];
+                const std::array<Vec3f, 3> &facet   = painted.facet;
+                if (facet[0].z() > layer->slice_z || layer->slice_z > facet[2].z())
+                    continue;
 
-                            size_t mutex_idx = layer_idx & 0x3F;
-                            assert(mutex_idx < painted_lines_mutex.size());
+                // https://kandepet.com/3d-printing-slicing-3d-objects/
+                float t            = (float(layer->slice_z) - facet[0].z()) / (facet[2].z() - facet[0].z());
+                Vec3f line_start_f = facet[0] + t * (facet[2] - facet[0]);
+                Vec3f line_end_f;
 
-                            PaintedLineVisitor visitor(edge_grids[layer_idx], painted_lines[layer_idx], painted_lines_mutex[mutex_idx], 16);
-                            visitor.line_to_test = line_to_test;
-                            visitor.color        = int(extruder_idx);
-                            edge_grids[layer_idx].visit_cells_intersecting_line(line_to_test.a, line_to_test.b, visitor);
-                        }
-                    }
-                }); // end of parallel_for
+                if (facet[1].z() > layer->slice_z) {
+                    // [P0, P2] and [P0, P1]
+                    float t1   = (float(layer->slice_z) - facet[0].z()) / (facet[1].z() - facet[0].z());
+                    line_end_f = facet[0] + t1 * (facet[1] - facet[0]);
+                } else {
+                    // [P0, P2] and [P1, P2]
+                    float t2   = (float(layer->slice_z) - facet[1].z()) / (facet[2].z() - facet[1].z());
+                    line_end_f = facet[1] + t2 * (facet[2] - facet[1]);
+                }
+
+                Line line_to_test(Point(scale_(line_start_f.x()), scale_(line_start_f.y())),
+                                  Point(scale_(line_end_f.x()), scale_(line_end_f.y())));
+                line_to_test.translate(-print_object.center_offset());
+
+                // BoundingBoxes for EdgeGrids are computed from printable regions. It is possible that the painted line (line_to_test) could
+                // be outside EdgeGrid's BoundingBox, for example, when the negative volume is used on the painted area (GH #7618).
+                // To ensure that the painted line is always inside EdgeGrid's BoundingBox, it is clipped by EdgeGrid's BoundingBox in cases
+                // when any of the endpoints of the line are outside the EdgeGrid's BoundingBox.
+                if (const BoundingBox &edge_grid_bbox = edge_grids[layer_idx].bbox(); !edge_grid_bbox.contains(line_to_test.a) || !edge_grid_bbox.contains(line_to_test.b)) {
+                    // If the painted line (line_to_test) is entirely outside EdgeGrid's BoundingBox, skip this painted line.
+                    if (!edge_grid_bbox.overlap(BoundingBox(Points{line_to_test.a, line_to_test.b})) ||
+                        !line_to_test.clip_with_bbox(edge_grid_bbox))
+                        continue;
+                }
+
+                visitor.reset();
+                visitor.line_to_test = line_to_test;
+                visitor.color        = painted.color;
+                edge_grids[layer_idx].visit_cells_intersecting_line(line_to_test.a, line_to_test.b, visitor);
             }
-        }); // end of parallel_for
-    }
+        }
+    }); // end of parallel_for
     BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - projection of painted triangles - end";
     BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - painted layers count: "
                              << std::count_if(painted_lines.begin(), painted_lines.end(), [](const std::vector<PaintedLine> &pl) { return !pl.empty(); });
@@ -5,7 +5,10 @@
 #ifndef BRUTEFORCEOPTIMIZER_HPP
 #define BRUTEFORCEOPTIMIZER_HPP
 
+#include <vector>
+
 #include <libslic3r/Optimize/Optimizer.hpp>
+#include <libslic3r/Execution/Execution.hpp>
 
 namespace Slic3r { namespace opt {
 
@@ -108,13 +111,78 @@ struct AlgBurteForce {
     }
 };
 
+// The same grid search with the grid points evaluated using the execution
+// policy EP, thus the object function may be called from multiple threads.
+// All the grid points up to max_iterations are evaluated, the score precision
+// criteria do not stop the search. Of equal scores, the grid point first in
+// the order of the sequential search wins, thus the result does not depend on
+// the scheduling of the threads.
+template<class EP>
+struct AlgBurteForceEP : public AlgBurteForce {
+    EP ep;
+
+    using AlgBurteForce::AlgBurteForce;
+
+    template<class Fn, size_t N>
+    Result<N> optimize(Fn&& fn,
+                       const Input<N> &/*initvals*/,
+                       const Bounds<N>& bounds)
+    {
+        size_t num_points = 1;
+        for (size_t d = 0; d < N; ++d)
+            num_points *= gridsz;
+
+        if (auto max_iter = size_t(stc.max_iterations()); max_iter > 0)
+            num_points = std::min(num_points, max_iter);
+
+        // Inverse of num_iter()
+        auto grid_point = [this, &bounds](size_t i) {
+            Input<N> inp;
+            for (size_t d = 0; d < N; ++d, i /= gridsz) {
+                const Bound &b = bounds[d];
+                double step = (b.max() - b.min()) / (gridsz - 1);
+                inp[d] = b.min() + (i % gridsz) * step;
+            }
+
+            return inp;
+        };
+
+        std::vector<double> scores(num_points, NaNd);
+        execution::for_each(ep, size_t(0), num_points,
+                            [this, &fn, &grid_point, &scores](size_t i) {
+                                if (! stc.stop_condition())
+                                    scores[i] = fn(grid_point(i));
+                            });
+
+        Result<N> result;
+        result.score = to_min ? std::numeric_limits<double>::max() :
+                                std::numeric_limits<double>::lowest();
+        for (size_t i = 0; i < num_points; ++i)
+            if (! std::isnan(scores[i]) &&
+                (to_min ? scores[i] < result.score : scores[i] > result.score)) {
+                result.score   = scores[i];
+                result.optimum = grid_point(i);
+            }
+
+        return result;
+    }
+};
+
+template<class M>
+using BruteForceOnly = std::enable_if_t<std::is_base_of_v<AlgBurteForce, M>>;
+
 } // namespace detail
 
 using AlgBruteForce = detail::AlgBurteForce;
 
-template<>
-class Optimizer<AlgBruteForce> {
-    AlgBruteForce m_alg;
+// Brute force grid search evaluating the grid points in parallel, e.g.
+// Optimizer<AlgBruteForceEP<ExecutionTBB>>
+template<class EP>
+using AlgBruteForceEP = detail::AlgBurteForceEP<EP>;
+
+template<class M>
+class Optimizer<M, detail::BruteForceOnly<M>> {
+    M m_alg;
 
 public:
 
@@ -16,8 +16,10 @@
 #endif
 
 #include <utility>
+#include <vector>
 
 #include <libslic3r/libslic3r.h>
+#include <libslic3r/Execution/Execution.hpp>
 
 #include "Optimizer.hpp"
 
@@ -305,6 +307,7 @@ public:
     const StopCriteria &get_loc_criteria() const noexcept { return m_loc_stopcr; }
 
     void set_dir(OptDir dir) noexcept { m_dir = dir; }
+    OptDir get_dir() const noexcept { return m_dir; }
     void seed(long s) { nlopt_srand(s); }
 };
 
@@ -350,6 +353,35 @@ public:
                               ineq_constraint);
     }
 
+    // Multistart optimization: the optimization is started from each of the
+    // initial values using the execution policy ep and the best of the results
+    // is returned. The object function and the stop condition may thus be
+    // called from multiple threads. Of equal scores, the result of the first
+    // initial value wins, thus the result does not depend on the scheduling.
+    template<class EP, class Func, size_t N, class = ExecutionPolicyOnly<EP>>
+    Result<N> optimize(const EP &ep,
+                       Func &&func,
+                       const std::vector<Input<N>> &initvals,
+                       const Bounds<N> &bounds)
+    {
+        std::vector<Result<N>> results(initvals.size());
+        execution::for_each(ep, size_t(0), initvals.size(),
+                            [this, &func, &initvals, &bounds, &results](size_t i) {
+                                results[i] = m_opt.optimize(func, initvals[i], bounds,
+                                                            std::tuple<>{}, std::tuple<>{});
+                            }, 1);
+
+        bool to_min = m_opt.get_dir() == detail::OptDir::MIN;
+        Result<N> best = {};
+        best.score = NaNd;
+        for (const Result<N> &r : results)
+            if (! std::isnan(r.score) &&
+                (std::isnan(best.score) || (to_min ? r.score < best.score : r.score > best.score)))
+                best = r;
+
+        return best;
+    }
+
     explicit Optimizer(StopCriteria stopcr = {}) : m_opt(stopcr) {}
 
     Optimizer &set_criteria(const StopCriteria &cr)
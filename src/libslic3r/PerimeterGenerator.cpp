@@ -53,6 +53,8 @@
 
 #include <ankerl/unordered_dense.h>
 
+#include <tbb/parallel_for.h>
+
 // #define ARACHNE_DEBUG
 
 #ifdef ARACHNE_DEBUG
@@ -292,6 +294,23 @@ static void fuzzy_extrusion_line(Arachne::ExtrusionLine &ext_lines, double fuzzy
 
 using PerimeterGeneratorLoops = std::vector<PerimeterGeneratorLoop>;
 
+// Medial axis of the islands calculated in parallel, text and thin ribs produce many of them.
+// The thick polylines are appended to out in the order of the islands.
+static void medial_axis(const ExPolygons &expolygons, double min_width, double max_width, ThickPolylines &out)
+{
+    if (expolygons.size() == 1) {
+        expolygons.front().medial_axis(min_width, max_width, &out);
+        return;
+    }
+    std::vector<ThickPolylines> per_island(expolygons.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, expolygons.size()), [&expolygons, &per_island, min_width, max_width](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            expolygons[i].medial_axis(min_width, max_width, &per_island[i]);
+    });
+    for (ThickPolylines &polylines : per_island)
+        append(out, std::move(polylines));
+}
+
 static ExtrusionEntityCollection traverse_loops_classic(const PerimeterGenerator::Parameters &params, const Polygons &lower_slices_polygons_cache, const PerimeterGeneratorLoops &loops, ThickPolylines &thin_walls)
 {
     // loops is an arrayref of ::Loop objects
@@ -1118,7 +1137,8 @@ void PerimeterGenerator::process_arachne(
     ExPolygons last        = offset_ex(surface.expolygon.simplify_p(params.scaled_resolution), - float(ext_perimeter_width / 2. - ext_perimeter_spacing / 2.));
     Polygons   last_p      = to_polygons(last);
 
-    Arachne::WallToolPaths wallToolPaths(last_p, ext_perimeter_spacing, perimeter_spacing, coord_t(loop_number + 1), 0, params.layer_height, params.object_config, params.print_config);
+    Arachne::WallToolPaths wallToolPaths(last_p, ext_perimeter_spacing, perimeter_spacing, coord_t(loop_number + 1), 0, params.layer_height, params.object_config, params.print_config,
+                                         params.throw_on_cancel);
     std::vector<Arachne::VariableWidthLines> perimeters = wallToolPaths.getToolPaths();
     loop_number = int(perimeters.size()) - 1;
 
@@ -1385,6 +1405,7 @@ void PerimeterGenerator::process_classic(
         ThickPolylines thin_walls;
         // we loop one time more than needed in order to find gaps after the last perimeter was applied
         for (int i = 0;; ++ i) {  // outer loop is 0
+            params.throw_on_cancel();
             // Calculate next onion shell of perimeters.
             ExPolygons offsets;
             if (i == 0) {
@@ -1406,8 +1427,7 @@ void PerimeterGenerator::process_classic(
                         diff_ex(last, offset(offsets, float(ext_perimeter_width / 2.) + ClipperSafetyOffset)),
                         float(min_width / 2.));
                     // the maximum thickness of our thin wall area is equal to the minimum thickness of a single loop
-                    for (ExPolygon &ex : expp)
-                        ex.medial_axis(min_width, ext_perimeter_width + ext_perimeter_spacing2, &thin_walls);
+                    medial_axis(expp, min_width, ext_perimeter_width + ext_perimeter_spacing2, thin_walls);
                 }
                 if (params.spiral_vase && offsets.size() > 1) {
                 	// Remove all but the largest area polygon.
@@ -1552,8 +1572,7 @@ void PerimeterGenerator::process_classic(
             opening_ex(gaps, float(min / 2.)),
             offset2_ex(gaps, - float(max / 2.), float(max / 2. + ClipperSafetyOffset)));
         ThickPolylines polylines;
-        for (const ExPolygon &ex : gaps_ex)
-            ex.medial_axis(min, max, &polylines);
+        medial_axis(gaps_ex, min, max, polylines);
         if (! polylines.empty()) {
 			ExtrusionEntityCollection gap_fill;
 			variable_width_classic(polylines, ExtrusionRole::GapFill, params.solid_infill_flow, gap_fill.entities);
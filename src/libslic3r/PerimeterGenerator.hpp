@@ -8,6 +8,7 @@
 #define slic3r_PerimeterGenerator_hpp_
 
 #include "libslic3r.h"
+#include <functional>
 #include <vector>
 #include "ExtrusionEntityCollection.hpp"
 #include "Flow.hpp"
@@ -67,6 +68,10 @@ struct Parameters {
     double                       mm3_per_mm;
     double                       mm3_per_mm_overhang;
 
+    // Throws CanceledException when the slicing was canceled, checked between the perimeter loops
+    // and between the phases of Arachne, so that a cancel does not wait for the whole layer to be finished.
+    std::function<void()>        throw_on_cancel { [](){} };
+
 private:
     Parameters() = delete;
 };
@@ -2350,8 +2350,27 @@ static std::string process_macro(const std::string &templ, client::MyContext &co
     return output;
 }
 
+// Is the template a plain 7-bit ASCII text, which the macro processor would return verbatim?
+// Such a text contains no macro or legacy variable expansion. It does not start with a white space either,
+// which the macro processor would skip.
+static bool is_verbatim_text(const std::string &templ)
+{
+    if (templ.empty())
+        return true;
+    if (char c = templ.front(); c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        return false;
+    for (char c : templ)
+        if ((unsigned char)c >= 0x80 || c == '[' || c == '{')
+            return false;
+    return true;
+}
+
 std::string PlaceholderParser::process(const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, DynamicConfig *config_outputs, ContextData *context_data) const
 {
+    // Custom G-code templates are processed on each layer and tool change, many of them are empty or plain G-code.
+    if (is_verbatim_text(templ))
+        return templ;
+
     client::MyContext context;
     context.external_config 	= this->external_config();
     context.config              = &this->config();
@@ -28,6 +28,8 @@
 #include <boost/locale.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include <LibBGCode/core/core.hpp>
 
 // Store the print/filament/printer presets into a "presets" subdirectory of the Slic3rPE config dir.
@@ -1392,6 +1394,75 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
     // If loading a user config bundle, do not flatten with the system profiles, but keep the "inherits" flag intact.
     flatten_configbundle_hierarchy(tree, flags.has(LoadConfigBundleAttribute::LoadSystem) ? nullptr : this);
 
+    // 1.6) Parse the print, filament and printer presets in parallel. Deserializing the values of the presets
+    // is the bulk of the work of loading a large vendor config bundle. The parsed presets are loaded
+    // into their collections in the order of the config bundle below.
+    struct ParsedPreset {
+        PresetCollection          *presets        { nullptr };
+        const DynamicPrintConfig  *default_config { nullptr };
+        DynamicPrintConfig         config;
+        std::string                alias_name;
+        std::vector<std::string>   renamed_from;
+        ConfigSubstitutions        substitutions;
+        // Parsing error, rethrown when the preset is being loaded.
+        std::exception_ptr         error;
+    };
+    std::vector<const pt::ptree::value_type*> sections;
+    for (const auto &section : tree)
+        sections.emplace_back(&section);
+    std::vector<ParsedPreset> parsed_presets(sections.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, sections.size()),
+        [this, &sections, &parsed_presets, &path, compatibility_rule](const tbb::blocked_range<size_t> &range) {
+        for (size_t section_idx = range.begin(); section_idx < range.end(); ++ section_idx) {
+            const auto   &section = *sections[section_idx];
+            ParsedPreset &parsed  = parsed_presets[section_idx];
+            if (boost::starts_with(section.first, "print:"))
+                parsed.presets = &this->prints;
+            else if (boost::starts_with(section.first, "filament:"))
+                parsed.presets = &this->filaments;
+            else if (boost::starts_with(section.first, "sla_print:"))
+                parsed.presets = &this->sla_prints;
+            else if (boost::starts_with(section.first, "sla_material:"))
+                parsed.presets = &this->sla_materials;
+            else if (boost::starts_with(section.first, "printer:"))
+                parsed.presets = &this->printers;
+            else
+                continue;
+            ConfigSubstitutionContext substitution_context { compatibility_rule };
+            try {
+                auto parse_config_section = [&section, &parsed, &substitution_context, &path](DynamicPrintConfig &config) {
+                    for (auto &kvp : section.second) {
+                    	if (kvp.first == "alias")
+                    		parsed.alias_name = kvp.second.data();
+                    	else if (kvp.first == "renamed_from") {
+                    		if (! unescape_strings_cstyle(kvp.second.data(), parsed.renamed_from)) {
+    			                BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle \"" << path << "\": The preset \"" << 
+    			                    section.first << "\" contains invalid \"renamed_from\" key, which is being ignored.";
+                       		}
+                    	}
+                        // Throws on parsing error. For system presets, no substituion is being done, but an exception is thrown.
+                        config.set_deserialize(kvp.first, kvp.second.data(), substitution_context);
+                    }
+                };
+                if (parsed.presets == &this->printers) {
+                    // Select the default config based on the printer_technology field extracted from kvp.
+                    DynamicPrintConfig config_src;
+                    parse_config_section(config_src);
+                    parsed.default_config = &parsed.presets->default_preset_for(config_src).config;
+                    parsed.config = *parsed.default_config;
+                    parsed.config.apply(config_src);
+                } else {
+                    parsed.default_config = &parsed.presets->default_preset().config;
+                    parsed.config = *parsed.default_config;
+                    parse_config_section(parsed.config);
+                }
+                parsed.substitutions = std::move(substitution_context.substitutions);
+            } catch (const ConfigurationError &e) {
+                parsed.error = std::make_exception_ptr(ConfigurationError(format("Invalid configuration bundle \"%1%\", section [%2%]: ", path, section.first) + e.what()));
+            }
+        }
+    });
+
     // 2) Parse the property_tree, extract the active preset names and the profiles, save them into local config files.
     // Parse the obsolete preset names, to be deleted when upgrading from the old configuration structure.
     std::vector<std::string> loaded_prints;
@@ -1409,7 +1480,10 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
     size_t                   presets_loaded = 0;
     size_t                   ph_printers_loaded = 0;
 
+    size_t                   section_idx = 0;
+
     for (const auto &section : tree) {
+        ParsedPreset             &parsed = parsed_presets[section_idx ++];
         PresetCollection         *presets = nullptr;
         std::string               preset_name;
         PhysicalPrinterCollection *ph_printers = nullptr;
@@ -1485,42 +1559,15 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
             // Ignore an unknown section.
             continue;
         if (presets != nullptr) {
-            // Load the print, filament or printer preset.
-            const DynamicPrintConfig *default_config = nullptr;
-            DynamicPrintConfig        config;
-            std::string 			  alias_name;
-            std::vector<std::string>  renamed_from;
-            try {
-                auto parse_config_section = [&section, &alias_name, &renamed_from, &substitution_context, &path](DynamicPrintConfig &config) {
-                    substitution_context.substitutions.clear();
-                    for (auto &kvp : section.second) {
-                    	if (kvp.first == "alias")
-                    		alias_name = kvp.second.data();
-                    	else if (kvp.first == "renamed_from") {
-                    		if (! unescape_strings_cstyle(kvp.second.data(), renamed_from)) {
-    			                BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle \"" << path << "\": The preset \"" << 
-    			                    section.first << "\" contains invalid \"renamed_from\" key, which is being ignored.";
-                       		}
-                    	}
-                        // Throws on parsing error. For system presets, no substituion is being done, but an exception is thrown.
-                        config.set_deserialize(kvp.first, kvp.second.data(), substitution_context);
-                    }
-                };
-                if (presets == &this->printers) {
-                    // Select the default config based on the printer_technology field extracted from kvp.
-                    DynamicPrintConfig config_src;
-                    parse_config_section(config_src);
-                    default_config = &presets->default_preset_for(config_src).config;
-                    config = *default_config;
-                    config.apply(config_src);
-                } else {
-                    default_config = &presets->default_preset().config;
-                    config = *default_config;
-                    parse_config_section(config);
-                }
-            } catch (const ConfigurationError &e) {
-                throw ConfigurationError(format("Invalid configuration bundle \"%1%\", section [%2%]: ", path, section.first) + e.what());
-            }
+            // Load the print, filament or printer preset parsed above.
+            assert(parsed.presets == presets);
+            if (parsed.error)
+                std::rethrow_exception(parsed.error);
+            const DynamicPrintConfig *default_config = parsed.default_config;
+            DynamicPrintConfig        config         = std::move(parsed.config);
+            std::string 			  alias_name     = std::move(parsed.alias_name);
+            std::vector<std::string>  renamed_from   = std::move(parsed.renamed_from);
+            substitution_context.substitutions = std::move(parsed.substitutions);
             Preset::normalize(config);
             // Report configuration fields, which are misplaced into a wrong group.
             std::string incorrect_keys = Preset::remove_invalid_keys(config, *default_config);
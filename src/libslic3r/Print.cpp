@@ -22,6 +22,8 @@
 ///|/
 #include "Exception.hpp"
 #include "Print.hpp"
+#include "PrintObjectCache.hpp"
+#include "ProfilerTracy.hpp"
 #include "BoundingBox.hpp"
 #include "Brim.hpp"
 #include "ClipperUtils.hpp"
@@ -41,7 +43,9 @@
 #include <float.h>
 
 #include <algorithm>
+#include <atomic>
 #include <limits>
+#include <numeric>
 #include <string>
 #include <unordered_set>
 #include <boost/filesystem/path.hpp>
@@ -54,12 +58,39 @@ namespace Slic3r {
 template class PrintState<PrintStep, psCount>;
 template class PrintState<PrintObjectStep, posCount>;
 
+const char* print_step_name(PrintStep step)
+{
+    switch (step) {
+    case psWipeTower:               return "WipeTower";
+    case psAlertWhenSupportsNeeded: return "AlertWhenSupportsNeeded";
+    case psSkirtBrim:               return "SkirtBrim";
+    case psGCodeExport:             return "GCodeExport";
+    default:                        assert(false); return "Unknown";
+    }
+}
+
+const char* print_object_step_name(PrintObjectStep step)
+{
+    switch (step) {
+    case posSlice:                          return "Slice";
+    case posPerimeters:                     return "Perimeters";
+    case posPrepareInfill:                  return "PrepareInfill";
+    case posInfill:                         return "Infill";
+    case posIroning:                        return "Ironing";
+    case posSupportSpotsSearch:             return "SupportSpotsSearch";
+    case posSupportMaterial:                return "SupportMaterial";
+    case posEstimateCurledExtrusions:       return "EstimateCurledExtrusions";
+    case posCalculateOverhangingPerimeters: return "CalculateOverhangingPerimeters";
+    default:                                assert(false); return "Unknown";
+    }
+}
+
 PrintRegion::PrintRegion(const PrintRegionConfig &config) : PrintRegion(config, config.hash()) {}
 PrintRegion::PrintRegion(PrintRegionConfig &&config) : PrintRegion(std::move(config), config.hash()) {}
 
 void Print::clear() 
 {
-	std::scoped_lock<std::mutex> lock(this->state_mutex());
+	std::scoped_lock<PrintStateMutex> lock(this->state_mutex());
     // The following call should stop background processing if it is running.
     this->invalidate_all_steps();
 	for (PrintObject *object : m_objects)
@@ -67,6 +98,7 @@ void Print::clear()
 	m_objects.clear();
     m_print_regions.clear();
     m_model.clear_objects();
+    m_gcode_layer_cache.reset();
 }
 
 // Called by Print::apply().
@@ -296,7 +328,7 @@ bool Print::is_step_done(PrintObjectStep step) const
 {
     if (m_objects.empty())
         return false;
-    std::scoped_lock<std::mutex> lock(this->state_mutex());
+    std::scoped_lock<PrintStateMutex> lock(this->state_mutex());
     for (const PrintObject *object : m_objects)
         if (! object->is_step_done_unguarded(step))
             return false;
@@ -412,7 +444,7 @@ bool Print::has_brim() const
 
 bool Print::sequential_print_horizontal_clearance_valid(const Print& print, Polygons* polygons)
 {
-	Polygons convex_hulls_other;
+	Polygons convex_hulls;
     if (polygons != nullptr)
         polygons->clear();
     std::vector<size_t> intersecting_idxs;
@@ -445,33 +477,44 @@ bool Print::sequential_print_horizontal_clearance_valid(const Print& print, Poly
 		const double z_diff = Geometry::rotation_diff_z(model_instance0->get_matrix(), print_object->instances().front().model_instance->get_matrix());
 		if (std::abs(z_diff) > EPSILON)
 			convex_hull0.rotate(z_diff);
-	    // Now we check that no instance of convex_hull intersects any of the previously checked object instances.
 	    for (const PrintInstance &instance : print_object->instances()) {
-	        Polygon convex_hull = convex_hull0;
+	        Polygon &convex_hull = convex_hulls.emplace_back(convex_hull0);
 	        // instance.shift is a position of a centered object, while model object may not be centered.
 	        // Convert the shift from the PrintObject's coordinates into ModelObject's coordinates by removing the centering offset.
 	        convex_hull.translate(instance.shift - print_object->center_offset());
-            // if output needed, collect indices (inside convex_hulls_other) of intersecting hulls
-            for (size_t i = 0; i < convex_hulls_other.size(); ++i) {
-                if (! intersection(convex_hulls_other[i], convex_hull).empty()) {
-                    if (polygons == nullptr)
-                        return false;
-                    else {
-                        intersecting_idxs.emplace_back(i);
-                        intersecting_idxs.emplace_back(convex_hulls_other.size());
-                    }
-                }
-            }
-            convex_hulls_other.emplace_back(std::move(convex_hull));
 	    }
 	}
 
+    // Now we check that no two instances intersect. Sweep and prune: Sweep the instances sorted by the left side
+    // of their bounding boxes, only the instances with overlapping bounding boxes are tested for intersection.
+    std::vector<BoundingBox> bboxes;
+    bboxes.reserve(convex_hulls.size());
+    for (const Polygon &convex_hull : convex_hulls)
+        bboxes.emplace_back(get_extents(convex_hull));
+    std::vector<size_t> sorted(convex_hulls.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::sort(sorted.begin(), sorted.end(), [&bboxes](size_t l, size_t r) { return bboxes[l].min.x() < bboxes[r].min.x(); });
+    std::vector<size_t> active;
+    for (size_t i : sorted) {
+        const BoundingBox &bbox = bboxes[i];
+        active.erase(std::remove_if(active.begin(), active.end(), [&bboxes, &bbox](size_t j) { return bboxes[j].max.x() < bbox.min.x(); }), active.end());
+        for (size_t j : active)
+            if (bboxes[j].overlap(bbox) && ! intersection(convex_hulls[j], convex_hulls[i]).empty()) {
+                if (polygons == nullptr)
+                    return false;
+                // if output needed, collect indices (inside convex_hulls) of intersecting hulls
+                intersecting_idxs.emplace_back(i);
+                intersecting_idxs.emplace_back(j);
+            }
+        active.emplace_back(i);
+    }
+
     if (!intersecting_idxs.empty()) {
-        // use collected indices (inside convex_hulls_other) to update output
+        // use collected indices (inside convex_hulls) to update output
         std::sort(intersecting_idxs.begin(), intersecting_idxs.end());
         intersecting_idxs.erase(std::unique(intersecting_idxs.begin(), intersecting_idxs.end()), intersecting_idxs.end());
         for (size_t i : intersecting_idxs) {
-            polygons->emplace_back(std::move(convex_hulls_other[i]));
+            polygons->emplace_back(std::move(convex_hulls[i]));
         }
         return false;
     }
@@ -934,34 +977,66 @@ void Print::auto_assign_extruders(ModelObject* model_object) const
 // Slicing process, running at a background thread.
 void Print::process()
 {
+    SLIC3R_PROFILE_ZONE();
     name_tbb_thread_pool_threads_set_locale();
 
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
 
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1), [this](const tbb::blocked_range<size_t> &range) {
-        for (size_t idx = range.begin(); idx < range.end(); ++idx) {
-            m_objects[idx]->make_perimeters();
-            m_objects[idx]->infill();
-            m_objects[idx]->ironing();
+    // Each PrintObject runs its steps as soon as the preceding steps of the same PrintObject finish, without waiting
+    // for the other PrintObjects. The per layer parallel loops of the individual steps are nested into the per object loop,
+    // so that idle threads steal work from the other PrintObjects instead of waiting at a barrier between the steps.
+    // This matters for plates full of small objects, where a single step of a single object does not saturate the cores.
+    // With a memory budget set, the extrusions of the objects finished above the budget are moved into temporary files
+    // and loaded back once all objects are processed, as the wipe tower, skirt, brim and G-code export need all of them.
+    std::atomic<size_t> extrusions_memsize { 0 };
+    auto restore_extrusions = [this]() {
+        for (PrintObject *obj : m_objects)
+            obj->restore_extrusions();
+    };
+    try {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1), [this, &extrusions_memsize](const tbb::blocked_range<size_t> &range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++idx) {
+                PrintObject &obj = *m_objects[idx];
+                // Reuse the layers produced by slicing the same object before, possibly with another printer profile.
+                std::string cache_key;
+                if (PrintObjectCache::enabled() && ! obj.is_step_done(posInfill)) {
+                    cache_key = PrintObjectCache::key(obj);
+                    if (PrintObjectCache::load(obj, cache_key))
+                        cache_key.clear();
+                }
+                obj.make_perimeters();
+                obj.infill();
+                if (! cache_key.empty())
+                    PrintObjectCache::store(obj, cache_key);
+                obj.ironing();
+                if (m_release_intermediate_data)
+                    obj.release_infill_data();
+                // Writes to m_shared_regions shared with the other PrintObjects of the same ModelObject, guarded by a mutex.
+                obj.generate_support_spots();
+                obj.generate_support_material();
+                obj.estimate_curled_extrusions();
+                obj.calculate_overhanging_perimeters();
+                if (m_memory_budget > 0) {
+                    size_t memsize = obj.extrusions_memsize();
+                    if (extrusions_memsize.fetch_add(memsize) + memsize > m_memory_budget && obj.spill_extrusions())
+                        extrusions_memsize -= memsize;
+                }
+            }
+        }, tbb::simple_partitioner());
+    } catch (...) {
+        try {
+            restore_extrusions();
+        } catch (const std::exception &ex) {
+            BOOST_LOG_TRIVIAL(error) << ex.what();
         }
-    }, tbb::simple_partitioner());
+        throw;
+    }
+    restore_extrusions();
 
-    // The following step writes to m_shared_regions, it should not run in parallel.
-    for (PrintObject *obj : m_objects)
-        obj->generate_support_spots();
-    // check data from previous step, format the error message(s) and send alert to ui
-    // this also has to be done sequentially.
+    // Check the support spots of all objects, format the error message(s) and send alert to ui.
+    // This has to be done sequentially.
     alert_when_supports_needed();
 
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1), [this](const tbb::blocked_range<size_t> &range) {
-        for (size_t idx = range.begin(); idx < range.end(); ++idx) {
-            PrintObject &obj = *m_objects[idx];
-            obj.generate_support_material();
-            obj.estimate_curled_extrusions();
-            obj.calculate_overhanging_perimeters();
-        }
-    }, tbb::simple_partitioner());
-
     if (this->set_started(psWipeTower)) {
         m_wipe_tower_data.clear();
         m_tool_ordering.clear();
@@ -1030,8 +1105,10 @@ void Print::process()
 // The export_gcode may die for various reasons (fails to process output_filename_format,
 // write error into the G-code, cannot execute post-processing scripts).
 // It is up to the caller to show an error message.
-std::string Print::export_gcode(const std::string& path_template, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb)
+std::string Print::export_gcode(const std::string& path_template, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb,
+                                GCodeProcessorResultCallback preview_cb)
 {
+    SLIC3R_PROFILE_ZONE();
     // output everything to a G-code file
     // The following call may die if the output_filename_format template substitution fails.
     std::string path = this->output_filepath(path_template);
@@ -1047,7 +1124,7 @@ std::string Print::export_gcode(const std::string& path_template, GCodeProcessor
 
     // Create GCode on heap, it has quite a lot of data.
     std::unique_ptr<GCodeGenerator> gcode(new GCodeGenerator);
-    gcode->do_export(this, path.c_str(), result, thumbnail_cb);
+    gcode->do_export(this, path.c_str(), result, thumbnail_cb, std::move(preview_cb));
 
     if (m_conflict_result.has_value())
         result->conflict_result = *m_conflict_result;
@@ -1057,6 +1134,7 @@ std::string Print::export_gcode(const std::string& path_template, GCodeProcessor
 
 void Print::_make_skirt()
 {
+    SLIC3R_PROFILE_ZONE();
     // First off we need to decide how tall the skirt must be.
     // The skirt_height option from config is expressed in layers, but our
     // object might have different layer heights, so we need to find the print_z
@@ -1453,6 +1531,7 @@ const WipeTowerData& Print::wipe_tower_data(size_t extruders_cnt) const
 
 void Print::_make_wipe_tower()
 {
+    SLIC3R_PROFILE_ZONE();
     m_wipe_tower_data.clear();
     if (! this->has_wipe_tower())
         return;
@@ -43,6 +43,7 @@
 #include <Eigen/Geometry>
 
 #include <functional>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <tcbspan/span.hpp>
@@ -50,10 +51,13 @@
 namespace Slic3r {
 
 class GCodeGenerator;
+namespace GCode { struct LayerResultCache; }
 class Layer;
 class ModelObject;
 class Print;
 class PrintObject;
+struct PrintObjectSliceCache;
+struct PrintObjectSeamData;
 class SupportLayer;
 
 namespace FillAdaptive {
@@ -90,6 +94,10 @@ enum PrintObjectStep : unsigned int {
     posInfill, posIroning, posSupportSpotsSearch, posSupportMaterial, posEstimateCurledExtrusions, posCalculateOverhangingPerimeters, posCount,
 };
 
+// Names of the steps for profiling reports.
+const char* print_step_name(PrintStep step);
+const char* print_object_step_name(PrintObjectStep step);
+
 // A PrintRegion object represents a group of volumes to print
 // sharing the same config (including the same assigned extruder(s))
 class PrintRegion
@@ -239,6 +247,9 @@ public:
     std::vector<ObjectID>                       cached_volume_ids;
 
     std::optional<GeneratedSupportPoints> generated_support_points;
+    // Guards generated_support_points, which are calculated by the first of the PrintObjects sharing these regions
+    // while the other PrintObjects are being processed in parallel.
+    std::mutex                            generated_support_points_mutex;
 
     void ref_cnt_inc() { ++ m_ref_cnt; }
     void ref_cnt_dec() { if (-- m_ref_cnt == 0) delete this; }
@@ -327,6 +338,9 @@ public:
     // The slicing parameters are dependent on various configuration values
     // (layer height, first layer height, raft settings, print nozzle diameter etc).
     const SlicingParameters&    slicing_parameters() const { return m_slicing_params; }
+    // Seam placement data of the last G-code export, kept until the perimeters are invalidated, see SeamPlacer::init().
+    const std::shared_ptr<PrintObjectSeamData>& seam_data() const { return m_seam_data; }
+    void                        set_seam_data(std::shared_ptr<PrintObjectSeamData> seam_data) { m_seam_data = std::move(seam_data); }
     static SlicingParameters    slicing_parameters(const DynamicPrintConfig &full_config, const ModelObject &model_object, float object_max_z);
 
     size_t                      num_printing_regions() const throw() { return m_shared_regions->all_regions.size(); }
@@ -359,6 +373,8 @@ private:
     // to be called from Print only.
     friend class Print;
     friend class PrintBaseWithState<PrintStep, psCount>;
+    // Restores m_layers and the step states.
+    friend class PrintObjectCache;
 
 	PrintObject(Print* print, ModelObject* model_object, const Transform3d& trafo, PrintInstances&& instances);
     ~PrintObject() override {
@@ -391,16 +407,32 @@ private:
     void make_perimeters();
     void prepare_infill();
     void clear_fills();
+    void clear_ironing();
     void infill();
     void ironing();
+    // Release the infill regions, which are only needed by infill() and ironing().
+    void release_infill_data();
     void generate_support_spots();
     void generate_support_material();
     void estimate_curled_extrusions();
     void calculate_overhanging_perimeters();
+    // Build Layer::lslices_distancer() for the layers missing it.
+    void build_lslices_distancers();
+
+    // Estimate of the memory held by the extrusions of the layers and support layers.
+    size_t extrusions_memsize() const;
+    // Move the extrusions of the layers and support layers into a temporary file to lower the peak memory
+    // while the other PrintObjects are being processed. Returns false if the extrusions could not be written.
+    bool spill_extrusions();
+    // Load the extrusions back from the temporary file and delete it. Throws if the file could not be read.
+    void restore_extrusions();
+    bool extrusions_spilled() const { return ! m_spill_path.empty(); }
 
     void slice_volumes();
     // Has any support (not counting the raft).
     void detect_surfaces_type();
+    // Classify a single layer of a single region. surfaces_new: Output of the classification with interface shells, otherwise nullptr.
+    void detect_surfaces_type(size_t region_id, size_t idx_layer, Surfaces *surfaces_new);
     void process_external_surfaces();
     void discover_vertical_shells();
     void bridge_over_infill();
@@ -434,9 +466,20 @@ private:
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
     bool                    				m_typed_slices = false;
+    // Set by make_perimeters() if it already classified the slices layer by layer, consumed by prepare_infill().
+    bool                                    m_surfaces_detected_by_perimeters = false;
+    // Set by ironing() once LayerRegion::m_ironing_areas were calculated, reset if the top surfaces or the ironing type change.
+    bool                                    m_ironing_areas_valid = false;
 
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
     FillLightning::GeneratorPtr m_lightning_generator;
+
+    // Slices of the ModelVolumes retained from the last slice_volumes() call, reused by the layers whose Z did not change.
+    std::shared_ptr<PrintObjectSliceCache> m_slice_cache;
+    // Seam candidates with their visibility and the picked seams, see seam_data().
+    std::shared_ptr<PrintObjectSeamData>   m_seam_data;
+    // Temporary file holding the extrusions moved out of memory by spill_extrusions().
+    std::string                             m_spill_path;
 };
 
 
@@ -581,10 +624,18 @@ public:
     void                process() override;
     void                finalize() override { PrintBaseWithState<PrintStep, psCount>::finalize_impl(m_objects); }
     void                cleanup() override;
+    // Release the intermediate data of the PrintObjects as soon as the following steps no longer need it, to lower the peak memory.
+    // The released steps cannot be recalculated incrementally, thus it is only meant for slicing once from the command line.
+    void                set_release_intermediate_data(bool release) { m_release_intermediate_data = release; }
+    // Once the extrusions of the PrintObjects processed so far exceed the budget (in bytes), the extrusions of the following
+    // PrintObjects are moved into temporary files until all PrintObjects are processed. Zero for no limit.
+    void                set_memory_budget(size_t bytes) { m_memory_budget = bytes; }
 
     // Exports G-code into a file name based on the path_template, returns the file path of the generated G-code file.
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
-    std::string         export_gcode(const std::string& path_template, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
+    // If preview_cb is set, it is called from the exporting thread with snapshots of the G-code generated so far.
+    std::string         export_gcode(const std::string& path_template, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb = nullptr,
+                                     GCodeProcessorResultCallback preview_cb = nullptr);
 
     // methods for handling state
     bool                is_step_done(PrintStep step) const { return Inherited::is_step_done(step); }
@@ -713,6 +764,13 @@ private:
     // Cache to store sequential print clearance contours
     Polygons m_sequential_print_clearance_contours;
 
+    // G-code of the layers of the last G-code export to be reused by the next export if only
+    // the end G-code or settings applied after the layer loop changed, see GCode::LayerResultCache.
+    std::shared_ptr<GCode::LayerResultCache> m_gcode_layer_cache;
+
+    bool                                    m_release_intermediate_data { false };
+    size_t                                  m_memory_budget { 0 };
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCodeGenerator;
     // To allow GCodeProcessor to emit warnings.
@@ -7,6 +7,8 @@
 
 #include <cfloat>
 
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 // Add or remove support modifier ModelVolumes from model_object_dst to match the ModelVolumes of model_object_new
@@ -56,8 +58,10 @@ namespace Slic3r {
             delete mv_with_status.first;
 }
 
-static inline void model_volume_list_copy_configs(ModelObject &model_object_dst, const ModelObject &model_object_src, const ModelVolumeType type)
+// Returns true if a config of any of the ModelVolumes changed.
+static inline bool model_volume_list_copy_configs(ModelObject &model_object_dst, const ModelObject &model_object_src, const ModelVolumeType type)
 {
+    bool   configs_changed = false;
     size_t i_src, i_dst;
     for (i_src = 0, i_dst = 0; i_src < model_object_src.volumes.size() && i_dst < model_object_dst.volumes.size();) {
         const ModelVolume &mv_src = *model_object_src.volumes[i_src];
@@ -73,6 +77,7 @@ static inline void model_volume_list_copy_configs(ModelObject &model_object_dst,
         assert(mv_src.id() == mv_dst.id());
         // Copy the ModelVolume data.
         mv_dst.name   = mv_src.name;
+        configs_changed |= ! mv_dst.config.timestamp_matches(mv_src.config);
 		mv_dst.config.assign_config(mv_src.config);
         assert(mv_dst.supported_facets.id() == mv_src.supported_facets.id());
         mv_dst.supported_facets.assign(mv_src.supported_facets);
@@ -85,11 +90,14 @@ static inline void model_volume_list_copy_configs(ModelObject &model_object_dst,
         ++ i_src;
         ++ i_dst;
     }
+    return configs_changed;
 }
 
-static inline void layer_height_ranges_copy_configs(t_layer_config_ranges &lr_dst, const t_layer_config_ranges &lr_src)
+// Returns true if a config of any of the layer ranges changed.
+static inline bool layer_height_ranges_copy_configs(t_layer_config_ranges &lr_dst, const t_layer_config_ranges &lr_src)
 {
     assert(lr_dst.size() == lr_src.size());
+    bool configs_changed = false;
     auto it_src = lr_src.cbegin();
     for (auto &kvp_dst : lr_dst) {
         const auto &kvp_src = *it_src ++;
@@ -97,8 +105,12 @@ static inline void layer_height_ranges_copy_configs(t_layer_config_ranges &lr_ds
         assert(std::abs(kvp_dst.first.second - kvp_src.first.second) <= EPSILON);
         // Layer heights are allowed do differ in case the layer height table is being overriden by the smooth profile.
         // assert(std::abs(kvp_dst.second.option("layer_height")->getFloat() - kvp_src.second.option("layer_height")->getFloat()) <= EPSILON);
-        kvp_dst.second = kvp_src.second;
+        if (! kvp_dst.second.timestamp_matches(kvp_src.second)) {
+            kvp_dst.second = kvp_src.second;
+            configs_changed = true;
+        }
     }
+    return configs_changed;
 }
 
 static inline bool transform3d_lower(const Transform3d &lhs, const Transform3d &rhs) 
@@ -126,6 +138,18 @@ static inline bool transform3d_equal(const Transform3d &lhs, const Transform3d &
     return true;
 }
 
+// Do the two transformations differ by the translation in Z only? That is the case for an object being lifted or sunk below the bed.
+static inline bool transform3d_equal_but_z_translation(const Transform3d &lhs, const Transform3d &rhs) 
+{
+    typedef Transform3d::Scalar T;
+    const T *lv = lhs.data();
+    const T *rv = rhs.data();
+    for (size_t i = 0; i < 16; ++ i, ++ lv, ++ rv)
+        if (i != 14 && *lv != *rv)
+            return false;
+    return true;
+}
+
 struct PrintObjectTrafoAndInstances
 {
     Transform3d    	trafo;
@@ -348,6 +372,9 @@ struct ModelObjectStatus {
     PrintObjectRegions                         *print_object_regions { nullptr };
     // Status of the above.
     PrintObjectRegionsStatus                    print_object_regions_status { PrintObjectRegionsStatus::Invalid };
+    // Did apply() change the config of the ModelObject, of its ModelVolumes or of its layer ranges?
+    // If not, the region configs may only change with the default region config or with the number of extruders.
+    bool                                        configs_changed { true };
 
     // Search by id.
     bool operator<(const ModelObjectStatus &rhs) const { return id < rhs.id; }
@@ -506,6 +533,13 @@ static PrintObjectRegions::BoundingBox transformed_its_bbox2d(const indexed_tria
     return bbox;
 }
 
+// The bounding box of a mesh is the bounding box of its convex hull, which has usually much fewer vertices than the mesh.
+static const indexed_triangle_set& its_for_bbox(const ModelVolume &model_volume)
+{
+    const std::shared_ptr<const TriangleMesh> &convex_hull = model_volume.get_convex_hull_shared_ptr();
+    return convex_hull && ! convex_hull->empty() ? convex_hull->its : model_volume.mesh().its;
+}
+
 static void transformed_its_bboxes_in_z_ranges(
     const indexed_triangle_set                                    &its, 
     const Transform3f                                             &m,
@@ -784,19 +818,34 @@ void update_volume_bboxes(
     // output will be sorted by the order of model_volumes sorted by their ObjectIDs.
     model_volumes_sort_by_id(model_volumes);
 
+    // Volumes with their bounding boxes not cached, their bounding boxes are calculated in parallel.
+    std::vector<const ModelVolume*> volumes_to_update;
+    for (const ModelVolume *model_volume : model_volumes)
+        if (model_volume_solid_or_modifier(*model_volume) && ! std::binary_search(cached_volume_ids.begin(), cached_volume_ids.end(), model_volume->id()))
+            volumes_to_update.emplace_back(model_volume);
+
     if (layer_ranges.size() == 1) {
+        std::vector<PrintObjectRegions::BoundingBox> bboxes_updated(volumes_to_update.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, volumes_to_update.size()), 
+            [&volumes_to_update, &bboxes_updated, &object_trafo, offset](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                const ModelVolume &model_volume = *volumes_to_update[i];
+                // The full extent of a volume is requested, the bounding box of its convex hull is exact.
+                bboxes_updated[i] = transformed_its_bbox2d(its_for_bbox(model_volume), trafo_for_bbox(object_trafo, model_volume.get_matrix()), offset);
+            }
+        });
         PrintObjectRegions::LayerRangeRegions &layer_range = layer_ranges.front();
         std::vector<PrintObjectRegions::VolumeExtents> volumes_old(std::move(layer_range.volumes));
         layer_range.volumes.reserve(model_volumes.size());
+        auto it_updated = volumes_to_update.begin();
         for (const ModelVolume *model_volume : model_volumes)
             if (model_volume_solid_or_modifier(*model_volume)) {
-                if (std::binary_search(cached_volume_ids.begin(), cached_volume_ids.end(), model_volume->id())) {
+                if (it_updated == volumes_to_update.end() || *it_updated != model_volume) {
                     auto it = lower_bound_by_predicate(volumes_old.begin(), volumes_old.end(), [model_volume](PrintObjectRegions::VolumeExtents &l) { return l.volume_id < model_volume->id(); });
                     if (it != volumes_old.end() && it->volume_id == model_volume->id())
                         layer_range.volumes.emplace_back(*it);
                 } else
-                    layer_range.volumes.push_back({ model_volume->id(),
-                        transformed_its_bbox2d(model_volume->mesh().its, trafo_for_bbox(object_trafo, model_volume->get_matrix()), offset) });
+                    layer_range.volumes.push_back({ model_volume->id(), bboxes_updated[it_updated ++ - volumes_to_update.begin()] });
             }
     } else {
         std::vector<std::vector<PrintObjectRegions::VolumeExtents>> volumes_old;
@@ -809,7 +858,6 @@ void update_volume_bboxes(
                 volumes_old.emplace_back(std::move(layer_range.volumes));
         }
 
-        std::vector<std::pair<PrintObjectRegions::BoundingBox, bool>> bboxes;
         std::vector<t_layer_height_range>                             ranges;
         ranges.reserve(layer_ranges.size());
         for (const PrintObjectRegions::LayerRangeRegions &layer_range : layer_ranges) {
@@ -818,9 +866,19 @@ void update_volume_bboxes(
             r.second += EPSILON;
             ranges.emplace_back(r);
         }
+        std::vector<std::vector<std::pair<PrintObjectRegions::BoundingBox, bool>>> bboxes_updated(volumes_to_update.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, volumes_to_update.size()), 
+            [&volumes_to_update, &bboxes_updated, &ranges, &object_trafo, offset](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                const ModelVolume &model_volume = *volumes_to_update[i];
+                // The extents of the volume sliced by the Z ranges are requested, thus the full mesh is needed.
+                transformed_its_bboxes_in_z_ranges(model_volume.mesh().its, trafo_for_bbox(object_trafo, model_volume.get_matrix()), ranges, bboxes_updated[i], offset);
+            }
+        });
+        auto it_updated = volumes_to_update.begin();
         for (const ModelVolume *model_volume : model_volumes)
             if (model_volume_solid_or_modifier(*model_volume)) {
-                if (std::binary_search(cached_volume_ids.begin(), cached_volume_ids.end(), model_volume->id())) {
+                if (it_updated == volumes_to_update.end() || *it_updated != model_volume) {
                     for (PrintObjectRegions::LayerRangeRegions &layer_range : layer_ranges) {
                         const auto &vold = volumes_old[&layer_range - layer_ranges.data()];
                         auto it = lower_bound_by_predicate(vold.begin(), vold.end(), [model_volume](const PrintObjectRegions::VolumeExtents &l) { return l.volume_id < model_volume->id(); });
@@ -828,7 +886,7 @@ void update_volume_bboxes(
                             layer_range.volumes.emplace_back(*it);
                     }
                 } else {
-                    transformed_its_bboxes_in_z_ranges(model_volume->mesh().its, trafo_for_bbox(object_trafo, model_volume->get_matrix()), ranges, bboxes, offset);
+                    const std::vector<std::pair<PrintObjectRegions::BoundingBox, bool>> &bboxes = bboxes_updated[it_updated ++ - volumes_to_update.begin()];
                     for (PrintObjectRegions::LayerRangeRegions &layer_range : layer_ranges)
                         if (auto &bbox = bboxes[&layer_range - layer_ranges.data()]; bbox.second)
                             layer_range.volumes.push_back({ model_volume->id(), bbox.first });
@@ -1000,7 +1058,7 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
         update_apply_status(false);
 
     // Grab the lock for the Print / PrintObject milestones.
-	std::scoped_lock<std::mutex> lock(this->state_mutex());
+	std::scoped_lock<PrintStateMutex> lock(this->state_mutex());
 
     // The following call may stop the background processing.
     if (! print_diff.empty())
@@ -1204,6 +1262,9 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
                 }
             } else if (model_custom_seam_data_changed(model_object, model_object_new)) {
                 update_apply_status(this->invalidate_step(psGCodeExport));
+                // The seam enforcers and blockers are baked into the seam data retained by the PrintObjects.
+                for (const PrintObjectStatus &print_object_status : print_objects_range)
+                    print_object_status.print_object->set_seam_data(nullptr);
             }
         }
         if (! solid_or_modifier_differ) {
@@ -1223,9 +1284,10 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
             }
             // Synchronize (just copy) the remaining data of ModelVolumes (name, config, custom supports data).
             //FIXME What to do with m_material_id?
-			model_volume_list_copy_configs(model_object /* dst */, model_object_new /* src */, ModelVolumeType::MODEL_PART);
-			model_volume_list_copy_configs(model_object /* dst */, model_object_new /* src */, ModelVolumeType::PARAMETER_MODIFIER);
-            layer_height_ranges_copy_configs(model_object.layer_config_ranges /* dst */, model_object_new.layer_config_ranges /* src */);
+            bool volume_configs_changed = model_volume_list_copy_configs(model_object /* dst */, model_object_new /* src */, ModelVolumeType::MODEL_PART);
+            volume_configs_changed |= model_volume_list_copy_configs(model_object /* dst */, model_object_new /* src */, ModelVolumeType::PARAMETER_MODIFIER);
+            bool layer_range_configs_changed = layer_height_ranges_copy_configs(model_object.layer_config_ranges /* dst */, model_object_new.layer_config_ranges /* src */);
+            model_object_status.configs_changed = object_config_changed || volume_configs_changed || layer_range_configs_changed;
             // Copy the ModelObject name, input_file and instances. The instances will be compared against PrintObject instances in the next step.
             model_object.name       = model_object_new.name;
             model_object.input_file = model_object_new.input_file;
@@ -1317,6 +1379,17 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
 					const_cast<PrintObjectStatus*>(*it_old)->status = PrintObjectStatus::Reused;
 				}
             }
+            // An object moved in Z (lifted or sunk below the bed) is replaced by a new PrintObject.
+            // Hand over the volume slices of the PrintObject being deleted, the slices are kept in mesh space
+            // and the new PrintObject will slice only the layers not matching the old slicing planes.
+            for (auto it_new = print_objects_new.end() - model_object_status.print_instances.size(); it_new != print_objects_new.end(); ++ it_new)
+                if (PrintObject *print_object = *it_new; ! print_object->m_slice_cache)
+                    for (const PrintObjectStatus *print_object_status : old)
+                        if (print_object_status->status != PrintObjectStatus::Reused && print_object_status->print_object->m_slice_cache &&
+                            transform3d_equal_but_z_translation(print_object_status->trafo, print_object->trafo())) {
+                            print_object->m_slice_cache = std::move(print_object_status->print_object->m_slice_cache);
+                            break;
+                        }
         }
         if (m_objects != print_objects_new) {
             this->call_cancel_callback();
@@ -1376,6 +1449,8 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
                 print_object_regions->clear();
                 model_object_status.print_object_regions_status = ModelObjectStatus::PrintObjectRegionsStatus::Invalid;
                 print_regions_reshuffled = true;
+            } else if (print_object_regions && ! model_object_status.configs_changed && region_diff.empty() && ! num_extruders_changed) {
+                // None of the inputs of the region configs changed, skip verifying the regions one by one.
             } else if (print_object_regions &&
                 verify_update_print_object_regions(
                     print_object.model_object()->volumes,
@@ -111,7 +111,16 @@ void PrintBase::status_update_warnings(int step, PrintStateBase::WarningLevel /*
         printf("%s warning: %s\n",  print_object ? "print_object" : "print", message.c_str());
 }
 
-std::mutex& PrintObjectBase::state_mutex(PrintBase *print)
+void PrintBase::step_finished(const char *category, const char *step, const PrintObjectBase *print_object, const Profiler::StepStart &start)
+{
+    Profiler::StepStart  end    = Profiler::step_start();
+    Profiler::StepMemory memory = Profiler::step_memory(start.memory, end.memory);
+    Profiler::record(category, step, print_object ? print_object->model_object()->name.c_str() : nullptr, -1, start.nanoseconds, end.nanoseconds, &memory);
+    if (m_step_callback)
+        m_step_callback(step, print_object, double(end.nanoseconds - start.nanoseconds) * 1e-9, memory);
+}
+
+PrintStateMutex& PrintObjectBase::state_mutex(PrintBase *print)
 { 
 	return print->state_mutex();
 }
@@ -126,4 +135,14 @@ void PrintObjectBase::status_update_warnings(PrintBase *print, int step, PrintSt
     print->status_update_warnings(step, warning_level, message, this);
 }
 
+Profiler::StepStart PrintObjectBase::step_start(const PrintBase *print)
+{
+    return print->step_start();
+}
+
+void PrintObjectBase::step_finished(PrintBase *print, const char *step, const Profiler::StepStart &start)
+{
+    print->step_finished("PrintObjectStep", step, this, start);
+}
+
 } // namespace Slic3r
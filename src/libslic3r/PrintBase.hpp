@@ -17,6 +17,8 @@
 #include "Model.hpp"
 #include "PlaceholderParser.hpp"
 #include "PrintConfig.hpp"
+#include "Profiler.hpp"
+#include "ProfilerTracy.hpp"
 
 namespace Slic3r {
 
@@ -25,6 +27,10 @@ public:
    const char* what() const throw() { return "Background processing has been canceled"; }
 };
 
+// Mutex guarding the state of the print steps, shared by the UI thread and the background processing.
+// Its contention is tracked by the Tracy profiler if enabled.
+using PrintStateMutex = SLIC3R_PROFILE_LOCKABLE_TYPE(std::mutex);
+
 class PrintStateBase {
 public:
     enum class State {
@@ -119,23 +125,23 @@ class PrintState : public PrintStateBase
 public:
     PrintState() {}
 
-    StateWithTimeStamp state_with_timestamp(StepType step, std::mutex &mtx) const {
-        std::scoped_lock<std::mutex> lock(mtx);
+    StateWithTimeStamp state_with_timestamp(StepType step, PrintStateMutex &mtx) const {
+        std::scoped_lock<PrintStateMutex> lock(mtx);
         StateWithTimeStamp state = m_state[step];
         return state;
     }
 
-    StateWithWarnings state_with_warnings(StepType step, std::mutex &mtx) const {
-        std::scoped_lock<std::mutex> lock(mtx);
+    StateWithWarnings state_with_warnings(StepType step, PrintStateMutex &mtx) const {
+        std::scoped_lock<PrintStateMutex> lock(mtx);
         StateWithWarnings state = m_state[step];
         return state;
     }
 
-    bool is_started(StepType step, std::mutex &mtx) const {
+    bool is_started(StepType step, PrintStateMutex &mtx) const {
         return this->state_with_timestamp(step, mtx).state == State::Started;
     }
 
-    bool is_done(StepType step, std::mutex &mtx) const {
+    bool is_done(StepType step, PrintStateMutex &mtx) const {
         return this->state_with_timestamp(step, mtx).state == State::Done;
     }
 
@@ -170,8 +176,8 @@ public:
     // influence the processing step being entered.
     // Returns false if the step is not enabled or if the step has already been finished (it is done).
     template<typename ThrowIfCanceled>
-    bool set_started(StepType step, std::mutex &mtx, ThrowIfCanceled throw_if_canceled) {
-        std::scoped_lock<std::mutex> lock(mtx);
+    bool set_started(StepType step, PrintStateMutex &mtx, ThrowIfCanceled throw_if_canceled) {
+        std::scoped_lock<PrintStateMutex> lock(mtx);
         // If canceled, throw before changing the step state.
         throw_if_canceled();
 #ifndef NDEBUG
@@ -203,8 +209,8 @@ public:
     // 		Timestamp when this step entered the Done state.
     // 		bool indicates whether the UI has to update the slicing warnings of this step or not.
 	template<typename ThrowIfCanceled>
-	std::pair<TimeStamp, bool> set_done(StepType step, std::mutex &mtx, ThrowIfCanceled throw_if_canceled) {
-        std::scoped_lock<std::mutex> lock(mtx);
+	std::pair<TimeStamp, bool> set_done(StepType step, PrintStateMutex &mtx, ThrowIfCanceled throw_if_canceled) {
+        std::scoped_lock<PrintStateMutex> lock(mtx);
         // If canceled, throw before changing the step state.
         throw_if_canceled();
         assert(m_state[step].state == State::Started);
@@ -322,9 +328,9 @@ public:
     // Return value:
     // 		Current milestone (StepType).
     // 		bool indicates whether the UI has to be updated or not.
-    std::pair<StepType, bool> active_step_add_warning(PrintStateBase::WarningLevel warning_level, const std::string &message, int message_id, std::mutex &mtx)
+    std::pair<StepType, bool> active_step_add_warning(PrintStateBase::WarningLevel warning_level, const std::string &message, int message_id, PrintStateMutex &mtx)
     {
-        std::scoped_lock<std::mutex> lock(mtx);
+        std::scoped_lock<PrintStateMutex> lock(mtx);
         assert(m_step_active != -1);
         StateWithWarnings &state = m_state[m_step_active];
         assert(state.state == State::Started);
@@ -370,12 +376,15 @@ protected:
     PrintObjectBase(ModelObject *model_object) : m_model_object(model_object) {}
     virtual ~PrintObjectBase() {}
     // Declared here to allow access from PrintBase through friendship.
-	static std::mutex&                  state_mutex(PrintBase *print);
+	static PrintStateMutex&             state_mutex(PrintBase *print);
 	static std::function<void()>        cancel_callback(PrintBase *print);
 	// Notify UI about a new warning of a milestone "step" on this PrintObjectBase.
 	// The UI will be notified by calling a status callback registered on print.
 	// If no status callback is registered, the message is printed to console.
 	void 				   				status_update_warnings(PrintBase *print, int step, PrintStateBase::WarningLevel warning_level, const std::string &message);
+    // Timing of the steps for the Profiler and for the step callback registered on print.
+    static Profiler::StepStart           step_start(const PrintBase *print);
+    void                                step_finished(PrintBase *print, const char *step, const Profiler::StepStart &start);
 
     ModelObject                  *m_model_object;
 };
@@ -492,6 +501,12 @@ public:
     void                    set_status_silent() { m_status_callback = [](const SlicingStatus&){}; }
     // Register a custom status callback.
     void                    set_status_callback(status_callback_type cb) { m_status_callback = cb; }
+    // Called whenever a Print or PrintObject step finishes with the name of the step, the PrintObject (nullptr for the Print steps)
+    // and the duration of the step in seconds. Called from the worker threads, the PrintObjects are processed in parallel.
+    // memory: allocations and peak RSS accounted while the step was running. The counters are process wide,
+    // thus the steps of objects processed concurrently account each other's allocations.
+    typedef std::function<void(const char *step, const PrintObjectBase *print_object, double duration, const Profiler::StepMemory &memory)> step_callback_type;
+    void                    set_step_callback(step_callback_type cb) { m_step_callback = cb; }
     // Calls a registered callback to update the status, or print out the default message.
     void                    set_status(int percent, const std::string &message, unsigned int flags = SlicingStatus::DEFAULT) {
 		if (m_status_callback) m_status_callback(SlicingStatus(percent, message, flags));
@@ -535,13 +550,17 @@ protected:
 	friend class PrintObjectBase;
     friend class BackgroundSlicingProcess;
 
-    std::mutex&            state_mutex() const { return m_state_mutex; }
+    PrintStateMutex&       state_mutex() const { return m_state_mutex; }
     std::function<void()>  cancel_callback() { return m_cancel_callback; }
 	void				   call_cancel_callback() { m_cancel_callback(); }
 	// Notify UI about a new warning of a milestone "step" on this PrintBase.
 	// The UI will be notified by calling a status callback.
 	// If no status callback is registered, the message is printed to console.
     void 				   status_update_warnings(int step, PrintStateBase::WarningLevel warning_level, const std::string &message, const PrintObjectBase* print_object = nullptr);
+    // Start time and memory counters of a step to be passed to step_finished(), zero time if neither profiling nor a step callback is active.
+    Profiler::StepStart    step_start() const { return Profiler::enabled() || m_step_callback ? Profiler::step_start() : Profiler::StepStart{}; }
+    // Record the step for the Profiler and report it to the step callback.
+    void                   step_finished(const char *category, const char *step, const PrintObjectBase *print_object, const Profiler::StepStart &start);
 
     // If the background processing stop was requested, throw CanceledException.
     // To be called by the worker thread and its sub-threads (mostly launched on the TBB thread pool) regularly.
@@ -560,6 +579,7 @@ protected:
 
     // Callback to be evoked regularly to update state of the UI thread.
     status_callback_type                    m_status_callback;
+    step_callback_type                      m_step_callback;
 
 private:
     std::atomic<CancelStatus>               m_cancel_status;
@@ -570,7 +590,7 @@ private:
     // Mutex used for synchronization of the worker thread with the UI thread:
     // The mutex will be used to guard the worker thread against entering a stage
     // while the data influencing the stage is modified.
-    mutable std::mutex                      m_state_mutex;
+    mutable SLIC3R_PROFILE_LOCKABLE(std::mutex, m_state_mutex);
 
     friend PrintTryCancel;
 };
@@ -589,9 +609,19 @@ public:
     PrintStateBase::StateWithWarnings  step_state_with_warnings(PrintStepEnum step) const { return m_state.state_with_warnings(step, this->state_mutex()); }
 
 protected:
-    bool            set_started(PrintStepEnum step) { return m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintStepEnum step) {
+        bool started = m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
+        if (started)
+            m_step_started[step] = this->step_start();
+        return started;
+    }
 	PrintStateBase::TimeStamp set_done(PrintStepEnum step) { 
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
+        if (m_step_started[step].nanoseconds != 0) {
+            // print_step_name() is found by ADL for the Print and SLAPrint step enums.
+            this->step_finished("PrintStep", print_step_name(step), nullptr, m_step_started[step]);
+            m_step_started[step] = {};
+        }
         if (status.second)
             this->status_update_warnings(static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
         return status.first;
@@ -626,7 +656,7 @@ protected:
         static constexpr const auto PrintObjectStepEnumSize = int(PrintObject::PrintObjectStepEnumSize);
         using                       PrintObjectStepEnum     = typename PrintObject::PrintObjectStepEnum;
         // Grab the lock for the Print / PrintObject milestones.
-        std::scoped_lock<std::mutex> lock(this->state_mutex());
+        std::scoped_lock<PrintStateMutex> lock(this->state_mutex());
 
         int n_object_steps = int(params.to_object_step) + 1;
         if (n_object_steps == 0)
@@ -706,6 +736,11 @@ protected:
             size_t istep = (params.to_object_step != -1) ? 0 : size_t(params.to_print_step) + 1;
             for (; istep < PrintStepEnumSize; ++ istep)
                 m_state.enable_unguarded(PrintStepEnum(istep), false);
+        } else {
+            // The print steps may have been suppressed by a limited task, which is still running and which
+            // will now continue with the print steps.
+            for (size_t istep = 0; istep < PrintStepEnumSize; ++ istep)
+                m_state.enable_unguarded(PrintStepEnum(istep), true);
         }
     }
 
@@ -718,7 +753,7 @@ protected:
     void finalize_impl(std::vector<PrintObject*> &print_objects)
     {
         // Grab the lock for the Print / PrintObject milestones.
-        std::scoped_lock<std::mutex> lock(this->state_mutex());
+        std::scoped_lock<PrintStateMutex> lock(this->state_mutex());
         for (auto *po : print_objects)
             po->finalize_impl();
         m_state.enable_all_unguarded(true);
@@ -727,6 +762,8 @@ protected:
 
 private:
     PrintState<PrintStepEnum, COUNT>    m_state;
+    // Start of the steps being executed if timed, see step_start().
+    Profiler::StepStart                 m_step_started[COUNT] {};
 };
 
 template<typename PrintType, typename PrintObjectStepEnumType, const size_t COUNT>
@@ -762,10 +799,18 @@ public:
 protected:
 	PrintObjectBaseWithState(PrintType *print, ModelObject *model_object) : PrintObjectBase(model_object), m_print(print) {}
 
-    bool            set_started(PrintObjectStepEnum step) 
-        { return m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintObjectStepEnum step) {
+        bool started = m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
+        if (started)
+            m_step_started[step] = PrintObjectBase::step_start(m_print);
+        return started;
+    }
 	PrintStateBase::TimeStamp set_done(PrintObjectStepEnum step) { 
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
+        if (m_step_started[step].nanoseconds != 0) {
+            this->step_finished(m_print, print_object_step_name(step), m_step_started[step]);
+            m_step_started[step] = {};
+        }
         if (status.second)
             this->status_update_warnings(m_print, static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
         return status.first;
@@ -811,6 +856,8 @@ protected:
 
 private:
     PrintState<PrintObjectStepEnum, COUNT>    m_state;
+    // Start of the steps being executed if timed, see step_start().
+    Profiler::StepStart                       m_step_started[COUNT] {};
 };
 
 } // namespace Slic3r
@@ -2177,7 +2177,9 @@ void PrintConfigDef::init_fff_params()
     def->tooltip = L("If you want to process the output G-code through custom scripts, "
                    "just list their absolute paths here. Separate multiple scripts with a semicolon. "
                    "Scripts will be passed the absolute path to the G-code file as the first argument, "
-                   "and they can access the Slic3r config settings by reading environment variables.");
+                   "and they can access the Slic3r config settings by reading environment variables. "
+                   "A script prefixed with | is run as a filter: It reads the G-code from its standard input and writes "
+                   "the processed G-code to its standard output. Consecutive filters are chained and run at once.");
     def->gui_flags = "serialized";
     def->multiline = true;
     def->full_width = true;
@@ -4884,6 +4886,16 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->label = L("Save config file");
     def->tooltip = L("Save configuration to the specified file.");
     def->set_default_value(new ConfigOptionString());
+
+    def = this->add("serve", coBool);
+    def->label = L("Slicing service");
+    def->tooltip = L("Keep running and process the jobs read from the standard input, one JSON object per line, "
+                     "for example {\"id\": \"1\", \"args\": [\"--export-gcode\", \"--load\", \"config.ini\", \"model.stl\"]}. "
+                     "The args of a job are processed as the command line of a separate invocation. "
+                     "The config files and options supplied with --serve are loaded once and used as the base config of all the jobs. "
+                     "After each job, a JSON object with the job id and the result code is written to the standard output, "
+                     "the console output of the jobs is redirected to the standard error.");
+    def->set_default_value(new ConfigOptionBool(false));
 }
 
 CLITransformConfigDef::CLITransformConfigDef()
@@ -5023,12 +5035,70 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->label = L("Data directory");
     def->tooltip = L("Load and store settings at the given directory. This is useful for maintaining different profiles or including configurations from a network storage.");
 
+    def = this->add("threads", coInt);
+    def->label = L("Maximum number of threads");
+    def->tooltip = L("Limit the number of threads used by slicing and G-code export. "
+                     "By default all the CPU cores are used. To bind the threads to a subset of the cores, "
+                     "start the process with that CPU affinity, the thread pool respects it.");
+    def->min = 1;
+
     def = this->add("loglevel", coInt);
     def->label = L("Logging level");
     def->tooltip = L("Sets logging sensitivity. 0:fatal, 1:error, 2:warning, 3:info, 4:debug, 5:trace\n"
                      "For example. loglevel=2 logs fatal, error and warning level messages.");
     def->min = 0;
 
+    def = this->add("profile_report", coString);
+    def->label = L("Profiling report");
+    def->tooltip = L("Measure the duration of the slicing steps, of the per layer processing and count the polygon clipping operations. "
+                     "Account the peak memory usage of the slicing steps and, if compiled with SLIC3R_PROFILE_ALLOCATIONS, their allocations. "
+                     "Write a summary with per object and per layer histograms into the given JSON file.");
+
+    def = this->add("profile_trace", coString);
+    def->label = L("Profiling trace");
+    def->tooltip = L("Measure the duration of the slicing steps and of the per layer processing. "
+                     "Write the intervals into the given file in the Chrome trace event format.");
+
+    def = this->add("progress_json", coString);
+    def->label = L("Progress in JSON");
+    def->tooltip = L("Write the slicing progress into the given file, or to the standard output if \"-\", one JSON object per line. "
+                     "Each status update and each finished slicing step is reported with the time elapsed and the peak memory usage, "
+                     "the steps also with the object name, the duration of the step, the increase of the peak memory usage "
+                     "and, if compiled with SLIC3R_PROFILE_ALLOCATIONS, the number and the size of the allocations.");
+
+    def = this->add("cache_dir", coString);
+    def->label = L("Slicing cache directory");
+    def->tooltip = L("Store the sliced layers with their perimeters and infill and the support layers into the given directory "
+                     "and reuse them when slicing an object with the same geometry and object settings again, "
+                     "even with a different printer profile or custom G-code. "
+                     "The supports are stored into the support cache directory instead, if set.");
+
+    def = this->add("support_cache_dir", coString);
+    def->label = L("Support cache directory");
+    def->tooltip = L("Store the generated support layers into the given directory and reuse them when slicing an object "
+                     "with the same geometry, layer heights and support settings again.");
+
+    def = this->add("jobs", coInt);
+    def->label = L("Concurrent jobs");
+    def->tooltip = L("Number of the jobs processed concurrently in the service mode (--serve). "
+                     "Each job is limited to its share of the CPU cores, so that the jobs do not oversubscribe the machine. "
+                     "The cache directories of the concurrent jobs are the ones of the service and the profiling is not supported.");
+    def->min = 1;
+    def->set_default_value(new ConfigOptionInt(1));
+
+    def = this->add("release_intermediate_data", coBool);
+    def->label = L("Release intermediate data");
+    def->tooltip = L("Release the intermediate slicing data as soon as the following steps no longer need it "
+                     "to lower the peak memory consumption.");
+
+    def = this->add("memory_budget", coInt);
+    def->label = L("Memory budget");
+    def->tooltip = L("Once the extrusions of the objects sliced so far take more than the given number of megabytes, "
+                     "the extrusions of the following objects are moved into temporary files until all the objects are sliced. "
+                     "Slicing plates with many large objects is slower, but needs less memory. 0 for no limit.");
+    def->sidetext = L("MB");
+    def->min = 0;
+
 #if (defined(_MSC_VER) || defined(__MINGW32__)) && defined(SLIC3R_GUI)
     def = this->add("sw_renderer", coBool);
     def->label = L("Render with a software renderer");
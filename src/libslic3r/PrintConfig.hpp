@@ -360,6 +360,24 @@ protected:
         const std::vector<std::string>& keys()      const { return m_keys; }
         const T&                        defaults()  const { return *m_defaults; }
 
+        // Same as ConfigBase::diff() and ConfigBase::equals(), but the options are addressed by their offsets
+        // stored in the order of keys(), not looked up by their names.
+        t_config_option_keys diff(const T &lhs, const T &rhs) const
+        {
+            t_config_option_keys diff;
+            for (size_t i = 0; i < m_offsets.size(); ++ i)
+                if (*this->opt_at(lhs, i) != *this->opt_at(rhs, i))
+                    diff.emplace_back(m_keys[i]);
+            return diff;
+        }
+        bool                equals(const T &lhs, const T &rhs) const
+        {
+            for (size_t i = 0; i < m_offsets.size(); ++ i)
+                if (*this->opt_at(lhs, i) != *this->opt_at(rhs, i))
+                    return false;
+            return true;
+        }
+
         // To be called during the StaticCache setup.
         // Collect option keys from m_map_name_to_offset,
         // assign default values to m_defaults.
@@ -369,6 +387,8 @@ protected:
             m_defaults = defaults;
             m_keys.clear();
             m_keys.reserve(m_map_name_to_offset.size());
+            m_offsets.clear();
+            m_offsets.reserve(m_map_name_to_offset.size());
             for (const auto &kvp : defs->options) {
                 // Find the option given the option name kvp.first by an offset from (char*)m_defaults.
                 ConfigOption *opt = this->optptr(kvp.first, m_defaults);
@@ -376,6 +396,7 @@ protected:
                     // This option is not defined by the ConfigBase of type T.
                     continue;
                 m_keys.emplace_back(kvp.first);
+                m_offsets.emplace_back((const char*)opt - (const char*)m_defaults);
                 const ConfigOptionDef *def = defs->get(kvp.first);
                 assert(def != nullptr);
                 if (def->default_value)
@@ -384,8 +405,13 @@ protected:
         }
 
     private:
+        const ConfigOption* opt_at(const T &owner, size_t idx) const
+            { return reinterpret_cast<const ConfigOption*>((const char*)&owner + m_offsets[idx]); }
+
         T                                  *m_defaults;
         std::vector<std::string>            m_keys;
+        // Offsets of the options from the owner, in the order of m_keys.
+        std::vector<ptrdiff_t>              m_offsets;
     };
 };
 
@@ -401,6 +427,11 @@ public: \
     t_config_option_keys     keys() const override { return s_cache_##CLASS_NAME.keys(); } \
     const t_config_option_keys& keys_ref() const override { return s_cache_##CLASS_NAME.keys(); } \
     static const CLASS_NAME& defaults() { assert(s_cache_##CLASS_NAME.initialized()); return s_cache_##CLASS_NAME.defaults(); } \
+    /* Hides ConfigBase::diff() and ConfigBase::equals() for configs of the same type, which are compared option by option without looking them up by name. */ \
+    using ConfigBase::diff; \
+    using ConfigBase::equals; \
+    t_config_option_keys     diff(const CLASS_NAME &other) const { return s_cache_##CLASS_NAME.diff(*this, other); } \
+    bool                     equals(const CLASS_NAME &other) const { return s_cache_##CLASS_NAME.equals(*this, other); } \
 private: \
     friend int print_config_static_initializer(); \
     static void initialize_cache() \
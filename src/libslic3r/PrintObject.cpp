@@ -11,6 +11,7 @@
 #include "BridgeDetector.hpp"
 #include "ExPolygon.hpp"
 #include "Exception.hpp"
+#include "ProfilerTracy.hpp"
 #include "Flow.hpp"
 #include "GCode/ExtrusionProcessor.hpp"
 #include "KDTreeIndirect.hpp"
@@ -28,6 +29,7 @@
 #include "MutablePolygon.hpp"
 #include "PrintBase.hpp"
 #include "PrintConfig.hpp"
+#include "Support/SupportCache.hpp"
 #include "Support/SupportMaterial.hpp"
 #include "Support/TreeSupport.hpp"
 #include "Surface.hpp"
@@ -38,6 +40,7 @@
 #include "Utils.hpp"
 #include "Fill/FillAdaptive.hpp"
 #include "Fill/FillLightning.hpp"
+#include "Fill/FillRectilinear.hpp"
 #include "Format/STL.hpp"
 #include "Support/SupportMaterial.hpp"
 #include "SupportSpotsGenerator.hpp"
@@ -56,6 +59,7 @@
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/concurrent_vector.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/task_arena.h>
 #include <string>
 #include <string_view>
 #include <tuple>
@@ -171,6 +175,7 @@ std::vector<std::reference_wrapper<const PrintRegion>> PrintObject::all_regions(
 // 3) Generates perimeters, gap fills and fill regions (fill regions of type stInternal).
 void PrintObject::make_perimeters()
 {
+    SLIC3R_PROFILE_ZONE();
     // prerequisites
     this->slice();
 
@@ -262,47 +267,72 @@ void PrintObject::make_perimeters()
         BOOST_LOG_TRIVIAL(debug) << "Generating extra perimeters for region " << region_id << " in parallel - end";
     }
 
+    // Classification of the slices of a layer into top / bottom / internal surfaces only compares the slices of the layer
+    // with the lslices of the neighbor layers, which are not modified by the perimeter generator. Thus the first pass of
+    // prepare_infill() is performed for each layer right after its perimeters are generated, while the layer is hot in cache,
+    // instead of waiting for all the perimeters of the object to finish. With interface shells the slices are compared
+    // with the region slices of the neighbor layers and the spiral vase overrides the surface types of all but the bottom layers,
+    // then detect_surfaces_type() is run by prepare_infill() over the complete object.
+    const bool detect_surfaces_with_perimeters = ! m_print->config().spiral_vase.value && ! m_config.interface_shells.value;
+    m_surfaces_detected_by_perimeters = false;
+    if (detect_surfaces_with_perimeters)
+        // If canceled, the next run of make_perimeters() has to restore the untyped slices.
+        m_typed_slices = true;
+
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start";
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, m_layers.size()),
-        [this](const tbb::blocked_range<size_t>& range) {
+        [this, detect_surfaces_with_perimeters](const tbb::blocked_range<size_t>& range) {
             PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
             for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                 m_print->throw_if_canceled();
+                Profiler::Scope profile("Layer", "make_perimeters", m_model_object->name.c_str(), int(layer_idx));
                 m_layers[layer_idx]->make_perimeters();
+                if (detect_surfaces_with_perimeters)
+                    for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
+                        this->detect_surfaces_type(region_id, layer_idx, nullptr);
+                        m_layers[layer_idx]->m_regions[region_id]->slices_to_fill_surfaces_clipped();
+                    }
             }
         }
     );
     m_print->throw_if_canceled();
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end";
 
+    m_surfaces_detected_by_perimeters = detect_surfaces_with_perimeters;
     this->set_done(posPerimeters);
 }
 
 void PrintObject::prepare_infill()
 {
+    SLIC3R_PROFILE_ZONE();
     if (! this->set_started(posPrepareInfill))
         return;
 
     m_print->set_status(30, _u8L("Preparing infill"));
 
-    if (m_typed_slices) {
-        // To improve robustness of detect_surfaces_type() when reslicing (working with typed slices), see GH issue #7442.
-        // The preceding step (perimeter generator) only modifies extra_perimeters and the extra perimeters are only used by discover_vertical_shells()
-        // with more than a single region. If this step does not use Surface::extra_perimeters or Surface::extra_perimeters is always zero, it is safe
-        // to reset to the untyped slices before re-runnning detect_surfaces_type().
-        for (Layer* layer : m_layers) {
-            layer->restore_untyped_slices_no_extra_perimeters();
-            m_print->throw_if_canceled();
+    if (m_surfaces_detected_by_perimeters) {
+        // The slices were already classified by make_perimeters(), layer by layer.
+        m_surfaces_detected_by_perimeters = false;
+    } else {
+        if (m_typed_slices) {
+            // To improve robustness of detect_surfaces_type() when reslicing (working with typed slices), see GH issue #7442.
+            // The preceding step (perimeter generator) only modifies extra_perimeters and the extra perimeters are only used by discover_vertical_shells()
+            // with more than a single region. If this step does not use Surface::extra_perimeters or Surface::extra_perimeters is always zero, it is safe
+            // to reset to the untyped slices before re-runnning detect_surfaces_type().
+            for (Layer* layer : m_layers) {
+                layer->restore_untyped_slices_no_extra_perimeters();
+                m_print->throw_if_canceled();
+            }
         }
-    }
 
-    // This will assign a type (top/bottom/internal) to $layerm->slices.
-    // Then the classifcation of $layerm->slices is transfered onto 
-    // the $layerm->fill_surfaces by clipping $layerm->fill_surfaces
-    // by the cummulative area of the previous $layerm->fill_surfaces.
-    this->detect_surfaces_type();
-    m_print->throw_if_canceled();
+        // This will assign a type (top/bottom/internal) to $layerm->slices.
+        // Then the classifcation of $layerm->slices is transfered onto 
+        // the $layerm->fill_surfaces by clipping $layerm->fill_surfaces
+        // by the cummulative area of the previous $layerm->fill_surfaces.
+        this->detect_surfaces_type();
+        m_print->throw_if_canceled();
+    }
     
     // Decide what surfaces are to be filled.
     // Here the stTop / stBottomBridge / stBottom infill is turned to just stInternal if zero top / bottom infill layers are configured.
@@ -423,8 +453,15 @@ void PrintObject::clear_fills()
         layer->clear_fills();
 }
 
+void PrintObject::clear_ironing()
+{
+    for (Layer *layer : m_layers)
+        layer->clear_ironing();
+}
+
 void PrintObject::infill()
 {
+    SLIC3R_PROFILE_ZONE();
     // prerequisites
     this->prepare_infill();
 
@@ -433,15 +470,23 @@ void PrintObject::infill()
         m_print->set_status(45, _u8L("Making infill"));
         const auto& adaptive_fill_octree = this->m_adaptive_fill_octrees.first;
         const auto& support_fill_octree = this->m_adaptive_fill_octrees.second;
+        // The rectilinear based fills are shared by the layers with the same fill regions.
+        FillLinesCache fill_lines_cache;
 
         BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
+            [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree, &fill_lines_cache](const tbb::blocked_range<size_t>& range) {
                 PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get());
+                    Profiler::Scope profile("Layer", "make_fills", m_model_object->name.c_str(), int(layer_idx));
+                    m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get(), &fill_lines_cache);
+                    // The perimeters and infill of this layer are final now, trim their memory.
+                    for (LayerRegion *layerm : m_layers[layer_idx]->regions()) {
+                        layerm->m_perimeters.shrink_to_fit();
+                        layerm->m_fills.shrink_to_fit();
+                    }
                 }
             }
         );
@@ -456,42 +501,79 @@ void PrintObject::infill()
 
 void PrintObject::ironing()
 {
+    SLIC3R_PROFILE_ZONE();
     if (this->set_started(posIroning)) {
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - start";
+        // The ironing areas are kept from the last run unless the top surfaces or the ironing type changed,
+        // so that tuning the ironing flow, spacing or speed only regenerates the ironing extrusions.
+        const bool make_areas = ! m_ironing_areas_valid;
         tbb::parallel_for(
             // Ironing starting with layer 0 to support ironing all surfaces.
             tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this](const tbb::blocked_range<size_t>& range) {
+            [this, make_areas](const tbb::blocked_range<size_t>& range) {
                 PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
+                    Profiler::Scope profile("Layer", "make_ironing", m_model_object->name.c_str(), int(layer_idx));
+                    if (make_areas)
+                        m_layers[layer_idx]->make_ironing_areas();
                     m_layers[layer_idx]->make_ironing();
                 }
             }
         );
         m_print->throw_if_canceled();
+        m_ironing_areas_valid = true;
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - end";
         this->set_done(posIroning);
     }
 }
 
+void PrintObject::release_infill_data()
+{
+    assert(this->is_step_done(posIroning));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()), [this](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            Layer &layer = *m_layers[layer_idx];
+            for (LayerSlice &lslice : layer.lslices_ex)
+                for (LayerIsland &island : lslice.islands)
+                    island.fill_expolygons = ExPolygonRange();
+            for (LayerRegion *layerm : layer.regions()) {
+                layerm->m_fill_expolygons                  = {};
+                layerm->m_fill_expolygons_bboxes           = {};
+                layerm->m_fill_expolygons_composite        = {};
+                layerm->m_fill_expolygons_composite_bboxes = {};
+            }
+        }
+    });
+    m_adaptive_fill_octrees = {};
+    m_lightning_generator.reset();
+}
+
 void PrintObject::generate_support_spots()
 {
+    SLIC3R_PROFILE_ZONE();
     if (this->set_started(posSupportSpotsSearch)) {
         BOOST_LOG_TRIVIAL(debug) << "Searching support spots - start";
         m_print->set_status(65, _u8L("Searching support spots"));
+        // PrintObjects of the same ModelObject share the support points, the first one to get here calculates them.
+        std::scoped_lock<std::mutex> lock(m_shared_regions->generated_support_points_mutex);
         if (!this->shared_regions()->generated_support_points.has_value()) {
-            PrintTryCancel                cancel_func = m_print->make_try_cancel();
-            SupportSpotsGenerator::Params params{this->print()->m_config.filament_type.values,
-                                                 float(this->print()->m_config.perimeter_acceleration.getFloat()),
-                                                 this->config().raft_layers.getInt(), this->config().brim_type.value,
-                                                 float(this->config().brim_width.getFloat())};
-            auto [supp_points, partial_objects] = SupportSpotsGenerator::full_search(this, cancel_func, params);
-            Transform3d po_transform            = this->trafo_centered();
-            if (this->layer_count() > 0) {
-                po_transform = Geometry::translation_transform(Vec3d{0, 0, this->layers().front()->bottom_z()}) * po_transform;
-            }
-            this->m_shared_regions->generated_support_points = {po_transform, supp_points, partial_objects};
+            this->build_lslices_distancers();
+            // Isolated, so that while waiting for its nested parallel loops, this thread does not pick up processing
+            // of another PrintObject sharing the same regions, which would try to lock the same mutex.
+            tbb::this_task_arena::isolate([this]() {
+                PrintTryCancel                cancel_func = m_print->make_try_cancel();
+                SupportSpotsGenerator::Params params{this->print()->m_config.filament_type.values,
+                                                     float(this->print()->m_config.perimeter_acceleration.getFloat()),
+                                                     this->config().raft_layers.getInt(), this->config().brim_type.value,
+                                                     float(this->config().brim_width.getFloat())};
+                auto [supp_points, partial_objects] = SupportSpotsGenerator::full_search(this, cancel_func, params);
+                Transform3d po_transform            = this->trafo_centered();
+                if (this->layer_count() > 0) {
+                    po_transform = Geometry::translation_transform(Vec3d{0, 0, this->layers().front()->bottom_z()}) * po_transform;
+                }
+                this->m_shared_regions->generated_support_points = {po_transform, supp_points, partial_objects};
+            });
             m_print->throw_if_canceled();
         }
         BOOST_LOG_TRIVIAL(debug) << "Searching support spots - end";
@@ -501,12 +583,18 @@ void PrintObject::generate_support_spots()
 
 void PrintObject::generate_support_material()
 {
+    SLIC3R_PROFILE_ZONE();
     if (this->set_started(posSupportMaterial)) {
         this->clear_support_layers();
         if ((this->has_support() && m_layers.size() > 1) || (this->has_raft() && ! m_layers.empty())) {
             m_print->set_status(70, _u8L("Generating support material"));    
-            this->_generate_support_material();
-            m_print->throw_if_canceled();
+            std::string cache_key = FFFSupport::SupportCache::enabled() ? FFFSupport::SupportCache::key(*this) : std::string();
+            if (cache_key.empty() || ! FFFSupport::SupportCache::load(*this, cache_key)) {
+                this->_generate_support_material();
+                m_print->throw_if_canceled();
+                if (! cache_key.empty())
+                    FFFSupport::SupportCache::store(*this, cache_key);
+            }
         } else {
 #if 0
             // Printing without supports. Empty layer means some objects or object parts are levitating,
@@ -522,6 +610,7 @@ void PrintObject::generate_support_material()
 
 void PrintObject::estimate_curled_extrusions()
 {
+    SLIC3R_PROFILE_ZONE();
     if (this->set_started(posEstimateCurledExtrusions)) {
         if (this->print()->config().avoid_crossing_curled_overhangs ||
             std::any_of(this->print()->m_print_regions.begin(), this->print()->m_print_regions.end(),
@@ -529,6 +618,7 @@ void PrintObject::estimate_curled_extrusions()
             BOOST_LOG_TRIVIAL(debug) << "Estimating areas with curled extrusions - start";
             m_print->set_status(88, _u8L("Estimating curled extrusions"));
 
+            this->build_lslices_distancers();
             // Estimate curling of support material and add it to the malformaition lines of each layer
             float                         support_flow_width = support_material_flow(this, this->config().layer_height).width();
             SupportSpotsGenerator::Params params{this->print()->m_config.filament_type.values,
@@ -546,6 +636,7 @@ void PrintObject::estimate_curled_extrusions()
 
 void PrintObject::calculate_overhanging_perimeters()
 {
+    SLIC3R_PROFILE_ZONE();
     if (this->set_started(posCalculateOverhangingPerimeters)) {
         BOOST_LOG_TRIVIAL(debug) << "Calculating overhanging perimeters - start";
         m_print->set_status(89, _u8L("Calculating overhanging perimeters"));
@@ -565,17 +656,9 @@ void PrintObject::calculate_overhanging_perimeters()
         }
 
         if (!regions_with_dynamic_speeds.empty()) {
-            std::unordered_map<size_t, AABBTreeLines::LinesDistancer<CurledLine>> curled_lines;
-            std::unordered_map<size_t, AABBTreeLines::LinesDistancer<Linef>>      unscaled_polygons_lines;
-            for (const Layer *l : this->layers()) {
-                curled_lines[l->id()]            = AABBTreeLines::LinesDistancer<CurledLine>{l->curled_lines};
-                unscaled_polygons_lines[l->id()] = AABBTreeLines::LinesDistancer<Linef>{to_unscaled_linesf(l->lslices)};
-            }
-            curled_lines[size_t(-1)]            = {};
-            unscaled_polygons_lines[size_t(-1)] = {};
-
-            tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()), [this, &curled_lines, &unscaled_polygons_lines,
-                                                                               &regions_with_dynamic_speeds](
+            this->build_lslices_distancers();
+            const AABBTreeLines::LinesDistancer<Linef> no_lower_slices;
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()), [this, &regions_with_dynamic_speeds, &no_lower_slices](
                                                                                   const tbb::blocked_range<size_t> &range) {
                 PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
@@ -583,15 +666,15 @@ void PrintObject::calculate_overhanging_perimeters()
                     if (l->id() == 0) { // first layer, do not split
                         continue;
                     }
+                    const AABBTreeLines::LinesDistancer<Linef> &lower_slices = l->lower_layer ? l->lower_layer->lslices_distancer() : no_lower_slices;
+                    const AABBTreeLines::LinesDistancer<CurledLine> curled_lines{l->curled_lines};
                     for (LayerRegion *layer_region : l->regions()) {
                         if (regions_with_dynamic_speeds.find(layer_region->m_region) == regions_with_dynamic_speeds.end()) {
                             continue;
                         }
-                        size_t prev_layer_id = l->lower_layer ? l->lower_layer->id() : size_t(-1);
                         layer_region->m_perimeters =
                             ExtrusionProcessor::calculate_and_split_overhanging_extrusions(&layer_region->m_perimeters,
-                                                                                           unscaled_polygons_lines[prev_layer_id],
-                                                                                           curled_lines[l->id()]);
+                                                                                           lower_slices, curled_lines);
                     }
                 }
             });
@@ -603,6 +686,15 @@ void PrintObject::calculate_overhanging_perimeters()
     }
 }
 
+void PrintObject::build_lslices_distancers()
+{
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()), [this](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+            if (Layer *layer = m_layers[layer_idx]; ! layer->m_lslices_distancer)
+                layer->m_lslices_distancer = std::make_shared<const AABBTreeLines::LinesDistancer<Linef>>(to_unscaled_linesf(layer->lslices));
+    });
+}
+
 std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> PrintObject::prepare_adaptive_infill_data(
     const std::vector<std::pair<const Surface *, float>> &surfaces_w_bottom_z) const
 {
@@ -700,6 +792,7 @@ bool PrintObject::invalidate_state_by_config_options(
 
     std::vector<PrintObjectStep> steps;
     bool invalidated = false;
+    bool invalidate_ironing_areas = false;
     for (const t_config_option_key &opt_key : opt_keys) {
         if (   opt_key == "brim_width"
             || opt_key == "brim_separation"
@@ -830,6 +923,18 @@ bool PrintObject::invalidate_state_by_config_options(
             steps.emplace_back(posInfill);
         } else if (opt_key == "fill_pattern") {
             steps.emplace_back(posPrepareInfill);
+        } else if (
+               opt_key == "ironing"
+            || opt_key == "ironing_type") {
+            steps.emplace_back(posIroning);
+            invalidate_ironing_areas = true;
+        } else if (
+               opt_key == "ironing_flowrate"
+            || opt_key == "ironing_spacing"
+            || opt_key == "ironing_speed") {
+            // The ironing areas stay valid, only the ironing extrusions are regenerated.
+            // The ironing speed is applied by the G-code generator, though the regions ironed with different speeds are not merged.
+            steps.emplace_back(posIroning);
         } else if (opt_key == "fill_density") {
             // One likely wants to reslice only when switching between zero infill to simulate boolean difference (subtracting volumes),
             // normal infill and 100% (solid) infill.
@@ -907,6 +1012,8 @@ bool PrintObject::invalidate_state_by_config_options(
     sort_remove_duplicates(steps);
     for (PrintObjectStep step : steps)
         invalidated |= this->invalidate_step(step);
+    if (invalidate_ironing_areas)
+        m_ironing_areas_valid = false;
     return invalidated;
 }
 
@@ -914,12 +1021,19 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
 {
 	bool invalidated = Inherited::invalidate_step(step);
     
+    if (step == posSlice || step == posPerimeters || step == posPrepareInfill || step == posInfill)
+        // The top surfaces to be ironed will be recalculated.
+        m_ironing_areas_valid = false;
+
     // propagate to dependent steps
     if (step == posPerimeters) {
 		invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill, posIroning,  posSupportSpotsSearch, posEstimateCurledExtrusions, posCalculateOverhangingPerimeters });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
+        m_seam_data.reset();
     } else if (step == posPrepareInfill) {
         invalidated |= this->invalidate_steps({ posInfill, posIroning, posSupportSpotsSearch});
+        // For example interface_shells or bottom_solid_layers changed: The surfaces classified by make_perimeters() will be re-classified.
+        m_surfaces_detected_by_perimeters = false;
     } else if (step == posInfill) {
         invalidated |= this->invalidate_steps({ posIroning, posSupportSpotsSearch });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
@@ -928,6 +1042,7 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
                                                posSupportMaterial, posEstimateCurledExtrusions, posCalculateOverhangingPerimeters});
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
         m_slicing_params.valid = false;
+        m_seam_data.reset();
     } else if (step == posSupportMaterial) {
         invalidated |= m_print->invalidate_steps({ psSkirtBrim,  });
         invalidated |= this->invalidate_steps({ posEstimateCurledExtrusions });
@@ -951,14 +1066,19 @@ bool PrintObject::invalidate_all_steps()
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	m_slicing_params.valid = false;
+	m_ironing_areas_valid = false;
 	return result;
 }
 
 // Called on main thread with stopped or paused background processing to let PrintObject release data for its milestones that were invalidated or canceled.
 void PrintObject::cleanup()
 {
+    // Query both steps to reset their dirty state. Clearing the fills clears the ironing extrusions as well.
+    bool ironing_dirty = this->query_reset_dirty_step_unguarded(posIroning);
     if (this->query_reset_dirty_step_unguarded(posInfill))
         this->clear_fills();
+    else if (ironing_dirty)
+        this->clear_ironing();
     if (this->query_reset_dirty_step_unguarded(posSupportMaterial))
         this->clear_support_layers();
 }
@@ -1007,130 +1127,9 @@ void PrintObject::detect_surfaces_type()
             		m_layers.size()),
             [this, region_id, interface_shells, &surfaces_new](const tbb::blocked_range<size_t>& range) {
                 PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
-                // If we have soluble support material, don't bridge. The overhang will be squished against a soluble layer separating
-                // the support from the print.
-                SurfaceType surface_type_bottom_other =
-                    (this->has_support() && m_config.support_material_contact_distance.value == 0) ?
-                    stBottom : stBottomBridge;
                 for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
                     m_print->throw_if_canceled();
-                    // BOOST_LOG_TRIVIAL(trace) << "Detecting solid surfaces for region " << region_id << " and layer " << layer->print_z;
-                    Layer       *layer  = m_layers[idx_layer];
-                    LayerRegion *layerm = layer->m_regions[region_id];
-                    // comparison happens against the *full* slices (considering all regions)
-                    // unless internal shells are requested
-                    Layer       *upper_layer = (idx_layer + 1 < this->layer_count()) ? m_layers[idx_layer + 1] : nullptr;
-                    Layer       *lower_layer = (idx_layer > 0) ? m_layers[idx_layer - 1] : nullptr;
-                    // collapse very narrow parts (using the safety offset in the diff is not enough)
-                    float        offset = layerm->flow(frExternalPerimeter).scaled_width() / 10.f;
-
-                    // find top surfaces (difference between current surfaces
-                    // of current layer and upper one)
-                    Surfaces top;
-                    if (upper_layer) {
-                        ExPolygons upper_slices = interface_shells ? 
-                            diff_ex(layerm->slices().surfaces, upper_layer->m_regions[region_id]->slices().surfaces, ApplySafetyOffset::Yes) :
-                            diff_ex(layerm->slices().surfaces, upper_layer->lslices, ApplySafetyOffset::Yes);
-                        surfaces_append(top, opening_ex(upper_slices, offset), stTop);
-                    } else {
-                        // if no upper layer, all surfaces of this one are solid
-                        // we clone surfaces because we're going to clear the slices collection
-                        top = layerm->slices().surfaces;
-                        for (Surface &surface : top)
-                            surface.surface_type = stTop;
-                    }
-                    
-                    // Find bottom surfaces (difference between current surfaces of current layer and lower one).
-                    Surfaces bottom;
-                    if (lower_layer) {
-#if 0
-                        //FIXME Why is this branch failing t\multi.t ?
-                        Polygons lower_slices = interface_shells ? 
-                            to_polygons(lower_layer->get_region(region_id)->slices.surfaces) : 
-                            to_polygons(lower_layer->slices);
-                        surfaces_append(bottom,
-                            opening_ex(diff(layerm->slices.surfaces, lower_slices, true), offset),
-                            surface_type_bottom_other);
-#else
-                        // Any surface lying on the void is a true bottom bridge (an overhang)
-                        surfaces_append(
-                            bottom,
-                            opening_ex(
-                                diff_ex(layerm->slices().surfaces, lower_layer->lslices, ApplySafetyOffset::Yes),
-                                offset),
-                            surface_type_bottom_other);
-                        // if user requested internal shells, we need to identify surfaces
-                        // lying on other slices not belonging to this region
-                        if (interface_shells) {
-                            // non-bridging bottom surfaces: any part of this layer lying 
-                            // on something else, excluding those lying on our own region
-                            surfaces_append(
-                                bottom,
-                                opening_ex(
-                                    diff_ex(
-                                        intersection(layerm->slices().surfaces, lower_layer->lslices), // supported
-                                        lower_layer->m_regions[region_id]->slices().surfaces,
-                                        ApplySafetyOffset::Yes),
-                                    offset),
-                                stBottom);
-                        }
-#endif
-                    } else {
-                        // if no lower layer, all surfaces of this one are solid
-                        // we clone surfaces because we're going to clear the slices collection
-                        bottom = layerm->slices().surfaces;
-                        for (Surface &surface : bottom)
-                            surface.surface_type = stBottom;
-                    }
-                    
-                    // now, if the object contained a thin membrane, we could have overlapping bottom
-                    // and top surfaces; let's do an intersection to discover them and consider them
-                    // as bottom surfaces (to allow for bridge detection)
-                    if (! top.empty() && ! bottom.empty()) {
-        //                Polygons overlapping = intersection(to_polygons(top), to_polygons(bottom));
-        //                Slic3r::debugf "  layer %d contains %d membrane(s)\n", $layerm->layer->id, scalar(@$overlapping)
-        //                    if $Slic3r::debug;
-                        Polygons top_polygons = to_polygons(std::move(top));
-                        top.clear();
-                        surfaces_append(top, diff_ex(top_polygons, bottom), stTop);
-                    }
-
-        #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
-                    {
-                        static int iRun = 0;
-                        std::vector<std::pair<Slic3r::ExPolygons, SVG::ExPolygonAttributes>> expolygons_with_attributes;
-                        expolygons_with_attributes.emplace_back(std::make_pair(union_ex(top),                             SVG::ExPolygonAttributes("green")));
-                        expolygons_with_attributes.emplace_back(std::make_pair(union_ex(bottom),                          SVG::ExPolygonAttributes("brown")));
-                        expolygons_with_attributes.emplace_back(std::make_pair(to_expolygons(layerm->slices().surfaces),  SVG::ExPolygonAttributes("black")));
-                        SVG::export_expolygons(debug_out_path("1_detect_surfaces_type_%d_region%d-layer_%f.svg", iRun ++, region_id, layer->print_z).c_str(), expolygons_with_attributes);
-                    }
-        #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
-                    
-                    // save surfaces to layer
-                    Surfaces &surfaces_out = interface_shells ? surfaces_new[idx_layer] : layerm->m_slices.surfaces;
-                    Surfaces  surfaces_backup;
-                    if (! interface_shells) {
-                        surfaces_backup = std::move(surfaces_out);
-                        surfaces_out.clear();
-                    }
-                    const Surfaces &surfaces_prev = interface_shells ? layerm->slices().surfaces : surfaces_backup;
-
-                    // find internal surfaces (difference between top/bottom surfaces and others)
-                    {
-                        Polygons topbottom = to_polygons(top);
-                        polygons_append(topbottom, to_polygons(bottom));
-                        surfaces_append(surfaces_out, diff_ex(surfaces_prev, topbottom), stInternal);
-                    }
-
-                    surfaces_append(surfaces_out, std::move(top));
-                    surfaces_append(surfaces_out, std::move(bottom));
-                    
-        //            Slic3r::debugf "  layer %d has %d bottom, %d top and %d internal surfaces\n",
-        //                $layerm->layer->id, scalar(@bottom), scalar(@top), scalar(@internal) if $Slic3r::debug;
-
-        #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
-                    layerm->export_region_slices_to_svg_debug("detect_surfaces_type-final");
-        #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
+                    this->detect_surfaces_type(region_id, idx_layer, interface_shells ? &surfaces_new[idx_layer] : nullptr);
                 }
             }
         ); // for each layer of a region
@@ -1173,6 +1172,137 @@ void PrintObject::detect_surfaces_type()
     m_typed_slices = true;
 }
 
+// Classify the slices of a single layer and region into top / bottom / internal surfaces, see detect_surfaces_type() above.
+// With interface shells, the classified surfaces are stored into surfaces_new, as the slices of this layer are compared with
+// the slices of the same region of the neighbor layers, which are being classified in parallel. Otherwise the slices are
+// only compared with the lslices of the neighbor layers and they are replaced with the classified surfaces in place.
+void PrintObject::detect_surfaces_type(size_t region_id, size_t idx_layer, Surfaces *surfaces_new)
+{
+    const bool interface_shells = surfaces_new != nullptr;
+    // If we have soluble support material, don't bridge. The overhang will be squished against a soluble layer separating
+    // the support from the print.
+    SurfaceType surface_type_bottom_other =
+        (this->has_support() && m_config.support_material_contact_distance.value == 0) ?
+        stBottom : stBottomBridge;
+    // BOOST_LOG_TRIVIAL(trace) << "Detecting solid surfaces for region " << region_id << " and layer " << layer->print_z;
+    Layer       *layer  = m_layers[idx_layer];
+    LayerRegion *layerm = layer->m_regions[region_id];
+    // comparison happens against the *full* slices (considering all regions)
+    // unless internal shells are requested
+    Layer       *upper_layer = (idx_layer + 1 < this->layer_count()) ? m_layers[idx_layer + 1] : nullptr;
+    Layer       *lower_layer = (idx_layer > 0) ? m_layers[idx_layer - 1] : nullptr;
+    // collapse very narrow parts (using the safety offset in the diff is not enough)
+    float        offset = layerm->flow(frExternalPerimeter).scaled_width() / 10.f;
+
+    // find top surfaces (difference between current surfaces
+    // of current layer and upper one)
+    Surfaces top;
+    if (upper_layer) {
+        ExPolygons upper_slices = interface_shells ? 
+            diff_ex(layerm->slices().surfaces, upper_layer->m_regions[region_id]->slices().surfaces, ApplySafetyOffset::Yes) :
+            diff_ex(layerm->slices().surfaces, upper_layer->lslices, ApplySafetyOffset::Yes);
+        surfaces_append(top, opening_ex(upper_slices, offset), stTop);
+    } else {
+        // if no upper layer, all surfaces of this one are solid
+        // we clone surfaces because we're going to clear the slices collection
+        top = layerm->slices().surfaces;
+        for (Surface &surface : top)
+            surface.surface_type = stTop;
+    }
+    
+    // Find bottom surfaces (difference between current surfaces of current layer and lower one).
+    Surfaces bottom;
+    if (lower_layer) {
+#if 0
+        //FIXME Why is this branch failing t\multi.t ?
+        Polygons lower_slices = interface_shells ? 
+            to_polygons(lower_layer->get_region(region_id)->slices.surfaces) : 
+            to_polygons(lower_layer->slices);
+        surfaces_append(bottom,
+            opening_ex(diff(layerm->slices.surfaces, lower_slices, true), offset),
+            surface_type_bottom_other);
+#else
+        // Any surface lying on the void is a true bottom bridge (an overhang)
+        surfaces_append(
+            bottom,
+            opening_ex(
+                diff_ex(layerm->slices().surfaces, lower_layer->lslices, ApplySafetyOffset::Yes),
+                offset),
+            surface_type_bottom_other);
+        // if user requested internal shells, we need to identify surfaces
+        // lying on other slices not belonging to this region
+        if (interface_shells) {
+            // non-bridging bottom surfaces: any part of this layer lying 
+            // on something else, excluding those lying on our own region
+            surfaces_append(
+                bottom,
+                opening_ex(
+                    diff_ex(
+                        intersection(layerm->slices().surfaces, lower_layer->lslices), // supported
+                        lower_layer->m_regions[region_id]->slices().surfaces,
+                        ApplySafetyOffset::Yes),
+                    offset),
+                stBottom);
+        }
+#endif
+    } else {
+        // if no lower layer, all surfaces of this one are solid
+        // we clone surfaces because we're going to clear the slices collection
+        bottom = layerm->slices().surfaces;
+        for (Surface &surface : bottom)
+            surface.surface_type = stBottom;
+    }
+    
+    // now, if the object contained a thin membrane, we could have overlapping bottom
+    // and top surfaces; let's do an intersection to discover them and consider them
+    // as bottom surfaces (to allow for bridge detection)
+    if (! top.empty() && ! bottom.empty()) {
+    //                Polygons overlapping = intersection(to_polygons(top), to_polygons(bottom));
+    //                Slic3r::debugf "  layer %d contains %d membrane(s)\n", $layerm->layer->id, scalar(@$overlapping)
+    //                    if $Slic3r::debug;
+        Polygons top_polygons = to_polygons(std::move(top));
+        top.clear();
+        surfaces_append(top, diff_ex(top_polygons, bottom), stTop);
+    }
+
+#ifdef SLIC3R_DEBUG_SLICE_PROCESSING
+    {
+        static int iRun = 0;
+        std::vector<std::pair<Slic3r::ExPolygons, SVG::ExPolygonAttributes>> expolygons_with_attributes;
+        expolygons_with_attributes.emplace_back(std::make_pair(union_ex(top),                             SVG::ExPolygonAttributes("green")));
+        expolygons_with_attributes.emplace_back(std::make_pair(union_ex(bottom),                          SVG::ExPolygonAttributes("brown")));
+        expolygons_with_attributes.emplace_back(std::make_pair(to_expolygons(layerm->slices().surfaces),  SVG::ExPolygonAttributes("black")));
+        SVG::export_expolygons(debug_out_path("1_detect_surfaces_type_%d_region%d-layer_%f.svg", iRun ++, region_id, layer->print_z).c_str(), expolygons_with_attributes);
+    }
+#endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
+    
+    // save surfaces to layer
+    Surfaces &surfaces_out = interface_shells ? *surfaces_new : layerm->m_slices.surfaces;
+    Surfaces  surfaces_backup;
+    if (! interface_shells) {
+        surfaces_backup = std::move(surfaces_out);
+        surfaces_out.clear();
+    }
+    const Surfaces &surfaces_prev = interface_shells ? layerm->slices().surfaces : surfaces_backup;
+
+    // find internal surfaces (difference between top/bottom surfaces and others)
+    {
+        Polygons topbottom = to_polygons(top);
+        polygons_append(topbottom, to_polygons(bottom));
+        surfaces_append(surfaces_out, diff_ex(surfaces_prev, topbottom), stInternal);
+    }
+
+    surfaces_append(surfaces_out, std::move(top));
+    surfaces_append(surfaces_out, std::move(bottom));
+    
+    //            Slic3r::debugf "  layer %d has %d bottom, %d top and %d internal surfaces\n",
+    //                $layerm->layer->id, scalar(@bottom), scalar(@top), scalar(@internal) if $Slic3r::debug;
+
+#ifdef SLIC3R_DEBUG_SLICE_PROCESSING
+    layerm->export_region_slices_to_svg_debug("detect_surfaces_type-final");
+#endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
+}
+
 void PrintObject::process_external_surfaces()
 {
     BOOST_LOG_TRIVIAL(info) << "Processing external surfaces..." << log_memory_info();
@@ -1266,17 +1396,96 @@ void PrintObject::process_external_surfaces()
     }
 } // void PrintObject::process_external_surfaces()
 
+namespace {
+
+struct DiscoverVerticalShellsCacheEntry
+{
+    // Collected polygons, offsetted
+    Polygons    top_surfaces;
+    Polygons    bottom_surfaces;
+    Polygons    holes;
+};
+
+// Unions of the top / bottom surfaces and intersections of the holes over aligned blocks of 2^level layers
+// (the lower levels of a segment tree, up to the longest range of layers queried). The shells of a layer
+// are then combined from O(log n) precomputed blocks instead of from the n layers above and below it.
+class DiscoverVerticalShellsCacheBlocks
+{
+public:
+    void build(const std::vector<DiscoverVerticalShellsCacheEntry> &layers, size_t max_range, const std::function<void()> &throw_if_canceled)
+    {
+        m_layers = &layers;
+        m_levels.clear();
+        for (size_t level = 1; (size_t(1) << level) <= max_range && (layers.size() >> level) > 0; ++ level) {
+            std::vector<DiscoverVerticalShellsCacheEntry> &blocks = m_levels.emplace_back(layers.size() >> level);
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks.size()), [this, level, &blocks, &throw_if_canceled](const tbb::blocked_range<size_t> &range) {
+                for (size_t idx_block = range.begin(); idx_block < range.end(); ++ idx_block) {
+                    throw_if_canceled();
+                    const DiscoverVerticalShellsCacheEntry &a = this->entry(level - 1, 2 * idx_block);
+                    const DiscoverVerticalShellsCacheEntry &b = this->entry(level - 1, 2 * idx_block + 1);
+                    DiscoverVerticalShellsCacheEntry       &block = blocks[idx_block];
+                    block.top_surfaces    = union_(a.top_surfaces, b.top_surfaces);
+                    block.bottom_surfaces = union_(a.bottom_surfaces, b.bottom_surfaces);
+                    if (! a.holes.empty() && ! b.holes.empty())
+                        block.holes = intersection(a.holes, b.holes);
+                }
+            });
+        }
+    }
+
+    // Calls fn for the blocks covering the layers <begin, end) in ascending order.
+    template<typename Fn>
+    void visit(size_t begin, size_t end, Fn &&fn) const
+    {
+        while (begin < end) {
+            size_t level = 0;
+            while (level < m_levels.size() && (begin & ((size_t(2) << level) - 1)) == 0 && begin + (size_t(2) << level) <= end)
+                ++ level;
+            fn(this->entry(level, begin >> level));
+            begin += size_t(1) << level;
+        }
+    }
+
+private:
+    const DiscoverVerticalShellsCacheEntry& entry(size_t level, size_t idx) const
+        { return level == 0 ? (*m_layers)[idx] : m_levels[level - 1][idx]; }
+
+    const std::vector<DiscoverVerticalShellsCacheEntry>         *m_layers { nullptr };
+    std::vector<std::vector<DiscoverVerticalShellsCacheEntry>>   m_levels;
+};
+
+// End of the range of layers above idx_layer, whose top surfaces are projected to idx_layer.
+size_t vertical_shells_top_range_end(const LayerPtrs &layers, size_t num_layers, size_t idx_layer, const PrintRegionConfig &config)
+{
+    size_t i = idx_layer + 1;
+    if (int n_top_layers = config.top_solid_layers.value; n_top_layers > 0) {
+        const size_t itop    = idx_layer + size_t(n_top_layers);
+        const double print_z = layers[idx_layer]->print_z;
+        while (i < num_layers && (i < itop || layers[i]->print_z - print_z < config.top_solid_min_thickness - EPSILON))
+            ++ i;
+    }
+    return i;
+}
+
+// Begin of the range of layers below idx_layer, whose bottom surfaces are projected to idx_layer.
+size_t vertical_shells_bottom_range_begin(const LayerPtrs &layers, size_t idx_layer, const PrintRegionConfig &config)
+{
+    int i = int(idx_layer) - 1;
+    if (int n_bottom_layers = config.bottom_solid_layers.value; n_bottom_layers > 0) {
+        const int    ibottom  = int(idx_layer) - n_bottom_layers;
+        const double bottom_z = layers[idx_layer]->bottom_z();
+        while (i >= 0 && (i > ibottom || bottom_z - layers[i]->bottom_z() < config.bottom_solid_min_thickness - EPSILON))
+            -- i;
+    }
+    return size_t(i + 1);
+}
+
+} // namespace
+
 void PrintObject::discover_vertical_shells()
 {
     BOOST_LOG_TRIVIAL(info) << "Discovering vertical shells..." << log_memory_info();
 
-    struct DiscoverVerticalShellsCacheEntry
-    {
-        // Collected polygons, offsetted
-        Polygons    top_surfaces;
-        Polygons    bottom_surfaces;
-        Polygons    holes;
-    };
     bool     spiral_vase      = this->print()->config().spiral_vase.value;
     size_t   num_layers       = spiral_vase ? std::min(size_t(this->printing_region(0).config().bottom_solid_layers), m_layers.size()) : m_layers.size();
     std::vector<DiscoverVerticalShellsCacheEntry> cache_top_botom_regions(num_layers, DiscoverVerticalShellsCacheEntry());
@@ -1356,6 +1565,17 @@ void PrintObject::discover_vertical_shells()
         BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells in parallel - end : cache top / bottom";
     }
 
+    // The longest range of layers, whose top or bottom surfaces are projected to a single layer.
+    size_t max_shell_range = 0;
+    for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
+        const PrintRegionConfig &region_config = this->printing_region(region_id).config();
+        for (size_t idx_layer = 0; idx_layer < num_layers; ++ idx_layer)
+            max_shell_range = std::max({ max_shell_range,
+                vertical_shells_top_range_end(m_layers, num_layers, idx_layer, region_config) - idx_layer - 1,
+                idx_layer - vertical_shells_bottom_range_begin(m_layers, idx_layer, region_config) });
+    }
+    DiscoverVerticalShellsCacheBlocks cache_blocks;
+
     for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
         //FIXME Improve the heuristics for a grain size.
         size_t grain_size = std::max(num_layers / 16, size_t(1));
@@ -1391,12 +1611,16 @@ void PrintObject::discover_vertical_shells()
             m_print->throw_if_canceled();
             BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - end : cache top / bottom";
         }
+        if (region_id == 0 || ! top_bottom_surfaces_all_regions) {
+            cache_blocks.build(cache_top_botom_regions, max_shell_range, [this]() { m_print->throw_if_canceled(); });
+            m_print->throw_if_canceled();
+        }
 
         BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - start : ensure vertical wall thickness";
         grain_size = 1;
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, num_layers, grain_size),
-            [this, region_id, &cache_top_botom_regions]
+            [this, region_id, &cache_top_botom_regions, &cache_blocks]
             (const tbb::blocked_range<size_t>& range) {
                 PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
                 // printf("discover_vertical_shells from %d to %d\n", range.begin(), range.end());
@@ -1468,17 +1692,13 @@ void PrintObject::discover_vertical_shells()
 			        if (int n_top_layers = region_config.top_solid_layers.value; n_top_layers > 0) {
                         // Gather top regions projected to this layer.
                         coordf_t print_z = layer->print_z;
-                        int i = int(idx_layer) + 1;
+                        int i = int(vertical_shells_top_range_end(m_layers, cache_top_botom_regions.size(), idx_layer, region_config));
                         int itop = int(idx_layer) + n_top_layers;
-                        bool at_least_one_top_projected = false;
-	                    for (; i < int(cache_top_botom_regions.size()) &&
-	                         (i < itop || m_layers[i]->print_z - print_z < region_config.top_solid_min_thickness - EPSILON);
-	                        ++ i) {
-                            at_least_one_top_projected = true;
-	                        const DiscoverVerticalShellsCacheEntry &cache = cache_top_botom_regions[i];
+                        bool at_least_one_top_projected = i > int(idx_layer) + 1;
+                        cache_blocks.visit(idx_layer + 1, size_t(i), [&combine_holes, &combine_shells](const DiscoverVerticalShellsCacheEntry &cache) {
                             combine_holes(cache.holes);
                             combine_shells(cache.top_surfaces);
-	                    }
+                        });
                         if (!at_least_one_top_projected && i < int(cache_top_botom_regions.size())) {
                             // Lets consider this a special case - with only 1 top solid and minimal shell thickness settings, the
                             // boundaries of solid layers are not anchored over/under perimeters, so lets fix it by adding at least one
@@ -1497,17 +1717,13 @@ void PrintObject::discover_vertical_shells()
 	                if (int n_bottom_layers = region_config.bottom_solid_layers.value; n_bottom_layers > 0) {
                         // Gather bottom regions projected to this layer.
                         coordf_t bottom_z = layer->bottom_z();
-                        int i = int(idx_layer) - 1;
+                        int i = int(vertical_shells_bottom_range_begin(m_layers, idx_layer, region_config)) - 1;
                         int ibottom = int(idx_layer) - n_bottom_layers;
-                        bool at_least_one_bottom_projected = false;
-	                    for (; i >= 0 &&
-	                         (i > ibottom || bottom_z - m_layers[i]->bottom_z() < region_config.bottom_solid_min_thickness - EPSILON);
-	                        -- i) {
-                                at_least_one_bottom_projected = true;
-	                        const DiscoverVerticalShellsCacheEntry &cache = cache_top_botom_regions[i];
-							combine_holes(cache.holes);
+                        bool at_least_one_bottom_projected = i < int(idx_layer) - 1;
+                        cache_blocks.visit(size_t(i + 1), idx_layer, [&combine_holes, &combine_shells](const DiscoverVerticalShellsCacheEntry &cache) {
+                            combine_holes(cache.holes);
                             combine_shells(cache.bottom_surfaces);
-	                    }
+                        });
 
                         if (!at_least_one_bottom_projected && i >= 0) {
                             Polygons anchor_area = intersection(expand(cache_top_botom_regions[idx_layer].bottom_surfaces,
@@ -1748,14 +1964,27 @@ void PrintObject::bridge_over_infill()
                     continue;
                 }
                 double spacing = layer->regions().front()->flow(frSolidInfill).scaled_spacing();
+                // Only the internal solids may be bridged. Skip the layers without them and process the lower layer
+                // just around them, the operations below do not reach farther than 10 spacings.
+                BoundingBox internal_solids_bbox;
+                for (const LayerRegion *region : layer->regions())
+                    for (const Surface &surface : region->fill_surfaces())
+                        if (surface.surface_type == stInternalSolid)
+                            internal_solids_bbox.merge(get_extents(surface.expolygon.contour));
+                if (! internal_solids_bbox.defined)
+                    continue;
+                internal_solids_bbox.offset(10 * spacing);
                 // unsupported area will serve as a filter for polygons worth bridging.
                 Polygons   unsupported_area;
                 Polygons   lower_layer_solids;
                 for (const LayerRegion *region : layer->lower_layer->regions()) {
-                    Polygons fill_polys = to_polygons(region->fill_expolygons());
                     // initially consider the whole layer unsupported, but also gather solid layers to later cut off supported parts
-                    unsupported_area.insert(unsupported_area.end(), fill_polys.begin(), fill_polys.end());
+                    for (const ExPolygon &expoly : region->fill_expolygons())
+                        if (internal_solids_bbox.overlap(get_extents(expoly.contour)))
+                            polygons_append(unsupported_area, to_polygons(expoly));
                     for (const Surface &surface : region->fill_surfaces()) {
+                        if (! internal_solids_bbox.overlap(get_extents(surface.expolygon.contour)))
+                            continue;
                         if (surface.surface_type != stInternal || region->region().config().fill_density.value == 100) {
                             Polygons p = to_polygons(surface.expolygon);
                             lower_layer_solids.insert(lower_layer_solids.end(), p.begin(), p.end());
@@ -1998,7 +2227,8 @@ void PrintObject::bridge_over_infill()
     }
 
     // LAMBDA to gather areas with sparse infill deep enough that we can fit thick bridges there.
-    auto gather_areas_w_depth = [target_flow_height_factor](const PrintObject *po, int lidx, float target_flow_height) {
+    // Only the surfaces overlapping bbox are gathered.
+    auto gather_areas_w_depth = [target_flow_height_factor](const PrintObject *po, int lidx, float target_flow_height, const BoundingBox &bbox) {
         // Gather layers sparse infill areas, to depth defined by used bridge flow
         ExPolygons layers_sparse_infill{};
         ExPolygons not_sparse_infill{};
@@ -2012,6 +2242,8 @@ void PrintObject::bridge_over_infill()
             for (const LayerRegion *region : layer->regions()) {
                 bool has_low_density = region->region().config().fill_density.value < 100;
                 for (const Surface &surface : region->fill_surfaces()) {
+                    if (! bbox.overlap(get_extents(surface.expolygon.contour)))
+                        continue;
                     if ((surface.surface_type == stInternal && has_low_density) || surface.surface_type == stInternalVoid ) {
                         layers_sparse_infill.push_back(surface.expolygon);
                     } else {
@@ -2320,7 +2552,19 @@ void PrintObject::bridge_over_infill()
                 coordf_t spacing            = surfaces_by_layer[lidx].front().region->bridging_flow(frSolidInfill, true).scaled_spacing();
                 coordf_t target_flow_height = surfaces_by_layer[lidx].front().region->bridging_flow(frSolidInfill, true).height() *
                                               target_flow_height_factor;
-                Polygons deep_infill_area = gather_areas_w_depth(po, lidx, target_flow_height);
+                // The bridges stay inside the islands of the candidates, the deep infill is only needed around these islands.
+                BoundingBox candidate_islands_bbox;
+                for (const CandidateSurface &candidate : surfaces_by_layer[lidx]) {
+                    BoundingBox candidate_bbox = get_extents(candidate.new_polys);
+                    if (! candidate_bbox.defined)
+                        continue;
+                    candidate_islands_bbox.merge(candidate_bbox);
+                    for (const LayerSlice &lslice : layer->lslices_ex)
+                        if (lslice.bbox.overlap(candidate_bbox))
+                            candidate_islands_bbox.merge(lslice.bbox);
+                }
+                candidate_islands_bbox.offset(10 * spacing);
+                Polygons deep_infill_area = gather_areas_w_depth(po, lidx, target_flow_height, candidate_islands_bbox);
 
                 {
                     // Now also remove area that has been already filled on lower layers by bridging expansion - For this
@@ -2808,24 +3052,31 @@ void PrintObject::discover_horizontal_shells()
 {
     BOOST_LOG_TRIVIAL(trace) << "discover_horizontal_shells()";
 
-    for (size_t region_id = 0; region_id < this->num_printing_regions(); ++region_id) {
-        for (size_t i = 0; i < m_layers.size(); ++i) {
-            m_print->throw_if_canceled();
-            Layer                   *layer         = m_layers[i];
-            LayerRegion             *layerm        = layer->regions()[region_id];
-            const PrintRegionConfig &region_config = layerm->region().config();
-            if (region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0 &&
-                (i % region_config.solid_infill_every_layers) == 0) {
-                // Insert a solid internal layer. Mark stInternal surfaces as stInternalSolid or stInternalBridge.
-                SurfaceType type = (region_config.fill_density == 100 || region_config.solid_infill_every_layers == 1) ? stInternalSolid :
-                                                                                                                         stInternalBridge;
-                for (Surface &surface : layerm->m_fill_surfaces.surfaces)
-                    if (surface.surface_type == stInternal)
-                        surface.surface_type = type;
-            }
-            // The rest has already been performed by discover_vertical_shells().
-        } // for each layer
-    }     // for each region
+    // Each layer only modifies its own fill surfaces, thus the layers are processed in parallel.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_layers.size()),
+        [this](const tbb::blocked_range<size_t> &range) {
+            PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                m_print->throw_if_canceled();
+                Layer *layer = m_layers[i];
+                for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
+                    LayerRegion             *layerm        = layer->regions()[region_id];
+                    const PrintRegionConfig &region_config = layerm->region().config();
+                    if (region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0 &&
+                        (i % region_config.solid_infill_every_layers) == 0) {
+                        // Insert a solid internal layer. Mark stInternal surfaces as stInternalSolid or stInternalBridge.
+                        SurfaceType type = (region_config.fill_density == 100 || region_config.solid_infill_every_layers == 1) ? stInternalSolid :
+                                                                                                                                 stInternalBridge;
+                        for (Surface &surface : layerm->m_fill_surfaces.surfaces)
+                            if (surface.surface_type == stInternal)
+                                surface.surface_type = type;
+                    }
+                    // The rest has already been performed by discover_vertical_shells().
+                } // for each region
+            } // for each layer
+        });
+    m_print->throw_if_canceled();
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
     for (size_t region_id = 0; region_id < this->num_printing_regions(); ++region_id) {
@@ -2881,12 +3132,18 @@ void PrintObject::combine_infill()
             combine[m_layers.size() - 1] = num_layers;
         }
         
-        // loop through layers to which we have assigned layers to combine
-        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx) {
+        // The uppermost layers of the groups to combine. The groups do not overlap, thus they are processed in parallel.
+        std::vector<size_t> groups;
+        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx)
+            if (combine[layer_idx] > 1)
+                groups.emplace_back(layer_idx);
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, groups.size()), [this, region_id, &region, &combine, &groups](const tbb::blocked_range<size_t> &range) {
+          PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
+          for (size_t group_idx = range.begin(); group_idx < range.end(); ++ group_idx) {
             m_print->throw_if_canceled();
+            size_t layer_idx  = groups[group_idx];
             size_t num_layers = combine[layer_idx];
-			if (num_layers <= 1)
-                continue;
             // Get all the LayerRegion objects to be combined.
             std::vector<LayerRegion*> layerms;
             layerms.reserve(num_layers);
@@ -2944,7 +3201,9 @@ void PrintObject::combine_infill()
                         stInternalVoid);
                 }
             }
-        }
+          }
+        });
+        m_print->throw_if_canceled();
     }
 } // void PrintObject::combine_infill()
 
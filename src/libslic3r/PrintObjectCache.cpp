@@ -0,0 +1,336 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "PrintObjectCache.hpp"
+
+#include "CacheIO.hpp"
+#include "ExtrusionEntityCollection.hpp"
+#include "Layer.hpp"
+#include "Model.hpp"
+#include "Print.hpp"
+
+#include <memory>
+
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r {
+
+// Increase if the key or the file format changes, or if the slicing, perimeter or infill steps produce different results for the same input.
+static constexpr const uint32_t cache_version = 1;
+// "PSOC"
+static constexpr const uint32_t cache_magic   = 0x434f5350;
+
+static std::string s_directory;
+
+void PrintObjectCache::set_directory(const std::string &dir)
+{
+    s_directory = dir;
+}
+
+const std::string& PrintObjectCache::directory()
+{
+    return s_directory;
+}
+
+bool PrintObjectCache::enabled()
+{
+    return ! s_directory.empty();
+}
+
+static boost::filesystem::path cache_file_path(const std::string &key)
+{
+    return (boost::filesystem::path(s_directory) / (key + ".layers")).make_preferred();
+}
+
+static void write_surfaces(CacheWriter &writer, const SurfaceCollection &surfaces)
+{
+    writer.write(uint32_t(surfaces.surfaces.size()));
+    for (const Surface &surface : surfaces.surfaces) {
+        writer.write(uint8_t(surface.surface_type));
+        writer.write(surface.expolygon);
+        writer.write(surface.thickness);
+        writer.write(surface.thickness_layers);
+        writer.write(surface.bridge_angle);
+        writer.write(surface.extra_perimeters);
+    }
+}
+
+static void read_surfaces(CacheReader &reader, SurfaceCollection &surfaces)
+{
+    uint32_t n = reader.read_count(sizeof(uint8_t) + 2 * sizeof(uint32_t));
+    surfaces.surfaces.clear();
+    surfaces.surfaces.reserve(n);
+    for (uint32_t i = 0; i < n && ! reader.failed(); ++ i) {
+        auto surface_type = SurfaceType(reader.read<uint8_t>());
+        Surface &surface = surfaces.surfaces.emplace_back(surface_type, reader.read_expolygon());
+        surface.thickness        = reader.read<double>();
+        surface.thickness_layers = reader.read<unsigned short>();
+        surface.bridge_angle     = reader.read<double>();
+        surface.extra_perimeters = reader.read<unsigned short>();
+    }
+}
+
+static void write_bboxes(CacheWriter &writer, const BoundingBoxes &bboxes)
+{
+    writer.write(uint32_t(bboxes.size()));
+    for (const BoundingBox &bbox : bboxes)
+        writer.write(bbox);
+}
+
+static BoundingBoxes read_bboxes(CacheReader &reader)
+{
+    BoundingBoxes out(reader.read_count(4 * sizeof(int64_t)));
+    for (BoundingBox &bbox : out)
+        bbox = reader.read_bbox();
+    return out;
+}
+
+static void write_range(CacheWriter &writer, const IndexRange<uint32_t> &range)
+{
+    writer.write(*range.begin());
+    writer.write(*range.end());
+}
+
+static IndexRange<uint32_t> read_range(CacheReader &reader)
+{
+    auto begin = reader.read<uint32_t>();
+    auto end   = reader.read<uint32_t>();
+    if (begin > end)
+        reader.set_failed();
+    return { begin, reader.failed() ? begin : end };
+}
+
+template<typename Links>
+static void write_links(CacheWriter &writer, const Links &links)
+{
+    writer.write(uint32_t(links.size()));
+    for (const LayerSlice::Link &link : links) {
+        writer.write(link.slice_idx);
+        writer.write(link.area);
+    }
+}
+
+template<typename Links>
+static void read_links(CacheReader &reader, Links &links)
+{
+    links.resize(reader.read_count(sizeof(int32_t) + sizeof(float)));
+    for (LayerSlice::Link &link : links) {
+        link.slice_idx = reader.read<int32_t>();
+        link.area      = reader.read<float>();
+    }
+}
+
+static void read_collection(CacheReader &reader, ExtrusionEntityCollection &dst)
+{
+    if (std::unique_ptr<ExtrusionEntity> entity = reader.read_entity(); entity && entity->is_collection())
+        dst = std::move(static_cast<ExtrusionEntityCollection&>(*entity));
+    else
+        reader.set_failed();
+}
+
+std::string PrintObjectCache::key(const PrintObject &print_object)
+{
+    CacheHasher hasher;
+    hasher.add(cache_version);
+
+    hasher.add(*print_object.model_object());
+    hasher.add(print_object.trafo_centered());
+    hasher.add(print_object.config());
+    for (const PrintRegion &region : print_object.all_regions())
+        hasher.add(region.config());
+    // Only the values of the print profile invalidating the object steps up to posInfill, see Print::invalidate_state_by_config_options().
+    hasher.add(print_object.print()->config(), {
+        "first_layer_height", "nozzle_diameter", "resolution", "spiral_vase",
+        "first_layer_extrusion_width", "min_layer_height", "max_layer_height", "gcode_resolution"
+    });
+
+    return hasher.hex_digest();
+}
+
+bool PrintObjectCache::load(PrintObject &print_object, const std::string &key)
+{
+    assert(enabled());
+    if (print_object.is_step_started_unguarded(posSlice))
+        return false;
+
+    boost::system::error_code   ec;
+    boost::filesystem::path     path = cache_file_path(key);
+    uintmax_t                   file_size = boost::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    boost::nowide::ifstream     ifs(path.string(), std::ios::binary);
+    if (! ifs)
+        return false;
+
+    CacheReader reader(ifs, size_t(file_size));
+    if (reader.read<uint32_t>() != cache_magic || reader.read<uint32_t>() != cache_version || reader.read_string() != key)
+        return false;
+
+    const size_t num_regions  = print_object.num_printing_regions();
+    const bool   typed_slices = reader.read<uint8_t>() != 0;
+    if (reader.read<uint32_t>() != num_regions)
+        return false;
+
+    LayerPtrs layers;
+    for (uint32_t num_layers = reader.read_count(4 * sizeof(uint64_t)), i = 0; i < num_layers && ! reader.failed(); ++ i) {
+        auto id      = reader.read<uint64_t>();
+        auto height  = reader.read<double>();
+        auto print_z = reader.read<double>();
+        auto slice_z = reader.read<double>();
+        Layer *layer = layers.emplace_back(new Layer(size_t(id), &print_object, height, print_z, slice_z));
+        if (i > 0) {
+            layers[i - 1]->upper_layer = layer;
+            layer->lower_layer = layers[i - 1];
+        }
+
+        layer->lslices = reader.read_expolygons();
+        layer->lslice_indices_sorted_by_print_order.resize(reader.read_count(sizeof(uint32_t)));
+        for (size_t &idx : layer->lslice_indices_sorted_by_print_order)
+            if (idx = reader.read<uint32_t>(); idx >= layer->lslices.size())
+                reader.set_failed();
+        layer->lslices_ex.resize(reader.read_count(4 * sizeof(int64_t)));
+        for (LayerSlice &lslice : layer->lslices_ex) {
+            lslice.bbox = reader.read_bbox();
+            read_links(reader, lslice.overlaps_above);
+            read_links(reader, lslice.overlaps_below);
+            lslice.islands.resize(reader.read_count(6 * sizeof(uint32_t)));
+            for (LayerIsland &island : lslice.islands) {
+                auto perimeters_region = reader.read<uint32_t>();
+                island.perimeters = { perimeters_region, read_range(reader) };
+                island.thin_fills = read_range(reader);
+                island.fills.resize(reader.read_count(3 * sizeof(uint32_t)));
+                for (LayerExtrusionRange &fill : island.fills) {
+                    auto fill_region = reader.read<uint32_t>();
+                    fill = { fill_region, read_range(reader) };
+                }
+                island.fill_expolygons = read_range(reader);
+                island.fill_region_id  = reader.read<uint32_t>();
+            }
+        }
+
+        for (size_t region_id = 0; region_id < num_regions && ! reader.failed(); ++ region_id) {
+            LayerRegion &layerm = *layer->add_region(&print_object.printing_region(region_id));
+            layerm.m_raw_slices = reader.read_expolygons();
+            read_surfaces(reader, layerm.m_slices);
+            layerm.m_fill_expolygons                  = reader.read_expolygons();
+            layerm.m_fill_expolygons_bboxes           = read_bboxes(reader);
+            layerm.m_fill_expolygons_composite        = reader.read_expolygons();
+            layerm.m_fill_expolygons_composite_bboxes = read_bboxes(reader);
+            read_surfaces(reader, layerm.m_fill_surfaces);
+            layerm.m_unsupported_bridge_edges.resize(reader.read_count(sizeof(uint32_t)));
+            for (Polyline &polyline : layerm.m_unsupported_bridge_edges)
+                polyline.points = reader.read_points();
+            read_collection(reader, layerm.m_thin_fills);
+            read_collection(reader, layerm.m_perimeters);
+            read_collection(reader, layerm.m_fills);
+        }
+    }
+
+    if (reader.failed()) {
+        BOOST_LOG_TRIVIAL(error) << "Layer cache file " << path.string() << " is corrupted, slicing the object again.";
+        for (Layer *layer : layers)
+            delete layer;
+        return false;
+    }
+
+    print_object.clear_layers();
+    print_object.m_layers       = std::move(layers);
+    print_object.m_typed_slices = typed_slices;
+    for (PrintObjectStep step : { posSlice, posPerimeters, posPrepareInfill, posInfill }) {
+        print_object.set_started(step);
+        print_object.set_done(step);
+    }
+    BOOST_LOG_TRIVIAL(debug) << "Layers of " << print_object.model_object()->name << " loaded from cache " << path.string();
+    return true;
+}
+
+bool PrintObjectCache::store(const PrintObject &print_object, const std::string &key)
+{
+    assert(enabled());
+    assert(print_object.is_step_done_unguarded(posInfill));
+    boost::system::error_code   ec;
+    boost::filesystem::create_directories(s_directory, ec);
+    boost::filesystem::path     path = cache_file_path(key);
+    // Write into a temporary file, then rename, so that concurrent processes sharing the cache never read a partial file.
+    boost::filesystem::path     path_tmp = path.parent_path() / boost::filesystem::unique_path(key + "-%%%%-%%%%.tmp");
+    bool                        success  = false;
+    {
+        boost::nowide::ofstream ofs(path_tmp.string(), std::ios::binary);
+        if (ofs) {
+            CacheWriter writer(ofs);
+            writer.write(cache_magic);
+            writer.write(cache_version);
+            writer.write(key);
+            writer.write(uint8_t(print_object.m_typed_slices));
+            writer.write(uint32_t(print_object.num_printing_regions()));
+            writer.write(uint32_t(print_object.layer_count()));
+            success = true;
+            for (const Layer *layer : print_object.layers()) {
+                writer.write(uint64_t(layer->id()));
+                writer.write(double(layer->height));
+                writer.write(double(layer->print_z));
+                writer.write(double(layer->slice_z));
+
+                writer.write(layer->lslices);
+                writer.write(uint32_t(layer->lslice_indices_sorted_by_print_order.size()));
+                for (size_t idx : layer->lslice_indices_sorted_by_print_order)
+                    writer.write(uint32_t(idx));
+                writer.write(uint32_t(layer->lslices_ex.size()));
+                for (const LayerSlice &lslice : layer->lslices_ex) {
+                    writer.write(lslice.bbox);
+                    write_links(writer, lslice.overlaps_above);
+                    write_links(writer, lslice.overlaps_below);
+                    writer.write(uint32_t(lslice.islands.size()));
+                    for (const LayerIsland &island : lslice.islands) {
+                        writer.write(island.perimeters.region());
+                        write_range(writer, island.perimeters);
+                        write_range(writer, island.thin_fills);
+                        writer.write(uint32_t(island.fills.size()));
+                        for (const LayerExtrusionRange &fill : island.fills) {
+                            writer.write(fill.region());
+                            write_range(writer, fill);
+                        }
+                        write_range(writer, island.fill_expolygons);
+                        writer.write(island.fill_region_id);
+                    }
+                }
+
+                assert(layer->region_count() == print_object.num_printing_regions());
+                for (const LayerRegion *layerm : layer->regions()) {
+                    writer.write(layerm->m_raw_slices);
+                    write_surfaces(writer, layerm->m_slices);
+                    writer.write(layerm->m_fill_expolygons);
+                    write_bboxes(writer, layerm->m_fill_expolygons_bboxes);
+                    writer.write(layerm->m_fill_expolygons_composite);
+                    write_bboxes(writer, layerm->m_fill_expolygons_composite_bboxes);
+                    write_surfaces(writer, layerm->m_fill_surfaces);
+                    writer.write(uint32_t(layerm->m_unsupported_bridge_edges.size()));
+                    for (const Polyline &polyline : layerm->m_unsupported_bridge_edges)
+                        writer.write(polyline.points);
+                    if (! writer.write(layerm->m_thin_fills) || ! writer.write(layerm->m_perimeters) || ! writer.write(layerm->m_fills)) {
+                        success = false;
+                        break;
+                    }
+                }
+                if (! success)
+                    break;
+            }
+            ofs.close();
+            success &= ! ofs.fail();
+        }
+    }
+    if (success) {
+        boost::filesystem::rename(path_tmp, path, ec);
+        success = ! ec;
+    }
+    if (! success) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to store layers of " << print_object.model_object()->name << " into cache " << path.string();
+        boost::filesystem::remove(path_tmp, ec);
+    }
+    return success;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,43 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_PrintObjectCache_hpp_
+#define slic3r_PrintObjectCache_hpp_
+
+#include <string>
+
+namespace Slic3r {
+
+class PrintObject;
+
+// Optional persistent cache of the layers of a PrintObject as produced by the posSlice, posPerimeters, posPrepareInfill
+// and posInfill steps, shared by all processes pointed to the same directory. Disabled by default.
+// The cache is keyed by an MD5 hash of the inputs of these steps: the meshes, painted facets, transformations and configs
+// of the ModelVolumes, the variable layer height profile, the PrintObjectConfig, the configs of the printing regions
+// and the few PrintConfig values these steps depend on. The PrintConfig values influencing the G-code export only
+// (the custom G-code templates, temperatures, speeds, bed shape, retractions...) are not part of the key,
+// thus slicing the same object with another printer profile reuses the cached layers.
+// The supports are cached separately by FFFSupport::SupportCache.
+class PrintObjectCache
+{
+public:
+    // Empty directory disables the cache.
+    static void                 set_directory(const std::string &dir);
+    static const std::string&   directory();
+    static bool                 enabled();
+
+    // Hex string of the cache key. Valid before the object is sliced.
+    static std::string          key(const PrintObject &print_object);
+    // If none of the steps of print_object was started yet, replace its layers with the cached ones
+    // and mark the steps up to posInfill as done. Returns false if not cached or if the cached file is not readable,
+    // then print_object is left untouched.
+    static bool                 load(PrintObject &print_object, const std::string &key);
+    // Store the layers of print_object after posInfill finished. Returns false if the layers contain extrusions,
+    // which could not be serialized, or if the file could not be written.
+    static bool                 store(const PrintObject &print_object, const std::string &key);
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_PrintObjectCache_hpp_
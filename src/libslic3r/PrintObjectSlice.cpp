@@ -6,6 +6,7 @@
 #include "ElephantFootCompensation.hpp"
 #include "I18N.hpp"
 #include "Layer.hpp"
+#include "ProfilerTracy.hpp"
 #include "MultiMaterialSegmentation.hpp"
 #include "Print.hpp"
 #include "ShortestPath.hpp"
@@ -42,23 +43,104 @@ LayerPtrs new_layers(
     return out;
 }
 
+// Slices of a single ModelVolume retained from the last slice_volumes() call.
+// TriangleMesh of a ModelVolume is immutable and shared by the copies of the ModelVolume,
+// thus holding the shared pointer identifies the mesh reliably.
+// The slicing planes are stored relative to the Z translation of the transformation, thus the slices remain valid
+// if the object is lifted or sunk below the print bed, see Print::apply().
+struct VolumeSliceCache
+{
+    ObjectID                             volume_id;
+    std::shared_ptr<const TriangleMesh>  mesh;
+    // Including the transformation of the volume.
+    MeshSlicingParamsEx                  params;
+    // Sorted slicing planes in mesh space (without the Z translation of params.trafo) and their slices.
+    std::vector<float>                   zs;
+    std::vector<ExPolygons>              slices;
+
+    // Slicing planes closer than this are considered equal. Moving the object in Z accumulates rounding errors
+    // of the layer heights, which are far below the resolution of the slices.
+    static constexpr const float         z_epsilon = 1e-5f;
+
+    bool matches(const ModelVolume &volume, const MeshSlicingParamsEx &params) const {
+        return this->mesh && this->mesh == volume.mesh_ptr() &&
+            this->params.mode == params.mode && this->params.mode_below == params.mode_below &&
+            this->params.slicing_mode_normal_below_layer == params.slicing_mode_normal_below_layer &&
+            // Translation in Z is not compared, the slicing planes are stored in mesh space.
+            this->params.trafo.linear() == params.trafo.linear() &&
+            this->params.trafo.translation().head<2>() == params.trafo.translation().head<2>() &&
+            this->params.closing_radius == params.closing_radius && this->params.extra_offset == params.extra_offset &&
+            this->params.resolution == params.resolution;
+    }
+};
+
+struct PrintObjectSliceCache
+{
+    // Sorted by ModelVolume::id().
+    std::vector<VolumeSliceCache> volumes;
+};
+
 // Slice single triangle mesh.
+// If cache is provided, layers of the same Z in mesh space sliced by the previous call with the same mesh and parameters
+// are reused and the cache is updated with the new slices.
 static std::vector<ExPolygons> slice_volume(
     const ModelVolume             &volume,
     const std::vector<float>      &zs, 
     const MeshSlicingParamsEx     &params,
+    VolumeSliceCache              *cache,
     const std::function<void()>   &throw_on_cancel_callback)
 {
     std::vector<ExPolygons> layers;
-    if (! zs.empty()) {
-        indexed_triangle_set its = volume.mesh().its;
-        if (its.indices.size() > 0) {
-            MeshSlicingParamsEx params2 { params };
-            params2.trafo = params2.trafo * volume.get_matrix();
+    if (! zs.empty() && volume.mesh().its.indices.size() > 0) {
+        MeshSlicingParamsEx params2 { params };
+        params2.trafo = params2.trafo * volume.get_matrix();
+        if (params2.slicing_mode_normal_below_layer > 0 && params2.mode_below != params2.mode)
+            // Slicing mode depends on the layer index (vase mode bottom layers), the layers are not interchangeable.
+            cache = nullptr;
+        const std::vector<float> *zs_to_slice = &zs;
+        std::vector<float>        zs_missing;
+        std::vector<size_t>       idx_missing;
+        // Z of the slicing planes in mesh space.
+        std::vector<float>        zs_mesh;
+        if (cache != nullptr) {
+            const float z_offset = float(params2.trafo.translation().z());
+            zs_mesh.reserve(zs.size());
+            for (float z : zs)
+                zs_mesh.emplace_back(z - z_offset);
+        }
+        if (cache != nullptr && cache->matches(volume, params2)) {
+            layers.assign(zs.size(), ExPolygons());
+            for (size_t i = 0, j = 0; i < zs.size(); ++ i) {
+                for (; j < cache->zs.size() && cache->zs[j] < zs_mesh[i] - VolumeSliceCache::z_epsilon; ++ j) ;
+                if (j < cache->zs.size() && cache->zs[j] <= zs_mesh[i] + VolumeSliceCache::z_epsilon)
+                    layers[i] = std::move(cache->slices[j ++]);
+                else {
+                    zs_missing.emplace_back(zs[i]);
+                    idx_missing.emplace_back(i);
+                }
+            }
+            zs_to_slice = &zs_missing;
+        }
+        if (cache != nullptr)
+            // Invalidate the cache until the new slices are stored, the slicing may be canceled.
+            cache->mesh.reset();
+        if (! zs_to_slice->empty()) {
+            indexed_triangle_set its = volume.mesh().its;
             if (params2.trafo.rotation().determinant() < 0.)
                 its_flip_triangles(its);
-            layers = slice_mesh_ex(its, zs, params2, throw_on_cancel_callback);
+            std::vector<ExPolygons> sliced = slice_mesh_ex(its, *zs_to_slice, params2, throw_on_cancel_callback);
             throw_on_cancel_callback();
+            if (zs_to_slice == &zs)
+                layers = std::move(sliced);
+            else
+                for (size_t i = 0; i < idx_missing.size(); ++ i)
+                    layers[idx_missing[i]] = std::move(sliced[i]);
+        }
+        if (cache != nullptr) {
+            cache->mesh   = volume.mesh_ptr();
+            cache->params = params2;
+            cache->zs     = std::move(zs_mesh);
+            cache->slices = layers;
         }
     }
     return layers;
@@ -71,13 +153,14 @@ static std::vector<ExPolygons> slice_volume(
     const std::vector<float>                    &z,
     const std::vector<t_layer_height_range>     &ranges,
     const MeshSlicingParamsEx                   &params,
+    VolumeSliceCache                            *cache,
     const std::function<void()>                 &throw_on_cancel_callback)
 {
     std::vector<ExPolygons> out;
     if (! z.empty() && ! ranges.empty()) {
         if (ranges.size() == 1 && z.front() >= ranges.front().first && z.back() < ranges.front().second) {
             // All layers fit into a single range.
-            out = slice_volume(volume, z, params, throw_on_cancel_callback);
+            out = slice_volume(volume, z, params, cache, throw_on_cancel_callback);
         } else {
             std::vector<float>                     z_filtered;
             std::vector<std::pair<size_t, size_t>> n_filtered;
@@ -93,7 +176,7 @@ static std::vector<ExPolygons> slice_volume(
                     n_filtered.emplace_back(std::make_pair(first, i));
             }
             if (! n_filtered.empty()) {
-                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, throw_on_cancel_callback);
+                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, cache, throw_on_cancel_callback);
                 out.assign(z.size(), ExPolygons());
                 i = 0;
                 for (const std::pair<size_t, size_t> &span : n_filtered)
@@ -121,6 +204,7 @@ static inline bool model_volume_needs_slicing(const ModelVolume &mv)
 // Apply closing radius.
 // Apply positive XY compensation to ModelVolumeType::MODEL_PART and ModelVolumeType::PARAMETER_MODIFIER, not to ModelVolumeType::NEGATIVE_VOLUME.
 // Apply contour simplification.
+// Slices of layers with unchanged Z are reused from cache if provided, the cache is updated with the new slices.
 static std::vector<VolumeSlices> slice_volumes_inner(
     const PrintConfig                                        &print_config,
     const PrintObjectConfig                                  &print_object_config,
@@ -128,6 +212,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
     ModelVolumePtrs                                           model_volumes,
     const std::vector<PrintObjectRegions::LayerRangeRegions> &layer_ranges,
     const std::vector<float>                                 &zs,
+    PrintObjectSliceCache                                    *cache,
     const std::function<void()>                              &throw_on_cancel_callback)
 {
     model_volumes_sort_by_id(model_volumes);
@@ -135,6 +220,21 @@ static std::vector<VolumeSlices> slice_volumes_inner(
     std::vector<VolumeSlices> out;
     out.reserve(model_volumes.size());
 
+    // Cache entries of the volumes sliced now, entries of the volumes no more sliced are dropped.
+    std::vector<VolumeSliceCache> cache_out;
+    cache_out.reserve(model_volumes.size());
+    auto volume_cache = [cache, &cache_out](const ModelVolume &model_volume) -> VolumeSliceCache* {
+        if (cache == nullptr)
+            return nullptr;
+        const ObjectID id = model_volume.id();
+        auto it = lower_bound_by_predicate(cache->volumes.begin(), cache->volumes.end(), [id](const VolumeSliceCache &vc) { return vc.volume_id < id; });
+        if (it != cache->volumes.end() && it->volume_id == id)
+            cache_out.emplace_back(std::move(*it));
+        else
+            cache_out.push_back({ id });
+        return &cache_out.back();
+    };
+
     std::vector<t_layer_height_range> slicing_ranges;
     if (layer_ranges.size() > 1)
         slicing_ranges.reserve(layer_ranges.size());
@@ -177,7 +277,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                     }
                     out.push_back({
                         model_volume->id(), 
-                        slice_volume(*model_volume, zs, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, params, volume_cache(*model_volume), throw_on_cancel_callback)
                     });
                 }
             } else {
@@ -189,13 +289,16 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                 if (! slicing_ranges.empty())
                     out.push_back({ 
                         model_volume->id(), 
-                        slice_volume(*model_volume, zs, slicing_ranges, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, slicing_ranges, params, volume_cache(*model_volume), throw_on_cancel_callback)
                     });
             }
             if (! out.empty() && out.back().slices.empty())
                 out.pop_back();
         }
 
+    if (cache != nullptr)
+        cache->volumes = std::move(cache_out);
+
     return out;
 }
 
@@ -499,6 +602,7 @@ std::string fix_slicing_errors(LayerPtrs &layers, const std::function<void()> &t
 // Resulting expolygons of layer regions are marked as Internal.
 void PrintObject::slice()
 {
+    SLIC3R_PROFILE_ZONE();
     if (! this->set_started(posSlice))
         return;
     m_print->set_status(10, _u8L("Processing triangulated mesh"));
@@ -699,11 +803,14 @@ void PrintObject::slice_volumes()
             layer->m_regions.emplace_back(new LayerRegion(layer, pr.get()));
     }
 
+    if (! m_slice_cache)
+        m_slice_cache = std::make_shared<PrintObjectSliceCache>();
+
     std::vector<float>                   slice_zs      = zs_from_layers(m_layers);
     std::vector<std::vector<ExPolygons>> region_slices = slices_to_regions(this->model_object()->volumes, *m_shared_regions, slice_zs,
         slice_volumes_inner(
             print->config(), this->config(), this->trafo_centered(),
-            this->model_object()->volumes, m_shared_regions->layer_ranges, slice_zs, throw_on_cancel_callback),
+            this->model_object()->volumes, m_shared_regions->layer_ranges, slice_zs, m_slice_cache.get(), throw_on_cancel_callback),
         throw_on_cancel_callback);
 
     for (size_t region_id = 0; region_id < region_slices.size(); ++ region_id) {
@@ -843,7 +950,7 @@ std::vector<Polygons> PrintObject::slice_support_volumes(const ModelVolumeType m
         params.trafo = this->trafo_centered();
         for (; it_volume != it_volume_end; ++ it_volume)
             if ((*it_volume)->type() == model_volume_type) {
-                std::vector<ExPolygons> slices2 = slice_volume(*(*it_volume), zs, params, throw_on_cancel_callback);
+                std::vector<ExPolygons> slices2 = slice_volume(*(*it_volume), zs, params, nullptr, throw_on_cancel_callback);
                 if (slices.empty()) {
                     slices.reserve(slices2.size());
                     for (ExPolygons &src : slices2)
@@ -0,0 +1,135 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "CacheIO.hpp"
+#include "Exception.hpp"
+#include "ExtrusionEntityCollection.hpp"
+#include "Layer.hpp"
+#include "Model.hpp"
+#include "Print.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r {
+
+static size_t extrusion_memsize(const ExtrusionPath &path)
+{
+    return sizeof(ExtrusionPath) + path.polyline.points.capacity() * sizeof(Point);
+}
+
+static size_t extrusion_memsize(const ExtrusionEntity &entity)
+{
+    size_t out = 0;
+    if (auto *collection = dynamic_cast<const ExtrusionEntityCollection*>(&entity)) {
+        out = sizeof(ExtrusionEntityCollection) + collection->entities.capacity() * sizeof(ExtrusionEntity*);
+        for (const ExtrusionEntity *ee : collection->entities)
+            out += extrusion_memsize(*ee);
+    } else if (auto *path = dynamic_cast<const ExtrusionPath*>(&entity)) {
+        out = extrusion_memsize(*path);
+    } else if (auto *multipath = dynamic_cast<const ExtrusionMultiPath*>(&entity)) {
+        out = sizeof(ExtrusionMultiPath);
+        for (const ExtrusionPath &path : multipath->paths)
+            out += extrusion_memsize(path);
+    } else if (auto *loop = dynamic_cast<const ExtrusionLoop*>(&entity)) {
+        out = sizeof(ExtrusionLoop);
+        for (const ExtrusionPath &path : loop->paths)
+            out += extrusion_memsize(path);
+    }
+    return out;
+}
+
+size_t PrintObject::extrusions_memsize() const
+{
+    size_t out = 0;
+    for (const Layer *layer : m_layers)
+        for (const LayerRegion *layerm : layer->regions())
+            out += extrusion_memsize(layerm->m_perimeters) + extrusion_memsize(layerm->m_thin_fills) + extrusion_memsize(layerm->m_fills);
+    for (const SupportLayer *layer : m_support_layers)
+        out += extrusion_memsize(layer->support_fills);
+    return out;
+}
+
+bool PrintObject::spill_extrusions()
+{
+    assert(! this->extrusions_spilled());
+    boost::system::error_code   ec;
+    boost::filesystem::path     path = boost::filesystem::temp_directory_path(ec);
+    if (ec)
+        return false;
+    path /= boost::filesystem::unique_path("." SLIC3R_APP_KEY ".spill.%%%%-%%%%-%%%%-%%%%");
+    bool success = false;
+    {
+        boost::nowide::ofstream ofs(path.string(), std::ios::binary);
+        if (ofs) {
+            CacheWriter writer(ofs);
+            success = true;
+            for (const Layer *layer : m_layers)
+                for (const LayerRegion *layerm : layer->regions())
+                    success &= writer.write(layerm->m_perimeters) && writer.write(layerm->m_thin_fills) && writer.write(layerm->m_fills);
+            for (const SupportLayer *layer : m_support_layers)
+                success &= writer.write(layer->support_fills);
+            ofs.close();
+            success &= ! ofs.fail();
+        }
+    }
+    if (! success) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to move extrusions of " << this->model_object()->name << " into " << path.string();
+        boost::filesystem::remove(path, ec);
+        return false;
+    }
+
+    for (Layer *layer : m_layers)
+        for (LayerRegion *layerm : layer->regions()) {
+            layerm->m_perimeters = ExtrusionEntityCollection();
+            layerm->m_thin_fills = ExtrusionEntityCollection();
+            layerm->m_fills      = ExtrusionEntityCollection();
+        }
+    for (SupportLayer *layer : m_support_layers)
+        layer->support_fills = ExtrusionEntityCollection();
+    m_spill_path = path.string();
+    BOOST_LOG_TRIVIAL(debug) << "Extrusions of " << this->model_object()->name << " moved into " << m_spill_path;
+    return true;
+}
+
+void PrintObject::restore_extrusions()
+{
+    if (! this->extrusions_spilled())
+        return;
+
+    boost::system::error_code   ec;
+    uintmax_t                   file_size = boost::filesystem::file_size(m_spill_path, ec);
+    bool                        success   = false;
+    if (! ec) {
+        boost::nowide::ifstream ifs(m_spill_path, std::ios::binary);
+        CacheReader reader(ifs, size_t(file_size));
+        auto read_collection = [&reader](ExtrusionEntityCollection &dst) {
+            if (std::unique_ptr<ExtrusionEntity> entity = reader.read_entity(); entity && entity->is_collection())
+                dst = std::move(static_cast<ExtrusionEntityCollection&>(*entity));
+            else
+                reader.set_failed();
+        };
+        for (Layer *layer : m_layers)
+            for (LayerRegion *layerm : layer->regions()) {
+                read_collection(layerm->m_perimeters);
+                read_collection(layerm->m_thin_fills);
+                read_collection(layerm->m_fills);
+            }
+        for (SupportLayer *layer : m_support_layers)
+            read_collection(layer->support_fills);
+        success = ! reader.failed();
+    }
+
+    std::string path = std::move(m_spill_path);
+    m_spill_path.clear();
+    boost::filesystem::remove(path, ec);
+    if (! success) {
+        // The extrusions are lost, they have to be generated again.
+        this->invalidate_all_steps();
+        throw Slic3r::RuntimeError("Failed to load extrusions of " + this->model_object()->name + " from " + path);
+    }
+}
+
+} // namespace Slic3r
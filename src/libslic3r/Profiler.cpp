@@ -0,0 +1,362 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "Profiler.hpp"
+#include "ProfilerTracy.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <locale>
+#include <map>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <vector>
+
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r::Profiler {
+
+namespace {
+
+struct Event {
+    const char  *category;
+    const char  *name;
+    std::string  object;
+    int          layer_id;
+    uint32_t     thread_id;
+    uint64_t     start;
+    uint64_t     duration;
+    // Memory accounting of the slicing steps.
+    bool         has_memory;
+    StepMemory   memory;
+};
+
+// Histograms are indexed by the binary logarithm of the value.
+static constexpr const size_t num_histogram_bins = 40;
+using Histogram = std::array<uint64_t, num_histogram_bins>;
+
+static inline size_t histogram_bin(uint64_t value)
+{
+    size_t bin = 0;
+    for (; value > 1 && bin + 1 < num_histogram_bins; value >>= 1)
+        ++ bin;
+    return bin;
+}
+
+struct Stats {
+    uint64_t  count { 0 };
+    uint64_t  total { 0 };
+    uint64_t  min   { std::numeric_limits<uint64_t>::max() };
+    uint64_t  max   { 0 };
+    Histogram histogram {};
+    // Sums of the memory accounting of the steps, maximum of the peak RSS.
+    bool       has_memory { false };
+    StepMemory memory;
+
+    void add(const Event &event) {
+        ++ count;
+        total += event.duration;
+        min = std::min(min, event.duration);
+        max = std::max(max, event.duration);
+        ++ histogram[histogram_bin(event.duration / 1000)];
+        if (event.has_memory) {
+            has_memory = true;
+            memory.allocations       += event.memory.allocations;
+            memory.allocated_bytes   += event.memory.allocated_bytes;
+            memory.peak_rss           = std::max(memory.peak_rss, event.memory.peak_rss);
+            memory.peak_rss_increase += event.memory.peak_rss_increase;
+        }
+    }
+};
+
+struct State {
+    std::atomic<bool>                            enabled { false };
+    std::mutex                                   mutex;
+    std::vector<Event>                           events;
+    uint64_t                                     origin { 0 };
+    std::atomic<uint64_t>                        clipper_calls { 0 };
+    std::atomic<uint64_t>                        clipper_points { 0 };
+    std::array<std::atomic<uint64_t>, num_histogram_bins> clipper_histogram {};
+    std::atomic<uint32_t>                        num_threads { 0 };
+    std::atomic<uint64_t>                        allocations { 0 };
+    std::atomic<uint64_t>                        allocated_bytes { 0 };
+};
+
+static State& state()
+{
+    static State s;
+    return s;
+}
+
+static uint32_t this_thread_id()
+{
+    static thread_local uint32_t id = state().num_threads.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+// Escape a string to be written into a JSON string literal.
+static std::string json_escape(const std::string &s)
+{
+    std::string out;
+    out.reserve(s.size() + 2);
+    for (const char c : s) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", int(c));
+                out += buf;
+            } else
+                out += c;
+        }
+    }
+    return out;
+}
+
+template<typename Container>
+static void write_histogram(std::ostream &os, const Container &histogram)
+{
+    // Trim the trailing empty bins.
+    size_t n = histogram.size();
+    while (n > 0 && histogram[n - 1] == 0)
+        -- n;
+    os << "[";
+    for (size_t i = 0; i < n; ++ i)
+        os << (i == 0 ? "" : ",") << uint64_t(histogram[i]);
+    os << "]";
+}
+
+static void write_memory(std::ostream &os, const StepMemory &memory)
+{
+    if (allocations_counted())
+        os << ",\"allocations\":" << memory.allocations << ",\"allocated_bytes\":" << memory.allocated_bytes;
+    os << ",\"peak_rss\":" << memory.peak_rss << ",\"peak_rss_increase\":" << memory.peak_rss_increase;
+}
+
+static void write_stats(std::ostream &os, const Stats &stats)
+{
+    os << "\"count\":" << stats.count << ",\"total_ms\":" << double(stats.total) * 1e-6
+       << ",\"min_ms\":" << (stats.count == 0 ? 0. : double(stats.min) * 1e-6) << ",\"max_ms\":" << double(stats.max) * 1e-6;
+    if (stats.has_memory)
+        write_memory(os, stats.memory);
+}
+
+} // namespace
+
+void set_enabled(bool enabled)
+{
+    State &s = state();
+    {
+        std::scoped_lock<std::mutex> lock(s.mutex);
+        if (enabled && s.origin == 0)
+            s.origin = now_nanoseconds();
+    }
+    s.enabled = enabled;
+}
+
+bool enabled()
+{
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+void clear()
+{
+    State &s = state();
+    std::scoped_lock<std::mutex> lock(s.mutex);
+    s.events.clear();
+    s.origin = s.enabled ? now_nanoseconds() : 0;
+    s.clipper_calls  = 0;
+    s.clipper_points = 0;
+    for (std::atomic<uint64_t> &bin : s.clipper_histogram)
+        bin = 0;
+}
+
+uint64_t now_nanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+MemoryCounters memory_counters()
+{
+    const State &s = state();
+    return { s.allocations.load(std::memory_order_relaxed), s.allocated_bytes.load(std::memory_order_relaxed), peak_memory_usage() };
+}
+
+bool allocations_counted()
+{
+#ifdef SLIC3R_PROFILE_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void count_allocation(size_t bytes)
+{
+    if (! enabled())
+        return;
+    State &s = state();
+    s.allocations.fetch_add(1, std::memory_order_relaxed);
+    s.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+StepStart step_start()
+{
+    return { now_nanoseconds(), memory_counters() };
+}
+
+StepMemory step_memory(const MemoryCounters &start, const MemoryCounters &end)
+{
+    return { end.allocations - start.allocations, end.allocated_bytes - start.allocated_bytes,
+             end.peak_rss, end.peak_rss > start.peak_rss ? end.peak_rss - start.peak_rss : 0 };
+}
+
+void record(const char *category, const char *name, const char *object, int layer_id, uint64_t start_nanoseconds, uint64_t end_nanoseconds,
+            const StepMemory *memory)
+{
+    if (! enabled())
+        return;
+    State &s = state();
+    Event  event { category, name, object ? std::string(object) : std::string(), layer_id, this_thread_id(),
+                   start_nanoseconds, end_nanoseconds > start_nanoseconds ? end_nanoseconds - start_nanoseconds : 0,
+                   memory != nullptr, memory ? *memory : StepMemory{} };
+    std::scoped_lock<std::mutex> lock(s.mutex);
+    s.events.emplace_back(std::move(event));
+}
+
+void count_clipper_call(size_t num_points)
+{
+    if (! enabled())
+        return;
+    State &s = state();
+    s.clipper_calls.fetch_add(1, std::memory_order_relaxed);
+    s.clipper_points.fetch_add(num_points, std::memory_order_relaxed);
+    s.clipper_histogram[histogram_bin(num_points)].fetch_add(1, std::memory_order_relaxed);
+}
+
+bool write_json(const std::string &path)
+{
+    State &s = state();
+    std::scoped_lock<std::mutex> lock(s.mutex);
+
+    // Steps and per layer intervals over all objects, both of them per object as well.
+    using Key = std::pair<std::string, std::string>;
+    std::map<Key, Stats>                        steps;
+    std::map<std::string, std::map<Key, Stats>> objects;
+    std::map<Key, Stats>                        layers;
+    for (const Event &event : s.events) {
+        Key key { event.category, event.name };
+        (event.layer_id >= 0 ? layers : steps)[key].add(event);
+        if (! event.object.empty())
+            objects[event.object][key].add(event);
+    }
+
+    boost::nowide::ofstream os(path);
+    if (! os.good()) {
+        BOOST_LOG_TRIVIAL(error) << "Profiler: Failed to open " << path << " for writing";
+        return false;
+    }
+    os.imbue(std::locale::classic());
+    os << std::fixed << std::setprecision(3);
+    auto write_map = [&os](const std::map<Key, Stats> &map, bool histogram) {
+        os << "[";
+        bool first = true;
+        for (const auto &[key, stats] : map) {
+            os << (first ? "" : ",") << "\n{\"category\":\"" << json_escape(key.first) << "\",\"name\":\"" << json_escape(key.second) << "\",";
+            write_stats(os, stats);
+            if (histogram) {
+                os << ",\"histogram_log2_us\":";
+                write_histogram(os, stats.histogram);
+            }
+            os << "}";
+            first = false;
+        }
+        os << "]";
+    };
+    os << "{\"steps\":";
+    write_map(steps, false);
+    os << ",\n\"objects\":{";
+    bool first = true;
+    for (const auto &[object, map] : objects) {
+        os << (first ? "" : ",") << "\n\"" << json_escape(object) << "\":";
+        write_map(map, true);
+        first = false;
+    }
+    os << "},\n\"layers\":";
+    write_map(layers, true);
+    os << ",\n\"clipper\":{\"calls\":" << s.clipper_calls.load() << ",\"points\":" << s.clipper_points.load() << ",\"histogram_log2_points\":";
+    write_histogram(os, s.clipper_histogram);
+    os << "}}\n";
+    os.close();
+    return ! os.fail();
+}
+
+bool write_chrome_trace(const std::string &path)
+{
+    State &s = state();
+    std::scoped_lock<std::mutex> lock(s.mutex);
+
+    boost::nowide::ofstream os(path);
+    if (! os.good()) {
+        BOOST_LOG_TRIVIAL(error) << "Profiler: Failed to open " << path << " for writing";
+        return false;
+    }
+    os.imbue(std::locale::classic());
+    os << std::fixed << std::setprecision(3);
+    // Complete events ("ph":"X") with timestamps in microseconds.
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const Event &event : s.events) {
+        os << (first ? "" : ",") << "\n{\"name\":\"" << json_escape(event.name) << "\",\"cat\":\"" << json_escape(event.category)
+           << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread_id
+           << ",\"ts\":" << double(event.start - std::min(event.start, s.origin)) * 1e-3 << ",\"dur\":" << double(event.duration) * 1e-3
+           << ",\"args\":{\"object\":\"" << json_escape(event.object) << "\",\"layer\":" << event.layer_id;
+        if (event.has_memory)
+            write_memory(os, event.memory);
+        os << "}}";
+        first = false;
+    }
+    os << "\n]}\n";
+    os.close();
+    return ! os.fail();
+}
+
+} // namespace Slic3r::Profiler
+
+#if defined(SLIC3R_PROFILE_ALLOCATIONS) || defined(SLIC3R_PROFILE_TRACY)
+// Replacement of the global operator new / delete counting the allocations for the profiling report
+// and / or reporting them to the Tracy profiler. The aligned variants are left to the standard library.
+// On Windows, where the PrusaSlicer application is a DLL loaded by a thin executable, the replacement
+// only covers the allocations of the modules linked into that DLL.
+void* operator new(std::size_t size)
+{
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+#ifdef SLIC3R_PROFILE_ALLOCATIONS
+    Slic3r::Profiler::count_allocation(size);
+#endif // SLIC3R_PROFILE_ALLOCATIONS
+    SLIC3R_PROFILE_ALLOC(ptr, size);
+    return ptr;
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void  operator delete(void *ptr) noexcept { SLIC3R_PROFILE_FREE(ptr); std::free(ptr); }
+void  operator delete[](void *ptr) noexcept { operator delete(ptr); }
+void  operator delete(void *ptr, std::size_t) noexcept { operator delete(ptr); }
+void  operator delete[](void *ptr, std::size_t) noexcept { operator delete(ptr); }
+#endif // SLIC3R_PROFILE_ALLOCATIONS || SLIC3R_PROFILE_TRACY
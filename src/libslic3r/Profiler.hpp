@@ -0,0 +1,95 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef libslic3r_Profiler_hpp_
+#define libslic3r_Profiler_hpp_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Slic3r {
+
+// Run time instrumentation of the slicing pipeline, usable in release builds.
+// Profiling is disabled by default. If disabled, the recording functions return immediately,
+// thus the instrumentation may stay in the production code.
+// The recorded intervals are reported either as a JSON summary (per step, per object and per layer histograms,
+// memory accounting of the steps, counts of Clipper calls) or in the Chrome trace event format to be loaded
+// by chrome://tracing or Perfetto.
+namespace Profiler {
+
+void        set_enabled(bool enabled);
+bool        enabled();
+// Drop all the recorded intervals and counters.
+void        clear();
+
+uint64_t    now_nanoseconds();
+
+// Memory counters of the process.
+struct MemoryCounters {
+    // Number and total size of the allocations done through the global operator new while the profiling was enabled.
+    // Only counted if compiled with SLIC3R_PROFILE_ALLOCATIONS, see allocations_counted().
+    uint64_t    allocations     { 0 };
+    uint64_t    allocated_bytes { 0 };
+    // Peak resident set size of the process.
+    size_t      peak_rss        { 0 };
+};
+MemoryCounters memory_counters();
+// Is the global operator new replaced to count the allocations?
+bool        allocations_counted();
+// Called by the replaced global operator new.
+void        count_allocation(size_t bytes);
+
+// Memory accounting of a slicing step. The steps of multiple objects run concurrently, thus the allocations
+// of a step include the allocations of the steps of the other objects running at the same time.
+struct StepMemory {
+    uint64_t    allocations       { 0 };
+    uint64_t    allocated_bytes   { 0 };
+    // Peak RSS of the process at the end of the step and its increase while the step was running.
+    size_t      peak_rss          { 0 };
+    size_t      peak_rss_increase { 0 };
+};
+
+// State at the start of a slicing step, zero nanoseconds if not sampled.
+struct StepStart {
+    uint64_t        nanoseconds { 0 };
+    MemoryCounters  memory;
+};
+StepStart   step_start();
+StepMemory  step_memory(const MemoryCounters &start, const MemoryCounters &end);
+
+// Record an interval [start, end]. object is the name of the PrintObject or nullptr,
+// layer_id is -1 for intervals not related to a single layer.
+// memory is the memory accounting of a slicing step or nullptr.
+void        record(const char *category, const char *name, const char *object, int layer_id, uint64_t start_nanoseconds, uint64_t end_nanoseconds,
+                   const StepMemory *memory = nullptr);
+
+// Record the interval of life time of this object.
+class Scope {
+public:
+    // All the strings have to outlive this object.
+    Scope(const char *category, const char *name, const char *object = nullptr, int layer_id = -1) :
+        m_category(category), m_name(name), m_object(object), m_layer_id(layer_id), m_start(enabled() ? now_nanoseconds() : 0) {}
+    ~Scope() { if (m_start != 0) record(m_category, m_name, m_object, m_layer_id, m_start, now_nanoseconds()); }
+
+private:
+    const char         *m_category;
+    const char         *m_name;
+    const char         *m_object;
+    int                 m_layer_id;
+    uint64_t            m_start;
+};
+
+// Called by ClipperUtils for each boolean operation or offset with the number of input vertices.
+void        count_clipper_call(size_t num_points);
+
+// Return false if the file could not be written.
+bool        write_json(const std::string &path);
+bool        write_chrome_trace(const std::string &path);
+
+} // namespace Profiler
+
+} // namespace Slic3r
+
+#endif // libslic3r_Profiler_hpp_
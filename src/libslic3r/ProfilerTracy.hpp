@@ -0,0 +1,46 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_ProfilerTracy_hpp_
+#define slic3r_ProfilerTracy_hpp_
+
+// Compile time instrumentation for the Tracy frame profiler (https://github.com/wolfpld/tracy),
+// complementing the run time Profiler of Profiler.hpp with zones of the hot functions, lock contention
+// and allocations, covering the GUI as well.
+// Enabled by the SLIC3R_PROFILE_TRACY CMake option, otherwise all the macros expand to nothing
+// (the lockable ones to the plain lockable type), so the instrumentation costs nothing in regular builds.
+//
+// SLIC3R_PROFILE_ZONE()                - scoped zone named after the enclosing function.
+// SLIC3R_PROFILE_ZONE_NAMED("name")    - scoped zone with a custom name, for a block of a function.
+// SLIC3R_PROFILE_FRAME()               - marks the end of a frame (one rendering of the 3D scene).
+// SLIC3R_PROFILE_LOCKABLE(type, name)  - declares a mutex "name" of "type", whose contention is tracked.
+// SLIC3R_PROFILE_LOCKABLE_TYPE(type)   - type of such a mutex, for references to it and for the locks.
+// SLIC3R_PROFILE_ALLOC(ptr, size)      - reports an allocation, called by the global operator new of Profiler.cpp.
+// SLIC3R_PROFILE_FREE(ptr)             - reports a deallocation, called by the global operator delete of Profiler.cpp.
+
+#ifdef SLIC3R_PROFILE_TRACY
+
+#include <tracy/Tracy.hpp>
+
+#define SLIC3R_PROFILE_ZONE()                   ZoneScoped
+#define SLIC3R_PROFILE_ZONE_NAMED(name)         ZoneScopedN(name)
+#define SLIC3R_PROFILE_FRAME()                  FrameMark
+#define SLIC3R_PROFILE_LOCKABLE(type, name)     TracyLockable(type, name)
+#define SLIC3R_PROFILE_LOCKABLE_TYPE(type)      LockableBase(type)
+#define SLIC3R_PROFILE_ALLOC(ptr, size)         TracyAlloc(ptr, size)
+#define SLIC3R_PROFILE_FREE(ptr)                TracyFree(ptr)
+
+#else // SLIC3R_PROFILE_TRACY
+
+#define SLIC3R_PROFILE_ZONE()                   ((void)0)
+#define SLIC3R_PROFILE_ZONE_NAMED(name)         ((void)0)
+#define SLIC3R_PROFILE_FRAME()                  ((void)0)
+#define SLIC3R_PROFILE_LOCKABLE(type, name)     type name
+#define SLIC3R_PROFILE_LOCKABLE_TYPE(type)      type
+#define SLIC3R_PROFILE_ALLOC(ptr, size)         ((void)0)
+#define SLIC3R_PROFILE_FREE(ptr)                ((void)0)
+
+#endif // SLIC3R_PROFILE_TRACY
+
+#endif // slic3r_ProfilerTracy_hpp_
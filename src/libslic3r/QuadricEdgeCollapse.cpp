@@ -6,6 +6,9 @@
 #include <tuple>
 #include <optional>
 #include "MutablePriorityQueue.hpp"
+#include <atomic>
+#include <mutex>
+#include <numeric>
 #include <tbb/parallel_for.h>
 
 using namespace Slic3r;
@@ -137,7 +140,15 @@ namespace QuadricEdgeCollapse {
     void change_neighbors(EdgeInfos &e_infos, VertexInfos &v_infos, uint32_t ti0, uint32_t ti1,
                           uint32_t vi0, uint32_t vi1, uint32_t vi_top0,
                           const Triangle &t1, CopyEdgeInfos& infos, EdgeInfos &e_infos1);
-    void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its);
+    // vertex_map: Optional output, new index of each vertex or -1 if the vertex was removed.
+    void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its,
+                 std::vector<int> *vertex_map = nullptr);
+    // Collapse edges until triangle_count or maximal_error is reached, never collapse an edge touching a locked vertex.
+    // Returns the error of the last collapsed edge.
+    float collapse_edges(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error, const std::vector<bool> &locked,
+                         ThrowOnCancel &throw_on_cancel, StatusFn &status_fn, std::vector<int> *vertex_map);
+    // Split triangles into spatially compact clusters of at most max_cluster_size triangles.
+    std::vector<std::vector<uint32_t>> create_clusters(const indexed_triangle_set &its, size_t max_cluster_size);
 
 #ifdef EXPENSIVE_DEBUG_CHECKS
     void store_surround(const char *obj_filename, size_t triangle_index, int depth, const indexed_triangle_set &its,
@@ -157,6 +168,11 @@ namespace QuadricEdgeCollapse {
     const int status_set_offsets = 10;
     const int status_calc_errors = 30;
     const int status_create_refs = 10;
+    // its_quadric_edge_collapse_parallel(): meshes with fewer triangles are not split into clusters
+    const size_t min_triangle_count_for_clusters = 500000;
+    const size_t max_cluster_size = 100000;
+    // part of the status for decimation of the clusters, the rest is for the final pass over the whole mesh
+    const int status_clusters_size = 80;
     } // namespace QuadricEdgeCollapse
 
 using namespace QuadricEdgeCollapse;
@@ -175,6 +191,138 @@ void Slic3r::its_quadric_edge_collapse(
     if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
     if (status_fn == nullptr) status_fn = [](int) {};
 
+    float last_collapsed_error = collapse_edges(its, triangle_count, maximal_error, {}, throw_on_cancel, status_fn, nullptr);
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+void Slic3r::its_quadric_edge_collapse_parallel(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count,
+    float *                   max_error,
+    std::function<void(void)> throw_on_cancel,
+    std::function<void(int)>  status_fn)
+{
+    if (its.indices.size() < min_triangle_count_for_clusters) {
+        its_quadric_edge_collapse(its, triangle_count, max_error, throw_on_cancel, status_fn);
+        return;
+    }
+    // check input
+    if (triangle_count >= its.indices.size()) return;
+    float maximal_error = (max_error == nullptr)? std::numeric_limits<float>::max() : *max_error;
+    if (maximal_error <= 0.f) return;
+    if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
+    if (status_fn == nullptr) status_fn = [](int) {};
+
+    std::vector<std::vector<uint32_t>> clusters = create_clusters(its, max_cluster_size);
+    // Vertices shared by triangles of more than one cluster are locked while decimating the clusters.
+    static constexpr const int shared_vertex = -2;
+    std::vector<int> vertex_cluster(its.vertices.size(), -1);
+    for (size_t cluster_idx = 0; cluster_idx < clusters.size(); ++ cluster_idx)
+        for (uint32_t ti : clusters[cluster_idx])
+            for (int vi : its.indices[ti]) {
+                int &vc = vertex_cluster[vi];
+                vc = vc == -1 || vc == int(cluster_idx) ? int(cluster_idx) : shared_vertex;
+            }
+
+    struct ClusterMesh {
+        indexed_triangle_set its;
+        // Index of the source vertex of each vertex of its before decimation.
+        std::vector<uint32_t> src_vertices;
+        std::vector<int>      vertex_map;
+        float                 last_collapsed_error = 0.f;
+    };
+    std::vector<ClusterMesh> cluster_meshes(clusters.size());
+    std::atomic<size_t>      num_clusters_done{ 0 };
+    std::mutex               status_mutex;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, clusters.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+        ThrowOnCancel cluster_throw_on_cancel = throw_on_cancel;
+        StatusFn      cluster_status_fn = [](int) {};
+        for (size_t cluster_idx = range.begin(); cluster_idx < range.end(); ++ cluster_idx) {
+            const std::vector<uint32_t> &cluster = clusters[cluster_idx];
+            ClusterMesh                 &mesh    = cluster_meshes[cluster_idx];
+            mesh.src_vertices.reserve(cluster.size() * 3);
+            for (uint32_t ti : cluster)
+                mesh.src_vertices.insert(mesh.src_vertices.end(), its.indices[ti].data(), its.indices[ti].data() + 3);
+            sort_remove_duplicates(mesh.src_vertices);
+            auto local_index = [&mesh](int vi) { return int(std::lower_bound(mesh.src_vertices.begin(), mesh.src_vertices.end(), uint32_t(vi)) - mesh.src_vertices.begin()); };
+            mesh.its.vertices.reserve(mesh.src_vertices.size());
+            std::vector<bool> locked(mesh.src_vertices.size(), false);
+            for (size_t i = 0; i < mesh.src_vertices.size(); ++ i) {
+                mesh.its.vertices.emplace_back(its.vertices[mesh.src_vertices[i]]);
+                locked[i] = vertex_cluster[mesh.src_vertices[i]] == shared_vertex;
+            }
+            // Triangles touching the locked vertices are mostly left for the final pass.
+            uint32_t num_locked_triangles = 0;
+            mesh.its.indices.reserve(cluster.size());
+            for (uint32_t ti : cluster) {
+                const Triangle &t = its.indices[ti];
+                mesh.its.indices.emplace_back(local_index(t[0]), local_index(t[1]), local_index(t[2]));
+                if (locked[mesh.its.indices.back()[0]] || locked[mesh.its.indices.back()[1]] || locked[mesh.its.indices.back()[2]])
+                    ++ num_locked_triangles;
+            }
+            uint32_t cluster_triangle_count = triangle_count == 0 ? 0 :
+                uint32_t(uint64_t(triangle_count) * cluster.size() / its.indices.size()) + num_locked_triangles;
+            if (cluster_triangle_count < mesh.its.indices.size())
+                mesh.last_collapsed_error = collapse_edges(mesh.its, cluster_triangle_count, maximal_error, locked,
+                    cluster_throw_on_cancel, cluster_status_fn, &mesh.vertex_map);
+            else {
+                mesh.vertex_map.resize(mesh.its.vertices.size());
+                std::iota(mesh.vertex_map.begin(), mesh.vertex_map.end(), 0);
+            }
+            size_t done = ++ num_clusters_done;
+            std::lock_guard<std::mutex> lock(status_mutex);
+            status_fn(int(done * status_clusters_size / clusters.size()));
+        }
+    });
+    clusters.clear();
+    clusters.shrink_to_fit();
+
+    // Merge the decimated clusters, the locked vertices are shared again.
+    indexed_triangle_set out;
+    float                last_collapsed_error = 0.f;
+    {
+        std::vector<int> shared_vertex_out(its.vertices.size(), -1);
+        for (ClusterMesh &mesh : cluster_meshes) {
+            std::vector<int> vertex_out(mesh.its.vertices.size(), -1);
+            for (size_t i = 0; i < mesh.vertex_map.size(); ++ i)
+                if (int vi = mesh.vertex_map[i]; vi >= 0) {
+                    uint32_t src_vi = mesh.src_vertices[i];
+                    if (vertex_cluster[src_vi] == shared_vertex) {
+                        int &vi_out = shared_vertex_out[src_vi];
+                        if (vi_out == -1) {
+                            vi_out = int(out.vertices.size());
+                            out.vertices.emplace_back(mesh.its.vertices[vi]);
+                        }
+                        vertex_out[vi] = vi_out;
+                    } else {
+                        vertex_out[vi] = int(out.vertices.size());
+                        out.vertices.emplace_back(mesh.its.vertices[vi]);
+                    }
+                }
+            for (const Triangle &t : mesh.its.indices)
+                out.indices.emplace_back(vertex_out[t[0]], vertex_out[t[1]], vertex_out[t[2]]);
+            last_collapsed_error = std::max(last_collapsed_error, mesh.last_collapsed_error);
+            mesh = ClusterMesh();
+        }
+    }
+    its = std::move(out);
+    throw_on_cancel();
+
+    // Final pass over the whole mesh decimates the borders of the clusters.
+    if (triangle_count < its.indices.size()) {
+        StatusFn final_status_fn = [&status_fn](int percent) {
+            status_fn(status_clusters_size + percent * (100 - status_clusters_size) / 100);
+        };
+        last_collapsed_error = std::max(last_collapsed_error,
+            collapse_edges(its, triangle_count, maximal_error, {}, throw_on_cancel, final_status_fn, nullptr));
+    }
+    status_fn(100);
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+float QuadricEdgeCollapse::collapse_edges(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error, const std::vector<bool> &locked,
+                                          ThrowOnCancel &throw_on_cancel, StatusFn &status_fn, std::vector<int> *vertex_map)
+{
     StatusFn init_status_fn = [&](int percent) {
         float n_percent = percent * status_init_size / 100.f;
         status_fn(static_cast<int>(std::round(n_percent)));
@@ -260,6 +408,7 @@ void Slic3r::its_quadric_edge_collapse(
             reorder_edges(e_infos, v_info1, ti0, ti1);
         }
         if (!ti1_opt.has_value() || // edge has only one triangle
+            (! locked.empty() && (locked[vi0] || locked[vi1])) ||
             degenerate(vi0, ti0, ti1, v_info1, e_infos, its.indices) ||
             degenerate(vi1, ti0, ti1, v_info0, e_infos, its.indices) ||
             create_no_volume(vi0, vi1, ti0, ti1, v_info0, v_info1, e_infos, its.indices) ||
@@ -346,8 +495,44 @@ void Slic3r::its_quadric_edge_collapse(
     }
 
     // compact triangle
-    compact(v_infos, t_infos, e_infos, its);
-    if (max_error != nullptr) *max_error = last_collapsed_error;
+    compact(v_infos, t_infos, e_infos, its, vertex_map);
+    return last_collapsed_error;
+}
+
+std::vector<std::vector<uint32_t>> QuadricEdgeCollapse::create_clusters(const indexed_triangle_set &its, size_t max_cluster_size)
+{
+    std::vector<Vec3f> centroids(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t ti = range.begin(); ti < range.end(); ++ ti) {
+            const Triangle &t = its.indices[ti];
+            centroids[ti] = (its.vertices[t[0]] + its.vertices[t[1]] + its.vertices[t[2]]) / 3.f;
+        }
+    });
+    std::vector<uint32_t> triangles(its.indices.size());
+    std::iota(triangles.begin(), triangles.end(), 0);
+
+    // Recursive bisection at the median of the centroids along the longest axis of the bounding box.
+    std::vector<std::vector<uint32_t>> clusters;
+    auto split = [&centroids, &clusters, max_cluster_size](auto &self, std::vector<uint32_t>::iterator begin, std::vector<uint32_t>::iterator end) -> void {
+        if (size_t(end - begin) <= max_cluster_size) {
+            clusters.emplace_back(begin, end);
+            return;
+        }
+        Vec3f min = centroids[*begin];
+        Vec3f max = min;
+        for (auto it = begin; it != end; ++ it) {
+            min = min.cwiseMin(centroids[*it]);
+            max = max.cwiseMax(centroids[*it]);
+        }
+        int axis;
+        (max - min).maxCoeff(&axis);
+        auto mid = begin + (end - begin) / 2;
+        std::nth_element(begin, mid, end, [&centroids, axis](uint32_t ti1, uint32_t ti2) { return centroids[ti1][axis] < centroids[ti2][axis]; });
+        self(self, begin, mid);
+        self(self, mid, end);
+    };
+    split(split, triangles.begin(), triangles.end());
+    return clusters;
 }
 
 Vec3d QuadricEdgeCollapse::create_normal(const Triangle &triangle,
@@ -840,12 +1025,17 @@ void QuadricEdgeCollapse::change_neighbors(EdgeInfos &     e_infos,
 void QuadricEdgeCollapse::compact(const VertexInfos &   v_infos,
                                   const TriangleInfos & t_infos,
                                   const EdgeInfos &     e_infos,
-                                  indexed_triangle_set &its)
+                                  indexed_triangle_set &its,
+                                  std::vector<int> *    vertex_map)
 {
+    if (vertex_map != nullptr)
+        vertex_map->assign(v_infos.size(), -1);
     uint32_t vi_new = 0;
     for (uint32_t vi = 0; vi < v_infos.size(); ++vi) {
         const VertexInfo &v_info = v_infos[vi];
         if (v_info.is_deleted()) continue; // deleted
+        if (vertex_map != nullptr)
+            (*vertex_map)[vi] = int(vi_new);
         uint32_t e_info_end = v_info.start + v_info.count;
         for (uint32_t ei = v_info.start; ei < e_info_end; ++ei) { 
             const EdgeInfo &e_info = e_infos[ei];
@@ -34,6 +34,20 @@ void its_quadric_edge_collapse(
     std::function<void(void)> throw_on_cancel = nullptr,
     std::function<void(int)>  statusfn        = nullptr);
 
+/// <summary>
+/// Simplify mesh by Quadric metric as its_quadric_edge_collapse(), faster for large meshes:
+/// Spatial clusters of triangles are simplified in parallel with the vertices shared between clusters locked,
+/// then the whole mesh is simplified to the wanted triangle count, reducing mainly the borders of the clusters.
+/// Small meshes are simplified by its_quadric_edge_collapse().
+/// throw_on_cancel is called from multiple threads.
+/// </summary>
+void its_quadric_edge_collapse_parallel(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count  = 0,
+    float *                   max_error       = nullptr,
+    std::function<void(void)> throw_on_cancel = nullptr,
+    std::function<void(int)>  statusfn        = nullptr);
+
 } // namespace Slic3r
 #endif // slic3r_quadric_edge_collapse_hpp_
 
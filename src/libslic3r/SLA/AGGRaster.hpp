@@ -20,6 +20,10 @@
 #include <agg/agg_rasterizer_scanline_aa.h>
 #include <agg/agg_path_storage.h>
 
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
 namespace Slic3r {
 
 inline const Polygon& contour(const ExPolygon& p) { return p.contour; }
@@ -35,33 +39,15 @@ template<class Color> struct Colors {
 template<class Color> const Color Colors<Color>::White = Color{255};
 template<class Color> const Color Colors<Color>::Black = Color{0};
 
-template<class PixelRenderer,
-         template<class /*agg::renderer_base<PixelRenderer>*/> class Renderer,
-         class Rasterizer = agg::rasterizer_scanline_aa<>,
-         class Scanline   = agg::scanline_p8>
-class AGGRaster: public RasterBase {
-public:
-    using TColor = typename PixelRenderer::color_type;
-    using TValue = typename TColor::value_type;
-    using TPixel = typename PixelRenderer::pixel_type;
-    using TRawBuffer = agg::rendering_buffer;
-
+// Conversion of the scaled polygons into AGG paths in the pixel coordinates
+// of a raster, applying the raster transformation (orientation, mirroring).
+class AGGRasterPaths: public RasterBase {
 protected:
     
     Resolution m_resolution;
     PixelDim m_pxdim_scaled;    // used for scaled coordinate polygons
     
-    std::vector<TPixel> m_buf;
-    agg::rendering_buffer m_rbuf;
-    
-    PixelRenderer m_pixrenderer;
-    
-    agg::renderer_base<PixelRenderer> m_raw_renderer;
-    Renderer<agg::renderer_base<PixelRenderer>> m_renderer;
-    
     Trafo m_trafo;
-    Scanline m_scanlines;
-    Rasterizer m_rasterizer;
     
     void flipy(agg::path_storage &path) const
     {
@@ -114,12 +100,134 @@ protected:
         return path;
     }
     
+    template<class Rasterizer, class P>
+    void add_paths(Rasterizer &rasterizer, const P &poly)
+    {
+        rasterizer.add_path(to_path(contour(poly)));
+        for(auto& h : holes(poly)) rasterizer.add_path(to_path(h));
+    }
+    
+    // Shifts in whole pixels by which translating the drawn polygons from
+    // offsets.front() to each of the offsets moves their pixels. Empty if
+    // any of the translations does not move the pixels by whole pixels.
+    std::vector<Vec2i> pixel_shifts(const std::vector<Point> &offsets) const
+    {
+        std::vector<Vec2i> shifts;
+        shifts.reserve(offsets.size());
+        for (const Point &offset : offsets) {
+            double dx = double(offset.x() - offsets.front().x()) * m_pxdim_scaled.w_mm;
+            double dy = double(offset.y() - offsets.front().y()) * m_pxdim_scaled.h_mm;
+            if (m_trafo.flipXY) std::swap(dx, dy);
+            if (m_trafo.mirror_x) dx = -dx;
+            if (m_trafo.mirror_y) dy = -dy;
+
+            // Well below the subpixel precision of the AGG rasterizer.
+            const double rx = std::round(dx), ry = std::round(dy);
+            if (std::abs(dx - rx) > 1e-3 || std::abs(dy - ry) > 1e-3)
+                return {};
+
+            shifts.emplace_back(int(rx), int(ry));
+        }
+        return shifts;
+    }
+
+    // Draw the copies of the polygons by drawfn(poly) at the first offset
+    // only, if the other copies are shifted by whole pixels. stampfn(box, shift)
+    // then copies the pixels within the box drawn by the rasterizer to each of
+    // the other copies.
+    template<class Rasterizer, class DrawFn, class StampFn>
+    void draw_stamped(const Rasterizer         &rasterizer,
+                      const ExPolygons         &polys,
+                      const std::vector<Point> &offsets,
+                      DrawFn                  &&drawfn,
+                      StampFn                 &&stampfn)
+    {
+        if (offsets.empty())
+            return;
+
+        std::vector<Vec2i> shifts = pixel_shifts(offsets);
+        if (shifts.empty()) {
+            RasterBase::draw_copies(polys, offsets);
+            return;
+        }
+
+        agg::rect_i box(std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+                        std::numeric_limits<int>::min(), std::numeric_limits<int>::min());
+        for (ExPolygon poly : polys) {
+            poly.translate(offsets.front());
+            drawfn(poly);
+            box.x1 = std::min(box.x1, rasterizer.min_x());
+            box.y1 = std::min(box.y1, rasterizer.min_y());
+            box.x2 = std::max(box.x2, rasterizer.max_x());
+            box.y2 = std::max(box.y2, rasterizer.max_y());
+        }
+
+        if (box.x1 > box.x2 || box.y1 > box.y2)
+            return;
+
+        if (box.x1 < 0 || box.y1 < 0 || box.x2 >= int(m_resolution.width_px) ||
+            box.y2 >= int(m_resolution.height_px)) {
+            // The first copy was clipped by the raster, its pixels can not be stamped.
+            RasterBase::draw_copies(polys, std::vector<Point>(offsets.begin() + 1, offsets.end()));
+            return;
+        }
+
+        for (size_t i = 1; i < shifts.size(); ++ i)
+            stampfn(box, shifts[i]);
+    }
+
+    AGGRasterPaths(const Resolution &res, const PixelDim &pd, const Trafo &trafo)
+        : m_resolution(res)
+        , m_pxdim_scaled(SCALING_FACTOR, SCALING_FACTOR)
+        , m_trafo(trafo)
+    {
+        // Visual Studio compiler gives warnings about possible division by zero.
+        assert(pd.w_mm != 0 && pd.h_mm != 0);
+        if (pd.w_mm != 0 && pd.h_mm != 0) {
+            m_pxdim_scaled.w_mm /= pd.w_mm;
+            m_pxdim_scaled.h_mm /= pd.h_mm;
+        }
+    }
+    
+public:
+    Trafo trafo() const override { return m_trafo; }
+    Resolution resolution() const { return m_resolution; }
+    PixelDim   pixel_dimensions() const
+    {
+        return {SCALING_FACTOR / m_pxdim_scaled.w_mm,
+                SCALING_FACTOR / m_pxdim_scaled.h_mm};
+    }
+};
+
+template<class PixelRenderer,
+         template<class /*agg::renderer_base<PixelRenderer>*/> class Renderer,
+         class Rasterizer = agg::rasterizer_scanline_aa<>,
+         class Scanline   = agg::scanline_p8>
+class AGGRaster: public AGGRasterPaths {
+public:
+    using TColor = typename PixelRenderer::color_type;
+    using TValue = typename TColor::value_type;
+    using TPixel = typename PixelRenderer::pixel_type;
+    using TRawBuffer = agg::rendering_buffer;
+
+protected:
+    
+    std::vector<TPixel> m_buf;
+    agg::rendering_buffer m_rbuf;
+    
+    PixelRenderer m_pixrenderer;
+    
+    agg::renderer_base<PixelRenderer> m_raw_renderer;
+    Renderer<agg::renderer_base<PixelRenderer>> m_renderer;
+    
+    Scanline m_scanlines;
+    Rasterizer m_rasterizer;
+    
     template<class P> void _draw(const P &poly)
     {
         m_rasterizer.reset();
         
-        m_rasterizer.add_path(to_path(contour(poly)));
-        for(auto& h : holes(poly)) m_rasterizer.add_path(to_path(h));
+        add_paths(m_rasterizer, poly);
         
         agg::render_scanlines(m_rasterizer, m_scanlines, m_renderer);
     }
@@ -132,8 +240,7 @@ public:
               const TColor &    foreground,
               const TColor &    background,
               GammaFn &&        gammafn)
-        : m_resolution(res)
-        , m_pxdim_scaled(SCALING_FACTOR, SCALING_FACTOR)
+        : AGGRasterPaths(res, pd, trafo)
         , m_buf(res.pixels())
         , m_rbuf(reinterpret_cast<TValue *>(m_buf.data()),
                  unsigned(res.width_px),
@@ -142,30 +249,24 @@ public:
         , m_pixrenderer(m_rbuf)
         , m_raw_renderer(m_pixrenderer)
         , m_renderer(m_raw_renderer)
-        , m_trafo(trafo)
     {
-        // Visual Studio compiler gives warnings about possible division by zero.
-        assert(pd.w_mm != 0 && pd.h_mm != 0);
-        if (pd.w_mm != 0 && pd.h_mm != 0) {
-            m_pxdim_scaled.w_mm /= pd.w_mm;
-            m_pxdim_scaled.h_mm /= pd.h_mm;
-        }
         m_renderer.color(foreground);
         clear(background);
         
         m_rasterizer.gamma(gammafn);
     }
     
-    Trafo trafo() const override { return m_trafo; }
-    Resolution resolution() const { return m_resolution; }
-    PixelDim   pixel_dimensions() const
+    void draw(const ExPolygon &poly) override { _draw(poly); }
+
+    void draw_copies(const ExPolygons &polys, const std::vector<Point> &offsets) override
     {
-        return {SCALING_FACTOR / m_pxdim_scaled.w_mm,
-                SCALING_FACTOR / m_pxdim_scaled.h_mm};
+        draw_stamped(m_rasterizer, polys, offsets,
+                     [this](const ExPolygon &poly) { _draw(poly); },
+                     [this](const agg::rect_i &box, const Vec2i &shift) {
+                         m_raw_renderer.copy_from(m_rbuf, &box, shift.x(), shift.y());
+                     });
     }
     
-    void draw(const ExPolygon &poly) override { _draw(poly); }
-    
     EncodedRaster encode(RasterEncoder encoder) const override
     {
         return encoder(m_buf.data(), m_resolution.width_px, m_resolution.height_px, 1);    
@@ -224,6 +325,210 @@ public:
     {}
 };
 
+/*
+ * Anti-aliased monochrome canvas storing the rasterized polygons as runs of
+ * equal pixel values per row instead of a full resolution pixel buffer.
+ * The pixel values are blended exactly as by RasterGrayscaleAA. Run length
+ * based encoders consume the runs directly by encode_runs(), encode()
+ * expands the runs into a pixel buffer for the other encoders.
+ */
+class RasterGrayscaleAARuns : public AGGRasterPaths {
+public:
+    struct Run {
+        uint32_t x;
+        uint32_t len;
+        uint8_t  value;
+        uint32_t x_end() const { return x + len; }
+    };
+    // Sorted, non overlapping runs of a row, background pixels are not stored.
+    using Row = std::vector<Run>;
+
+private:
+    std::vector<Row>                 m_rows;
+    agg::scanline_p8                 m_scanlines;
+    agg::rasterizer_scanline_aa<>    m_rasterizer;
+
+    static uint8_t blend(uint8_t px, agg::cover_type cover)
+    {
+        // Blending of the white foreground as by agg::pixfmt_gray8.
+        return cover == agg::cover_mask ? uint8_t(255) :
+                                          agg::gray8::lerp(px, 255, agg::gray8::mult_cover(255, cover));
+    }
+
+    static void push_run(Row &row, uint32_t x, uint32_t len, uint8_t value)
+    {
+        if (value == 0 || len == 0)
+            return;
+        if (! row.empty() && row.back().x_end() == x && row.back().value == value)
+            row.back().len += len;
+        else
+            row.push_back({x, len, value});
+    }
+
+    // Blend a span of pixels with either per pixel covers or a single cover into a row.
+    void blend_span(Row &row, uint32_t x, uint32_t len, const agg::cover_type *covers, agg::cover_type cover)
+    {
+        if (row.empty() || row.back().x_end() <= x) {
+            // Fast path: the span is right of all the pixels drawn into the row so far.
+            if (covers == nullptr)
+                push_run(row, x, len, blend(0, cover));
+            else
+                for (uint32_t i = 0; i < len; ++ i)
+                    push_run(row, x + i, 1, blend(0, covers[i]));
+            return;
+        }
+
+        const uint32_t x_end = x + len;
+        auto it = std::lower_bound(row.begin(), row.end(), x, [](const Run &run, uint32_t x) { return run.x_end() <= x; });
+        Row merged;
+        merged.reserve(row.size() + len);
+        merged.insert(merged.end(), row.begin(), it);
+        if (it != row.end() && it->x < x)
+            push_run(merged, it->x, x - it->x, it->value);
+        for (uint32_t px = x; px < x_end; ++ px) {
+            while (it != row.end() && it->x_end() <= px)
+                ++ it;
+            uint8_t old = it != row.end() && it->x <= px ? it->value : 0;
+            push_run(merged, px, 1, blend(old, covers == nullptr ? cover : covers[px - x]));
+        }
+        while (it != row.end() && it->x_end() <= x_end)
+            ++ it;
+        if (it != row.end() && it->x < x_end) {
+            push_run(merged, x_end, it->x_end() - x_end, it->value);
+            ++ it;
+        }
+        for (; it != row.end(); ++ it)
+            push_run(merged, it->x, it->len, it->value);
+        row = std::move(merged);
+    }
+
+    // Copy the runs of the rows within the box shifted by the shift, clipping
+    // them to the raster. The target pixels have to be background.
+    void stamp_runs(const agg::rect_i &box, const Vec2i &shift)
+    {
+        const int w = int(m_resolution.width_px);
+        Row runs;
+        for (int y = box.y1; y <= box.y2; ++ y) {
+            const int ty = y + shift.y();
+            if (ty < 0 || ty >= int(m_resolution.height_px))
+                continue;
+
+            runs.clear();
+            for (const Run &run : m_rows[y]) {
+                int x     = std::max(int(run.x), box.x1) + shift.x();
+                int x_end = std::min(int(run.x_end()), box.x2 + 1) + shift.x();
+                x         = std::max(x, 0);
+                x_end     = std::min(x_end, w);
+                if (x < x_end)
+                    runs.push_back({uint32_t(x), uint32_t(x_end - x), run.value});
+            }
+            if (runs.empty())
+                continue;
+
+            Row &row = m_rows[ty];
+            auto it = std::lower_bound(row.begin(), row.end(), runs.front().x,
+                                       [](const Run &run, uint32_t x) { return run.x_end() <= x; });
+            assert(it == row.end() || it->x >= runs.back().x_end());
+            row.insert(it, runs.begin(), runs.end());
+        }
+    }
+
+    // Renderer of the rasterizer scanlines into the rows, clipping the spans to the raster.
+    struct RunRenderer {
+        RasterGrayscaleAARuns &self;
+
+        void prepare() {}
+
+        template<class Scanline> void render(const Scanline &sl)
+        {
+            const int y = sl.y();
+            if (y < 0 || y >= int(self.m_resolution.height_px))
+                return;
+            const int w        = int(self.m_resolution.width_px);
+            Row      &row      = self.m_rows[y];
+            unsigned  num_spans = sl.num_spans();
+            for (auto span = sl.begin();; ++ span) {
+                int                    x      = span->x;
+                int                    len    = span->len > 0 ? span->len : - span->len;
+                const agg::cover_type *covers = span->len > 0 ? span->covers : nullptr;
+                if (x < 0) {
+                    if (covers != nullptr)
+                        covers -= x;
+                    len += x;
+                    x = 0;
+                }
+                if (x + len > w)
+                    len = w - x;
+                if (len > 0)
+                    self.blend_span(row, uint32_t(x), uint32_t(len), covers, *span->covers);
+                if (-- num_spans == 0)
+                    break;
+            }
+        }
+    };
+
+public:
+    template<class GammaFn>
+    RasterGrayscaleAARuns(const Resolution        &res,
+                          const PixelDim          &pd,
+                          const RasterBase::Trafo &trafo,
+                          GammaFn                &&fn)
+        : AGGRasterPaths(res, pd, trafo)
+        , m_rows(res.height_px)
+    {
+        m_rasterizer.gamma(std::forward<GammaFn>(fn));
+    }
+
+    void draw(const ExPolygon &poly) override
+    {
+        m_rasterizer.reset();
+        add_paths(m_rasterizer, poly);
+        RunRenderer renderer{*this};
+        agg::render_scanlines(m_rasterizer, m_scanlines, renderer);
+    }
+
+    void draw_copies(const ExPolygons &polys, const std::vector<Point> &offsets) override
+    {
+        draw_stamped(m_rasterizer, polys, offsets,
+                     [this](const ExPolygon &poly) { draw(poly); },
+                     [this](const agg::rect_i &box, const Vec2i &shift) { stamp_runs(box, shift); });
+    }
+
+    const Row& row(size_t y) const { return m_rows[y]; }
+
+    EncodedRaster encode(RasterEncoder encoder) const override
+    {
+        std::vector<uint8_t> buf(m_resolution.pixels(), 0);
+        for (size_t y = 0; y < m_rows.size(); ++ y)
+            for (const Run &run : m_rows[y])
+                std::fill_n(buf.begin() + y * m_resolution.width_px + run.x, run.len, run.value);
+        return encoder(buf.data(), m_resolution.width_px, m_resolution.height_px, 1);
+    }
+
+    EncodedRaster encode_runs(RunEncoder encoder) const override
+    {
+        struct Runs : RasterRuns {
+            const RasterGrayscaleAARuns &rst;
+            explicit Runs(const RasterGrayscaleAARuns &rst) : rst(rst) {}
+            void for_each_run(const std::function<void(uint8_t value, size_t len)> &fn) const override
+            {
+                for (const Row &row : rst.m_rows) {
+                    uint32_t x = 0;
+                    for (const Run &run : row) {
+                        if (run.x > x)
+                            fn(0, run.x - x);
+                        fn(run.value, run.len);
+                        x = run.x_end();
+                    }
+                    if (x < rst.m_resolution.width_px)
+                        fn(0, rst.m_resolution.width_px - x);
+                }
+            }
+        };
+        return encoder(Runs{*this}, m_resolution.width_px, m_resolution.height_px);
+    }
+};
+
 }} // namespace Slic3r::sla
 
 #endif // AGGRASTER_HPP
@@ -151,6 +151,8 @@ public:
     std::optional<Vec3f> suggest_avoidance(const branchingtree::Node &from,
                                            float max_bridge_len) const override;
 
+    std::vector<bool> check_branches(const std::vector<Branch> &branches) override;
+
     void report_unroutable(const branchingtree::Node &j) override
     {
         double glvl = ground_level(m_sm);
@@ -227,6 +229,39 @@ bool BranchingTreeBuilder::add_merger(const branchingtree::Node &node,
     return ret;
 }
 
+std::vector<bool> BranchingTreeBuilder::check_branches(const std::vector<Branch> &branches)
+{
+    // The beams of all the branches, a merger consists of two beams.
+    std::vector<Beam> beams;
+    beams.reserve(2 * branches.size());
+    for (const Branch &br : branches) {
+        const branchingtree::Node &to = br.merge ? *br.merge : br.to;
+        Ball toball{to.pos.cast<double>(), get_radius(to)};
+
+        beams.emplace_back(Ball{br.from.pos.cast<double>(), get_radius(br.from)}, toball);
+        if (br.merge)
+            beams.emplace_back(Ball{br.to.pos.cast<double>(), get_radius(br.to)}, toball);
+    }
+
+    auto hits = beams_mesh_hit(beam_ex_policy, m_sm.emesh, beams,
+                               m_sm.cfg.safety_distance_mm);
+
+    std::vector<bool> ret(branches.size());
+    auto hit = hits.begin();
+    for (size_t i = 0; i < branches.size(); ++i) {
+        const Branch &br = branches[i];
+        const branchingtree::Node &to = br.merge ? *br.merge : br.to;
+
+        bool ok = (hit++)->distance() > (to.pos.cast<double>() - br.from.pos.cast<double>()).norm();
+        if (br.merge)
+            ok = (hit++)->distance() > (to.pos.cast<double>() - br.to.pos.cast<double>()).norm() && ok;
+
+        ret[i] = ok;
+    }
+
+    return ret;
+}
+
 bool BranchingTreeBuilder::add_ground_bridge(const branchingtree::Node &from,
                                              const branchingtree::Node &to)
 {
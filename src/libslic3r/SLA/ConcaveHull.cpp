@@ -7,6 +7,7 @@
 
 #include <libslic3r/MTUtils.hpp>
 #include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
 
 #include <boost/log/trivial.hpp>
 
@@ -70,31 +71,30 @@ void ConcaveHull::add_connector_rectangles(const Points &centroids,
     unsigned  idx = 0;
     for(const Point &ct : centroids) ctrindex.insert(to_vec3(ct), idx++);
 
+    // Distances of the centroids to their nearest neighbors, the index
+    // queries are independent and run in parallel.
+    std::vector<double> nearest_dist(centroids.size(), double(max_dist));
+    execution::for_each(ex_tbb, size_t(0), centroids.size(),
+                        [&centroids, &ctrindex, &nearest_dist, &thr](size_t i) {
+        thr();
+        const Point &ct = centroids[i];
+        for (const PointIndexEl &el : ctrindex.nearest(to_vec3(ct), 2))
+            if (el.second != i) {
+                nearest_dist[i] = Line(to_vec2(el.first), ct).length();
+                break;
+            }
+    }, 64);
+
     m_polys.reserve(m_polys.size() + centroids.size());
 
-    idx = 0;
-    for (const Point &c : centroids) {
-        thr();
+    for (size_t i = 0; i < centroids.size(); ++i) {
+        if (nearest_dist[i] >= max_dist) return;
 
+        const Point &c = centroids[i];
         double dx = c.x() - cc.x(), dy = c.y() - cc.y();
         double l  = std::sqrt(dx * dx + dy * dy);
         double nx = dx / l, ny = dy / l;
 
-        const Point &ct = centroids[idx];
-
-        std::vector<PointIndexEl> result = ctrindex.nearest(to_vec3(ct), 2);
-
-        double dist = max_dist;
-        for (const PointIndexEl &el : result)
-            if (el.second != idx) {
-                dist = Line(to_vec2(el.first), ct).length();
-                break;
-            }
-
-        idx++;
-
-        if (dist >= max_dist) return;
-
         Polygon r;
         r.points.reserve(3);
         r.points.emplace_back(cc);
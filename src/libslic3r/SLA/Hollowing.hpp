@@ -130,16 +130,16 @@ template<class Cont> double csgmesh_positive_maxvolume(const Cont &csg)
     return mesh_vol;
 }
 
+// Voxelize the CSG parts into the distance grid, which generate_interior()
+// derives the interior from. The grid only depends on the parts and the voxel
+// scale, so it can be kept while the other hollowing parameters change.
 template<class It>
-InteriorPtr generate_interior(const Range<It>       &csgparts,
-                              const HollowingConfig &hc  = {},
-                              const JobController   &ctl = {})
+VoxelGridPtr generate_interior_grid(const Range<It>     &csgparts,
+                                    double               voxel_scale,
+                                    const JobController &ctl = {})
 {
-    double mesh_vol = csgmesh_positive_maxvolume(csgparts);
-    double voxsc    = get_voxel_scale(mesh_vol, hc);
-
     auto params = csg::VoxelizeParams{}
-                      .voxel_scale(voxsc)
+                      .voxel_scale(voxel_scale)
                       .exterior_bandwidth(3.f)
                       .interior_bandwidth(3.f)
                       .statusfn([&ctl](int){ return ctl.stopcondition && ctl.stopcondition(); });
@@ -152,7 +152,18 @@ InteriorPtr generate_interior(const Range<It>       &csgparts,
     // TODO: figure out issues without the redistance
 //    if (csgparts.size() > 1 || its_is_splittable(*csg::get_mesh(*csgparts.begin())))
 
-    ptr = redistance_grid(*ptr, 0.0f, 3.f, 3.f);
+    return redistance_grid(*ptr, 0.0f, 3.f, 3.f);
+}
+
+template<class It>
+InteriorPtr generate_interior(const Range<It>       &csgparts,
+                              const HollowingConfig &hc  = {},
+                              const JobController   &ctl = {})
+{
+    double mesh_vol = csgmesh_positive_maxvolume(csgparts);
+    double voxsc    = get_voxel_scale(mesh_vol, hc);
+
+    auto ptr = generate_interior_grid(csgparts, voxsc, ctl);
 
     return ptr ? generate_interior(*ptr, hc, ctl) : InteriorPtr{};
 }
@@ -0,0 +1,409 @@
+///|/ Copyright (c) Prusa Research 2020 - 2022 Tomáš Mészáros @tamasmeszaros
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <libslic3r/SLA/RasterBase.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <queue>
+
+// for crc32
+#include <miniz.h>
+
+namespace Slic3r { namespace sla {
+
+namespace {
+
+// Index of the first byte in [begin, end) different from value. The bytes
+// are compared 8 at a time, the SLA layers consist of long uniform runs.
+const uint8_t* find_run_end(const uint8_t *begin, const uint8_t *end, uint8_t value)
+{
+    const uint64_t pattern = 0x0101010101010101ull * value;
+    for (; end - begin >= 8; begin += 8) {
+        uint64_t word;
+        memcpy(&word, begin, 8);
+        if (word != pattern)
+            break;
+    }
+    while (begin != end && *begin == value)
+        ++ begin;
+    return begin;
+}
+
+// Adler-32 checksum of the zlib stream updated by whole runs of equal bytes.
+class Adler32 {
+    static constexpr uint64_t Base = 65521;
+    uint64_t m_s1 = 1, m_s2 = 0;
+
+public:
+    void add(uint8_t value) { add(value, 1); }
+
+    void add(uint8_t value, uint64_t count)
+    {
+        // s2 accumulates s1 after each of the bytes: s1 + value, s1 + 2 value, ...
+        m_s2 = (m_s2 + (count % Base) * m_s1 + value * (count * (count + 1) / 2 % Base)) % Base;
+        m_s1 = (m_s1 + value * (count % Base)) % Base;
+    }
+
+    uint32_t value() const { return uint32_t((m_s2 << 16) | m_s1); }
+};
+
+// Bits written into a byte vector, least significant bit first as required by deflate.
+class BitWriter {
+    std::vector<uint8_t> &m_out;
+    uint64_t              m_bits  = 0;
+    unsigned              m_nbits = 0;
+
+public:
+    explicit BitWriter(std::vector<uint8_t> &out) : m_out(out) {}
+
+    void put(uint32_t bits, unsigned nbits)
+    {
+        assert(nbits <= 32);
+        m_bits |= uint64_t(bits) << m_nbits;
+        m_nbits += nbits;
+        while (m_nbits >= 8) {
+            m_out.emplace_back(uint8_t(m_bits));
+            m_bits >>= 8;
+            m_nbits -= 8;
+        }
+    }
+
+    void flush()
+    {
+        if (m_nbits > 0)
+            m_out.emplace_back(uint8_t(m_bits));
+        m_bits  = 0;
+        m_nbits = 0;
+    }
+};
+
+// Huffman code of a deflate alphabet.
+struct HuffmanCode {
+    std::vector<uint8_t>  lengths;
+    std::vector<uint16_t> codes; // bit reversed for BitWriter
+
+    // Build the code lengths limited to max_length bits. Symbols with zero
+    // frequency get no code. At least two symbols get a code, so that the code
+    // is always complete as required by the decoders.
+    void build(std::vector<uint32_t> freqs, unsigned max_length)
+    {
+        const size_t n = freqs.size();
+        if (std::count_if(freqs.begin(), freqs.end(), [](uint32_t f) { return f > 0; }) < 2) {
+            for (size_t i = 0; i < 2; ++ i)
+                if (freqs[i] == 0)
+                    freqs[i] = 1;
+        }
+        lengths.assign(n, 0);
+        for (;;) {
+            // Nodes 0..n-1 are the leaves, the rest are the inner nodes.
+            std::vector<int> parent(2 * n, -1);
+            using Node = std::pair<uint64_t, int>;
+            std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+            for (size_t i = 0; i < n; ++ i)
+                if (freqs[i] > 0)
+                    queue.emplace(freqs[i], int(i));
+            int next = int(n);
+            while (queue.size() > 1) {
+                Node a = queue.top(); queue.pop();
+                Node b = queue.top(); queue.pop();
+                parent[a.second] = parent[b.second] = next;
+                queue.emplace(a.first + b.first, next ++);
+            }
+            unsigned max_len = 0;
+            for (size_t i = 0; i < n; ++ i) {
+                unsigned len = 0;
+                if (freqs[i] > 0)
+                    for (int p = parent[i]; p != -1; p = parent[p])
+                        ++ len;
+                lengths[i] = uint8_t(len);
+                max_len    = std::max(max_len, len);
+            }
+            if (max_len <= max_length)
+                break;
+            // Flatten the distribution until the code fits into the length limit.
+            for (uint32_t &f : freqs)
+                if (f > 0)
+                    f = (f + 1) / 2;
+        }
+
+        // Canonical codes, see RFC 1951, 3.2.2.
+        std::array<uint16_t, 16> bl_count {};
+        for (uint8_t len : lengths)
+            ++ bl_count[len];
+        bl_count[0] = 0;
+        std::array<uint16_t, 16> next_code {};
+        for (unsigned bits = 1, code = 0; bits < 16; ++ bits) {
+            code = (code + bl_count[bits - 1]) << 1;
+            next_code[bits] = uint16_t(code);
+        }
+        codes.assign(n, 0);
+        for (size_t i = 0; i < n; ++ i)
+            if (unsigned len = lengths[i]; len > 0) {
+                uint16_t code = next_code[len] ++, rev = 0;
+                for (unsigned b = 0; b < len; ++ b)
+                    rev |= ((code >> b) & 1) << (len - 1 - b);
+                codes[i] = rev;
+            }
+    }
+
+    void write(BitWriter &bw, size_t symbol) const { bw.put(codes[symbol], lengths[symbol]); }
+};
+
+// Deflate compressor producing only literals and matches of distance one,
+// thus run length encoding the data. It is much faster than a general
+// deflate on the filtered scanlines of the SLA layers, which consist of long
+// runs of black, white and of zeros of the rows filtered by Up, while the
+// compression is about the same.
+class RunDeflater {
+    static constexpr size_t   MaxTokens    = 1 << 16;
+    static constexpr unsigned MinMatch     = 3;
+    static constexpr unsigned MaxMatch     = 258;
+    static constexpr size_t   NumLitCodes  = 286;
+    static constexpr size_t   NumDistCodes = 2;
+    static constexpr size_t   EndOfBlock   = 256;
+
+    struct LengthCode { uint16_t symbol; uint8_t extra_bits; uint16_t extra; };
+    // Deflate length symbols with their extra bits indexed by match length.
+    static const std::array<LengthCode, MaxMatch + 1>& length_codes()
+    {
+        static const std::array<LengthCode, MaxMatch + 1> table = []() {
+            static const uint16_t base[]  = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                              35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+            static const uint8_t  extra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                              3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+            std::array<LengthCode, MaxMatch + 1> out {};
+            for (unsigned code = 0; code < 29; ++ code) {
+                unsigned end = code == 28 ? 259 : base[code + 1];
+                for (unsigned len = base[code]; len < end; ++ len)
+                    out[len] = { uint16_t(257 + code), extra[code], uint16_t(len - base[code]) };
+            }
+            return out;
+        }();
+        return table;
+    }
+
+    BitWriter             m_bw;
+    // Literals are stored as they are, matches as MaxMatch + 1 + length.
+    std::vector<uint16_t> m_tokens;
+    int                   m_last    = -1;
+    size_t                m_repeats = 0;
+    Adler32               m_adler;
+
+    void emit_literal(uint8_t c)
+    {
+        m_tokens.emplace_back(c);
+        if (m_tokens.size() >= MaxTokens)
+            write_block(false);
+    }
+
+    // Emit the repetitions of the last byte as matches of distance one.
+    void flush_repeats()
+    {
+        while (m_repeats >= MinMatch) {
+            size_t len = std::min<size_t>(m_repeats, MaxMatch);
+            // Don't leave less than a minimal match for the next one.
+            if (m_repeats > MaxMatch && m_repeats - MaxMatch < MinMatch)
+                len = m_repeats - MinMatch;
+            m_tokens.emplace_back(uint16_t(MaxMatch + 1 + len));
+            m_repeats -= len;
+            if (m_tokens.size() >= MaxTokens)
+                write_block(false);
+        }
+        for (; m_repeats > 0; -- m_repeats)
+            emit_literal(uint8_t(m_last));
+    }
+
+    void write_block(bool final)
+    {
+        const auto &lcodes = length_codes();
+
+        std::vector<uint32_t> lit_freqs(NumLitCodes, 0), dist_freqs(NumDistCodes, 0);
+        for (uint16_t t : m_tokens)
+            if (t <= MaxMatch)
+                ++ lit_freqs[t];
+            else {
+                ++ lit_freqs[lcodes[t - MaxMatch - 1].symbol];
+                ++ dist_freqs[0];
+            }
+        lit_freqs[EndOfBlock] = 1;
+
+        HuffmanCode lit, dist;
+        lit.build(lit_freqs, 15);
+        dist.build(dist_freqs, 15);
+
+        size_t num_lit = NumLitCodes;
+        while (num_lit > 257 && lit.lengths[num_lit - 1] == 0)
+            -- num_lit;
+
+        // Code lengths of both alphabets, zero runs compressed by the symbols 17 and 18.
+        std::vector<uint8_t> all_lengths(lit.lengths.begin(), lit.lengths.begin() + num_lit);
+        all_lengths.insert(all_lengths.end(), dist.lengths.begin(), dist.lengths.end());
+        std::vector<std::pair<uint8_t, uint8_t>> cl_symbols; // symbol, extra bits value
+        std::vector<uint32_t> cl_freqs(19, 0);
+        for (size_t i = 0; i < all_lengths.size();) {
+            size_t run = 1;
+            while (i + run < all_lengths.size() && all_lengths[i + run] == all_lengths[i])
+                ++ run;
+            if (all_lengths[i] == 0 && run >= 3) {
+                run = std::min<size_t>(run, 138);
+                if (run <= 10)
+                    cl_symbols.emplace_back(17, uint8_t(run - 3));
+                else
+                    cl_symbols.emplace_back(18, uint8_t(run - 11));
+            } else {
+                run = 1;
+                cl_symbols.emplace_back(all_lengths[i], 0);
+            }
+            ++ cl_freqs[cl_symbols.back().first];
+            i += run;
+        }
+        HuffmanCode cl;
+        cl.build(cl_freqs, 7);
+        static const uint8_t cl_order[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+        size_t num_cl = 19;
+        while (num_cl > 4 && cl.lengths[cl_order[num_cl - 1]] == 0)
+            -- num_cl;
+
+        // Block header with the dynamic Huffman codes, see RFC 1951, 3.2.7.
+        m_bw.put(final ? 1 : 0, 1);
+        m_bw.put(2, 2);
+        m_bw.put(uint32_t(num_lit - 257), 5);
+        m_bw.put(uint32_t(NumDistCodes - 1), 5);
+        m_bw.put(uint32_t(num_cl - 4), 4);
+        for (size_t i = 0; i < num_cl; ++ i)
+            m_bw.put(cl.lengths[cl_order[i]], 3);
+        for (const auto &[symbol, extra] : cl_symbols) {
+            cl.write(m_bw, symbol);
+            if (symbol == 17)
+                m_bw.put(extra, 3);
+            else if (symbol == 18)
+                m_bw.put(extra, 7);
+        }
+
+        for (uint16_t t : m_tokens)
+            if (t <= MaxMatch)
+                lit.write(m_bw, t);
+            else {
+                const LengthCode &lc = lcodes[t - MaxMatch - 1];
+                lit.write(m_bw, lc.symbol);
+                if (lc.extra_bits > 0)
+                    m_bw.put(lc.extra, lc.extra_bits);
+                dist.write(m_bw, 0);
+            }
+        lit.write(m_bw, EndOfBlock);
+        m_tokens.clear();
+    }
+
+public:
+    explicit RunDeflater(std::vector<uint8_t> &out) : m_bw(out)
+    {
+        m_tokens.reserve(MaxTokens + 1);
+        // zlib header: deflate with 32K window, fastest compression
+        m_bw.put(0x78, 8);
+        m_bw.put(0x01, 8);
+    }
+
+    void compress(const uint8_t *data, size_t len)
+    {
+        const uint8_t *end = data + len;
+        while (data != end) {
+            if (int(*data) != m_last) {
+                flush_repeats();
+                m_last = *data;
+                m_adler.add(*data);
+                emit_literal(*data ++);
+            }
+            const uint8_t *run_end = find_run_end(data, end, uint8_t(m_last));
+            m_adler.add(uint8_t(m_last), uint64_t(run_end - data));
+            m_repeats += size_t(run_end - data);
+            data = run_end;
+        }
+    }
+
+    void finish()
+    {
+        flush_repeats();
+        write_block(true);
+        m_bw.flush();
+        const uint32_t adler = m_adler.value();
+        for (int shift = 24; shift >= 0; shift -= 8)
+            m_bw.put((adler >> shift) & 0xFF, 8);
+    }
+};
+
+void append_be32(std::vector<uint8_t> &buf, uint32_t v)
+{
+    buf.insert(buf.end(), { uint8_t(v >> 24), uint8_t(v >> 16), uint8_t(v >> 8), uint8_t(v) });
+}
+
+// Start a PNG chunk, its length is filled in by end_chunk().
+size_t begin_chunk(std::vector<uint8_t> &buf, const char *type)
+{
+    size_t chunk_begin = buf.size();
+    append_be32(buf, 0);
+    buf.insert(buf.end(), type, type + 4);
+    return chunk_begin;
+}
+
+void end_chunk(std::vector<uint8_t> &buf, size_t chunk_begin)
+{
+    const uint32_t len = uint32_t(buf.size() - chunk_begin - 8);
+    for (size_t i = 0; i < 4; ++ i)
+        buf[chunk_begin + i] = uint8_t(len >> (24 - 8 * i));
+    append_be32(buf, uint32_t(mz_crc32(MZ_CRC32_INIT, buf.data() + chunk_begin + 4, buf.size() - chunk_begin - 4)));
+}
+
+} // namespace
+
+// PNG encoder specialized for the SLA layers, which are mostly black with
+// large uniform areas. The runs of equal bytes are compressed by RunDeflater.
+// Scanlines repeating the previous one are filtered by Up into zeros, the
+// other scanlines are not filtered: Sub and Up produce more runs than the
+// plain pixels for the shapes of the SLA layers.
+EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
+                                           size_t      num_components)
+{
+    static const uint8_t color_types[] = { 0, 0, 4, 2, 6 };
+    if (num_components < 1 || num_components > 4 || w == 0 || h == 0)
+        return EncodedRaster({}, "png");
+
+    const size_t   bpl = w * num_components;
+    const uint8_t *img = static_cast<const uint8_t *>(ptr);
+
+    std::vector<uint8_t> buf;
+    buf.reserve(1024 + bpl * h / 64);
+
+    const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    buf.insert(buf.end(), std::begin(signature), std::end(signature));
+
+    size_t chunk = begin_chunk(buf, "IHDR");
+    append_be32(buf, uint32_t(w));
+    append_be32(buf, uint32_t(h));
+    // bit depth, color type, compression, filter and interlace methods
+    buf.insert(buf.end(), { 8, color_types[num_components], 0, 0, 0 });
+    end_chunk(buf, chunk);
+
+    chunk = begin_chunk(buf, "IDAT");
+    {
+        RunDeflater          deflater(buf);
+        const std::vector<uint8_t> zeros(bpl, 0);
+        const uint8_t             *prev = nullptr;
+        for (size_t y = 0; y < h; ++ y, prev = img, img += bpl) {
+            const bool repeated = prev != nullptr && memcmp(img, prev, bpl) == 0;
+            const uint8_t filter = repeated ? 2 /* Up */ : 0 /* None */;
+            deflater.compress(&filter, 1);
+            deflater.compress(repeated ? zeros.data() : img, bpl);
+        }
+        deflater.finish();
+    }
+    end_chunk(buf, chunk);
+
+    end_chunk(buf, begin_chunk(buf, "IEND"));
+
+    return EncodedRaster(std::move(buf), "png");
+}
+
+}} // namespace Slic3r::sla
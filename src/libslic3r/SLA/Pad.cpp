@@ -16,6 +16,9 @@
 #include "MTUtils.hpp"
 
 #include "TriangulateWall.hpp"
+#include "Execution/ExecutionTBB.hpp"
+
+#include <numeric>
 
 // For debugging:
 // #include <fstream>
@@ -147,6 +150,27 @@ static inline double get_merge_distance(const PadConfig &c)
     return 2. * (1.8 * c.wall_thickness_mm) + c.max_merge_dist_mm;
 }
 
+// Concave hull of the contours, reused from the cache if it was calculated
+// for the same contours and merge distance.
+static std::shared_ptr<const ConcaveHull> concave_hull(Polygons     &&contours,
+                                                       double         merge_dist,
+                                                       ThrowOnCancel  thr,
+                                                       PadCache      *cache)
+{
+    if (cache && cache->hull && cache->hull_merge_distance == merge_dist &&
+        cache->hull_contours == contours)
+        return cache->hull;
+
+    auto hull = std::make_shared<const ConcaveHull>(contours, merge_dist, thr);
+    if (cache) {
+        cache->hull_contours       = std::move(contours);
+        cache->hull_merge_distance = merge_dist;
+        cache->hull                = hull;
+    }
+
+    return hull;
+}
+
 // Part of the pad configuration that is used for 3D geometry generation
 struct PadConfig3D {
     double thickness, height, wing_height, slope;
@@ -244,7 +268,8 @@ public:
     _AroundPadSkeleton(const ExPolygons &support_blueprint,
                        const ExPolygons &model_blueprint,
                        const PadConfig & cfg,
-                       ThrowOnCancel     thr)
+                       ThrowOnCancel     thr,
+                       PadCache         *cache)
     {
         // We need to merge the support and the model contours in a special
         // way in which the model contours have to be substracted from the
@@ -261,7 +286,7 @@ public:
                       ClipperLib::jtMiter, 1);
 
         ExPolygons fullcvh =
-            wafflized_concave_hull(support_blueprint, model_bp_offs, cfg, thr);
+            wafflized_concave_hull(support_blueprint, model_bp_offs, cfg, thr, cache);
 
         auto model_bp_sticks =
             breakstick_holes(model_bp_offs, cfg.embed_object.object_gap_mm,
@@ -293,15 +318,16 @@ private:
     ExPolygons wafflized_concave_hull(const ExPolygons &supp_bp,
                                        const ExPolygons &model_bp,
                                        const PadConfig  &cfg,
-                                       ThrowOnCancel     thr)
+                                       ThrowOnCancel     thr,
+                                       PadCache         *cache)
     {
-        auto allin = reserve_vector<ExPolygon>(supp_bp.size() + model_bp.size());
+        auto allin = reserve_polygons(supp_bp.size() + model_bp.size());
 
         for (auto &ep : supp_bp) allin.emplace_back(ep.contour);
         for (auto &ep : model_bp) allin.emplace_back(ep.contour);
 
-        ConcaveHull cchull{allin, get_merge_distance(cfg), thr};
-        return offset_waffle_style_ex(cchull, get_waffle_offset(cfg));
+        auto cchull = concave_hull(std::move(allin), get_merge_distance(cfg), thr, cache);
+        return offset_waffle_style_ex(*cchull, get_waffle_offset(cfg));
     }
 
     // To remove parts of the pad skeleton which do not host any supports
@@ -325,16 +351,17 @@ public:
     BelowPadSkeleton(const ExPolygons &support_blueprint,
                      const ExPolygons &model_blueprint,
                      const PadConfig & cfg,
-                     ThrowOnCancel     thr)
+                     ThrowOnCancel     thr,
+                     PadCache         *cache)
     {
-        outer.reserve(support_blueprint.size() + model_blueprint.size());
+        auto contours = reserve_polygons(support_blueprint.size() + model_blueprint.size());
 
-        for (auto &ep : support_blueprint) outer.emplace_back(ep.contour);
-        for (auto &ep : model_blueprint) outer.emplace_back(ep.contour);
+        for (auto &ep : support_blueprint) contours.emplace_back(ep.contour);
+        for (auto &ep : model_blueprint) contours.emplace_back(ep.contour);
 
-        ConcaveHull ochull{outer, get_merge_distance(cfg), thr};
+        auto ochull = concave_hull(std::move(contours), get_merge_distance(cfg), thr, cache);
 
-        outer = offset_waffle_style_ex(ochull, get_waffle_offset(cfg));
+        outer = offset_waffle_style_ex(*ochull, get_waffle_offset(cfg));
     }
 };
 
@@ -385,18 +412,32 @@ bool add_cavity(indexed_triangle_set &pad,
     return true;
 }
 
+// The parts of the pad are extruded in parallel and merged in their order.
+template<class Fn>
+indexed_triangle_set merge_pad_parts(const ExPolygons &skeleton, Fn &&fn)
+{
+    std::vector<indexed_triangle_set> parts(skeleton.size());
+    execution::for_each(ex_tbb, size_t(0), skeleton.size(),
+                        [&skeleton, &parts, &fn](size_t i) { parts[i] = fn(skeleton[i]); }, 1);
+
+    indexed_triangle_set ret;
+    for (indexed_triangle_set &part : parts)
+        its_merge(ret, std::move(part));
+
+    return ret;
+}
+
 indexed_triangle_set create_outer_pad_geometry(const ExPolygons & skeleton,
                                                const PadConfig3D &cfg,
                                                ThrowOnCancel      thr)
 {
-    indexed_triangle_set ret;
-
-    for (const ExPolygon &pad_part : skeleton) {
+    return merge_pad_parts(skeleton, [&cfg, &thr](const ExPolygon &pad_part) {
+        indexed_triangle_set ret;
         ExPolygon top_poly{pad_part};
         ExPolygon bottom_poly =
             offset_contour_only(pad_part, -scaled(cfg.bottom_offset()));
 
-        if (bottom_poly.empty()) continue;
+        if (bottom_poly.empty()) return ret;
         thr();
         
         double z_min = -cfg.height, z_max = 0;
@@ -410,19 +451,18 @@ indexed_triangle_set create_outer_pad_geometry(const ExPolygons & skeleton,
         
         its_merge(ret, triangulate_expolygon_3d(bottom_poly, z_min, NORMALS_DOWN));
         its_merge(ret, triangulate_expolygon_3d(top_poly, NORMALS_UP));
-    }
 
-    return ret;
+        return ret;
+    });
 }
 
 indexed_triangle_set create_inner_pad_geometry(const ExPolygons & skeleton,
                                                const PadConfig3D &cfg,
                                                ThrowOnCancel      thr)
 {
-    indexed_triangle_set ret;
-
     double z_max = 0., z_min = -cfg.height;
-    for (const ExPolygon &pad_part : skeleton) {
+    return merge_pad_parts(skeleton, [z_max, z_min, &thr](const ExPolygon &pad_part) {
+        indexed_triangle_set ret;
         thr();
         its_merge(ret, straight_walls(pad_part.contour, z_max, z_min));
 
@@ -431,9 +471,9 @@ indexed_triangle_set create_inner_pad_geometry(const ExPolygons & skeleton,
     
         its_merge(ret, triangulate_expolygon_3d(pad_part, z_min, NORMALS_DOWN));
         its_merge(ret, triangulate_expolygon_3d(pad_part, z_max, NORMALS_UP));
-    }
 
-    return ret;
+        return ret;
+    });
 }
 
 indexed_triangle_set create_pad_geometry(const PadSkeleton &skelet,
@@ -457,17 +497,18 @@ indexed_triangle_set create_pad_geometry(const PadSkeleton &skelet,
 indexed_triangle_set create_pad_geometry(const ExPolygons &supp_bp,
                                          const ExPolygons &model_bp,
                                          const PadConfig & cfg,
-                                         ThrowOnCancel     thr)
+                                         ThrowOnCancel     thr,
+                                         PadCache         *cache)
 {
     PadSkeleton skelet;
 
     if (cfg.embed_object.enabled) {
         if (cfg.embed_object.everywhere)
-            skelet = BrimPadSkeleton(supp_bp, model_bp, cfg, thr);
+            skelet = BrimPadSkeleton(supp_bp, model_bp, cfg, thr, cache);
         else
-            skelet = AroundPadSkeleton(supp_bp, model_bp, cfg, thr);
+            skelet = AroundPadSkeleton(supp_bp, model_bp, cfg, thr, cache);
     } else
-        skelet = BelowPadSkeleton(supp_bp, model_bp, cfg, thr);
+        skelet = BelowPadSkeleton(supp_bp, model_bp, cfg, thr, cache);
 
     return create_pad_geometry(skelet, cfg, thr);
 }
@@ -478,21 +519,65 @@ void pad_blueprint(const indexed_triangle_set &mesh,
                    ExPolygons &                output,
                    const std::vector<float> &  heights,
                    ThrowOnCancel               thrfn)
+{
+    PadBlueprintSlices cache;
+    pad_blueprint(mesh, output, heights, cache, thrfn);
+}
+
+void pad_blueprint(const indexed_triangle_set &mesh,
+                   ExPolygons &                output,
+                   const std::vector<float> &  heights,
+                   PadBlueprintSlices &        cache,
+                   ThrowOnCancel               thrfn)
 {
     if (mesh.empty()) return;
 
-    std::vector<ExPolygons> out = slice_mesh_ex(mesh, heights, thrfn);
+    assert(std::is_sorted(cache.heights.begin(), cache.heights.end()));
+    std::vector<float> missing;
+    for (float h : heights)
+        if (! std::binary_search(cache.heights.begin(), cache.heights.end(), h))
+            missing.emplace_back(h);
+
+    if (! missing.empty()) {
+        std::vector<ExPolygons> out = slice_mesh_ex(mesh, missing, thrfn);
+
+        // Unification is expensive, a simplify also speeds up the pad generation
+        execution::for_each(ex_tbb, size_t(0), out.size(), [&out](size_t i) {
+            ExPolygons simplified;
+            for (ExPolygon &e : out[i])
+                append(simplified, e.simplify(scaled<double>(0.1)));
+            out[i] = std::move(simplified);
+        });
+
+        // Insert the new slices into the cache, keeping it sorted by the heights.
+        append(cache.heights, std::move(missing));
+        append(cache.slices, std::move(out));
+        std::vector<size_t> order(cache.heights.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [&cache](size_t a, size_t b) { return cache.heights[a] < cache.heights[b]; });
+        PadBlueprintSlices sorted;
+        sorted.heights.reserve(order.size());
+        sorted.slices.reserve(order.size());
+        for (size_t i : order) {
+            sorted.heights.emplace_back(cache.heights[i]);
+            sorted.slices.emplace_back(std::move(cache.slices[i]));
+        }
+        cache = std::move(sorted);
+    }
 
+    std::vector<const ExPolygons*> out;
+    out.reserve(heights.size());
     size_t count = 0;
-    for(auto& o : out) count += o.size();
+    for (float h : heights) {
+        auto it = std::lower_bound(cache.heights.begin(), cache.heights.end(), h);
+        assert(it != cache.heights.end() && *it == h);
+        out.emplace_back(&cache.slices[it - cache.heights.begin()]);
+        count += out.back()->size();
+    }
 
-    // Unification is expensive, a simplify also speeds up the pad generation
     auto tmp = reserve_vector<ExPolygon>(count);
-    for(ExPolygons& o : out)
-        for(ExPolygon& e : o) {
-            auto&& exss = e.simplify(scaled<double>(0.1));
-            for(ExPolygon& ep : exss) tmp.emplace_back(std::move(ep));
-        }
+    for (const ExPolygons *o : out)
+        append(tmp, *o);
 
     ExPolygons utmp = union_ex(tmp);
 
@@ -518,9 +603,10 @@ void create_pad(const ExPolygons &    sup_blueprint,
                 const ExPolygons &    model_blueprint,
                 indexed_triangle_set &out,
                 const PadConfig &     cfg,
-                ThrowOnCancel         thr)
+                ThrowOnCancel         thr,
+                PadCache *            cache)
 {
-    auto t = create_pad_geometry(sup_blueprint, model_blueprint, cfg, thr);
+    auto t = create_pad_geometry(sup_blueprint, model_blueprint, cfg, thr, cache);
     its_merge(out, t);
 }
 
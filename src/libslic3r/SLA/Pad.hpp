@@ -8,23 +8,44 @@
 #include <vector>
 #include <functional>
 #include <cmath>
+#include <memory>
 #include <string>
 
 #include <libslic3r/Point.hpp>
+#include <libslic3r/ExPolygon.hpp>
 
 struct indexed_triangle_set;
 
 namespace Slic3r {
 
-class ExPolygon;
-class Polygon;
-using ExPolygons = std::vector<ExPolygon>;
-using Polygons = std::vector<Polygon, PointsAllocator<Polygon>>;
-
 namespace sla {
 
 using ThrowOnCancel = std::function<void(void)>;
 
+class ConcaveHull;
+
+// Simplified slices of a mesh sampled by pad_blueprint(), sorted by their
+// heights. If kept for the next pad_blueprint() call on the same mesh, only
+// the heights not sampled yet are sliced, e.g. if just the pad wall height
+// has changed.
+struct PadBlueprintSlices {
+    std::vector<float>      heights;
+    std::vector<ExPolygons> slices;
+};
+
+// Intermediate results of the pad generation, which are reused when the pad
+// is generated again for the same model and supports with a different
+// configuration. To be cleared when the model or the supports change.
+struct PadCache {
+    PadBlueprintSlices model_slices;
+    PadBlueprintSlices support_slices;
+
+    // The last concave hull of the pad and its input.
+    Polygons                           hull_contours;
+    double                             hull_merge_distance = 0.;
+    std::shared_ptr<const ConcaveHull> hull;
+};
+
 /// Calculate the polygon representing the silhouette.
 void pad_blueprint(
     const indexed_triangle_set &mesh,       // input mesh
@@ -39,6 +60,14 @@ void pad_blueprint(
     float         layerheight    = 0.05f, // The sampling height
     ThrowOnCancel thrfn          = [] {});
 
+// Same as above, the slices are looked up in and added to the cache.
+void pad_blueprint(
+    const indexed_triangle_set &mesh,
+    ExPolygons &                output,
+    const std::vector<float> &  heights,
+    PadBlueprintSlices &        cache,
+    ThrowOnCancel               thrfn = [] {});
+
 struct PadConfig {
     double wall_thickness_mm = 1.;
     double wall_height_mm = 1.;
@@ -93,7 +122,8 @@ void create_pad(
     const ExPolygons &    model_contours,
     indexed_triangle_set &output_mesh,
     const PadConfig &             = PadConfig(),
-    ThrowOnCancel throw_on_cancel = [] {});
+    ThrowOnCancel throw_on_cancel = [] {},
+    PadCache *    cache           = nullptr);
 
 } // namespace sla
 } // namespace Slic3r
@@ -7,37 +7,13 @@
 #define SLARASTER_CPP
 
 #include <functional>
+#include <algorithm>
 
 #include <libslic3r/SLA/RasterBase.hpp>
 #include <libslic3r/SLA/AGGRaster.hpp>
 
-// minz image write:
-#include <miniz.h>
-
 namespace Slic3r { namespace sla {
 
-EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
-                                           size_t      num_components)
-{
-    std::vector<uint8_t> buf;
-    size_t s = 0;
-    
-    void *rawdata = tdefl_write_image_to_png_file_in_memory(
-        ptr, int(w), int(h), int(num_components), &s);
-    
-    // On error, data() will return an empty vector. No other info can be
-    // retrieved from miniz anyway...
-    if (rawdata == nullptr) return EncodedRaster({}, "png");
-    
-    auto pptr = static_cast<std::uint8_t*>(rawdata);
-    
-    buf.reserve(s);
-    std::copy(pptr, pptr + s, std::back_inserter(buf));
-    
-    MZ_FREE(rawdata);
-    return EncodedRaster(std::move(buf), "png");
-}
-
 std::ostream &operator<<(std::ostream &stream, const EncodedRaster &bytes)
 {
     stream.write(reinterpret_cast<const char *>(bytes.data()),
@@ -67,6 +43,33 @@ EncodedRaster PPMRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     return EncodedRaster(std::move(buf), "ppm");
 }
 
+void RasterBase::draw_copies(const ExPolygons &polys, const std::vector<Point> &offsets)
+{
+    for (const Point &offset : offsets)
+        for (ExPolygon poly : polys) {
+            poly.translate(offset);
+            draw(poly);
+        }
+}
+
+void PixelBufferRuns::for_each_run(const std::function<void(uint8_t value, size_t len)> &fn) const
+{
+    const uint8_t *ptr = m_data;
+    const uint8_t *end = m_data + m_size;
+    while (ptr < end) {
+        const uint8_t *run_end = std::find_if(ptr, end, [px = *ptr](uint8_t v) { return v != px; });
+        fn(*ptr, size_t(run_end - ptr));
+        ptr = run_end;
+    }
+}
+
+EncodedRaster RasterBase::encode_runs(RunEncoder encoder) const
+{
+    return encode([&encoder](const void *ptr, size_t w, size_t h, size_t num_components) {
+        return encoder(PixelBufferRuns{ptr, w * h * num_components}, w, h);
+    });
+}
+
 std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     const Resolution        &res,
     const PixelDim          &pxdim,
@@ -85,6 +88,22 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     return rst;
 }
 
+std::unique_ptr<RasterBase> create_raster_grayscale_aa_runs(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma,
+    const RasterBase::Trafo &tr)
+{
+    std::unique_ptr<RasterBase> rst;
+    
+    if (gamma > 0)
+        rst = std::make_unique<RasterGrayscaleAARuns>(res, pxdim, tr, agg::gamma_power(gamma));
+    else
+        rst = std::make_unique<RasterGrayscaleAARuns>(res, pxdim, tr, agg::gamma_threshold(.5));
+    
+    return rst;
+}
+
 } // namespace sla
 } // namespace Slic3r
 
@@ -8,6 +8,8 @@
 
 #include <ostream>
 #include <memory>
+#include <functional>
+#include <string>
 #include <vector>
 #include <array>
 #include <utility>
@@ -59,6 +61,28 @@ struct PixelDim {
 using RasterEncoder =
     std::function<EncodedRaster(const void *ptr, size_t w, size_t h, size_t num_components)>;
 
+// A grayscale raster seen as a sequence of runs of pixels with equal values,
+// covering the raster row by row. Adjacent runs may have the same value.
+class RasterRuns {
+public:
+    virtual ~RasterRuns() = default;
+    virtual void for_each_run(const std::function<void(uint8_t value, size_t len)> &fn) const = 0;
+};
+
+// Runs of a raw grayscale pixel buffer.
+class PixelBufferRuns : public RasterRuns {
+    const uint8_t *m_data;
+    size_t         m_size;
+public:
+    PixelBufferRuns(const void *ptr, size_t size) : m_data(static_cast<const uint8_t *>(ptr)), m_size(size) {}
+    void for_each_run(const std::function<void(uint8_t value, size_t len)> &fn) const override;
+};
+
+// Encoder of the run length based formats, consuming the runs of a raster
+// without the need for a full resolution pixel buffer.
+using RunEncoder =
+    std::function<EncodedRaster(const RasterRuns &runs, size_t w, size_t h)>;
+
 class RasterBase {
 public:
     
@@ -92,6 +116,12 @@ public:
     
     /// Draw a polygon with holes.
     virtual void draw(const ExPolygon& poly) = 0;
+
+    /// Draw copies of the polygons translated by each of the offsets. The
+    /// copies must not overlap each other nor anything drawn before, so that
+    /// a raster may render the polygons once and stamp the rendered pixels
+    /// to the other offsets.
+    virtual void draw_copies(const ExPolygons &polys, const std::vector<Point> &offsets);
     
     /// Get the resolution of the raster.
 //    virtual Resolution resolution() const = 0;
@@ -99,6 +129,9 @@ public:
     virtual Trafo      trafo() const = 0;
     
     virtual EncodedRaster encode(RasterEncoder encoder) const = 0;
+    
+    // The default implementation scans the pixel buffer passed to encode().
+    virtual EncodedRaster encode_runs(RunEncoder encoder) const;
 };
 
 struct PNGRasterEncoder {
@@ -118,6 +151,14 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     double                   gamma = 1.0,
     const RasterBase::Trafo &tr    = {});
 
+// Same as create_raster_grayscale_aa(), but the raster stores runs of equal
+// pixels per row instead of a pixel buffer. Suitable for run length encoders.
+std::unique_ptr<RasterBase> create_raster_grayscale_aa_runs(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma = 1.0,
+    const RasterBase::Trafo &tr    = {});
+
 }} // namespace Slic3r::sla
 
 #endif // SLARASTERBASE_HPP
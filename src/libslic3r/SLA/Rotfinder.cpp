@@ -9,7 +9,6 @@
 #include <libslic3r/Execution/ExecutionTBB.hpp>
 #include <libslic3r/Execution/ExecutionSeq.hpp>
 
-#include <libslic3r/Optimize/BruteforceOptimizer.hpp>
 #include <libslic3r/Optimize/NLoptOptimizer.hpp>
 
 #include "libslic3r/SLAPrint.hpp"
@@ -17,6 +16,8 @@
 
 #include <libslic3r/Geometry.hpp>
 
+#include <atomic>
+#include <numeric>
 #include <thread>
 
 namespace Slic3r { namespace sla {
@@ -26,21 +27,34 @@ namespace {
 inline const Vec3f DOWN = {0.f, 0.f, -1.f};
 constexpr double POINTS_PER_UNIT_AREA = 1.f;
 
+// Number of faces of the mesh the global search is performed on.
+constexpr size_t COARSE_FACE_COUNT = 20000;
+// Number of the best rotations of the global search refined on the full mesh.
+constexpr size_t REFINED_CANDIDATES = 4;
+// Maximum number of the score evaluations for refining one candidate.
+constexpr unsigned REFINE_ITERATIONS = 50;
+
 // Get the vertices of a triangle directly in an array of 3 points
+std::array<Vec3f, 3> get_triangle_vertices(const indexed_triangle_set &its,
+                                           size_t                      faceidx)
+{
+    const auto &face = its.indices[faceidx];
+    return {its.vertices[face(0)],
+            its.vertices[face(1)],
+            its.vertices[face(2)]};
+}
+
 std::array<Vec3f, 3> get_triangle_vertices(const TriangleMesh &mesh,
                                            size_t              faceidx)
 {
-    const auto &face = mesh.its.indices[faceidx];
-    return {mesh.its.vertices[face(0)],
-            mesh.its.vertices[face(1)],
-            mesh.its.vertices[face(2)]};
+    return get_triangle_vertices(mesh.its, faceidx);
 }
 
-std::array<Vec3f, 3> get_transformed_triangle(const TriangleMesh &mesh,
-                                              const Transform3f & tr,
-                                              size_t              faceidx)
+std::array<Vec3f, 3> get_transformed_triangle(const indexed_triangle_set &its,
+                                              const Transform3f &         tr,
+                                              size_t                      faceidx)
 {
-    const auto &tri = get_triangle_vertices(mesh, faceidx);
+    const auto &tri = get_triangle_vertices(its, faceidx);
     return {tr * tri[0], tr * tri[1], tr * tri[2]};
 }
 
@@ -51,15 +65,15 @@ template<class T> Vec<3, T> normal(const std::array<Vec<3, T>, 3> &tri)
     return U.cross(V).normalized();
 }
 
-template<class T, class AccessFn>
-T sum_score(AccessFn &&accessfn, size_t facecount, size_t Nthreads)
+template<class T, class EP, class AccessFn>
+T sum_score(const EP &ep, AccessFn &&accessfn, size_t facecount)
 {
     T  initv         = 0.;
     auto   mergefn   = [](T a, T b) { return a + b; };
-    size_t grainsize = facecount / Nthreads;
+    size_t grainsize = std::max(size_t(1), facecount / execution::max_concurrency(ep));
     size_t from = 0, to = facecount;
 
-    return execution::reduce(ex_tbb, from, to, initv, mergefn, accessfn, grainsize);
+    return execution::reduce(ep, from, to, initv, mergefn, accessfn, grainsize);
 }
 
 // Get area and normal of a triangle
@@ -78,12 +92,13 @@ struct Facestats {
 };
 
 // Try to guess the number of support points needed to support a mesh
-double get_misalginment_score(const TriangleMesh &mesh, const Transform3f &tr)
+template<class EP>
+double get_misalginment_score(const EP &ep, const indexed_triangle_set &its, const Transform3f &tr)
 {
-    if (mesh.its.vertices.empty()) return NaNd;
+    if (its.vertices.empty()) return NaNd;
 
-    auto accessfn = [&mesh, &tr](size_t fi) {
-        Facestats fc{get_transformed_triangle(mesh, tr, fi)};
+    auto accessfn = [&its, &tr](size_t fi) {
+        Facestats fc{get_transformed_triangle(its, tr, fi)};
 
         float score = fc.area
                       * (std::abs(fc.normal.dot(Vec3f::UnitX()))
@@ -94,9 +109,8 @@ double get_misalginment_score(const TriangleMesh &mesh, const Transform3f &tr)
         return scaled<int_fast64_t>(score);
     };
 
-    size_t facecount = mesh.its.indices.size();
-    size_t Nthreads  = std::thread::hardware_concurrency();
-    double S = unscaled(sum_score<int_fast64_t>(accessfn, facecount, Nthreads));
+    size_t facecount = its.indices.size();
+    double S = unscaled(sum_score<int_fast64_t>(ep, accessfn, facecount));
 
     return S / facecount;
 }
@@ -119,66 +133,79 @@ inline double get_supportedness_score(const Facestats &fc)
 }
 
 // Try to guess the number of support points needed to support a mesh
-double get_supportedness_score(const TriangleMesh &mesh, const Transform3f &tr)
+template<class EP>
+double get_supportedness_score(const EP &ep, const indexed_triangle_set &its, const Transform3f &tr)
 {
-    if (mesh.its.vertices.empty()) return NaNd;
+    if (its.vertices.empty()) return NaNd;
 
-    auto accessfn = [&mesh, &tr](size_t fi) {
-        Facestats fc{get_transformed_triangle(mesh, tr, fi)};
+    auto accessfn = [&its, &tr](size_t fi) {
+        Facestats fc{get_transformed_triangle(its, tr, fi)};
         return scaled<int_fast64_t>(get_supportedness_score(fc));
     };
 
-    size_t facecount = mesh.its.indices.size();
-    size_t Nthreads  = std::thread::hardware_concurrency();
-    double S = unscaled(sum_score<int_fast64_t>(accessfn, facecount, Nthreads));
+    size_t facecount = its.indices.size();
+    double S = unscaled(sum_score<int_fast64_t>(ep, accessfn, facecount));
 
     return S / facecount;
 }
 
-// Find transformed mesh ground level without copy and with parallel reduce.
-float find_ground_level(const TriangleMesh &mesh,
-                         const Transform3f & tr,
-                         size_t              threads)
+// Find transformed mesh ground level without copy. The lowest point of a mesh
+// is a vertex of its convex hull, thus the hull is passed in place of the mesh.
+float find_ground_level(const indexed_triangle_set &hull, const Transform3f &tr)
 {
-    size_t vsize = mesh.its.vertices.size();
-
-    auto minfn = [](float a, float b) { return std::min(a, b); };
-
-    auto accessfn = [&mesh, &tr] (size_t vi) {
-        return (tr * mesh.its.vertices[vi]).z();
-    };
-
     auto zmin = std::numeric_limits<float>::max();
-    size_t granularity = vsize / threads;
-    return execution::reduce(ex_tbb, size_t(0), vsize, zmin, minfn, accessfn, granularity);
+    for (const Vec3f &v : hull.vertices)
+        zmin = std::min(zmin, (tr * v).z());
+
+    return zmin;
 }
 
-double get_supportedness_onfloor_score(const TriangleMesh &mesh,
-                                       const Transform3f  &tr)
+template<class EP>
+double get_supportedness_onfloor_score(const EP                   &ep,
+                                       const indexed_triangle_set &its,
+                                       const indexed_triangle_set &hull,
+                                       const Transform3f          &tr)
 {
-    if (mesh.its.vertices.empty()) return NaNd;
+    if (its.vertices.empty()) return NaNd;
 
-    size_t Nthreads = std::thread::hardware_concurrency();
-
-    float zmin = find_ground_level(mesh, tr, Nthreads);
+    float zmin = find_ground_level(hull, tr);
     float zlvl = zmin + 0.1f; // Set up a slight tolerance from z level
 
-    auto accessfn = [&mesh, &tr, zlvl](size_t fi) {
-        std::array<Vec3f, 3> tri = get_transformed_triangle(mesh, tr, fi);
+    auto accessfn = [&its, &tr, zlvl](size_t fi) {
+        std::array<Vec3f, 3> tri = get_transformed_triangle(its, tr, fi);
         Facestats fc{tri};
 
         if (tri[0].z() <= zlvl && tri[1].z() <= zlvl && tri[2].z() <= zlvl)
-            return -2 * fc.area * POINTS_PER_UNIT_AREA;
+            return scaled<int_fast64_t>(-2 * fc.area * POINTS_PER_UNIT_AREA);
 
-        return get_supportedness_score(fc);
+        return scaled<int_fast64_t>(get_supportedness_score(fc));
     };
 
-    size_t facecount = mesh.its.indices.size();
-    double S = unscaled(sum_score<int_fast64_t>(accessfn, facecount, Nthreads));
+    size_t facecount = its.indices.size();
+    double S = unscaled(sum_score<int_fast64_t>(ep, accessfn, facecount));
 
     return S / facecount;
 }
 
+// Pick evenly spread faces of the mesh for the coarse global search. All the
+// scores are averages over the faces, thus a regular subset of the faces
+// estimates them well enough to tell the promising rotations from the bad ones.
+indexed_triangle_set subsample_faces(const indexed_triangle_set &its, size_t max_faces)
+{
+    if (its.indices.size() <= max_faces)
+        return its;
+
+    indexed_triangle_set out;
+    out.vertices = its.vertices;
+    out.indices.reserve(max_faces);
+    double step = double(its.indices.size()) / double(max_faces);
+    for (size_t i = 0; i < max_faces; ++i)
+        out.indices.emplace_back(its.indices[size_t(i * step)]);
+    its_compactify_vertices(out);
+
+    return out;
+}
+
 using XYRotation = std::array<double, 2>;
 
 // prepare the rotation transformation
@@ -197,6 +224,32 @@ XYRotation from_transform3f(const Transform3f &tr)
     return {rot3.x(), rot3.y()};
 }
 
+// Rotations of the global search: the directions of a Fibonacci sphere, each
+// turned downwards. Two rotations around X and Y turn a direction downwards,
+// differing in the resulting rotation around Z. If the score does not depend on
+// the rotation around Z, one of them is sufficient.
+std::vector<XYRotation> sample_sphere_rotations(size_t count, bool both_twists)
+{
+    auto ret = reserve_vector<XYRotation>(both_twists ? 2 * count : count);
+
+    const double golden_angle = PI * (3. - std::sqrt(5.));
+    for (size_t i = 0; i < count; ++i) {
+        double z   = 1. - 2. * (double(i) + 0.5) / double(count);
+        double r   = std::sqrt(std::max(0., 1. - z * z));
+        double phi = golden_angle * double(i);
+        Vec3d  dir = {r * std::cos(phi), r * std::sin(phi), z};
+
+        // Rotate dir around X into the XZ plane, then around Y to point down.
+        double ryz = std::hypot(dir.y(), dir.z());
+        double rx  = std::atan2(dir.y(), dir.z());
+        ret.push_back({rx, std::atan2(dir.x(), -ryz)});
+        if (both_twists)
+            ret.push_back({rx > 0. ? rx - PI : rx + PI, std::atan2(dir.x(), ryz)});
+    }
+
+    return ret;
+}
+
 inline bool is_on_floor(const SLAPrintObjectConfig &cfg)
 {
     auto opt_elevation = cfg.support_object_elevation.getFloat();
@@ -206,9 +259,8 @@ inline bool is_on_floor(const SLAPrintObjectConfig &cfg)
 }
 
 // collect the rotations for each face of the convex hull
-std::vector<XYRotation> get_chull_rotations(const TriangleMesh &mesh, size_t max_count)
+std::vector<XYRotation> get_chull_rotations(TriangleMesh &chull, size_t max_count)
 {
-    TriangleMesh chull = mesh.convex_hull_3d();
     double chull2d_area = chull.convex_hull().area();
     double area_threshold = chull2d_area / (scaled<double>(1e3) * scaled(1.));
 
@@ -292,7 +344,7 @@ template<unsigned MAX_ITER>
 struct RotfinderBoilerplate {
     static constexpr unsigned MAX_TRIES = MAX_ITER;
 
-    int status = 0, prev_status = 0;
+    std::atomic<int> status = 0, prev_status = 0;
     TriangleMesh mesh;
     unsigned max_tries;
     const RotOptimizeParams &params;
@@ -317,45 +369,109 @@ struct RotfinderBoilerplate {
         , params{p}
     {}
 
+    // May be called from multiple threads.
     void statusfn() {
-        int s = status * 100 / max_tries;
-        if (s != prev_status) {
+        int s    = status++ * 100 / int(std::max(max_tries, 1u));
+        int prev = prev_status;
+        while (s > prev && ! prev_status.compare_exchange_weak(prev, s)) ;
+        if (s > prev)
             params.statuscb()(s);
-            prev_status = s;
-        }
-
-        ++status;
     }
 
     bool stopcond() { return ! params.statuscb()(-1); }
 };
 
+// Coarse to fine search for the rotation with the minimum score, the score
+// function is called as scorefn(execution_policy, its, transformation).
+// All the inputs are scored in parallel on a subsampled mesh first, then the
+// few best of them are scored on the full mesh. If refine_radius is not zero,
+// these are refined by a local optimizer within refine_radius around them.
+template<class Boilerplate, class ScoreFn>
+XYRotation find_min_score_coarse_to_fine(Boilerplate                   &bp,
+                                         ScoreFn                      &&scorefn,
+                                         const std::vector<XYRotation> &inputs,
+                                         double                         refine_radius)
+{
+    if (inputs.empty() || bp.mesh.its.indices.empty())
+        return {0., 0.};
+
+    indexed_triangle_set coarse = subsample_faces(bp.mesh.its, COARSE_FACE_COUNT);
+
+    // The candidates are scored in parallel, each of them sequentially.
+    std::vector<double> scores(inputs.size(), std::numeric_limits<double>::max());
+    execution::for_each(ex_tbb, size_t(0), inputs.size(),
+        [&bp, &scorefn, &inputs, &coarse, &scores](size_t i) {
+            if (bp.stopcond()) return;
+
+            bp.statusfn();
+            scores[i] = scorefn(ex_seq, coarse, to_transform3f(inputs[i]));
+        });
+
+    std::vector<size_t> candidates(inputs.size());
+    std::iota(candidates.begin(), candidates.end(), size_t(0));
+    size_t num_candidates = std::min(REFINED_CANDIDATES, inputs.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + num_candidates, candidates.end(),
+        [&scores](size_t a, size_t b) { return scores[a] < scores[b]; });
+    candidates.resize(num_candidates);
+
+    if (bp.stopcond())
+        return inputs[candidates.front()];
+
+    // The few candidates are evaluated on the full mesh, each evaluation is parallel.
+    std::vector<opt::Result<2>> results(num_candidates);
+    execution::for_each(ex_tbb, size_t(0), num_candidates,
+        [&bp, &scorefn, &inputs, &candidates, &results, refine_radius](size_t i) {
+            const XYRotation &rot = inputs[candidates[i]];
+            auto fullfn = [&bp, &scorefn](const XYRotation &r) {
+                bp.statusfn();
+                return scorefn(ex_tbb, bp.mesh.its, to_transform3f(r));
+            };
+
+            if (refine_radius > 0.) {
+                opt::Optimizer<opt::AlgNLoptSubplex> solver(
+                    opt::StopCriteria{}.max_iterations(REFINE_ITERATIONS)
+                                       .rel_score_diff(1e-4)
+                                       .stop_condition([&bp] { return bp.stopcond(); }));
+                auto bounds = opt::bounds({ {rot[0] - refine_radius, rot[0] + refine_radius},
+                                            {rot[1] - refine_radius, rot[1] + refine_radius} });
+                results[i] = solver.to_min().optimize(fullfn, rot, bounds);
+            } else {
+                results[i].optimum = rot;
+                results[i].score   = fullfn(rot);
+            }
+        }, 1);
+
+    auto it = std::min_element(results.begin(), results.end(),
+        [](const opt::Result<2> &a, const opt::Result<2> &b) { return a.score < b.score; });
+
+    return it->optimum;
+}
+
+// Mean distance of the samples of a Fibonacci sphere with count points.
+inline double sphere_sample_distance(size_t count)
+{
+    return std::sqrt(4. * PI / double(std::max(count, size_t(1))));
+}
+
 Vec2d find_best_misalignment_rotation(const ModelObject &      mo,
                                       const RotOptimizeParams &params)
 {
     RotfinderBoilerplate<1000> bp{mo, params};
 
-    // Preparing the optimizer.
-    size_t gridsize = std::sqrt(bp.max_tries);
-    opt::Optimizer<opt::AlgBruteForce> solver(
-        opt::StopCriteria{}.max_iterations(bp.max_tries)
-                           .stop_condition([&bp] { return bp.stopcond(); }),
-        gridsize
-    );
-
-    // We are searching rotations around only two axes x, y. Thus the
-    // problem becomes a 2 dimensional optimization task.
-    // We can specify the bounds for a dimension in the following way:
-    auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
-
-    auto result = solver.to_max().optimize(
-        [&bp] (const XYRotation &rot)
-        {
-            bp.statusfn();
-            return get_misalginment_score(bp.mesh, to_transform3f(rot));
-        }, opt::initvals({0., 0.}), bounds);
+    // We are searching rotations around only two axes x, y. The alignment
+    // with the X and Y axes depends on the resulting rotation around Z,
+    // thus both rotations turning a direction downwards are scored.
+    size_t num_directions = std::max(bp.max_tries / 2, 1u);
+    std::vector<XYRotation> inputs = sample_sphere_rotations(num_directions, true);
+    bp.max_tries = inputs.size() + REFINED_CANDIDATES * REFINE_ITERATIONS;
+
+    // The score is maximized.
+    XYRotation rot = find_min_score_coarse_to_fine(bp,
+        [](const auto &ep, const indexed_triangle_set &its, const Transform3f &tr) {
+            return -get_misalginment_score(ep, its, tr);
+        }, inputs, sphere_sample_distance(num_directions));
 
-    return {result.optimum[0], result.optimum[1]};
+    return {rot[0], rot[1]};
 }
 
 Vec2d find_least_supports_rotation(const ModelObject &      mo,
@@ -373,46 +489,29 @@ Vec2d find_least_supports_rotation(const ModelObject &      mo,
 
     // Different search methods have to be used depending on the model elevation
     if (is_on_floor(pocfg)) {
-
-        std::vector<XYRotation> inputs = get_chull_rotations(bp.mesh, bp.max_tries);
-        bp.max_tries = inputs.size();
+        TriangleMesh chull = bp.mesh.convex_hull_3d();
+        std::vector<XYRotation> inputs = get_chull_rotations(chull, bp.max_tries);
+        bp.max_tries = inputs.size() + REFINED_CANDIDATES;
 
         // If the model can be placed on the bed directly, we only need to
-        // check the 3D convex hull face rotations.
-
-        auto objfn = [&bp](const XYRotation &rot) {
-            bp.statusfn();
-            Transform3f tr = to_transform3f(rot);
-            return get_supportedness_onfloor_score(bp.mesh, tr);
-        };
-
-        rot = find_min_score<2>(objfn, inputs.begin(), inputs.end(), [&bp] {
-            return bp.stopcond();
-        });
+        // check the 3D convex hull face rotations. The contact with the bed
+        // changes abruptly with the rotation, thus the best ones are not refined.
+        rot = find_min_score_coarse_to_fine(bp,
+            [&chull](const auto &ep, const indexed_triangle_set &its, const Transform3f &tr) {
+                return get_supportedness_onfloor_score(ep, its, chull.its, tr);
+            }, inputs, 0.);
 
     } else {
-        // Preparing the optimizer.
-        size_t gridsize = std::sqrt(bp.max_tries); // 2D grid has gridsize^2 calls
-        opt::Optimizer<opt::AlgBruteForce> solver(
-            opt::StopCriteria{}.max_iterations(bp.max_tries)
-                               .stop_condition([&bp] { return bp.stopcond(); }),
-            gridsize
-        );
-
-        // We are searching rotations around only two axes x, y. Thus the
-        // problem becomes a 2 dimensional optimization task.
-        // We can specify the bounds for a dimension in the following way:
-        auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
-
-        auto result = solver.to_min().optimize(
-            [&bp] (const XYRotation &rot)
-            {
-                bp.statusfn();
-                return get_supportedness_score(bp.mesh, to_transform3f(rot));
-            }, opt::initvals({0., 0.}), bounds);
-
-        // Save the result
-        rot = result.optimum;
+        // We are searching rotations around only two axes x, y. The score only
+        // depends on the direction, which is turned downwards.
+        size_t num_directions = std::max(bp.max_tries, 1u);
+        std::vector<XYRotation> inputs = sample_sphere_rotations(num_directions, false);
+        bp.max_tries = inputs.size() + REFINED_CANDIDATES * REFINE_ITERATIONS;
+
+        rot = find_min_score_coarse_to_fine(bp,
+            [](const auto &ep, const indexed_triangle_set &its, const Transform3f &tr) {
+                return get_supportedness_score(ep, its, tr);
+            }, inputs, sphere_sample_distance(num_directions));
     }
 
     return {rot[0], rot[1]};
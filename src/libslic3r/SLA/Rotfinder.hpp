@@ -50,8 +50,9 @@ public:
   *
   * @param modelobj The model object representing the 3d mesh.
   * @param accuracy The optimization accuracy from 0.0f to 1.0f. Currently,
-  * the nlopt genetic optimizer is used and the number of iterations is
-  * accuracy * 100000. This can change in the future.
+  * accuracy * 1000 rotations are scored in parallel on a subsampled mesh and
+  * the best few of them are refined on the full mesh. This can change in the
+  * future.
   * @param statuscb A status indicator callback called with the int
   * argument spanning from 0 to 100. May not reach 100 if the optimization finds
   * an optimum before max iterations are reached. It should return a boolean
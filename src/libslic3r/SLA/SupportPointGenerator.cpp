@@ -101,8 +101,10 @@ void SupportPointGenerator::project_onto_mesh(std::vector<sla::SupportPoint>& po
 
         Vec3f& p = points[idx].pos;
         // Project the point upward and downward and choose the closer intersection with the mesh.
-        AABBMesh::hit_result hit_up   = m_emesh.query_ray_hit(p.cast<double>(), Vec3d(0., 0., 1.));
-        AABBMesh::hit_result hit_down = m_emesh.query_ray_hit(p.cast<double>(), Vec3d(0., 0., -1.));
+        static const std::vector<Vec3d> dirs { Vec3d(0., 0., 1.), Vec3d(0., 0., -1.) };
+        std::vector<AABBMesh::hit_result> hits = m_emesh.query_ray_hit(std::vector<Vec3d>{ p.cast<double>() }, dirs);
+        AABBMesh::hit_result &hit_up   = hits.front();
+        AABBMesh::hit_result &hit_down = hits.back();
 
         bool up   = hit_up.is_hit();
         bool down = hit_down.is_hit();
@@ -232,6 +234,7 @@ void SupportPointGenerator::process(const std::vector<ExPolygons>& slices, const
 #endif /* SLA_SUPPORTPOINTGEN_DEBUG */
 
     std::vector<SupportPointGenerator::MyLayer> layers = make_layers(slices, heights, m_throw_on_cancel);
+    sample_structures(layers, m_rng());
 
     PointGrid3D point_grid;
     point_grid.cell_size = Vec3f(10.f, 10.f, 10.f);
@@ -295,6 +298,43 @@ void SupportPointGenerator::process(const std::vector<ExPolygons>& slices, const
     }
 }
 
+void SupportPointGenerator::sample_structures(std::vector<MyLayer> &layers, std::mt19937::result_type seed) const
+{
+    execution::for_each(ex_tbb, size_t(0), layers.size(),
+        [this, &layers, seed](size_t layer_id)
+    {
+        if ((layer_id % 8) == 0)
+            // Don't call the following function too often as it flushes CPU write caches due to synchronization primitves.
+            m_throw_on_cancel();
+
+        std::vector<Structure> &islands = layers[layer_id].islands;
+        for (size_t i = 0; i < islands.size(); ++ i) {
+            Structure &s = islands[i];
+            bool is_new = s.islands_below.empty();
+            if (! is_new && s.overhangs.empty())
+                continue;
+
+            // Seed by the position of the structure, so that the samples do not
+            // depend on the order in which the structures are processed.
+            std::seed_seq seq{ seed, std::mt19937::result_type(layer_id), std::mt19937::result_type(i) };
+            std::mt19937  rng(seq);
+
+            if (is_new) {
+                auto chull = Geometry::convex_hull(*s.polygon);
+                auto rotbox = MinAreaBoundigBox{chull, MinAreaBoundigBox::pcConvex};
+                Vec2d bbdim = {unscaled(rotbox.width()), unscaled(rotbox.height())};
+
+                if (bbdim.x() > bbdim.y()) std::swap(bbdim.x(), bbdim.y());
+                double aspectr = bbdim.y() / bbdim.x();
+
+                s.deficit_factor = float(1 + aspectr / 2.);
+                s.raw_samples = sample_cover({ *s.polygon }, icfWithBoundary, rng);
+            } else
+                s.raw_samples = sample_cover(s.overhangs, icfNone, rng);
+        }
+    }, 8 /* gransize */);
+}
+
 void SupportPointGenerator::add_support_points(SupportPointGenerator::Structure &s, SupportPointGenerator::PointGrid3D &grid3d)
 {
     // Select each type of surface (overrhang, dangling, slope), derive the support
@@ -306,12 +346,12 @@ void SupportPointGenerator::add_support_points(SupportPointGenerator::Structure
     if (s.islands_below.empty()) {
         // completely new island - needs support no doubt
         // deficit is full, there is nothing below that would hold this island
-        uniformly_cover({ *s.polygon }, s, s.area * tp, grid3d, IslandCoverageFlags(icfIsNew | icfWithBoundary) );
+        uniformly_cover({ *s.polygon }, s.raw_samples, s, s.area * tp * s.deficit_factor, grid3d, IslandCoverageFlags(icfIsNew | icfWithBoundary) );
         return;
     }
 
     if (! s.overhangs.empty()) {
-        uniformly_cover(s.overhangs, s, s.overhangs_area * tp, grid3d);
+        uniformly_cover(s.overhangs, s.raw_samples, s, s.overhangs_area * tp, grid3d);
     }
 
     auto areafn = [](double sum, auto &p) { return sum + p.area() * SCALING_FACTOR * SCALING_FACTOR; };
@@ -322,13 +362,17 @@ void SupportPointGenerator::add_support_points(SupportPointGenerator::Structure
         // What we now have in polygons needs support, regardless of what the forces are, so we can add them.
 
         double a = std::accumulate(s.dangling_areas.begin(), s.dangling_areas.end(), 0., areafn);
-        uniformly_cover(s.dangling_areas, s, a * tp - a * current * s.area, grid3d, icfWithBoundary);
+        float deficit = float(a * tp - a * current * s.area);
+        if (deficit >= 0)
+            uniformly_cover(s.dangling_areas, sample_cover(s.dangling_areas, icfWithBoundary, m_rng), s, deficit, grid3d, icfWithBoundary);
     }
 
     current = s.supports_force_total();
     if (! s.overhangs_slopes.empty()) {
         double a = std::accumulate(s.overhangs_slopes.begin(), s.overhangs_slopes.end(), 0., areafn);
-        uniformly_cover(s.overhangs_slopes, s, a * tp - a * current / s.area, grid3d, icfWithBoundary);
+        float deficit = float(a * tp - a * current / s.area);
+        if (deficit >= 0)
+            uniformly_cover(s.overhangs_slopes, sample_cover(s.overhangs_slopes, icfWithBoundary, m_rng), s, deficit, grid3d, icfWithBoundary);
     }
 }
 
@@ -543,23 +587,30 @@ static inline std::vector<Vec2f> poisson_disk_from_samples(const std::vector<Vec
 }
 
 
-void SupportPointGenerator::uniformly_cover(const ExPolygons& islands, Structure& structure, float deficit, PointGrid3D &grid3d, IslandCoverageFlags flags)
+float SupportPointGenerator::poisson_radius() const
 {
-    //int num_of_points = std::max(1, (int)((island.area()*pow(SCALING_FACTOR, 2) * m_config.tear_pressure)/m_config.support_force));
+    const float density_horizontal = m_config.tear_pressure() / m_config.support_force();
+    //FIXME why?
+    return std::max(m_config.minimal_distance, 1.f / (5.f * density_horizontal));
+//    return 1.f / (15.f * density_horizontal);
+}
 
-    float support_force_deficit = deficit;
-//    auto bb = get_extents(islands);
+std::vector<Vec2f> SupportPointGenerator::sample_cover(const ExPolygons& islands, IslandCoverageFlags flags, std::mt19937 &rng) const
+{
+    const float poisson_radius  = this->poisson_radius();
+    const float samples_per_mm2 = 30.f / (float(M_PI) * poisson_radius * poisson_radius);
 
-    if (flags & icfIsNew) {
-        auto chull = Geometry::convex_hull(islands);
-        auto rotbox = MinAreaBoundigBox{chull, MinAreaBoundigBox::pcConvex};
-        Vec2d bbdim = {unscaled(rotbox.width()), unscaled(rotbox.height())};
+    return flags & icfWithBoundary ?
+               sample_expolygon_with_boundary(islands, samples_per_mm2,
+                                              5.f / poisson_radius, rng) :
+               sample_expolygon(islands, samples_per_mm2, rng);
+}
 
-        if (bbdim.x() > bbdim.y()) std::swap(bbdim.x(), bbdim.y());
-        double aspectr = bbdim.y() / bbdim.x();
+void SupportPointGenerator::uniformly_cover(const ExPolygons& islands, const std::vector<Vec2f> &raw_samples, Structure& structure, float deficit, PointGrid3D &grid3d, IslandCoverageFlags flags)
+{
+    //int num_of_points = std::max(1, (int)((island.area()*pow(SCALING_FACTOR, 2) * m_config.tear_pressure)/m_config.support_force));
 
-        support_force_deficit *= (1 + aspectr / 2.);
-    }
+    float support_force_deficit = deficit;
 
     if (support_force_deficit < 0)
         return;
@@ -567,23 +618,11 @@ void SupportPointGenerator::uniformly_cover(const ExPolygons& islands, Structure
     // Number of newly added points.
     const size_t poisson_samples_target = size_t(ceil(support_force_deficit / m_config.support_force()));
 
-    const float density_horizontal = m_config.tear_pressure() / m_config.support_force();
-    //FIXME why?
-    float poisson_radius		= std::max(m_config.minimal_distance, 1.f / (5.f * density_horizontal));
-//    const float poisson_radius     = 1.f / (15.f * density_horizontal);
-    const float samples_per_mm2 = 30.f / (float(M_PI) * poisson_radius * poisson_radius);
+    float poisson_radius		= this->poisson_radius();
     // Minimum distance between samples, in 3D space.
 //    float min_spacing			= poisson_radius / 3.f;
     float min_spacing			= poisson_radius;
 
-    //FIXME share the random generator. The random generator may be not so cheap to initialize, also we don't want the random generator to be restarted for each polygon.
-
-    std::vector<Vec2f> raw_samples =
-        flags & icfWithBoundary ?
-            sample_expolygon_with_boundary(islands, samples_per_mm2,
-                                           5.f / poisson_radius, m_rng) :
-            sample_expolygon(islands, samples_per_mm2, m_rng);
-
     std::vector<Vec2f>  poisson_samples;
     for (size_t iter = 0; iter < 4; ++ iter) {
         poisson_samples = poisson_disk_from_samples(raw_samples, poisson_radius,
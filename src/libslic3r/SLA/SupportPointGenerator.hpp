@@ -86,6 +86,13 @@ public:
         // Overhangs, where the surface must slope.
         ExPolygons                              overhangs_slopes;
         float                                   overhangs_area = 0.f;
+        // Random samples of the area, which is always covered by new points:
+        // the whole island if it is new, the complete overhangs otherwise.
+        // Drawn in parallel for all structures ahead of the serial propagation
+        // of the support forces.
+        std::vector<Vec2f>                      raw_samples;
+        // Coefficient of the support force deficit of a new island by its aspect ratio.
+        float                                   deficit_factor = 1.f;
         
         bool overlaps(const Structure &rhs) const { 
             return this->bbox.overlap(rhs.bbox) && this->polygon->overlaps(*rhs.polygon);
@@ -209,7 +216,15 @@ public:
 
 private:
 
-    void uniformly_cover(const ExPolygons& islands, Structure& structure, float deficit, PointGrid3D &grid3d, IslandCoverageFlags flags = icfNone);
+    // Radius of the Poisson disk sampling before it gets reduced to reach the support force deficit.
+    float poisson_radius() const;
+
+    std::vector<Vec2f> sample_cover(const ExPolygons& islands, IslandCoverageFlags flags, std::mt19937 &rng) const;
+
+    // Draw the random samples of the structures, which do not depend on the propagation of the support forces.
+    void sample_structures(std::vector<MyLayer> &layers, std::mt19937::result_type seed) const;
+
+    void uniformly_cover(const ExPolygons& islands, const std::vector<Vec2f> &raw_samples, Structure& structure, float deficit, PointGrid3D &grid3d, IslandCoverageFlags flags = icfNone);
 
     void add_support_points(Structure& structure, PointGrid3D &grid3d);
 
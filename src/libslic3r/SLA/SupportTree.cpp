@@ -66,7 +66,8 @@ indexed_triangle_set create_support_tree(const SupportableMesh &sm,
 
 indexed_triangle_set create_pad(const SupportableMesh      &sm,
                                 const indexed_triangle_set &support_mesh,
-                                const JobController        &ctl)
+                                const JobController        &ctl,
+                                PadCache                   *cache)
 {
     constexpr float PadSamplingLH = 0.1f;
 
@@ -77,20 +78,24 @@ indexed_triangle_set create_pad(const SupportableMesh      &sm,
     float  zend   = zstart + float(pad_h + PadSamplingLH + EPSILON);
     auto  heights = grid(zstart, zend, PadSamplingLH);
 
+    PadCache local_cache;
+    if (!cache)
+        cache = &local_cache;
+
     if (!sm.cfg.enabled || sm.pad_cfg.embed_object) {
         // No support (thus no elevation) or zero elevation mode
         // we sometimes call it "builtin pad" is enabled so we will
         // get a sample from the bottom of the mesh and use it for pad
         // creation.
         sla::pad_blueprint(*sm.emesh.get_triangle_mesh(), model_contours,
-                           heights, ctl.cancelfn);
+                           heights, cache->model_slices, ctl.cancelfn);
     }
 
     ExPolygons sup_contours;
-    pad_blueprint(support_mesh, sup_contours, heights, ctl.cancelfn);
+    pad_blueprint(support_mesh, sup_contours, heights, cache->support_slices, ctl.cancelfn);
 
     indexed_triangle_set out;
-    create_pad(sup_contours, model_contours, out, sm.pad_cfg);
+    create_pad(sup_contours, model_contours, out, sm.pad_cfg, ctl.cancelfn, cache);
 
     Vec3f offs{.0f, .0f, gndlvl};
     for (auto &p : out.vertices) p += offs;
@@ -147,9 +147,12 @@ inline double ground_level(const SupportableMesh &sm)
 indexed_triangle_set create_support_tree(const SupportableMesh &mesh,
                                          const JobController   &ctl);
 
+// The optional cache keeps the pad blueprint slices and the concave hull
+// between the calls with the same model and support meshes.
 indexed_triangle_set create_pad(const SupportableMesh      &model_mesh,
                                 const indexed_triangle_set &support_mesh,
-                                const JobController        &ctl);
+                                const JobController        &ctl,
+                                PadCache                   *cache = nullptr);
 
 std::vector<ExPolygons> slice(const indexed_triangle_set &support_mesh,
                               const indexed_triangle_set &pad_mesh,
@@ -9,6 +9,7 @@
 #include <optional>
 
 #include <libslic3r/Execution/Execution.hpp>
+#include <libslic3r/Execution/ExecutionSeq.hpp>
 #include <libslic3r/Optimize/NLoptOptimizer.hpp>
 #include <libslic3r/Optimize/BruteforceOptimizer.hpp>
 #include <libslic3r/MeshNormals.hpp>
@@ -166,25 +167,31 @@ Hit beam_mesh_hit(Ex policy,
     // Hit results
     std::array<Hit, RayCount> hits;
 
+    // The rays of the beam are nearly parallel, thus they are cast on the mesh together.
+    std::array<Vec3d, RayCount> p_srcs;
+    std::vector<Vec3d> sources(RayCount), raydirs(RayCount);
+    for (size_t i = 0; i < RayCount; ++i) {
+        // Point on the circle on the pin sphere
+        p_srcs[i] = ring.get(i, src, r_src + sd);
+        Vec3d p_dst = ring.get(i, dst, r_dst + sd);
+        raydirs[i] = (p_dst - p_srcs[i]).normalized();
+        sources[i] = p_srcs[i] + r_src * raydirs[i];
+    }
+    std::vector<Hit> first_hits = mesh.query_ray_hit(sources, raydirs);
+
     execution::for_each(
         policy, size_t(0), hits.size(),
-        [&mesh, r_src, r_dst, src, dst, &ring, dir, sd, &hits](size_t i) {
+        [&mesh, r_src, sd, &p_srcs, &raydirs, &first_hits, &hits](size_t i) {
             Hit &hit = hits[i];
-
-            // Point on the circle on the pin sphere
-            Vec3d p_src = ring.get(i, src, r_src + sd);
-            Vec3d p_dst = ring.get(i, dst, r_dst + sd);
-            Vec3d raydir = (p_dst - p_src).normalized();
-
-            auto hr = mesh.query_ray_hit(p_src + r_src * raydir, raydir);
+            const Hit &hr = first_hits[i];
 
             if (hr.is_inside()) {
                 if (hr.distance() > 2 * r_src + sd)
                     hit = Hit(0.0);
                 else {
                     // re-cast the ray from the outside of the object
-                    auto q = p_src + (hr.distance() + EPSILON) * raydir;
-                    hit = mesh.query_ray_hit(q, raydir);
+                    auto q = p_srcs[i] + (hr.distance() + EPSILON) * raydirs[i];
+                    hit = mesh.query_ray_hit(q, raydirs[i]);
                 }
             } else
                 hit = hr;
@@ -193,6 +200,26 @@ Hit beam_mesh_hit(Ex policy,
     return min_hit(hits.begin(), hits.end());
 }
 
+// Test multiple beams on the mesh at once, returning the same hits as
+// beam_mesh_hit() for each beam. The beams are tested in parallel, the rays of
+// each beam are cast together.
+template<class Ex, size_t RayCount = Beam::SAMPLES>
+std::vector<Hit> beams_mesh_hit(Ex policy,
+                                const AABBMesh &mesh,
+                                const std::vector<Beam_<RayCount>> &beams,
+                                double sd)
+{
+    std::vector<Hit> hits(beams.size());
+
+    execution::for_each(
+        policy, size_t(0), beams.size(),
+        [&mesh, &beams, sd, &hits](size_t i) {
+            hits[i] = beam_mesh_hit(ex_seq, mesh, beams[i], sd);
+        }, execution::max_concurrency(policy));
+
+    return hits;
+}
+
 template<class Ex>
 Hit pinhead_mesh_hit(Ex              ex,
                      const AABBMesh &mesh,
@@ -231,14 +258,25 @@ Hit pinhead_mesh_hit(Ex              ex,
 
     // We will shoot multiple rays from the head pinpoint in the direction
     // of the pinhead robe (side) surface. The result will be the smallest
-    // hit distance.
+    // hit distance. The rays are nearly parallel, thus they are cast on the
+    // mesh together.
+
+    std::array<Vec3d, SAMPLES> pins;
+    std::vector<Vec3d> sources(SAMPLES), dirs(SAMPLES);
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        // Point on the circle on the pin sphere
+        pins[i] = rings.pinring(i);
+        // This is the point on the circle on the back sphere
+        Vec3d p = rings.backring(i);
+        dirs[i] = (p - pins[i]).normalized();
+        sources[i] = pins[i] + sd * dirs[i];
+    }
+    std::vector<HitResult> first_hits = m.query_ray_hit(sources, dirs);
 
     execution::for_each(
-        ex, size_t(0), hits.size(), [&m, &rings, sd, &hits](size_t i) {
-            // Point on the circle on the pin sphere
-            Vec3d ps = rings.pinring(i);
-            // This is the point on the circle on the back sphere
-            Vec3d p = rings.backring(i);
+        ex, size_t(0), hits.size(), [&m, &rings, sd, &pins, &dirs, &first_hits, &hits](size_t i) {
+            const Vec3d &ps = pins[i];
+            const Vec3d &n  = dirs[i];
 
             auto &hit = hits[i];
 
@@ -248,8 +286,7 @@ Hit pinhead_mesh_hit(Ex              ex,
                // use the ray-casting result (which has an is_inside
                // predicate).
 
-            Vec3d n = (p - ps).normalized();
-            auto  q = m.query_ray_hit(ps + sd * n, n);
+            const HitResult &q = first_hits[i];
 
             if (q.is_inside()) { // the hit is inside the model
                 if (q.distance() > rings.rpin) {
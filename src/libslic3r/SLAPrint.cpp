@@ -35,6 +35,29 @@
 
 namespace Slic3r {
 
+const char* print_step_name(SLAPrintStep step)
+{
+    switch (step) {
+    case slapsMergeSlicesAndEval:   return "MergeSlicesAndEval";
+    case slapsRasterize:            return "Rasterize";
+    default:                        assert(false); return "Unknown";
+    }
+}
+
+const char* print_object_step_name(SLAPrintObjectStep step)
+{
+    switch (step) {
+    case slaposAssembly:        return "Assembly";
+    case slaposHollowing:       return "Hollowing";
+    case slaposDrillHoles:      return "DrillHoles";
+    case slaposObjectSlice:     return "ObjectSlice";
+    case slaposSupportPoints:   return "SupportPoints";
+    case slaposSupportTree:     return "SupportTree";
+    case slaposPad:             return "Pad";
+    case slaposSliceSupports:   return "SliceSupports";
+    default:                    assert(false); return "Unknown";
+    }
+}
 
 bool is_zero_elevation(const SLAPrintObjectConfig &c)
 {
@@ -153,7 +176,7 @@ bool validate_pad(const indexed_triangle_set &pad, const sla::PadConfig &pcfg)
 
 void SLAPrint::clear()
 {
-    std::scoped_lock<std::mutex> lock(this->state_mutex());
+    std::scoped_lock<PrintStateMutex> lock(this->state_mutex());
     // The following call should stop background processing if it is running.
     this->invalidate_all_steps();
     for (SLAPrintObject *object : m_objects)
@@ -228,7 +251,7 @@ SLAPrint::ApplyStatus SLAPrint::apply(const Model &model, DynamicPrintConfig con
         update_apply_status(false);
 
     // Grab the lock for the Print / PrintObject milestones.
-    std::scoped_lock<std::mutex> lock(this->state_mutex());
+    std::scoped_lock<PrintStateMutex> lock(this->state_mutex());
 
     // The following call may stop the background processing.
     bool invalidate_all_model_objects = false;
@@ -259,7 +282,8 @@ SLAPrint::ApplyStatus SLAPrint::apply(const Model &model, DynamicPrintConfig con
     // Handle changes to object config defaults
     m_default_object_config.apply_only(config, object_diff, true);
 
-    if (!m_archiver || !printer_diff.empty())
+    // Keep the archiver with its rasters if only the metadata of the printer changed.
+    if (!m_archiver || (!printer_diff.empty() && !m_rasters_valid))
         m_archiver = SLAArchiveWriter::create(m_printer_config.sla_archive_format.value.c_str(), m_printer_config);
 
     struct ModelObjectStatus {
@@ -627,6 +651,14 @@ bool SLAPrint::invalidate_step(SLAPrintStep step)
     return invalidated;
 }
 
+bool SLAPrint::invalidate_all_steps()
+{
+    bool invalidated = Inherited::invalidate_all_steps();
+    // The background processing has been stopped by now if it was running.
+    m_rasters_valid = false;
+    return invalidated;
+}
+
 void SLAPrint::process()
 {
     if (m_objects.empty())
@@ -757,15 +789,8 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
         "gamma_correction"
     };
 
-    // Cache the plenty of parameters, which influence the final rasterization only,
-    // or they are only notes not influencing the rasterization step.
+    // Cache the plenty of parameters, which influence the final rasterization only.
     static std::unordered_set<std::string> steps_rasterize = {
-        "min_exposure_time",
-        "max_exposure_time",
-        "exposure_time",
-        "min_initial_exposure_time",
-        "max_initial_exposure_time",
-        "initial_exposure_time",
         "display_width",
         "display_height",
         "display_pixels_x",
@@ -777,6 +802,17 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
         "sla_output_precision"
     };
 
+    // Parameters, which only go into the print statistics and the archive metadata.
+    // The statistics are evaluated again, but the rasters are kept.
+    static std::unordered_set<std::string> steps_metadata = {
+        "min_exposure_time",
+        "max_exposure_time",
+        "exposure_time",
+        "min_initial_exposure_time",
+        "max_initial_exposure_time",
+        "initial_exposure_time"
+    };
+
     static std::unordered_set<std::string> steps_ignore = {
         "bed_shape",
         "max_print_height",
@@ -795,12 +831,14 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
     std::vector<SLAPrintStep> steps;
     std::vector<SLAPrintObjectStep> osteps;
     bool invalidated = false;
+    bool invalidate_metadata = false;
 
     for (const t_config_option_key &opt_key : opt_keys) {
         if (steps_rasterize.find(opt_key) != steps_rasterize.end()) {
-            // These options only affect the final rasterization, or they are just notes without influence on the output,
-            // so there is nothing to invalidate.
+            // These options only affect the final rasterization, so there is no need to slice again.
             steps.emplace_back(slapsMergeSlicesAndEval);
+        } else if (steps_metadata.find(opt_key) != steps_metadata.end()) {
+            invalidate_metadata = true;
         } else if (steps_ignore.find(opt_key) != steps_ignore.end()) {
             // These steps have no influence on the output. Just ignore them.
         } else if (steps_full.find(opt_key) != steps_full.end()) {
@@ -816,6 +854,9 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
     sort_remove_duplicates(steps);
     for (SLAPrintStep step : steps)
         invalidated |= this->invalidate_step(step);
+    if (invalidate_metadata)
+        // Bypass the propagation to invalidate_all_steps(), which would drop the rasters.
+        invalidated |= Inherited::invalidate_steps({ slapsMergeSlicesAndEval, slapsRasterize });
     sort_remove_duplicates(osteps);
     for (SLAPrintObjectStep ostep : osteps)
         for (SLAPrintObject *object : m_objects)
@@ -828,7 +869,7 @@ bool SLAPrint::is_step_done(SLAPrintObjectStep step) const
 {
     if (m_objects.empty())
         return false;
-    std::scoped_lock<std::mutex> lock(this->state_mutex());
+    std::scoped_lock<PrintStateMutex> lock(this->state_mutex());
     for (const SLAPrintObject *object : m_objects)
         if (! object->is_step_done_unguarded(step))
             return false;
@@ -41,6 +41,10 @@ enum SLAPrintObjectStep : unsigned int {
 	slaposCount
 };
 
+// Names of the steps for profiling reports.
+const char* print_step_name(SLAPrintStep step);
+const char* print_object_step_name(SLAPrintObjectStep step);
+
 class SLAPrint;
 class GLCanvas;
 
@@ -346,6 +350,7 @@ private:
         sla::SupportableMesh    input; // the input
         std::vector<ExPolygons> support_slices;   // sliced supports
         TriangleMesh tree_mesh, pad_mesh, full_mesh; // cached artifacts
+        sla::PadCache pad_cache; // intermediate pad results valid for the current tree_mesh
         
         inline SupportData(const TriangleMesh &t)
             : input{t.its, {}, {}}
@@ -358,11 +363,12 @@ private:
         void create_support_tree(const sla::JobController &ctl)
         {
             tree_mesh = TriangleMesh{sla::create_support_tree(input, ctl)};
+            pad_cache = {};
         }
 
         void create_pad(const sla::JobController &ctl)
         {
-            pad_mesh = TriangleMesh{sla::create_pad(input, tree_mesh.its, ctl)};
+            pad_mesh = TriangleMesh{sla::create_pad(input, tree_mesh.its, ctl, &pad_cache)};
         }
     };
 
@@ -394,6 +400,17 @@ private:
     };
     
     std::unique_ptr<HollowingData> m_hollowing_data;
+
+    // The distance grid of the parts to hollow with the hash of the parts and
+    // the voxel scale it was created with. It is kept over the invalidation of
+    // the hollowing step, so that the interior is derived from it again when
+    // only the thickness or the closing distance changes.
+    struct HollowingGrid
+    {
+        size_t       csg_hash    = 0;
+        double       voxel_scale = 0.;
+        VoxelGridPtr grid;
+    } m_hollowing_grid;
 };
 
 using PrintObjects = std::vector<SLAPrintObject*>;
@@ -505,17 +522,31 @@ public:
     // occupied layer. Slice record levels dont have to match exactly.
     // They are unified if the level difference is within +/- SCALED_EPSILON
     class PrintLayer {
+    public:
+        // Slices of an object instance to be drawn at the offsets of the
+        // instances of the object with the same rotation. The stamped
+        // instances do not overlap anything else on the level, so a raster
+        // may render the slices once and copy the pixels to the offsets.
+        struct Stamp {
+            ExPolygons         slices;
+            std::vector<Point> offsets;
+        };
+
+    private:
         coord_t m_level;
 
         // The collection of slice records for the current level.
         std::vector<std::reference_wrapper<const SliceRecord>> m_slices;
 
         ExPolygons m_transformed_slices;
+        std::vector<Stamp> m_stamps;
 
         template<class Container> void transformed_slices(Container&& c)
         {
             m_transformed_slices = std::forward<Container>(c);
         }
+
+        void stamps(std::vector<Stamp> &&s) { m_stamps = std::move(s); }
         
         friend class SLAPrint::Steps;
 
@@ -534,9 +565,21 @@ public:
 
         auto slices() const -> const decltype (m_slices)& { return m_slices; }
 
+        // The merged slices of the level except for the stamped instances.
         const ExPolygons & transformed_slices() const {
             return m_transformed_slices;
         }
+
+        const std::vector<Stamp> & stamps() const { return m_stamps; }
+
+        // Draw the transformed slices and the stamps into the raster.
+        void draw(sla::RasterBase &raster) const
+        {
+            for (const ExPolygon &poly : m_transformed_slices)
+                raster.draw(poly);
+            for (const Stamp &stamp : m_stamps)
+                raster.draw_copies(stamp.slices, stamp.offsets);
+        }
     };
 
     // The aggregated and leveled print records from various objects.
@@ -557,6 +600,8 @@ private:
     
     // Implement same logic as in SLAPrintObject
     bool invalidate_step(SLAPrintStep st);
+    // Invalidates the rasters kept by the archiver as well.
+    bool invalidate_all_steps();
 
     // Invalidate steps based on a set of parameters changed.
     bool invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys, bool &invalidate_all_model_objects);
@@ -573,6 +618,10 @@ private:
     
     // The archive object which collects the raster images after slicing
     std::unique_ptr<SLAArchiveWriter>     m_archiver;
+    // The archiver holds the rasters of the current geometry. Only cleared
+    // by invalidate_all_steps(), thus settings which only go into the archive
+    // metadata or the print statistics do not trigger rasterization again.
+    bool                            m_rasters_valid = false;
     
     // Estimated print time, material consumed.
     SLAPrintStatistics              m_print_statistics;
@@ -31,6 +31,7 @@
 //#include <libslic3r/ShortEdgeCollapse.hpp>
 
 #include <boost/log/trivial.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "I18N.hpp"
 
@@ -70,6 +71,10 @@ std::string OBJ_STEP_LABELS(size_t idx)
     return "Out of bounds!";
 }
 
+// Minimal gap between the bounding boxes of the object instances stamped
+// into the rasters and the other instances, several pixels of any display.
+const coord_t StampMargin = scaled(.5);
+
 const std::array<unsigned, slapsCount> PRINT_STEP_LEVELS = {
     10, // slapsMergeSlicesAndEval
     90, // slapsRasterize
@@ -174,17 +179,14 @@ void SLAPrint::Steps::generate_preview(SLAPrintObject &po, SLAPrintObjectStep st
         m = csgmesh_merge_positive_parts(r);
         handled = true;
     } else if (csg::check_csgmesh_booleans(r) == r.end()) {
-        MeshBoolean::cgal::CGALMeshPtr cgalmeshptr;
         try {
-            cgalmeshptr = csg::perform_csgmesh_booleans(r);
+            m = csg::perform_csgmesh_booleans(r, csg::BooleanBackend::Fast);
+            handled = true;
         } catch (...) {
-            // leaves cgalmeshptr as nullptr
+            // leaves handled as false
         }
 
-        if (cgalmeshptr) {
-            m = MeshBoolean::cgal::cgal_to_indexed_triangle_set(*cgalmeshptr);
-            handled = true;
-        } else {
+        if (! handled) {
             BOOST_LOG_TRIVIAL(warning) << "CSG mesh is not egligible for proper CGAL booleans!";
         }
     } else {
@@ -323,15 +325,46 @@ void SLAPrint::Steps::mesh_assembly(SLAPrintObject &po)
     generate_preview(po, slaposAssembly);
 }
 
+// Hash of the meshes, transformations and operations of the CSG parts to
+// recognize that a voxel grid created from them is still valid.
+template<class Cont> size_t csgmesh_hash(const Cont &csg)
+{
+    size_t seed = 0;
+    for (const auto &m : csg) {
+        boost::hash_combine(seed, int(csg::get_operation(m)));
+        boost::hash_combine(seed, int(csg::get_stack_operation(m)));
+
+        Transform3f trafo = csg::get_transform(m);
+        boost::hash_range(seed, trafo.data(), trafo.data() + trafo.matrix().size());
+
+        if (const indexed_triangle_set *its = csg::get_mesh(m)) {
+            boost::hash_combine(seed, its->vertices.size());
+            if (! its->vertices.empty())
+                boost::hash_range(seed, its->vertices.front().data(),
+                                  its->vertices.front().data() + 3 * its->vertices.size());
+            boost::hash_combine(seed, its->indices.size());
+            if (! its->indices.empty())
+                boost::hash_range(seed, its->indices.front().data(),
+                                  its->indices.front().data() + 3 * its->indices.size());
+        }
+    }
+
+    return seed;
+}
+
 void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
 {
     po.m_hollowing_data.reset();
     po.m_supportdata.reset();
     clear_csg(po.m_mesh_to_slice, slaposDrillHoles);
     clear_csg(po.m_mesh_to_slice, slaposHollowing);
+    // Previews of the previous hollowing and drilling, they may not be generated again.
+    for (size_t i = slaposHollowing; i < slaposCount; ++i)
+        po.m_preview_meshes[i] = {};
 
     if (! po.m_config.hollowing_enable.getBool()) {
         BOOST_LOG_TRIVIAL(info) << "Skipping hollowing step!";
+        po.m_hollowing_grid = {};
         return;
     }
 
@@ -345,8 +378,23 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
     ctl.stopcondition = [this]() { return canceled(); };
     ctl.cancelfn = [this]() { throw_if_canceled(); };
 
-    sla::InteriorPtr interior =
-        generate_interior(po.mesh_to_slice(), hlwcfg, ctl);
+    // The distance grid of the model is only created again if the model or
+    // the voxel scale changed, not if just the thickness or the closing
+    // distance did.
+    auto   parts    = po.mesh_to_slice();
+    size_t csg_hash = csgmesh_hash(parts);
+    double voxsc    = sla::get_voxel_scale(sla::csgmesh_positive_maxvolume(parts), hlwcfg);
+
+    SLAPrintObject::HollowingGrid &cache = po.m_hollowing_grid;
+    if (! cache.grid || cache.csg_hash != csg_hash || cache.voxel_scale != voxsc) {
+        cache = {};
+        if (VoxelGridPtr grid = sla::generate_interior_grid(parts, voxsc, ctl))
+            cache = { csg_hash, voxsc, std::move(grid) };
+    } else
+        BOOST_LOG_TRIVIAL(info) << "Reusing the distance grid of the model for hollowing.";
+
+    sla::InteriorPtr interior = cache.grid ?
+        sla::generate_interior(*cache.grid, hlwcfg, ctl) : sla::InteriorPtr{};
 
     if (!interior || sla::get_mesh(*interior).empty())
         BOOST_LOG_TRIVIAL(warning) << "Hollowed interior is empty!";
@@ -385,7 +433,17 @@ void SLAPrint::Steps::drill_holes(SLAPrintObject &po)
                           csg_inserter{po.m_mesh_to_slice, slaposDrillHoles},
                           csg::mpartsDrillHoles);
 
-    generate_preview(po, slaposDrillHoles);
+    if (auto holes = po.m_mesh_to_slice.equal_range(slaposDrillHoles); holes.first != holes.second)
+        generate_preview(po, slaposDrillHoles);
+    else {
+        // Nothing to drill, the preview of the previous step is still valid.
+        // Don't repeat the (possibly CGAL) mesh booleans of the previous step.
+        for (size_t i = slaposDrillHoles; i < slaposCount; ++i)
+            po.m_preview_meshes[i] = {};
+
+        using namespace std::string_literals;
+        report_status(-2, "Reload preview from step "s + std::to_string(int(slaposDrillHoles)), SlicingStatus::RELOAD_SLA_PREVIEW);
+    }
 
     // Release the data, won't be needed anymore, takes huge amount of ram
     if (po.m_hollowing_data && po.m_hollowing_data->interior)
@@ -799,61 +857,57 @@ void SLAPrint::Steps::slice_supports(SLAPrintObject &po) {
     report_status(-2, "", SlicingStatus::RELOAD_SLA_PREVIEW);
 }
 
-// get polygons for all instances in the object
-static ExPolygons get_all_polygons(const SliceRecord& record, SliceOrigin o)
+// get polygons of the object rotated and shifted as one of its instances
+static ExPolygons get_instance_polygons(const SliceRecord &record, SliceOrigin o, double rotation, const Point &shift)
 {
     if (!record.print_obj()) return {};
 
     ExPolygons polygons;
     auto &input_polygons = record.get_slice(o);
-    auto &instances = record.print_obj()->instances();
     bool is_lefthanded = record.print_obj()->is_left_handed();
-    polygons.reserve(input_polygons.size() * instances.size());
+    polygons.reserve(input_polygons.size());
 
     for (const ExPolygon& polygon : input_polygons) {
         if(polygon.contour.empty()) continue;
 
-        for (size_t i = 0; i < instances.size(); ++i)
-        {
-            ExPolygon poly;
+        ExPolygon poly;
+
+        // We need to reverse if is_lefthanded is true but
+        bool needreverse = is_lefthanded;
 
-            // We need to reverse if is_lefthanded is true but
-            bool needreverse = is_lefthanded;
+        // should be a move
+        poly.contour.points.reserve(polygon.contour.size() + 1);
 
-            // should be a move
-            poly.contour.points.reserve(polygon.contour.size() + 1);
+        auto& cntr = polygon.contour.points;
+        if(needreverse)
+            for(auto it = cntr.rbegin(); it != cntr.rend(); ++it)
+                poly.contour.points.emplace_back(it->x(), it->y());
+        else
+            for(auto& p : cntr)
+                poly.contour.points.emplace_back(p.x(), p.y());
+
+        for(auto& h : polygon.holes) {
+            poly.holes.emplace_back();
+            auto& hole = poly.holes.back();
+            hole.points.reserve(h.points.size() + 1);
 
-            auto& cntr = polygon.contour.points;
             if(needreverse)
-                for(auto it = cntr.rbegin(); it != cntr.rend(); ++it)
-                    poly.contour.points.emplace_back(it->x(), it->y());
+                for(auto it = h.points.rbegin(); it != h.points.rend(); ++it)
+                    hole.points.emplace_back(it->x(), it->y());
             else
-                for(auto& p : cntr)
-                    poly.contour.points.emplace_back(p.x(), p.y());
-
-            for(auto& h : polygon.holes) {
-                poly.holes.emplace_back();
-                auto& hole = poly.holes.back();
-                hole.points.reserve(h.points.size() + 1);
-
-                if(needreverse)
-                    for(auto it = h.points.rbegin(); it != h.points.rend(); ++it)
-                        hole.points.emplace_back(it->x(), it->y());
-                else
-                    for(auto& p : h.points)
-                        hole.points.emplace_back(p.x(), p.y());
-            }
+                for(auto& p : h.points)
+                    hole.points.emplace_back(p.x(), p.y());
+        }
 
-            if(is_lefthanded) {
-                for(auto& p : poly.contour) p.x() = -p.x();
-                for(auto& h : poly.holes) for(auto& p : h) p.x() = -p.x();
-            }
+        if(is_lefthanded) {
+            for(auto& p : poly.contour) p.x() = -p.x();
+            for(auto& h : poly.holes) for(auto& p : h) p.x() = -p.x();
+        }
 
-            poly.rotate(double(instances[i].rotation));
-            poly.translate(Point{instances[i].shift.x(), instances[i].shift.y()});
+        poly.rotate(rotation);
+        poly.translate(shift);
 
-            polygons.emplace_back(std::move(poly));
-        }
+        polygons.emplace_back(std::move(poly));
     }
 
     return polygons;
@@ -930,32 +984,28 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
     const auto height         = scaled<double>(printer_config.display_height.getFloat());
     const double display_area = width*height;
 
-    double supports_volume(0.0);
-    double models_volume(0.0);
-
-    double estim_time(0.0);
-    std::vector<double> layers_times;
-    layers_times.reserve(printer_input.size());
-
-    size_t slow_layers = 0;
-    size_t fast_layers = 0;
-
-    const double delta_fade_time = (init_exp_time - exp_time) / (fade_layers_cnt + 1);
-    double fade_layer_time = init_exp_time;
+    // The statistics of each layer, which do not depend on the other layers.
+    struct LayerStats
+    {
+        bool   valid         = false;
+        double l_height      = 0.;
+        double model_area    = 0.;
+        double support_area  = 0.;
+        bool   is_fast_layer = false;
+    };
 
-    execution::SpinningMutex<ExecutionTBB> mutex;
-    using Lock = std::lock_guard<decltype(mutex)>;
+    std::vector<LayerStats> layer_stats(printer_input.size());
 
     // Going to parallel:
     auto printlayerfn = [this,
             // functions and read only vars
-            area_fill, display_area, exp_time, init_exp_time, fast_tilt, slow_tilt, hv_tilt, material_config, delta_fade_time,
+            area_fill, display_area,
 
             // write vars
-            &mutex, &models_volume, &supports_volume, &estim_time, &slow_layers,
-            &fast_layers, &fade_layer_time, &layers_times](size_t sliced_layer_cnt)
+            &layer_stats](size_t sliced_layer_cnt)
     {
         PrintLayer &layer = m_print->m_printer_input[sliced_layer_cnt];
+        LayerStats &stats = layer_stats[sliced_layer_cnt];
 
         // vector of slice record references
         auto& slicerecord_references = layer.slices();
@@ -963,49 +1013,110 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
         if(slicerecord_references.empty()) return;
 
         // Layer height should match for all object slices for a given level.
-        const auto l_height = double(slicerecord_references.front().get().layer_height());
+        stats.l_height = double(slicerecord_references.front().get().layer_height());
+        stats.valid    = true;
 
         // Calculation of the consumed material
 
         ExPolygons model_polygons;
         ExPolygons supports_polygons;
 
-        size_t c = std::accumulate(layer.slices().begin(),
-                                   layer.slices().end(),
-                                   size_t(0),
-                                   [](size_t a, const SliceRecord &sr) {
-            return a + sr.get_slice(soModel).size();
-        });
+        // Instances of an object with the same rotation share their slices,
+        // which are transformed only once. The instances not overlapping any
+        // other instance on the level are merged only once as well and drawn
+        // as stamps of the shared slices.
+        struct InstanceGroup {
+            ExPolygons         model, supports; // rotated, but not shifted
+            BoundingBox        bb;
+            std::vector<Point> offsets;         // of the stamped instances
+        };
+        struct InstanceBox {
+            BoundingBox bb;
+            size_t      group;
+            Point       shift;
+            bool        stamped = true;
+        };
 
-        model_polygons.reserve(c);
+        std::vector<InstanceGroup> groups;
+        std::vector<InstanceBox>   boxes;
 
-        c = std::accumulate(layer.slices().begin(),
-                            layer.slices().end(),
-                            size_t(0),
-                            [](size_t a, const SliceRecord &sr) {
-            return a + sr.get_slice(soSupport).size();
-        });
+        for(const SliceRecord& record : layer.slices()) {
+            const SLAPrintObject *po = record.print_obj();
+            if (!po) continue;
+
+            std::vector<std::pair<float, size_t>> rotations;
+            for (const SLAPrintObject::Instance &inst : po->instances()) {
+                auto it = std::find_if(rotations.begin(), rotations.end(),
+                                       [&inst](const auto &r) { return r.first == inst.rotation; });
+                if (it == rotations.end()) {
+                    InstanceGroup g;
+                    g.model    = get_instance_polygons(record, soModel, double(inst.rotation), Point::Zero());
+                    g.supports = get_instance_polygons(record, soSupport, double(inst.rotation), Point::Zero());
+                    g.bb       = get_extents(g.model);
+                    g.bb.merge(get_extents(g.supports));
+                    rotations.emplace_back(inst.rotation, groups.size());
+                    groups.emplace_back(std::move(g));
+                    it = std::prev(rotations.end());
+                }
 
-        supports_polygons.reserve(c);
+                if (! groups[it->second].bb.defined) continue;
 
-        for(const SliceRecord& record : layer.slices()) {
+                BoundingBox bb = groups[it->second].bb;
+                bb.translate(inst.shift);
+                bb.offset(StampMargin);
+                boxes.push_back({bb, it->second, inst.shift});
+            }
+        }
 
-            ExPolygons modelslices = get_all_polygons(record, soModel);
-            for(ExPolygon& p_tmp : modelslices) model_polygons.emplace_back(std::move(p_tmp));
+        std::sort(boxes.begin(), boxes.end(),
+                  [](const InstanceBox &a, const InstanceBox &b) { return a.bb.min.x() < b.bb.min.x(); });
+        for (size_t i = 0; i < boxes.size(); ++i)
+            for (size_t j = i + 1; j < boxes.size() && boxes[j].bb.min.x() <= boxes[i].bb.max.x(); ++j)
+                if (boxes[i].bb.overlap(boxes[j].bb))
+                    boxes[i].stamped = boxes[j].stamped = false;
+
+        std::vector<size_t> stamped_cnt(groups.size(), 0);
+        for (const InstanceBox &box : boxes)
+            if (box.stamped) ++stamped_cnt[box.group];
+
+        for (const InstanceBox &box : boxes) {
+            InstanceGroup &g = groups[box.group];
+            if (box.stamped && stamped_cnt[box.group] > 1) {
+                g.offsets.emplace_back(box.shift);
+                continue;
+            }
 
-            ExPolygons supportslices = get_all_polygons(record, soSupport);
-            for(ExPolygon& p_tmp : supportslices) supports_polygons.emplace_back(std::move(p_tmp));
+            for (ExPolygon p : g.model) {
+                p.translate(box.shift);
+                model_polygons.emplace_back(std::move(p));
+            }
+            for (ExPolygon p : g.supports) {
+                p.translate(box.shift);
+                supports_polygons.emplace_back(std::move(p));
+            }
+        }
+
+        std::vector<PrintLayer::Stamp> stamps;
+        for (InstanceGroup &g : groups) {
+            if (g.offsets.empty()) continue;
+
+            ExPolygons model = union_ex(g.model);
+            ExPolygons supports = model.empty() ? union_ex(g.supports) : diff_ex(g.supports, model);
+
+            double cnt = double(g.offsets.size());
+            for (const ExPolygon &polygon : model)
+                stats.model_area += cnt * area(polygon);
+            for (const ExPolygon &polygon : supports)
+                stats.support_area += cnt * area(polygon);
 
+            append(model, std::move(supports));
+            stamps.push_back({union_ex(model), std::move(g.offsets)});
         }
+        layer.stamps(std::move(stamps));
 
         model_polygons = union_ex(model_polygons);
-        double layer_model_area = 0;
         for (const ExPolygon& polygon : model_polygons)
-            layer_model_area += area(polygon);
-
-        if (layer_model_area < 0 || layer_model_area > 0) {
-            Lock lck(mutex); models_volume += layer_model_area * l_height;
-        }
+            stats.model_area += area(polygon);
 
         if(!supports_polygons.empty()) {
             if(model_polygons.empty()) supports_polygons = union_ex(supports_polygons);
@@ -1013,13 +1124,8 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
             // allegedly, union of subject is done withing the diff according to the pftPositive polyFillType
         }
 
-        double layer_support_area = 0;
         for (const ExPolygon& polygon : supports_polygons)
-            layer_support_area += area(polygon);
-
-        if (layer_support_area < 0 || layer_support_area > 0) {
-            Lock lck(mutex); supports_volume += layer_support_area * l_height;
-        }
+            stats.support_area += area(polygon);
 
         // Here we can save the expensively calculated polygons for printing
         ExPolygons trslices;
@@ -1030,59 +1136,85 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
         layer.transformed_slices(union_ex(trslices));
 
         // Calculation of the slow and fast layers to the future controlling those values on FW
+        stats.is_fast_layer = (stats.model_area + stats.support_area) <= display_area*area_fill;
+    };
+
+    // sequential version for debugging:
+    // for(size_t i = 0; i < m_printer_input.size(); ++i) printlayerfn(i);
+    execution::for_each(ex_tbb, size_t(0), printer_input.size(), printlayerfn,
+                        execution::max_concurrency(ex_tbb));
+
+    // The volumes and the times are summed up in the order of the layers, as
+    // the fading of the exposure time depends on the order. This pass is
+    // cheap compared to the merging of the slices above.
+    double supports_volume(0.0);
+    double models_volume(0.0);
+
+    double estim_time(0.0);
+    std::vector<double> layers_times;
+    layers_times.reserve(printer_input.size());
+
+    size_t slow_layers = 0;
+    size_t fast_layers = 0;
+
+    const double delta_fade_time = (init_exp_time - exp_time) / (fade_layers_cnt + 1);
+    double fade_layer_time = init_exp_time;
+
+    for (size_t sliced_layer_cnt = 0; sliced_layer_cnt < layer_stats.size(); ++sliced_layer_cnt) {
+        const LayerStats &stats = layer_stats[sliced_layer_cnt];
+        if (! stats.valid)
+            continue;
+
+        const double l_height = stats.l_height;
+        const bool is_fast_layer = stats.is_fast_layer;
+
+        models_volume   += stats.model_area * l_height;
+        supports_volume += stats.support_area * l_height;
 
-        const bool is_fast_layer = (layer_model_area + layer_support_area) <= display_area*area_fill;
         const double tilt_time = material_config.material_print_speed == slamsSlow              ? slow_tilt :
                                  material_config.material_print_speed == slamsHighViscosity     ? hv_tilt   :
                                  is_fast_layer ? fast_tilt : slow_tilt;
 
-        { Lock lck(mutex);
-            if (is_fast_layer)
-                fast_layers++;
-            else
-                slow_layers++;
+        if (is_fast_layer)
+            fast_layers++;
+        else
+            slow_layers++;
 
-            // Calculation of the printing time
+        // Calculation of the printing time
 
-            double layer_times = 0.0;
-            if (sliced_layer_cnt < 3)
-                layer_times += init_exp_time;
-            else if (fade_layer_time > exp_time) {
-                fade_layer_time -= delta_fade_time;
-                layer_times += fade_layer_time;
-            }
-            else
-                layer_times += exp_time;
-            layer_times += tilt_time;
-
-            //// Per layer times (magical constants cuclulated from FW)
-
-            static double exposure_safe_delay_before{ 3.0 };
-            static double exposure_high_viscosity_delay_before{ 3.5 };
-            static double exposure_slow_move_delay_before{ 1.0 };
-
-            if (material_config.material_print_speed == slamsSlow)
-                layer_times += exposure_safe_delay_before;
-            else if (material_config.material_print_speed == slamsHighViscosity)
-                layer_times += exposure_high_viscosity_delay_before;
-            else if (!is_fast_layer)
-                layer_times += exposure_slow_move_delay_before;
-
-            // Increase layer time for "magic constants" from FW
-            layer_times += (
-                l_height * 5  // tower move
-                + 120 / 1000  // Magical constant to compensate remaining computation delay in exposure thread
-            );
-
-            layers_times.push_back(layer_times);
-            estim_time += layer_times;
+        double layer_times = 0.0;
+        if (sliced_layer_cnt < 3)
+            layer_times += init_exp_time;
+        else if (fade_layer_time > exp_time) {
+            fade_layer_time -= delta_fade_time;
+            layer_times += fade_layer_time;
         }
-    };
-
-    // sequential version for debugging:
-    // for(size_t i = 0; i < m_printer_input.size(); ++i) printlayerfn(i);
-    execution::for_each(ex_tbb, size_t(0), printer_input.size(), printlayerfn,
-                        execution::max_concurrency(ex_tbb));
+        else
+            layer_times += exp_time;
+        layer_times += tilt_time;
+
+        //// Per layer times (magical constants cuclulated from FW)
+
+        static double exposure_safe_delay_before{ 3.0 };
+        static double exposure_high_viscosity_delay_before{ 3.5 };
+        static double exposure_slow_move_delay_before{ 1.0 };
+
+        if (material_config.material_print_speed == slamsSlow)
+            layer_times += exposure_safe_delay_before;
+        else if (material_config.material_print_speed == slamsHighViscosity)
+            layer_times += exposure_high_viscosity_delay_before;
+        else if (!is_fast_layer)
+            layer_times += exposure_slow_move_delay_before;
+
+        // Increase layer time for "magic constants" from FW
+        layer_times += (
+            l_height * 5  // tower move
+            + 120 / 1000  // Magical constant to compensate remaining computation delay in exposure thread
+        );
+
+        layers_times.push_back(layer_times);
+        estim_time += layer_times;
+    }
 
     auto SCALING2 = SCALING_FACTOR * SCALING_FACTOR;
     print_statistics.support_used_material = supports_volume * SCALING2;
@@ -1108,6 +1240,12 @@ void SLAPrint::Steps::rasterize()
 {
     if(canceled() || !m_print->m_archiver) return;
 
+    // The layers are rasterized on export, streamed into the archive.
+    if (m_print->m_archiver->streams_layers()) return;
+
+    // Only the exposure settings changed, the rasters of the archiver are up to date.
+    if (m_print->m_rasters_valid) return;
+
     // coefficient to map the rasterization state (0-99) to the allocated
     // portion (slot) of the process state
     double sd = (100 - max_objstatus) / 100.0;
@@ -1131,8 +1269,7 @@ void SLAPrint::Steps::rasterize()
         PrintLayer& printlayer = m_print->m_printer_input[idx];
         if(canceled()) return;
 
-        for (const ExPolygon& poly : printlayer.transformed_slices())
-            raster.draw(poly);
+        printlayer.draw(raster);
 
         // Status indication guarded with the spinlock
         {
@@ -1152,6 +1289,8 @@ void SLAPrint::Steps::rasterize()
     // Print all the layers in parallel
     m_print->m_archiver->draw_layers(m_print->m_printer_input.size(), lvlfn,
                                     [this]() { return canceled(); }, ex_tbb);
+
+    m_print->m_rasters_valid = !canceled();
 }
 
 std::string SLAPrint::Steps::label(SLAPrintObjectStep step)
@@ -4,6 +4,7 @@
 ///|/
 #include "ShortEdgeCollapse.hpp"
 #include "libslic3r/NormalUtils.hpp"
+#include "libslic3r/BoundingBox.hpp"
 
 #include <unordered_map>
 #include <unordered_set>
@@ -12,6 +13,9 @@
 
 #include <ankerl/unordered_dense.h>
 
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
 namespace Slic3r {
 
 void its_short_edge_collpase(indexed_triangle_set &mesh, size_t target_triangle_count) {
@@ -20,24 +24,25 @@ void its_short_edge_collpase(indexed_triangle_set &mesh, size_t target_triangle_
     for (size_t idx = 0; idx < vertices_index_mapping.size(); ++idx) {
         vertices_index_mapping[idx] = idx;
     }
-    // Algorithm uses get_final_index query to get the actual vertex index. The query also updates all mappings on the way, essentially flattening the mapping
+    // Algorithm uses get_final_index query to get the actual vertex index. The query also updates all mappings on the way, essentially flattening the mapping.
+    // The queue is passed in, as the partitions of the mesh are collapsed in parallel.
     std::vector<size_t> flatten_queue;
-    auto get_final_index = [&vertices_index_mapping, &flatten_queue](const size_t &orig_index) {
-        flatten_queue.clear();
+    auto get_final_index = [&vertices_index_mapping](const size_t &orig_index, std::vector<size_t> &queue) {
+        queue.clear();
         size_t idx = orig_index;
         while (vertices_index_mapping[idx] != idx) {
-            flatten_queue.push_back(idx);
+            queue.push_back(idx);
             idx = vertices_index_mapping[idx];
         }
-        for (size_t i : flatten_queue) {
+        for (size_t i : queue) {
             vertices_index_mapping[i] = idx;
         }
         return idx;
 
     };
 
-    // if face is removed, mark it here
-    std::vector<bool> face_removal_flags(mesh.indices.size(), false);
+    // if face is removed, mark it here. Not std::vector<bool>, the faces of different partitions are removed concurrently.
+    std::vector<char> face_removal_flags(mesh.indices.size(), false);
 
     std::vector<Vec3i> triangles_neighbors = its_face_neighbors_par(mesh);
 
@@ -85,6 +90,44 @@ void its_short_edge_collpase(indexed_triangle_set &mesh, size_t target_triangle_
             }
     };
 
+    // Split the faces into slabs of equal face count along the longest axis of the mesh. The edges inside a slab are collapsed
+    // in parallel with the other slabs, the edges along the slab borders are then collapsed serially.
+    // The number of partitions does not depend on the number of threads, so that results are deterministic.
+    static constexpr const size_t faces_per_partition = 50000;
+    const size_t num_partitions = std::clamp<size_t>(mesh.indices.size() / faces_per_partition, 1, 64);
+    std::vector<int> face_partition(mesh.indices.size(), 0);
+    if (num_partitions > 1) {
+        BoundingBoxf3 bbox;
+        for (const Vec3f &v : mesh.vertices)
+            bbox.merge(v.cast<double>());
+        int axis = 0;
+        bbox.size().maxCoeff(&axis);
+        std::vector<std::pair<float, int>> face_coords(mesh.indices.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, mesh.indices.size()), [&mesh, &face_coords, axis](const tbb::blocked_range<size_t> &range) {
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                const Vec3i &t = mesh.indices[face_idx];
+                face_coords[face_idx] = { mesh.vertices[t[0]][axis] + mesh.vertices[t[1]][axis] + mesh.vertices[t[2]][axis], int(face_idx) };
+            }
+        });
+        tbb::parallel_sort(face_coords.begin(), face_coords.end());
+        for (size_t i = 0; i < face_coords.size(); ++ i)
+            face_partition[face_coords[i].second] = int(i * num_partitions / face_coords.size());
+    }
+    // Partition owning a vertex, if all the live faces around the vertex belong to that partition, otherwise -1.
+    std::vector<int> vertex_partition(mesh.vertices.size());
+    auto update_vertex_partitions = [&mesh, &face_removal_flags, &face_partition, &vertex_partition, &get_final_index, &flatten_queue]() {
+        std::fill(vertex_partition.begin(), vertex_partition.end(), -2);
+        for (size_t face_idx = 0; face_idx < mesh.indices.size(); ++ face_idx)
+            if (! face_removal_flags[face_idx])
+                for (int i = 0; i < 3; ++ i) {
+                    // Flatten the mapping, so that the parallel collapse only reads the mapping of vertices it does not own.
+                    int &partition = vertex_partition[get_final_index(mesh.indices[face_idx][i], flatten_queue)];
+                    partition = partition == -2 || partition == face_partition[face_idx] ? face_partition[face_idx] : -1;
+                }
+        for (size_t idx = 0; idx < mesh.vertices.size(); ++ idx)
+            get_final_index(idx, flatten_queue);
+    };
+
     std::mt19937_64 generator { 27644437 };// default constant seed! so that results are deterministic
     std::vector<size_t> face_indices(mesh.indices.size());
     for (size_t idx = 0; idx < face_indices.size(); ++idx) {
@@ -105,21 +148,33 @@ void its_short_edge_collpase(indexed_triangle_set &mesh, size_t target_triangle_
         std::shuffle(face_indices.begin(), face_indices.end(), generator);
         
         int allowed_face_removals = int(face_indices.size()) - int(target_triangle_count);
-        for (const size_t &face_idx : face_indices) {
-            if (face_removal_flags[face_idx]) {
-                // if face already removed from previous collapses, skip (each collapse removes two triangles [at least] )
-                continue;
-            }
-
+        // Try to collapse an edge of the face, returns false if the collapse has to be deferred to the serial pass.
+        // If partition is not negative, only the edges of the partition not touching other partitions are collapsed.
+        auto collapse_face = [&](size_t face_idx, int partition, int &allowed, std::vector<size_t> &queue) {
             // look at each edge if it is good candidate for collapse
             for (size_t edge_idx = 0; edge_idx < 3; ++edge_idx) {
-                size_t vertex_index_keep = get_final_index(mesh.indices[face_idx][edge_idx]);
-                size_t vertex_index_remove = get_final_index(mesh.indices[face_idx][(edge_idx + 1) % 3]);
+                if (partition >= 0 && (vertex_partition[vertices_index_mapping[mesh.indices[face_idx][edge_idx]]] != partition ||
+                                       vertex_partition[vertices_index_mapping[mesh.indices[face_idx][(edge_idx + 1) % 3]]] != partition))
+                    return false;
+                size_t vertex_index_keep = get_final_index(mesh.indices[face_idx][edge_idx], queue);
+                size_t vertex_index_remove = get_final_index(mesh.indices[face_idx][(edge_idx + 1) % 3], queue);
                 //check distance, skip long edges
                 if ((mesh.vertices[vertex_index_keep] - mesh.vertices[vertex_index_remove]).squaredNorm()
                         > max_edge_len_squared) {
                     continue;
                 }
+                int neighbor_to_remove_face_idx = triangles_neighbors[face_idx][edge_idx];
+                if (partition >= 0) {
+                    // The faces removed and the faces linked by the removal have to belong to this partition.
+                    auto owned = [&face_partition, partition](int idx) { return idx < 0 || face_partition[idx] == partition; };
+                    if (! owned(neighbor_to_remove_face_idx))
+                        return false;
+                    for (int face : { int(face_idx), neighbor_to_remove_face_idx })
+                        if (face >= 0)
+                            for (int n : triangles_neighbors[face])
+                                if (! owned(n))
+                                    return false;
+                }
                 // swap indexes if vertex_index_keep has higher dot product (we want to keep low dot product vertices)
                 if (min_vertex_dot_product[vertex_index_remove] < min_vertex_dot_product[vertex_index_keep]) {
                     size_t tmp = vertex_index_keep;
@@ -133,17 +188,56 @@ void its_short_edge_collpase(indexed_triangle_set &mesh, size_t target_triangle_
                     vertices_index_mapping[vertex_index_remove] = vertices_index_mapping[vertex_index_keep];
                 }
 
-                int neighbor_to_remove_face_idx = triangles_neighbors[face_idx][edge_idx];
                 // remove faces
                 remove_face(face_idx, neighbor_to_remove_face_idx);
                 remove_face(neighbor_to_remove_face_idx, face_idx);
-                allowed_face_removals-=2;
+                allowed-=2;
 
                 // break. this triangle is done
                 break;
             }
+            return true;
+        };
 
+        std::vector<size_t> deferred_faces;
+        if (num_partitions == 1) {
+            deferred_faces = face_indices;
+        } else {
+            update_vertex_partitions();
+            // Faces of each partition in the shuffled order.
+            std::vector<std::vector<size_t>> partition_faces(num_partitions);
+            for (size_t face_idx : face_indices)
+                partition_faces[face_partition[face_idx]].push_back(face_idx);
+            std::vector<std::vector<size_t>> partition_deferred(num_partitions);
+            std::vector<int>                 partition_removed(num_partitions, 0);
+            tbb::parallel_for(size_t(0), num_partitions, [&](size_t partition) {
+                const std::vector<size_t> &faces   = partition_faces[partition];
+                std::vector<size_t>       &deferred = partition_deferred[partition];
+                std::vector<size_t>        flatten_queue;
+                // Each partition gets its share of the allowed removals.
+                const int budget  = int(int64_t(allowed_face_removals) * int64_t(faces.size()) / int64_t(face_indices.size()));
+                int       allowed = budget;
+                for (size_t face_idx : faces) {
+                    if (allowed <= 0)
+                        break;
+                    if (! face_removal_flags[face_idx] && ! collapse_face(face_idx, int(partition), allowed, flatten_queue))
+                        deferred.push_back(face_idx);
+                }
+                partition_removed[partition] = budget - allowed;
+            });
+            for (size_t partition = 0; partition < num_partitions; ++ partition) {
+                allowed_face_removals -= partition_removed[partition];
+                append(deferred_faces, std::move(partition_deferred[partition]));
+            }
+        }
+        // Serial pass over the faces not processed in parallel.
+        for (const size_t &face_idx : deferred_faces) {
             if (allowed_face_removals <= 0) { break; }
+            if (face_removal_flags[face_idx]) {
+                // if face already removed from previous collapses, skip (each collapse removes two triangles [at least] )
+                continue;
+            }
+            collapse_face(face_idx, -1, allowed_face_removals, flatten_queue);
         }
 
         // filter face_indices, remove those that have been collapsed
@@ -168,7 +262,7 @@ void its_short_edge_collpase(indexed_triangle_set &mesh, size_t target_triangle_
     for (size_t idx : face_indices) {
         Vec3i final_face;
         for (size_t i = 0; i < 3; ++i) {
-            final_face[i] = get_final_index(mesh.indices[idx][i]);
+            final_face[i] = get_final_index(mesh.indices[idx][i], flatten_queue);
         }
         if (final_face[0] == final_face[1] || final_face[1] == final_face[2] || final_face[2] == final_face[0]) {
             continue; // discard degenerate triangles
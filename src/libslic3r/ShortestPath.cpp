@@ -181,6 +181,10 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 		}
 		EndPoint *initial_point = first_point;
 		EndPoint *last_point = nullptr;
+		// Number of end points in the KD tree and the number of them connected since the KD tree was built.
+		// The connected end points are filtered out by the closest point search, which slows down with their growing number.
+		size_t    kdtree_size      = end_points.size();
+		size_t    kdtree_connected = 0;
 
 		// Assign the closest point and distance to the end points.
 		for (EndPoint &end_point : end_points) {
@@ -301,6 +305,7 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 								equivalent_chain.merge(end_point1_other_chain_id, end_point2_other_chain_id));
 				end_point1.chain_id = chain_id;
 				end_point2.chain_id = chain_id;
+				kdtree_connected += 2;
 				assert(validate_graph_and_queue());
 				if (iter == 0) {
 					// Last iteration. There shall be exactly one or two end points waiting to be connected.
@@ -320,6 +325,18 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 				// This edge forms a loop. Update end_point1 and try another one.
 				++ iter;
 				end_point1.edge_out = nullptr;
+				if (2 * kdtree_connected > kdtree_size) {
+					// Remove the connected end points from the KD tree in a batch, once they make up most of it.
+					// The KD tree shrinks geometrically, thus the rebuilds take O(n log n) time in total.
+					std::vector<size_t> unconnected;
+					unconnected.reserve(kdtree_size - kdtree_connected);
+					for (size_t idx = 0; idx < end_points.size(); ++ idx)
+						if (end_points[idx].chain_id == 0)
+							unconnected.emplace_back(idx);
+					kdtree_size      = unconnected.size();
+					kdtree_connected = 0;
+					kdtree.build(unconnected);
+				}
 		    	// Update edge_out and distance.
 		    	size_t this_idx = &end_point1 - &end_points.front();
 		    	// Find the closest point to this end_point, which lies on a different extrusion path (filtered by the filter lambda).
@@ -393,9 +410,13 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 					} while (first_point != nullptr);
 				}
 			}
-			if (failed)
+			if (failed) {
 				// As a last resort, try a dumb algorithm, which is not sensitive to edge reversal constraints.
+				// It searches all the end points again.
+				if (kdtree_size < end_points.size())
+					kdtree.build(end_points.size());
 				out = chain_segments_closest_point<EndPoint, decltype(kdtree), CouldReverseFunc>(end_points, kdtree, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+			}
 		} else {
 			assert(! failed);
 		}
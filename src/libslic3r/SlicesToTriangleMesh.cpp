@@ -17,34 +17,28 @@
 
 namespace Slic3r {
 
-// Same as walls() but with identical higher and lower polygons.
-indexed_triangle_set inline straight_walls(const Polygon &plate,
-                                     double         lo_z,
-                                     double         hi_z)
+// Append the walls of the slice to out, which is reserved by the caller.
+void inline append_straight_walls(indexed_triangle_set &out,
+                                  const ExPolygons     &slice,
+                                  double                lo_z,
+                                  double                hi_z)
 {
-    return wall_strip(plate, lo_z, hi_z);
+    for (const ExPolygon &expoly : slice) {
+        wall_strip(out, expoly.contour, lo_z, hi_z);
+        for (const Polygon &h : expoly.holes)
+            wall_strip(out, h, lo_z, hi_z);
+    }
 }
 
-indexed_triangle_set inline straight_walls(const ExPolygon &plate,
-                                     double           lo_z,
-                                     double           hi_z)
+// Append the triangulated polygons to out, which is reserved by the caller.
+void inline append_triangles(indexed_triangle_set &out, const std::vector<Vec3d> &triangles)
 {
-    indexed_triangle_set ret = straight_walls(plate.contour, lo_z, hi_z);
-    for (auto &h : plate.holes)
-        its_merge(ret, straight_walls(h, lo_z, hi_z));
-
-    return ret;
-}
-
-indexed_triangle_set inline straight_walls(const ExPolygons &slice,
-                                     double            lo_z,
-                                     double            hi_z)
-{
-    indexed_triangle_set ret;
-    for (const ExPolygon &poly : slice)
-        its_merge(ret, straight_walls(poly, lo_z, hi_z));
-
-    return ret;
+    assert(triangles.size() % 3 == 0);
+    auto idx = int(out.vertices.size());
+    for (const Vec3d &v : triangles)
+        out.vertices.emplace_back(v.cast<float>());
+    for (size_t i = 0; i < triangles.size(); i += 3, idx += 3)
+        out.indices.emplace_back(idx, idx + 1, idx + 2);
 }
 
 indexed_triangle_set slices_to_mesh(
@@ -53,37 +47,72 @@ indexed_triangle_set slices_to_mesh(
     const std::vector<float> &     grid)
 {
     assert(slices.size() == grid.size());
+    if (slices.empty())
+        return {};
 
-    using Layers = std::vector<indexed_triangle_set>;
-    Layers layers(slices.size());
+    // One mesh per each pair of consecutive slices, the last two are the
+    // bottom and the top caps. All of them are generated in parallel,
+    // each into buffers sized upfront from the point counts of the slices.
     size_t len = slices.size() - 1;
+    std::vector<indexed_triangle_set> layers(len + 2);
+
+    execution::for_each(ex_tbb, size_t(0), layers.size(), [&slices, &layers, &grid, len, zmin](size_t i) {
+        indexed_triangle_set &out = layers[i];
+        std::vector<Vec3d> caps;
+        const ExPolygons *walls = nullptr;
+        double lo_z = 0., hi_z = 0.;
+
+        if (i < len) {
+            const ExPolygons &upper = slices[i + 1];
+            const ExPolygons &lower = slices[i];
+
+            // Small 0 area artefacts can be created by diff_ex, and the
+            // tesselation also can create 0 area triangles. These will be removed
+            // by its_remove_degenerate_faces.
+            caps = triangulate_expolygons_3d(diff_ex(lower, upper), grid[i], NORMALS_UP);
+            append(caps, triangulate_expolygons_3d(diff_ex(upper, lower), grid[i], NORMALS_DOWN));
+            walls = &upper;
+            lo_z  = grid[i];
+            hi_z  = grid[i + 1];
+        } else if (i == len) {
+            caps  = triangulate_expolygons_3d(slices.front(), zmin, NORMALS_DOWN);
+            walls = &slices.front();
+            lo_z  = zmin;
+            hi_z  = grid.front();
+        } else
+            caps  = triangulate_expolygons_3d(slices.back(), grid.back(), NORMALS_UP);
+
+        size_t wall_points = walls ? count_points(*walls) : 0;
+        out.vertices.reserve(caps.size() + 2 * wall_points);
+        out.indices.reserve(caps.size() / 3 + 2 * wall_points);
+        append_triangles(out, caps);
+        if (walls)
+            append_straight_walls(out, *walls, lo_z, hi_z);
+    }, 1);
+
+    // Concatenate the layers in parallel into a preallocated mesh rather than
+    // merging them pairwise, which copies the lower layers over and over.
+    std::vector<size_t> vertices_begin(layers.size() + 1, 0);
+    std::vector<size_t> indices_begin(layers.size() + 1, 0);
+    for (size_t i = 0; i < layers.size(); ++i) {
+        vertices_begin[i + 1] = vertices_begin[i] + layers[i].vertices.size();
+        indices_begin[i + 1]  = indices_begin[i] + layers[i].indices.size();
+    }
 
-    auto threads_cnt = execution::max_concurrency(ex_tbb);
-    execution::for_each(ex_tbb, size_t(0), len, [&slices, &layers, &grid](size_t i) {
-        const ExPolygons &upper = slices[i + 1];
-        const ExPolygons &lower = slices[i];
-
-        // Small 0 area artefacts can be created by diff_ex, and the
-        // tesselation also can create 0 area triangles. These will be removed
-        // by its_remove_degenerate_faces.
-        ExPolygons free_top = diff_ex(lower, upper);
-        ExPolygons overhang = diff_ex(upper, lower);
-        its_merge(layers[i], triangulate_expolygons_3d(free_top, grid[i], NORMALS_UP));
-        its_merge(layers[i], triangulate_expolygons_3d(overhang, grid[i], NORMALS_DOWN));
-        its_merge(layers[i], straight_walls(upper, grid[i], grid[i + 1]));
-        }, threads_cnt);
-
-    auto merge_fn = []( const indexed_triangle_set &a, const indexed_triangle_set &b ) {
-        indexed_triangle_set res{a}; its_merge(res, b); return res;
-    };
-
-    auto ret = execution::reduce(ex_tbb, layers.begin(), layers.end(),
-                                 indexed_triangle_set{}, merge_fn,
-                                 threads_cnt);
-
-    its_merge(ret, triangulate_expolygons_3d(slices.front(), zmin, NORMALS_DOWN));
-    its_merge(ret, straight_walls(slices.front(), zmin, grid.front()));
-    its_merge(ret, triangulate_expolygons_3d(slices.back(), grid.back(), NORMALS_UP));
+    indexed_triangle_set ret;
+    ret.vertices.resize(vertices_begin.back());
+    ret.indices.resize(indices_begin.back());
+    execution::for_each(ex_tbb, size_t(0), layers.size(),
+        [&layers, &ret, &vertices_begin, &indices_begin](size_t i) {
+            const indexed_triangle_set &layer = layers[i];
+            std::copy(layer.vertices.begin(), layer.vertices.end(), ret.vertices.begin() + vertices_begin[i]);
+            auto offset = int(vertices_begin[i]);
+            std::transform(layer.indices.begin(), layer.indices.end(), ret.indices.begin() + indices_begin[i],
+                           [offset](const stl_triangle_vertex_indices &face) -> stl_triangle_vertex_indices {
+                               return face.array() + offset;
+                           });
+            layers[i] = {};
+        });
 
     // FIXME: these repairs do not fix the mesh entirely. There will be cracks
     // in the output. It is very hard to do the meshing in a way that does not
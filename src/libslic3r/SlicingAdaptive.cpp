@@ -10,6 +10,8 @@
 #include <boost/log/trivial.hpp>
 #include <cfloat>
 
+#include <tbb/parallel_for.h>
+
 // Based on the work of Florens Waserfall (@platch on github)
 // and his paper
 // Florens Wasserfall, Norman Hendrich, Jianwei Zhang:
@@ -73,31 +75,67 @@ static inline float layer_height_from_slope(const SlicingAdaptive::FaceZ &face,
 
 void SlicingAdaptive::clear()
 {
-	m_faces.clear();
+	m_faces.reset();
+}
+
+const std::vector<SlicingAdaptive::FaceZ>& SlicingAdaptive::faces() const
+{
+	static const std::vector<FaceZ> empty;
+	return m_faces ? m_faces->faces : empty;
 }
 
 void SlicingAdaptive::prepare(const ModelObject &object)
 {
     this->clear();
 
-    TriangleMesh		 mesh			= object.raw_mesh();
-    const ModelInstance &first_instance = *object.instances.front();
-    mesh.transform(first_instance.get_matrix(), first_instance.is_left_handed());
-
-    // 1) Collect faces from mesh.
-    m_faces.reserve(mesh.facets_count());
-	for (stl_triangle_vertex_indices face : mesh.its.indices) {
-		stl_vertex vertex[3] = { mesh.its.vertices[face[0]], mesh.its.vertices[face[1]], mesh.its.vertices[face[2]] };
-		stl_vertex n         = face_normal_normalized(vertex);
-		std::pair<float, float> face_z_span {
-			std::min(std::min(vertex[0].z(), vertex[1].z()), vertex[2].z()),
-			std::max(std::max(vertex[0].z(), vertex[1].z()), vertex[2].z())
-		};
-		m_faces.emplace_back(FaceZ({ face_z_span, std::abs(n.z()), std::sqrt(n.x() * n.x() + n.y() * n.y()) }));
+    auto faces = std::make_shared<SlicingAdaptiveFaces>();
+    faces->instance_matrix = object.instances.front()->get_matrix();
+    for (const ModelVolume *v : object.volumes)
+        if (v->is_model_part())
+            faces->volumes.emplace_back(v->mesh_ptr(), v->get_matrix());
+
+    // Reuse the faces cached at the ModelObject if the meshes and their transformations did not change.
+    // Changing the quality or smoothing of the adaptive layer height profile does not recalculate them.
+    if (const SlicingAdaptiveFaces *cached = object.m_slicing_adaptive_faces.get();
+        cached != nullptr && cached->instance_matrix.matrix() == faces->instance_matrix.matrix() &&
+        std::equal(cached->volumes.begin(), cached->volumes.end(), faces->volumes.begin(), faces->volumes.end(),
+            [](const auto &l, const auto &r) { return l.first == r.first && l.second.matrix() == r.second.matrix(); })) {
+        m_faces = object.m_slicing_adaptive_faces;
+        return;
+    }
+
+    // 1) Collect faces from the meshes of the model parts, transformed by the first instance.
+    // The orientation of the faces does not matter, only the absolute values of the normal are used,
+    // thus the left handed transformations do not need to flip the faces.
+    size_t num_faces = 0;
+    for (const auto &volume : faces->volumes)
+        num_faces += volume.first->its.indices.size();
+    faces->faces.assign(num_faces, FaceZ{});
+    size_t first_face = 0;
+    for (const auto &volume : faces->volumes) {
+        const indexed_triangle_set &its   = volume.first->its;
+        const Transform3f           trafo = (faces->instance_matrix * volume.second).cast<float>();
+        FaceZ                      *out   = faces->faces.data() + first_face;
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &trafo, out](const tbb::blocked_range<size_t> &range) {
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                const stl_triangle_vertex_indices &face = its.indices[face_idx];
+                stl_vertex vertex[3] = { trafo * its.vertices[face[0]], trafo * its.vertices[face[1]], trafo * its.vertices[face[2]] };
+                stl_vertex n         = face_normal_normalized(vertex);
+                std::pair<float, float> face_z_span {
+                    std::min(std::min(vertex[0].z(), vertex[1].z()), vertex[2].z()),
+                    std::max(std::max(vertex[0].z(), vertex[1].z()), vertex[2].z())
+                };
+                out[face_idx] = FaceZ({ face_z_span, std::abs(n.z()), std::sqrt(n.x() * n.x() + n.y() * n.y()) });
+            }
+        });
+        first_face += its.indices.size();
     }
 
 	// 2) Sort faces lexicographically by their Z span.
-	std::sort(m_faces.begin(), m_faces.end(), [](const FaceZ &f1, const FaceZ &f2) { return f1.z_span < f2.z_span; });
+	std::sort(faces->faces.begin(), faces->faces.end(), [](const FaceZ &f1, const FaceZ &f2) { return f1.z_span < f2.z_span; });
+
+    object.m_slicing_adaptive_faces = faces;
+    m_faces = std::move(faces);
 }
 
 // current_facet is in/out parameter, rememebers the index of the last face of m_faces visited, 
@@ -106,6 +144,7 @@ void SlicingAdaptive::prepare(const ModelObject &object)
 // returns height of the next layer.
 float SlicingAdaptive::next_layer_height(const float print_z, float quality_factor, size_t &current_facet)
 {
+	const std::vector<FaceZ> &faces = this->faces();
 	float  height = (float)m_slicing_params.max_layer_height;
 
 	float  max_surface_deviation;
@@ -131,8 +170,8 @@ float SlicingAdaptive::next_layer_height(const float print_z, float quality_fact
 	size_t ordered_id = current_facet;
 	{
 		bool first_hit = false;
-		for (; ordered_id < m_faces.size(); ++ ordered_id) {
-	        const std::pair<float, float> &zspan = m_faces[ordered_id].z_span;
+		for (; ordered_id < faces.size(); ++ ordered_id) {
+	        const std::pair<float, float> &zspan = faces[ordered_id].z_span;
 	        // facet's minimum is higher than slice_z -> end loop
 			if (zspan.first >= print_z)
 				break;
@@ -147,7 +186,7 @@ float SlicingAdaptive::next_layer_height(const float print_z, float quality_fact
 				if (zspan.second < print_z + EPSILON)
 					continue;
 				// compute cusp-height for this facet and store minimum of all heights
-				height = std::min(height, layer_height_from_slope(m_faces[ordered_id], max_surface_deviation));
+				height = std::min(height, layer_height_from_slope(faces[ordered_id], max_surface_deviation));
 	        }
 		}
 	}
@@ -157,8 +196,8 @@ float SlicingAdaptive::next_layer_height(const float print_z, float quality_fact
 
 	// check for sloped facets inside the determined layer and correct height if necessary
 	if (height > float(m_slicing_params.min_layer_height)) {
-		for (; ordered_id < m_faces.size(); ++ ordered_id) {
-            const std::pair<float, float> &zspan = m_faces[ordered_id].z_span;
+		for (; ordered_id < faces.size(); ++ ordered_id) {
+            const std::pair<float, float> &zspan = faces[ordered_id].z_span;
             // facet's minimum is higher than slice_z + height -> end loop
 			if (zspan.first >= print_z + height)
 				break;
@@ -168,7 +207,7 @@ float SlicingAdaptive::next_layer_height(const float print_z, float quality_fact
 				continue;
 
 			// Compute cusp-height for this facet and check against height.
-            float reduced_height = layer_height_from_slope(m_faces[ordered_id], max_surface_deviation);
+            float reduced_height = layer_height_from_slope(faces[ordered_id], max_surface_deviation);
 
 			float z_diff = zspan.first - print_z;
 			if (reduced_height < z_diff) {
@@ -202,8 +241,9 @@ float SlicingAdaptive::next_layer_height(const float print_z, float quality_fact
 // to consider horizontal object features in slice thickness
 float SlicingAdaptive::horizontal_facet_distance(float z)
 {
-	for (size_t i = 0; i < m_faces.size(); ++ i) {
-        std::pair<float, float> zspan = m_faces[i].z_span;
+	const std::vector<FaceZ> &faces = this->faces();
+	for (size_t i = 0; i < faces.size(); ++ i) {
+        std::pair<float, float> zspan = faces[i].z_span;
         // facet's minimum is higher than max forward distance -> end loop
 		if (zspan.first > z + m_slicing_params.max_layer_height)
 			break;
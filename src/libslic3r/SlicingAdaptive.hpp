@@ -7,6 +7,9 @@
 #ifndef slic3r_SlicingAdaptive_hpp_
 #define slic3r_SlicingAdaptive_hpp_
 
+#include <memory>
+
+#include "Point.hpp"
 #include "Slicing.hpp"
 #include "admesh/stl.h"
 
@@ -14,12 +17,16 @@ namespace Slic3r
 {
 
 class ModelVolume;
+class TriangleMesh;
+struct SlicingAdaptiveFaces;
 
 class SlicingAdaptive
 {
 public:
     void  clear();
     void  set_slicing_parameters(SlicingParameters params) { m_slicing_params = params; }
+    // Collect the facets of the object's model parts sorted by Z. The facets are cached at the ModelObject,
+    // the cache is reused as long as the meshes and transformations of the ModelObject do not change.
     void  prepare(const ModelObject &object);
     // Return next layer height starting from the last print_z, using a quality measure
     // (quality in range from 0 to 1, 0 - highest quality at low layer heights, 1 - lowest print quality at high layer heights).
@@ -36,9 +43,22 @@ public:
 	};
 
 protected:
+	const std::vector<FaceZ>& faces() const;
+
 	SlicingParameters 		m_slicing_params;
 
-	std::vector<FaceZ>		m_faces;
+	// Shared with the cache of the ModelObject.
+	std::shared_ptr<const SlicingAdaptiveFaces> m_faces;
+};
+
+// Facets of the model parts of a ModelObject transformed by its first instance, sorted by their Z span,
+// together with the meshes and transformations they were calculated from.
+struct SlicingAdaptiveFaces
+{
+	Transform3d                                                             instance_matrix;
+	// Model parts with their transformations.
+	std::vector<std::pair<std::shared_ptr<const TriangleMesh>, Transform3d>> volumes;
+	std::vector<SlicingAdaptive::FaceZ>                                     faces;
 };
 
 }; // namespace Slic3r
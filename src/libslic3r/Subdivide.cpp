@@ -5,111 +5,155 @@
 #include "Subdivide.hpp"
 #include "Point.hpp"
 
+#include <algorithm>
+#include <map>
+#include <queue>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
 namespace Slic3r{
 
-indexed_triangle_set its_subdivide(
-    const indexed_triangle_set &its, float max_length)
+namespace {
+
+// same order as key order in Edge Divides
+struct VerticesSequence
 {
-    // same order as key order in Edge Divides
-    struct VerticesSequence
+    size_t   start_index;
+    bool     positive_order;
+    VerticesSequence(size_t start_index, bool positive_order = true)
+        : start_index(start_index), positive_order(positive_order){}
+};
+//                         vertex index small, big      vertex index from key.first to key.second
+using EdgeDivides = std::map<std::pair<size_t, size_t>, VerticesSequence>;
+
+// Edge of the input mesh longer than max_length, shared by all the triangles touching it.
+struct SplitEdge
+{
+    std::pair<size_t, size_t> key;
+    // Index of the first of floor(length / max_length) vertices created on the edge, ordered from key.first to key.second.
+    size_t                    start_index;
+};
+
+// Vertices seen by the subdivision of a chunk of triangles: Vertices of the input mesh and vertices on its split edges are indexed
+// as in the result, vertices created inside the triangles of the chunk are indexed from vertices.size() up and they are shifted
+// to their final place once the numbers of vertices created by all the chunks are known.
+struct ChunkVertices
+{
+    const std::vector<Vec3f>     &vertices;
+    const std::vector<SplitEdge> &split_edges;
+    std::vector<Vec3f>            local_vertices;
+    // Edges divided inside the triangle being subdivided, including the parts of the split edges.
+    EdgeDivides                   edge_divides;
+
+    const Vec3f& operator[](size_t idx) const
+        { return idx < vertices.size() ? vertices[idx] : local_vertices[idx - vertices.size()]; }
+    size_t       size() const { return vertices.size() + local_vertices.size(); }
+    void         push_back(const Vec3f &v) { local_vertices.push_back(v); }
+
+    const SplitEdge* find_split_edge(const std::pair<size_t, size_t> &key) const {
+        auto it = std::lower_bound(split_edges.begin(), split_edges.end(), key, [](const SplitEdge &l, const std::pair<size_t, size_t> &r) { return l.key < r; });
+        return it != split_edges.end() && it->key == key ? &(*it) : nullptr;
+    }
+};
+
+struct Edges
+{
+    Vec3f data[3];
+    Vec3f lengths;
+    Edges(const Vec3crd &indices, const std::vector<Vec3f> &vertices)
+        : lengths(-1.f,-1.f,-1.f)
     {
-        size_t   start_index;
-        bool     positive_order;
-        VerticesSequence(size_t start_index, bool positive_order = true)
-            : start_index(start_index), positive_order(positive_order){}
-    };
-    //                         vertex index small, big      vertex index from key.first to key.second
-    using EdgeDivides = std::map<std::pair<size_t, size_t>, VerticesSequence>;
-    struct Edges
+        const Vec3f &v0 = vertices[indices[0]];
+        const Vec3f &v1 = vertices[indices[1]];
+        const Vec3f &v2 = vertices[indices[2]];
+        data[0] = v0 - v1;
+        data[1] = v1 - v2;
+        data[2] = v2 - v0;
+    }
+    float abs_sum(const Vec3f &v)
     {
-        Vec3f data[3];
-        Vec3f lengths;
-        Edges(const Vec3crd &indices, const std::vector<Vec3f> &vertices)
-            : lengths(-1.f,-1.f,-1.f)
-        {
-            const Vec3f &v0 = vertices[indices[0]];
-            const Vec3f &v1 = vertices[indices[1]];
-            const Vec3f &v2 = vertices[indices[2]];
-            data[0] = v0 - v1;
-            data[1] = v1 - v2;
-            data[2] = v2 - v0;
-        }
-        float abs_sum(const Vec3f &v)
-        {
-            return abs(v[0]) + abs(v[1]) + abs(v[2]);
-        }
-        bool is_dividable(const float& max_length) {
-            Vec3f sum(abs_sum(data[0]), abs_sum(data[1]), abs_sum(data[2]));
-            Vec3i biggest_index = (sum[0] > sum[1]) ?
-                                      ((sum[0] > sum[2]) ?
-                                           ((sum[2] > sum[1]) ?
-                                                Vec3i(0, 2, 1) :
-                                                Vec3i(0, 1, 2)) :
-                                           Vec3i(2, 0, 1)) :
-                                      ((sum[1] > sum[2]) ?
-                                           ((sum[2] > sum[0]) ?
-                                                Vec3i(1, 2, 0) :
-                                                Vec3i(1, 0, 2)) :
-                                           Vec3i(2, 1, 0));
-            for (int i = 0; i < 3; i++) {
-                int index = biggest_index[i];
-                if (sum[index] <= max_length) return false;
-                lengths[index] = data[index].norm();
-                if (lengths[index] <= max_length) continue;
+        return abs(v[0]) + abs(v[1]) + abs(v[2]);
+    }
+    bool is_dividable(const float& max_length) {
+        Vec3f sum(abs_sum(data[0]), abs_sum(data[1]), abs_sum(data[2]));
+        Vec3i biggest_index = (sum[0] > sum[1]) ?
+                                  ((sum[0] > sum[2]) ?
+                                       ((sum[2] > sum[1]) ?
+                                            Vec3i(0, 2, 1) :
+                                            Vec3i(0, 1, 2)) :
+                                       Vec3i(2, 0, 1)) :
+                                  ((sum[1] > sum[2]) ?
+                                       ((sum[2] > sum[0]) ?
+                                            Vec3i(1, 2, 0) :
+                                            Vec3i(1, 0, 2)) :
+                                       Vec3i(2, 1, 0));
+        for (int i = 0; i < 3; i++) {
+            int index = biggest_index[i];
+            if (sum[index] <= max_length) return false;
+            lengths[index] = data[index].norm();
+            if (lengths[index] <= max_length) continue;
 
-                // calculate rest of lengths
-                for (int j = i + 1; j < 3; j++) {
-                    index     = biggest_index[j];
-                    lengths[index] = data[index].norm();
-                }
-                return true;
+            // calculate rest of lengths
+            for (int j = i + 1; j < 3; j++) {
+                index     = biggest_index[j];
+                lengths[index] = data[index].norm();
             }
-            return false;
+            return true;
         }
-    };
-    struct TriangleLengths
-    {
-        Vec3crd indices;
-        Vec3f l; // lengths
-        TriangleLengths(const Vec3crd &indices, const Vec3f &lengths)
-            : indices(indices), l(lengths)
-        {}
-
-        int get_divide_index(float max_length) {
-            if (l[0] > l[1] && l[0] > l[2]) {
-                if (l[0] > max_length) return 0;
-            } else if (l[1] > l[2]) {
-                if (l[1] > max_length) return 1;
-            } else {
-                if (l[2] > max_length) return 2;
-            }
-            return -1;
+        return false;
+    }
+};
+
+struct TriangleLengths
+{
+    Vec3crd indices;
+    Vec3f l; // lengths
+    TriangleLengths(const Vec3crd &indices, const Vec3f &lengths)
+        : indices(indices), l(lengths)
+    {}
+
+    int get_divide_index(float max_length) {
+        if (l[0] > l[1] && l[0] > l[2]) {
+            if (l[0] > max_length) return 0;
+        } else if (l[1] > l[2]) {
+            if (l[1] > max_length) return 1;
+        } else {
+            if (l[2] > max_length) return 2;
         }
+        return -1;
+    }
 
-        // divide triangle add new vertex to vertices
-        std::pair<TriangleLengths, TriangleLengths> divide(
-            int divide_index, float max_length,
-            std::vector<Vec3f> &vertices,
-            EdgeDivides &edge_divides)
-        {
-            // index to lengths and indices
-            size_t i0 = divide_index;
-            size_t i1 = (divide_index + 1) % 3;
-            size_t vi0   = indices[i0];
-            size_t vi1   = indices[i1];
-            std::pair<size_t, size_t> key(vi0, vi1);
-            bool key_swap = false;
-            if (key.first > key.second) {
-                std::swap(key.first, key.second);
-                key_swap = true;
-            }
+    // divide triangle add new vertex to vertices
+    std::pair<TriangleLengths, TriangleLengths> divide(
+        int divide_index, float max_length,
+        ChunkVertices &vertices)
+    {
+        EdgeDivides &edge_divides = vertices.edge_divides;
+        // index to lengths and indices
+        size_t i0 = divide_index;
+        size_t i1 = (divide_index + 1) % 3;
+        size_t vi0   = indices[i0];
+        size_t vi1   = indices[i1];
+        std::pair<size_t, size_t> key(vi0, vi1);
+        bool key_swap = false;
+        if (key.first > key.second) {
+            std::swap(key.first, key.second);
+            key_swap = true;
+        }
 
-            float length = l[divide_index];
-            size_t count_edge_vertices  = static_cast<size_t>(floor(length / max_length));
-            float count_edge_segments = static_cast<float>(count_edge_vertices + 1);
+        float length = l[divide_index];
+        size_t count_edge_vertices  = static_cast<size_t>(floor(length / max_length));
+        float count_edge_segments = static_cast<float>(count_edge_vertices + 1);
 
-            auto it = edge_divides.find(key);
-            if (it == edge_divides.end()) {
+        auto it = edge_divides.find(key);
+        if (it == edge_divides.end()) {
+            bool success;
+            if (const SplitEdge *split_edge = vertices.find_split_edge(key); split_edge) {
+                // Vertices shared with the other triangles along an edge of the input mesh.
+                std::tie(it, success) = edge_divides.insert({key, VerticesSequence(split_edge->start_index)});
+            } else {
                 // Create new vertices
                 VerticesSequence new_vs(vertices.size());
                 Vec3f vf = vertices[key.first]; // copy
@@ -119,103 +163,186 @@ indexed_triangle_set its_subdivide(
                     float ratio = i / count_edge_segments;
                     vertices.push_back(vf + dir * ratio);
                 }
-                bool     success;
                 std::tie(it,success) = edge_divides.insert({key, new_vs});
-                assert(success);
             }
-            const VerticesSequence &vs = it->second;
+            assert(success);
+        }
+        const VerticesSequence &vs = it->second;
 
-            int index_offset = count_edge_vertices/2;
-            size_t i2 = (divide_index + 2) % 3;
-            if (count_edge_vertices % 2 == 0 && key_swap == (l[i1] < l[i2])) {
-                --index_offset;
+        int index_offset = count_edge_vertices/2;
+        size_t i2 = (divide_index + 2) % 3;
+        if (count_edge_vertices % 2 == 0 && key_swap == (l[i1] < l[i2])) {
+            --index_offset;
+        }
+        int sign = (vs.positive_order) ? 1 : -1;
+        size_t new_index = vs.start_index + sign*index_offset;
+
+        size_t vi2   = indices[i2];
+        const Vec3f &v2 = vertices[vi2];
+        Vec3f        new_edge = v2 - vertices[new_index];
+        float        new_len  = new_edge.norm();
+
+        float ratio = (1 + index_offset) / count_edge_segments;
+        float len1 = l[i0] * ratio;
+        float len2 = l[i0] - len1;
+        if (key_swap) std::swap(len1, len2);
+
+        Vec3crd indices1(vi0, new_index, vi2);
+        Vec3f lengths1(len1, new_len, l[i2]);
+
+        Vec3crd indices2(new_index, vi1, vi2);
+        Vec3f lengths2(len2, l[i1], new_len);
+
+        // append key for divided edge when neccesary
+        if (index_offset > 0) {
+            std::pair<size_t, size_t> new_key(key.first, new_index);
+            bool new_key_swap = false;
+            if (new_key.first > new_key.second) {
+                std::swap(new_key.first, new_key.second);
+                new_key_swap = true;
             }
-            int sign = (vs.positive_order) ? 1 : -1;
-            size_t new_index = vs.start_index + sign*index_offset;
-
-            size_t vi2   = indices[i2];
-            const Vec3f &v2 = vertices[vi2];
-            Vec3f        new_edge = v2 - vertices[new_index];
-            float        new_len  = new_edge.norm();
-
-            float ratio = (1 + index_offset) / count_edge_segments;
-            float len1 = l[i0] * ratio;
-            float len2 = l[i0] - len1;
-            if (key_swap) std::swap(len1, len2);
-
-            Vec3crd indices1(vi0, new_index, vi2);
-            Vec3f lengths1(len1, new_len, l[i2]);
-
-            Vec3crd indices2(new_index, vi1, vi2);
-            Vec3f lengths2(len2, l[i1], new_len);
-
-            // append key for divided edge when neccesary
-            if (index_offset > 0) {
-                std::pair<size_t, size_t> new_key(key.first, new_index);
-                bool new_key_swap = false;
-                if (new_key.first > new_key.second) {
-                    std::swap(new_key.first, new_key.second);
-                    new_key_swap = true;
-                }
-                if (edge_divides.find(new_key) == edge_divides.end()) {
-                    // insert new
-                    edge_divides.insert({new_key, (new_key_swap) ?
-                        VerticesSequence(new_index - sign, !vs.positive_order)
-                        : vs});
-                }
+            if (edge_divides.find(new_key) == edge_divides.end()) {
+                // insert new
+                edge_divides.insert({new_key, (new_key_swap) ?
+                    VerticesSequence(new_index - sign, !vs.positive_order)
+                    : vs});
             }
+        }
 
-            if (index_offset < int(count_edge_vertices)-1) {
-                std::pair<size_t, size_t> new_key(new_index, key.second);
-                bool new_key_swap = false;
-                if (new_key.first > new_key.second) {
-                    std::swap(new_key.first, new_key.second);
-                    new_key_swap = true;
-                }
-                // bad order
-                if (edge_divides.find(new_key) == edge_divides.end()) {
-                    edge_divides.insert({new_key, (new_key_swap) ?
-                        VerticesSequence(vs.start_index + sign*(count_edge_vertices-1), !vs.positive_order)
-                        : VerticesSequence(new_index + sign, vs.positive_order)});
-                }
+        if (index_offset < int(count_edge_vertices)-1) {
+            std::pair<size_t, size_t> new_key(new_index, key.second);
+            bool new_key_swap = false;
+            if (new_key.first > new_key.second) {
+                std::swap(new_key.first, new_key.second);
+                new_key_swap = true;
+            }
+            // bad order
+            if (edge_divides.find(new_key) == edge_divides.end()) {
+                edge_divides.insert({new_key, (new_key_swap) ?
+                    VerticesSequence(vs.start_index + sign*(count_edge_vertices-1), !vs.positive_order)
+                    : VerticesSequence(new_index + sign, vs.positive_order)});
             }
-
-            return {TriangleLengths(indices1, lengths1),
-                    TriangleLengths(indices2, lengths2)};
         }
-    };
-    indexed_triangle_set result;
-    result.indices.reserve(its.indices.size());
+
+        return {TriangleLengths(indices1, lengths1),
+                TriangleLengths(indices2, lengths2)};
+    }
+};
+
+} // namespace
+
+indexed_triangle_set its_subdivide(
+    const indexed_triangle_set &its, float max_length)
+{
     const std::vector<Vec3f> &vertices = its.vertices;
-    result.vertices = vertices; // copy
-    std::queue<TriangleLengths> tls;
-
-    EdgeDivides edge_divides;
-    for (const Vec3crd &indices : its.indices) {
-        Edges edges(indices, vertices);
-        // speed up only sum not sqrt is apply
-        if (!edges.is_dividable(max_length)) {
-             // small triangle
-            result.indices.push_back(indices);
-            continue;
+
+    // 1) Collect the edges of the input mesh to be split. All the triangles sharing an edge take their vertices on the edge
+    // from here, thus the triangles may be subdivided independently.
+    std::vector<SplitEdge> split_edges(its.indices.size() * 3, SplitEdge{ { 0, 0 }, 0 });
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &vertices, &split_edges, max_length](const tbb::blocked_range<size_t> &range) {
+        for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx)
+            for (int i = 0; i < 3; ++ i) {
+                size_t vi0 = its.indices[face_idx][i];
+                size_t vi1 = its.indices[face_idx][(i + 1) % 3];
+                // Same length as calculated by Edges.
+                if ((vertices[vi0] - vertices[vi1]).norm() > max_length)
+                    split_edges[face_idx * 3 + i].key = std::make_pair(std::min(vi0, vi1), std::max(vi0, vi1));
+            }
+    });
+    split_edges.erase(std::remove_if(split_edges.begin(), split_edges.end(), [](const SplitEdge &e) { return e.key.first == e.key.second; }), split_edges.end());
+    tbb::parallel_sort(split_edges.begin(), split_edges.end(), [](const SplitEdge &l, const SplitEdge &r) { return l.key < r.key; });
+    split_edges.erase(std::unique(split_edges.begin(), split_edges.end(), [](const SplitEdge &l, const SplitEdge &r) { return l.key == r.key; }), split_edges.end());
+
+    // 2) Count the vertices on the split edges, create them in a pre-sized buffer.
+    indexed_triangle_set result;
+    {
+        std::vector<size_t> counts(split_edges.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, split_edges.size()), [&vertices, &split_edges, &counts, max_length](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                const std::pair<size_t, size_t> &key = split_edges[i].key;
+                counts[i] = static_cast<size_t>(floor((vertices[key.first] - vertices[key.second]).norm() / max_length));
+            }
+        });
+        size_t num_vertices = vertices.size();
+        for (size_t i = 0; i < split_edges.size(); ++ i) {
+            split_edges[i].start_index = num_vertices;
+            num_vertices += counts[i];
         }
-        TriangleLengths tl(indices, edges.lengths);
-        do {
-            int divide_index = tl.get_divide_index(max_length);
-            if (divide_index < 0) {
-                // no dividing
-                result.indices.push_back(tl.indices);
-                if (tls.empty()) break;
-                tl = tls.front(); // copy
-                tls.pop();
-            } else {
-                auto [tl1, tl2] = tl.divide(divide_index, max_length,
-                                            result.vertices, edge_divides);
-                tl = tl1;
-                tls.push(tl2);
+        result.vertices.resize(num_vertices);
+        std::copy(vertices.begin(), vertices.end(), result.vertices.begin());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, split_edges.size()), [&result, &split_edges, &counts](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                const SplitEdge &edge = split_edges[i];
+                Vec3f vf = result.vertices[edge.key.first]; // copy
+                Vec3f dir = result.vertices[edge.key.second] - vf;
+                float count_edge_segments = static_cast<float>(counts[i] + 1);
+                for (size_t j = 1; j <= counts[i]; ++ j)
+                    result.vertices[edge.start_index + j - 1] = vf + dir * (j / count_edge_segments);
             }
-        } while (true);
+        });
     }
+
+    // 3) Subdivide the triangles by chunks in parallel. The results are independent of the chunking.
+    struct Chunk {
+        std::vector<Vec3crd> indices;
+        std::vector<Vec3f>   vertices;
+    };
+    static constexpr const size_t chunk_size = 4096;
+    std::vector<Chunk> chunks((its.indices.size() + chunk_size - 1) / chunk_size);
+    const std::vector<Vec3f> &shared_vertices = result.vertices;
+    tbb::parallel_for(size_t(0), chunks.size(), [&its, &vertices, &shared_vertices, &split_edges, &chunks, max_length](size_t chunk_idx) {
+        Chunk                      &chunk = chunks[chunk_idx];
+        ChunkVertices               chunk_vertices{ shared_vertices, split_edges };
+        std::queue<TriangleLengths> tls;
+        for (size_t face_idx = chunk_idx * chunk_size; face_idx < std::min((chunk_idx + 1) * chunk_size, its.indices.size()); ++ face_idx) {
+            const Vec3crd &indices = its.indices[face_idx];
+            Edges edges(indices, vertices);
+            // speed up only sum not sqrt is apply
+            if (!edges.is_dividable(max_length)) {
+                 // small triangle
+                chunk.indices.push_back(indices);
+                continue;
+            }
+            chunk_vertices.edge_divides.clear();
+            TriangleLengths tl(indices, edges.lengths);
+            do {
+                int divide_index = tl.get_divide_index(max_length);
+                if (divide_index < 0) {
+                    // no dividing
+                    chunk.indices.push_back(tl.indices);
+                    if (tls.empty()) break;
+                    tl = tls.front(); // copy
+                    tls.pop();
+                } else {
+                    auto [tl1, tl2] = tl.divide(divide_index, max_length, chunk_vertices);
+                    tl = tl1;
+                    tls.push(tl2);
+                }
+            } while (true);
+        }
+        chunk.vertices = std::move(chunk_vertices.local_vertices);
+    });
+
+    // 4) Stitch the chunks into pre-sized buffers, shift the indices of the vertices created inside the triangles.
+    std::vector<size_t> index_offsets(chunks.size() + 1, 0);
+    std::vector<size_t> vertex_offsets(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); ++ i) {
+        index_offsets[i + 1]  = index_offsets[i] + chunks[i].indices.size();
+        vertex_offsets[i + 1] = vertex_offsets[i] + chunks[i].vertices.size();
+    }
+    const size_t num_shared_vertices = result.vertices.size();
+    result.indices.resize(index_offsets.back());
+    result.vertices.resize(num_shared_vertices + vertex_offsets.back());
+    tbb::parallel_for(size_t(0), chunks.size(), [&result, &chunks, &index_offsets, &vertex_offsets, num_shared_vertices](size_t chunk_idx) {
+        const Chunk &chunk = chunks[chunk_idx];
+        std::copy(chunk.vertices.begin(), chunk.vertices.end(), result.vertices.begin() + num_shared_vertices + vertex_offsets[chunk_idx]);
+        auto out = result.indices.begin() + index_offsets[chunk_idx];
+        for (const Vec3crd &indices : chunk.indices) {
+            for (int i = 0; i < 3; ++ i)
+                (*out)[i] = indices[i] < int(num_shared_vertices) ? indices[i] : indices[i] + int(vertex_offsets[chunk_idx]);
+            ++ out;
+        }
+    });
     return result;
 }
 
@@ -7,6 +7,7 @@
 
 #include "../AABBTreeLines.hpp"
 #include "../ClipperUtils.hpp"
+#include "../ProfilerTracy.hpp"
 #include "../Polygon.hpp"
 #include "../Polyline.hpp"
 #include "../MutablePolygon.hpp"
@@ -724,22 +725,26 @@ static void organic_smooth_branches_avoid_collisions(
 
     throw_on_cancel();
 
-    for (LayerIndex layer_idx = 0; layer_idx < LayerIndex(layer_collision_cache.size()); ++layer_idx)
-        if (LayerCollisionCache& l = layer_collision_cache[layer_idx]; !l.min_element_radius_known())
-            l.min_element_radius = 0;
-        else {
-            //FIXME
-            l.min_element_radius = 0;
-            std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> res = volumes.get_collision_lower_bound_area(layer_idx, l.min_element_radius);
-            assert(res.has_value());
-            l.collision_radius = res->first;
-            Lines alines = to_lines(res->second.get());
-            l.lines.reserve(alines.size());
-            for (const Line &line : alines)
-                l.lines.push_back({ unscaled<double>(line.a), unscaled<double>(line.b) });
-            l.aabbtree_lines = AABBTreeLines::build_aabb_tree_over_indexed_lines(l.lines);
-            throw_on_cancel();
-        }
+    // The layers are independent, build their AABB trees in parallel.
+    tbb::parallel_for(tbb::blocked_range<LayerIndex>(0, LayerIndex(layer_collision_cache.size())),
+        [&layer_collision_cache, &volumes, &throw_on_cancel](const tbb::blocked_range<LayerIndex> &range) {
+        for (LayerIndex layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+            if (LayerCollisionCache& l = layer_collision_cache[layer_idx]; !l.min_element_radius_known())
+                l.min_element_radius = 0;
+            else {
+                //FIXME
+                l.min_element_radius = 0;
+                std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> res = volumes.get_collision_lower_bound_area(layer_idx, l.min_element_radius);
+                assert(res.has_value());
+                l.collision_radius = res->first;
+                Lines alines = to_lines(res->second.get());
+                l.lines.reserve(alines.size());
+                for (const Line &line : alines)
+                    l.lines.push_back({ unscaled<double>(line.a), unscaled<double>(line.b) });
+                l.aabbtree_lines = AABBTreeLines::build_aabb_tree_over_indexed_lines(l.lines);
+                throw_on_cancel();
+            }
+    });
 
     struct CollisionSphere {
         const SupportElement& element;
@@ -1024,6 +1029,7 @@ void organic_draw_branches(
 
     std::function<void()>            throw_on_cancel)
 {
+    SLIC3R_PROFILE_ZONE();
     // All SupportElements are put into a layer independent storage to improve parallelization.
     std::vector<std::pair<SupportElement*, int>> elements_with_link_down;
     std::vector<size_t>                          linear_data_layers;
@@ -1215,9 +1221,13 @@ void organic_draw_branches(
                     }
                     std::vector<Polygons> slices = slice_mesh(partial_mesh, slice_z, mesh_slicing_params, throw_on_cancel);
                     bottom_contacts.clear();
-                    //FIXME parallelize?
-                    for (LayerIndex i = 0; i < LayerIndex(slices.size()); ++ i)
-                        slices[i] = diff_clipped(slices[i], volumes.getCollision(0, layer_begin + i, true)); //FIXME parent_uses_min || draw_area.element->state.use_min_xy_dist);
+                    // Long branches span many layers, clip them in parallel. The trees are already processed in parallel,
+                    // this nested loop helps when there are a few large trees only.
+                    tbb::parallel_for(tbb::blocked_range<LayerIndex>(0, LayerIndex(slices.size())),
+                        [&slices, &volumes, layer_begin](const tbb::blocked_range<LayerIndex> &range) {
+                        for (LayerIndex i = range.begin(); i < range.end(); ++ i)
+                            slices[i] = diff_clipped(slices[i], volumes.getCollision(0, layer_begin + i, true)); //FIXME parent_uses_min || draw_area.element->state.use_min_xy_dist);
+                    });
 
                     size_t num_empty = 0;
                     if (slices.front().empty()) {
@@ -1362,21 +1372,26 @@ void organic_draw_branches(
         if (tree.first_layer_id >= 0)
             num_layers = std::max(num_layers, size_t(tree.first_layer_id + tree.slices.size()));
 
+    // Gather the slices of all trees layer by layer. Each layer collects the trees in their order,
+    // thus the result does not depend on the scheduling.
     std::vector<Slice> slices(num_layers, Slice{});
-    for (Tree &tree : trees)
-        if (tree.first_layer_id >= 0) {
-            for (LayerIndex i = tree.first_layer_id; i != tree.first_layer_id + LayerIndex(tree.slices.size()); ++ i)
-                if (Slice &src = tree.slices[i - tree.first_layer_id]; ! src.polygons.empty()) {
-                    Slice &dst = slices[i];
-                    if (++ dst.num_branches > 1) {
-                        append(dst.polygons,        std::move(src.polygons));
-                        append(dst.bottom_contacts, std::move(src.bottom_contacts));
-                    } else {
-                        dst.polygons        = std::move(src.polygons);
-                        dst.bottom_contacts = std::move(src.bottom_contacts);
+    tbb::parallel_for(tbb::blocked_range<LayerIndex>(0, LayerIndex(num_layers)),
+        [&trees, &slices](const tbb::blocked_range<LayerIndex> &range) {
+        for (LayerIndex i = range.begin(); i < range.end(); ++ i) {
+            Slice &dst = slices[i];
+            for (Tree &tree : trees)
+                if (tree.first_layer_id >= 0 && i >= tree.first_layer_id && i < tree.first_layer_id + LayerIndex(tree.slices.size()))
+                    if (Slice &src = tree.slices[i - tree.first_layer_id]; ! src.polygons.empty()) {
+                        if (++ dst.num_branches > 1) {
+                            append(dst.polygons,        std::move(src.polygons));
+                            append(dst.bottom_contacts, std::move(src.bottom_contacts));
+                        } else {
+                            dst.polygons        = std::move(src.polygons);
+                            dst.bottom_contacts = std::move(src.bottom_contacts);
+                        }
                     }
-                }
         }
+    });
 
     tbb::parallel_for(tbb::blocked_range<size_t>(0, std::min(move_bounds.size(), slices.size()), 1),
         [&print_object, &config, &slices, &bottom_contacts, &top_contacts, &intermediate_layers, &layer_storage, &throw_on_cancel](const tbb::blocked_range<size_t> &range) {
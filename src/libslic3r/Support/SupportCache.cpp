@@ -0,0 +1,167 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "SupportCache.hpp"
+
+#include "../CacheIO.hpp"
+#include "../ExtrusionEntity.hpp"
+#include "../ExtrusionEntityCollection.hpp"
+#include "../Layer.hpp"
+#include "../Model.hpp"
+#include "../Print.hpp"
+
+#include <memory>
+
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r::FFFSupport::SupportCache {
+
+// Increase if the key or the file format changes, or if the support generator produces different results for the same input.
+static constexpr const uint32_t cache_version = 1;
+// "PSSC"
+static constexpr const uint32_t cache_magic   = 0x43535350;
+
+static std::string s_directory;
+
+void set_directory(const std::string &dir)
+{
+    s_directory = dir;
+}
+
+const std::string& directory()
+{
+    return s_directory;
+}
+
+bool enabled()
+{
+    return ! s_directory.empty();
+}
+
+static boost::filesystem::path cache_file_path(const std::string &key)
+{
+    return (boost::filesystem::path(s_directory) / (key + ".supports")).make_preferred();
+}
+
+std::string key(const PrintObject &print_object)
+{
+    CacheHasher hasher;
+    hasher.add(cache_version);
+
+    // Meshes with their support enforcers, blockers and paint-on supports, and the per volume configs.
+    hasher.add(*print_object.model_object());
+    hasher.add(print_object.trafo_centered());
+
+    // Layer heights, including the variable layer height profile and raft.
+    hasher.add(uint64_t(print_object.layer_count()));
+    for (const Layer *layer : print_object.layers()) {
+        hasher.add(layer->print_z);
+        hasher.add(layer->slice_z);
+        hasher.add(layer->height);
+    }
+
+    hasher.add(print_object.config());
+    for (const PrintRegion &region : print_object.all_regions())
+        hasher.add(region.config());
+    // Only the values of the print profile read by the support generator and by the support flows.
+    hasher.add(print_object.print()->config(), {
+        "nozzle_diameter", "filament_soluble", "first_layer_height", "first_layer_extrusion_width",
+        "min_layer_height", "max_layer_height", "gcode_resolution"
+    });
+
+    return hasher.hex_digest();
+}
+
+bool load(PrintObject &print_object, const std::string &key)
+{
+    assert(enabled());
+    boost::system::error_code   ec;
+    boost::filesystem::path     path = cache_file_path(key);
+    uintmax_t                   file_size = boost::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    boost::nowide::ifstream     ifs(path.string(), std::ios::binary);
+    if (! ifs)
+        return false;
+
+    CacheReader reader(ifs, size_t(file_size));
+    if (reader.read<uint32_t>() != cache_magic || reader.read<uint32_t>() != cache_version || reader.read_string() != key)
+        return false;
+
+    print_object.clear_support_layers();
+    for (uint32_t num_layers = reader.read_count(sizeof(uint64_t)), i = 0; i < num_layers && ! reader.failed(); ++ i) {
+        auto id           = reader.read<uint64_t>();
+        auto interface_id = reader.read<uint64_t>();
+        auto height       = reader.read<double>();
+        auto print_z      = reader.read<double>();
+        auto slice_z      = reader.read<double>();
+        SupportLayerPtrs &support_layers = print_object.support_layers();
+        SupportLayer &layer = **print_object.insert_support_layer(support_layers.end(), size_t(id), size_t(interface_id), height, print_z, slice_z);
+        layer.support_islands = reader.read_expolygons();
+        // Inflated the same way as SupportCommon does.
+        layer.support_islands_bboxes.reserve(layer.support_islands.size());
+        for (const ExPolygon &island : layer.support_islands)
+            layer.support_islands_bboxes.emplace_back(get_extents(island).inflated(SCALED_EPSILON));
+        if (std::unique_ptr<ExtrusionEntity> fills = reader.read_entity(); fills && fills->is_collection())
+            layer.support_fills = std::move(static_cast<ExtrusionEntityCollection&>(*fills));
+        else
+            break;
+    }
+    if (reader.failed()) {
+        BOOST_LOG_TRIVIAL(error) << "Support cache file " << path.string() << " is corrupted, generating the supports again.";
+        print_object.clear_support_layers();
+        return false;
+    }
+    BOOST_LOG_TRIVIAL(debug) << "Support layers of " << print_object.model_object()->name << " loaded from cache " << path.string();
+    return true;
+}
+
+bool store(const PrintObject &print_object, const std::string &key)
+{
+    assert(enabled());
+    boost::system::error_code   ec;
+    boost::filesystem::create_directories(s_directory, ec);
+    boost::filesystem::path     path = cache_file_path(key);
+    // Write into a temporary file, then rename, so that concurrent processes sharing the cache never read a partial file.
+    boost::filesystem::path     path_tmp = path.parent_path() / boost::filesystem::unique_path(key + "-%%%%-%%%%.tmp");
+    bool                        success  = false;
+    {
+        boost::nowide::ofstream ofs(path_tmp.string(), std::ios::binary);
+        if (ofs) {
+            CacheWriter writer(ofs);
+            writer.write(cache_magic);
+            writer.write(cache_version);
+            writer.write(key);
+            writer.write(uint32_t(print_object.support_layer_count()));
+            success = true;
+            for (const SupportLayer *layer : print_object.support_layers()) {
+                writer.write(uint64_t(layer->id()));
+                writer.write(uint64_t(layer->interface_id()));
+                writer.write(double(layer->height));
+                writer.write(double(layer->print_z));
+                writer.write(double(layer->slice_z));
+                writer.write(layer->support_islands);
+                if (! writer.write(layer->support_fills)) {
+                    success = false;
+                    break;
+                }
+            }
+            ofs.close();
+            success &= ! ofs.fail();
+        }
+    }
+    if (success) {
+        boost::filesystem::rename(path_tmp, path, ec);
+        success = ! ec;
+    }
+    if (! success) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to store support layers of " << print_object.model_object()->name << " into cache " << path.string();
+        boost::filesystem::remove(path_tmp, ec);
+    }
+    return success;
+}
+
+} // namespace Slic3r::FFFSupport::SupportCache
@@ -0,0 +1,44 @@
+///|/ Copyright (c) Prusa Research 2023 Vojtěch Bubník @bubnikv
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_SupportCache_hpp_
+#define slic3r_SupportCache_hpp_
+
+#include <string>
+
+namespace Slic3r {
+
+class PrintObject;
+
+namespace FFFSupport {
+
+// Optional persistent cache of the support layers of a PrintObject (support_islands and support_fills of all SupportLayers),
+// shared by all processes pointed to the same directory. Disabled by default.
+// The cache is keyed by an MD5 hash of the support generator inputs: the meshes, painted facets and transformations of the
+// ModelVolumes, the object transformation, the Z coordinates of the object layers, the PrintObjectConfig, the configs
+// of the printing regions and the few PrintConfig values used by the support generator. Changing for example temperatures
+// or speeds of the print profile thus keeps the cached supports valid.
+namespace SupportCache {
+
+// Empty directory disables the cache.
+void                set_directory(const std::string &dir);
+const std::string&  directory();
+bool                enabled();
+
+// Hex string of the cache key. Valid after the object has been sliced.
+std::string         key(const PrintObject &print_object);
+// Replace the support layers of print_object with the cached ones.
+// Returns false if not cached or if the cached file is not readable, then the object is left without support layers.
+bool                load(PrintObject &print_object, const std::string &key);
+// Store the support layers of print_object. Returns false if the support layers contain extrusions, which could not be
+// serialized, or if the file could not be written.
+bool                store(const PrintObject &print_object, const std::string &key);
+
+} // namespace SupportCache
+
+} // namespace FFFSupport
+
+} // namespace Slic3r
+
+#endif // slic3r_SupportCache_hpp_
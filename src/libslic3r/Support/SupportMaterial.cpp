@@ -2316,10 +2316,13 @@ void PrintObjectSupportMaterial::generate_base_layers(
         // No top contacts -> no intermediate layers will be produced.
         return;
 
+    const SlicingParameters &slicing_params = m_slicing_params;
+    const float              gap_xy_scaled  = float(scale_(m_support_params.gap_xy));
+
     BOOST_LOG_TRIVIAL(debug) << "PrintObjectSupportMaterial::generate_base_layers() in parallel - start";
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, intermediate_layers.size()),
-        [&object, &bottom_contacts, &top_contacts, &intermediate_layers, &layer_support_areas](const tbb::blocked_range<size_t>& range) {
+        [this, &object, &bottom_contacts, &top_contacts, &intermediate_layers, &layer_support_areas, &slicing_params, gap_xy_scaled](const tbb::blocked_range<size_t>& range) {
             // index -2 means not initialized yet, -1 means intialized and decremented to 0 and then -1.
             int idx_top_contact_above           = -2;
             int idx_bottom_contact_overlapping  = -2;
@@ -2424,6 +2427,14 @@ void PrintObjectSupportMaterial::generate_base_layers(
                         ApplySafetyOffset::Yes); // safety offset to merge the touching source polygons
                 layer_intermediate.layer_type = SupporLayerType::Base;
 
+                // Trim the base layer by the object right away instead of waiting for all the base layers to be generated.
+                if (! layer_intermediate.polygons.empty() && layer_intermediate.print_z >= slicing_params.raft_contact_top_z + EPSILON) {
+                    // Counting down, thus the cached index of the object layer overlapping the layer above cannot be reused.
+                    size_t idx_object_layer_overlapping = size_t(-1);
+                    this->trim_support_layer_by_object(object, layer_intermediate, idx_object_layer_overlapping,
+                        slicing_params.gap_support_object, slicing_params.gap_object_support, gap_xy_scaled);
+                }
+
         #if 0
                     // coordf_t fillet_radius_scaled = scale_(m_object_config->support_material_spacing);
                     // Fillet the base polygons and trim them again with the top, interface and contact layers.
@@ -2444,14 +2455,8 @@ void PrintObjectSupportMaterial::generate_base_layers(
     BOOST_LOG_TRIVIAL(debug) << "PrintObjectSupportMaterial::generate_base_layers() in parallel - end";
 
 #ifdef SLIC3R_DEBUG
-    for (SupportGeneratorLayersPtr::const_iterator it = intermediate_layers.begin(); it != intermediate_layers.end(); ++it)
-        ::Slic3r::SVG::export_expolygons(
-            debug_out_path("support-intermediate-layers-untrimmed-%d-%lf.svg", iRun, (*it)->print_z),
-            union_ex((*it)->polygons));
     ++ iRun;
 #endif /* SLIC3R_DEBUG */
-
-    this->trim_support_layers_by_object(object, intermediate_layers, m_slicing_params.gap_support_object, m_slicing_params.gap_object_support, m_support_params.gap_xy);
 }
 
 void PrintObjectSupportMaterial::trim_support_layers_by_object(
@@ -2483,51 +2488,62 @@ void PrintObjectSupportMaterial::trim_support_layers_by_object(
             for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
                 SupportGeneratorLayer &support_layer = *nonempty_layers[idx_layer];
                 // BOOST_LOG_TRIVIAL(trace) << "Support generator - trim_support_layers_by_object - trimmming non-empty layer " << idx_layer << " of " << nonempty_layers.size();
-                assert(! support_layer.polygons.empty() && support_layer.print_z >= m_slicing_params.raft_contact_top_z + EPSILON);
-                // Find the overlapping object layers including the extra above / below gap.
-                coordf_t z_threshold = support_layer.bottom_print_z() - gap_extra_below + EPSILON;
-                idx_object_layer_overlapping = idx_higher_or_equal(
-                    object.layers().begin(), object.layers().end(), idx_object_layer_overlapping,
-                    [z_threshold](const Layer *layer){ return layer->print_z >= z_threshold; });
-                // Collect all the object layers intersecting with this layer.
-                Polygons polygons_trimming;
-                size_t i = idx_object_layer_overlapping;
-                for (; i < object.layers().size(); ++ i) {
-                    const Layer &object_layer = *object.layers()[i];
-                    if (object_layer.bottom_z() > support_layer.print_z + gap_extra_above - EPSILON)
-                        break;
-                    polygons_append(polygons_trimming, offset(object_layer.lslices, gap_xy_scaled, SUPPORT_SURFACES_OFFSET_PARAMETERS));
-                }
-                if (! m_slicing_params.soluble_interface && m_object_config->thick_bridges) {
-                    // Collect all bottom surfaces, which will be extruded with a bridging flow.
-                    for (; i < object.layers().size(); ++ i) {
-                        const Layer &object_layer = *object.layers()[i];
-                        bool some_region_overlaps = false;
-                        for (LayerRegion *region : object_layer.regions()) {
-                            coordf_t bridging_height = region->region().bridging_height_avg(*m_print_config);
-                            if (object_layer.print_z - bridging_height > support_layer.print_z + gap_extra_above - EPSILON)
-                                break;
-                            some_region_overlaps = true;
-                            polygons_append(polygons_trimming, 
-                                offset(region->fill_surfaces().filter_by_type(stBottomBridge), gap_xy_scaled, SUPPORT_SURFACES_OFFSET_PARAMETERS));
-                            if (region->region().config().overhangs.value)
-                                // Add bridging perimeters.
-                                SupportMaterialInternal::collect_bridging_perimeter_areas(region->perimeters(), gap_xy_scaled, polygons_trimming);
-                        }
-                        if (! some_region_overlaps)
-                            break;
-                    }
-                }
-                // $layer->slices contains the full shape of layer, thus including
-                // perimeter's width. $support contains the full shape of support
-                // material, thus including the width of its foremost extrusion.
-                // We leave a gap equal to a full extrusion width.
-                support_layer.polygons = diff(support_layer.polygons, polygons_trimming);
+                this->trim_support_layer_by_object(object, support_layer, idx_object_layer_overlapping, gap_extra_above, gap_extra_below, gap_xy_scaled);
             }
         });
     BOOST_LOG_TRIVIAL(debug) << "PrintObjectSupportMaterial::trim_support_layers_by_object() in parallel - end";
 }
 
+void PrintObjectSupportMaterial::trim_support_layer_by_object(
+    const PrintObject   &object,
+    SupportGeneratorLayer &support_layer,
+    size_t              &idx_object_layer_overlapping,
+    const coordf_t       gap_extra_above,
+    const coordf_t       gap_extra_below,
+    const float          gap_xy_scaled) const
+{
+    assert(! support_layer.polygons.empty() && support_layer.print_z >= m_slicing_params.raft_contact_top_z + EPSILON);
+    // Find the overlapping object layers including the extra above / below gap.
+    coordf_t z_threshold = support_layer.bottom_print_z() - gap_extra_below + EPSILON;
+    idx_object_layer_overlapping = idx_higher_or_equal(
+        object.layers().begin(), object.layers().end(), idx_object_layer_overlapping,
+        [z_threshold](const Layer *layer){ return layer->print_z >= z_threshold; });
+    // Collect all the object layers intersecting with this layer.
+    Polygons polygons_trimming;
+    size_t i = idx_object_layer_overlapping;
+    for (; i < object.layers().size(); ++ i) {
+        const Layer &object_layer = *object.layers()[i];
+        if (object_layer.bottom_z() > support_layer.print_z + gap_extra_above - EPSILON)
+            break;
+        polygons_append(polygons_trimming, offset(object_layer.lslices, gap_xy_scaled, SUPPORT_SURFACES_OFFSET_PARAMETERS));
+    }
+    if (! m_slicing_params.soluble_interface && m_object_config->thick_bridges) {
+        // Collect all bottom surfaces, which will be extruded with a bridging flow.
+        for (; i < object.layers().size(); ++ i) {
+            const Layer &object_layer = *object.layers()[i];
+            bool some_region_overlaps = false;
+            for (LayerRegion *region : object_layer.regions()) {
+                coordf_t bridging_height = region->region().bridging_height_avg(*m_print_config);
+                if (object_layer.print_z - bridging_height > support_layer.print_z + gap_extra_above - EPSILON)
+                    break;
+                some_region_overlaps = true;
+                polygons_append(polygons_trimming, 
+                    offset(region->fill_surfaces().filter_by_type(stBottomBridge), gap_xy_scaled, SUPPORT_SURFACES_OFFSET_PARAMETERS));
+                if (region->region().config().overhangs.value)
+                    // Add bridging perimeters.
+                    SupportMaterialInternal::collect_bridging_perimeter_areas(region->perimeters(), gap_xy_scaled, polygons_trimming);
+            }
+            if (! some_region_overlaps)
+                break;
+        }
+    }
+    // $layer->slices contains the full shape of layer, thus including
+    // perimeter's width. $support contains the full shape of support
+    // material, thus including the width of its foremost extrusion.
+    // We leave a gap equal to a full extrusion width.
+    support_layer.polygons = diff(support_layer.polygons, polygons_trimming);
+}
+
 /*
 void PrintObjectSupportMaterial::clip_by_pillars(
     const PrintObject   &object,
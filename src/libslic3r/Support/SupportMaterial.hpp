@@ -41,6 +41,7 @@ public:
 	void 		generate(PrintObject &object);
 
 private:
+	using SupportGeneratorLayer        = FFFSupport::SupportGeneratorLayer;
 	using SupportGeneratorLayersPtr    = FFFSupport::SupportGeneratorLayersPtr;
 	using SupportGeneratorLayerStorage = FFFSupport::SupportGeneratorLayerStorage;
 	using SupportParameters            = FFFSupport::SupportParameters;
@@ -85,6 +86,15 @@ private:
 	    const coordf_t       gap_extra_above,
 	    const coordf_t       gap_extra_below,
 	    const coordf_t       gap_xy) const;
+	// Trim a single non-empty support layer above the raft by the object.
+	// idx_object_layer_overlapping caches the search for the object layers overlapping the support layer, see idx_higher_or_equal().
+	void trim_support_layer_by_object(
+	    const PrintObject   &object,
+	    SupportGeneratorLayer &support_layer,
+	    size_t              &idx_object_layer_overlapping,
+	    const coordf_t       gap_extra_above,
+	    const coordf_t       gap_extra_below,
+	    const float          gap_xy_scaled) const;
 
 /*
 	void generate_pillars_shape();
@@ -23,6 +23,9 @@
 #include "../Utils.hpp"
 #include "../format.hpp"
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <string_view>
 
 #include <boost/log/trivial.hpp>
@@ -223,36 +226,107 @@ void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord
     // Now that required_avoidance_limit contains the maximum of ild and regular required radius just copy.
     std::vector<RadiusLayerPair> relevant_collision_radiis{ radius_until_layer.begin(), radius_until_layer.end() };
 
-    // Calculate the relevant collisions
-    calculateCollision(relevant_collision_radiis, throw_on_cancel);
-
     // calculate a separate Collisions with all holes removed. These are relevant for some avoidances that try to avoid holes (called safe)
     std::vector<RadiusLayerPair> relevant_hole_collision_radiis;
     for (RadiusLayerPair key : relevant_avoidance_radiis)
         if (key.first < m_increase_until_radius + m_current_min_xy_dist_delta)
             relevant_hole_collision_radiis.emplace_back(key);
 
-    // Calculate collisions without holes, built from regular collision
-    calculateCollisionHolefree(relevant_hole_collision_radiis, throw_on_cancel);
-    // Let placables be calculated from calculateAvoidance() for better parallelization.
+    // Instead of calculating all collisions, then all hole free collisions and placeables, then all avoidances and wall restrictions,
+    // each of the calculations is started as soon as the collisions it reads are available. The collisions of the individual radii
+    // take very different time, thus waiting for all of them left most of the cores idle.
+    struct PrecalculationTask {
+        std::function<void()>               run;
+        // Number of tasks this task waits for.
+        std::atomic<int>                    num_pending { 0 };
+        std::vector<PrecalculationTask*>    successors;
+    };
+    // std::deque for pointer stability.
+    std::deque<PrecalculationTask> tasks;
+    auto add_task = [&tasks](std::function<void()> &&run) -> PrecalculationTask* {
+        PrecalculationTask &task = tasks.emplace_back();
+        task.run = std::move(run);
+        return &task;
+    };
+    // A dependency on a task, which is not scheduled, is ignored. The data is then calculated lazily by the getters.
+    auto depend_on = [](PrecalculationTask *task, PrecalculationTask *dependency) {
+        if (dependency) {
+            dependency->successors.emplace_back(task);
+            ++ task->num_pending;
+        }
+    };
+
+    // Calculate the relevant collisions. Placeables of radius 0 are calculated together with the collision of radius 0.
+    std::map<coord_t, PrecalculationTask*> collision_tasks;
+    for (RadiusLayerPair key : relevant_collision_radiis)
+        collision_tasks[key.first] = add_task([this, key, throw_on_cancel]{ calculateCollision(key.first, key.second, throw_on_cancel); });
+    auto collision_task = [this, &collision_tasks](coord_t radius, bool min_xy_dist) -> PrecalculationTask* {
+        auto it = collision_tasks.find(this->ceilRadius(radius, min_xy_dist));
+        return it == collision_tasks.end() ? nullptr : it->second;
+    };
+
+    // Collisions without holes are built from the regular collision of m_increase_until_radius.
+    std::map<coord_t, PrecalculationTask*> collision_holefree_tasks;
+    for (RadiusLayerPair key : relevant_hole_collision_radiis) {
+        PrecalculationTask *task = add_task([this, key, throw_on_cancel]{ calculateCollisionHolefree({ key }, throw_on_cancel); });
+        depend_on(task, collision_task(m_increase_until_radius, false));
+        collision_holefree_tasks[key.first] = task;
+    }
+
+    // Placeables are calculated from the placeables of radius 0 and the collision of layer 0.
+    std::map<coord_t, PrecalculationTask*> placeable_tasks;
     if (m_support_rests_on_model)
-        calculatePlaceables(relevant_avoidance_radiis, throw_on_cancel);
+        for (RadiusLayerPair key : relevant_avoidance_radiis) {
+            PrecalculationTask *task = add_task([this, key, throw_on_cancel]{ calculatePlaceables(key.first, key.second, throw_on_cancel); });
+            depend_on(task, collision_task(0, true));
+            depend_on(task, collision_task(key.first, true));
+            placeable_tasks[key.first] = task;
+        }
 
-    auto t_coll = std::chrono::high_resolution_clock::now();
+    // Each avoidance propagates bottom up serially, thus each avoidance is a separate task.
+    for (const AvoidanceTask &avoidance : this->avoidanceTasks(relevant_avoidance_radiis, true, m_support_rests_on_model)) {
+        PrecalculationTask *task = add_task([this, avoidance, throw_on_cancel]{ calculateAvoidance(avoidance, throw_on_cancel); });
+        if ((avoidance.slow() || avoidance.holefree()) && avoidance.radius < m_increase_until_radius + m_current_min_xy_dist_delta) {
+            auto it = collision_holefree_tasks.find(avoidance.radius);
+            depend_on(task, it == collision_holefree_tasks.end() ? nullptr : it->second);
+        }
+        // Layer 0 of any avoidance is the collision.
+        depend_on(task, collision_task(avoidance.radius, true));
+        if (avoidance.to_model) {
+            auto it = placeable_tasks.find(ceilRadius(avoidance.radius));
+            depend_on(task, it == placeable_tasks.end() ? nullptr : it->second);
+        }
+    }
+
+    // Wall restrictions intersect the collision of radius 0 with the collision of the layer below.
+    for (RadiusLayerPair key : relevant_avoidance_radiis) {
+        PrecalculationTask *task = add_task([this, key, throw_on_cancel]{ calculateWallRestrictions({ key }, throw_on_cancel); });
+        depend_on(task, collision_task(0, false));
+        depend_on(task, collision_task(0, true));
+        depend_on(task, collision_task(key.first, true));
+    }
 
-    // Calculate the relevant avoidances in parallel as far as possible
     {
         tbb::task_group task_group;
-        task_group.run([this, relevant_avoidance_radiis, throw_on_cancel]{ calculateAvoidance(relevant_avoidance_radiis, true, m_support_rests_on_model, throw_on_cancel); });
-        task_group.run([this, relevant_avoidance_radiis, throw_on_cancel]{ calculateWallRestrictions(relevant_avoidance_radiis, throw_on_cancel); });
+        std::function<void(PrecalculationTask&)> spawn = [&task_group, &spawn](PrecalculationTask &task) {
+            task_group.run([&task, &spawn]{
+                task.run();
+                for (PrecalculationTask *successor : task.successors)
+                    if (-- successor->num_pending == 0)
+                        spawn(*successor);
+            });
+        };
+        // All dependencies are registered before the first task is started.
+        for (PrecalculationTask &task : tasks)
+            if (task.num_pending == 0)
+                spawn(task);
         task_group.wait();
     }
     auto t_end = std::chrono::high_resolution_clock::now();
-    auto dur_col = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_coll - t_start).count();
-    auto dur_avo = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_coll).count();
+    auto dur = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_start).count();
 
 //    m_precalculated = true;
-    BOOST_LOG_TRIVIAL(info) << "Precalculating collision took" << dur_col << " ms. Precalculating avoidance took " << dur_avo << " ms.";
+    BOOST_LOG_TRIVIAL(info) << "Precalculating collisions and avoidances took " << dur << " ms.";
 
 #if 0
     // Paint caches into SVGs:
@@ -608,21 +682,9 @@ void TreeModelVolumes::calculateCollisionHolefree(const std::vector<RadiusLayerP
     });
 }
 
-void TreeModelVolumes::calculateAvoidance(const std::vector<RadiusLayerPair> &keys, bool to_build_plate, bool to_model, std::function<void()> throw_on_cancel)
+std::vector<TreeModelVolumes::AvoidanceTask> TreeModelVolumes::avoidanceTasks(const std::vector<RadiusLayerPair> &keys, bool to_build_plate, bool to_model) const
 {
     // For every RadiusLayer pair there are 3 avoidances that have to be calculated.
-    // Prepare tasks for parallelization.
-    struct AvoidanceTask {
-        AvoidanceType   type;
-        coord_t         radius;
-        LayerIndex      max_required_layer;
-        bool            to_model;
-        LayerIndex      start_layer;
-
-        bool slow()     const { return this->type == AvoidanceType::Slow; }
-        bool holefree() const { return this->type == AvoidanceType::FastSafe; }
-    };
-
     std::vector<AvoidanceTask> avoidance_tasks;
     avoidance_tasks.reserve((int(to_build_plate) + int(to_model)) * keys.size() * size_t(AvoidanceType::Count));
 
@@ -643,54 +705,20 @@ void TreeModelVolumes::calculateAvoidance(const std::vector<RadiusLayerPair> &ke
             (! task.holefree() || task.radius < m_increase_until_radius + m_current_min_xy_dist_delta))
             avoidance_tasks.emplace_back(task);
     }
+    return avoidance_tasks;
+}
+
+void TreeModelVolumes::calculateAvoidance(const std::vector<RadiusLayerPair> &keys, bool to_build_plate, bool to_model, std::function<void()> throw_on_cancel)
+{
+    // Prepare tasks for parallelization.
+    std::vector<AvoidanceTask> avoidance_tasks = this->avoidanceTasks(keys, to_build_plate, to_model);
 
     throw_on_cancel();
 
     tbb::parallel_for(tbb::blocked_range<size_t>(0, avoidance_tasks.size(), 1),
-        [this, &avoidance_tasks, &throw_on_cancel](const tbb::blocked_range<size_t> &range) {
+        [&](const tbb::blocked_range<size_t> &range) {
         for (size_t task_idx = range.begin(); task_idx < range.end(); ++ task_idx) {
-            const AvoidanceTask &task = avoidance_tasks[task_idx];
-            assert(! task.holefree() || task.radius < m_increase_until_radius + m_current_min_xy_dist_delta);
-            if (task.to_model)
-                // ensuring Placeableareas are calculated
-                //FIXME pass throw_on_cancel
-                getPlaceableAreas(task.radius, task.max_required_layer, throw_on_cancel);
-            // The following loop propagating avoidance regions bottom up is inherently serial.
-            const bool  collision_holefree = (task.slow() || task.holefree()) && task.radius < m_increase_until_radius + m_current_min_xy_dist_delta;
-            const float max_move           = task.slow() ? m_max_move_slow : m_max_move;
-            // Limiting the offset step so that unioning the shrunk latest_avoidance with the current layer collisions
-            // will not create gaps in the resulting avoidance region letting a tree support branch tunneling through an object wall.
-            float move_step      = 1.9 * std::max(task.radius, m_current_min_xy_dist);
-            int   move_steps     = round_up_divide<int>(max_move, move_step);
-            assert(move_steps > 0);
-            float last_move_step = max_move - (move_steps - 1) * move_step;
-            if (last_move_step < scaled<float>(0.05)) {
-                assert(move_steps > 1);
-                if (move_steps > 1) {
-                    // Avoid taking a very short last step, stretch the other steps a bit instead.
-                    move_step = max_move / (-- move_steps);
-                    last_move_step = move_step;
-                }
-            }
-            // minDist as the delta was already added, also avoidance for layer 0 will return the collision.
-            Polygons    latest_avoidance   = getAvoidance(task.radius, task.start_layer - 1, task.type, task.to_model, true);
-            std::vector<std::pair<RadiusLayerPair, Polygons>> data;
-            data.reserve(task.max_required_layer + 1 - task.start_layer);
-            for (LayerIndex layer_idx = task.start_layer; layer_idx <= task.max_required_layer; ++ layer_idx) {
-                // Merge current layer collisions with shrunk last_avoidance.
-                const Polygons &current_layer_collisions = collision_holefree ? getCollisionHolefree(task.radius, layer_idx) : getCollision(task.radius, layer_idx, true);
-                // For mildly steep branch angles only one step will be taken.
-                for (int istep = 0; istep < move_steps; ++ istep)
-                    latest_avoidance = union_(current_layer_collisions,
-                        offset(latest_avoidance,
-                            istep + 1 == move_steps ? - last_move_step : - move_step,
-                            ClipperLib::jtRound, m_min_resolution));
-                if (task.to_model)
-                    latest_avoidance = diff(latest_avoidance, getPlaceableAreas(task.radius, layer_idx, throw_on_cancel));
-                latest_avoidance = polygons_simplify(latest_avoidance, m_min_resolution, polygons_strictly_simple);
-                data.emplace_back(RadiusLayerPair{task.radius, layer_idx}, latest_avoidance);
-                throw_on_cancel();
-            }
+            calculateAvoidance(avoidance_tasks[task_idx], throw_on_cancel);
 #ifdef SLIC3R_TREESUPPORTS_PROGRESS
             {
                 std::lock_guard<std::mutex> critical_section(*m_critical_progress);
@@ -702,11 +730,55 @@ void TreeModelVolumes::calculateAvoidance(const std::vector<RadiusLayerPair> &ke
                 }
             }
 #endif
-            avoidance_cache(task.type, task.to_model).insert(std::move(data));
         }
     });
 }
 
+void TreeModelVolumes::calculateAvoidance(const AvoidanceTask &task, std::function<void()> throw_on_cancel)
+{
+    assert(! task.holefree() || task.radius < m_increase_until_radius + m_current_min_xy_dist_delta);
+    if (task.to_model)
+        // ensuring Placeableareas are calculated
+        getPlaceableAreas(task.radius, task.max_required_layer, throw_on_cancel);
+    // The following loop propagating avoidance regions bottom up is inherently serial.
+    const bool  collision_holefree = (task.slow() || task.holefree()) && task.radius < m_increase_until_radius + m_current_min_xy_dist_delta;
+    const float max_move           = task.slow() ? m_max_move_slow : m_max_move;
+    // Limiting the offset step so that unioning the shrunk latest_avoidance with the current layer collisions
+    // will not create gaps in the resulting avoidance region letting a tree support branch tunneling through an object wall.
+    float move_step      = 1.9 * std::max(task.radius, m_current_min_xy_dist);
+    int   move_steps     = round_up_divide<int>(max_move, move_step);
+    assert(move_steps > 0);
+    float last_move_step = max_move - (move_steps - 1) * move_step;
+    if (last_move_step < scaled<float>(0.05)) {
+        assert(move_steps > 1);
+        if (move_steps > 1) {
+            // Avoid taking a very short last step, stretch the other steps a bit instead.
+            move_step = max_move / (-- move_steps);
+            last_move_step = move_step;
+        }
+    }
+    // minDist as the delta was already added, also avoidance for layer 0 will return the collision.
+    Polygons    latest_avoidance   = getAvoidance(task.radius, task.start_layer - 1, task.type, task.to_model, true);
+    std::vector<std::pair<RadiusLayerPair, Polygons>> data;
+    data.reserve(task.max_required_layer + 1 - task.start_layer);
+    for (LayerIndex layer_idx = task.start_layer; layer_idx <= task.max_required_layer; ++ layer_idx) {
+        // Merge current layer collisions with shrunk last_avoidance.
+        const Polygons &current_layer_collisions = collision_holefree ? getCollisionHolefree(task.radius, layer_idx) : getCollision(task.radius, layer_idx, true);
+        // For mildly steep branch angles only one step will be taken.
+        for (int istep = 0; istep < move_steps; ++ istep)
+            latest_avoidance = union_(current_layer_collisions,
+                offset(latest_avoidance,
+                    istep + 1 == move_steps ? - last_move_step : - move_step,
+                    ClipperLib::jtRound, m_min_resolution));
+        if (task.to_model)
+            latest_avoidance = diff(latest_avoidance, getPlaceableAreas(task.radius, layer_idx, throw_on_cancel));
+        latest_avoidance = polygons_simplify(latest_avoidance, m_min_resolution, polygons_strictly_simple);
+        data.emplace_back(RadiusLayerPair{task.radius, layer_idx}, latest_avoidance);
+        throw_on_cancel();
+    }
+    avoidance_cache(task.type, task.to_model).insert(std::move(data));
+}
+
 
 void TreeModelVolumes::calculatePlaceables(const std::vector<RadiusLayerPair> &keys, std::function<void()> throw_on_cancel)
 {
@@ -853,25 +925,46 @@ coord_t TreeModelVolumes::ceilRadius(const coord_t radius) const
     return out;
 }
 
-void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layers)
+TreeModelVolumes::RadiusLayerPolygonCache::RadiusData& TreeModelVolumes::RadiusLayerPolygonCache::get_allocate_radius_data(coord_t radius)
 {
-    if (num_layers > m_data.size()) {
-        if (num_layers > m_data.capacity())
-            reserve_power_of_2(m_data, num_layers);
-        m_data.resize(num_layers, {});
+    {
+        std::shared_lock<std::shared_mutex> guard(m_mutex);
+        if (auto it = m_radii.find(radius); it != m_radii.end())
+            return *it->second;
     }
+    std::unique_lock<std::shared_mutex> guard(m_mutex);
+    std::unique_ptr<RadiusData> &data = m_radii[radius];
+    if (! data)
+        data = std::make_unique<RadiusData>();
+    return *data;
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear_all_but_radius0()
+{
+    // Layers, at which a smaller radius has already been kept.
+    std::vector<bool> kept;
+    for (auto &[radius, data] : m_radii)
+        for (size_t layer_idx = 0; layer_idx < data->layers.size(); ++ layer_idx)
+            if (std::optional<Polygons> &layer = data->layers[layer_idx]; layer) {
+                if (layer_idx < kept.size() && kept[layer_idx])
+                    layer.reset();
+                else {
+                    if (layer_idx >= kept.size())
+                        kept.resize(layer_idx + 1, false);
+                    kept[layer_idx] = true;
+                }
+            }
 }
 
 // For debugging purposes, sorted by layer index, then by radius.
 std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::sorted() const
 {
     std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> out;
-    for (auto &layer : m_data) {
-        auto layer_idx = LayerIndex(&layer - m_data.data());
-        for (auto &radius_polygons : layer)
-            out.emplace_back(std::make_pair(radius_polygons.first, layer_idx), radius_polygons.second);
-    }
-    assert(std::is_sorted(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second) && l.first.first < r.first.first; }));
+    for (auto &[radius, data] : m_radii)
+        for (size_t layer_idx = 0; layer_idx < data->layers.size(); ++ layer_idx)
+            if (const std::optional<Polygons> &layer = data->layers[layer_idx]; layer)
+                out.emplace_back(std::make_pair(radius, LayerIndex(layer_idx)), *layer);
+    std::sort(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second && l.first.first < r.first.first); });
     return out;
 }
 
@@ -13,7 +13,11 @@
 #ifndef slic3r_TreeModelVolumes_hpp
 #define slic3r_TreeModelVolumes_hpp
 
+#include <deque>
+#include <map>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
@@ -200,42 +204,63 @@ private:
      */
     using RadiusLayerPair             = std::pair<coord_t, LayerIndex>;
     class RadiusLayerPolygonCache {
-        // Map from radius to Polygons. Cache of one layer collision regions.
-        using LayerData = std::map<coord_t, Polygons>;
-        // Vector of layers, at each layer map of radius to Polygons.
-        // Reference to Polygons returned shall be stable to insertion.
-        using Layers = std::vector<LayerData>;
+        // Cache of one radius, indexed by layer. Layers not calculated yet are empty.
+        // std::deque keeps references to the contained Polygons stable when growing at its end.
+        struct RadiusData {
+            std::deque<std::optional<Polygons>> layers;
+            // Shared by readers, exclusive for inserting new layers.
+            mutable std::shared_mutex           mutex;
+
+            bool has(LayerIndex layer_idx) const { return layer_idx >= 0 && layer_idx < LayerIndex(layers.size()) && layers[layer_idx]; }
+            // Does not overwrite a layer already calculated.
+            void emplace(LayerIndex layer_idx, Polygons &&polygons) {
+                if (layer_idx >= LayerIndex(layers.size()))
+                    layers.resize(layer_idx + 1);
+                if (std::optional<Polygons> &dst = layers[layer_idx]; ! dst)
+                    dst = std::move(polygons);
+            }
+        };
+        // The cache is sharded by radius: A radius is calculated by a single task at a time, while its layers are read
+        // by other tasks concurrently, thus the tasks of different radii do not contend for a single lock.
+        // Reference to RadiusData is stable to insertion of other radii.
+        using Radii = std::map<coord_t, std::unique_ptr<RadiusData>>;
     public:
         RadiusLayerPolygonCache() = default;
-        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : m_data(std::move(rhs.m_data)) {}
-        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) { m_data = std::move(rhs.m_data); return *this; }
+        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : m_radii(std::move(rhs.m_radii)) {}
+        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) { m_radii = std::move(rhs.m_radii); return *this; }
 
         RadiusLayerPolygonCache(const RadiusLayerPolygonCache&) = delete;
         RadiusLayerPolygonCache& operator=(const RadiusLayerPolygonCache&) = delete;
 
         void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in) {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            for (auto &d : in)
-                this->get_allocate_layer_data(d.first.second).emplace(d.first.first, std::move(d.second));
+            // Lock each run of the same radius once.
+            for (auto it = in.begin(); it != in.end();) {
+                const coord_t radius = it->first.first;
+                RadiusData   &data   = this->get_allocate_radius_data(radius);
+                std::unique_lock<std::shared_mutex> guard(data.mutex);
+                for (; it != in.end() && it->first.first == radius; ++ it)
+                    data.emplace(it->first.second, std::move(it->second));
+            }
         }
         // by layer
         void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            RadiusData &data = this->get_allocate_radius_data(radius);
+            std::unique_lock<std::shared_mutex> guard(data.mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first).emplace(radius, std::move(d.second));
+                data.emplace(d.first, std::move(d.second));
         }
         void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            allocate_layers(first_layer_idx + in.size());
+            RadiusData &data = this->get_allocate_radius_data(radius);
+            std::unique_lock<std::shared_mutex> guard(data.mutex);
             for (auto &d : in)
-                m_data[first_layer_idx ++].emplace(radius, std::move(d));
+                data.emplace(first_layer_idx ++, std::move(d));
         }
         void insert(LayerPolygonCache &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            RadiusData &data = this->get_allocate_radius_data(radius);
+            std::unique_lock<std::shared_mutex> guard(data.mutex);
             LayerIndex i = in.begin();
-            allocate_layers(i + LayerIndex(in.size()));
             for (auto &d : in.polygons_mutable())
-                m_data[i ++].emplace(radius, std::move(d));
+                data.emplace(i ++, std::move(d));
         }
         /*!
          * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
@@ -243,29 +268,23 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= LayerIndex(m_data.size()))
+            const RadiusData *data = this->find_radius_data(key.first);
+            if (data == nullptr)
                 return std::optional<std::reference_wrapper<const Polygons>>{};
-            const auto &layer = m_data[key.second];
-            auto it = layer.find(key.first);
-            return it == layer.end() ? 
-                std::optional<std::reference_wrapper<const Polygons>>{} : std::optional<std::reference_wrapper<const Polygons>>{ it->second };
+            std::shared_lock<std::shared_mutex> guard(data->mutex);
+            return data->has(key.second) ?
+                std::optional<std::reference_wrapper<const Polygons>>{ *data->layers[key.second] } : std::optional<std::reference_wrapper<const Polygons>>{};
         }
         // Get a collision area at a given layer for a radius that is a lower or equial to the key radius.
         std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= LayerIndex(m_data.size()))
-                return {};
-            const auto &layer = m_data[key.second];
-            if (layer.empty())
-                return {};
-            auto it = layer.lower_bound(key.first);
-            if (it == layer.end() || it->first != key.first) {
-                if (it == layer.begin())
-                    return {};
+            std::shared_lock<std::shared_mutex> guard(m_mutex);
+            for (auto it = m_radii.upper_bound(key.first); it != m_radii.begin();) {
                 -- it;
+                std::shared_lock<std::shared_mutex> guard_radius(it->second->mutex);
+                if (it->second->has(key.second))
+                    return std::make_pair(it->first, std::reference_wrapper<const Polygons>(*it->second->layers[key.second]));
             }
-            return std::make_pair(it->first, std::reference_wrapper<const Polygons>(it->second));
+            return {};
         }
         /*!
          * \brief Get the highest already calculated layer in the cache.
@@ -275,10 +294,13 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         LayerIndex getMaxCalculatedLayer(coord_t radius) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            auto layer_idx = LayerIndex(m_data.size()) - 1;
+            const RadiusData *data = this->find_radius_data(radius);
+            if (data == nullptr)
+                return -1;
+            std::shared_lock<std::shared_mutex> guard(data->mutex);
+            auto layer_idx = LayerIndex(data->layers.size()) - 1;
             for (; layer_idx > 0; -- layer_idx)
-                if (const auto &layer = m_data[layer_idx]; layer.find(radius) != layer.end())
+                if (data->layers[layer_idx])
                     break;
             // The placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
             return layer_idx == 0 ? -1 : layer_idx;
@@ -287,25 +309,21 @@ private:
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
 
-        void clear() { m_data.clear(); }
-        void clear_all_but_radius0() { 
-            for (LayerData &l : m_data) {
-                auto begin = l.begin();
-                auto end = l.end();
-                if (begin != end && ++ begin != end)
-                    l.erase(begin, end);
-            }
-        }
+        void clear() { m_radii.clear(); }
+        // Keep just the smallest radius calculated at each layer.
+        void clear_all_but_radius0();
 
     private:
-        LayerData&          get_allocate_layer_data(LayerIndex layer_idx) {
-            allocate_layers(layer_idx + 1);
-            return m_data[layer_idx];
+        const RadiusData*   find_radius_data(coord_t radius) const {
+            std::shared_lock<std::shared_mutex> guard(m_mutex);
+            auto it = m_radii.find(radius);
+            return it == m_radii.end() ? nullptr : it->second.get();
         }
-        void                allocate_layers(size_t num_layers);
+        RadiusData&         get_allocate_radius_data(coord_t radius);
 
-        Layers              m_data;
-        mutable std::mutex  m_mutex;
+        Radii                     m_radii;
+        // Shared by readers, exclusive for inserting a new radius.
+        mutable std::shared_mutex m_mutex;
     };
 
 
@@ -383,6 +401,29 @@ private:
         calculateAvoidance(std::vector<RadiusLayerPair>{ RadiusLayerPair(key) }, to_build_plate, to_model, []{});
     }
 
+    // Avoidance of a single type and radius, to be propagated bottom up from start_layer to max_required_layer.
+    struct AvoidanceTask {
+        AvoidanceType   type;
+        coord_t         radius;
+        LayerIndex      max_required_layer;
+        bool            to_model;
+        LayerIndex      start_layer;
+
+        bool slow()     const { return this->type == AvoidanceType::Slow; }
+        bool holefree() const { return this->type == AvoidanceType::FastSafe; }
+    };
+
+    /*!
+     * \brief Collects the avoidances not calculated yet for the provided RadiusLayerPairs.
+     * \param keys RadiusLayerPairs of all requested areas. Every radius will be calculated up to the provided layer.
+     */
+    std::vector<AvoidanceTask> avoidanceTasks(const std::vector<RadiusLayerPair> &keys, bool to_build_plate, bool to_model) const;
+
+    /*!
+     * \brief Calculates a single avoidance task, the layers are processed serially. Result is saved in the cache.
+     */
+    void calculateAvoidance(const AvoidanceTask &task, std::function<void()> throw_on_cancel);
+
     /*!
      * \brief Creates the areas where a branch of a given radius can be place on the model.
      * Result is saved in the cache.
@@ -14,6 +14,7 @@
 #include "TreeSupportCommon.hpp"
 #include "SupportCommon.hpp"
 #include "OrganicSupport.hpp"
+#include "../ProfilerTracy.hpp"
 
 #include "../AABBTreeIndirect.hpp"
 #include "../BuildVolume.hpp"
@@ -34,6 +35,8 @@
 #include <stdio.h>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <unordered_map>
 
 #include <boost/log/trivial.hpp>
 
@@ -939,37 +942,57 @@ private:
         }
         Polygons circle{ m_base_circle };
         circle.front().translate(p.first);
+        static constexpr const size_t dtt = 0;
+        SupportElementState state;
+        state.target_height = insert_layer;
+        state.target_position = p.first;
+        state.next_position = p.first;
+        state.layer_idx = insert_layer;
+        state.effective_radius_height = dtt;
+        state.to_buildplate = to_bp;
+        state.distance_to_top = dtt;
+        state.result_on_layer = p.first;
+        assert(state.result_on_layer_is_set());
+        state.increased_to_model_radius = 0;
+        state.to_model_gracious = gracious;
+        state.elephant_foot_increases = 0;
+        state.use_min_xy_dist = min_xy_dist;
+        state.supports_roof = roof;
+        state.dont_move_until = dont_move_until;
+        state.can_use_safe_radius = safe_radius;
+        state.missing_roof_layers = force_tip_to_roof ? dont_move_until : 0;
+        state.skip_ovalisation = skip_ovalisation;
         {
+            // normalize the point a bit to also catch points which are so close that inserting it would achieve nothing
             Point hash_pos = p.first / ((config.min_radius + 1) / 10);
             std::lock_guard<std::mutex> critical_section_movebounds(m_mutex_movebounds);
-            if (!m_already_inserted[insert_layer].count(hash_pos)) {
-                // normalize the point a bit to also catch points which are so close that inserting it would achieve nothing
-                m_already_inserted[insert_layer].emplace(hash_pos);
-                static constexpr const size_t dtt = 0;
-                SupportElementState state;
-                state.target_height = insert_layer;
-                state.target_position = p.first;
-                state.next_position = p.first;
-                state.layer_idx = insert_layer;
-                state.effective_radius_height = dtt;
-                state.to_buildplate = to_bp;
-                state.distance_to_top = dtt;
-                state.result_on_layer = p.first;
-                assert(state.result_on_layer_is_set());
-                state.increased_to_model_radius = 0;
-                state.to_model_gracious = gracious;
-                state.elephant_foot_increases = 0;
-                state.use_min_xy_dist = min_xy_dist;
-                state.supports_roof = roof;
-                state.dont_move_until = dont_move_until;
-                state.can_use_safe_radius = safe_radius;
-                state.missing_roof_layers = force_tip_to_roof ? dont_move_until : 0;
-                state.skip_ovalisation = skip_ovalisation;
-                move_bounds[insert_layer].emplace_back(state, std::move(circle));
-            }
+            SupportElements &tips = move_bounds[insert_layer];
+            if (auto [it, inserted] = m_already_inserted[insert_layer].emplace(hash_pos, tips.size()); inserted)
+                tips.emplace_back(state, std::move(circle));
+            else if (tip_less(state, tips[it->second].state))
+                // The layers are processed in parallel, keep the same tip of the colliding ones independently of the order of insertion.
+                tips[it->second] = SupportElement(state, std::move(circle));
         }
     }
 
+    // Total order of the tips generated by add_point_as_influence_area().
+    static bool tip_less(const SupportElementState &l, const SupportElementState &r)
+    {
+        auto key = [](const SupportElementState &s) {
+            return std::make_tuple(s.target_position.x(), s.target_position.y(), s.dont_move_until, s.missing_roof_layers,
+                bool(s.to_buildplate), bool(s.to_model_gracious), bool(s.can_use_safe_radius), bool(s.supports_roof), bool(s.skip_ovalisation));
+        };
+        return key(l) < key(r);
+    }
+
+public:
+    // Sort the tips of each layer, which were inserted by multiple threads in an arbitrary order.
+    void sort_tips()
+    {
+        for (SupportElements &tips : move_bounds)
+            std::sort(tips.begin(), tips.end(), [](const SupportElement &l, const SupportElement &r) { return tip_less(l.state, r.state); });
+    }
+
     // Outputs
     std::vector<SupportElements>                       &move_bounds;
 
@@ -979,7 +1002,8 @@ private:
     
     // Mutexes, guards
     std::mutex                                          m_mutex_movebounds;
-    std::vector<std::unordered_set<Point, PointHash>>   m_already_inserted;
+    // Index of the tip in move_bounds for the normalized tip positions of each layer.
+    std::vector<std::unordered_map<Point, size_t, PointHash>> m_already_inserted;
 };
 
 int generate_raft_contact(
@@ -1418,6 +1442,10 @@ static void generate_initial_areas(
         }
     });
 
+    // The tips and roofs were inserted by multiple threads, order them so that the supports do not differ run to run.
+    rich_interface_placer.sort_tips();
+    rich_interface_placer.sort_roofs();
+
     finalize_raft_contact(print_object, raft_contact_layer_idx, interface_placer.top_contacts_mutable(), move_bounds);
 }
 
@@ -3404,6 +3432,7 @@ extern bool g_showed_performance_warning;
  */
 static void generate_support_areas(Print &print, const BuildVolume &build_volume, const std::vector<size_t> &print_object_ids, std::function<void()> throw_on_cancel)
 {
+    SLIC3R_PROFILE_ZONE();
     g_showed_critical_error = false;
     g_showed_performance_warning = false;
 
@@ -3625,6 +3654,7 @@ static void generate_support_areas(Print &print, const BuildVolume &build_volume
 
 void fff_tree_support_generate(PrintObject &print_object, std::function<void()> throw_on_cancel)
 {
+    SLIC3R_PROFILE_ZONE();
     size_t idx = 0;
     for (const PrintObject *po : print_object.print()->objects()) {
         if (po == &print_object)
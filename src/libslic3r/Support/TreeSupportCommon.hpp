@@ -577,6 +577,15 @@ public:
         append(l->polygons, std::move(new_roofs));
     }
 
+    // Sort the roof polygons added by multiple threads, so that their union does not depend on the order of insertion.
+    void sort_roofs()
+    {
+        for (SupportGeneratorLayersPtr *layers : { &this->top_contacts, &this->top_interfaces, &this->top_base_interfaces })
+            for (SupportGeneratorLayer *layer : *layers)
+                if (layer)
+                    std::sort(layer->polygons.begin(), layer->polygons.end(), [](const Polygon &l, const Polygon &r) { return l.points < r.points; });
+    }
+
 private:
     // Outputs
     SupportGeneratorLayerStorage                       &layer_storage;
@@ -24,6 +24,16 @@
 #include "tbb/blocked_range.h"
 #include "tbb/blocked_range2d.h"
 #include "tbb/parallel_reduce.h"
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
 #include <algorithm>
 #include <boost/log/trivial.hpp>
 #include <cmath>
@@ -855,7 +865,7 @@ std::vector<EnitityToCheck> gather_entities_to_check(const Layer* layer) {
 
 LocalSupports compute_local_supports(
     const std::vector<EnitityToCheck>& entities_to_check,
-    const std::optional<Linesf>& previous_layer_boundary,
+    const AABBTreeLines::LinesDistancer<Linef>& prev_layer_boundary_distancer,
     const LD& prev_layer_ext_perim_lines,
     size_t slices_count,
     const Params& params
@@ -863,9 +873,6 @@ LocalSupports compute_local_supports(
     std::vector<tbb::concurrent_vector<ExtrusionLine>> unstable_lines_per_slice(slices_count);
     std::vector<tbb::concurrent_vector<ExtrusionLine>> ext_perim_lines_per_slice(slices_count);
 
-    AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary_distancer =
-        (previous_layer_boundary ? AABBTreeLines::LinesDistancer<Linef>{*previous_layer_boundary} : AABBTreeLines::LinesDistancer<Linef>{});
-
     if constexpr (debug_files) {
         for (const auto &e_to_check : entities_to_check) {
             for (const auto &line : check_extrusion_entity_stability(e_to_check.e, e_to_check.region, prev_layer_ext_perim_lines,
@@ -879,23 +886,29 @@ LocalSupports compute_local_supports(
             }
         }
     } else {
+        // The lines are collected per entity and distributed to the slices in the order of the entities,
+        // so that the order of the lines does not depend on the scheduling of the threads.
+        std::vector<std::vector<ExtrusionLine>> lines_per_entity(entities_to_check.size());
         tbb::parallel_for(tbb::blocked_range<size_t>(0, entities_to_check.size()),
-                          [&entities_to_check, &prev_layer_ext_perim_lines, &prev_layer_boundary_distancer, &unstable_lines_per_slice,
-                           &ext_perim_lines_per_slice, &params](tbb::blocked_range<size_t> r) {
+                          [&entities_to_check, &prev_layer_ext_perim_lines, &prev_layer_boundary_distancer, &lines_per_entity,
+                           &params](tbb::blocked_range<size_t> r) {
                               for (size_t entity_idx = r.begin(); entity_idx < r.end(); ++entity_idx) {
                                   const auto &e_to_check = entities_to_check[entity_idx];
-                                  for (const auto &line :
-                                       check_extrusion_entity_stability(e_to_check.e, e_to_check.region, prev_layer_ext_perim_lines,
-                                                                        prev_layer_boundary_distancer, params)) {
-                                      if (line.support_point_generated.has_value()) {
-                                          unstable_lines_per_slice[e_to_check.slice_idx].push_back(line);
-                                      }
-                                      if (line.is_external_perimeter()) {
-                                          ext_perim_lines_per_slice[e_to_check.slice_idx].push_back(line);
-                                      }
-                                  }
+                                  lines_per_entity[entity_idx] = check_extrusion_entity_stability(e_to_check.e, e_to_check.region, prev_layer_ext_perim_lines,
+                                                                                                  prev_layer_boundary_distancer, params);
                               }
                           });
+        for (size_t entity_idx = 0; entity_idx < entities_to_check.size(); ++entity_idx) {
+            const auto &e_to_check = entities_to_check[entity_idx];
+            for (const auto &line : lines_per_entity[entity_idx]) {
+                if (line.support_point_generated.has_value()) {
+                    unstable_lines_per_slice[e_to_check.slice_idx].push_back(line);
+                }
+                if (line.is_external_perimeter()) {
+                    ext_perim_lines_per_slice[e_to_check.slice_idx].push_back(line);
+                }
+            }
+        }
     }
     return {unstable_lines_per_slice, ext_perim_lines_per_slice};
 }
@@ -1052,47 +1065,81 @@ std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject
 
     SliceMappings slice_mappings;
 
-
-    for (size_t layer_idx = 0; layer_idx < po->layer_count(); ++layer_idx) {
-        cancel_func();
-        const Layer *layer                 = po->get_layer(layer_idx);
-        float        bottom_z              = layer->bottom_z();
-
-        slice_mappings = update_active_object_parts(layer, params, precomputed_slices_connections[layer_idx], slice_mappings, active_object_parts, partial_objects);
-
-        std::optional<Linesf> prev_layer_boundary = layer->lower_layer != nullptr ?
-                                                        std::optional{to_unscaled_linesf(layer->lower_layer->lslices)} :
-                                                        std::nullopt;
-
-        LocalSupports local_supports{
-            compute_local_supports(gather_entities_to_check(layer), prev_layer_boundary, prev_layer_ext_perim_lines, layer->lslices_ex.size(), params)};
-
-        std::vector<ExtrusionLine> current_layer_ext_perims_lines{};
-        current_layer_ext_perims_lines.reserve(prev_layer_ext_perim_lines.get_lines().size());
-        // All object parts updated, and for each slice we have coresponding weakest connection.
-        // We can now check each slice and its corresponding weakest connection and object part for stability.
-        for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
-            ObjectPart                &part         = active_object_parts.access(slice_mappings.index_to_object_part_mapping[slice_idx]);
-            SliceConnection           &weakest_conn = slice_mappings.index_to_weakest_connection[slice_idx];
-
-            if (layer_idx > 1) {
-                for (const auto &l : local_supports.unstable_lines_per_slice[slice_idx]) {
-                    assert(l.support_point_generated.has_value());
-                    SupportPoint support_point{*l.support_point_generated, to_3d(l.b, bottom_z),
-                                               params.support_points_interface_radius};
-                    reckon_new_support_point(part, weakest_conn, supp_points, supports_presence_grid, support_point);
-                }
+    // The extrusions of a layer are analyzed (including the curling estimate) once the external perimeters of the layer below
+    // are known, which does not depend on the object parts. Therefore the analysis runs in a pipeline ahead of the serial walk
+    // merging the object parts and placing the support points. The entities to check are collected fully in parallel.
+    struct LayerToCheck {
+        size_t                      layer_idx;
+        std::vector<EnitityToCheck> entities_to_check;
+        LocalSupports               local_supports;
+    };
+    const AABBTreeLines::LinesDistancer<Linef> no_prev_layer_boundary;
+    size_t next_layer_idx = 0;
+    const auto generator = tbb::make_filter<void, std::shared_ptr<LayerToCheck>>(slic3r_tbb_filtermode::serial_in_order,
+        [po, &next_layer_idx, &cancel_func](tbb::flow_control &fc) -> std::shared_ptr<LayerToCheck> {
+            if (next_layer_idx == po->layer_count()) {
+                fc.stop();
+                return {};
             }
+            cancel_func();
+            auto layer_to_check = std::make_shared<LayerToCheck>();
+            layer_to_check->layer_idx = next_layer_idx ++;
+            return layer_to_check;
+        });
+    const auto gather = tbb::make_filter<std::shared_ptr<LayerToCheck>, std::shared_ptr<LayerToCheck>>(slic3r_tbb_filtermode::parallel,
+        [po](std::shared_ptr<LayerToCheck> layer_to_check) -> std::shared_ptr<LayerToCheck> {
+            const Layer *layer = po->get_layer(layer_to_check->layer_idx);
+            layer_to_check->entities_to_check = gather_entities_to_check(layer);
+            return layer_to_check;
+        });
+    const auto analyze = tbb::make_filter<std::shared_ptr<LayerToCheck>, std::shared_ptr<LayerToCheck>>(slic3r_tbb_filtermode::serial_in_order,
+        [po, &prev_layer_ext_perim_lines, &no_prev_layer_boundary, &params](std::shared_ptr<LayerToCheck> layer_to_check) -> std::shared_ptr<LayerToCheck> {
+            const Layer *layer = po->get_layer(layer_to_check->layer_idx);
+            layer_to_check->local_supports = compute_local_supports(layer_to_check->entities_to_check,
+                layer->lower_layer != nullptr ? layer->lower_layer->lslices_distancer() : no_prev_layer_boundary,
+                prev_layer_ext_perim_lines, layer->lslices_ex.size(), params);
+            layer_to_check->entities_to_check.clear();
+            std::vector<ExtrusionLine> current_layer_ext_perims_lines{};
+            current_layer_ext_perims_lines.reserve(prev_layer_ext_perim_lines.get_lines().size());
+            for (const tbb::concurrent_vector<ExtrusionLine> &external_perimeter_lines : layer_to_check->local_supports.ext_perim_lines_per_slice)
+                current_layer_ext_perims_lines.insert(current_layer_ext_perims_lines.end(), external_perimeter_lines.begin(), external_perimeter_lines.end());
+            prev_layer_ext_perim_lines = LD(current_layer_ext_perims_lines);
+            return layer_to_check;
+        });
+    const auto walk = tbb::make_filter<std::shared_ptr<LayerToCheck>, void>(slic3r_tbb_filtermode::serial_in_order,
+        [po, &precomputed_slices_connections, &params, &supp_points, &supports_presence_grid, &active_object_parts, &partial_objects, &slice_mappings]
+        (std::shared_ptr<LayerToCheck> layer_to_check) {
+            const size_t   layer_idx      = layer_to_check->layer_idx;
+            const Layer   *layer          = po->get_layer(layer_idx);
+            float          bottom_z       = layer->bottom_z();
+            LocalSupports &local_supports = layer_to_check->local_supports;
+
+            slice_mappings = update_active_object_parts(layer, params, precomputed_slices_connections[layer_idx], slice_mappings, active_object_parts, partial_objects);
+
+            // All object parts updated, and for each slice we have coresponding weakest connection.
+            // We can now check each slice and its corresponding weakest connection and object part for stability.
+            for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
+                ObjectPart                &part         = active_object_parts.access(slice_mappings.index_to_object_part_mapping[slice_idx]);
+                SliceConnection           &weakest_conn = slice_mappings.index_to_weakest_connection[slice_idx];
+
+                if (layer_idx > 1) {
+                    for (const auto &l : local_supports.unstable_lines_per_slice[slice_idx]) {
+                        assert(l.support_point_generated.has_value());
+                        SupportPoint support_point{*l.support_point_generated, to_3d(l.b, bottom_z),
+                                                   params.support_points_interface_radius};
+                        reckon_new_support_point(part, weakest_conn, supp_points, supports_presence_grid, support_point);
+                    }
+                }
 
-            const tbb::concurrent_vector<ExtrusionLine> &external_perimeter_lines = local_supports.ext_perim_lines_per_slice[slice_idx];
-            if (layer_idx > 1) {
-                reckon_global_supports(external_perimeter_lines, bottom_z, params, part, weakest_conn, supp_points, supports_presence_grid);
-            }
+                const tbb::concurrent_vector<ExtrusionLine> &external_perimeter_lines = local_supports.ext_perim_lines_per_slice[slice_idx];
+                if (layer_idx > 1) {
+                    reckon_global_supports(external_perimeter_lines, bottom_z, params, part, weakest_conn, supp_points, supports_presence_grid);
+                }
+            } // slice iterations
+    });
 
-            current_layer_ext_perims_lines.insert(current_layer_ext_perims_lines.end(), external_perimeter_lines.begin(), external_perimeter_lines.end());
-        } // slice iterations
-        prev_layer_ext_perim_lines = LD(current_layer_ext_perims_lines);
-    } // layer iterations
+    // The number of live tokens bounds the number of layers analyzed ahead of the walk.
+    tbb::parallel_pipeline(2 * size_t(tbb::this_task_arena::max_concurrency()), generator & gather & analyze & walk);
 
     for (const auto& active_obj_pair : slice_mappings.index_to_object_part_mapping) {
         auto object_part = active_object_parts.access(active_obj_pair.second);
@@ -1235,13 +1282,18 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
     FILE *full_file  = boost::nowide::fopen(debug_out_path("object_full.obj").c_str(), "w");
 #endif
 
-    LD prev_layer_lines{};
+    LD                                         prev_layer_lines{};
+    const AABBTreeLines::LinesDistancer<Linef> no_prev_layer_boundary;
 
     for (Layer *l : layers) {
         l->curled_lines.clear();
-        std::vector<Linef> boundary_lines = l->lower_layer != nullptr ? to_unscaled_linesf(l->lower_layer->lslices) : std::vector<Linef>();
-        AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary{std::move(boundary_lines)};
-        std::vector<ExtrusionLine>           current_layer_lines;
+        const AABBTreeLines::LinesDistancer<Linef> &prev_layer_boundary = l->lower_layer != nullptr ? l->lower_layer->lslices_distancer() :
+                                                                                                       no_prev_layer_boundary;
+        std::vector<ExtrusionLine> current_layer_lines;
+        // Flow width and curvature of current_layer_lines, the lines are finished once the distances of their middles
+        // from the lower layer slices are queried in a single batch.
+        std::vector<std::pair<float, float>> current_layer_lines_flow_width_curvature;
+        std::vector<Vec2d>                   current_layer_lines_middles;
         for (const LayerRegion *layer_region : l->regions()) {
             for (const ExtrusionEntity *extrusion : layer_region->perimeters().flatten().entities) {
                 if (!extrusion->role().is_external_perimeter())
@@ -1259,24 +1311,29 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
                     const ExtrusionProcessor::ExtendedPoint &b = annotated_points[i];
                     ExtrusionLine line_out{a.position.cast<float>(), b.position.cast<float>(), float((a.position - b.position).norm()),
                                            extrusion};
-
-                    Vec2f middle                               = 0.5 * (line_out.a + line_out.b);
-                    auto [middle_distance, bottom_line_idx, x] = prev_layer_lines.distance_from_lines_extra<false>(middle);
-                    ExtrusionLine bottom_line                  = prev_layer_lines.get_lines().empty() ? ExtrusionLine{} :
-                                                                                                        prev_layer_lines.get_line(bottom_line_idx);
-
-                    // correctify the distance sign using slice polygons
-                    float sign = (prev_layer_boundary.distance_from_lines<true>(middle.cast<double>()) + 0.5f * flow_width) < 0.0f ? -1.0f :
-                                                                                                                                     1.0f;
-
-                    line_out.curled_up_height = estimate_curled_up_height(middle_distance * sign, 0.5 * (a.curvature + b.curvature),
-                                                                          l->height, flow_width, bottom_line.curled_up_height, params);
-
+                    current_layer_lines_middles.emplace_back(0.5 * (line_out.a + line_out.b).cast<double>());
+                    current_layer_lines_flow_width_curvature.emplace_back(flow_width, 0.5 * (a.curvature + b.curvature));
                     current_layer_lines.push_back(line_out);
                 }
             }
         }
 
+        std::vector<double> boundary_distances = prev_layer_boundary.distances_from_lines<true>(current_layer_lines_middles);
+        for (size_t line_idx = 0; line_idx < current_layer_lines.size(); ++line_idx) {
+            ExtrusionLine &line_out                    = current_layer_lines[line_idx];
+            auto [flow_width, curvature]               = current_layer_lines_flow_width_curvature[line_idx];
+            Vec2f middle                               = current_layer_lines_middles[line_idx].cast<float>();
+            auto [middle_distance, bottom_line_idx, x] = prev_layer_lines.distance_from_lines_extra<false>(middle);
+            ExtrusionLine bottom_line                  = prev_layer_lines.get_lines().empty() ? ExtrusionLine{} :
+                                                                                                prev_layer_lines.get_line(bottom_line_idx);
+
+            // correctify the distance sign using slice polygons
+            float sign = (boundary_distances[line_idx] + 0.5f * flow_width) < 0.0f ? -1.0f : 1.0f;
+
+            line_out.curled_up_height = estimate_curled_up_height(middle_distance * sign, curvature, l->height, flow_width,
+                                                                  bottom_line.curled_up_height, params);
+        }
+
         for (const ExtrusionLine &line : current_layer_lines) {
             if (line.curled_up_height > params.curling_tolerance_limit) {
                 l->curled_lines.push_back(CurledLine{Point::new_scale(line.a), Point::new_scale(line.b), line.curled_up_height});
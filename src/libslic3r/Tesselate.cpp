@@ -252,12 +252,17 @@ std::vector<Vec2f> triangulate_expolygons_2f(const ExPolygons &polys, bool flip)
 indexed_triangle_set wall_strip(const Polygon &poly, double lower_z_mm, double upper_z_mm)
 {
     indexed_triangle_set ret;
+    ret.vertices.reserve(2 * poly.points.size());
+    ret.indices.reserve(2 * poly.points.size());
+    wall_strip(ret, poly, lower_z_mm, upper_z_mm);
+    return ret;
+}
 
+void wall_strip(indexed_triangle_set &ret, const Polygon &poly, double lower_z_mm, double upper_z_mm)
+{
     size_t startidx = ret.vertices.size();
     size_t offs     = poly.points.size();
 
-    ret.vertices.reserve(ret.vertices.size() + 2 *offs);
-
        // The expression unscaled(p).cast<float>().eval() is important here
        // as it ensures identical conversion of 2D scaled coordinates to float 3D
        // to that used by the tesselation. This way, the duplicated vertices in the
@@ -276,8 +281,6 @@ indexed_triangle_set wall_strip(const Polygon &poly, double lower_z_mm, double u
 
     ret.indices.emplace_back(startidx + offs - 1, startidx, startidx + 2 * offs - 1);
     ret.indices.emplace_back(startidx, startidx + offs, startidx + 2 * offs - 1);
-
-    return ret;
 }
 
 } // namespace Slic3r
@@ -25,6 +25,12 @@ extern std::vector<Vec2f> triangulate_expolygons_2f(const ExPolygons &polys, boo
 indexed_triangle_set wall_strip(const Polygon &poly,
                                 double         lower_z_mm,
                                 double         upper_z_mm);
+// Append the wall strip to out, which may be reserved by the caller for
+// 2 * poly.size() more vertices and faces.
+void wall_strip(indexed_triangle_set &out,
+                const Polygon        &poly,
+                double                lower_z_mm,
+                double                upper_z_mm);
 
 } // namespace Slic3r
 
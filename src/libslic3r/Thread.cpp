@@ -24,6 +24,8 @@
 #include "Utils.hpp"
 #include "LocalesUtils.hpp"
 
+#include <boost/log/trivial.hpp>
+
 namespace Slic3r {
 
 #ifdef _WIN32
@@ -225,10 +227,10 @@ ThreadData& thread_data()
 // Also it sets locale of the worker threads to "C" for the G-code generator to produce "." as a decimal separator.
 void name_tbb_thread_pool_threads_set_locale()
 {
-	static bool initialized = false;
-	if (initialized)
+	// May be called by Print instances processed concurrently.
+	static std::atomic<bool> initialized { false };
+	if (initialized.exchange(true))
 		return;
-	initialized = true;
 
 	// see GH issue #5661 PrusaSlicer hangs on Linux when run with non standard task affinity
 	// TBB will respect the task affinity mask on Linux and spawn less threads than std::thread::hardware_concurrency().
@@ -284,6 +286,77 @@ void set_current_thread_qos()
 #endif // __APPLE__
 }
 
+ConcurrentJobs::ConcurrentJobs(size_t max_jobs, int max_concurrency)
+{
+    max_jobs = std::max<size_t>(1, max_jobs);
+    const int concurrency = std::max(1, max_concurrency / int(max_jobs));
+    m_threads.reserve(max_jobs);
+    for (size_t i = 0; i < max_jobs; ++ i)
+        m_threads.emplace_back(create_thread([this, i, concurrency] { this->thread_proc(i, concurrency); }));
+}
+
+ConcurrentJobs::~ConcurrentJobs()
+{
+    this->wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for (boost::thread &thread : m_threads)
+        thread.join();
+}
+
+void ConcurrentJobs::run(std::function<void()> job)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return ! m_job && m_running < m_threads.size(); });
+        m_job = std::move(job);
+    }
+    m_condition.notify_all();
+}
+
+void ConcurrentJobs::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this] { return ! m_job && m_running == 0; });
+}
+
+void ConcurrentJobs::thread_proc(size_t idx, int concurrency)
+{
+    set_current_thread_name(("slic3r_job_" + std::to_string(idx)).c_str());
+    set_c_locales();
+
+    tbb::task_arena arena(concurrency);
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stop || m_job; });
+            if (! m_job)
+                break;
+            job = std::move(m_job);
+            m_job = nullptr;
+            ++ m_running;
+        }
+        m_condition.notify_all();
+
+        try {
+            arena.execute(job);
+        } catch (const std::exception &ex) {
+            BOOST_LOG_TRIVIAL(error) << "Concurrent job failed: " << ex.what();
+        }
+        job = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            -- m_running;
+        }
+        m_condition.notify_all();
+    }
+}
+
 void ThreadData::tbb_worker_thread_set_c_locales()
 {
 //    static std::atomic<int> cnt = 0;
@@ -8,9 +8,14 @@
 #include <utility>
 #include <string>
 #include <thread>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
 #include <random>
 #include <boost/thread.hpp>
 
+#include <tbb/task_arena.h>
 #include <tbb/task_scheduler_observer.h>
 #include <tbb/enumerable_thread_specific.h>
 
@@ -108,6 +113,33 @@ public:
     void on_scheduler_entry(bool /* is_worker */) override { thread_data().tbb_worker_thread_set_c_locales(); }
 };
 
+// Runs up to max_jobs jobs at once, each one on its own thread inside of its own tbb::task_arena.
+// An arena is limited to its share of max_concurrency, thus the concurrent jobs share the TBB worker threads
+// fairly instead of competing for all of them. The jobs should not throw, exceptions are logged and dropped.
+class ConcurrentJobs
+{
+public:
+    explicit ConcurrentJobs(size_t max_jobs, int max_concurrency = tbb::this_task_arena::max_concurrency());
+    // Waits for all the jobs.
+    ~ConcurrentJobs();
+
+    // Starts the job, blocks while all the threads are busy.
+    void run(std::function<void()> job);
+    // Waits for all the jobs started so far.
+    void wait();
+
+private:
+    void thread_proc(size_t idx, int concurrency);
+
+    std::mutex                  m_mutex;
+    std::condition_variable     m_condition;
+    // Job waiting for a thread
+    std::function<void()>       m_job;
+    size_t                      m_running { 0 };
+    bool                        m_stop { false };
+    std::vector<boost::thread>  m_threads;
+};
+
 }
 
 #endif // GUI_THREAD_HPP
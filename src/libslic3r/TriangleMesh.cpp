@@ -31,17 +31,28 @@
 
 #include <cmath>
 #include <deque>
+#include <limits>
+#include <numeric>
 #include <queue>
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <atomic>
 #include <type_traits>
 
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/predef/other/endian.h>
 
+#include <tbb/blocked_range.h>
 #include <tbb/concurrent_vector.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
+#include <ankerl/unordered_dense.h>
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
@@ -194,8 +205,53 @@ static void trianglemesh_repair_on_import(stl_file &stl)
     BOOST_LOG_TRIVIAL(debug) << "TriangleMesh::repair() finished";
 }
 
+// Load a binary STL without the admesh stl_file, if the welded mesh is a closed, consistently oriented manifold
+// without degenerate faces, which the admesh repair would not modify besides flipping a mesh with a negative volume.
+// Returns false if the mesh has to be loaded and repaired by admesh.
+static bool read_stl_binary_manifold(const char *input_file, indexed_triangle_set &its, TriangleMeshStats &stats)
+{
+    if (! its_read_stl_binary(input_file, its))
+        return false;
+    bool manifold = std::none_of(its.indices.begin(), its.indices.end(), [](const stl_triangle_vertex_indices &f) { return f(0) == f(1) || f(1) == f(2) || f(2) == f(0); });
+    std::vector<Vec3i> face_neighbors;
+    if (manifold) {
+        face_neighbors = its_face_neighbors_par(its);
+        // Each edge shall be paired with an oppositely oriented edge of a neighbor face.
+        for (int face_idx = 0; manifold && face_idx < int(face_neighbors.size()); ++ face_idx)
+            for (int neighbor : face_neighbors[face_idx])
+                if (neighbor < 0 || (face_neighbors[neighbor].array() != face_idx).all()) {
+                    manifold = false;
+                    break;
+                }
+    }
+    if (! manifold) {
+        BOOST_LOG_TRIVIAL(debug) << "read_stl_binary_manifold: " << input_file << " is not a manifold, will be repaired by admesh";
+        its = {};
+        return false;
+    }
+    stats.number_of_facets = its.indices.size();
+    stats.volume           = its_volume(its);
+    if (stats.volume < 0) {
+        // Reported the same way as by stl_fix_normal_directions().
+        its_flip_triangles(its);
+        stats.volume = - stats.volume;
+        stats.repaired_errors.facets_reversed = int(its.indices.size());
+    }
+    update_bounding_box(its, stats);
+    stats.number_of_parts  = its_number_of_patches(its, face_neighbors);
+    stats.open_edges       = 0;
+    return true;
+}
+
 bool TriangleMesh::ReadSTLFile(const char* input_file, bool repair)
 { 
+    if (repair) {
+        // Fast path for large binary STLs, which avoids the stl_file with its facets and neighbors.
+        m_stats.clear();
+        if (read_stl_binary_manifold(input_file, this->its, m_stats))
+            return true;
+    }
+
     stl_file stl;
     if (! stl_open(&stl, input_file))
         return false;
@@ -690,10 +746,11 @@ std::vector<Vec3i> its_face_edge_ids(const indexed_triangle_set &its, std::vecto
 int its_merge_vertices(indexed_triangle_set &its, bool shrink_to_fit)
 {
     // 1) Sort indices to vertices lexicographically by coordinates AND vertex index.
+    // The order is total, thus the parallel sort is deterministic.
     auto sorted = reserve_vector<int>(its.vertices.size());
     for (int i = 0; i < int(its.vertices.size()); ++ i)
         sorted.emplace_back(i);
-    std::sort(sorted.begin(), sorted.end(), [&its](int il, int ir) {
+    tbb::parallel_sort(sorted.begin(), sorted.end(), [&its](int il, int ir) {
         const Vec3f &l = its.vertices[il];
         const Vec3f &r = its.vertices[ir];
         // Sort lexicographically by coordinates AND vertex index.
@@ -1398,7 +1455,7 @@ indexed_triangle_set its_make_snap(double r, double h, float space_proportion, f
     return mesh;
 }
 
-indexed_triangle_set its_convex_hull(const std::vector<Vec3f> &pts)
+static indexed_triangle_set its_convex_hull_qhull(const std::vector<Vec3f> &pts)
 {
     std::vector<Vec3f>  dst_vertices;
     std::vector<Vec3i>  dst_facets;
@@ -1482,6 +1539,86 @@ indexed_triangle_set its_convex_hull(const std::vector<Vec3f> &pts)
     return { std::move(dst_facets), std::move(dst_vertices) };
 }
 
+// Discard the points strictly inside the convex hull of the extreme points of pts in 26 directions (Akl-Toussaint heuristic).
+// These points cannot be vertices of the convex hull of pts, thus qhull gives the same result on the remaining points.
+static std::vector<Vec3f> its_convex_hull_candidates(const std::vector<Vec3f> &pts)
+{
+    static constexpr size_t granularity = 4096;
+
+    std::array<Vec3f, 26> directions;
+    {
+        size_t idx = 0;
+        for (int x = -1; x <= 1; ++ x)
+            for (int y = -1; y <= 1; ++ y)
+                for (int z = -1; z <= 1; ++ z)
+                    if (x != 0 || y != 0 || z != 0)
+                        directions[idx ++] = Vec3f(float(x), float(y), float(z));
+    }
+    // Index of the first point reaching the maximum along each direction.
+    using Extremes = std::array<size_t, 26>;
+    auto merge_extremes = [&pts, &directions](Extremes a, const Extremes &b) {
+        for (size_t i = 0; i < directions.size(); ++ i) {
+            float da = directions[i].dot(pts[a[i]]);
+            float db = directions[i].dot(pts[b[i]]);
+            if (db > da || (db == da && b[i] < a[i]))
+                a[i] = b[i];
+        }
+        return a;
+    };
+    Extremes init;
+    init.fill(0);
+    Extremes extremes = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, pts.size(), granularity), init,
+        [&pts, &directions](const tbb::blocked_range<size_t> &range, Extremes extremes) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                for (size_t j = 0; j < directions.size(); ++ j)
+                    if (directions[j].dot(pts[i]) > directions[j].dot(pts[extremes[j]]))
+                        extremes[j] = i;
+            return extremes;
+        }, merge_extremes);
+    std::sort(extremes.begin(), extremes.end());
+    std::vector<Vec3f> extreme_pts;
+    for (auto it = extremes.begin(); it != std::unique(extremes.begin(), extremes.end()); ++ it)
+        extreme_pts.emplace_back(pts[*it]);
+
+    // Planes of the outward oriented faces of the hull of the extreme points.
+    indexed_triangle_set inner = its_convex_hull_qhull(extreme_pts);
+    if (inner.indices.size() < 4)
+        // Degenerate hull of the extreme points, nothing to discard.
+        return pts;
+    BoundingBoxf3 bbox;
+    for (const Vec3f &p : extreme_pts)
+        bbox.merge(p.cast<double>());
+    // Keep the points close to the planes to stay on the safe side with the rounding errors.
+    const float eps = float(1e-5 * bbox.size().maxCoeff());
+    std::vector<std::pair<Vec3f, float>> planes;
+    planes.reserve(inner.indices.size());
+    for (const stl_triangle_vertex_indices &face : inner.indices) {
+        Vec3f n = its_face_normal(inner, face);
+        if (! n.allFinite())
+            // Degenerate face, the inside test would not be reliable.
+            return pts;
+        planes.emplace_back(n, n.dot(inner.vertices[face(0)]) - eps);
+    }
+
+    std::vector<char> keep(pts.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, pts.size(), granularity), [&pts, &planes, &keep](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            keep[i] = std::any_of(planes.begin(), planes.end(), [&p = pts[i]](const std::pair<Vec3f, float> &plane) { return plane.first.dot(p) >= plane.second; });
+    });
+    std::vector<Vec3f> out;
+    for (size_t i = 0; i < pts.size(); ++ i)
+        if (keep[i])
+            out.emplace_back(pts[i]);
+    return out;
+}
+
+indexed_triangle_set its_convex_hull(const std::vector<Vec3f> &pts)
+{
+    // Filtering the input pays off for larger inputs only.
+    static constexpr size_t min_points_to_filter = 32768;
+    return pts.size() < min_points_to_filter ? its_convex_hull_qhull(pts) : its_convex_hull_qhull(its_convex_hull_candidates(pts));
+}
+
 void its_reverse_all_facets(indexed_triangle_set &its)
 {
     for (stl_triangle_vertex_indices &face : its.indices)
@@ -1630,27 +1767,34 @@ size_t its_num_open_edges(const indexed_triangle_set &its)
 
 void VertexFaceIndex::create(const indexed_triangle_set &its)
 {
+    static constexpr size_t granularity = 4096;
+
+    // 1) Calculate vertex incidence by scatter in parallel.
+    std::vector<std::atomic<size_t>> vertex_faces_cnt(its.vertices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size(), granularity), [&its, &vertex_faces_cnt](const tbb::blocked_range<size_t> &range) {
+        for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx)
+            for (int i = 0; i < 3; ++ i)
+                vertex_faces_cnt[its.indices[face_idx](i)].fetch_add(1, std::memory_order_relaxed);
+    });
+    // 2) Prefix sum to calculate offsets to m_vertex_faces_all.
     m_vertex_to_face_start.assign(its.vertices.size() + 1, 0);
-    // 1) Calculate vertex incidence by scatter.
-    for (auto &face : its.indices) {
-        ++ m_vertex_to_face_start[face(0) + 1];
-        ++ m_vertex_to_face_start[face(1) + 1];
-        ++ m_vertex_to_face_start[face(2) + 1];
+    for (size_t i = 0; i < vertex_faces_cnt.size(); ++ i) {
+        m_vertex_to_face_start[i + 1] = m_vertex_to_face_start[i] + vertex_faces_cnt[i].load(std::memory_order_relaxed);
+        vertex_faces_cnt[i].store(m_vertex_to_face_start[i], std::memory_order_relaxed);
     }
-    // 2) Prefix sum to calculate offsets to m_vertex_faces_all.
-    for (size_t i = 2; i < m_vertex_to_face_start.size(); ++ i)
-        m_vertex_to_face_start[i] += m_vertex_to_face_start[i - 1];
-    // 3) Scatter indices of faces incident to a vertex into m_vertex_faces_all.
+    // 3) Scatter indices of faces incident to a vertex into m_vertex_faces_all in parallel,
+    // the counters of vertex incidence being reused as the insertion cursors.
     m_vertex_faces_all.assign(m_vertex_to_face_start.back(), 0);
-    for (size_t face_idx = 0; face_idx < its.indices.size(); ++ face_idx) {
-        auto &face = its.indices[face_idx];
-        for (int i = 0; i < 3; ++ i)
-            m_vertex_faces_all[m_vertex_to_face_start[face(i)] ++] = face_idx;
-    }
-    // 4) The previous loop modified m_vertex_to_face_start. Revert the change.
-    for (auto i = int(m_vertex_to_face_start.size()) - 1; i > 0; -- i)
-        m_vertex_to_face_start[i] = m_vertex_to_face_start[i - 1];
-    m_vertex_to_face_start.front() = 0;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size(), granularity), [this, &its, &vertex_faces_cnt](const tbb::blocked_range<size_t> &range) {
+        for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx)
+            for (int i = 0; i < 3; ++ i)
+                m_vertex_faces_all[vertex_faces_cnt[its.indices[face_idx](i)].fetch_add(1, std::memory_order_relaxed)] = face_idx;
+    });
+    // 4) The faces were scattered in an arbitrary order, sort the faces of each vertex to keep the index deterministic.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.vertices.size(), granularity), [this](const tbb::blocked_range<size_t> &range) {
+        for (size_t vertex_idx = range.begin(); vertex_idx < range.end(); ++ vertex_idx)
+            std::sort(m_vertex_faces_all.begin() + m_vertex_to_face_start[vertex_idx], m_vertex_faces_all.begin() + m_vertex_to_face_start[vertex_idx + 1]);
+    });
 }
 
 std::vector<Vec3i> its_face_neighbors(const indexed_triangle_set &its)
@@ -1747,5 +1891,144 @@ bool its_write_stl_binary(const char *file, const char *label, const std::vector
     return true;
 }
 
+// Position of a vertex of a binary STL compared by the bits of its coordinates, the same way as stl_check_facets_exact() does.
+struct StlVertexKey
+{
+    uint32_t bits[3];
+    bool operator==(const StlVertexKey &rhs) const { return bits[0] == rhs.bits[0] && bits[1] == rhs.bits[1] && bits[2] == rhs.bits[2]; }
+};
+
+struct StlVertexKeyHash
+{
+    using is_avalanching = void;
+    uint64_t operator()(const StlVertexKey &key) const noexcept { return ankerl::unordered_dense::detail::wyhash::hash(key.bits, sizeof(key.bits)); }
+};
+
+bool its_read_stl_binary(const char *file, indexed_triangle_set &its)
+{
+    its.clear();
+#if BOOST_ENDIAN_BIG_BYTE
+    // Let admesh swap the bytes.
+    return false;
+#else // BOOST_ENDIAN_BIG_BYTE
+    boost::iostreams::mapped_file_source mapped;
+    try {
+        mapped.open(boost::filesystem::path(file));
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "its_read_stl_binary: Couldn't map " << file << ": " << ex.what();
+        return false;
+    }
+    // Binary / ASCII detection and size validation of stl_open().
+    const size_t size = mapped.size();
+    if (size < STL_MIN_FILE_SIZE || (size - HEADER_SIZE) % SIZEOF_STL_FACET != 0)
+        return false;
+    const auto *data = reinterpret_cast<const unsigned char*>(mapped.data());
+    if (std::none_of(data + HEADER_SIZE, data + HEADER_SIZE + 128, [](unsigned char c) { return c > 127; }))
+        return false;
+    const size_t num_facets = (size - HEADER_SIZE) / SIZEOF_STL_FACET;
+    const size_t num_corners = num_facets * 3;
+    // Corner indices are stored into the int indices while welding.
+    if (num_corners > size_t(std::numeric_limits<int>::max()))
+        return false;
+
+    data += HEADER_SIZE;
+    auto corner_key = [data](size_t corner) {
+        StlVertexKey key;
+        ::memcpy(key.bits, data + (corner / 3) * SIZEOF_STL_FACET + sizeof(stl_normal) + (corner % 3) * sizeof(stl_vertex), sizeof(stl_vertex));
+        // Switch negative zeros to positive zeros.
+        for (uint32_t &b : key.bits)
+            if (b == 0x80000000u)
+                b = 0;
+        return key;
+    };
+    // The corners are distributed into a fixed number of shards by the hash of their position, thus the welding
+    // of each shard is independent and the result does not depend on the number of threads.
+    // The shard is selected by the lowest bits of the hash, while ankerl::unordered_dense indexes its buckets by the highest bits.
+    static constexpr const size_t num_shards = 256;
+    static constexpr const size_t block_size = 1 << 16;
+    auto corner_shard = [](const StlVertexKey &key) { return size_t(StlVertexKeyHash{}(key) & (num_shards - 1)); };
+    const size_t num_blocks = (num_corners + block_size - 1) / block_size;
+
+    // Counting sort of the corners by their shard. Corners of a shard are sorted by their index.
+    std::vector<uint32_t> block_shard_offsets(num_blocks * num_shards, 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t iblock = range.begin(); iblock < range.end(); ++ iblock) {
+            uint32_t *counts = block_shard_offsets.data() + iblock * num_shards;
+            for (size_t corner = iblock * block_size; corner < std::min(num_corners, (iblock + 1) * block_size); ++ corner)
+                ++ counts[corner_shard(corner_key(corner))];
+        }
+    });
+    std::vector<uint32_t> shard_begin(num_shards + 1, 0);
+    {
+        uint32_t offset = 0;
+        for (size_t ishard = 0; ishard < num_shards; ++ ishard) {
+            shard_begin[ishard] = offset;
+            for (size_t iblock = 0; iblock < num_blocks; ++ iblock) {
+                uint32_t &cnt = block_shard_offsets[iblock * num_shards + ishard];
+                uint32_t  next = offset + cnt;
+                cnt    = offset;
+                offset = next;
+            }
+        }
+        shard_begin.back() = offset;
+    }
+    std::vector<uint32_t> sorted_corners(num_corners);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t iblock = range.begin(); iblock < range.end(); ++ iblock) {
+            uint32_t *offsets = block_shard_offsets.data() + iblock * num_shards;
+            for (size_t corner = iblock * block_size; corner < std::min(num_corners, (iblock + 1) * block_size); ++ corner)
+                sorted_corners[offsets[corner_shard(corner_key(corner))] ++] = uint32_t(corner);
+        }
+    });
+    block_shard_offsets = {};
+
+    // Weld the corners of each shard: each corner is assigned the index of the first corner with the same position.
+    its.indices.assign(num_facets, stl_triangle_vertex_indices(-1, -1, -1));
+    int *corner_first = its.indices.front().data();
+    static_assert(sizeof(stl_triangle_vertex_indices) == 3 * sizeof(int), "stl_triangle_vertex_indices is expected to be packed");
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_shards, 1), [&](const tbb::blocked_range<size_t> &range) {
+        ankerl::unordered_dense::map<StlVertexKey, uint32_t, StlVertexKeyHash> map;
+        for (size_t ishard = range.begin(); ishard < range.end(); ++ ishard) {
+            map.clear();
+            map.reserve((shard_begin[ishard + 1] - shard_begin[ishard]) / 4);
+            for (uint32_t i = shard_begin[ishard]; i < shard_begin[ishard + 1]; ++ i) {
+                uint32_t corner = sorted_corners[i];
+                corner_first[corner] = int(map.try_emplace(corner_key(corner), corner).first->second);
+            }
+        }
+    });
+
+    // Number the vertices in the order of their first occurrence, as stl_generate_shared_vertices() does.
+    // sorted_corners is reused to store the vertex index of the first corners.
+    std::vector<uint32_t> &vertex_idx = sorted_corners;
+    std::vector<uint32_t>  block_first_vertex(num_blocks + 1, 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t iblock = range.begin(); iblock < range.end(); ++ iblock) {
+            uint32_t cnt = 0;
+            for (size_t corner = iblock * block_size; corner < std::min(num_corners, (iblock + 1) * block_size); ++ corner)
+                if (corner_first[corner] == int(corner))
+                    ++ cnt;
+            block_first_vertex[iblock + 1] = cnt;
+        }
+    });
+    std::partial_sum(block_first_vertex.begin(), block_first_vertex.end(), block_first_vertex.begin());
+    its.vertices.assign(block_first_vertex.back(), stl_vertex());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t iblock = range.begin(); iblock < range.end(); ++ iblock) {
+            uint32_t idx = block_first_vertex[iblock];
+            for (size_t corner = iblock * block_size; corner < std::min(num_corners, (iblock + 1) * block_size); ++ corner)
+                if (corner_first[corner] == int(corner)) {
+                    ::memcpy(its.vertices[idx].data(), data + (corner / 3) * SIZEOF_STL_FACET + sizeof(stl_normal) + (corner % 3) * sizeof(stl_vertex), sizeof(stl_vertex));
+                    vertex_idx[corner] = idx ++;
+                }
+        }
+    });
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_corners), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t corner = range.begin(); corner < range.end(); ++ corner)
+            corner_first[corner] = int(vertex_idx[corner_first[corner]]);
+    });
+    return true;
+#endif // BOOST_ENDIAN_BIG_BYTE
+}
 
 } // namespace Slic3r
@@ -348,6 +348,9 @@ bool        its_write_stl_ascii(const char *file, const char *label, const std::
 inline bool its_write_stl_ascii(const char *file, const char *label, const indexed_triangle_set &its) { return its_write_stl_ascii(file, label, its.indices, its.vertices); }
 bool        its_write_stl_binary(const char *file, const char *label, const std::vector<stl_triangle_vertex_indices> &indices, const std::vector<stl_vertex> &vertices);
 inline bool its_write_stl_binary(const char *file, const char *label, const indexed_triangle_set &its) { return its_write_stl_binary(file, label, its.indices, its.vertices); }
+// Read a binary STL through a memory mapped file, weld the vertices with the same coordinates in parallel.
+// Returns false if the file could not be read or if it is not a binary STL by the admesh rules, then its is left empty.
+bool        its_read_stl_binary(const char *file, indexed_triangle_set &its);
 
 inline BoundingBoxf3 bounding_box(const TriangleMesh &m) { return m.bounding_box(); }
 inline BoundingBoxf3 bounding_box(const indexed_triangle_set& its)
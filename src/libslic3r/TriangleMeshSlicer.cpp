@@ -15,12 +15,14 @@
 #include <queue>
 #include <mutex>
 #include <new>
+#include <numeric>
 #include <utility>
 
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
 #include <tbb/scalable_allocator.h>
+#include <tbb/task_arena.h>
 
 #include <ankerl/unordered_dense.h>
 
@@ -366,6 +368,47 @@ inline FacetSliceType slice_facet(
     return FacetSliceType::NoSlice;
 }
 
+// Specialization of slice_facet() for a facet crossing the slicing plane with none of its vertices on the plane,
+// which is the case for the vast majority of facets. Such a facet is always sliced at two of its edges,
+// thus the result is the same FacetSliceType::Slicing intersection line slice_facet() would produce.
+template<typename T>
+inline void slice_facet_general_position(
+    T                                               slice_z,
+    const Eigen::Matrix<T, 3, 1, Eigen::DontAlign> *vertices,
+    const stl_triangle_vertex_indices              &indices,
+    const Vec3i                                    &edge_ids,
+    const int                                       idx_vertex_lowest,
+    IntersectionLine                               &line_out)
+{
+    using             Vector = Eigen::Matrix<T, 3, 1, Eigen::DontAlign>;
+    IntersectionPoint points[2];
+    size_t            num_points = 0;
+    for (int j = 0; j < 3; ++ j) {
+        int k = (idx_vertex_lowest + j) % 3;
+        int l = (k + 1) % 3;
+        if ((vertices[k].z() < slice_z) == (vertices[l].z() < slice_z))
+            continue;
+        // Sort the edge to give a consistent answer, see slice_facet().
+        const Vector *a = vertices + k;
+        const Vector *b = vertices + l;
+        if (indices[k] > indices[l])
+            std::swap(a, b);
+        double t = (double(slice_z) - double(a->z())) / (double(b->z()) - double(a->z()));
+        IntersectionPoint &point = points[num_points ++];
+        static_cast<Point&>(point) =
+            t <= 0. ? v3f_scaled_to_contour_point(*a) :
+            t >= 1. ? v3f_scaled_to_contour_point(*b) :
+            v3f_scaled_to_contour_point(a->template head<2>().template cast<double>() * (1. - t) + b->template head<2>().template cast<double>() * t + Vec2d(0.5, 0.5));
+        point.edge_id = edge_ids(k);
+    }
+    assert(num_points == 2);
+    line_out.edge_type  = IntersectionLine::FacetEdgeType::General;
+    line_out.a          = static_cast<const Point&>(points[1]);
+    line_out.b          = static_cast<const Point&>(points[0]);
+    line_out.edge_a_id  = points[1].edge_id;
+    line_out.edge_b_id  = points[0].edge_id;
+}
+
 class LinesMutexes {
 public:
     std::mutex& operator()(size_t slice_id) {
@@ -440,6 +483,177 @@ static inline std::vector<IntersectionLines> slice_make_lines(
     return lines;
 }
 
+// Minimum number of slicing planes to slice with slice_make_lines_sweep() instead of slice_make_lines().
+static constexpr const size_t slice_sweep_min_layers = 64;
+
+// Alternative to slice_make_lines() for dense stacks of slicing planes, producing the same intersection lines.
+// The facets are bucket sorted by their lowest slicing plane, then chunks of consecutive slicing planes are swept
+// bottom up in parallel, maintaining the set of facets crossing the current plane. Each layer reserves its lines
+// for the number of active facets, thus the layers are filled without locking and without reallocation,
+// and the order of the lines is deterministic.
+template<typename ThrowOnCancel>
+static inline std::vector<IntersectionLines> slice_make_lines_sweep(
+    // Vertices already transformed for slicing.
+    const std::vector<stl_vertex>                   &vertices,
+    const std::vector<stl_triangle_vertex_indices>  &indices,
+    const std::vector<Vec3i>                        &face_edge_ids,
+    const std::vector<float>                        &zs,
+    const ThrowOnCancel                              throw_on_cancel_fn)
+{
+    // Range of slicing planes [first, last) crossing a facet.
+    struct FacetSpan {
+        int first;
+        int last;
+    };
+    const int              num_layers = int(zs.size());
+    std::vector<FacetSpan> spans(indices.size());
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, int(indices.size())),
+        [&vertices, &indices, &zs, &spans, num_layers](const tbb::blocked_range<int> &range) {
+            for (int face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                const stl_triangle_vertex_indices &tri = indices[face_idx];
+                const float min_z = fminf(vertices[tri(0)].z(), fminf(vertices[tri(1)].z(), vertices[tri(2)].z()));
+                const float max_z = fmaxf(vertices[tri(0)].z(), fmaxf(vertices[tri(1)].z(), vertices[tri(2)].z()));
+                FacetSpan  &span  = spans[face_idx];
+                if (min_z == max_z) {
+                    // Ignore horizontal triangles, see slice_facet_at_zs().
+                    span.first = span.last = num_layers;
+                } else {
+                    span.first = int(std::lower_bound(zs.begin(), zs.end(), min_z) - zs.begin());
+                    span.last  = int(std::upper_bound(zs.begin() + span.first, zs.end(), max_z) - zs.begin());
+                }
+            }
+        });
+    throw_on_cancel_fn();
+
+    // Bucket sort the facets by their first slicing plane.
+    std::vector<int> layer_facets_begin(num_layers + 1, 0);
+    for (const FacetSpan &span : spans)
+        if (span.first < span.last)
+            ++ layer_facets_begin[span.first + 1];
+    std::partial_sum(layer_facets_begin.begin(), layer_facets_begin.end(), layer_facets_begin.begin());
+    std::vector<int> sorted_facets(layer_facets_begin.back());
+    {
+        std::vector<int> cursor(layer_facets_begin.begin(), layer_facets_begin.end() - 1);
+        for (int face_idx = 0; face_idx < int(spans.size()); ++ face_idx)
+            if (const FacetSpan &span = spans[face_idx]; span.first < span.last)
+                sorted_facets[cursor[span.first] ++] = face_idx;
+    }
+
+    // Split the slicing planes into chunks to be swept in parallel. Facets starting below a chunk and crossing its first plane
+    // are collected for each chunk to initialize its sweep.
+    const int num_chunks = std::min(num_layers, 8 * std::max(1, tbb::this_task_arena::max_concurrency()));
+    const int chunk_size = (num_layers + num_chunks - 1) / num_chunks;
+    std::vector<std::vector<int>> chunk_active(num_chunks);
+    for (int face_idx = 0; face_idx < int(spans.size()); ++ face_idx)
+        if (const FacetSpan &span = spans[face_idx]; span.first < span.last)
+            for (int chunk = span.first / chunk_size + 1; chunk < num_chunks && chunk * chunk_size < span.last; ++ chunk)
+                chunk_active[chunk].emplace_back(face_idx);
+    throw_on_cancel_fn();
+
+    // Per facet data invariant over the sweep: the index of the lowest vertex, see slice_facet_at_zs().
+    std::vector<int8_t> idx_vertex_lowest(indices.size());
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, int(indices.size())),
+        [&vertices, &indices, &spans, &idx_vertex_lowest](const tbb::blocked_range<int> &range) {
+            for (int face_idx = range.begin(); face_idx < range.end(); ++ face_idx)
+                if (const FacetSpan &span = spans[face_idx]; span.first < span.last) {
+                    const stl_triangle_vertex_indices &tri = indices[face_idx];
+                    const float min_z = fminf(vertices[tri(0)].z(), fminf(vertices[tri(1)].z(), vertices[tri(2)].z()));
+                    idx_vertex_lowest[face_idx] = (vertices[tri(1)].z() == min_z) ? 1 : ((vertices[tri(2)].z() == min_z) ? 2 : 0);
+                }
+        });
+    throw_on_cancel_fn();
+
+    std::vector<IntersectionLines> lines(zs.size(), IntersectionLines{});
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, num_chunks, 1),
+        [&vertices, &indices, &face_edge_ids, &zs, &spans, &idx_vertex_lowest, &layer_facets_begin, &sorted_facets, &chunk_active, &lines, num_layers, chunk_size, throw_on_cancel_fn]
+        (const tbb::blocked_range<int> &range) {
+            // Active facets stored as structure of arrays, so that retiring the facets and classifying them against
+            // the slicing plane are simple loops over contiguous memory, which the compiler vectorizes.
+            struct ActiveFacets {
+                std::vector<int>     face_idx;
+                std::vector<int>     last;
+                std::vector<float>   z[3];
+                std::vector<uint8_t> on_plane;
+
+                void push_back(const int face, const int face_last, const stl_vertex *facet_vertices) {
+                    face_idx.emplace_back(face);
+                    last.emplace_back(face_last);
+                    for (int i = 0; i < 3; ++ i)
+                        z[i].emplace_back(facet_vertices[i].z());
+                }
+                void retire(const int layer_id) {
+                    size_t j = 0;
+                    for (size_t i = 0; i < face_idx.size(); ++ i)
+                        if (last[i] > layer_id) {
+                            face_idx[j] = face_idx[i];
+                            last[j]     = last[i];
+                            z[0][j]     = z[0][i];
+                            z[1][j]     = z[1][i];
+                            z[2][j]     = z[2][i];
+                            ++ j;
+                        }
+                    face_idx.resize(j);
+                    last.resize(j);
+                    for (int i = 0; i < 3; ++ i)
+                        z[i].resize(j);
+                }
+                // Mark the facets touching the slicing plane with at least one vertex. These need the full slice_facet() treatment.
+                void classify(const float slice_z) {
+                    const size_t n = face_idx.size();
+                    on_plane.resize(n);
+                    const float *z0 = z[0].data();
+                    const float *z1 = z[1].data();
+                    const float *z2 = z[2].data();
+                    uint8_t     *out = on_plane.data();
+                    for (size_t i = 0; i < n; ++ i)
+                        out[i] = uint8_t((z0[i] == slice_z) | (z1[i] == slice_z) | (z2[i] == slice_z));
+                }
+            };
+            ActiveFacets active;
+            auto activate = [&vertices, &indices, &spans, &active](const int face_idx) {
+                const stl_triangle_vertex_indices &tri = indices[face_idx];
+                const stl_vertex facet_vertices[3] { vertices[tri(0)], vertices[tri(1)], vertices[tri(2)] };
+                active.push_back(face_idx, spans[face_idx].last, facet_vertices);
+            };
+            for (int chunk = range.begin(); chunk < range.end(); ++ chunk) {
+                active.face_idx.clear();
+                active.last.clear();
+                for (int i = 0; i < 3; ++ i)
+                    active.z[i].clear();
+                for (const int face_idx : chunk_active[chunk])
+                    activate(face_idx);
+                for (int layer_id = chunk * chunk_size; layer_id < std::min(num_layers, (chunk + 1) * chunk_size); ++ layer_id) {
+                    throw_on_cancel_fn();
+                    // Retire the facets below this plane, activate the facets starting at this plane.
+                    active.retire(layer_id);
+                    for (int i = layer_facets_begin[layer_id]; i < layer_facets_begin[layer_id + 1]; ++ i)
+                        activate(sorted_facets[i]);
+                    const float        slice_z     = zs[layer_id];
+                    IntersectionLines &layer_lines = lines[layer_id];
+                    layer_lines.reserve(active.face_idx.size());
+                    active.classify(slice_z);
+                    for (size_t i = 0; i < active.face_idx.size(); ++ i) {
+                        const int                          face_idx = active.face_idx[i];
+                        const stl_triangle_vertex_indices &tri      = indices[face_idx];
+                        const stl_vertex                   facet_vertices[3] { vertices[tri(0)], vertices[tri(1)], vertices[tri(2)] };
+                        IntersectionLine il;
+                        if (! active.on_plane[i]) {
+                            slice_facet_general_position(slice_z, facet_vertices, tri, face_edge_ids[face_idx], idx_vertex_lowest[face_idx], il);
+                            layer_lines.emplace_back(il);
+                        } else if (slice_facet(slice_z, facet_vertices, tri, face_edge_ids[face_idx], idx_vertex_lowest[face_idx], false, il) == FacetSliceType::Slicing) {
+                            assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+                            layer_lines.emplace_back(il);
+                        }
+                    }
+                }
+            }
+        });
+    return lines;
+}
+
 template<typename TransformVertex, typename FaceFilter>
 static inline IntersectionLines slice_make_lines(
     const std::vector<stl_vertex>                   &mesh_vertices,
@@ -1800,9 +2014,10 @@ std::vector<Polygons> slice_mesh(
             }
         } else {
             // Copy and scale vertices in XY, don't scale in Z. Possibly apply the transformation.
-            lines = slice_make_lines(
-                transform_mesh_vertices_for_slicing(mesh, params.trafo), 
-                [](const Vec3f &p) { return p; },  mesh.indices, face_edge_ids, zs, throw_on_cancel);
+            std::vector<stl_vertex> vertices = transform_mesh_vertices_for_slicing(mesh, params.trafo);
+            lines = zs.size() >= slice_sweep_min_layers ?
+                slice_make_lines_sweep(vertices, mesh.indices, face_edge_ids, zs, throw_on_cancel) :
+                slice_make_lines(vertices, [](const Vec3f &p) { return p; }, mesh.indices, face_edge_ids, zs, throw_on_cancel);
         }
     }
 
@@ -7,6 +7,8 @@
 
 #include <boost/container/small_vector.hpp>
 
+#include <ankerl/unordered_dense.h>
+
 #ifndef NDEBUG
 //    #define EXPENSIVE_DEBUG_CHECKS
 #endif // NDEBUG
@@ -258,24 +260,34 @@ void TriangleSelector::select_patch(int facet_start, std::unique_ptr<Cursor> &&c
     facets_to_check.reserve(16);
     facets_to_check.emplace_back(facet_start);
     // Keep track of facets of the original mesh we already processed.
-    std::vector<bool> visited(m_orig_size_indices, false);
+    // select_patch() is called for every segment of a brush stroke, thus the flags are allocated just once
+    // and only the flags of the facets touched by this call are cleared at the end, instead of allocating
+    // and clearing a flag for each facet of a possibly huge mesh.
+    if (m_select_patch_visited.size() != size_t(m_orig_size_indices))
+        m_select_patch_visited.assign(m_orig_size_indices, false);
+    m_select_patch_visited[facet_start] = true;
     // Breadth-first search around the hit point. facets_to_check may grow significantly large.
     // Head of the bread-first facets_to_check FIFO.
+    // A facet is marked as visited once pushed into facets_to_check, thus each facet is queued at most once.
     int facet_idx = 0;
     while (facet_idx < int(facets_to_check.size())) {
         int          facet        = facets_to_check[facet_idx];
         const Vec3f &facet_normal = m_face_normals[m_triangles[facet].source_triangle];
-        if (!visited[facet] && (highlight_by_angle_deg == 0.f || vec_down.dot(facet_normal) >= highlight_angle_limit)) {
+        if (highlight_by_angle_deg == 0.f || vec_down.dot(facet_normal) >= highlight_angle_limit) {
             if (select_triangle(facet, new_state, triangle_splitting)) {
                 // add neighboring facets to list to be processed later
                 for (int neighbor_idx : m_neighbors[facet])
-                    if (neighbor_idx >= 0 && m_cursor->is_facet_visible(neighbor_idx, m_face_normals))
+                    if (neighbor_idx >= 0 && !m_select_patch_visited[neighbor_idx] && m_cursor->is_facet_visible(neighbor_idx, m_face_normals)) {
+                        m_select_patch_visited[neighbor_idx] = true;
                         facets_to_check.push_back(neighbor_idx);
+                    }
             }
         }
-        visited[facet] = true;
         ++facet_idx;
     }
+
+    for (int facet : facets_to_check)
+        m_select_patch_visited[facet] = false;
 }
 
 bool TriangleSelector::is_facet_clipped(int facet_idx, const ClippingPlane &clp) const
@@ -1757,6 +1769,119 @@ bool TriangleSelector::has_facets(const std::pair<std::vector<std::pair<int, int
     return false;
 }
 
+indexed_triangle_set TriangleSelector::get_facets(const indexed_triangle_set &mesh, const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> &data, const EnforcerBlockerType state)
+{
+    // Vertices are identified by their index in the source mesh, midpoints of the split edges are numbered
+    // starting with the number of vertices of the source mesh. A midpoint is shared by all triangles splitting the same edge.
+    struct Decoder {
+        const indexed_triangle_set                                           &mesh;
+        const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> &data;
+        const EnforcerBlockerType                                             state;
+        int                                                                   ibit { 0 };
+        std::vector<Vec3f>                                                    midpoints;
+        ankerl::unordered_dense::map<uint64_t, int>                           edge_midpoint;
+        // Index of a vertex or a midpoint in the output mesh, -1 if not used yet.
+        std::vector<int>                                                      vertex_map;
+        indexed_triangle_set                                                  out;
+
+        int next_nibble() {
+            int n = 0;
+            for (int i = 0; i < 4; ++ i)
+                n |= data.second[ibit ++] << i;
+            return n;
+        }
+
+        const Vec3f& position(int v) const {
+            return v < int(mesh.vertices.size()) ? mesh.vertices[v] : midpoints[v - int(mesh.vertices.size())];
+        }
+
+        int midpoint(int va, int vb) {
+            auto [it, inserted] = edge_midpoint.try_emplace((uint64_t(std::min(va, vb)) << 32) | uint64_t(std::max(va, vb)), 0);
+            if (inserted) {
+                it->second = int(mesh.vertices.size() + midpoints.size());
+                midpoints.emplace_back(0.5f * (this->position(va) + this->position(vb)));
+                vertex_map.emplace_back(-1);
+            }
+            return it->second;
+        }
+
+        void emit(const Vec3i &verts) {
+            stl_triangle_vertex_indices indices;
+            for (int i = 0; i < 3; ++ i) {
+                int &j = vertex_map[verts[i]];
+                if (j == -1) {
+                    j = int(out.vertices.size());
+                    out.vertices.emplace_back(this->position(verts[i]));
+                }
+                indices[i] = j;
+            }
+            out.indices.emplace_back(indices);
+        }
+
+        // Decode the division tree of a triangle, split it the same way as perform_split() does.
+        void decode(const Vec3i &verts) {
+            int code = next_nibble();
+            int num_of_split_sides = code & 0b11;
+            if (num_of_split_sides == 0) {
+                // Value of the second nibble was subtracted by 3, so it is added back.
+                if (EnforcerBlockerType((code & 0b1100) == 0b1100 ? next_nibble() + 3 : code >> 2) == state)
+                    this->emit(verts);
+                return;
+            }
+            int special_side = code >> 2;
+            const Vec3i v(verts[special_side], verts[next_idx_modulo(special_side, 3)], verts[prev_idx_modulo(special_side, 3)]);
+            std::array<Vec3i, 4> children;
+            switch (num_of_split_sides) {
+            case 1:
+            {
+                int m12 = this->midpoint(v[2], v[1]);
+                children[0] = { v[0], v[1], m12 };
+                children[1] = { m12, v[2], v[0] };
+                break;
+            }
+            case 2:
+            {
+                int m01 = this->midpoint(v[1], v[0]);
+                int m20 = this->midpoint(v[0], v[2]);
+                children[0] = { v[0], m01, m20 };
+                children[1] = { m01, v[1], m20 };
+                children[2] = { v[1], v[2], m20 };
+                break;
+            }
+            default:
+            {
+                int m01 = this->midpoint(v[1], v[0]);
+                int m12 = this->midpoint(v[2], v[1]);
+                int m20 = this->midpoint(v[0], v[2]);
+                children[0] = { v[0], m01, m20 };
+                children[1] = { m01, v[1], m12 };
+                children[2] = { m12, v[2], m20 };
+                children[3] = { m01, m12, m20 };
+                break;
+            }
+            }
+            // Children are serialized in reverse order.
+            for (int child_idx = num_of_split_sides; child_idx >= 0; -- child_idx)
+                this->decode(children[child_idx]);
+        }
+    } decoder { mesh, data, state };
+
+    decoder.vertex_map.assign(mesh.vertices.size(), -1);
+    auto it_painted = data.first.begin();
+    for (int triangle_id = 0; triangle_id < int(mesh.indices.size()); ++ triangle_id) {
+        const Vec3i verts = mesh.indices[triangle_id];
+        if (it_painted != data.first.end() && it_painted->first == triangle_id) {
+            assert(it_painted->second < int(data.second.size()));
+            decoder.ibit = it_painted->second;
+            decoder.decode(verts);
+            ++ it_painted;
+        } else if (state == EnforcerBlockerType::NONE)
+            // Triangles not stored in data are not painted.
+            decoder.emit(verts);
+    }
+    return std::move(decoder.out);
+}
+
 void TriangleSelector::seed_fill_unselect_all_triangles()
 {
     for (Triangle &triangle : m_triangles)
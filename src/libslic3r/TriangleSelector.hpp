@@ -226,6 +226,10 @@ public:
     int                  num_facets(EnforcerBlockerType state) const;
     // Get facets at a given state. Don't triangulate T-joints.
     indexed_triangle_set get_facets(EnforcerBlockerType state) const;
+    // Lightweight variant of deserialize() followed by get_facets(): The division trees of the painted triangles are expanded
+    // straight from the serialized data and only the facets of the given state are produced, without allocating the Triangles,
+    // the Vertices and the neighbors of the whole mesh.
+    static indexed_triangle_set get_facets(const indexed_triangle_set &mesh, const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> &data, EnforcerBlockerType state);
     // Get facets at a given state. Triangulate T-joints.
     indexed_triangle_set get_facets_strict(EnforcerBlockerType state) const;
     // Get edges around the selected area by seed fill.
@@ -343,6 +347,9 @@ protected:
     // Zero indicates an uninitialized state.
     float m_old_cursor_radius_sqr = 0;
 
+    // Visited flags of the original facets reused by select_patch(), all false between the calls.
+    std::vector<bool> m_select_patch_visited;
+
     // Private functions:
 private:
     bool select_triangle(int facet_idx, EnforcerBlockerType type, bool triangle_splitting);
@@ -3,7 +3,7 @@
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
 #include "TriangleSetSampling.hpp"
-#include <map>
+#include <numeric>
 #include <random>
 #include <tbb/parallel_for.h>
 #include <tbb/blocked_range.h>
@@ -11,6 +11,9 @@
 namespace Slic3r {
 
 TriangleSetSamples sample_its_uniform_parallel(size_t samples_count, const indexed_triangle_set &triangle_set) {
+    if (triangle_set.indices.empty())
+        return { 0.f, {}, {}, {} };
+
     std::vector<double> triangles_area(triangle_set.indices.size());
 
     tbb::parallel_for(tbb::blocked_range<size_t>(0, triangle_set.indices.size()),
@@ -25,12 +28,11 @@ TriangleSetSamples sample_its_uniform_parallel(size_t samples_count, const index
                 }
             });
 
-    std::map<double, size_t> area_sum_to_triangle_idx;
-    float area_sum = 0;
-    for (size_t t_idx = 0; t_idx < triangles_area.size(); ++t_idx) {
-        area_sum += triangles_area[t_idx];
-        area_sum_to_triangle_idx[area_sum] = t_idx;
-    }
+    // Prefix sums of the triangle areas, the triangle of a sample is found by a binary search
+    // in this flat array. Triangles with zero area are never hit.
+    std::vector<double> area_prefix_sum(triangles_area.size());
+    std::partial_sum(triangles_area.begin(), triangles_area.end(), area_prefix_sum.begin());
+    const double area_sum = area_prefix_sum.back();
 
     std::mt19937_64 mersenne_engine { 27644437 };
     // random numbers on interval [0, 1)
@@ -44,17 +46,19 @@ TriangleSetSamples sample_its_uniform_parallel(size_t samples_count, const index
     std::generate(random_samples.begin(), random_samples.end(), get_random);
 
     TriangleSetSamples result;
-    result.total_area = area_sum;
+    result.total_area = float(area_sum);
     result.positions.resize(samples_count);
     result.normals.resize(samples_count);
     result.triangle_indices.resize(samples_count);
 
     tbb::parallel_for(tbb::blocked_range<size_t>(0, samples_count),
-            [&triangle_set, &area_sum_to_triangle_idx, &area_sum, &random_samples, &result](
+            [&triangle_set, &area_prefix_sum, area_sum, &random_samples, &result](
                     tbb::blocked_range<size_t> r) {
                 for (size_t s_idx = r.begin(); s_idx < r.end(); ++s_idx) {
                     double t_sample = random_samples[s_idx].x() * area_sum;
-                    size_t t_idx = area_sum_to_triangle_idx.upper_bound(t_sample)->second;
+                    size_t t_idx = std::min<size_t>(
+                        std::upper_bound(area_prefix_sum.begin(), area_prefix_sum.end(), t_sample) - area_prefix_sum.begin(),
+                        area_prefix_sum.size() - 1);
 
                     double sq_u = std::sqrt(random_samples[s_idx].y());
                     double v = random_samples[s_idx].z();
@@ -29,7 +29,11 @@ extern std::string format_memsize_MB(size_t n);
 // The string is non-empty if the loglevel >= info (3) or ignore_loglevel==true.
 // Latter is used to get the memory info from SysInfoDialog.
 extern std::string log_memory_info(bool ignore_loglevel = false);
+// Returns the peak resident memory of the process in bytes, zero if not known.
+extern size_t peak_memory_usage();
 extern void disable_multi_threading();
+// Limits the number of threads executing the parallel algorithms of TBB in the whole process, zero removes the limit.
+extern void set_max_threads(size_t max_threads);
 // Returns the size of physical memory (RAM) in bytes.
 extern size_t total_physical_memory();
 
@@ -2,7 +2,9 @@
 ///|/
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
+#include <algorithm>
 #include <exception>
+#include <memory>
 
 #include "miniz_extension.hpp"
 
@@ -12,6 +14,8 @@
 
 #include "libslic3r/I18N.hpp"
 
+#include <tbb/task_arena.h>
+
 namespace Slic3r {
 
 namespace {
@@ -156,4 +160,96 @@ std::string MZ_Archive::get_errorstr(mz_zip_error mz_err)
     return "unknown error";
 }
 
+MZ_ParallelStagedWriter::MZ_ParallelStagedWriter(mz_zip_writer_staged_context &context, int level) :
+    m_context(context), m_flags(tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY))
+{
+    m_current.reserve(block_size);
+}
+
+MZ_ParallelStagedWriter::~MZ_ParallelStagedWriter()
+{
+    m_tasks.wait();
+}
+
+bool MZ_ParallelStagedWriter::add(const char *data, size_t size)
+{
+    // Limit the memory held by the blocks waiting for compression if the data is produced faster than compressed.
+    const size_t max_blocks = size_t(std::max(2, 2 * tbb::this_task_arena::max_concurrency()));
+    while (size > 0) {
+        size_t n = std::min(size, block_size - m_current.size());
+        m_current.append(data, n);
+        data += n;
+        size -= n;
+        if (m_current.size() == block_size) {
+            this->compress_current_block();
+            if (m_blocks.size() >= max_blocks && ! this->write_blocks())
+                return false;
+        }
+    }
+    return true;
+}
+
+bool MZ_ParallelStagedWriter::finish()
+{
+    if (! m_current.empty())
+        this->compress_current_block();
+    return this->write_blocks() && mz_zip_writer_add_staged_finish(&m_context);
+}
+
+void MZ_ParallelStagedWriter::compress_current_block()
+{
+    // Appending to std::deque does not move its elements, thus the task may reference the block.
+    Block &block = m_blocks.emplace_back();
+    block.data = std::move(m_current);
+    m_current.clear();
+    m_current.reserve(block_size);
+    m_tasks.run([&block, flags = m_flags]() {
+        auto put_buf = [](const void *buf, int len, void *user) -> mz_bool {
+            auto &out = *static_cast<std::vector<unsigned char>*>(user);
+            out.insert(out.end(), static_cast<const unsigned char*>(buf), static_cast<const unsigned char*>(buf) + len);
+            return MZ_TRUE;
+        };
+        auto compressor = std::make_unique<tdefl_compressor>();
+        block.compressed.reserve(block.data.size() / 4);
+        // Sync flush aligns the end of the block to a byte boundary, so that the blocks may be concatenated.
+        block.failed = tdefl_init(compressor.get(), put_buf, &block.compressed, int(flags)) != TDEFL_STATUS_OKAY ||
+                       tdefl_compress_buffer(compressor.get(), block.data.data(), block.data.size(), TDEFL_SYNC_FLUSH) != TDEFL_STATUS_OKAY;
+    });
+}
+
+bool MZ_ParallelStagedWriter::write_blocks()
+{
+    m_tasks.wait();
+    bool ok = true;
+    for (const Block &block : m_blocks) {
+        if (block.failed) {
+            // Release the compressor as mz_zip_writer_add_staged_data() does on failure.
+            m_context.pZip->m_last_error = MZ_ZIP_COMPRESSION_FAILED;
+            m_context.pZip->m_pFree(m_context.pZip->m_pAlloc_opaque, m_context.pCompressor);
+            m_context.pCompressor = nullptr;
+            ok = false;
+            break;
+        }
+        if (! mz_zip_writer_add_staged_compressed_data(&m_context, block.compressed.data(), block.compressed.size(), block.data.data(), block.data.size())) {
+            ok = false;
+            break;
+        }
+    }
+    m_blocks.clear();
+    return ok;
+}
+
+bool add_mem_parallel(mz_zip_archive &zip, const std::string &name, const void *data, size_t size, mz_uint level_and_flags)
+{
+    const int level = int(level_and_flags) < 0 ? MZ_DEFAULT_LEVEL : int(level_and_flags & 0xF);
+    if (level == MZ_NO_COMPRESSION || size <= MZ_ParallelStagedWriter::block_size)
+        return mz_zip_writer_add_mem(&zip, name.c_str(), data, size, level_and_flags);
+
+    mz_zip_writer_staged_context context;
+    if (! mz_zip_writer_add_staged_open(&zip, &context, name.c_str(), size, nullptr, nullptr, 0, level_and_flags, nullptr, 0, nullptr, 0))
+        return false;
+    MZ_ParallelStagedWriter writer(context, level);
+    return writer.add(static_cast<const char*>(data), size) && writer.finish();
+}
+
 } // namespace Slic3r
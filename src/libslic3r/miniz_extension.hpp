@@ -5,9 +5,13 @@
 #ifndef MINIZ_EXTENSION_HPP
 #define MINIZ_EXTENSION_HPP
 
+#include <deque>
 #include <string>
+#include <vector>
 #include <miniz.h>
 
+#include <tbb/task_group.h>
+
 namespace Slic3r {
 
 bool open_zip_reader(mz_zip_archive *zip, const std::string &fname_utf8);
@@ -34,6 +38,48 @@ public:
     }
 };
 
+// Writes the data of a zip entry opened with mz_zip_writer_add_staged_open(). The data is split into blocks,
+// which are deflated independently by TBB tasks (as pigz does) while the caller produces the following data,
+// and which are appended to the entry in their order. The blocks do not share the deflate dictionary,
+// thus the entry compresses slightly worse than with mz_zip_writer_add_staged_data().
+class MZ_ParallelStagedWriter
+{
+public:
+    // Size of the blocks of uncompressed data deflated by a single task.
+    static constexpr size_t block_size = 4 * 1024 * 1024;
+
+    // level: MZ_BEST_SPEED to MZ_UBER_COMPRESSION, see mz_zip_writer_add_staged_open().
+    MZ_ParallelStagedWriter(mz_zip_writer_staged_context &context, int level);
+    // Waits for the running tasks, does not finish the entry.
+    ~MZ_ParallelStagedWriter();
+
+    bool add(const char *data, size_t size);
+    bool add(const std::string &data) { return this->add(data.data(), data.size()); }
+    // Writes the pending blocks and finishes the entry with mz_zip_writer_add_staged_finish().
+    bool finish();
+
+private:
+    struct Block {
+        std::string                 data;
+        std::vector<unsigned char>  compressed;
+        bool                        failed { false };
+    };
+
+    void compress_current_block();
+    bool write_blocks();
+
+    mz_zip_writer_staged_context &m_context;
+    mz_uint                       m_flags;
+    // Block being filled by add().
+    std::string                   m_current;
+    // Blocks being compressed, in the order of the entry data.
+    std::deque<Block>             m_blocks;
+    tbb::task_group               m_tasks;
+};
+
+// Replacement of mz_zip_writer_add_mem(), which deflates entries larger than MZ_ParallelStagedWriter::block_size in parallel.
+bool add_mem_parallel(mz_zip_archive &zip, const std::string &name, const void *data, size_t size, mz_uint level_and_flags);
+
 } // namespace Slic3r
 
 #endif // MINIZ_EXTENSION_HPP
@@ -8,6 +8,7 @@
 #include "I18N.hpp"
 
 #include <atomic>
+#include <memory>
 #include <locale>
 #include <ctime>
 #include <cstdarg>
@@ -135,13 +136,21 @@ static struct RunOnInit {
 void disable_multi_threading()
 {
     // Disable parallelization to simplify debugging.
+    set_max_threads(1);
+}
+
+void set_max_threads(size_t max_threads)
+{
 #ifdef TBB_HAS_GLOBAL_CONTROL
-	{
-		static tbb::global_control gc(tbb::global_control::max_allowed_parallelism, 1);
-	}
+    static std::unique_ptr<tbb::global_control> gc;
+    gc.reset();
+    if (max_threads > 0)
+        gc = std::make_unique<tbb::global_control>(tbb::global_control::max_allowed_parallelism, max_threads);
 #else // TBB_HAS_GLOBAL_CONTROL
-    static tbb::task_scheduler_init *tbb_init = new tbb::task_scheduler_init(1);
-    UNUSED(tbb_init);
+    static std::unique_ptr<tbb::task_scheduler_init> tbb_init;
+    tbb_init.reset();
+    if (max_threads > 0)
+        tbb_init = std::make_unique<tbb::task_scheduler_init>(int(max_threads));
 #endif // TBB_HAS_GLOBAL_CONTROL
 }
 
@@ -1155,6 +1164,25 @@ std::string log_memory_info(bool ignore_loglevel)
     return out;
 }
 
+size_t peak_memory_usage()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return size_t(pmc.PeakWorkingSetSize);
+#elif defined(__linux__) or defined(__APPLE__)
+    rusage memory_info;
+    if (getrusage(RUSAGE_SELF, &memory_info) == 0) {
+        size_t peak_mem_usage = (size_t)memory_info.ru_maxrss;
+    #ifdef __linux__
+        peak_mem_usage *= 1024;// getrusage returns the value in kB on linux
+    #endif
+        return peak_mem_usage;
+    }
+#endif
+    return 0;
+}
+
 // Returns the size of physical memory (RAM) in bytes.
 // http://nadeausoftware.com/articles/2012/09/c_c_tip_how_get_physical_memory_size_system
 size_t total_physical_memory()
@@ -6883,6 +6883,32 @@ mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context *pContext, co
     return MZ_FALSE;
 }
 
+mz_bool mz_zip_writer_add_staged_compressed_data(mz_zip_writer_staged_context *pContext, const void *pComp_buf, size_t comp_size, const void *pUncomp_buf, size_t uncomp_size)
+{
+    if (pContext->file_ofs + uncomp_size > pContext->max_size)
+    {
+        mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_READ_FAILED);
+        pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+        pContext->pCompressor = NULL;
+        return MZ_FALSE;
+    }
+
+    pContext->file_ofs += uncomp_size;
+    pContext->uncomp_crc32 = (mz_uint32)mz_crc32(pContext->uncomp_crc32, (const mz_uint8 *)pUncomp_buf, uncomp_size);
+
+    if (comp_size > 0 && pContext->pZip->m_pWrite(pContext->pZip->m_pIO_opaque, pContext->add_state.m_cur_archive_file_ofs, pComp_buf, comp_size) != comp_size)
+    {
+        mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_WRITE_FAILED);
+        pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+        pContext->pCompressor = NULL;
+        return MZ_FALSE;
+    }
+
+    pContext->add_state.m_cur_archive_file_ofs += comp_size;
+    pContext->add_state.m_comp_size += comp_size;
+    return MZ_TRUE;
+}
+
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context *pContext)
 {
     if (! mz_zip_writer_add_staged_data(pContext, NULL, 0) ||
@@ -1352,6 +1352,10 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     mz_uint64 max_size, const MZ_TIME_T* pFile_time, const void* pComment, mz_uint16 comment_size, mz_uint level_and_flags,
     const char* user_extra_data, mz_uint user_extra_data_len, const char* user_extra_data_central, mz_uint user_extra_data_central_len);
 mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context* pContext, const char* pRead_buf, size_t n);
+/* Adds a block of raw deflate data compressed by the caller, together with the uncompressed data to update the CRC. */
+/* The compressed block has to end at a byte boundary (compressed with TDEFL_SYNC_FLUSH or TDEFL_FULL_FLUSH) and it must not be final. */
+/* Don't mix with mz_zip_writer_add_staged_data(), the final empty block is written by mz_zip_writer_add_staged_finish(). */
+mz_bool mz_zip_writer_add_staged_compressed_data(mz_zip_writer_staged_context* pContext, const void* pComp_buf, size_t comp_size, const void* pUncomp_buf, size_t uncomp_size);
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context* pContext);
 
 /* Adds a file to an archive by fully cloning the data from another archive. */
@@ -2,6 +2,7 @@
 
 #include "occtwrapper_export.h"
 
+#include <atomic>
 #include <cassert>
 
 #ifdef _WIN32
@@ -21,6 +22,7 @@
 #include "BRepBuilderAPI_Transform.hxx"
 #include "TopExp_Explorer.hxx"
 #include "BRep_Tool.hxx"
+#include "OSD_Parallel.hxx"
 
 const double STEP_TRANS_CHORD_ERROR = 0.005;
 const double STEP_TRANS_ANGLE_RES = 1;
@@ -126,62 +128,86 @@ try {
     std::string obj_name((last_slash == nullptr) ? path : last_slash + 1);
     res->object_name = obj_name;
 
-    for (size_t i = 0; i < namedSolids.size(); ++i) {
-        //BBS:if (proFn) {
-        //    proFn(LOAD_STEP_STAGE_GET_MESH, i, namedSolids.size(), cb_cancel);
-        //    if (cb_cancel) {
-        //        model->delete_object(new_object);
-        //        shapeTool.reset(nullptr);
-        //        application->Close(document);
-        //        return false;
-        //    }
-        //}
-
-        res->volumes.emplace_back();
-        auto& vertices = res->volumes.back().vertices;
-        auto& indices  = res->volumes.back().indices;
-
-        BRepMesh_IncrementalMesh mesh(namedSolids[i].solid, STEP_TRANS_CHORD_ERROR, false, STEP_TRANS_ANGLE_RES, true);
-
-        for (TopExp_Explorer anExpSF(namedSolids[i].solid, TopAbs_FACE); anExpSF.More(); anExpSF.Next()) {
-            const int aNodeOffset = int(vertices.size());
-            const TopoDS_Shape& aFace = anExpSF.Current();
-            TopLoc_Location aLoc;
-            Handle(Poly_Triangulation) aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(aFace), aLoc);
-            if (aTriangulation.IsNull())
-                continue;
-
-            // First copy vertices (will create duplicates).
-            gp_Trsf aTrsf = aLoc.Transformation();
-            for (Standard_Integer aNodeIter = 1; aNodeIter <= aTriangulation->NbNodes(); ++aNodeIter) {
-                gp_Pnt aPnt = aTriangulation->Node(aNodeIter);
-                aPnt.Transform(aTrsf);
-                vertices.push_back({float(aPnt.X()), float(aPnt.Y()), float(aPnt.Z())});
+    // The solids are independent copies (see BRepBuilderAPI_Transform in getNamedSolids()),
+    // thus they are meshed and converted in parallel, each into its own volume.
+    std::vector<OCCTVolume> volumes(namedSolids.size());
+    std::atomic<bool>       failed{ false };
+    OSD_Parallel::For(0, int(namedSolids.size()), [&namedSolids, &volumes, &failed](int i) {
+        if (failed)
+            return;
+        try {
+            OCCTVolume &volume   = volumes[i];
+            auto       &vertices = volume.vertices;
+            auto       &indices  = volume.indices;
+
+            // The faces of a solid are meshed in parallel as well (the isInParallel flag).
+            BRepMesh_IncrementalMesh mesh(namedSolids[i].solid, STEP_TRANS_CHORD_ERROR, false, STEP_TRANS_ANGLE_RES, true);
+
+            // Count the nodes and triangles first to allocate the output just once.
+            size_t num_nodes     = 0;
+            size_t num_triangles = 0;
+            for (TopExp_Explorer anExpSF(namedSolids[i].solid, TopAbs_FACE); anExpSF.More(); anExpSF.Next()) {
+                TopLoc_Location aLoc;
+                Handle(Poly_Triangulation) aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(anExpSF.Current()), aLoc);
+                if (! aTriangulation.IsNull()) {
+                    num_nodes     += size_t(aTriangulation->NbNodes());
+                    num_triangles += size_t(aTriangulation->NbTriangles());
+                }
             }
-            // Now the indices.
-            const TopAbs_Orientation anOrientation = anExpSF.Current().Orientation();
-            for (Standard_Integer aTriIter = 1; aTriIter <= aTriangulation->NbTriangles(); ++aTriIter) {
-                Poly_Triangle aTri = aTriangulation->Triangle(aTriIter);
-
-                Standard_Integer anId[3];
-                aTri.Get(anId[0], anId[1], anId[2]);
-                if (anOrientation == TopAbs_REVERSED)
-                    std::swap(anId[1], anId[2]);
-
-                // Account for the vertices we already have from previous faces.
-                // anId is 1-based index !
-                indices.push_back({anId[0] - 1 + aNodeOffset,
-                                   anId[1] - 1 + aNodeOffset,
-                                   anId[2] - 1 + aNodeOffset});
+            vertices.reserve(num_nodes);
+            indices.reserve(num_triangles);
+
+            for (TopExp_Explorer anExpSF(namedSolids[i].solid, TopAbs_FACE); anExpSF.More(); anExpSF.Next()) {
+                const int aNodeOffset = int(vertices.size());
+                const TopoDS_Shape& aFace = anExpSF.Current();
+                TopLoc_Location aLoc;
+                Handle(Poly_Triangulation) aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(aFace), aLoc);
+                if (aTriangulation.IsNull())
+                    continue;
+
+                // First copy vertices (will create duplicates).
+                gp_Trsf aTrsf = aLoc.Transformation();
+                for (Standard_Integer aNodeIter = 1; aNodeIter <= aTriangulation->NbNodes(); ++aNodeIter) {
+                    gp_Pnt aPnt = aTriangulation->Node(aNodeIter);
+                    aPnt.Transform(aTrsf);
+                    vertices.push_back({float(aPnt.X()), float(aPnt.Y()), float(aPnt.Z())});
+                }
+                // Now the indices.
+                const TopAbs_Orientation anOrientation = anExpSF.Current().Orientation();
+                for (Standard_Integer aTriIter = 1; aTriIter <= aTriangulation->NbTriangles(); ++aTriIter) {
+                    Poly_Triangle aTri = aTriangulation->Triangle(aTriIter);
+
+                    Standard_Integer anId[3];
+                    aTri.Get(anId[0], anId[1], anId[2]);
+                    if (anOrientation == TopAbs_REVERSED)
+                        std::swap(anId[1], anId[2]);
+
+                    // Account for the vertices we already have from previous faces.
+                    // anId is 1-based index !
+                    indices.push_back({anId[0] - 1 + aNodeOffset,
+                                       anId[1] - 1 + aNodeOffset,
+                                       anId[2] - 1 + aNodeOffset});
+                }
             }
-        }
-
-        res->volumes.back().volume_name = namedSolids[i].name;
 
-        if (vertices.empty())
-            res->volumes.pop_back();        
+            volume.volume_name = namedSolids[i].name;
+        } catch (...) {
+            // The exceptions may not cross the OCCT thread pool, report the failure after the loop.
+            failed = true;
+        }
+    });
+    if (failed) {
+        shapeTool.reset(nullptr);
+        application->Close(document);
+        res->error_str = std::string{"Could not triangulate '"} + path + "'";
+        return false;
     }
 
+    res->volumes.reserve(volumes.size());
+    for (OCCTVolume &volume : volumes)
+        if (! volume.vertices.empty())
+            res->volumes.emplace_back(std::move(volume));
+
     shapeTool.reset(nullptr);
     application->Close(document);
 
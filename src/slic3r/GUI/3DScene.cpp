@@ -32,6 +32,8 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Tesselate.hpp"
 #include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/QuadricEdgeCollapse.hpp"
+#include "libslic3r/Thread.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -403,8 +405,14 @@ void GLVolume::render()
         glsafe(::glFrontFace(GL_CW));
     glsafe(::glCullFace(GL_BACK));
 
-    if (tverts_range == std::make_pair<size_t, size_t>(0, -1))
-        model.render();
+    if (tverts_range == std::make_pair<size_t, size_t>(0, -1)) {
+        if (lod_level >= 0 && lod_models[lod_level].is_initialized()) {
+            lod_models[lod_level].set_color(model.get_color());
+            lod_models[lod_level].render();
+        }
+        else
+            model.render();
+    }
     else
         model.render(this->tverts_range);
 
@@ -474,6 +482,8 @@ int GLVolumeCollection::load_object_volume(
     if (m_use_raycasters)
       v.mesh_raycaster = std::make_unique<GUI::MeshRaycaster>(mesh);
 #endif // ENABLE_SMOOTH_NORMALS
+    if (mesh->its.indices.size() >= GLVolumeLODGenerator::MinTriangles)
+        v.lod_source = mesh;
     v.composite_id = GLVolume::CompositeID(obj_idx, volume_idx, instance_idx);
     if (model_volume->is_model_part()) {
         // GLVolume will reference a convex hull from model_volume!
@@ -691,6 +701,103 @@ GLVolume* GLVolumeCollection::new_nontoolpath_volume(const ColorRGBA& rgba)
     return out;
 }
 
+GLVolumeLODGenerator::~GLVolumeLODGenerator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = true;
+    }
+    m_condition.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+std::shared_ptr<const GLVolumeLODGenerator::Levels> GLVolumeLODGenerator::get(const std::shared_ptr<const TriangleMesh> &mesh)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (auto it = m_entries.find(mesh.get()); it != m_entries.end() && it->second.mesh.lock() == mesh)
+        return it->second.levels;
+
+    // A new mesh, possibly allocated at the address of an already released one. Drop the entries of the released meshes.
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+        it = it->second.mesh.expired() ? m_entries.erase(it) : std::next(it);
+    m_entries[mesh.get()] = { mesh, nullptr };
+    m_queue.emplace_back(mesh);
+    if (! m_thread.joinable())
+        m_thread = create_thread([this]{ this->thread_proc(); });
+    m_condition.notify_one();
+    return nullptr;
+}
+
+void GLVolumeLODGenerator::thread_proc()
+{
+    set_current_thread_name("slic3r_GLVolLOD");
+    for (;;) {
+        std::shared_ptr<const TriangleMesh> mesh;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]{ return m_exit || ! m_queue.empty(); });
+            if (m_exit)
+                return;
+            mesh = m_queue.front().lock();
+            m_queue.pop_front();
+        }
+        if (mesh == nullptr)
+            // Released before its turn came.
+            continue;
+
+        auto levels = std::make_shared<Levels>();
+        try {
+            // Each level is simplified from the previous one.
+            indexed_triangle_set its = mesh->its;
+            for (size_t i = 0; i < Ratios.size(); ++ i) {
+                its_quadric_edge_collapse_parallel(its, uint32_t(Ratios[i] * mesh->its.indices.size()), nullptr,
+                    [this]() { if (m_exit) throw CanceledException(); });
+                (*levels)[i] = its;
+            }
+        } catch (const CanceledException &) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_entries.find(mesh.get()); it != m_entries.end() && it->second.mesh.lock() == mesh)
+            it->second.levels = std::move(levels);
+    }
+}
+
+// Level of detail to render the volume with, -1 for the full resolution model.
+// Selected by the size of the projected bounding sphere of the volume relative to the viewport height.
+static int lod_level(const GLVolume &volume, const Transform3d &view_matrix, const Transform3d &projection_matrix)
+{
+    const BoundingBoxf3 &box = volume.transformed_bounding_box();
+    const Vec4d center = projection_matrix.matrix() * (view_matrix * box.center()).homogeneous();
+    if (center.w() <= 0.)
+        return -1;
+    const double screen_ratio = box.radius() * std::abs(projection_matrix(1, 1)) / center.w();
+    return screen_ratio < 0.1 ? 1 : screen_ratio < 0.3 ? 0 : -1;
+}
+
+// Planes of the view frustum of the given projection * view matrix in world coordinates, with the normals pointing inside.
+static std::array<Vec4d, 6> frustum_planes(const Matrix4d &projection_view_matrix)
+{
+    const Matrix4d &m = projection_view_matrix;
+    return { Vec4d(m.row(3) + m.row(0)), Vec4d(m.row(3) - m.row(0)),
+             Vec4d(m.row(3) + m.row(1)), Vec4d(m.row(3) - m.row(1)),
+             Vec4d(m.row(3) + m.row(2)), Vec4d(m.row(3) - m.row(2)) };
+}
+
+// Conservative test, a box outside of the frustum close to its corner may be reported as visible.
+static bool is_outside_frustum(const BoundingBoxf3 &box, const std::array<Vec4d, 6> &planes)
+{
+    for (const Vec4d &plane : planes) {
+        // Corner of the box furthest along the plane normal.
+        const Vec3d corner(plane.x() > 0. ? box.max.x() : box.min.x(), plane.y() > 0. ? box.max.y() : box.min.y(), plane.z() > 0. ? box.max.z() : box.min.z());
+        if (plane.head<3>().dot(corner) + plane.w() < 0.)
+            return true;
+    }
+    return false;
+}
+
 GLVolumeWithIdAndZList volumes_to_render(const GLVolumePtrs& volumes, GLVolumeCollection::ERenderType type, const Transform3d& view_matrix, std::function<bool(const GLVolume&)> filter_func)
 {
     GLVolumeWithIdAndZList list;
@@ -728,6 +835,12 @@ void GLVolumeCollection::render(GLVolumeCollection::ERenderType type, bool disab
     std::function<bool(const GLVolume&)> filter_func) const
 {
     GLVolumeWithIdAndZList to_render = volumes_to_render(volumes, type, view_matrix, filter_func);
+    // Frustum culling.
+    const std::array<Vec4d, 6> planes = frustum_planes(projection_matrix.matrix() * view_matrix.matrix());
+    to_render.erase(std::remove_if(to_render.begin(), to_render.end(), [&planes](const GLVolumeWithIdAndZ &volume) {
+        const BoundingBoxf3 &box = volume.first->transformed_bounding_box();
+        return box.defined && is_outside_frustum(box, planes);
+    }), to_render.end());
     if (to_render.empty())
         return;
 
@@ -794,6 +907,16 @@ void GLVolumeCollection::render(GLVolumeCollection::ERenderType type, bool disab
         glcheck();
 
         volume.first->model.set_color(volume.first->render_color);
+        volume.first->lod_level = -1;
+        if (volume.first->lod_source != nullptr) {
+            const int level = lod_level(*volume.first, view_matrix, projection_matrix);
+            if (level >= 0 && ! volume.first->lod_models[level].is_initialized()) {
+                if (std::shared_ptr<const GLVolumeLODGenerator::Levels> levels = m_lod_generator.get(volume.first->lod_source); levels != nullptr)
+                    for (size_t i = 0; i < levels->size(); ++ i)
+                        volume.first->lod_models[i].init_from((*levels)[i]);
+            }
+            volume.first->lod_level = level;
+        }
         const Transform3d model_matrix = world_matrix;
         shader->set_uniform("view_model_matrix", view_matrix * model_matrix);
         shader->set_uniform("projection_matrix", projection_matrix);
@@ -25,6 +25,14 @@
 
 #include <functional>
 #include <optional>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#include <boost/thread.hpp>
 
 #ifndef NDEBUG
 #define HAS_GLSAFE
@@ -198,6 +206,13 @@ public:
     EHoverState         	hover;
 
     GUI::GLModel            model;
+    // Mesh to generate the levels of detail from, set for large model volumes only.
+    std::shared_ptr<const TriangleMesh> lod_source;
+    // Simplified meshes rendered instead of model if the volume covers a small part of the screen,
+    // initialized by GLVolumeCollection::render() once generated by GLVolumeLODGenerator.
+    std::array<GUI::GLModel, 2> lod_models;
+    // Index into lod_models to be rendered by render(), -1 to render model.
+    int                     lod_level{ -1 };
     // raycaster used for picking
     std::unique_ptr<GUI::MeshRaycaster> mesh_raycaster;
     // Ranges of triangle and quad indices to be rendered.
@@ -278,7 +293,7 @@ public:
     void set_volume_mirror(Axis axis, double mirror) { m_volume_transformation.set_mirror(axis, mirror); set_bounding_boxes_as_dirty(); }
      
     double get_sla_shift_z() const { return m_sla_shift_z; }
-    void set_sla_shift_z(double z) { m_sla_shift_z = z; }
+    void set_sla_shift_z(double z) { m_sla_shift_z = z; set_bounding_boxes_as_dirty(); }
 
     void set_convex_hull(std::shared_ptr<const TriangleMesh> convex_hull) { m_convex_hull = std::move(convex_hull); }
     void set_convex_hull(const TriangleMesh &convex_hull) { m_convex_hull = std::make_shared<const TriangleMesh>(convex_hull); }
@@ -325,11 +340,11 @@ public:
 
     // Return an estimate of the memory consumed by this class.
     size_t 				cpu_memory_used() const {
-          return sizeof(*this) + this->model.cpu_memory_used() + this->print_zs.capacity() * sizeof(coordf_t) +
-               this->offsets.capacity() * sizeof(size_t);
+          return sizeof(*this) + this->model.cpu_memory_used() + this->lod_models[0].cpu_memory_used() + this->lod_models[1].cpu_memory_used() +
+               this->print_zs.capacity() * sizeof(coordf_t) + this->offsets.capacity() * sizeof(size_t);
     }
     // Return an estimate of the memory held by GPU vertex buffers.
-    size_t 				gpu_memory_used() const { return this->model.gpu_memory_used(); }
+    size_t 				gpu_memory_used() const { return this->model.gpu_memory_used() + this->lod_models[0].gpu_memory_used() + this->lod_models[1].gpu_memory_used(); }
     size_t 				total_memory_used() const { return this->cpu_memory_used() + this->gpu_memory_used(); }
 };
 
@@ -337,6 +352,43 @@ typedef std::vector<GLVolume*> GLVolumePtrs;
 typedef std::pair<GLVolume*, std::pair<unsigned int, double>> GLVolumeWithIdAndZ;
 typedef std::vector<GLVolumeWithIdAndZ> GLVolumeWithIdAndZList;
 
+// Generates the levels of detail of large meshes by quadric edge collapse in a background thread.
+// The simplified meshes are shared by all GLVolumes referencing the same mesh, thus by all instances of a ModelVolume.
+class GLVolumeLODGenerator
+{
+public:
+    // Triangle counts of the levels of detail relative to the source mesh.
+    static constexpr std::array<float, 2> Ratios{ 0.25f, 0.0625f };
+    // Meshes with less triangles are always rendered at full resolution.
+    static constexpr size_t               MinTriangles = 100000;
+
+    using Levels = std::array<indexed_triangle_set, Ratios.size()>;
+
+    GLVolumeLODGenerator() = default;
+    ~GLVolumeLODGenerator();
+
+    // Returns the levels of detail of mesh if already generated. Otherwise schedules their generation
+    // and returns nullptr.
+    std::shared_ptr<const Levels> get(const std::shared_ptr<const TriangleMesh> &mesh);
+
+private:
+    void thread_proc();
+
+    struct Entry
+    {
+        std::weak_ptr<const TriangleMesh> mesh;
+        // nullptr until generated.
+        std::shared_ptr<const Levels>     levels;
+    };
+
+    std::mutex                                    m_mutex;
+    std::condition_variable                       m_condition;
+    std::map<const TriangleMesh*, Entry>          m_entries;
+    std::deque<std::weak_ptr<const TriangleMesh>> m_queue;
+    std::atomic<bool>                             m_exit{ false };
+    boost::thread                                 m_thread;
+};
+
 class GLVolumeCollection
 {
 public:
@@ -388,6 +440,8 @@ private:
     bool m_show_non_manifold_edges{ true };
     bool m_use_raycasters{ true };
 
+    mutable GLVolumeLODGenerator m_lod_generator;
+
 public:
     GLVolumePtrs volumes;
 
@@ -157,7 +157,13 @@ void BackgroundSlicingProcess::process_fff()
 	// Passing the timestamp 
 	evt.SetInt((int)(m_fff_print->step_state_with_timestamp(PrintStep::psSlicingFinished).timestamp));
 	wxQueueEvent(GUI::wxGetApp().mainframe->m_plater, evt.Clone());
-	m_fff_print->export_gcode(m_temp_output_path, m_gcode_result, [this](const ThumbnailsParams& params) { return this->render_thumbnails(params); });
+	// Drop a snapshot left over by a canceled G-code export.
+	this->set_partial_gcode_result(nullptr);
+	m_fff_print->export_gcode(m_temp_output_path, m_gcode_result, [this](const ThumbnailsParams& params) { return this->render_thumbnails(params); },
+		// Let the G-code preview fill in bottom-up while the G-code is being exported.
+		[this](GCodeProcessorResult &&partial_result) { this->set_partial_gcode_result(std::make_unique<GCodeProcessorResult>(std::move(partial_result))); });
+	// Drop the last snapshot, the complete G-code preview will be loaded.
+	this->set_partial_gcode_result(nullptr);
 	if (this->set_step_started(bspsGCodeFinalize)) {
 	    if (! m_export_path.empty()) {
 			wxQueueEvent(GUI::wxGetApp().mainframe->m_plater, new wxCommandEvent(m_event_export_began_id));
@@ -172,6 +178,25 @@ void BackgroundSlicingProcess::process_fff()
 	}
 }
 
+void BackgroundSlicingProcess::set_partial_gcode_result(std::unique_ptr<GCodeProcessorResult> result)
+{
+	bool post_event = false;
+	{
+		std::scoped_lock<std::mutex> lock(m_partial_gcode_result_mutex);
+		// Only notify the UI thread if it already took the previous snapshot, otherwise just replace the snapshot.
+		post_event = result && ! m_partial_gcode_result && m_event_gcode_preview_id != 0;
+		m_partial_gcode_result = std::move(result);
+	}
+	if (post_event)
+		wxQueueEvent(GUI::wxGetApp().mainframe->m_plater, new wxCommandEvent(m_event_gcode_preview_id));
+}
+
+std::unique_ptr<GCodeProcessorResult> BackgroundSlicingProcess::take_partial_gcode_result()
+{
+	std::scoped_lock<std::mutex> lock(m_partial_gcode_result_mutex);
+	return std::move(m_partial_gcode_result);
+}
+
 void BackgroundSlicingProcess::process_sla()
 {
     assert(m_print == m_sla_print);
@@ -606,7 +631,7 @@ void BackgroundSlicingProcess::schedule_export(const std::string &path, bool exp
 		return;
 
 	// Guard against entering the export step before changing the export path.
-	std::scoped_lock<std::mutex> lock(m_print->state_mutex());
+	std::scoped_lock<PrintStateMutex> lock(m_print->state_mutex());
 	this->invalidate_step(bspsGCodeFinalize);
 	m_export_path = path;
 	m_export_path_on_removable_media = export_path_on_removable_media;
@@ -619,7 +644,7 @@ void BackgroundSlicingProcess::schedule_upload(Slic3r::PrintHostJob upload_job)
 		return;
 
 	// Guard against entering the export step before changing the export path.
-	std::scoped_lock<std::mutex> lock(m_print->state_mutex());
+	std::scoped_lock<PrintStateMutex> lock(m_print->state_mutex());
 	this->invalidate_step(bspsGCodeFinalize);
 	m_export_path.clear();
 	m_upload_job = std::move(upload_job);
@@ -632,7 +657,7 @@ void BackgroundSlicingProcess::reset_export()
 		m_export_path.clear();
 		m_export_path_on_removable_media = false;
 		// invalidate_step expects the mutex to be locked.
-		std::scoped_lock<std::mutex> lock(m_print->state_mutex());
+		std::scoped_lock<PrintStateMutex> lock(m_print->state_mutex());
 		this->invalidate_step(bspsGCodeFinalize);
 	}
 }
@@ -736,8 +761,20 @@ void BackgroundSlicingProcess::prepare_upload()
 
 	if (m_print == m_fff_print) {
 		m_print->set_status(95, _u8L("Running post-processing scripts"));
+		bool linked = false;
+#ifndef _WIN32
+		if (const auto *post_process = m_fff_print->full_print_config().opt<ConfigOptionStrings>("post_process");
+			post_process == nullptr || post_process->values.empty()) {
+			// No post-processing script is going to modify the upload source in place, thus the upload may share the file
+			// with the temporary G-code, saving a copy of the whole G-code before the upload starts.
+			// The temporary G-code is replaced by renaming a new file over it, which leaves the linked file intact.
+			boost::system::error_code ec;
+			boost::filesystem::create_hard_link(m_temp_output_path, source_path, ec);
+			linked = ! ec;
+		}
+#endif // _WIN32
 		std::string error_message;
-		if (copy_file(m_temp_output_path, source_path.string(), error_message) != SUCCESS)
+		if (! linked && copy_file(m_temp_output_path, source_path.string(), error_message) != SUCCESS)
 			throw Slic3r::RuntimeError("Copying of the temporary G-code to the output G-code failed");
         m_upload_job.upload_data.upload_path = m_fff_print->print_statistics().finalize_output_path(m_upload_job.upload_data.upload_path.string());
         // Make a copy of the source path, as run_post_process_scripts() is allowed to change it when making a copy of the source file
@@ -8,6 +8,7 @@
 
 #include <string>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 
 #include <boost/thread.hpp>
@@ -103,6 +104,13 @@ public:
 	// specified path or uploaded.
 	// The wxCommandEvent is sent to the UI thread asynchronously without waiting for the event to be processed.
 	void set_export_began_event(int event_id) { m_event_export_began_id = event_id; }
+	// The following wxCommandEvent will be sent to the UI thread / Plater window, when a snapshot of the G-code exported so far
+	// is ready to be displayed by the G-code preview, see take_partial_gcode_result().
+	// The wxCommandEvent is sent to the UI thread asynchronously without waiting for the event to be processed.
+	void set_gcode_preview_event(int event_id) { m_event_gcode_preview_id = event_id; }
+	// Take the latest snapshot of the G-code exported so far. Returns nullptr if it was already taken,
+	// or if the G-code export finished in the meantime and the complete G-code preview is to be loaded instead.
+	std::unique_ptr<GCodeProcessorResult> take_partial_gcode_result();
 
 	// Activate either m_fff_print or m_sla_print.
 	// Return true if changed.
@@ -281,6 +289,13 @@ private:
 	int 						m_event_finished_id  			= 0;
 	// wxWidgets command ID to be sent to the plater to inform that the G-code is being exported.
 	int                         m_event_export_began_id         = 0;
+	// wxWidgets command ID to be sent to the plater to inform that a snapshot of the G-code exported so far is ready.
+	int                         m_event_gcode_preview_id        = 0;
+
+	// Latest snapshot of the G-code exported so far, not yet taken by the UI thread. Older snapshots are dropped.
+	std::mutex                              m_partial_gcode_result_mutex;
+	std::unique_ptr<GCodeProcessorResult>   m_partial_gcode_result;
+	void                set_partial_gcode_result(std::unique_ptr<GCodeProcessorResult> result);
 
 };
 
@@ -7,7 +7,9 @@
 #include "BonjourDialog.hpp"
 
 #include <set>
+#include <map>
 #include <mutex>
+#include <chrono>
 
 #include <boost/nowide/convert.hpp>
 
@@ -31,10 +33,13 @@ class BonjourReplyEvent : public wxEvent
 {
 public:
 	BonjourReply reply;
+	// Replayed from the cache of the previous lookups.
+	bool cached;
 
-	BonjourReplyEvent(wxEventType eventType, int winid, BonjourReply &&reply) :
+	BonjourReplyEvent(wxEventType eventType, int winid, BonjourReply &&reply, bool cached = false) :
 		wxEvent(winid, eventType),
-		reply(std::move(reply))
+		reply(std::move(reply)),
+		cached(cached)
 	{}
 
 	virtual wxEvent *Clone() const
@@ -50,6 +55,18 @@ wxDEFINE_EVENT(EVT_BONJOUR_COMPLETE, wxCommandEvent);
 
 class ReplySet: public std::set<BonjourReply> {};
 
+// Replies received by the previous lookups with the time they were last received.
+// Only accessed from the UI thread.
+using ReplyCache = std::map<BonjourReply, std::chrono::steady_clock::time_point>;
+static ReplyCache& reply_cache()
+{
+	static ReplyCache cache;
+	return cache;
+}
+
+// Cached replies older than this are dropped, as the host has likely gone away or changed its address.
+static constexpr std::chrono::minutes REPLY_CACHE_TTL { 10 };
+
 struct LifetimeGuard
 {
 	std::mutex mutex;
@@ -118,6 +135,20 @@ bool BonjourDialog::show_and_lookup()
 	timer->Start(1000);
     on_timer_process();
 
+	// Show the hosts known from the previous lookups right away, they are refreshed by the lookup below.
+	{
+		ReplyCache &cache = reply_cache();
+		const auto  now   = std::chrono::steady_clock::now();
+		for (auto it = cache.begin(); it != cache.end();)
+			if (now - it->second > REPLY_CACHE_TTL)
+				it = cache.erase(it);
+			else {
+				BonjourReply reply = it->first;
+				wxQueueEvent(this, new BonjourReplyEvent(EVT_BONJOUR_REPLY, GetId(), std::move(reply), true));
+				++ it;
+			}
+	}
+
 	// The background thread needs to queue messages for this dialog
 	// and for that it needs a valid pointer to it (mandated by the wxWidgets API).
 	// Here we put the pointer under a shared_ptr and protect it by a mutex,
@@ -169,6 +200,13 @@ wxString BonjourDialog::get_selected() const
 
 void BonjourDialog::on_reply(BonjourReplyEvent &e)
 {
+	if (! e.cached) {
+		// Replace the cached reply, its TXT data may have changed.
+		ReplyCache &cache = reply_cache();
+		cache.erase(e.reply);
+		cache.emplace(e.reply, std::chrono::steady_clock::now());
+	}
+
 	if (replies->find(e.reply) != replies->end()) {
 		// We already have this reply
 		return;
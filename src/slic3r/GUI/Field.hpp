@@ -79,6 +79,7 @@ class UndoValueUIManager
 		bool	set_label_colour(const wxColour* clr) {
 			if (label_color != clr) {
 				label_color = clr;
+				return true;
 			}
 			return false;
 		}
@@ -11,6 +11,7 @@
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/Model.hpp"
+#include "libslic3r/ProfilerTracy.hpp"
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/LocalesUtils.hpp"
 #include "libslic3r/PresetBundle.hpp"
@@ -37,12 +38,15 @@
 #include <boost/algorithm/string/split.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/nowide/fstream.hpp>
+#include <tbb/parallel_for.h>
+#include <miniz.h>
 #include <wx/progdlg.h>
-#include <wx/numformatter.h>
 
 #include <array>
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 
 namespace Slic3r {
 namespace GUI {
@@ -55,6 +59,26 @@ static EMoveType buffer_type(unsigned char id) {
     return static_cast<EMoveType>(static_cast<unsigned char>(EMoveType::Retract) + id);
 }
 
+// Packs a unit normal into the bits of a float, as 3 signed normalized bytes followed by a zero byte (VBuffer::EFormat::PositionPackedNormal).
+// The zero byte makes the exponent of the (little endian) float zero, so the packed value is never a NaN and it survives copies unchanged.
+static float pack_normal(const Vec3f& normal) {
+    const std::array<int8_t, 4> bytes = {
+        static_cast<int8_t>(std::lround(127.0f * std::clamp(normal.x(), -1.0f, 1.0f))),
+        static_cast<int8_t>(std::lround(127.0f * std::clamp(normal.y(), -1.0f, 1.0f))),
+        static_cast<int8_t>(std::lround(127.0f * std::clamp(normal.z(), -1.0f, 1.0f))),
+        0 };
+    float ret;
+    std::memcpy(&ret, bytes.data(), sizeof(float));
+    return ret;
+}
+
+static Vec3f unpack_normal(float packed) {
+    std::array<int8_t, 4> bytes;
+    std::memcpy(bytes.data(), &packed, sizeof(float));
+    // same conversion as the one applied by OpenGL to normalized signed bytes
+    return Vec3f(std::max(-1.0f, float(bytes[0]) / 127.0f), std::max(-1.0f, float(bytes[1]) / 127.0f), std::max(-1.0f, float(bytes[2]) / 127.0f));
+}
+
 // Round to a bin with minimum two digits resolution.
 // Equivalent to conversion to string with sprintf(buf, "%.2g", value) and conversion back to float, but faster.
 static float round_to_bin(const float value)
@@ -90,6 +114,7 @@ void GCodeViewer::VBuffer::reset()
     }
 #endif // ENABLE_GL_CORE_PROFILE
 
+    paged.clear();
     sizes.clear();
     count = 0;
 }
@@ -121,9 +146,40 @@ void GCodeViewer::IBuffer::reset()
     }
 
     vbo = 0;
+    vbuffer_id = 0;
+    paged = PagedBuffer();
     count = 0;
 }
 
+void GCodeViewer::PagedBuffer::store(const void* buffer, size_t size)
+{
+    size_bytes = size;
+    mz_ulong compressed_size = mz_compressBound(static_cast<mz_ulong>(size));
+    data.resize(compressed_size);
+    // fastest compression, the buffers are decompressed while the user moves the sliders
+    if (mz_compress2(data.data(), &compressed_size, static_cast<const unsigned char*>(buffer), static_cast<mz_ulong>(size), MZ_BEST_SPEED) != MZ_OK) {
+        BOOST_LOG_TRIVIAL(error) << "GCodeViewer::PagedBuffer::store: Compression of " << size << " bytes failed";
+        compressed_size = 0;
+    }
+    data.resize(compressed_size);
+    data.shrink_to_fit();
+}
+
+unsigned int GCodeViewer::PagedBuffer::upload(unsigned int target) const
+{
+    std::vector<unsigned char> buffer(size_bytes);
+    mz_ulong size = static_cast<mz_ulong>(size_bytes);
+    if (mz_uncompress(buffer.data(), &size, data.data(), static_cast<mz_ulong>(data.size())) != MZ_OK || size != size_bytes)
+        BOOST_LOG_TRIVIAL(error) << "GCodeViewer::PagedBuffer::upload: Decompression of " << size_bytes << " bytes failed";
+
+    GLuint id = 0;
+    glsafe(::glGenBuffers(1, &id));
+    glsafe(::glBindBuffer(target, id));
+    glsafe(::glBufferData(target, size_bytes, buffer.data(), GL_STATIC_DRAW));
+    glsafe(::glBindBuffer(target, 0));
+    return static_cast<unsigned int>(id);
+}
+
 bool GCodeViewer::Path::matches(const GCodeProcessorResult::MoveVertex& move, bool account_for_volumetric_rate) const
 {
     auto matches_percent = [](float value1, float value2, float max_percent) {
@@ -373,6 +429,16 @@ void GCodeViewer::SequentialView::GCodeWindow::load_gcode(const GCodeProcessorRe
     m_filename = gcode_result.filename;
     m_is_binary_file = gcode_result.is_binary_file;
     m_lines_ends = gcode_result.lines_ends;
+    m_cumulative_lines_counts.clear();
+    m_cumulative_lines_counts.reserve(m_lines_ends.size());
+    m_lines_count = 0;
+    for (const std::vector<size_t>& lines_ends : m_lines_ends) {
+        m_lines_count += lines_ends.size();
+        m_cumulative_lines_counts.emplace_back(m_lines_count);
+    }
+    m_gcode_blocks.clear();
+    m_lines_cache.clear();
+    m_cache_range = Range();
 }
 
 void GCodeViewer::SequentialView::GCodeWindow::add_gcode_line_to_lines_cache(const std::string& src)
@@ -410,20 +476,18 @@ void GCodeViewer::SequentialView::GCodeWindow::render(float top, float bottom, s
         const std::vector<size_t>& lines_ends = m_lines_ends.front();
         FILE* file = boost::nowide::fopen(m_filename.c_str(), "rb");
         if (file != nullptr) {
-            for (size_t id = *m_cache_range.min; id <= *m_cache_range.max; ++id) {
-                assert(id > 0);
-                // read line from file
-                const size_t begin = id == 1 ? 0 : lines_ends[id - 2];
-                const size_t len = lines_ends[id - 1] - begin;
-                std::string gline(len, '\0');
-                fseek(file, begin, SEEK_SET);
-                const size_t rsize = fread((void*)gline.data(), 1, len, file);
-                if (ferror(file) || rsize != len) {
-                    m_lines_cache.clear();
-                    break;
+            // read all the cached lines at once
+            assert(*m_cache_range.min > 0);
+            const size_t begin = *m_cache_range.min == 1 ? 0 : lines_ends[*m_cache_range.min - 2];
+            const size_t len = lines_ends[*m_cache_range.max - 1] - begin;
+            std::string glines(len, '\0');
+            fseek(file, begin, SEEK_SET);
+            const size_t rsize = fread((void*)glines.data(), 1, len, file);
+            if (!ferror(file) && rsize == len) {
+                for (size_t id = *m_cache_range.min; id <= *m_cache_range.max; ++id) {
+                    const size_t line_begin = (id == 1 ? 0 : lines_ends[id - 2]) - begin;
+                    add_gcode_line_to_lines_cache(glines.substr(line_begin, lines_ends[id - 1] - begin - line_begin));
                 }
-
-                add_gcode_line_to_lines_cache(gline);
             }
             fclose(file);
         }
@@ -433,28 +497,14 @@ void GCodeViewer::SequentialView::GCodeWindow::render(float top, float bottom, s
         m_lines_cache.clear();
         m_lines_cache.reserve(m_cache_range.size());
 
-        size_t cumulative_lines_count = 0;
-        std::vector<size_t> cumulative_lines_counts;
-        cumulative_lines_counts.reserve(m_lines_ends.size());
-        for (size_t i = 0; i < m_lines_ends.size(); ++i) {
-            cumulative_lines_count += m_lines_ends[i].size();
-            cumulative_lines_counts.emplace_back(cumulative_lines_count);
-        }
-
-        size_t first_block_id = 0;
-        for (size_t i = 0; i < cumulative_lines_counts.size(); ++i) {
-            if (*m_cache_range.min <= cumulative_lines_counts[i]) {
-                first_block_id = i;
-                break;
-            }
-        }
-        size_t last_block_id = 0;
-        for (size_t i = 0; i < cumulative_lines_counts.size(); ++i) {
-            if (*m_cache_range.max <= cumulative_lines_counts[i]) {
-                last_block_id = i;
-                break;
-            }
-        }
+        // blocks containing the first and the last cached lines
+        const std::vector<size_t>& cumulative_lines_counts = m_cumulative_lines_counts;
+        auto block_containing = [&cumulative_lines_counts](size_t line_id) {
+            const size_t id = std::lower_bound(cumulative_lines_counts.begin(), cumulative_lines_counts.end(), line_id) - cumulative_lines_counts.begin();
+            return std::min(id, cumulative_lines_counts.size() - 1);
+        };
+        const size_t first_block_id = block_containing(*m_cache_range.min);
+        const size_t last_block_id = block_containing(*m_cache_range.max);
         assert(last_block_id >= first_block_id);
 
         FilePtr file(boost::nowide::fopen(m_filename.c_str(), "rb"));
@@ -468,51 +518,53 @@ void GCodeViewer::SequentialView::GCodeWindow::render(float top, float bottom, s
             using namespace bgcode::binarize;
             FileHeader file_header;
             EResult res = read_header(*file.f, file_header, nullptr);
-            if (res == EResult::Success) {
-                // search first GCode block
+            if (res != EResult::Success)
+                return;
+
+            if (m_gcode_blocks.empty()) {
+                // index the GCode blocks once, the following reads seek directly to the blocks containing the cached lines
                 BlockHeader block_header;
                 res = read_next_block_header(*file.f, file_header, block_header, EBlockType::GCode, nullptr, 0);
-                if (res == EResult::Success) {
-                    for (size_t i = 0; i < first_block_id; ++i) {
-                        skip_block(*file.f, file_header, block_header);
-                        res = read_next_block_header(*file.f, file_header, block_header, nullptr, 0);
-                        if (res != EResult::Success || block_header.type != (uint16_t)EBlockType::GCode) {
-                            m_lines_cache.clear();
-                            return;
-                        }
-                    }
-
-                    for (size_t i = first_block_id; i <= last_block_id; ++i) {
-                        GCodeBlock block;
-                        res = block.read_data(*file.f, file_header, block_header);
-                        if (res != EResult::Success) {
-                            m_lines_cache.clear();
-                            return;
-                        }
+                while (res == EResult::Success) {
+                    m_gcode_blocks.push_back({ block_header, ftell(file.f) });
+                    skip_block(*file.f, file_header, block_header);
+                    if (ftell(file.f) == file_size)
+                        break;
+                    res = read_next_block_header(*file.f, file_header, block_header, nullptr, 0);
+                    if (res == EResult::Success && block_header.type != (uint16_t)EBlockType::GCode)
+                        res = EResult::InvalidBlockType;
+                }
+                if (res != EResult::Success) {
+                    m_gcode_blocks.clear();
+                    return;
+                }
+            }
 
-                        const size_t ref_id = (i == 0) ? 0 : i - 1;
-                        const size_t first_line_id = (i == 0) ? *m_cache_range.min :
-                            (*m_cache_range.min - 1 >= cumulative_lines_counts[ref_id]) ? *m_cache_range.min - cumulative_lines_counts[ref_id] : 1;
-                        const size_t last_line_id = (*m_cache_range.max - 1 <= cumulative_lines_counts[i]) ?
-                            (i == 0) ? *m_cache_range.max : *m_cache_range.max - cumulative_lines_counts[ref_id] : m_lines_ends[i].size() - 1;
-
-                        for (size_t j = first_line_id; j <= last_line_id; ++j) {
-                            const size_t begin = (j == 1) ? 0 : m_lines_ends[i][j - 2];
-                            const size_t end = m_lines_ends[i][j - 1];
-                            std::string gline;
-                            gline.insert(gline.end(), block.raw_data.begin() + begin, block.raw_data.begin() + end);
-                            add_gcode_line_to_lines_cache(gline);
-                        }
+            if (last_block_id >= m_gcode_blocks.size())
+                return;
 
-                        if (ftell(file.f) == file_size)
-                            break;
+            for (size_t i = first_block_id; i <= last_block_id; ++i) {
+                const GCodeBlockPosition& block_position = m_gcode_blocks[i];
+                fseek(file.f, block_position.data_position, SEEK_SET);
+                GCodeBlock block;
+                res = block.read_data(*file.f, file_header, block_position.header);
+                if (res != EResult::Success) {
+                    m_lines_cache.clear();
+                    return;
+                }
 
-                        res = read_next_block_header(*file.f, file_header, block_header, nullptr, 0);
-                        if (res != EResult::Success || block_header.type != (uint16_t)EBlockType::GCode) {
-                            m_lines_cache.clear();
-                            return;
-                        }
-                    }
+                const size_t ref_id = (i == 0) ? 0 : i - 1;
+                const size_t first_line_id = (i == 0) ? *m_cache_range.min :
+                    (*m_cache_range.min - 1 >= cumulative_lines_counts[ref_id]) ? *m_cache_range.min - cumulative_lines_counts[ref_id] : 1;
+                const size_t last_line_id = (*m_cache_range.max - 1 <= cumulative_lines_counts[i]) ?
+                    (i == 0) ? *m_cache_range.max : *m_cache_range.max - cumulative_lines_counts[ref_id] : m_lines_ends[i].size() - 1;
+
+                for (size_t j = first_line_id; j <= last_line_id; ++j) {
+                    const size_t begin = (j == 1) ? 0 : m_lines_ends[i][j - 2];
+                    const size_t end = m_lines_ends[i][j - 1];
+                    std::string gline;
+                    gline.insert(gline.end(), block.raw_data.begin() + begin, block.raw_data.begin() + end);
+                    add_gcode_line_to_lines_cache(gline);
                 }
             }
         }
@@ -546,12 +598,8 @@ void GCodeViewer::SequentialView::GCodeWindow::render(float top, float bottom, s
         const size_t half_lines_count = lines_count / 2;
         range.min = (curr_line_id > half_lines_count) ? curr_line_id - half_lines_count : 1;
         range.max = *range.min + lines_count - 1;
-        size_t lines_ends_count = 0;
-        for (const auto& le : m_lines_ends) {
-            lines_ends_count += le.size();
-        }
-        if (*range.max >= lines_ends_count) {
-            range.max = lines_ends_count - 1;
+        if (*range.max >= m_lines_count) {
+            range.max = m_lines_count - 1;
             range.min = *range.max - lines_count + 1;
         }
     };
@@ -824,6 +872,7 @@ void GCodeViewer::init()
 
 void GCodeViewer::load(const GCodeProcessorResult& gcode_result, const Print& print)
 {
+    SLIC3R_PROFILE_ZONE();
     // avoid processing if called with the same gcode_result
     if (m_last_result_id == gcode_result.id &&
         (m_last_view_type == m_view_type || (m_last_view_type != EViewType::VolumetricRate && m_view_type != EViewType::VolumetricRate)))
@@ -910,6 +959,7 @@ void GCodeViewer::load(const GCodeProcessorResult& gcode_result, const Print& pr
 
 void GCodeViewer::refresh(const GCodeProcessorResult& gcode_result, const std::vector<std::string>& str_tool_colors)
 {
+    SLIC3R_PROFILE_ZONE();
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
@@ -1186,6 +1236,15 @@ void GCodeViewer::export_toolpaths_to_obj(const char* filename) const
     if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::Triangle)
         return;
 
+    // the export needs all the vbos/ibos in the gpu memory, the next refresh of the render paths will page them out
+    if (m_paging.budget > 0) {
+        GCodeViewer* self = const_cast<GCodeViewer*>(this);
+        ++self->m_paging.tick;
+        for (size_t i = 0; i < t_buffer.indices.size(); ++i) {
+            self->page_in(const_cast<TBuffer&>(t_buffer), i);
+        }
+    }
+
     // collect color information to generate materials
     std::vector<ColorRGBA> colors;
     for (const RenderPath& path : t_buffer.render_paths) {
@@ -1260,7 +1319,10 @@ void GCodeViewer::export_toolpaths_to_obj(const char* filename) const
         for (size_t j = 0; j < vertices_count; ++j) {
             const size_t base = j * floats_per_vertex;
             out_vertices.push_back({ vertices[base + 0], vertices[base + 1], vertices[base + 2] });
-            out_normals.push_back({ vertices[base + 3], vertices[base + 4], vertices[base + 5] });
+            if (t_buffer.vertices.has_packed_normal())
+                out_normals.push_back(unpack_normal(vertices[base + 3]));
+            else
+                out_normals.push_back({ vertices[base + 3], vertices[base + 4], vertices[base + 5] });
         }
 
         if (i < t_buffer.vertices.vbos.size() - 1)
@@ -1335,6 +1397,7 @@ void GCodeViewer::export_toolpaths_to_obj(const char* filename) const
 
 void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 {
+    SLIC3R_PROFILE_ZONE();
     // max index buffer size, in bytes
     static const size_t IBUFFER_THRESHOLD_BYTES = 64 * 1024 * 1024;
 
@@ -1391,15 +1454,20 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
     // format data into the buffers to be rendered as solid
     auto add_vertices_as_solid = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer,
         unsigned int vbuffer_id, VertexBuffer& vertices, size_t move_id, bool account_for_volumetric_rate) {
-        auto store_vertex = [](VertexBuffer& vertices, const Vec3f& position, const Vec3f& normal) {
+        const bool packed_normal = buffer.vertices.has_packed_normal();
+        auto store_vertex = [packed_normal](VertexBuffer& vertices, const Vec3f& position, const Vec3f& normal) {
             // append position
             vertices.push_back(position.x());
             vertices.push_back(position.y());
             vertices.push_back(position.z());
             // append normal
-            vertices.push_back(normal.x());
-            vertices.push_back(normal.y());
-            vertices.push_back(normal.z());
+            if (packed_normal)
+                vertices.push_back(pack_normal(normal));
+            else {
+                vertices.push_back(normal.x());
+                vertices.push_back(normal.y());
+                vertices.push_back(normal.z());
+            }
         };
 
         if (buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr, account_for_volumetric_rate)) {
@@ -1447,12 +1515,19 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 
         last_path.sub_paths.back().last = { vbuffer_id, vertices.size(), move_id, curr.position };
     };
+    // last segment added to a TBuffer by add_indices_as_solid(), the TBuffers are filled in parallel, thus one instance per TBuffer
+    struct SolidSegment
+    {
+        Vec3f dir{ Vec3f::Zero() };
+        Vec3f up{ Vec3f::Zero() };
+        float sq_length{ 0.0f };
+    };
     auto add_indices_as_solid = [&](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr,
         const GCodeProcessorResult::MoveVertex* next, TBuffer& buffer, size_t& vbuffer_size, unsigned int ibuffer_id,
-        IndexBuffer& indices, size_t move_id, bool account_for_volumetric_rate) {
-            static Vec3f prev_dir;
-            static Vec3f prev_up;
-            static float sq_prev_length;
+        IndexBuffer& indices, size_t move_id, bool account_for_volumetric_rate, SolidSegment& prev_segment) {
+            Vec3f& prev_dir = prev_segment.dir;
+            Vec3f& prev_up = prev_segment.up;
+            float& sq_prev_length = prev_segment.sq_length;
             auto store_triangle = [](IndexBuffer& indices, IBufferType i1, IBufferType i2, IBufferType i3) {
                 indices.push_back(i1);
                 indices.push_back(i2);
@@ -1657,8 +1732,22 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 
     m_extruders_count = gcode_result.extruders_count;
 
-    unsigned int progress_count = 0;
-    static const unsigned int progress_threshold = 1000;
+    // the compact toolpaths may have been switched on/off in preferences since the last load
+    const VBuffer::EFormat solid_format = get_app_config()->get_bool("compact_toolpaths") ?
+        VBuffer::EFormat::PositionPackedNormal : VBuffer::EFormat::PositionNormal3;
+    for (TBuffer& buffer : m_buffers) {
+        if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle)
+            buffer.vertices.format = solid_format;
+    }
+
+    // gpu memory budget of the toolpaths, in MB, 0 to keep all the toolpaths in the gpu memory
+    m_paging.budget = static_cast<size_t>(std::strtoul(get_app_config()->get("toolpaths_gpu_budget").c_str(), nullptr, 10)) << 20;
+    // the buffers of the toolpaths rendered as lines and triangles are paged, the instanced and batched models are small
+    auto is_paged = [this](const TBuffer& buffer) {
+        return m_paging.budget > 0 && (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Line ||
+                                       buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle);
+    };
+
     wxProgressDialog* progress_dialog = wxGetApp().is_gcode_viewer() ?
         new wxProgressDialog(_L("Generating toolpaths"), "...",
             100, wxGetApp().mainframe, wxPD_AUTO_HIDE | wxPD_APP_MODAL) : nullptr;
@@ -1699,14 +1788,12 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 
     std::vector<size_t> biased_seams_ids;
 
-    // toolpaths data -> extract vertices from result
+    // toolpaths data -> extract seams, center of gravity and options zs from result
     for (size_t i = 0; i < m_moves_count; ++i) {
         const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
         if (curr.type == EMoveType::Seam)
             biased_seams_ids.push_back(i - biased_seams_ids.size() - 1);
 
-        const size_t move_id = i - biased_seams_ids.size();
-
         // skip first vertex
         if (i == 0)
             continue;
@@ -1724,64 +1811,6 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
             m_cog.add_segment(curr_pos, prev_pos, curr.mm3_per_mm * (curr_pos - prev_pos).norm());
         }
 
-        // update progress dialog
-        ++progress_count;
-        if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
-            progress_dialog->Update(int(100.0f * float(i) / (2.0f * float(m_moves_count))),
-                _L("Generating vertex buffer") + ": " + wxNumberFormatter::ToString(100.0 * double(i) / double(m_moves_count), 0, wxNumberFormatter::Style_None) + "%");
-            progress_dialog->Fit();
-            progress_count = 0;
-        }
-
-        const unsigned char id = buffer_id(curr.type);
-        TBuffer& t_buffer = m_buffers[id];
-        MultiVertexBuffer& v_multibuffer = vertices[id];
-        InstanceBuffer& inst_buffer = instances[id];
-        InstanceIdBuffer& inst_id_buffer = instances_ids[id];
-        InstancesOffsets& inst_offsets = instances_offsets[id];
-
-        // ensure there is at least one vertex buffer
-        if (v_multibuffer.empty())
-            v_multibuffer.push_back(VertexBuffer());
-
-        // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
-        // add another vertex buffer
-        size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : t_buffer.max_vertices_per_segment_size_bytes();
-        if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
-            v_multibuffer.push_back(VertexBuffer());
-            if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
-                Path& last_path = t_buffer.paths.back();
-                if (prev.type == curr.type && last_path.matches(curr, account_for_volumetric_rate))
-                    last_path.add_sub_path(prev, static_cast<unsigned int>(v_multibuffer.size()) - 1, 0, move_id - 1);
-            }
-        }
-
-        VertexBuffer& v_buffer = v_multibuffer.back();
-
-        switch (t_buffer.render_primitive_type)
-        {
-        case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(prev, curr, v_buffer); break; }
-        case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, move_id, account_for_volumetric_rate); break; }
-        case TBuffer::ERenderPrimitiveType::InstancedModel:
-        {
-            add_model_instance(curr, inst_buffer, inst_id_buffer, move_id);
-            inst_offsets.push_back(prev.position - curr.position);
-#if ENABLE_GCODE_VIEWER_STATISTICS
-            ++m_statistics.instances_count;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-            break;
-        }
-        case TBuffer::ERenderPrimitiveType::BatchedModel:
-        {
-            add_vertices_as_model_batch(curr, t_buffer.model.data, v_buffer, inst_buffer, inst_id_buffer, move_id);
-            inst_offsets.push_back(prev.position - curr.position);
-#if ENABLE_GCODE_VIEWER_STATISTICS
-            ++m_statistics.batched_count;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-            break;
-        }
-        }
-
         // collect options zs for later use
         if (curr.type == EMoveType::Pause_Print || curr.type == EMoveType::Custom_GCode) {
             const float* const last_z = options_zs.empty() ? nullptr : &options_zs.back();
@@ -1946,27 +1975,96 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
         }
     };
 
-#if ENABLE_GCODE_VIEWER_STATISTICS
-    auto load_vertices_time = std::chrono::high_resolution_clock::now();
-    m_statistics.load_vertices = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-
-    // smooth toolpaths corners for TBuffers using triangles
-    for (size_t i = 0; i < m_buffers.size(); ++i) {
-        const TBuffer& t_buffer = m_buffers[i];
-        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle)
-            smooth_triangle_toolpaths_corners(t_buffer, vertices[i]);
+    if (progress_dialog != nullptr) {
+        progress_dialog->Update(0, _L("Generating vertex buffer") + "...");
+        progress_dialog->Fit();
     }
 
-    // dismiss, no more needed
-    std::vector<size_t>().swap(biased_seams_ids);
+    // toolpaths data -> extract vertices from result
+    // each TBuffer depends only on the moves of its own type, so the TBuffers are filled in parallel, one task per TBuffer,
+    // while all the OpenGL calls stay on the main thread
+    tbb::parallel_for(size_t(0), m_buffers.size(), [&](size_t id) {
+        TBuffer& t_buffer = m_buffers[id];
+        MultiVertexBuffer& v_multibuffer = vertices[id];
+        InstanceBuffer& inst_buffer = instances[id];
+        InstanceIdBuffer& inst_id_buffer = instances_ids[id];
+        InstancesOffsets& inst_offsets = instances_offsets[id];
+
+        size_t seams_count = 0;
+        for (size_t i = 0; i < m_moves_count; ++i) {
+            const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+            if (curr.type == EMoveType::Seam)
+                ++seams_count;
+
+            const size_t move_id = i - seams_count;
+
+            // skip first vertex and the moves of the other TBuffers
+            if (i == 0 || buffer_id(curr.type) != id)
+                continue;
+
+            const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
+
+            // ensure there is at least one vertex buffer
+            if (v_multibuffer.empty())
+                v_multibuffer.push_back(VertexBuffer());
+
+            // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
+            // add another vertex buffer
+            size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : t_buffer.max_vertices_per_segment_size_bytes();
+            if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
+                v_multibuffer.push_back(VertexBuffer());
+                if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
+                    Path& last_path = t_buffer.paths.back();
+                    if (prev.type == curr.type && last_path.matches(curr, account_for_volumetric_rate))
+                        last_path.add_sub_path(prev, static_cast<unsigned int>(v_multibuffer.size()) - 1, 0, move_id - 1);
+                }
+            }
+
+            VertexBuffer& v_buffer = v_multibuffer.back();
+
+            switch (t_buffer.render_primitive_type)
+            {
+            case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(prev, curr, v_buffer); break; }
+            case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, move_id, account_for_volumetric_rate); break; }
+            case TBuffer::ERenderPrimitiveType::InstancedModel:
+            {
+                add_model_instance(curr, inst_buffer, inst_id_buffer, move_id);
+                inst_offsets.push_back(prev.position - curr.position);
+                break;
+            }
+            case TBuffer::ERenderPrimitiveType::BatchedModel:
+            {
+                add_vertices_as_model_batch(curr, t_buffer.model.data, v_buffer, inst_buffer, inst_id_buffer, move_id);
+                inst_offsets.push_back(prev.position - curr.position);
+                break;
+            }
+            }
+        }
+
+        // smooth toolpaths corners for TBuffers using triangles
+        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle)
+            smooth_triangle_toolpaths_corners(t_buffer, v_multibuffer);
 
-    for (MultiVertexBuffer& v_multibuffer : vertices) {
         for (VertexBuffer& v_buffer : v_multibuffer) {
             v_buffer.shrink_to_fit();
         }
+    });
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+    for (size_t i = 0; i < m_buffers.size(); ++i) {
+        if (m_buffers[i].render_primitive_type == TBuffer::ERenderPrimitiveType::InstancedModel)
+            m_statistics.instances_count += static_cast<int64_t>(instances_ids[i].size());
+        else if (m_buffers[i].render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel)
+            m_statistics.batched_count += static_cast<int64_t>(instances_ids[i].size());
     }
 
+    auto load_vertices_time = std::chrono::high_resolution_clock::now();
+    m_statistics.load_vertices = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+
+    // dismiss, no more needed
+    std::vector<size_t>().swap(biased_seams_ids);
+
     // move the wipe toolpaths half height up to render them on proper position
     MultiVertexBuffer& wipe_vertices = vertices[buffer_id(EMoveType::Wipe)];
     for (VertexBuffer& v_buffer : wipe_vertices) {
@@ -2017,10 +2115,17 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 #endif // ENABLE_GL_CORE_PROFILE
 
                 GLuint vbo_id = 0;
-                glsafe(::glGenBuffers(1, &vbo_id));
-                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, vbo_id));
-                glsafe(::glBufferData(GL_ARRAY_BUFFER, size_bytes, v_buffer.data(), GL_STATIC_DRAW));
-                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+                if (is_paged(t_buffer)) {
+                    // the vbo will be created by page_in(), when needed
+                    t_buffer.vertices.paged.emplace_back();
+                    t_buffer.vertices.paged.back().store(v_buffer.data(), size_bytes);
+                }
+                else {
+                    glsafe(::glGenBuffers(1, &vbo_id));
+                    glsafe(::glBindBuffer(GL_ARRAY_BUFFER, vbo_id));
+                    glsafe(::glBufferData(GL_ARRAY_BUFFER, size_bytes, v_buffer.data(), GL_STATIC_DRAW));
+                    glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+                }
 
 #if ENABLE_GL_CORE_PROFILE
                 if (OpenGLManager::get_gl_info().is_version_greater_or_equal_to(3, 0)) {
@@ -2066,34 +2171,20 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
     using VboIndexList = std::vector<unsigned int>;
     std::vector<VboIndexList> vbo_indices(m_buffers.size());
 #endif // ENABLE_GL_CORE_PROFILE
+    // variable used to keep track of the vertex buffers indices, used by the paging
+    std::vector<std::vector<size_t>> vbuffer_indices(m_buffers.size());
 
-    size_t seams_count = 0;
-
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
-        if (curr.type == EMoveType::Seam)
-            ++seams_count;
-
-        const size_t move_id = i - seams_count;
-
-        // skip first vertex
-        if (i == 0)
-            continue;
+#if ENABLE_GL_CORE_PROFILE
+    const bool use_vaos = OpenGLManager::get_gl_info().is_version_greater_or_equal_to(3, 0);
+#endif // ENABLE_GL_CORE_PROFILE
 
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
-        const GCodeProcessorResult::MoveVertex* next = nullptr;
-        if (i < m_moves_count - 1)
-            next = &gcode_result.moves[i + 1];
-
-        ++progress_count;
-        if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
-            progress_dialog->Update(int(100.0f * float(m_moves_count + i) / (2.0f * float(m_moves_count))),
-                _L("Generating index buffers") + ": " + wxNumberFormatter::ToString(100.0 * double(i) / double(m_moves_count), 0, wxNumberFormatter::Style_None) + "%");
-            progress_dialog->Fit();
-            progress_count = 0;
-        }
+    if (progress_dialog != nullptr) {
+        progress_dialog->Update(50, _L("Generating index buffers") + "...");
+        progress_dialog->Fit();
+    }
 
-        const unsigned char id = buffer_id(curr.type);
+    // the index buffers are filled in parallel, one task per TBuffer, as the vertex buffers above
+    tbb::parallel_for(size_t(0), m_buffers.size(), [&](size_t id) {
         TBuffer& t_buffer = m_buffers[id];
         MultiIndexBuffer& i_multibuffer = indices[id];
         CurrVertexBuffer& curr_vertex_buffer = curr_vertex_buffers[id];
@@ -2103,85 +2194,109 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 #else
         VboIndexList& vbo_index_list = vbo_indices[id];
 #endif // ENABLE_GL_CORE_PROFILE
+        std::vector<size_t>& vbuffer_index_list = vbuffer_indices[id];
+        SolidSegment prev_segment;
+
+        size_t seams_count = 0;
+        for (size_t i = 0; i < m_moves_count; ++i) {
+            const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+            if (curr.type == EMoveType::Seam)
+                ++seams_count;
+
+            const size_t move_id = i - seams_count;
 
-        // ensure there is at least one index buffer
-        if (i_multibuffer.empty()) {
-            i_multibuffer.push_back(IndexBuffer());
+            // skip first vertex and the moves of the other TBuffers
+            if (i == 0 || buffer_id(curr.type) != id)
+                continue;
+
+            const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
+            const GCodeProcessorResult::MoveVertex* next = nullptr;
+            if (i < m_moves_count - 1)
+                next = &gcode_result.moves[i + 1];
+
+            // ensure there is at least one index buffer
+            if (i_multibuffer.empty()) {
+                i_multibuffer.push_back(IndexBuffer());
 #if ENABLE_GL_CORE_PROFILE
-            if (!t_buffer.vertices.vaos.empty() && OpenGLManager::get_gl_info().is_version_greater_or_equal_to(3, 0))
-                vao_index_list.push_back(t_buffer.vertices.vaos[curr_vertex_buffer.first]);
+                if (!t_buffer.vertices.vaos.empty() && use_vaos)
+                    vao_index_list.push_back(t_buffer.vertices.vaos[curr_vertex_buffer.first]);
 
-            if (!t_buffer.vertices.vbos.empty())
-                vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+                if (!t_buffer.vertices.vbos.empty()) {
+                    vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+                    vbuffer_index_list.push_back(curr_vertex_buffer.first);
+                }
 #else
-            if (!t_buffer.vertices.vbos.empty())
-                vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+                if (!t_buffer.vertices.vbos.empty()) {
+                    vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+                    vbuffer_index_list.push_back(curr_vertex_buffer.first);
+                }
 #endif // ENABLE_GL_CORE_PROFILE
-        }
+            }
 
-        // if adding the indices for the current segment exceeds the threshold size of the current index buffer
-        // create another index buffer
-        size_t indiced_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.indices_size_bytes() : t_buffer.max_indices_per_segment_size_bytes();
-        if (i_multibuffer.back().size() * sizeof(IBufferType) >= IBUFFER_THRESHOLD_BYTES - indiced_size_to_add) {
-            i_multibuffer.push_back(IndexBuffer());
+            // if adding the indices for the current segment exceeds the threshold size of the current index buffer
+            // create another index buffer
+            size_t indiced_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.indices_size_bytes() : t_buffer.max_indices_per_segment_size_bytes();
+            if (i_multibuffer.back().size() * sizeof(IBufferType) >= IBUFFER_THRESHOLD_BYTES - indiced_size_to_add) {
+                i_multibuffer.push_back(IndexBuffer());
 #if ENABLE_GL_CORE_PROFILE
-            if (OpenGLManager::get_gl_info().is_version_greater_or_equal_to(3, 0))
-                vao_index_list.push_back(t_buffer.vertices.vaos[curr_vertex_buffer.first]);
+                if (use_vaos)
+                    vao_index_list.push_back(t_buffer.vertices.vaos[curr_vertex_buffer.first]);
 #endif // ENABLE_GL_CORE_PROFILE
-            vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
-            if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::BatchedModel) {
-                Path& last_path = t_buffer.paths.back();
-                last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, move_id - 1);
+                vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+                vbuffer_index_list.push_back(curr_vertex_buffer.first);
+                if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::BatchedModel) {
+                    Path& last_path = t_buffer.paths.back();
+                    last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, move_id - 1);
+                }
             }
-        }
 
-        // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
-        // create another index buffer
-        size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : t_buffer.max_vertices_per_segment_size_bytes();
-        if (curr_vertex_buffer.second * t_buffer.vertices.vertex_size_bytes() > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
-            i_multibuffer.push_back(IndexBuffer());
+            // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
+            // create another index buffer
+            size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : t_buffer.max_vertices_per_segment_size_bytes();
+            if (curr_vertex_buffer.second * t_buffer.vertices.vertex_size_bytes() > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
+                i_multibuffer.push_back(IndexBuffer());
 
-            ++curr_vertex_buffer.first;
-            curr_vertex_buffer.second = 0;
+                ++curr_vertex_buffer.first;
+                curr_vertex_buffer.second = 0;
 #if ENABLE_GL_CORE_PROFILE
-            if (OpenGLManager::get_gl_info().is_version_greater_or_equal_to(3, 0))
-                vao_index_list.push_back(t_buffer.vertices.vaos[curr_vertex_buffer.first]);
+                if (use_vaos)
+                    vao_index_list.push_back(t_buffer.vertices.vaos[curr_vertex_buffer.first]);
 #endif // ENABLE_GL_CORE_PROFILE
-            vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+                vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+                vbuffer_index_list.push_back(curr_vertex_buffer.first);
 
-            if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::BatchedModel) {
-                Path& last_path = t_buffer.paths.back();
-                last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, move_id - 1);
+                if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::BatchedModel) {
+                    Path& last_path = t_buffer.paths.back();
+                    last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, move_id - 1);
+                }
             }
-        }
 
-        IndexBuffer& i_buffer = i_multibuffer.back();
+            IndexBuffer& i_buffer = i_multibuffer.back();
 
-        switch (t_buffer.render_primitive_type)
-        {
-        case TBuffer::ERenderPrimitiveType::Line: {
-            add_indices_as_line(prev, curr, t_buffer, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, move_id, account_for_volumetric_rate);
-            curr_vertex_buffer.second += t_buffer.max_vertices_per_segment();
-            break;
-        }
-        case TBuffer::ERenderPrimitiveType::Triangle: {
-            add_indices_as_solid(prev, curr, next, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, move_id, account_for_volumetric_rate);
-            break;
-        }
-        case TBuffer::ERenderPrimitiveType::BatchedModel: {
-            add_indices_as_model_batch(t_buffer.model.data, i_buffer, curr_vertex_buffer.second);
-            curr_vertex_buffer.second += t_buffer.model.data.vertices_count();
-            break;
-        }
-        default: { break; }
+            switch (t_buffer.render_primitive_type)
+            {
+            case TBuffer::ERenderPrimitiveType::Line: {
+                add_indices_as_line(prev, curr, t_buffer, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, move_id, account_for_volumetric_rate);
+                curr_vertex_buffer.second += t_buffer.max_vertices_per_segment();
+                break;
+            }
+            case TBuffer::ERenderPrimitiveType::Triangle: {
+                add_indices_as_solid(prev, curr, next, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, move_id, account_for_volumetric_rate, prev_segment);
+                break;
+            }
+            case TBuffer::ERenderPrimitiveType::BatchedModel: {
+                add_indices_as_model_batch(t_buffer.model.data, i_buffer, curr_vertex_buffer.second);
+                curr_vertex_buffer.second += t_buffer.model.data.vertices_count();
+                break;
+            }
+            default: { break; }
+            }
         }
-    }
 
-    for (MultiIndexBuffer& i_multibuffer : indices) {
         for (IndexBuffer& i_buffer : i_multibuffer) {
             i_buffer.shrink_to_fit();
         }
-    }
+    });
 
     // toolpaths data -> send indices data to gpu
     for (size_t i = 0; i < m_buffers.size(); ++i) {
@@ -2201,6 +2316,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
                     ibuf.vao = vao_indices[i][t_buffer.indices.size() - 1];
 #endif // ENABLE_GL_CORE_PROFILE
                 ibuf.vbo = vbo_indices[i][t_buffer.indices.size() - 1];
+                ibuf.vbuffer_id = vbuffer_indices[i][t_buffer.indices.size() - 1];
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
                 m_statistics.total_indices_gpu_size += static_cast<int64_t>(size_bytes);
@@ -2208,10 +2324,15 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
                 ++m_statistics.ibuffers_count;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
-                glsafe(::glGenBuffers(1, &ibuf.ibo));
-                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf.ibo));
-                glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_bytes, i_buffer.data(), GL_STATIC_DRAW));
-                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+                if (is_paged(t_buffer))
+                    // the ibo will be created by page_in(), when needed
+                    ibuf.paged.store(i_buffer.data(), size_bytes);
+                else {
+                    glsafe(::glGenBuffers(1, &ibuf.ibo));
+                    glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf.ibo));
+                    glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_bytes, i_buffer.data(), GL_STATIC_DRAW));
+                    glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+                }
             }
         }
     }
@@ -2558,12 +2679,44 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
 
     const bool top_layer_only = get_app_config()->get_bool("seq_top_layer_only");
 
+    GCodeViewer* self = const_cast<GCodeViewer*>(this);
+    if (m_paging.budget > 0)
+        ++self->m_paging.tick;
+
     SequentialView::Endpoints global_endpoints = { m_moves_count , 0 };
     SequentialView::Endpoints top_layer_endpoints = global_endpoints;
     SequentialView* sequential_view = const_cast<SequentialView*>(&m_sequential_view);
     if (top_layer_only || !keep_sequential_current_first) sequential_view->current.first = 0;
     if (!keep_sequential_current_last) sequential_view->current.last = m_moves_count;
 
+    // the paths and the instances of a TBuffer are sorted by their sequential ids, so the ones in the layers range
+    // are found by binary search, a slider step costs O(log(total) + visible) instead of O(total)
+    const size_t layers_min_s_id = m_layers.get_range_at(m_layers_z_range[0]).first;
+    const size_t layers_max_s_id = m_layers.get_range_at(m_layers_z_range[1]).last;
+
+    // range of the paths of the given TBuffer to be tested for being in the layers range
+    auto paths_in_layers_range = [&](size_t b) {
+        const std::vector<Path>& buffer_paths = m_buffers[b].paths;
+        size_t begin = std::lower_bound(buffer_paths.begin(), buffer_paths.end(), layers_min_s_id,
+            [](const Path& path, size_t s_id) { return path.sub_paths.front().first.s_id < s_id; }) - buffer_paths.begin();
+        size_t end = std::upper_bound(buffer_paths.begin() + begin, buffer_paths.end(), layers_max_s_id,
+            [](size_t s_id, const Path& path) { return s_id < path.sub_paths.front().first.s_id; }) - buffer_paths.begin();
+        if (buffer_type(b) == EMoveType::Travel) {
+            // travel paths are merged with the adjacent ones (see is_travel_in_layers_range()), the merged paths
+            // in the layers range are contiguous, extend the range while the neighbours are accepted
+            while (begin > 0 && is_travel_in_layers_range(begin - 1, m_layers_z_range[0], m_layers_z_range[1]))
+                --begin;
+            if (m_layers_z_range[1] == m_layers.size() - 1)
+                // all the travels above the top layer are shown
+                end = buffer_paths.size();
+            else {
+                while (end < buffer_paths.size() && is_travel_in_layers_range(end, m_layers_z_range[0], m_layers_z_range[1]))
+                    ++end;
+            }
+        }
+        return std::make_pair(begin, end);
+    };
+
     // first pass: collect visible paths and update sequential view data
     std::vector<std::tuple<unsigned char, unsigned int, unsigned int, unsigned int>> paths;
     for (size_t b = 0; b < m_buffers.size(); ++b) {
@@ -2576,10 +2729,11 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
 
         if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::InstancedModel ||
             buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) {
-            for (size_t id : buffer.model.instances.s_ids) {
-                if (id < m_layers.get_range_at(m_layers_z_range[0]).first || m_layers.get_range_at(m_layers_z_range[1]).last < id)
-                    continue;
-
+            const std::vector<size_t>& s_ids = buffer.model.instances.s_ids;
+            auto it_begin = std::lower_bound(s_ids.begin(), s_ids.end(), layers_min_s_id);
+            auto it_end = std::upper_bound(it_begin, s_ids.end(), layers_max_s_id);
+            for (auto it = it_begin; it != it_end; ++it) {
+                const size_t id = *it;
                 global_endpoints.first = std::min(global_endpoints.first, id);
                 global_endpoints.last = std::max(global_endpoints.last, id);
 
@@ -2593,7 +2747,8 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
             }
         }
         else {
-            for (size_t i = 0; i < buffer.paths.size(); ++i) {
+            const auto [paths_begin, paths_end] = paths_in_layers_range(b);
+            for (size_t i = paths_begin; i < paths_end; ++i) {
                 const Path& path = buffer.paths[i];
                 if (path.type == EMoveType::Travel) {
                     if (!is_travel_in_layers_range(i, m_layers_z_range[0], m_layers_z_range[1]))
@@ -2629,6 +2784,13 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
         }
     }
 
+    // upload to gpu the paged out buffers of the visible paths
+    if (m_paging.budget > 0) {
+        for (const auto& [tbuffer_id, ibuffer_id, path_id, sub_path_id] : paths) {
+            self->page_in(self->m_buffers[tbuffer_id], ibuffer_id);
+        }
+    }
+
     // update current sequential position
     sequential_view->current.first = !top_layer_only && keep_sequential_current_first ? std::clamp(sequential_view->current.first, global_endpoints.first, global_endpoints.last) : global_endpoints.first;
     sequential_view->current.last = keep_sequential_current_last ? std::clamp(sequential_view->current.last, global_endpoints.first, global_endpoints.last) : global_endpoints.last;
@@ -2638,70 +2800,72 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
     for (const TBuffer& buffer : m_buffers) {
         if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::InstancedModel ||
             buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) {
-            for (size_t i = 0; i < buffer.model.instances.s_ids.size(); ++i) {
-                if (buffer.model.instances.s_ids[i] == m_sequential_view.current.last) {
-                    size_t offset = i * buffer.model.instances.instance_size_floats();
-                    sequential_view->current_position.x() = buffer.model.instances.buffer[offset + 0];
-                    sequential_view->current_position.y() = buffer.model.instances.buffer[offset + 1];
-                    sequential_view->current_position.z() = buffer.model.instances.buffer[offset + 2];
-                    sequential_view->current_offset = buffer.model.instances.offsets[i];
-                    found = true;
-                    break;
-                }
+            const std::vector<size_t>& s_ids = buffer.model.instances.s_ids;
+            auto it = std::lower_bound(s_ids.begin(), s_ids.end(), m_sequential_view.current.last);
+            if (it != s_ids.end() && *it == m_sequential_view.current.last) {
+                const size_t i = std::distance(s_ids.begin(), it);
+                size_t offset = i * buffer.model.instances.instance_size_floats();
+                sequential_view->current_position.x() = buffer.model.instances.buffer[offset + 0];
+                sequential_view->current_position.y() = buffer.model.instances.buffer[offset + 1];
+                sequential_view->current_position.z() = buffer.model.instances.buffer[offset + 2];
+                sequential_view->current_offset = buffer.model.instances.offsets[i];
+                found = true;
             }
         }
         else {
-            // searches the path containing the current position
-            for (const Path& path : buffer.paths) {
-                if (path.contains(m_sequential_view.current.last)) {
-                    const int sub_path_id = path.get_id_of_sub_path_containing(m_sequential_view.current.last);
-                    if (sub_path_id != -1) {
-                        const Path::Sub_Path& sub_path = path.sub_paths[sub_path_id];
-                        unsigned int offset = static_cast<unsigned int>(m_sequential_view.current.last - sub_path.first.s_id);
-                        if (offset > 0) {
-                            if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Line)
-                                offset = 2 * offset - 1;
-                            else if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
-                                unsigned int indices_count = buffer.indices_per_segment();
-                                offset = indices_count * (offset - 1) + (indices_count - 2);
-                                if (sub_path_id == 0)
-                                    offset += 6; // add 2 triangles for starting cap 
-                            }
+            // searches the path containing the current position, the first path ending at or after it
+            auto it = std::lower_bound(buffer.paths.begin(), buffer.paths.end(), m_sequential_view.current.last,
+                [](const Path& path, size_t s_id) { return path.sub_paths.back().last.s_id < s_id; });
+            if (it != buffer.paths.end() && it->contains(m_sequential_view.current.last)) {
+                const Path& path = *it;
+                const int sub_path_id = path.get_id_of_sub_path_containing(m_sequential_view.current.last);
+                if (sub_path_id != -1) {
+                    const Path::Sub_Path& sub_path = path.sub_paths[sub_path_id];
+                    unsigned int offset = static_cast<unsigned int>(m_sequential_view.current.last - sub_path.first.s_id);
+                    if (offset > 0) {
+                        if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Line)
+                            offset = 2 * offset - 1;
+                        else if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
+                            unsigned int indices_count = buffer.indices_per_segment();
+                            offset = indices_count * (offset - 1) + (indices_count - 2);
+                            if (sub_path_id == 0)
+                                offset += 6; // add 2 triangles for starting cap 
                         }
-                        offset += static_cast<unsigned int>(sub_path.first.i_id);
+                    }
+                    offset += static_cast<unsigned int>(sub_path.first.i_id);
 
-                        // gets the vertex index from the index buffer on gpu
-                        const IBuffer& i_buffer = buffer.indices[sub_path.first.b_id];
-                        glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, i_buffer.ibo));
+                    // gets the vertex index from the index buffer on gpu
+                    if (m_paging.budget > 0)
+                        self->page_in(const_cast<TBuffer&>(buffer), sub_path.first.b_id);
+                    const IBuffer& i_buffer = buffer.indices[sub_path.first.b_id];
+                    glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, i_buffer.ibo));
 #if ENABLE_OPENGL_ES
-                        IBufferType index = *static_cast<IBufferType*>(::glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER,
-                            static_cast<GLintptr>(offset * sizeof(IBufferType)), static_cast<GLsizeiptr>(sizeof(IBufferType)),
-                            GL_MAP_READ_BIT));
-                        glcheck();
-                        glsafe(::glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER));
+                    IBufferType index = *static_cast<IBufferType*>(::glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER,
+                        static_cast<GLintptr>(offset * sizeof(IBufferType)), static_cast<GLsizeiptr>(sizeof(IBufferType)),
+                        GL_MAP_READ_BIT));
+                    glcheck();
+                    glsafe(::glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER));
 #else
-                        IBufferType index = 0;
-                        glsafe(::glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(offset * sizeof(IBufferType)), static_cast<GLsizeiptr>(sizeof(IBufferType)), static_cast<void*>(&index)));
+                    IBufferType index = 0;
+                    glsafe(::glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(offset * sizeof(IBufferType)), static_cast<GLsizeiptr>(sizeof(IBufferType)), static_cast<void*>(&index)));
 #endif // ENABLE_OPENGL_ES
-                        glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+                    glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 
-                        // gets the position from the vertices buffer on gpu
-                        glsafe(::glBindBuffer(GL_ARRAY_BUFFER, i_buffer.vbo));
+                    // gets the position from the vertices buffer on gpu
+                    glsafe(::glBindBuffer(GL_ARRAY_BUFFER, i_buffer.vbo));
 #if ENABLE_OPENGL_ES
-                        sequential_view->current_position = *static_cast<Vec3f*>(::glMapBufferRange(GL_ARRAY_BUFFER,
-                            static_cast<GLintptr>(index * buffer.vertices.vertex_size_bytes()),
-                            static_cast<GLsizeiptr>(buffer.vertices.position_size_bytes()), GL_MAP_READ_BIT));
-                        glcheck();
-                        glsafe(::glUnmapBuffer(GL_ARRAY_BUFFER));
+                    sequential_view->current_position = *static_cast<Vec3f*>(::glMapBufferRange(GL_ARRAY_BUFFER,
+                        static_cast<GLintptr>(index * buffer.vertices.vertex_size_bytes()),
+                        static_cast<GLsizeiptr>(buffer.vertices.position_size_bytes()), GL_MAP_READ_BIT));
+                    glcheck();
+                    glsafe(::glUnmapBuffer(GL_ARRAY_BUFFER));
 #else
-                        glsafe(::glGetBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(index * buffer.vertices.vertex_size_bytes()), static_cast<GLsizeiptr>(3 * sizeof(float)), static_cast<void*>(sequential_view->current_position.data())));
+                    glsafe(::glGetBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(index * buffer.vertices.vertex_size_bytes()), static_cast<GLsizeiptr>(3 * sizeof(float)), static_cast<void*>(sequential_view->current_position.data())));
 #endif // ENABLE_OPENGL_ES
-                        glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+                    glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
 
-                        sequential_view->current_offset = Vec3f::Zero();
-                        found = true;
-                        break;
-                    }
+                    sequential_view->current_offset = Vec3f::Zero();
+                    found = true;
                 }
             }
         }
@@ -2834,29 +2998,26 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
         if (has_second_range)
             buffer.model.instances.render_ranges.ranges.push_back({ 0, 0, 0, Neutral_Color });
 
-        if (m_sequential_view.current.first <= buffer.model.instances.s_ids.back() && buffer.model.instances.s_ids.front() <= m_sequential_view.current.last) {
-            for (size_t id : buffer.model.instances.s_ids) {
-                if (has_second_range) {
-                    if (id < m_sequential_view.endpoints.first) {
-                        ++buffer.model.instances.render_ranges.ranges.front().offset;
-                        if (id <= m_sequential_view.current.first)
-                            ++buffer.model.instances.render_ranges.ranges.back().offset;
-                        else
-                            ++buffer.model.instances.render_ranges.ranges.back().count;
-                    }
-                    else if (id <= m_sequential_view.current.last)
-                        ++buffer.model.instances.render_ranges.ranges.front().count;
-                    else
-                        break;
-                }
-                else {
-                    if (id <= m_sequential_view.current.first)
-                        ++buffer.model.instances.render_ranges.ranges.front().offset;
-                    else if (id <= m_sequential_view.current.last)
-                        ++buffer.model.instances.render_ranges.ranges.front().count;
-                    else
-                        break;
-                }
+        const std::vector<size_t>& s_ids = buffer.model.instances.s_ids;
+        if (m_sequential_view.current.first <= s_ids.back() && s_ids.front() <= m_sequential_view.current.last) {
+            // the instances are sorted by their sequential ids, count them by binary search
+            auto count_up_to = [&s_ids](size_t id) {
+                return static_cast<unsigned int>(std::distance(s_ids.begin(), std::upper_bound(s_ids.begin(), s_ids.end(), id)));
+            };
+            InstanceVBuffer::Ranges::Range& front = buffer.model.instances.render_ranges.ranges.front();
+            if (has_second_range) {
+                // instances before the sequential endpoints
+                const unsigned int count_before = static_cast<unsigned int>(std::distance(s_ids.begin(),
+                    std::lower_bound(s_ids.begin(), s_ids.end(), m_sequential_view.endpoints.first)));
+                InstanceVBuffer::Ranges::Range& back = buffer.model.instances.render_ranges.ranges.back();
+                front.offset = count_before;
+                front.count = std::max(count_up_to(m_sequential_view.current.last), count_before) - count_before;
+                back.offset = std::min(count_up_to(m_sequential_view.current.first), count_before);
+                back.count = count_before - back.offset;
+            }
+            else {
+                front.offset = count_up_to(m_sequential_view.current.first);
+                front.count = std::max(count_up_to(m_sequential_view.current.last), front.offset) - front.offset;
             }
         }
     }
@@ -3011,6 +3172,9 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
 
     wxGetApp().plater()->enable_preview_moves_slider(!paths.empty());
 
+    if (m_paging.budget > 0)
+        self->page_out();
+
 #if ENABLE_GCODE_VIEWER_STATISTICS
     for (const TBuffer& buffer : m_buffers) {
         statistics->render_paths_size += SLIC3R_STDUNORDEREDSET_MEMSIZE(buffer.render_paths, RenderPath);
@@ -3026,6 +3190,85 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 }
 
+void GCodeViewer::page_in(TBuffer& buffer, size_t ibuffer_id)
+{
+    IBuffer& i_buffer = buffer.indices[ibuffer_id];
+    if (i_buffer.paged.empty())
+        return;
+
+    const size_t vbuffer_id = i_buffer.vbuffer_id;
+    PagedBuffer& v_paged = buffer.vertices.paged[vbuffer_id];
+    if (buffer.vertices.vbos[vbuffer_id] == 0) {
+        const unsigned int vbo_id = v_paged.upload(GL_ARRAY_BUFFER);
+        buffer.vertices.vbos[vbuffer_id] = vbo_id;
+        // the vbo may be shared by several ibos
+        for (IBuffer& other : buffer.indices) {
+            if (other.vbuffer_id == vbuffer_id)
+                other.vbo = vbo_id;
+        }
+    }
+    v_paged.last_used = m_paging.tick;
+
+    if (i_buffer.ibo == 0)
+        i_buffer.ibo = i_buffer.paged.upload(GL_ELEMENT_ARRAY_BUFFER);
+    i_buffer.paged.last_used = m_paging.tick;
+}
+
+void GCodeViewer::page_out()
+{
+    struct Resident
+    {
+        TBuffer* buffer;
+        // index into VBuffer::vbos or into TBuffer::indices
+        size_t id;
+        bool is_vbo;
+        const PagedBuffer* paged;
+    };
+
+    std::vector<Resident> residents;
+    size_t used_bytes = 0;
+    for (TBuffer& buffer : m_buffers) {
+        for (size_t i = 0; i < buffer.vertices.paged.size(); ++i) {
+            if (buffer.vertices.vbos[i] != 0) {
+                residents.push_back({ &buffer, i, true, &buffer.vertices.paged[i] });
+                used_bytes += buffer.vertices.paged[i].size_bytes;
+            }
+        }
+        for (size_t i = 0; i < buffer.indices.size(); ++i) {
+            const IBuffer& i_buffer = buffer.indices[i];
+            if (!i_buffer.paged.empty() && i_buffer.ibo != 0) {
+                residents.push_back({ &buffer, i, false, &i_buffer.paged });
+                used_bytes += i_buffer.paged.size_bytes;
+            }
+        }
+    }
+
+    if (used_bytes <= m_paging.budget)
+        return;
+
+    std::sort(residents.begin(), residents.end(), [](const Resident& r1, const Resident& r2) { return r1.paged->last_used < r2.paged->last_used; });
+    for (const Resident& r : residents) {
+        // the buffers used in the current tick are needed for rendering, even if they do not fit into the budget
+        if (used_bytes <= m_paging.budget || r.paged->last_used == m_paging.tick)
+            break;
+
+        if (r.is_vbo) {
+            glsafe(::glDeleteBuffers(1, &r.buffer->vertices.vbos[r.id]));
+            r.buffer->vertices.vbos[r.id] = 0;
+            for (IBuffer& i_buffer : r.buffer->indices) {
+                if (i_buffer.vbuffer_id == r.id)
+                    i_buffer.vbo = 0;
+            }
+        }
+        else {
+            IBuffer& i_buffer = r.buffer->indices[r.id];
+            glsafe(::glDeleteBuffers(1, &i_buffer.ibo));
+            i_buffer.ibo = 0;
+        }
+        used_bytes -= r.paged->size_bytes;
+    }
+}
+
 void GCodeViewer::render_toolpaths()
 {
     const Camera& camera = wxGetApp().plater()->get_camera();
@@ -3144,7 +3387,8 @@ void GCodeViewer::render_toolpaths()
             const bool has_normals = buffer.vertices.normal_size_floats() > 0;
             if (has_normals) {
                 if (normal_id != -1) {
-                    glsafe(::glVertexAttribPointer(normal_id, buffer.vertices.normal_size_floats(), GL_FLOAT, GL_FALSE, buffer.vertices.vertex_size_bytes(), (const void*)buffer.vertices.normal_offset_bytes()));
+                    glsafe(::glVertexAttribPointer(normal_id, buffer.vertices.normal_components(), buffer.vertices.has_packed_normal() ? GL_BYTE : GL_FLOAT,
+                            buffer.vertices.has_packed_normal() ? GL_TRUE : GL_FALSE, buffer.vertices.vertex_size_bytes(), (const void*)buffer.vertices.normal_offset_bytes()));
                     glsafe(::glEnableVertexAttribArray(normal_id));
                 }
             }
@@ -3245,7 +3489,8 @@ void GCodeViewer::render_toolpaths()
                 const bool has_normals = buffer.vertices.normal_size_floats() > 0;
                 if (has_normals) {
                     if (normal_id != -1) {
-                        glsafe(::glVertexAttribPointer(normal_id, buffer.vertices.normal_size_floats(), GL_FLOAT, GL_FALSE, buffer.vertices.vertex_size_bytes(), (const void*)buffer.vertices.normal_offset_bytes()));
+                        glsafe(::glVertexAttribPointer(normal_id, buffer.vertices.normal_components(), buffer.vertices.has_packed_normal() ? GL_BYTE : GL_FLOAT,
+                                buffer.vertices.has_packed_normal() ? GL_TRUE : GL_FALSE, buffer.vertices.vertex_size_bytes(), (const void*)buffer.vertices.normal_offset_bytes()));
                         glsafe(::glEnableVertexAttribArray(normal_id));
                     }
                 }
@@ -3321,7 +3566,8 @@ void GCodeViewer::render_toolpaths()
         const bool has_normals = buffer->vertices.normal_size_floats() > 0;
         if (has_normals) {
             if (normal_id != -1) {
-                glsafe(::glVertexAttribPointer(normal_id, buffer->vertices.normal_size_floats(), GL_FLOAT, GL_FALSE, buffer->vertices.vertex_size_bytes(), (const void*)buffer->vertices.normal_offset_bytes()));
+                glsafe(::glVertexAttribPointer(normal_id, buffer->vertices.normal_components(), buffer->vertices.has_packed_normal() ? GL_BYTE : GL_FLOAT,
+                        buffer->vertices.has_packed_normal() ? GL_TRUE : GL_FALSE, buffer->vertices.vertex_size_bytes(), (const void*)buffer->vertices.normal_offset_bytes()));
                 glsafe(::glEnableVertexAttribArray(normal_id));
             }
         }
@@ -53,6 +53,22 @@ class GCodeViewer
         CustomGCodes
     };
 
+    // compressed copy of the data of a vbo/ibo, kept in cpu memory when the toolpaths are paged (see GCodeViewer::page_in())
+    struct PagedBuffer
+    {
+        // data compressed by miniz
+        std::vector<unsigned char> data;
+        // size of the uncompressed data, in bytes
+        size_t size_bytes{ 0 };
+        // value of GCodeViewer::Paging::tick when the buffer was used for the last time
+        size_t last_used{ 0 };
+
+        bool empty() const { return data.empty(); }
+        void store(const void* buffer, size_t size);
+        // creates a gpu buffer bound to the given target filled with the uncompressed data, returns its id
+        unsigned int upload(unsigned int target) const;
+    };
+
     // vbo buffer containing vertices data used to render a specific toolpath type
     struct VBuffer
     {
@@ -63,7 +79,10 @@ class GCodeViewer
             // vertex format: 4 floats -> position.x|position.y|position.z|normal.x
             PositionNormal1,
             // vertex format: 6 floats -> position.x|position.y|position.z|normal.x|normal.y|normal.z
-            PositionNormal3
+            PositionNormal3,
+            // vertex format: 4 floats -> position.x|position.y|position.z|normal packed into 3 signed normalized bytes + 1 zero byte
+            // (used by the compact toolpaths to save 1/3 of the gpu memory of PositionNormal3)
+            PositionPackedNormal
         };
 
         EFormat format{ EFormat::Position };
@@ -71,8 +90,10 @@ class GCodeViewer
         // vaos id
         std::vector<unsigned int> vaos;
 #endif // ENABLE_GL_CORE_PROFILE
-        // vbos id
+        // vbos id, 0 for the vbos paged out of the gpu memory
         std::vector<unsigned int> vbos;
+        // cpu copies of the vbos, empty if the toolpaths are not paged
+        std::vector<PagedBuffer> paged;
         // sizes of the buffers, in bytes, used in export to obj
         std::vector<size_t> sizes;
         // count of vertices, updated after data are sent to gpu
@@ -93,7 +114,7 @@ class GCodeViewer
         size_t position_size_bytes() const { return position_size_floats() * sizeof(float); }
 
         size_t normal_offset_floats() const {
-            assert(format == EFormat::PositionNormal1 || format == EFormat::PositionNormal3);
+            assert(format == EFormat::PositionNormal1 || format == EFormat::PositionNormal3 || format == EFormat::PositionPackedNormal);
             return position_size_floats();
         }
         size_t normal_offset_bytes() const { return normal_offset_floats() * sizeof(float); }
@@ -101,13 +122,18 @@ class GCodeViewer
         size_t normal_size_floats() const {
             switch (format)
             {
-            case EFormat::PositionNormal1: { return 1; }
-            case EFormat::PositionNormal3: { return 3; }
-            default:                       { return 0; }
+            case EFormat::PositionNormal1:      { return 1; }
+            case EFormat::PositionNormal3:      { return 3; }
+            case EFormat::PositionPackedNormal: { return 1; }
+            default:                            { return 0; }
             }
         }
         size_t normal_size_bytes() const { return normal_size_floats() * sizeof(float); }
 
+        bool has_packed_normal() const { return format == EFormat::PositionPackedNormal; }
+        // count of the components of the normal attribute, as sent to the shader
+        size_t normal_components() const { return has_packed_normal() ? 3 : normal_size_floats(); }
+
         void reset();
     };
 
@@ -177,8 +203,12 @@ class GCodeViewer
 #endif // ENABLE_GL_CORE_PROFILE
         // id of the associated vertex buffer
         unsigned int vbo{ 0 };
-        // ibo id
+        // index of the associated vertex buffer into VBuffer::vbos
+        size_t vbuffer_id{ 0 };
+        // ibo id, 0 if paged out of the gpu memory
         unsigned int ibo{ 0 };
+        // cpu copy of the ibo, empty if the toolpaths are not paged
+        PagedBuffer paged;
         // count of indices, updated after data are sent to gpu
         size_t count{ 0 };
 
@@ -365,7 +395,8 @@ class GCodeViewer
             {
             case ERenderPrimitiveType::Line:
             case ERenderPrimitiveType::Triangle: {
-                return !vertices.vbos.empty() && vertices.vbos.front() != 0 && !indices.empty() && indices.front().ibo != 0;
+                return !vertices.vbos.empty() && !indices.empty() &&
+                    ((vertices.vbos.front() != 0 && indices.front().ibo != 0) || (!vertices.paged.empty() && !indices.front().paged.empty()));
             }
             case ERenderPrimitiveType::InstancedModel: { return model.model.is_initialized() && !model.instances.buffer.empty(); }
             case ERenderPrimitiveType::BatchedModel: {
@@ -710,6 +741,18 @@ public:
             bool m_is_binary_file{ false };
             // map for accessing data in file by line number
             std::vector<std::vector<size_t>> m_lines_ends;
+            // total count of lines in m_lines_ends
+            size_t m_lines_count{ 0 };
+            // count of lines up to and including the i-th block of m_lines_ends, to find the block containing a line by bisection
+            std::vector<size_t> m_cumulative_lines_counts;
+            struct GCodeBlockPosition
+            {
+                bgcode::core::BlockHeader header;
+                // position of the block data in the file, right after the block header
+                long data_position{ 0 };
+            };
+            // G-code blocks of a binary G-code file, filled in when the file is read for the first time
+            std::vector<GCodeBlockPosition> m_gcode_blocks;
             std::vector<Line> m_lines_cache;
             Range m_cache_range;
             size_t m_max_line_length{ 0 };
@@ -718,6 +761,9 @@ public:
             void load_gcode(const GCodeProcessorResult& gcode_result);
             void reset() {
                 m_lines_ends.clear();
+                m_lines_count = 0;
+                m_cumulative_lines_counts.clear();
+                m_gcode_blocks.clear();
                 m_lines_cache.clear();
                 m_filename.clear();
             }
@@ -811,6 +857,17 @@ private:
 
     bool m_contained_in_bed{ true };
 
+    // Paging of the vbos/ibos of the toolpaths rendered as lines and triangles between the gpu memory and compressed copies
+    // in the cpu memory. When enabled, only the buffers of the paths visible in the current layers range are uploaded to the gpu.
+    struct Paging
+    {
+        // gpu memory budget, in bytes, 0 if the paging is disabled
+        size_t budget{ 0 };
+        // incremented at every refresh of the render paths
+        size_t tick{ 0 };
+    };
+    Paging m_paging;
+
     ConflictResultOpt m_conflict_result;
 
 public:
@@ -892,6 +949,10 @@ public:
 private:
     void load_toolpaths(const GCodeProcessorResult& gcode_result);
     void load_wipetower_shell(const Print& print);
+    // Uploads the given ibo of the given TBuffer and its vbo to the gpu, if paged out, and marks them as used in the current tick.
+    void page_in(TBuffer& buffer, size_t ibuffer_id);
+    // Releases the least recently used vbos/ibos not used in the current tick until the paged buffers fit into the budget.
+    void page_out();
     void render_toolpaths();
     void render_shells();
     void render_legend(float& legend_height);
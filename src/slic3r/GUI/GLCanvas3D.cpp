@@ -25,6 +25,7 @@
 #include "libslic3r/Technologies.hpp"
 #include "libslic3r/Tesselate.hpp"
 #include "libslic3r/PresetBundle.hpp"
+#include "libslic3r/ProfilerTracy.hpp"
 #include "3DBed.hpp"
 #include "3DScene.hpp"
 #include "BackgroundSlicingProcess.hpp"
@@ -1848,6 +1849,7 @@ void GLCanvas3D::update_volumes_colors_by_extruder()
 
 void GLCanvas3D::render()
 {
+    SLIC3R_PROFILE_ZONE();
     if (m_in_render) {
         // if called recursively, return
         m_dirty = true;
@@ -2059,6 +2061,7 @@ void GLCanvas3D::render()
 
     m_canvas->SwapBuffers();
     m_render_stats.increment_fps_counter();
+    SLIC3R_PROFILE_FRAME();
 }
 
 void GLCanvas3D::render_thumbnail(ThumbnailData& thumbnail_data, unsigned int w, unsigned int h, const ThumbnailsParams& thumbnail_params, Camera::EType camera_type)
@@ -6947,6 +6950,8 @@ void GLCanvas3D::_load_print_object_toolpaths(const PrintObject& print_object, c
     ctxt.extruders_cnt = wxGetApp().extruders_edited_cnt();
 
     ctxt.shifted_copies = &print_object.instances();
+    if (ctxt.shifted_copies->empty())
+        return;
 
     // order layers by print_z
     {
@@ -7021,6 +7026,26 @@ void GLCanvas3D::_load_print_object_toolpaths(const PrintObject& print_object, c
         for (GLModel::Geometry& g : geometries) {
             g.format = { GLModel::Geometry::EPrimitiveType::Triangles, GLModel::Geometry::EVertexLayout::P3N3 };
         }
+        // The extrusions of a layer are triangulated once for the first instance into layer_geometries,
+        // the other instances of the same PrintObject only get a shifted copy of the vertices.
+        std::vector<GLModel::Geometry> layer_geometries(geometries.size());
+        for (GLModel::Geometry& g : layer_geometries) {
+            g.format = { GLModel::Geometry::EPrimitiveType::Triangles, GLModel::Geometry::EVertexLayout::P3N3 };
+        }
+        auto select_layer_geometry = [&geometries, &layer_geometries, &select_geometry](size_t layer_idx, int extruder, int feature) -> GLModel::Geometry& {
+            return layer_geometries[&select_geometry(layer_idx, extruder, feature) - geometries.data()];
+        };
+        auto append_shifted = [](GLModel::Geometry& dst, const GLModel::Geometry& src, const Vec3f& shift) {
+            const unsigned int first_vertex = unsigned(dst.vertices_count());
+            dst.reserve_more_vertices(src.vertices_count());
+            for (size_t i = 0; i < src.vertices.size(); i += 6) {
+                const float* v = src.vertices.data() + i;
+                dst.vertices.insert(dst.vertices.end(), { v[0] + shift.x(), v[1] + shift.y(), v[2] + shift.z(), v[3], v[4], v[5] });
+            }
+            dst.reserve_more_indices(src.indices.size());
+            for (unsigned int idx : src.indices)
+                dst.indices.emplace_back(first_vertex + idx);
+        };
         for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
             const Layer *layer = ctxt.layers[idx_layer];
 
@@ -7049,42 +7074,50 @@ void GLCanvas3D::_load_print_object_toolpaths(const PrintObject& print_object, c
                 }
             }
 
-            for (const PrintInstance &instance : *ctxt.shifted_copies) {
-                const Point &copy = instance.shift;
-                for (const LayerRegion *layerm : layer->regions()) {
-                    if (is_selected_separate_extruder) {
-                        const PrintRegionConfig& cfg = layerm->region().config();
-                        if (cfg.perimeter_extruder.value    != m_selected_extruder ||
-                            cfg.infill_extruder.value       != m_selected_extruder ||
-                            cfg.solid_infill_extruder.value != m_selected_extruder)
-                            continue;
-                    }
-                    if (ctxt.has_perimeters)
-                        _3DScene::extrusionentity_to_verts(layerm->perimeters(), float(layer->print_z), copy,
-                            select_geometry(idx_layer, layerm->region().config().perimeter_extruder.value, 0));
-                    if (ctxt.has_infill) {
-                        for (const ExtrusionEntity *ee : layerm->fills()) {
-                            // fill represents infill extrusions of a single island.
-                            const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                            if (! fill->entities.empty())
-                                _3DScene::extrusionentity_to_verts(*fill, float(layer->print_z), copy,
-                                    select_geometry(idx_layer, fill->entities.front()->role().is_solid_infill() ?
-                                                    layerm->region().config().solid_infill_extruder :
-                                                    layerm->region().config().infill_extruder, 1));
-                        }
-                    }
+            for (GLModel::Geometry& g : layer_geometries) {
+                g.vertices.clear();
+                g.indices.clear();
+            }
+            const Point &copy = ctxt.shifted_copies->front().shift;
+            for (const LayerRegion *layerm : layer->regions()) {
+                if (is_selected_separate_extruder) {
+                    const PrintRegionConfig& cfg = layerm->region().config();
+                    if (cfg.perimeter_extruder.value    != m_selected_extruder ||
+                        cfg.infill_extruder.value       != m_selected_extruder ||
+                        cfg.solid_infill_extruder.value != m_selected_extruder)
+                        continue;
                 }
-                if (ctxt.has_support) {
-                    const SupportLayer *support_layer = dynamic_cast<const SupportLayer*>(layer);
-                    if (support_layer) {
-                        for (const ExtrusionEntity *extrusion_entity : support_layer->support_fills.entities)
-                            _3DScene::extrusionentity_to_verts(extrusion_entity, float(layer->print_z), copy,
-                                select_geometry(idx_layer, (extrusion_entity->role() == ExtrusionRole::SupportMaterial) ?
-                                                support_layer->object()->config().support_material_extruder :
-                                                support_layer->object()->config().support_material_interface_extruder, 2));
+                if (ctxt.has_perimeters)
+                    _3DScene::extrusionentity_to_verts(layerm->perimeters(), float(layer->print_z), copy,
+                        select_layer_geometry(idx_layer, layerm->region().config().perimeter_extruder.value, 0));
+                if (ctxt.has_infill) {
+                    for (const ExtrusionEntity *ee : layerm->fills()) {
+                        // fill represents infill extrusions of a single island.
+                        const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                        if (! fill->entities.empty())
+                            _3DScene::extrusionentity_to_verts(*fill, float(layer->print_z), copy,
+                                select_layer_geometry(idx_layer, fill->entities.front()->role().is_solid_infill() ?
+                                                layerm->region().config().solid_infill_extruder :
+                                                layerm->region().config().infill_extruder, 1));
                     }
                 }
             }
+            if (ctxt.has_support) {
+                const SupportLayer *support_layer = dynamic_cast<const SupportLayer*>(layer);
+                if (support_layer) {
+                    for (const ExtrusionEntity *extrusion_entity : support_layer->support_fills.entities)
+                        _3DScene::extrusionentity_to_verts(extrusion_entity, float(layer->print_z), copy,
+                            select_layer_geometry(idx_layer, (extrusion_entity->role() == ExtrusionRole::SupportMaterial) ?
+                                            support_layer->object()->config().support_material_extruder :
+                                            support_layer->object()->config().support_material_interface_extruder, 2));
+                }
+            }
+            for (const PrintInstance &instance : *ctxt.shifted_copies) {
+                const Vec2d shift = unscale(instance.shift) - unscale(copy);
+                for (size_t i = 0; i < geometries.size(); ++i)
+                    if (! layer_geometries[i].is_empty())
+                        append_shifted(geometries[i], layer_geometries[i], Vec3f(float(shift.x()), float(shift.y()), 0.f));
+            }
             // Ensure that no volume grows over the limits. If the volume is too large, allocate a new one.
 	        for (size_t i = 0; i < vols.size(); ++i) {
 	            GLVolume &vol = *vols[i];
@@ -7310,41 +7343,80 @@ void GLCanvas3D::_load_wipe_tower_toolpaths(const BuildVolume& build_volume, con
 void GLCanvas3D::_load_sla_shells()
 {
     const SLAPrint* print = this->sla_print();
-    if (print->objects().empty())
+    if (print->objects().empty()) {
         // nothing to render, return
+        m_sla_preview_cache.objects.clear();
         return;
+    }
 
-    auto add_volume = [this](const SLAPrintObject &object, int volume_id, const SLAPrintObject::Instance& instance,
-        const indexed_triangle_set& mesh, const ColorRGBA& color, bool outside_printer_detection_enabled) {
-        m_volumes.volumes.emplace_back(new GLVolume(color));
-        GLVolume& v = *m_volumes.volumes.back();
+    // Rebuild the geometry of the objects changed since the last call, in parallel.
+    std::vector<std::pair<const SLAPrintObject*, SlaPreviewCache::Object*>> invalidated;
+    {
+        std::map<ObjectID, SlaPreviewCache::Object> &cache = m_sla_preview_cache.objects;
+        std::map<ObjectID, SlaPreviewCache::Object>  valid;
+        for (const SLAPrintObject* obj : print->objects()) {
+            std::shared_ptr<const indexed_triangle_set> m = obj->get_mesh_to_print();
+            const std::array<size_t, 3> timestamps{
+                obj->step_state_with_timestamp(slaposSupportTree).timestamp,
+                obj->step_state_with_timestamp(slaposPad).timestamp,
+                obj->step_state_with_timestamp(slaposSliceSupports).timestamp };
+            if (auto it = cache.find(obj->id()); it != cache.end() && it->second.mesh_to_print == m && it->second.timestamps == timestamps)
+                valid.insert(cache.extract(it));
+            else {
+                SlaPreviewCache::Object &cached = valid[obj->id()];
+                cached.mesh_to_print = std::move(m);
+                cached.timestamps    = timestamps;
+                invalidated.emplace_back(obj, &cached);
+            }
+        }
+        // Objects no more present in the print are dropped.
+        cache = std::move(valid);
+    }
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, invalidated.size() * 3), [&invalidated](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const auto [obj, cached] = invalidated[i / 3];
+            if (! cached->mesh_to_print || cached->mesh_to_print->empty())
+                continue;
+            const indexed_triangle_set &mesh = i % 3 == 0 ? *cached->mesh_to_print : i % 3 == 1 ? obj->support_mesh().its : obj->pad_mesh().its;
+            if (mesh.empty())
+                continue;
+            SlaPreviewCache::Mesh &out = cached->meshes[i % 3];
 #if ENABLE_SMOOTH_NORMALS
-        v.model.init_from(mesh, true);
+            out.model.init_from(TriangleMesh(mesh), true);
 #else
-        v.model.init_from(mesh);
+            out.model.init_from(mesh);
 #endif // ENABLE_SMOOTH_NORMALS
+            out.convex_hull = std::make_shared<const TriangleMesh>(its_convex_hull(mesh));
+        }
+    });
+
+    auto add_volume = [this](const SLAPrintObject &object, int volume_id, const SLAPrintObject::Instance& instance,
+        const SlaPreviewCache::Mesh& mesh, const ColorRGBA& color, bool outside_printer_detection_enabled) {
+        m_volumes.volumes.emplace_back(new GLVolume(color));
+        GLVolume& v = *m_volumes.volumes.back();
+        v.model.init_from(GLModel::Geometry(mesh.model.get_geometry()));
         v.shader_outside_printer_detection_enabled = outside_printer_detection_enabled;
         v.composite_id.volume_id = volume_id;
         v.set_instance_offset(unscale(instance.shift.x(), instance.shift.y(), 0.0));
         v.set_instance_rotation({ 0.0, 0.0, (double)instance.rotation });
         v.set_instance_mirror(X, object.is_left_handed() ? -1. : 1.);
-        v.set_convex_hull(TriangleMesh{its_convex_hull(mesh)});
+        v.set_convex_hull(mesh.convex_hull);
     };
 
     // adds objects' volumes 
     for (const SLAPrintObject* obj : print->objects()) {
         unsigned int initial_volumes_count = (unsigned int)m_volumes.volumes.size();
-        std::shared_ptr<const indexed_triangle_set> m = obj->get_mesh_to_print();
-        if (m && !m->empty()) {
+        const SlaPreviewCache::Object &cached = m_sla_preview_cache.objects[obj->id()];
+        if (cached.meshes[0].convex_hull) {
             for (const SLAPrintObject::Instance& instance : obj->instances()) {
-                add_volume(*obj, 0, instance, *m, GLVolume::MODEL_COLOR[0], true);
+                add_volume(*obj, 0, instance, cached.meshes[0], GLVolume::MODEL_COLOR[0], true);
                 // Set the extruder_id and volume_id to achieve the same color as in the 3D scene when
                 // through the update_volumes_colors_by_extruder() call.
                 m_volumes.volumes.back()->extruder_id = obj->model_object()->volumes.front()->extruder_id();
-                if (auto &tree_mesh = obj->support_mesh().its; !tree_mesh.empty())
-                    add_volume(*obj, -int(slaposSupportTree), instance, tree_mesh, GLVolume::SLA_SUPPORT_COLOR, true);
-                if (auto &pad_mesh = obj->pad_mesh().its; !pad_mesh.empty())
-                    add_volume(*obj, -int(slaposPad), instance, pad_mesh, GLVolume::SLA_PAD_COLOR, false);
+                if (cached.meshes[1].convex_hull)
+                    add_volume(*obj, -int(slaposSupportTree), instance, cached.meshes[1], GLVolume::SLA_SUPPORT_COLOR, true);
+                if (cached.meshes[2].convex_hull)
+                    add_volume(*obj, -int(slaposPad), instance, cached.meshes[2], GLVolume::SLA_PAD_COLOR, false);
             }
         }
         const double shift_z = obj->get_current_elevation();
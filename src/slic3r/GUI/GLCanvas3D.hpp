@@ -366,6 +366,29 @@ class GLCanvas3D
         bool matches(double z) const { return this->z == z; }
     };
 
+    // Geometry of the SLA preview of the SLAPrintObjects, shared by the instances of an object.
+    // The geometry of an object is only rebuilt by _load_sla_shells() if its mesh to print,
+    // its support tree or its pad changed.
+    struct SlaPreviewCache
+    {
+        struct Mesh
+        {
+            // Only the cpu side geometry is initialized, it is copied into the GLVolumes.
+            GLModel                             model;
+            // Null if the mesh is empty.
+            std::shared_ptr<const TriangleMesh> convex_hull;
+        };
+        struct Object
+        {
+            std::shared_ptr<const indexed_triangle_set> mesh_to_print;
+            // Timestamps of slaposSupportTree, slaposPad, slaposSliceSupports.
+            std::array<size_t, 3>                       timestamps{ 0, 0, 0 };
+            // Object mesh, support tree, pad.
+            std::array<Mesh, 3>                         meshes;
+        };
+        std::map<ObjectID, Object> objects;
+    };
+
     enum class EWarning {
         ObjectOutside,
         ToolpathOutside,
@@ -504,6 +527,7 @@ private:
     ClippingPlane m_camera_clipping_plane;
     bool m_use_clipping_planes;
     std::array<SlaCap, 2> m_sla_caps;
+    SlaPreviewCache m_sla_preview_cache;
     std::string m_sidebar_field;
     // when true renders an extra frame by not resetting m_dirty to false
     // see request_extra_frame()
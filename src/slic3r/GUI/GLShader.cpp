@@ -9,10 +9,13 @@
 #include "GLShader.hpp"
 
 #include "3DScene.hpp"
+#include "OpenGLManager.hpp"
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/format.hpp"
 #include "libslic3r/Color.hpp"
 
+#include <boost/container_hash/hash.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <GL/glew.h>
 #include <cassert>
@@ -21,6 +24,98 @@
 
 namespace Slic3r {
 
+// Cache of the linked shader programs in the driver specific binary format stored in the data directory,
+// saving the compilation of all the shaders at each application start, which takes seconds with some drivers.
+// A cached binary is only used if it was produced from the same shader sources by the same OpenGL driver,
+// otherwise the program is compiled and linked from sources and the cached binary is replaced.
+static bool program_binary_cache_supported()
+{
+    if (! GLEW_ARB_get_program_binary || data_dir().empty())
+        return false;
+    GLint num_formats = 0;
+    glsafe(::glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats));
+    return num_formats > 0;
+}
+
+static boost::filesystem::path program_binary_cache_path(const std::string& name)
+{
+    return boost::filesystem::path(data_dir()) / "cache" / "shaders" / (name + ".bin");
+}
+
+static uint64_t program_binary_cache_key(const GLShaderProgram::ShaderSources& sources)
+{
+    const GUI::OpenGLManager::GLInfo& gl_info = GUI::OpenGLManager::get_gl_info();
+    size_t seed = 0;
+    boost::hash_combine(seed, gl_info.get_vendor());
+    boost::hash_combine(seed, gl_info.get_renderer());
+    boost::hash_combine(seed, gl_info.get_version_string());
+    for (const std::string& source : sources)
+        boost::hash_combine(seed, source);
+    return uint64_t(seed);
+}
+
+// Returns id of the shader program loaded from the cache or zero if there is no valid cached binary.
+static GLuint load_program_binary(const std::string& name, uint64_t key)
+{
+    boost::nowide::ifstream s(program_binary_cache_path(name).string(), boost::nowide::ifstream::binary);
+    if (!s.good())
+        return 0;
+
+    uint64_t file_key = 0;
+    uint32_t format   = 0;
+    s.read(reinterpret_cast<char*>(&file_key), sizeof(file_key));
+    s.read(reinterpret_cast<char*>(&format), sizeof(format));
+    if (!s.good() || file_key != key)
+        return 0;
+    std::vector<char> binary((std::istreambuf_iterator<char>(s)), std::istreambuf_iterator<char>());
+    if (binary.empty())
+        return 0;
+
+    GLuint id = ::glCreateProgram();
+    glcheck();
+    if (id == 0)
+        return 0;
+    glsafe(::glProgramBinary(id, GLenum(format), binary.data(), GLsizei(binary.size())));
+    GLint params;
+    glsafe(::glGetProgramiv(id, GL_LINK_STATUS, &params));
+    if (params == GL_FALSE) {
+        // The driver rejected the binary, for example after a driver update which did not change the version string.
+        BOOST_LOG_TRIVIAL(info) << "Cached binary of shader program '" << name << "' rejected by the driver";
+        glsafe(::glDeleteProgram(id));
+        return 0;
+    }
+    return id;
+}
+
+static void save_program_binary(const std::string& name, uint64_t key, GLuint id)
+{
+    GLint length = 0;
+    glsafe(::glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glsafe(::glGetProgramBinary(id, length, &length, &format, binary.data()));
+
+    const boost::filesystem::path path = program_binary_cache_path(name);
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(path.parent_path(), ec);
+    if (ec) {
+        BOOST_LOG_TRIVIAL(warning) << "Unable to create the shader cache directory '" << path.parent_path().string() << "': " << ec.message();
+        return;
+    }
+    boost::nowide::ofstream s(path.string(), boost::nowide::ofstream::binary);
+    const uint32_t format32 = uint32_t(format);
+    s.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    s.write(reinterpret_cast<const char*>(&format32), sizeof(format32));
+    s.write(binary.data(), length);
+    s.close();
+    if (s.fail()) {
+        BOOST_LOG_TRIVIAL(warning) << "Unable to save the binary of shader program '" << name << "' into '" << path.string() << "'";
+        boost::filesystem::remove(path, ec);
+    }
+}
+
 GLShaderProgram::~GLShaderProgram()
 {
     if (m_id > 0)
@@ -125,6 +220,14 @@ bool GLShaderProgram::init_from_texts(const std::string& name, const ShaderSourc
 
     m_name = name;
 
+    const bool     use_binary_cache = program_binary_cache_supported();
+    const uint64_t binary_cache_key = use_binary_cache ? program_binary_cache_key(sources) : 0;
+    if (use_binary_cache) {
+        m_id = load_program_binary(name, binary_cache_key);
+        if (m_id > 0)
+            return true;
+    }
+
     std::array<GLuint, static_cast<size_t>(EShaderType::Count)> shader_ids = { 0 };
 
     for (size_t i = 0; i < static_cast<size_t>(EShaderType::Count); ++i) {
@@ -176,6 +279,8 @@ bool GLShaderProgram::init_from_texts(const std::string& name, const ShaderSourc
             glsafe(::glAttachShader(m_id, shader_ids[i]));
     }
 
+    if (use_binary_cache)
+        glsafe(::glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
     glsafe(::glLinkProgram(m_id));
     GLint params;
     glsafe(::glGetProgramiv(m_id, GL_LINK_STATUS, &params));
@@ -199,6 +304,9 @@ bool GLShaderProgram::init_from_texts(const std::string& name, const ShaderSourc
     // release shaders, they are no more needed
     release_shaders(shader_ids);
 
+    if (use_binary_cache)
+        save_program_binary(name, binary_cache_key, m_id);
+
     return true;
 }
 
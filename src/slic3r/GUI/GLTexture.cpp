@@ -20,8 +20,12 @@
 
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <mutex>
 #include <thread>
 
+#include <tbb/parallel_for.h>
+
 #define STB_DXT_IMPLEMENTATION
 #include "stb_dxt/stb_dxt.h"
 
@@ -107,16 +111,41 @@ void GLTexture::Compressor::compress()
     assert(m_num_levels_compressed == 0);
     assert(m_abort_compressing == false);
 
+    // stb_dxt initializes its lookup tables on the first use of stb_compress_dxt_block(), which is not thread safe.
+    static std::once_flag dxt_initialized;
+    std::call_once(dxt_initialized, []() {
+        unsigned char block[64] = { 0 };
+        unsigned char dst[16];
+        stb_compress_dxt_block(dst, block, 1, STB_DXT_NORMAL);
+    });
+
+    // Generate the source data of the levels, which were not provided by the caller, in parallel.
+    tbb::parallel_for(size_t(0), m_levels.size(), [this](size_t level_idx) {
+        Level &level = m_levels[level_idx];
+        if (level.src_generator && ! m_abort_compressing) {
+            level.src_data.assign(size_t(level.w) * size_t(level.h) * 4, 0);
+            level.src_generator(level.src_data);
+            level.src_generator = nullptr;
+        }
+    });
+
     for (Level& level : m_levels) {
         if (m_abort_compressing)
             break;
 
-        // stb_dxt library, despite claiming that the needed size of the destination buffer is equal to (source buffer size)/4,
-        // crashes if doing so, requiring a minimum of 64 bytes and up to a third of the source buffer size, so we set the destination buffer initial size to be half the source buffer size
-        level.compressed_data = std::vector<unsigned char>(std::max((unsigned int)64, (unsigned int)level.src_data.size() / 2), 0);
-        int compressed_size = 0;
-        rygCompress(level.compressed_data.data(), level.src_data.data(), level.w, level.h, 1, compressed_size);
-        level.compressed_data.resize(compressed_size);
+        // DXT5 compresses each block of 4x4 pixels into 16 bytes. Rows of blocks are compressed independently in parallel.
+        const unsigned int block_row_pixels = 4 * level.w;
+        const unsigned int block_row_bytes  = 16 * ((level.w + 3) / 4);
+        const unsigned int num_block_rows   = (level.h + 3) / 4;
+        level.compressed_data.assign(size_t(block_row_bytes) * num_block_rows, 0);
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, num_block_rows, std::max(1u, 16384u / block_row_pixels)),
+            [&level, block_row_pixels, block_row_bytes](const tbb::blocked_range<unsigned int> &range) {
+                int compressed_size = 0;
+                rygCompress(level.compressed_data.data() + size_t(range.begin()) * block_row_bytes,
+                    level.src_data.data() + size_t(range.begin()) * block_row_pixels * 4,
+                    level.w, std::min(level.h, 4 * range.end()) - 4 * range.begin(), 1, compressed_size);
+                assert(size_t(compressed_size) == size_t(range.size()) * block_row_bytes);
+            });
 
         // we are done with the source data, we can discard it
         level.src_data.clear();
@@ -557,7 +586,8 @@ bool GLTexture::load_from_svg(const std::string& filename, bool use_mipmaps, boo
 {
     const bool compression_enabled = compress && OpenGLManager::are_compressed_textures_supported();
 
-    NSVGimage* image = BitmapCache::nsvgParseFromFileWithReplace(filename.c_str(), "px", 96.0f, {});
+    // Shared with the compressor, which rasterizes the levels in its worker thread.
+    std::shared_ptr<NSVGimage> image(BitmapCache::nsvgParseFromFileWithReplace(filename.c_str(), "px", 96.0f, {}), nsvgDelete);
     if (image == nullptr) {
         reset();
         return false;
@@ -590,20 +620,32 @@ bool GLTexture::load_from_svg(const std::string& filename, bool use_mipmaps, boo
 
     if (n_pixels <= 0) {
         reset();
-        nsvgDelete(image);
         return false;
     }
 
-    NSVGrasterizer* rast = nsvgCreateRasterizer();
-    if (rast == nullptr) {
-        nsvgDelete(image);
-        reset();
-        return false;
-    }
+    // Each call creates its own rasterizer, thus the levels may be rasterized in parallel.
+    auto rasterize = [image](float scale_w, float scale_h, int w, int h, std::vector<unsigned char>& data) {
+        if (NSVGrasterizer* rast = nsvgCreateRasterizer(); rast != nullptr) {
+            nsvgRasterizeXY(rast, image.get(), 0, 0, scale_w, scale_h, data.data(), w, h, w * 4);
+            nsvgDeleteRasterizer(rast);
+        }
+    };
 
     // creates the temporary buffer only once, with max size, and reuse it for all the levels, if generating mipmaps
-    std::vector<unsigned char> data(n_pixels * 4, 0);
-    nsvgRasterizeXY(rast, image, 0, 0, scale_w, scale_h, data.data(), m_width, m_height, m_width * 4);
+    std::vector<unsigned char> data;
+    auto add_level = [this, compression_enabled, &rasterize, &data](GLint level, int w, int h, float scale_w, float scale_h) {
+        if (compression_enabled) {
+            // initializes the texture on GPU 
+            glsafe(::glTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, (GLsizei)w, (GLsizei)h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+            // and let the compressor rasterize and compress the level in its worker thread
+            m_compressor.add_level((unsigned int)w, (unsigned int)h, [rasterize, scale_w, scale_h, w, h](std::vector<unsigned char>& data) { rasterize(scale_w, scale_h, w, h, data); });
+        }
+        else {
+            data.resize(w * h * 4);
+            rasterize(scale_w, scale_h, w, h, data);
+            glsafe(::glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, (GLsizei)w, (GLsizei)h, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)data.data()));
+        }
+    };
 
     // sends data to gpu
     glsafe(::glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
@@ -616,14 +658,7 @@ bool GLTexture::load_from_svg(const std::string& filename, bool use_mipmaps, boo
             glsafe(::glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, max_anisotropy));
     }
 
-    if (compression_enabled) {
-        // initializes the texture on GPU 
-        glsafe(::glTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, (GLsizei)m_width, (GLsizei)m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0));
-        // and send the uncompressed data to the compressor
-        m_compressor.add_level((unsigned int)m_width, (unsigned int)m_height, data);
-    }
-    else
-        glsafe(::glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)m_width, (GLsizei)m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)data.data()));
+    add_level(0, m_width, m_height, scale_w, scale_h);
 
     if (use_mipmaps) {
         // we manually generate mipmaps because glGenerateMipmap() function is not reliable on all graphics cards
@@ -638,17 +673,7 @@ bool GLTexture::load_from_svg(const std::string& filename, bool use_mipmaps, boo
             scale_w /= 2.0f;
             scale_h /= 2.0f;
 
-            data.resize(lod_w * lod_h * 4);
-
-            nsvgRasterizeXY(rast, image, 0, 0, scale_w, scale_h, data.data(), lod_w, lod_h, lod_w * 4);
-            if (compression_enabled) {
-                // initializes the texture on GPU 
-                glsafe(::glTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, (GLsizei)lod_w, (GLsizei)lod_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0));
-                // and send the uncompressed data to the compressor
-                m_compressor.add_level((unsigned int)lod_w, (unsigned int)lod_h, data);
-            }
-            else
-                glsafe(::glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, (GLsizei)lod_w, (GLsizei)lod_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)data.data()));
+            add_level(level, lod_w, lod_h, scale_w, scale_h);
         }
 
         if (!compression_enabled) {
@@ -668,12 +693,9 @@ bool GLTexture::load_from_svg(const std::string& filename, bool use_mipmaps, boo
     m_source = filename;
 
     if (compression_enabled)
-        // start asynchronous compression
+        // start asynchronous rasterization and compression
         m_compressor.start_compressing();
 
-    nsvgDeleteRasterizer(rast);
-    nsvgDelete(image);
-
     return true;
 }
 
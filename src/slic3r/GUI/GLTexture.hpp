@@ -6,6 +6,7 @@
 #define slic3r_GLTexture_hpp_
 
 #include <atomic>
+#include <functional>
 #include <string>
 #include <vector>
 #include <thread>
@@ -23,11 +24,15 @@ namespace GUI {
             {
                 unsigned int w;
                 unsigned int h;
+                // Fills src_data of w * h RGBA pixels in the worker thread, if the source data was not provided by the caller.
+                std::function<void(std::vector<unsigned char>&)> src_generator;
                 std::vector<unsigned char> src_data;
                 std::vector<unsigned char> compressed_data;
                 bool sent_to_gpu;
 
                 Level(unsigned int w, unsigned int h, const std::vector<unsigned char>& data) : w(w), h(h), src_data(data), sent_to_gpu(false) {}
+                Level(unsigned int w, unsigned int h, std::function<void(std::vector<unsigned char>&)> src_generator) :
+                    w(w), h(h), src_generator(std::move(src_generator)), sent_to_gpu(false) {}
             };
 
             GLTexture& m_texture;
@@ -47,6 +52,8 @@ namespace GUI {
             void reset();
 
             void add_level(unsigned int w, unsigned int h, const std::vector<unsigned char>& data) { m_levels.emplace_back(w, h, data); }
+            // The source data will be generated by src_generator in the worker thread, for example by rasterizing an SVG image.
+            void add_level(unsigned int w, unsigned int h, std::function<void(std::vector<unsigned char>&)> src_generator) { m_levels.emplace_back(w, h, std::move(src_generator)); }
 
             void start_compressing();
 
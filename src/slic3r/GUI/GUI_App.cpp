@@ -1109,6 +1109,10 @@ bool GUI_App::on_init_inner()
     // Set initialization of image handlers before any UI actions - See GH issue #7469
     wxInitAllImageHandlers();
 
+    // Bound the CPU footprint of the background processing before any parallel work starts.
+    if (int max_threads = atoi(app_config->get("max_threads").c_str()); max_threads > 0)
+        set_max_threads(size_t(max_threads));
+
 #if defined(_WIN32) && ! defined(_WIN64)
     // Win32 32bit build.
     if (wxPlatformInfo::Get().GetArchName().substr(0, 2) == "64") {
@@ -1352,7 +1356,7 @@ bool GUI_App::on_init_inner()
 
     plater_->init_notification_manager();
 
-    m_printhost_job_queue.reset(new PrintHostJobQueue(mainframe->printhost_queue_dlg()));
+    m_printhost_job_queue.reset(new PrintHostJobQueue(mainframe->printhost_queue_dlg(), std::max(1, atoi(app_config->get("printhost_max_concurrent_uploads").c_str()))));
 
     if (is_gcode_viewer()) {
         mainframe->update_layout();
@@ -1901,7 +1905,7 @@ void GUI_App::recreate_GUI(const wxString& msg_name)
     old_main_frame->Destroy();
 
     dlg.Update(80, _L("Loading of current presets") + dots);
-    m_printhost_job_queue.reset(new PrintHostJobQueue(mainframe->printhost_queue_dlg()));
+    m_printhost_job_queue.reset(new PrintHostJobQueue(mainframe->printhost_queue_dlg(), std::max(1, atoi(app_config->get("printhost_max_concurrent_uploads").c_str()))));
     load_current_presets();
     mainframe->Show(true);
 
@@ -3039,11 +3039,37 @@ void ObjectList::add_object_to_list(size_t obj_idx, bool call_selection_changed)
     add_layer_root_item(item);
 
 #ifndef __WXOSX__ 
-    if (call_selection_changed)
-	    selection_changed();
+    if (call_selection_changed) {
+        if (m_batch_update_level > 0)
+            m_batch_selection_changed = true;
+        else
+	        selection_changed();
+    }
 #endif //__WXMSW__
 }
 
+ObjectList::BatchUpdate::BatchUpdate(ObjectList &list) : m_list(list)
+{
+    if (m_list.m_batch_update_level ++ == 0) {
+        m_list.Freeze();
+        m_list.m_batch_prevent_list_events = m_list.m_prevent_list_events;
+        m_list.m_prevent_list_events       = true;
+        m_list.m_batch_selection_changed   = false;
+    }
+}
+
+ObjectList::BatchUpdate::~BatchUpdate()
+{
+    if (-- m_list.m_batch_update_level == 0) {
+        m_list.m_prevent_list_events = m_list.m_batch_prevent_list_events;
+        m_list.Thaw();
+        if (m_list.m_batch_selection_changed) {
+            m_list.m_batch_selection_changed = false;
+            m_list.selection_changed();
+        }
+    }
+}
+
 void ObjectList::delete_object_from_list()
 {
     auto item = GetSelection();
@@ -4866,6 +4892,7 @@ void ObjectList::update_after_undo_redo()
      * from wxEVT_DATAVIEW_SELECTION_CHANGED emitted from DeleteAll(), 
      * wrap this two functions into m_prevent_list_events *
      * */
+    BatchUpdate batch(*this);
     m_prevent_list_events = true;
     this->UnselectAll();
     m_objects_model->DeleteAll();
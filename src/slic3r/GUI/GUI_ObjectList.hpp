@@ -188,6 +188,11 @@ private:
 
     size_t    m_items_count { size_t(-1) };
 
+    // Nesting level of BatchUpdate, see below.
+    int       m_batch_update_level { 0 };
+    bool      m_batch_prevent_list_events { false };
+    bool      m_batch_selection_changed { false };
+
     inline void ensure_current_item_visible()
     {
         if (const auto &item = this->GetCurrentItem())
@@ -302,6 +307,18 @@ public:
     wxDataViewItemArray add_volumes_to_object_in_list(size_t obj_idx, std::function<bool(const ModelVolume*)> add_to_selection = nullptr);
     // Add object to the list
     void add_object_to_list(size_t obj_idx, bool call_selection_changed = true);
+
+    // Batch of changes of the list, for example when loading a project with hundreds of objects.
+    // The control is frozen and the list events are suppressed until the outermost batch ends,
+    // selection_changed() requested by add_object_to_list() is called just once at its end.
+    class BatchUpdate
+    {
+    public:
+        BatchUpdate(ObjectList &list);
+        ~BatchUpdate();
+    private:
+        ObjectList &m_list;
+    };
     // Delete object from the list
     void delete_object_from_list();
     void delete_object_from_list(const size_t obj_idx);
@@ -328,6 +328,27 @@ void Preview::reload_print(bool keep_volumes)
     load_print();
 }
 
+void Preview::load_partial_gcode_preview(const GCodeProcessorResult &partial_result)
+{
+    if (!IsShown() || m_process->current_printer_technology() != ptFFF || partial_result.moves.empty())
+        return;
+
+    const std::vector<std::string> colors = (m_canvas->get_gcode_view_preview_type() == GCodeViewer::EViewType::ColorPrint) ?
+        wxGetApp().plater()->get_colors_for_color_print(&partial_result) :
+        wxGetApp().plater()->get_extruder_colors_from_plater_config(&partial_result);
+    m_canvas->set_selected_extruder(0);
+    m_canvas->load_gcode_preview(partial_result, colors);
+    m_left_sizer->Layout();
+    Refresh();
+    // Show all the layers exported so far, the preview fills in bottom-up.
+    const std::vector<double> zs = m_canvas->get_gcode_layers_zs();
+    if (zs.empty())
+        return;
+    m_left_sizer->Show(m_bottom_toolbar_panel);
+    update_layers_slider(zs, false);
+    // Not marked as m_loaded: The complete G-code preview replaces the snapshot once the export finishes.
+}
+
 void Preview::refresh_print()
 {
     m_loaded = false;
@@ -139,6 +139,8 @@ public:
     void load_gcode_shells();
     void load_print(bool keep_z_range = false);
     void reload_print(bool keep_volumes = false);
+    // Show the G-code exported so far while the G-code export is still running.
+    void load_partial_gcode_preview(const GCodeProcessorResult &partial_result);
     void refresh_print();
 
     void msw_rescale();
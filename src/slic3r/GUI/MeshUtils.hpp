@@ -228,6 +228,8 @@ public:
 
     Vec3f get_triangle_normal(size_t facet_idx) const;
 
+    BoundingBoxf3 get_bounding_box() const { return m_mesh->bounding_box(); }
+
 private:
     std::shared_ptr<const TriangleMesh> m_mesh;
     AABBMesh m_emesh;
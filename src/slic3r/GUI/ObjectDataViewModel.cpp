@@ -568,18 +568,15 @@ wxDataViewItem ObjectDataViewModel::AddInstanceChild(const wxDataViewItem& paren
 
     // Add instance nodes
     ObjectDataViewModelNode *instance_node = nullptr;    
-    size_t counter = 0;
-    while (counter < print_indicator.size()) {
+    wxDataViewItemArray      instance_items;
+    for (bool printable : print_indicator) {
         instance_node = new ObjectDataViewModelNode(inst_root_node, itInstance);
-
-        instance_node->set_printable_icon(print_indicator[counter] ? piPrintable : piUnprintable);
-
+        instance_node->set_printable_icon(printable ? piPrintable : piUnprintable);
         inst_root_node->Append(instance_node);
-        // notify control
-        const wxDataViewItem instance_item((void*)instance_node);
-        ItemAdded(inst_root_item, instance_item);
-        ++counter;
+        instance_items.Add(wxDataViewItem((void*)instance_node));
     }
+    // notify control once for all the new instances
+    ItemsAdded(inst_root_item, instance_items);
 
     // update object_node printable property
     UpdateObjectPrintable(parent_item);
@@ -863,8 +860,10 @@ wxDataViewItem ObjectDataViewModel::DeleteLastInstance(const wxDataViewItem &par
         if (i==0) last_inst_printable = last_instance_node->IsPrintable();
         inst_root_node->GetChildren().Remove(last_instance_node);
         delete last_instance_node;
-        ItemDeleted(inst_root_item, wxDataViewItem(last_instance_node));
+        items.Add(wxDataViewItem(last_instance_node));
     }
+    // notify control once for all the deleted instances
+    ItemsDeleted(inst_root_item, items);
 
     if (delete_inst_root_item) {
         ret_item = parent_item;
@@ -883,12 +882,15 @@ wxDataViewItem ObjectDataViewModel::DeleteLastInstance(const wxDataViewItem &par
 
 void ObjectDataViewModel::DeleteAll()
 {
-	while (!m_objects.empty())
-	{
-		auto object = m_objects.back();
-// 		object->RemoveAllChildren();
-		Delete(wxDataViewItem(object));	
-	}
+    if (m_objects.empty())
+        return;
+    // The nodes free their children. Deleting the objects one by one would notify the control
+    // for each of their sub-items, which is very slow for projects with hundreds of objects.
+    for (ObjectDataViewModelNode *object : m_objects)
+        delete object;
+    m_objects.clear();
+    // notify control
+    Cleared();
 }
 
 void ObjectDataViewModel::DeleteChildren(wxDataViewItem& parent)
@@ -27,6 +27,7 @@
 #include <string>
 #include <regex>
 #include <future>
+#include <atomic>
 #include <boost/algorithm/string.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/optional.hpp>
@@ -36,6 +37,8 @@
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/convert.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include <wx/sizer.h>
 #include <wx/stattext.h>
 #include <wx/button.h>
@@ -165,6 +168,8 @@ wxDEFINE_EVENT(EVT_SLICING_COMPLETED,               wxCommandEvent);
 // BackgroundSlicingProcess finished either with success or error.
 wxDEFINE_EVENT(EVT_PROCESS_COMPLETED,               SlicingProcessCompletedEvent);
 wxDEFINE_EVENT(EVT_EXPORT_BEGAN,                    wxCommandEvent);
+// A snapshot of the G-code exported so far is ready to be displayed by the G-code preview.
+wxDEFINE_EVENT(EVT_GCODE_PREVIEW_PARTIAL,           wxCommandEvent);
 
 
 bool Plater::has_illegal_filename_characters(const wxString& wxs_name)
@@ -1922,6 +1927,9 @@ struct Plater::priv
     void process_validation_warning(const std::vector<std::string>& warning) const;
 
     bool background_processing_enabled() const { return this->get_config_bool("background_processing"); }
+    // With the background processing disabled, recalculate the object steps invalidated by an edit anyway,
+    // so that only the print steps remain to be calculated once slicing is requested.
+    bool speculative_slicing_enabled() const { return ! this->background_processing_enabled() && this->get_config_bool("speculative_slicing"); }
     void update_print_volume_state();
     void schedule_background_process();
     // Update background processing thread from the current config and Model.
@@ -1939,6 +1947,9 @@ struct Plater::priv
         UPDATE_BACKGROUND_PROCESS_FORCE_RESTART = 8,
         // Restart for G-code (or SLA zip) export or upload.
         UPDATE_BACKGROUND_PROCESS_FORCE_EXPORT = 16,
+        // update_background_process() reports, that the background process was invalidated, the background
+        // processing is disabled, but the object steps are to be recalculated by speculative slicing.
+        UPDATE_BACKGROUND_PROCESS_SPECULATIVE = 32,
     };
     // returns bit mask of UpdateBackgroundProcessReturnState
     unsigned int update_background_process(bool force_validation = false, bool postpone_error_messages = false);
@@ -1965,6 +1976,7 @@ struct Plater::priv
     void on_slicing_completed(wxCommandEvent&);
     void on_process_completed(SlicingProcessCompletedEvent&);
 	void on_export_began(wxCommandEvent&);
+    void on_gcode_preview_partial(wxCommandEvent&);
     void on_layer_editing_toggled(bool enable);
 	void on_slicing_began();
 
@@ -2061,6 +2073,8 @@ private:
 	// vector of all warnings generated by last slicing
 	std::vector<std::pair<Slic3r::PrintStateBase::Warning, size_t>> current_warnings;
 	bool show_warning_dialog { false };
+    // The running background process was started by speculative slicing and it calculates the object steps only.
+    bool speculative_slicing_running { false };
 	
 };
 
@@ -2101,6 +2115,7 @@ Plater::priv::priv(Plater *q, MainFrame *main_frame)
     background_process.set_slicing_completed_event(EVT_SLICING_COMPLETED);
     background_process.set_finished_event(EVT_PROCESS_COMPLETED);
 	background_process.set_export_began_event(EVT_EXPORT_BEGAN);
+    background_process.set_gcode_preview_event(EVT_GCODE_PREVIEW_PARTIAL);
     // Default printer technology for default config.
     background_process.select_technology(this->printer_technology);
     // Register progress callback from the Print class to the Plater.
@@ -2224,6 +2239,7 @@ Plater::priv::priv(Plater *q, MainFrame *main_frame)
         q->Bind(EVT_SLICING_COMPLETED, &priv::on_slicing_completed, this);
         q->Bind(EVT_PROCESS_COMPLETED, &priv::on_process_completed, this);
         q->Bind(EVT_EXPORT_BEGAN, &priv::on_export_began, this);
+        q->Bind(EVT_GCODE_PREVIEW_PARTIAL, &priv::on_gcode_preview_partial, this);
         q->Bind(EVT_GLVIEWTOOLBAR_3D, [q](SimpleEvent&) { q->select_view_3D("3D"); });
         q->Bind(EVT_GLVIEWTOOLBAR_PREVIEW, [q](SimpleEvent&) { q->select_view_3D("Preview"); });
     }
@@ -2492,6 +2508,64 @@ void Plater::check_selected_presets_visibility(PrinterTechnology loaded_printer_
     }
 }
 
+// Mesh of an STL file read, repaired and with its convex hull calculated by preload_stl_meshes().
+// An empty mesh means that the file could not be loaded.
+struct PreloadedMesh
+{
+    TriangleMesh mesh;
+    TriangleMesh convex_hull;
+    std::string  error;
+};
+
+// Read the STL files, repair them and calculate their convex hulls in parallel on a background thread,
+// so that loading of many large STLs neither blocks the UI thread nor runs serially. Only the meshes
+// are loaded in the background, the Model is assembled from them on the UI thread, as the ObjectID
+// counter is not thread safe. The UI thread keeps updating the progress dialog in the meantime,
+// the files not started yet are skipped if the user cancels the dialog.
+// Returns false if canceled. The output vector is indexed by input files, not STL files are left empty.
+static bool preload_stl_meshes(const std::vector<fs::path> &input_files, wxProgressDialog *progress_dlg, std::vector<std::unique_ptr<PreloadedMesh>> &out)
+{
+    out.clear();
+    out.resize(input_files.size());
+    std::vector<size_t> stl_files;
+    for (size_t i = 0; i < input_files.size(); ++ i)
+        if (boost::algorithm::iends_with(input_files[i].string(), ".stl"))
+            stl_files.emplace_back(i);
+    if (stl_files.empty())
+        return true;
+
+    std::atomic<bool>   canceled { false };
+    std::atomic<size_t> num_loaded { 0 };
+    auto future = std::async(std::launch::async, [&input_files, &stl_files, &out, &canceled, &num_loaded]() {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, stl_files.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end() && ! canceled; ++ i) {
+                const size_t idx    = stl_files[i];
+                auto         loaded = std::make_unique<PreloadedMesh>();
+                try {
+                    if (loaded->mesh.ReadSTLFile(input_files[idx].string().c_str()) && loaded->mesh.facets_count() > 1)
+                        loaded->convex_hull = loaded->mesh.convex_hull_3d();
+                } catch (const std::exception &ex) {
+                    loaded->mesh  = TriangleMesh();
+                    loaded->error = ex.what();
+                }
+                out[idx] = std::move(loaded);
+                ++ num_loaded;
+            }
+        });
+    });
+
+    while (future.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+        if (progress_dlg != nullptr && ! canceled &&
+            ! progress_dlg->Update(static_cast<int>(100.f * static_cast<float>(num_loaded) / static_cast<float>(input_files.size())),
+                                   _L("Loading file") + ": " + format_wxstr("%1% / %2%", num_loaded.load(), stl_files.size())))
+            canceled = true;
+    future.get();
+
+    if (canceled)
+        BOOST_LOG_TRIVIAL(info) << "Loading of " << stl_files.size() - num_loaded << " STL files was canceled";
+    return ! canceled;
+}
+
 std::vector<size_t> Plater::priv::load_files(const std::vector<fs::path>& input_files, bool load_model, bool load_config, bool imperial_units/* = false*/)
 {
      if (input_files.empty()) { return std::vector<size_t>(); }
@@ -2519,10 +2593,10 @@ std::vector<size_t> Plater::priv::load_files(const std::vector<fs::path>& input_
     // appear at all. Therefore, we create the dialog on stack on Win and macOS, and on heap on Linux, which
     // is the only system that needed the workarounds in the first place.
 #ifdef __linux__
-    auto progress_dlg = new wxProgressDialog(loading, "", 100, find_toplevel_parent(q), wxPD_APP_MODAL | wxPD_AUTO_HIDE);
+    auto progress_dlg = new wxProgressDialog(loading, "", 100, find_toplevel_parent(q), wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT);
     Slic3r::ScopeGuard([&progress_dlg](){ if (progress_dlg) progress_dlg->Destroy(); progress_dlg = nullptr; });
 #else
-    wxProgressDialog progress_dlg_stack(loading, "", 100, find_toplevel_parent(q), wxPD_APP_MODAL | wxPD_AUTO_HIDE);
+    wxProgressDialog progress_dlg_stack(loading, "", 100, find_toplevel_parent(q), wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT);
     wxProgressDialog* progress_dlg = &progress_dlg_stack;    
 #endif
     
@@ -2539,6 +2613,10 @@ std::vector<size_t> Plater::priv::load_files(const std::vector<fs::path>& input_
     bool in_temp = false; 
     const fs::path temp_path = wxStandardPaths::Get().GetTempDir().utf8_str().data();
 
+    std::vector<std::unique_ptr<PreloadedMesh>> preloaded_meshes;
+    if (load_model && ! preload_stl_meshes(input_files, progress_dlg, preloaded_meshes))
+        return obj_idxs;
+
     size_t input_files_size = input_files.size();
     for (size_t i = 0; i < input_files_size; ++i) {
 #ifdef _WIN32
@@ -2552,7 +2630,9 @@ std::vector<size_t> Plater::priv::load_files(const std::vector<fs::path>& input_
         in_temp = (path.parent_path() == temp_path);
         const auto filename = path.filename();
         if (progress_dlg) {
-            progress_dlg->Update(static_cast<int>(100.0f * static_cast<float>(i) / static_cast<float>(input_files.size())), _L("Loading file") + ": " + from_path(filename));
+            if (! progress_dlg->Update(static_cast<int>(100.0f * static_cast<float>(i) / static_cast<float>(input_files.size())), _L("Loading file") + ": " + from_path(filename)))
+                // Canceled by the user, don't load the remaining files.
+                break;
             progress_dlg->Fit();
         }
 
@@ -2648,6 +2728,17 @@ std::vector<size_t> Plater::priv::load_files(const std::vector<fs::path>& input_
                         wxGetApp().app_config->update_config_dir(path.parent_path().string());
                 }
             }
+            else if (i < preloaded_meshes.size() && preloaded_meshes[i]) {
+                // The STL file has already been read and repaired by preload_stl_meshes().
+                std::unique_ptr<PreloadedMesh> preloaded = std::move(preloaded_meshes[i]);
+                if (preloaded->mesh.empty())
+                    throw Slic3r::RuntimeError(preloaded->error.empty() ? "Loading of a model file failed." : preloaded->error);
+                const std::string name = filename.string();
+                if (preloaded->convex_hull.empty())
+                    model.add_object(name.c_str(), path.string().c_str(), std::move(preloaded->mesh));
+                else
+                    model.add_object(name.c_str(), path.string().c_str(), std::move(preloaded->mesh), std::move(preloaded->convex_hull));
+            }
             else {
                 model = Slic3r::Model::read_from_file(path.string(), nullptr, nullptr, only_if(load_config, Model::LoadAttribute::CheckVersion));
                 for (auto obj : model.objects)
@@ -2916,8 +3007,10 @@ std::vector<size_t> Plater::priv::load_model_objects(const ModelObjectPtrs& mode
     }
 
     notification_manager->close_notification_of_type(NotificationType::UpdatedItemsInfo);
-    for (const size_t idx : obj_idxs) {
-        wxGetApp().obj_list()->add_object_to_list(idx, call_selection_changed);
+    {
+        ObjectList::BatchUpdate batch(*wxGetApp().obj_list());
+        for (const size_t idx : obj_idxs)
+            wxGetApp().obj_list()->add_object_to_list(idx, call_selection_changed);
     }
 
     if (call_selection_changed) {
@@ -3381,6 +3474,8 @@ unsigned int Plater::priv::update_background_process(bool force_validation, bool
             notification_manager->close_notification_of_type(NotificationType::ValidateError);
             if (invalidated != Print::APPLY_STATUS_UNCHANGED && background_processing_enabled())
                 return_state |= UPDATE_BACKGROUND_PROCESS_RESTART;
+            else if (invalidated != Print::APPLY_STATUS_UNCHANGED && speculative_slicing_enabled())
+                return_state |= UPDATE_BACKGROUND_PROCESS_SPECULATIVE;
 
             // Pass a warning from validation and either show a notification,
             // or hide the old one.
@@ -3441,7 +3536,7 @@ unsigned int Plater::priv::update_background_process(bool force_validation, bool
 	} 
 
     if (invalidated != Print::APPLY_STATUS_UNCHANGED && was_running && ! this->background_process.running() &&
-        (return_state & UPDATE_BACKGROUND_PROCESS_RESTART) == 0) {
+        (return_state & (UPDATE_BACKGROUND_PROCESS_RESTART | UPDATE_BACKGROUND_PROCESS_SPECULATIVE)) == 0) {
         // The background processing was killed and it will not be restarted.
         // Post the "canceled" callback message, so that it will be processed after any possible pending status bar update messages.
         wxQueueEvent(GUI::wxGetApp().mainframe->m_plater, new SlicingProcessCompletedEvent(EVT_PROCESS_COMPLETED, 0, SlicingProcessCompletedEvent::Cancelled, std::exception_ptr{}));
@@ -3499,6 +3594,8 @@ bool Plater::priv::restart_background_process(unsigned int state)
          ( ((state & UPDATE_BACKGROUND_PROCESS_FORCE_RESTART) != 0 && ! this->background_process.finished()) ||
            (state & UPDATE_BACKGROUND_PROCESS_FORCE_EXPORT) != 0 ||
            (state & UPDATE_BACKGROUND_PROCESS_RESTART) != 0 ) ) {
+        // The task was extended to the whole print by the caller, a speculative slicing still running continues with it.
+        speculative_slicing_running = false;
         // The print is valid and it can be started.
         if (this->background_process.start()) {
 //            this->statusbar()->set_cancel_callback([this]() {
@@ -3509,6 +3606,18 @@ bool Plater::priv::restart_background_process(unsigned int state)
 				on_slicing_began();
             return true;
         }
+    } else if ( ! this->background_process.empty() &&
+                (state & priv::UPDATE_BACKGROUND_PROCESS_INVALID) == 0 &&
+                (state & UPDATE_BACKGROUND_PROCESS_SPECULATIVE) != 0 &&
+                ! this->background_process.running()) {
+        // Recalculate just the object steps, the objects not touched by the edit are skipped as their steps are still valid.
+        PrintBase::TaskParams task;
+        task.to_object_step = this->printer_technology == ptFFF ? int(posCount) - 1 : int(slaposCount) - 1;
+        this->background_process.set_task(task);
+        if (this->background_process.start()) {
+            speculative_slicing_running = true;
+            return true;
+        }
     }
     return false;
 }
@@ -4282,6 +4391,14 @@ void Plater::priv::on_export_began(wxCommandEvent& evt)
 	if (show_warning_dialog)
 		warnings_dialog();  
 }
+void Plater::priv::on_gcode_preview_partial(wxCommandEvent&)
+{
+    std::unique_ptr<GCodeProcessorResult> partial_result = background_process.take_partial_gcode_result();
+    // Ignore a snapshot of a G-code export, which was canceled or which finished in the meantime.
+    if (partial_result && this->printer_technology == ptFFF && this->background_process.running() &&
+        ! this->fff_print.is_step_done(psGCodeExport) && ! view3D->is_dragging())
+        this->preview->load_partial_gcode_preview(*partial_result);
+}
 void Plater::priv::on_slicing_began()
 {
 	clear_warnings();
@@ -4396,7 +4513,12 @@ void Plater::priv::on_process_completed(SlicingProcessCompletedEvent &evt)
         this->notification_manager->set_slicing_progress_canceled(_u8L("Slicing Cancelled."));
     }
 
-    this->sidebar->show_sliced_info_sizer(evt.success());
+    // Speculative slicing only recalculated the object steps, there is no G-code to be shown or exported yet.
+    const bool speculative = std::exchange(this->speculative_slicing_running, false);
+    if (speculative)
+        notification_manager->set_slicing_progress_hidden();
+
+    this->sidebar->show_sliced_info_sizer(evt.success() && ! speculative);
 
     // This updates the "Slice now", "Export G-code", "Arrange" buttons status.
     // Namely, it refreshes the "Out of print bed" property of all the ModelObjects, and it enables
@@ -4413,7 +4535,7 @@ void Plater::priv::on_process_completed(SlicingProcessCompletedEvent &evt)
             this->update_sla_scene();
     }
 	
-    if (evt.cancelled()) {
+    if (evt.cancelled() || speculative) {
         if (wxGetApp().get_mode() == comSimple)
             sidebar->set_btn_label(ActionButtonType::abReslice, "Slice now");
         show_action_buttons(true);
@@ -6783,8 +6905,7 @@ void Plater::export_stl_obj(bool extended, bool selection_only)
             mesh = TriangleMesh{csg::csgmesh_merge_positive_parts(csgrange)};
         } else if (csg::check_csgmesh_booleans(csgrange) == csgrange.end()) {
             try {
-                auto cgalm = csg::perform_csgmesh_booleans(csgrange);
-                mesh = MeshBoolean::cgal::cgal_to_triangle_mesh(*cgalm);
+                mesh = TriangleMesh{csg::perform_csgmesh_booleans(csgrange, csg::BooleanBackend::Fast)};
             } catch (...) {}
         }
 
@@ -7068,13 +7189,14 @@ bool Plater::export_3mf(const boost::filesystem::path& output_path)
     const std::string path_u8 = into_u8(path);
     wxBusyCursor wait;
     bool full_pathnames = wxGetApp().app_config->get_bool("export_sources_full_pathnames");
+    bool binary_meshes = wxGetApp().app_config->get_bool("export_binary_meshes_3mf");
     ThumbnailData thumbnail_data;
     ThumbnailsParams thumbnail_params = { {}, false, true, true, true };
     p->generate_thumbnail(thumbnail_data, THUMBNAIL_SIZE_3MF.first, THUMBNAIL_SIZE_3MF.second, thumbnail_params, Camera::EType::Ortho);
     bool ret = false;
     try
     {
-        ret = Slic3r::store_3mf(path_u8.c_str(), &p->model, export_config ? &cfg : nullptr, full_pathnames, &thumbnail_data);
+        ret = Slic3r::store_3mf(path_u8.c_str(), &p->model, export_config ? &cfg : nullptr, full_pathnames, &thumbnail_data, true, false, binary_meshes);
     }
     catch (boost::filesystem::filesystem_error& e)
     {
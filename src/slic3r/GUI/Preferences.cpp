@@ -289,6 +289,12 @@ void PreferencesDialog::build()
 				"as they\'re loaded in order to save time when exporting G-code."),
 			app_config->get_bool("background_processing"));
 
+		append_bool_option(m_optgroup_general, "speculative_slicing", 
+			L("Speculative slicing"),
+			L("If this is enabled and the background processing is disabled, the objects invalidated by an edit "
+				"are sliced again in the background, so that only the G-code has to be generated once slicing is requested."),
+			app_config->get_bool("speculative_slicing"));
+
 		append_bool_option(m_optgroup_general, "alert_when_supports_needed", 
 			L("Alert when supports needed"),
 			L("If this is enabled, Slic3r will raise alerts when it detects "
@@ -305,6 +311,12 @@ void PreferencesDialog::build()
 			L("If enabled, allows the Reload from disk command to automatically find and load the files when invoked."),
 			app_config->get_bool("export_sources_full_pathnames"));
 
+		append_bool_option(m_optgroup_general, "export_binary_meshes_3mf",
+			L("Store binary meshes to 3mf"),
+			L("If enabled, a binary copy of each mesh is stored into the 3mf project next to the standard XML mesh. "
+			  "PrusaSlicer loads such projects faster, other applications read the XML mesh. The file becomes larger."),
+			app_config->get_bool("export_binary_meshes_3mf"));
+
 #ifdef _WIN32
 		// Please keep in sync with ConfigWizard
 		append_bool_option(m_optgroup_general, "associate_3mf",
@@ -512,6 +524,14 @@ void PreferencesDialog::build()
 		  "If disabled, changes made using the sequential slider, in preview, apply to the whole gcode."),
 		app_config->get_bool("seq_top_layer_only"));
 
+	append_bool_option(m_optgroup_gui, "compact_toolpaths",
+		L("Compact toolpaths in preview"),
+		L("If enabled, the normals of the extrusions in preview are stored in a packed format, "
+		  "which reduces the graphics memory used by the toolpaths by one third. "
+		  "Useful on computers with integrated graphics and with large G-codes. "
+		  "The change is applied the next time the G-code is loaded into the preview."),
+		app_config->get_bool("compact_toolpaths"));
+
 	if (is_editor) {
 		append_bool_option(m_optgroup_gui, "show_collapse_button",
 			L("Show sidebar collapse/expand button"),
@@ -13,6 +13,13 @@
 namespace Slic3r {
 namespace GUI {
 
+const BoundingBoxf3& SceneRaycasterItem::get_world_bounding_box() const
+{
+    if (!m_world_bounding_box.has_value())
+        m_world_bounding_box = m_raycaster->get_bounding_box().transformed(m_trafo);
+    return *m_world_bounding_box;
+}
+
 SceneRaycaster::SceneRaycaster() {
 #if ENABLE_RAYCAST_PICKING_DEBUG
     // hit point
@@ -40,6 +47,8 @@ SceneRaycaster::SceneRaycaster() {
 std::shared_ptr<SceneRaycasterItem> SceneRaycaster::add_raycaster(EType type, int id, const MeshRaycaster& raycaster,
     const Transform3d& trafo, bool use_back_faces)
 {
+    if (type != EType::None)
+        get_tree(type).dirty = true;
     switch (type) {
     case EType::Bed:    { return m_bed.emplace_back(std::make_shared<SceneRaycasterItem>(encode_id(type, id), raycaster, trafo, use_back_faces)); }
     case EType::Volume: { return m_volumes.emplace_back(std::make_shared<SceneRaycasterItem>(encode_id(type, id), raycaster, trafo, use_back_faces)); }
@@ -63,6 +72,8 @@ void SceneRaycaster::remove_raycasters(EType type, int id)
 
 void SceneRaycaster::remove_raycasters(EType type)
 {
+    if (type != EType::None)
+        get_tree(type).dirty = true;
     switch (type) {
     case EType::Bed:    { m_bed.clear(); break; }
     case EType::Volume: { m_volumes.clear(); break; }
@@ -74,6 +85,8 @@ void SceneRaycaster::remove_raycasters(EType type)
 
 void SceneRaycaster::remove_raycaster(std::shared_ptr<SceneRaycasterItem> item)
 {
+    for (RaycastersTree& tree : m_trees)
+        tree.dirty = true;
     for (auto it = m_bed.begin(); it != m_bed.end(); ++it) {
         if (*it == item) {
             m_bed.erase(it);
@@ -155,12 +168,18 @@ SceneRaycaster::HitResult SceneRaycaster::hit(const Vec2d& mouse_pos, const Came
 
     HitResult ret;
 
-    auto test_raycasters = [this, is_closest, clipping_plane, &volume_keeper](EType type, const Vec2d& mouse_pos, const Camera& camera, HitResult& ret) {
+    // Same line as used by MeshRaycaster::closest_hit(), in world coordinates.
+    Vec3d line_point;
+    Vec3d line_direction;
+    MeshRaycaster::line_from_mouse_pos(mouse_pos, Transform3d::Identity(), camera, line_point, line_direction);
+
+    auto test_raycasters = [this, is_closest, clipping_plane, &volume_keeper, &line_point, &line_direction](EType type, const Vec2d& mouse_pos, const Camera& camera, HitResult& ret) {
         const ClippingPlane* clip_plane = (clipping_plane != nullptr && type == EType::Volume) ? clipping_plane : nullptr;
         const std::vector<std::shared_ptr<SceneRaycasterItem>>* raycasters = get_raycasters(type);
         const Vec3f camera_forward = camera.get_dir_forward().cast<float>();
         HitResult current_hit = { type };
-        for (std::shared_ptr<SceneRaycasterItem> item : *raycasters) {
+        for (size_t idx : raycasters_on_line(type, line_point, line_direction)) {
+            const std::shared_ptr<SceneRaycasterItem>& item = (*raycasters)[idx];
             if (!item->is_active())
                 continue;
 
@@ -268,6 +287,9 @@ size_t SceneRaycaster::active_fallback_gizmos_count() const {
 
 std::vector<std::shared_ptr<SceneRaycasterItem>>* SceneRaycaster::get_raycasters(EType type)
 {
+    // The caller may modify the raycasters.
+    if (type != EType::None)
+        get_tree(type).dirty = true;
     std::vector<std::shared_ptr<SceneRaycasterItem>>* ret = nullptr;
     switch (type)
     {
@@ -311,6 +333,68 @@ int SceneRaycaster::base_id(EType type)
     return -1;
 }
 
+SceneRaycaster::RaycastersTree& SceneRaycaster::get_tree(EType type) const
+{
+    assert(type != EType::None);
+    return m_trees[size_t(type) - size_t(EType::Bed)];
+}
+
+// Slab test of the infinite line against the box.
+static bool line_intersects_box(const Vec3d& point, const Vec3d& direction, const AABBTreeIndirect::Tree3d::BoundingBox& box)
+{
+    double t_min = -std::numeric_limits<double>::max();
+    double t_max = std::numeric_limits<double>::max();
+    for (int i = 0; i < 3; ++i) {
+        if (direction[i] == 0.0) {
+            if (point[i] < box.min()[i] || point[i] > box.max()[i])
+                return false;
+        }
+        else {
+            const double t1 = (box.min()[i] - point[i]) / direction[i];
+            const double t2 = (box.max()[i] - point[i]) / direction[i];
+            t_min = std::max(t_min, std::min(t1, t2));
+            t_max = std::min(t_max, std::max(t1, t2));
+        }
+    }
+    return t_min <= t_max;
+}
+
+std::vector<size_t> SceneRaycaster::raycasters_on_line(EType type, const Vec3d& point, const Vec3d& direction) const
+{
+    const std::vector<std::shared_ptr<SceneRaycasterItem>>& raycasters = *get_raycasters(type);
+    RaycastersTree& tree = get_tree(type);
+    if (!tree.dirty)
+        tree.dirty = std::any_of(raycasters.begin(), raycasters.end(),
+            [](const std::shared_ptr<SceneRaycasterItem>& item) { return !item->is_world_bounding_box_valid(); });
+    if (tree.dirty) {
+        struct ItemBox
+        {
+            size_t m_idx;
+            AABBTreeIndirect::Tree3d::BoundingBox m_bbox;
+
+            size_t idx() const { return m_idx; }
+            const AABBTreeIndirect::Tree3d::BoundingBox& bbox() const { return m_bbox; }
+            Vec3d centroid() const { return m_bbox.center(); }
+        };
+        std::vector<ItemBox> boxes;
+        boxes.reserve(raycasters.size());
+        for (size_t i = 0; i < raycasters.size(); ++i) {
+            const BoundingBoxf3& box = raycasters[i]->get_world_bounding_box();
+            // Inflate the bounding box a bit to account for numerical issues.
+            boxes.push_back({ i, { box.min - Vec3d(EPSILON, EPSILON, EPSILON), box.max + Vec3d(EPSILON, EPSILON, EPSILON) } });
+        }
+        tree.tree.build(std::move(boxes));
+        tree.dirty = false;
+    }
+
+    std::vector<size_t> ret;
+    AABBTreeIndirect::traverse(tree.tree,
+        [&point, &direction](const AABBTreeIndirect::Tree3d::Node& node) { return line_intersects_box(point, direction, node.bbox); },
+        [&ret](const AABBTreeIndirect::Tree3d::Node& node) { ret.emplace_back(node.idx); return true; });
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
 int SceneRaycaster::encode_id(EType type, int id) { return base_id(type) + id; }
 int SceneRaycaster::decode_id(EType type, int id) { return id - base_id(type); }
 
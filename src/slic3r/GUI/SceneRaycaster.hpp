@@ -7,6 +7,8 @@
 
 #include "MeshUtils.hpp"
 #include "GLModel.hpp"
+#include "libslic3r/AABBTreeIndirect.hpp"
+#include <array>
 #include <vector>
 #include <string>
 #include <optional>
@@ -23,6 +25,8 @@ class SceneRaycasterItem
     bool m_use_back_faces{ false };
     const MeshRaycaster* m_raycaster;
     Transform3d m_trafo;
+    // Bounding box of the mesh of m_raycaster transformed by m_trafo, calculated on demand.
+    mutable std::optional<BoundingBoxf3> m_world_bounding_box;
 
 public:
     SceneRaycasterItem(int id, const MeshRaycaster& raycaster, const Transform3d& trafo, bool use_back_faces = false)
@@ -35,7 +39,9 @@ public:
     bool use_back_faces() const { return m_use_back_faces; }
     const MeshRaycaster* get_raycaster() const { return m_raycaster; }
     const Transform3d& get_transform() const { return m_trafo; }
-    void set_transform(const Transform3d& trafo) { m_trafo = trafo; }
+    void set_transform(const Transform3d& trafo) { m_trafo = trafo; m_world_bounding_box.reset(); }
+    const BoundingBoxf3& get_world_bounding_box() const;
+    bool is_world_bounding_box_valid() const { return m_world_bounding_box.has_value(); }
 };
 
 class SceneRaycaster
@@ -74,6 +80,16 @@ private:
     std::vector<std::shared_ptr<SceneRaycasterItem>> m_gizmos;
     std::vector<std::shared_ptr<SceneRaycasterItem>> m_fallback_gizmos;
 
+    // AABB trees over the world bounding boxes of the raycasters of the Bed, Volume, Gizmo and FallbackGizmo types,
+    // so that hit() tests only the raycasters with the bounding box intersected by the mouse ray.
+    // Rebuilt on demand after the raycasters of the type were added, removed or transformed.
+    struct RaycastersTree
+    {
+        AABBTreeIndirect::Tree3d tree;
+        bool dirty{ true };
+    };
+    mutable std::array<RaycastersTree, 4> m_trees;
+
     // When set to true, if checking gizmos returns a valid hit,
     // the search is not performed on other types
     bool m_gizmos_on_top{ false };
@@ -118,6 +134,10 @@ public:
 private:
     static int encode_id(EType type, int id);
     static int base_id(EType type);
+
+    RaycastersTree& get_tree(EType type) const;
+    // Indices, in ascending order, of the raycasters of the given type with the world bounding box intersected by the given line.
+    std::vector<size_t> raycasters_on_line(EType type, const Vec3d& point, const Vec3d& direction) const;
 };
 
 } // namespace GUI
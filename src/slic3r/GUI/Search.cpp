@@ -5,6 +5,7 @@
 #include "Search.hpp"
 
 #include <cstddef>
+#include <numeric>
 #include <string>
 #include <boost/algorithm/string.hpp>
 #include <boost/optional.hpp>
@@ -195,27 +196,20 @@ static bool fuzzy_match(const std::wstring &search_pattern, const std::wstring &
 		return false;
 }
 
-bool OptionsSearcher::search(const std::string& search, bool force/* = false*/)
+// Compose the labels of all options once, so that they are not composed on every keystroke.
+void OptionsSearcher::update_labels()
 {
-    if (search_line == search && !force)
-        return false;
-
-    found.clear();
+    const std::wstring sep = L" : ";
 
-    bool full_list = search.empty();
-    std::wstring sep = L" : ";
-
-    auto get_label = [this, &sep](const Option& opt, bool marked = true)
+    auto get_label = [this, &sep](const std::wstring &category, const std::wstring &group, const std::wstring &label)
     {
         std::wstring out;
-        if (marked)
-            out += marker_by_type(opt.type, printer_technology);
     	const std::wstring *prev = nullptr;
     	for (const std::wstring * const s : {
-	        view_params.category 	? &opt.category_local 		: nullptr,
-	        &opt.group_local, &opt.label_local })
+	        view_params.category 	? &category 		: nullptr,
+	        &group, &label })
     		if (s != nullptr && (prev == nullptr || *prev != *s)) {
-      			if (out.size()>2)
+      			if (! out.empty())
     				out += sep;
     			out += *s;
     			prev = s;
@@ -223,80 +217,109 @@ bool OptionsSearcher::search(const std::string& search, bool force/* = false*/)
         return out;
     };
 
-    auto get_label_english = [this, &sep](const Option& opt, bool marked = true)
-    {
-        std::wstring out;
-        if (marked)
-            out += marker_by_type(opt.type, printer_technology);
-    	const std::wstring*prev = nullptr;
-    	for (const std::wstring * const s : {
-	        view_params.category 	? &opt.category 			: nullptr,
-	        &opt.group, &opt.label })
-    		if (s != nullptr && (prev == nullptr || *prev != *s)) {
-      			if (out.size()>2)
-    				out += sep;
-    			out += *s;
-    			prev = s;
-    		}
-        return out;
+    // Some characters are folded to more than one ASCII character (for example German sharp s to "ss"). Such a label may not match
+    // a search pattern, but match the same pattern extended by the next character, thus it must not be dropped by the incremental search.
+    auto folds_to_multiple_chars = [](const std::wstring &str) {
+        wchar_t tmp[4];
+        return std::any_of(str.begin(), str.end(), [&tmp](wchar_t c) { return fold_to_ascii(c, tmp) - tmp > 1; });
     };
 
-    auto get_tooltip = [this, &sep](const Option& opt)
-    {
-        return  marker_by_type(opt.type, printer_technology) +
-                opt.category_local + sep +
-                opt.group_local + sep + opt.label_local;
-    };
+    labels.clear();
+    labels.reserve(options.size());
+    for (const Option &opt : options) {
+        OptionLabels &l = labels.emplace_back();
+        l.label         = get_label(opt.category_local, opt.group_local, opt.label_local);
+        l.label_english = get_label(opt.category, opt.group, opt.label);
+        l.label_marked  = into_u8(marker_by_type(opt.type, printer_technology) + l.label);
+        l.tooltip       = boost::nowide::narrow(marker_by_type(opt.type, printer_technology) + opt.category_local + sep + opt.group_local + sep + opt.label_local);
+        l.multichar_fold = folds_to_multiple_chars(l.label) || folds_to_multiple_chars(l.label_english) || folds_to_multiple_chars(opt.key);
+    }
+    labels_category = view_params.category;
+    candidates_pattern.clear();
+}
 
-    std::vector<uint16_t> matches, matches2;
-    for (size_t i=0; i < options.size(); i++)
-    {
-        const Option &opt = options[i];
-        if (full_list) {
-            std::string label = into_u8(get_label(opt));
-            found.emplace_back(FoundOption{ label, label, boost::nowide::narrow(get_tooltip(opt)), i, 0 });
-            continue;
-        }
+bool OptionsSearcher::search(const std::string& search, bool force/* = false*/)
+{
+    if (search_line == search && !force)
+        return false;
+
+    found.clear();
+
+    if (labels.size() != options.size() || labels_category != view_params.category)
+        update_labels();
 
-        std::wstring wsearch       = boost::nowide::widen(search);
+    bool full_list = search.empty();
+    if (full_list) {
+        for (size_t i = 0; i < options.size(); ++ i)
+            found.emplace_back(FoundOption{ labels[i].label_marked, labels[i].label_marked, labels[i].tooltip, i, 0 });
+        candidates_pattern.clear();
+    } else {
+        std::wstring wsearch = boost::nowide::widen(search);
         boost::trim_left(wsearch);
-        std::wstring label         = get_label(opt, false);
-        std::wstring label_english = get_label_english(opt, false);
-        int score = std::numeric_limits<int>::min();
-        int score2;
-        matches.clear();
-        fuzzy_match(wsearch, label, score, matches);
-        if (fuzzy_match(wsearch, opt.key, score2, matches2) && score2 > score) {
-        	for (fts::pos_type &pos : matches2)
-        		pos += label.size() + 1;
-        	label += L"(" + opt.key + L")";
-        	append(matches, matches2);
-        	score = score2;
-        }
-        if (view_params.english && fuzzy_match(wsearch, label_english, score2, matches2) && score2 > score) {
-        	label   = std::move(label_english);
-        	matches = std::move(matches2);
-        	score   = score2;
+
+        // A fuzzy match of a pattern requires its characters to be found in the label in the same order, therefore an option
+        // not matching a pattern will not match the pattern extended with more characters. While the user types, only the options
+        // matching the previous search line are searched.
+        const bool narrow = ! candidates_pattern.empty() && candidates_english == view_params.english &&
+                            boost::starts_with(wsearch, candidates_pattern);
+        if (! narrow) {
+            candidates.resize(options.size());
+            std::iota(candidates.begin(), candidates.end(), size_t(0));
         }
-        if (score > 90/*std::numeric_limits<int>::min()*/) {
-		    label = mark_string(label, matches, opt.type, printer_technology);
-            label += L"  [" + std::to_wstring(score) + L"]";// add score value
-	        std::string label_u8 = into_u8(label);
-	        std::string label_plain = label_u8;
+
+        std::vector<uint16_t> matches, matches2;
+        size_t num_candidates = 0;
+        for (size_t i : candidates)
+        {
+            const Option       &opt    = options[i];
+            const OptionLabels &l      = labels[i];
+            std::wstring label         = l.label;
+            int score = std::numeric_limits<int>::min();
+            int score2;
+            matches.clear();
+            bool matched = fuzzy_match(wsearch, label, score, matches);
+            if (fuzzy_match(wsearch, opt.key, score2, matches2)) {
+                matched = true;
+                if (score2 > score) {
+        	        for (fts::pos_type &pos : matches2)
+        		        pos += label.size() + 1;
+        	        label += L"(" + opt.key + L")";
+        	        append(matches, matches2);
+        	        score = score2;
+                }
+            }
+            if (view_params.english && fuzzy_match(wsearch, l.label_english, score2, matches2)) {
+                matched = true;
+                if (score2 > score) {
+        	        label   = l.label_english;
+        	        matches = std::move(matches2);
+        	        score   = score2;
+                }
+            }
+            if (matched || l.multichar_fold)
+                candidates[num_candidates ++] = i;
+            if (score > 90/*std::numeric_limits<int>::min()*/) {
+		        label = mark_string(label, matches, opt.type, printer_technology);
+                label += L"  [" + std::to_wstring(score) + L"]";// add score value
+	            std::string label_u8 = into_u8(label);
+	            std::string label_plain = label_u8;
 
 #ifdef SUPPORTS_MARKUP
-            boost::replace_all(label_plain, std::string(1, char(ImGui::ColorMarkerStart)), "<b>");
-            boost::replace_all(label_plain, std::string(1, char(ImGui::ColorMarkerEnd)),   "</b>");
+                boost::replace_all(label_plain, std::string(1, char(ImGui::ColorMarkerStart)), "<b>");
+                boost::replace_all(label_plain, std::string(1, char(ImGui::ColorMarkerEnd)),   "</b>");
 #else
-            boost::erase_all(label_plain, std::string(1, char(ImGui::ColorMarkerStart)));
-            boost::erase_all(label_plain, std::string(1, char(ImGui::ColorMarkerEnd)));
+                boost::erase_all(label_plain, std::string(1, char(ImGui::ColorMarkerStart)));
+                boost::erase_all(label_plain, std::string(1, char(ImGui::ColorMarkerEnd)));
 #endif
-	        found.emplace_back(FoundOption{ label_plain, label_u8, boost::nowide::narrow(get_tooltip(opt)), i, score });
+	            found.emplace_back(FoundOption{ label_plain, label_u8, l.tooltip, i, score });
+            }
         }
-    }
+        candidates.resize(num_candidates);
+        candidates_pattern = std::move(wsearch);
+        candidates_english = view_params.english;
 
-    if (!full_list)
         sort_found();
+    }
  
     if (search_line != search)
         search_line = search;
@@ -328,6 +351,7 @@ void OptionsSearcher::check_and_update(PrinterTechnology pt_in, ConfigOptionMode
     options.insert(options.end(), preferences_options.begin(), preferences_options.end());
 
     sort_options();
+    update_labels();
 
     search(search_line, true);
 }
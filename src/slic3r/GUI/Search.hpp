@@ -96,11 +96,32 @@ class OptionsSearcher
     std::vector<Option>                     preferences_options {};
     std::vector<FoundOption>                found {};
 
+    // Labels of options, precomputed by update_labels() when the options are loaded. Indexed the same way as options.
+    struct OptionLabels {
+        std::wstring    label;
+        std::wstring    label_english;
+        // UTF8 encoded label with the marker of the preset type, used when listing all options.
+        std::string     label_marked;
+        std::string     tooltip;
+        // The label contains a character folded to more than one ASCII character, see update_labels().
+        bool            multichar_fold { false };
+    };
+    std::vector<OptionLabels>               labels {};
+    // Value of view_params.category the labels were composed for.
+    bool                                    labels_category { false };
+    // Indices of options matching candidates_pattern. When the search line is extended, only these options are searched.
+    std::vector<size_t>                     candidates {};
+    std::wstring                            candidates_pattern {};
+    bool                                    candidates_english { false };
+
     void append_options(DynamicPrintConfig* config, Preset::Type type);
+    void update_labels();
 
     void sort_options() {
         std::sort(options.begin(), options.end(), [](const Option& o1, const Option& o2) {
             return o1.label < o2.label; });
+        // Labels are indexed by options, they will be composed again by the next search().
+        labels.clear();
     }
     void sort_found() {
         std::sort(found.begin(), found.end(), [](const FoundOption& f1, const FoundOption& f2) {
@@ -142,6 +163,7 @@ public:
     void sort_options_by_key() {
         std::sort(options.begin(), options.end(), [](const Option& o1, const Option& o2) {
             return o1.key < o2.key; });
+        labels.clear();
     }
     void sort_options_by_label() { sort_options(); }
 
@@ -566,6 +566,11 @@ void Tab::update_label_colours()
 
 void Tab::decorate()
 {
+    // Only the fields of the active page exist, and only the changed ones need to be repainted.
+    if (!m_active_page)
+        return;
+    bool changed = false;
+
     for (const auto& opt : m_options_list)
     {
         Field*      field = nullptr;
@@ -611,29 +616,29 @@ void Tab::decorate()
 
         if (option_without_field) {
             if (Line* line = get_line(opt.first)) {
-                line->set_undo_bitmap(icon);
-                line->set_undo_to_sys_bitmap(sys_icon);
-                line->set_undo_tooltip(tt);
-                line->set_undo_to_sys_tooltip(sys_tt);
-                line->set_label_colour(color);
+                changed |= line->set_undo_bitmap(icon);
+                changed |= line->set_undo_to_sys_bitmap(sys_icon);
+                changed |= line->set_undo_tooltip(tt);
+                changed |= line->set_undo_to_sys_tooltip(sys_tt);
+                changed |= line->set_label_colour(color);
             }
             continue;
         }
         
         field->m_is_nonsys_value = is_nonsys_value;
         field->m_is_modified_value = is_modified_value;
-        field->set_undo_bitmap(icon);
-        field->set_undo_to_sys_bitmap(sys_icon);
-        field->set_undo_tooltip(tt);
-        field->set_undo_to_sys_tooltip(sys_tt);
-        field->set_label_colour(color);
+        changed |= field->set_undo_bitmap(icon);
+        changed |= field->set_undo_to_sys_bitmap(sys_icon);
+        changed |= field->set_undo_tooltip(tt);
+        changed |= field->set_undo_to_sys_tooltip(sys_tt);
+        changed |= field->set_label_colour(color);
 
         if (field->has_edit_ui())
-            field->set_edit_bitmap(&m_bmp_edit_value);
+            changed |= field->set_edit_bitmap(&m_bmp_edit_value);
 
     }
 
-    if (m_active_page)
+    if (changed)
         m_active_page->refresh();
 }
 
@@ -915,8 +920,15 @@ void Tab::load_config(const DynamicPrintConfig& config)
 // Reload current $self->{config} (aka $self->{presets}->edited_preset->config) into the UI fields.
 void Tab::reload_config()
 {
-    if (m_active_page)
-        m_active_page->reload_config();
+    if (!m_active_page)
+        return;
+    // Don't push the values into the widgets of a Tab, which is not shown. They will be pushed when the Tab is activated.
+    if (wxGetApp().mainframe != nullptr && !wxGetApp().mainframe->is_active_and_shown_tab(this)) {
+        m_reload_config_postponed = true;
+        return;
+    }
+    m_reload_config_postponed = false;
+    m_active_page->reload_config();
 }
 
 void Tab::update_mode()
@@ -4032,6 +4044,11 @@ void Tab::activate_selected_page(std::function<void()> throw_if_canceled)
     if (!m_active_page)
         return;
 
+    if (m_reload_config_postponed) {
+        // Update the widgets, which were already created, before the missing ones are created.
+        m_reload_config_postponed = false;
+        m_active_page->reload_config();
+    }
     m_active_page->activate(m_mode, throw_if_canceled);
 
     if (m_active_page->title() == "Dependencies") {
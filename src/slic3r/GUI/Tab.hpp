@@ -281,6 +281,8 @@ protected:
 	bool				m_is_modified_values{ false };
 	bool				m_is_nonsys_values{ true };
 	bool				m_postpone_update_ui {false};
+	// reload_config() was called while this Tab was not shown. The active page will be reloaded by activate_selected_page().
+	bool				m_reload_config_postponed {false};
 
     void                set_type();
 
@@ -377,7 +377,7 @@ bool fix_model_by_win10_sdk_gui(ModelObject &model_object, int volume_idx, wxPro
                 mo->volumes.back()->set_transformation(Geometry::Transformation());
 
                 mo->add_instance();
-				if (!Slic3r::store_3mf(path_src.string().c_str(), &model, nullptr, false, nullptr, false)) {
+				if (!Slic3r::store_3mf(path_src.string().c_str(), &model, nullptr, false, nullptr, false, true)) {
 					boost::filesystem::remove(path_src);
 					throw Slic3r::RuntimeError("Export of a temporary 3mf file failed");
 				}
@@ -10,6 +10,7 @@
 #include <functional>
 #include <thread>
 #include <deque>
+#include <mutex>
 #include <sstream>
 #include <exception>
 #include <boost/filesystem/fstream.hpp>
@@ -41,6 +42,11 @@ struct CurlGlobalInit
 {
     static std::unique_ptr<CurlGlobalInit> instance;
     std::string message;
+    // Shared by all the Http requests to cache the DNS lookups, TLS sessions and open connections,
+    // so that repeated requests to the same host (printer status polling, preset updates) do not pay
+    // for the connection setup each time. Null if it could not be created.
+    ::CURLSH *share { nullptr };
+    std::mutex share_mutexes[CURL_LOCK_DATA_LAST];
 
 	CurlGlobalInit()
     {
@@ -98,10 +104,36 @@ struct CurlGlobalInit
                             "network connections. See logs for additional details.");
 
             BOOST_LOG_TRIVIAL(error) << ::curl_easy_strerror(ec);
+        } else if ((share = ::curl_share_init()) != nullptr) {
+            ::curl_share_setopt(share, CURLSHOPT_LOCKFUNC, share_lock);
+            ::curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+            ::curl_share_setopt(share, CURLSHOPT_USERDATA, static_cast<void*>(this));
+            ::curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            ::curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+            // Sharing of the connection cache is supported since curl 7.57.0.
+            ::curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
         }
     }
 
-	~CurlGlobalInit() { ::curl_global_cleanup(); }
+	~CurlGlobalInit()
+    {
+        // Fails with CURLSHE_IN_USE if a request is still running at exit, then the share handle is leaked.
+        if (share != nullptr)
+            ::curl_share_cleanup(share);
+        ::curl_global_cleanup();
+    }
+
+    static void share_lock(::CURL * /* handle */, ::curl_lock_data data, ::curl_lock_access /* access */, void *userp)
+    {
+        static_cast<CurlGlobalInit*>(userp)->share_mutexes[data].lock();
+    }
+
+    static void share_unlock(::CURL * /* handle */, ::curl_lock_data data, void *userp)
+    {
+        static_cast<CurlGlobalInit*>(userp)->share_mutexes[data].unlock();
+    }
 };
 
 std::unique_ptr<CurlGlobalInit> CurlGlobalInit::instance;
@@ -177,6 +209,10 @@ Http::priv::priv(const std::string &url)
 	::curl_easy_setopt(curl, CURLOPT_URL, url.c_str());   // curl makes a copy internally
 	::curl_easy_setopt(curl, CURLOPT_USERAGENT, SLIC3R_APP_NAME "/" SLIC3R_VERSION);
 	::curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, &error_buffer.front());
+	if (CurlGlobalInit::instance->share != nullptr)
+		::curl_easy_setopt(curl, CURLOPT_SHARE, CurlGlobalInit::instance->share);
+	// Keep the cached connections alive between the requests.
+	::curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
 }
 
 Http::priv::~priv()
@@ -6,11 +6,15 @@
 #include "PresetUpdater.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <ostream>
 #include <utility>
 #include <stdexcept>
+#include <tuple>
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
@@ -56,6 +60,8 @@ namespace Slic3r {
 
 //static const char *INDEX_FILENAME = "index.idx";
 static const char *TMP_EXTENSION = ".download";
+// Number of the vendors and resources downloaded concurrently.
+static constexpr const size_t max_parallel_downloads = 4;
 
 namespace {
 void copy_file_fix(const fs::path &source, const fs::path &target)
@@ -88,6 +94,36 @@ std::string escape_string_url(const std::string& unescaped)
 	}
 	return ret_val;
 }
+// Formats the time as a HTTP date (RFC 7231), independent of the current locale.
+std::string http_date(std::time_t t)
+{
+	static const char *days[]   = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+	static const char *months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+	std::tm tm;
+#ifdef _WIN32
+	gmtime_s(&tm, &t);
+#else
+	gmtime_r(&t, &tm);
+#endif
+	return (boost::format("%1%, %2$02d %3% %4% %5$02d:%6$02d:%7$02d GMT")
+		% days[tm.tm_wday] % tm.tm_mday % months[tm.tm_mon] % (tm.tm_year + 1900) % tm.tm_hour % tm.tm_min % tm.tm_sec).str();
+}
+// Calls fn(0) ... fn(count - 1) on at most max_threads threads, the calling thread included.
+template<class Fn>
+void run_bounded(size_t count, size_t max_threads, Fn &&fn)
+{
+	std::atomic<size_t> next { 0 };
+	auto worker = [&next, &fn, count]() {
+		for (size_t i = next ++; i < count; i = next ++)
+			fn(i);
+	};
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < std::min(count, max_threads); ++ i)
+		threads.emplace_back(worker);
+	worker();
+	for (std::thread &thread : threads)
+		thread.join();
+}
 }
 
 wxDEFINE_EVENT(EVT_CONFIG_UPDATER_SYNC_DONE, wxCommandEvent);
@@ -175,7 +211,8 @@ struct PresetUpdater::priv
 	fs::path rsrc_path;
 	fs::path vendor_path;
 
-	bool cancel;
+	// Read by the download threads of sync_config().
+	std::atomic<bool> cancel;
 	std::thread thread;
 
 	bool has_waiting_updates { false };
@@ -184,7 +221,8 @@ struct PresetUpdater::priv
 	priv();
 
 	void set_download_prefs(const AppConfig *app_config);
-	bool get_file(const std::string &url, const fs::path &target_path) const;
+	// If if_modified is set and the target exists, the file is only downloaded if it changed on the server since it was written.
+	bool get_file(const std::string &url, const fs::path &target_path, bool if_modified = false) const;
 	void prune_tmps() const;
 	void sync_config(const VendorMap vendors, const std::string& index_archive_url);
 
@@ -227,7 +265,7 @@ void PresetUpdater::priv::set_download_prefs(const AppConfig *app_config)
 }
 
 // Downloads a file (http get operation). Cancels if the Updater is being destroyed.
-bool PresetUpdater::priv::get_file(const std::string &url, const fs::path &target_path) const
+bool PresetUpdater::priv::get_file(const std::string &url, const fs::path &target_path, bool if_modified) const
 {
 	bool res = false;
 	fs::path tmp_path = target_path;
@@ -238,9 +276,14 @@ bool PresetUpdater::priv::get_file(const std::string &url, const fs::path &targe
 		target_path.string(),
 		tmp_path.string());
 
-	Http::get(url)
-        .on_progress([](Http::Progress, bool &cancel) {
-			if (cancel) { cancel = true; }
+	auto http = Http::get(url);
+	boost::system::error_code ec;
+	if (if_modified && fs::exists(target_path, ec))
+		if (std::time_t mtime = fs::last_write_time(target_path, ec); ! ec)
+			http.header("If-Modified-Since", http_date(mtime));
+
+	http.on_progress([this](Http::Progress, bool &cancel) {
+			if (this->cancel) { cancel = true; }
 		})
 		.on_error([&](std::string body, std::string error, unsigned http_status) {
 			(void)body;
@@ -249,7 +292,13 @@ bool PresetUpdater::priv::get_file(const std::string &url, const fs::path &targe
 				http_status,
 				error);
 		})
-		.on_complete([&](std::string body, unsigned /* http_status */) {
+		.on_complete([&](std::string body, unsigned http_status) {
+			if (http_status == 304) {
+				// Not modified, keep the file downloaded before.
+				BOOST_LOG_TRIVIAL(info) << format("Not modified: `%1%`", url);
+				res = true;
+				return;
+			}
 			fs::fstream file(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
 			file.write(body.c_str(), body.size());
 			file.close();
@@ -377,7 +426,8 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 		BOOST_LOG_TRIVIAL(error) << "Unsafe url path for vedor profiles archive zip. Download is rejected.";
 		return;
 	}
-	if (!get_file(index_archive_url, archive_path)) {
+	// The archive is only downloaded if it changed since the last synchronization.
+	if (!get_file(index_archive_url, archive_path, true)) {
 		BOOST_LOG_TRIVIAL(error) << "Download of vedor profiles archive zip failed.";
 		return;
 	}
@@ -449,7 +499,18 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 
 	// Update vendor preset bundles if in Vendor
 	// Over all indices from the cache directory:
-	for (auto &index : index_db) {
+	// Resources missing in the vendor, resources and cache folders. They are downloaded once all the bundles are known.
+	struct Resource { std::string vendor; std::string filename; std::string url; bool copy_from_cache; };
+	std::vector<Resource> resources;
+	std::mutex            resources_mutex;
+	auto add_resource = [&resources, &resources_mutex](const std::string &vendor, const std::string &filename, const std::string &url, bool copy_from_cache) {
+		std::lock_guard<std::mutex> lock(resources_mutex);
+		resources.push_back({ vendor, filename, url, copy_from_cache });
+	};
+
+	// The vendors are independent of each other, they are processed concurrently.
+	run_bounded(index_db.size(), max_parallel_downloads, [&](size_t index_idx) {
+		Index &index = index_db[index_idx];
 		if (cancel) { 
 			return; 
 		}
@@ -463,7 +524,7 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			BOOST_LOG_TRIVIAL(debug) << "No such vendor: " << index.vendor();
 			if (archive_it != vendors_with_status.end())
 				archive_it->second = VendorStatus::IN_CACHE;
-			continue;
+			return;
 		}
 
 		if (archive_it != vendors_with_status.end())
@@ -480,11 +541,11 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 				new_index.load(idx_path_temp);
 			} catch (const std::exception & /* err */) {
 				BOOST_LOG_TRIVIAL(error) << format("Could not load downloaded index %1% for vendor %2%: invalid index?", idx_path_temp, vendor.name);
-				continue;
+				return;
 			}
 			if (new_index.version() < index.version()) {
 				BOOST_LOG_TRIVIAL(info) << format("The downloaded index %1% for vendor %2% is older than the active one. Ignoring the downloaded index.", idx_path_temp, vendor.name);
-				continue;
+				return;
 			}
 			copy_file_fix(idx_path_temp, idx_path);
 			
@@ -495,7 +556,7 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			}
 			catch (const std::exception& /* err */) {
 				BOOST_LOG_TRIVIAL(error) << format("Could not load downloaded index %1% for vendor %2%: invalid index?", idx_path, vendor.name);
-				continue;
+				return;
 			}
 			if (cancel)
 				return;
@@ -505,7 +566,7 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 		const auto recommended_it = index.recommended();
 		if (recommended_it == index.end()) {
 			BOOST_LOG_TRIVIAL(error) << format("No recommended version for vendor: %1%, invalid index?", vendor.name);
-			continue;
+			return;
 		}
 
 		const auto recommended = recommended_it->config_version;
@@ -515,7 +576,7 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			vendor.config_version.to_string(),
 			recommended.to_string());
 
-		if (vendor.config_version >= recommended) { continue; }
+		if (vendor.config_version >= recommended) { return; }
 
 		// vendors that are checked here, doesnt need to be checked again later
 		if (archive_it != vendors_with_status.end())
@@ -526,8 +587,18 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 		BOOST_LOG_TRIVIAL(info) << "Downloading new bundle for vendor: " << vendor.name;
 		const auto bundle_url = format("%1%/%2%.ini", vendor.config_update_url, recommended.to_string());
 		const auto bundle_path = cache_path / (vendor.id + ".ini");
-		if (!get_file(bundle_url, bundle_path))
-			continue;
+		// The bundles are versioned. Skip the download if the recommended one was downloaded by a previous synchronization.
+		bool cached = false;
+		if (fs::exists(bundle_path)) {
+			try {
+				cached = VendorProfile::from_ini(bundle_path, false).config_version == recommended;
+			} catch (const std::exception &) {
+			}
+		}
+		if (cached)
+			BOOST_LOG_TRIVIAL(info) << "Bundle for vendor " << vendor.name << " is up to date in cache.";
+		else if (!get_file(bundle_url, bundle_path))
+			return;
 		if (cancel)
 			return;
 		// vp is fully loaded to get all resources
@@ -536,50 +607,45 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			vp = VendorProfile::from_ini(bundle_path, true);
 		} catch (const std::exception& e) {
 			BOOST_LOG_TRIVIAL(error) << format("Corrupted profile file for vendor %1% at %2%, message: %3%", vendor.id, bundle_path, e.what());
-			continue;
+			return;
 		}
 		// check the fresh bundle for missing resources
 		// for that, the ini file must be parsed (done above)
 		for (const auto& model : vp.models) {
 			for (const std::string& res : { model.bed_texture, model.bed_model, model.thumbnail/*id +"_thumbnail.png"*/} ) {
-				if (! res.empty()) {
-					try
-					{
-						get_missing_resource(vp.id, res, vendor.config_update_url);
-					}
-					catch (const std::exception& e)
-					{
-						BOOST_LOG_TRIVIAL(error) << "Failed to get " << res << " for " << vp.id << " " << model.id << ": " << e.what();
-					}
-					
-				}
-				if (cancel)
-			    	return;
+				if (! res.empty())
+					add_resource(vp.id, res, vendor.config_update_url, false);
 			}
 		}
-	}
+	});
+	if (cancel)
+		return;
+
 	// Download missing thumbnails for not-installed vendors.
 	//for (const std::string& vendor : vendors_only_in_archive)	
-	for (const std::pair<std::string, VendorStatus >& vendor :  vendors_with_status) {
+	run_bounded(vendors_with_status.size(), max_parallel_downloads, [&](size_t vendor_idx) {
+		const std::pair<std::string, VendorStatus> &vendor = vendors_with_status[vendor_idx];
+		if (cancel)
+			return;
 		if (vendor.second == VendorStatus::IN_ARCHIVE) {
 			// index in archive and not in cache and not installed vendor
 			
 			const auto idx_path_in_archive = cache_vendor_path / (vendor.first + ".idx");
 			const auto ini_path_in_archive = cache_vendor_path / (vendor.first + ".ini");
 			if (!fs::exists(idx_path_in_archive))
-				continue;
+				return;
 			Index index;
 			try {
 				index.load(idx_path_in_archive);
 			}
 			catch (const std::exception& /* err */) {
 				BOOST_LOG_TRIVIAL(error) << format("Could not load downloaded index %1% for vendor %2%: invalid index?", idx_path_in_archive, vendor.first);
-				continue;
+				return;
 			}
 			const auto recommended_it = index.recommended();
 			if (recommended_it == index.end()) {
 				BOOST_LOG_TRIVIAL(error) << format("No recommended version for vendor: %1%, invalid index? (%2%)", vendor.first, idx_path_in_archive);
-				continue;
+				return;
 			}
 			const auto recommended = recommended_it->config_version;
 			if (!fs::exists(ini_path_in_archive)){
@@ -587,7 +653,7 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 				const std::string fixed_url = GUI::wxGetApp().app_config->profile_folder_url();
 				const auto bundle_url = format("%1%/%2%/%3%.ini", fixed_url, vendor.first, recommended.to_string());
 				if (!get_file(bundle_url, ini_path_in_archive))
-					continue;
+					return;
 			} else {
 				// check existing ini version
 				// then download recommneded to vendor if needed
@@ -596,13 +662,13 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 					vp = VendorProfile::from_ini(ini_path_in_archive, true);
 				} catch (const std::exception& e) {
 					BOOST_LOG_TRIVIAL(error) << format("Corrupted profile file for vendor %1% at %2%, message: %3%", vendor.first, ini_path_in_archive, e.what());
-					continue;
+					return;
 				}
 				if (vp.config_version != recommended) {
 					const std::string fixed_url = GUI::wxGetApp().app_config->profile_folder_url();
 					const auto bundle_url = format("%1%/%2%/%3%.ini", fixed_url, vendor.first, recommended.to_string());
 					if (!get_file(bundle_url, ini_path_in_archive))
-						continue;
+						return;
 				}
 			}
 			// check missing thumbnails
@@ -612,21 +678,12 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			}
 			catch (const std::exception& e) {
 				BOOST_LOG_TRIVIAL(error) << format("Corrupted profile file for vendor %1% at %2%, message: %3%", vendor.first, ini_path_in_archive, e.what());
-				continue;
+				return;
 			}
 			for (const auto& model : vp.models) {
 				if (!model.thumbnail.empty()) {
-					try
-					{
-						get_missing_resource(vp.id, model.thumbnail, vp.config_update_url);
-					}
-					catch (const std::exception& e)
-					{
-						BOOST_LOG_TRIVIAL(error) << "Failed to get " << model.thumbnail << " for " << vp.id << " " << model.id << ": " << e.what();
-					}
+					add_resource(vp.id, model.thumbnail, vp.config_update_url, false);
 				}
-				if (cancel)
-					return;
 			}
 		} else if (vendor.second == VendorStatus::IN_CACHE) {
 			// find those where archive index recommends other version than index in cache and get it if not present
@@ -635,7 +692,7 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			const auto idx_path_in_cache = cache_path / (vendor.first + ".idx");
 
 			if (!fs::exists(idx_path_in_archive) || !fs::exists(idx_path_in_cache))
-					continue;
+					return;
 
 			// Compare index in cache and recetly downloaded one as part of zip archive
 			Index index_cache;
@@ -644,12 +701,12 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			}
 			catch (const std::exception& /* err */) {
 				BOOST_LOG_TRIVIAL(error) << format("Could not load downloaded index %1% for vendor %2%: invalid index?", idx_path_in_cache, vendor.first);
-				continue;
+				return;
 			}
 			const auto recommended_it_cache = index_cache.recommended();
 			if (recommended_it_cache == index_cache.end()) {
 				BOOST_LOG_TRIVIAL(error) << format("No recommended version for vendor: %1%, invalid index? (%2%)", vendor.first, idx_path_in_cache);
-				continue;
+				return;
 			}
 			const auto recommended_cache = recommended_it_cache->config_version;
 
@@ -659,12 +716,12 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			}
 			catch (const std::exception& /* err */) {
 				BOOST_LOG_TRIVIAL(error) << format("Could not load downloaded index %1% for vendor %2%: invalid index?", idx_path_in_archive, vendor.first);
-				continue;
+				return;
 			}
 			const auto recommended_it_archive = index_archive.recommended();
 			if (recommended_it_archive == index_archive.end()) {
 				BOOST_LOG_TRIVIAL(error) << format("No recommended version for vendor: %1%, invalid index? (%2%)", vendor.first, idx_path_in_archive);
-				continue;
+				return;
 			}
 			const auto recommended_archive = recommended_it_archive->config_version;
 			
@@ -672,7 +729,7 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 				// There isn't  more recent recomended version online. This vendor is also not istalled.
 				// Thus only .ini is in resources and came with installation.
 				// And we expect all resources are present.
-				continue;
+				return;
 			}
 			
 			// Download new .ini if needed. So next time user runs Wizard, most recent profiles are shown & installed.
@@ -681,7 +738,7 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 				const fs::path ini_path_in_rsrc = rsrc_path / (vendor.first + ".ini");
 				if (!fs::exists(ini_path_in_rsrc)) {
 					// THIS SHOULD NOT HAPPEN
-					continue;
+					return;
 				}
 				// Get download path from existing ini.
 				VendorProfile vp;
@@ -690,12 +747,12 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 				}
 				catch (const std::exception& e) {
 					BOOST_LOG_TRIVIAL(error) << format("Corrupted profile file for vendor %1% at %2%, message: %3%", vendor.first, ini_path_in_rsrc, e.what());
-					continue;
+					return;
 				}
 				const auto bundle_url = format("%1%/%2%.ini", vp.config_update_url, recommended_archive.to_string());
 				if (!get_file(bundle_url, ini_path_in_archive)) {
 					BOOST_LOG_TRIVIAL(error) << format("Failed to open vendor .ini file when checking missing resources: %1%", ini_path_in_rsrc);
-					continue;
+					return;
 				}
 			} else {
 				// Check existing ini version.
@@ -706,20 +763,20 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 				}
 				catch (const std::exception& e) {
 					BOOST_LOG_TRIVIAL(error) << format("Corrupted profile file for vendor %1% at %2%, message: %3%", vendor.first, ini_path_in_archive, e.what());
-					continue;
+					return;
 				}
 				if (vp.config_version != recommended_archive) {
 					const auto bundle_url = format("%1%/%2%.ini", vp.config_update_url, recommended_archive.to_string());
 					if (!get_file(bundle_url, ini_path_in_archive)) {
 						BOOST_LOG_TRIVIAL(error) << format("Failed to open vendor .ini file when checking missing resources: %1%", ini_path_in_archive);
-						continue;
+						return;
 					}
 				}
 			}
 
 			if (!fs::exists(ini_path_in_archive)) {
 				BOOST_LOG_TRIVIAL(error) << "Resources check failed to find ini file for vendor: " << vendor.first;
-				continue;
+				return;
 			}
 			// check missing thumbnails
 			VendorProfile vp;
@@ -728,21 +785,12 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			}
 			catch (const std::exception& e) {
 				BOOST_LOG_TRIVIAL(error) << format("Corrupted profile file for vendor %1% at %2%, message: %3%", vendor.first, ini_path_in_archive, e.what());
-				continue;
+				return;
 			}
 			for (const auto& model : vp.models) {
 				if (!model.thumbnail.empty()) {
-					try
-					{
-						get_missing_resource(vp.id, model.thumbnail, vp.config_update_url);
-					}
-					catch (const std::exception& e)
-					{
-						BOOST_LOG_TRIVIAL(error) << "Failed to get " << model.thumbnail << " for " << vp.id << " " << model.id << ": " << e.what();
-					}
+					add_resource(vp.id, model.thumbnail, vp.config_update_url, false);
 				}
-				if (cancel)
-					return;
 			}
 		} else if (vendor.second == VendorStatus::INSTALLED || vendor.second == VendorStatus::NEW_VERSION) {
 			// Installed vendors need to check that no resource is missing. Do this only for files in vendor folder (not in resorces)
@@ -750,33 +798,45 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors, const std::string
 			// But this is a check for ini file in vendor where resources might be still missing since last update.
 			const auto path_in_vendor = vendor_path / (vendor.first + ".ini");
 			if(!fs::exists(path_in_vendor))
-				continue;
+				return;
 			VendorProfile vp;
 			try {
 				vp = VendorProfile::from_ini(path_in_vendor, true);
 			}
 			catch (const std::exception& e) {
 				BOOST_LOG_TRIVIAL(error) << format("Corrupted profile file for vendor %1% at %2%, message: %3%", vendor.first, path_in_vendor, e.what());
-				continue;
+				return;
 			}
 			for (const auto& model : vp.models) {
 				for (const std::string& res : { model.bed_texture, model.bed_model, model.thumbnail }) {
 					if (!model.thumbnail.empty()) {
-						try
-						{
-							get_or_copy_missing_resource(vp.id, res, vp.config_update_url);
-						}
-						catch (const std::exception& e)
-						{
-							BOOST_LOG_TRIVIAL(error) << "Failed to get " << model.thumbnail << " for " << vp.id << " " << model.id << ": " << e.what();
-						}
+						add_resource(vp.id, res, vp.config_update_url, true);
 					}
-					if (cancel)
-						return;
 				}
 			}
 		}
-	}
+	});
+	if (cancel)
+		return;
+
+	// Download the missing resources of all the vendors. Models of a vendor often share a resource, download it once.
+	std::sort(resources.begin(), resources.end(), [](const Resource &l, const Resource &r)
+		{ return std::tie(l.vendor, l.filename, l.copy_from_cache) < std::tie(r.vendor, r.filename, r.copy_from_cache); });
+	resources.erase(std::unique(resources.begin(), resources.end(), [](const Resource &l, const Resource &r)
+		{ return l.vendor == r.vendor && l.filename == r.filename && l.copy_from_cache == r.copy_from_cache; }), resources.end());
+	run_bounded(resources.size(), max_parallel_downloads, [&](size_t resource_idx) {
+		const Resource &res = resources[resource_idx];
+		if (cancel)
+			return;
+		try {
+			if (res.copy_from_cache)
+				get_or_copy_missing_resource(res.vendor, res.filename, res.url);
+			else
+				get_missing_resource(res.vendor, res.filename, res.url);
+		} catch (const std::exception &e) {
+			BOOST_LOG_TRIVIAL(error) << "Failed to get " << res.filename << " for " << res.vendor << ": " << e.what();
+		}
+	});
 }
 
 // Install indicies from resources. Only installs those that are either missing or older than in resources.
@@ -1139,6 +1199,8 @@ void PresetUpdater::sync(const PresetBundle *preset_bundle, wxEvtHandler* evt_ha
 	VendorMap vendors = preset_bundle->vendors;
 	std::string index_archive_url = GUI::wxGetApp().app_config->index_archive_url();
 
+	// A previous synchronization may have been cancelled.
+	p->cancel = false;
     p->thread = std::thread([this, vendors, index_archive_url, evt_handler]() {
 		this->p->prune_tmps();
 		this->p->sync_config(std::move(vendors), index_archive_url);
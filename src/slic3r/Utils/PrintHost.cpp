@@ -9,6 +9,13 @@
 ///|/
 #include "PrintHost.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
 #include <vector>
 #include <thread>
 #include <exception>
@@ -21,7 +28,6 @@
 #include <wx/arrstr.h>
 
 #include "libslic3r/PrintConfig.hpp"
-#include "libslic3r/Channel.hpp"
 #include "OctoPrint.hpp"
 #include "Duet.hpp"
 #include "FlashAir.hpp"
@@ -85,64 +91,88 @@ wxString PrintHost::format_error(const std::string &body, const std::string &err
 
 struct PrintHostJobQueue::priv
 {
-    // XXX: comment on how bg thread works
+    // The jobs are uploaded by a pool of background threads, each of them picking up the oldest job, which is not uploaded
+    // to the same host as a job being uploaded by another thread. Thus the uploads to a single host are performed one after the other
+    // in the order they were enqueued, while up to max_concurrent_uploads hosts receive their uploads concurrently.
+    // The threads hold a shared pointer to priv, they are detached on exit and they finish on their own.
+
+    struct QueuedJob {
+        // Index of the job in the PrintHostQueueDialog.
+        size_t       id;
+        PrintHostJob job;
+    };
+
+    // State of a job being uploaded, owned by the background thread uploading it.
+    struct RunningJob {
+        size_t   id;
+        int      prev_progress = -1;
+        fs::path source_to_remove;
+    };
 
     PrintHostJobQueue *q;
 
-    Channel<PrintHostJob> channel_jobs;
-    Channel<size_t> channel_cancels;
-    size_t job_id = 0;
-    int prev_progress = -1;
-    fs::path source_to_remove;
+    size_t max_concurrent_uploads = 1;
 
-    std::thread bg_thread;
-    bool bg_exit = false;
+    // Following members are guarded by mutex.
+    std::mutex              mutex;
+    std::condition_variable condition;
+    std::deque<QueuedJob>   jobs;
+    size_t                  next_job_id = 0;
+    // Hosts with an upload in progress, mapped to the ID of the job being uploaded.
+    std::map<std::string, size_t> hosts_uploading;
+    // Jobs being uploaded, which were requested to be cancelled.
+    std::set<size_t>        cancels;
+
+    std::vector<std::thread> bg_threads;
+    std::atomic<bool>        bg_exit { false };
 
     PrintHostQueueDialog *queue_dialog;
 
     priv(PrintHostJobQueue *q) : q(q) {}
 
-    void emit_progress(int progress);
-    void emit_error(wxString error);
+    void emit_progress(size_t id, int progress);
+    void emit_error(size_t id, wxString error);
     void emit_cancel(size_t id);
-    void emit_info(wxString tag, wxString status);
-    void start_bg_thread();
-    void stop_bg_thread();
+    void emit_info(size_t id, wxString tag, wxString status);
+    void start_bg_threads();
+    void stop_bg_threads();
     void bg_thread_main();
-    void progress_fn(Http::Progress progress, bool &cancel);
-    void error_fn(wxString error);
-    void info_fn(wxString tag, wxString status);
+    // Is a job being uploaded requested to be cancelled? Consumes the request.
+    bool consume_cancel(size_t id);
+    void progress_fn(RunningJob &running, Http::Progress progress, bool &cancel);
+    void error_fn(RunningJob &running, wxString error);
+    void info_fn(RunningJob &running, wxString tag, wxString status);
     void remove_source(const fs::path &path);
-    void remove_source();
-    void perform_job(PrintHostJob the_job);
+    void perform_job(RunningJob &running, PrintHostJob the_job);
 };
 
-PrintHostJobQueue::PrintHostJobQueue(PrintHostQueueDialog *queue_dialog)
+PrintHostJobQueue::PrintHostJobQueue(PrintHostQueueDialog *queue_dialog, size_t max_concurrent_uploads)
     : p(new priv(this))
 {
     p->queue_dialog = queue_dialog;
+    p->max_concurrent_uploads = std::max<size_t>(1, max_concurrent_uploads);
 }
 
 PrintHostJobQueue::~PrintHostJobQueue()
 {
-    if (p) { p->stop_bg_thread(); }
+    if (p) { p->stop_bg_threads(); }
 }
 
-void PrintHostJobQueue::priv::emit_progress(int progress)
+void PrintHostJobQueue::priv::emit_progress(size_t id, int progress)
 {
-    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_PROGRESS, queue_dialog->GetId(), job_id, progress);
+    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_PROGRESS, queue_dialog->GetId(), id, progress);
     wxQueueEvent(queue_dialog, evt);
 }
 
-void PrintHostJobQueue::priv::emit_error(wxString error)
+void PrintHostJobQueue::priv::emit_error(size_t id, wxString error)
 {
-    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_ERROR, queue_dialog->GetId(), job_id, std::move(error));
+    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_ERROR, queue_dialog->GetId(), id, std::move(error));
     wxQueueEvent(queue_dialog, evt);
 }
 
-void PrintHostJobQueue::priv::emit_info(wxString tag, wxString status)
+void PrintHostJobQueue::priv::emit_info(size_t id, wxString tag, wxString status)
 {
-    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_INFO, queue_dialog->GetId(), job_id, std::move(tag), std::move(status));
+    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_INFO, queue_dialog->GetId(), id, std::move(tag), std::move(status));
     wxQueueEvent(queue_dialog, evt);
 }
 
@@ -152,140 +182,121 @@ void PrintHostJobQueue::priv::emit_cancel(size_t id)
     wxQueueEvent(queue_dialog, evt);
 }
 
-void PrintHostJobQueue::priv::start_bg_thread()
+void PrintHostJobQueue::priv::start_bg_threads()
 {
-    if (bg_thread.joinable()) { return; }
+    // Called with mutex locked. Start a new thread if all the running threads may be busy uploading.
+    if (bg_threads.size() >= max_concurrent_uploads || bg_threads.size() > hosts_uploading.size() + jobs.size())
+        return;
 
     std::shared_ptr<priv> p2 = q->p;
-    bg_thread = std::thread([p2]() {
+    bg_threads.emplace_back([p2]() {
         p2->bg_thread_main();
     });
 }
 
-void PrintHostJobQueue::priv::stop_bg_thread()
+void PrintHostJobQueue::priv::stop_bg_threads()
 {
-    if (bg_thread.joinable()) {
-        bg_exit = true;
-        channel_jobs.push(PrintHostJob()); // Push an empty job to wake up bg_thread in case it's sleeping
-        bg_thread.detach();                // Let the background thread go, it should exit on its own
+    bg_exit = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        condition.notify_all();    // Wake up the sleeping threads
     }
+    for (std::thread &bg_thread : bg_threads)
+        bg_thread.detach();        // Let the background threads go, they should exit on their own
+    bg_threads.clear();
 }
 
 void PrintHostJobQueue::priv::bg_thread_main()
 {
     // bg thread entry point
 
-    try {
-        // Pick up jobs from the job channel:
-        while (! bg_exit) {
-            auto job = channel_jobs.pop();   // Sleeps in a cond var if there are no jobs
-            if (job.empty()) {
-                // This happens when the thread is being stopped
-                break;
-            }
-
-            source_to_remove = job.upload_data.source_path;
-
-            BOOST_LOG_TRIVIAL(debug) << boost::format("PrintHostJobQueue/bg_thread: Received job: [%1%]: `%2%` -> `%3%`, cancelled: %4%")
-                % job_id
-                % job.upload_data.upload_path
-                % job.printhost->get_host()
-                % job.cancelled;
-
-            if (! job.cancelled) {
-                perform_job(std::move(job));
+    std::unique_lock<std::mutex> lock(mutex);
+    while (! bg_exit) {
+        // Pick up the oldest job with its host not receiving another upload. Sleeps in a cond var if there is no such job.
+        auto it_job = jobs.end();
+        condition.wait(lock, [this, &it_job]() {
+            it_job = std::find_if(jobs.begin(), jobs.end(), [this](const QueuedJob &job) {
+                return job.job.cancelled || hosts_uploading.find(job.job.printhost->get_host()) == hosts_uploading.end();
+            });
+            return bg_exit || it_job != jobs.end();
+        });
+        if (bg_exit)
+            break;
+
+        RunningJob   running { it_job->id };
+        PrintHostJob job = std::move(it_job->job);
+        jobs.erase(it_job);
+        running.source_to_remove = job.upload_data.source_path;
+        const std::string host = job.printhost->get_host();
+
+        BOOST_LOG_TRIVIAL(debug) << boost::format("PrintHostJobQueue/bg_thread: Received job: [%1%]: `%2%` -> `%3%`, cancelled: %4%")
+            % running.id
+            % job.upload_data.upload_path
+            % host
+            % job.cancelled;
+
+        if (! job.cancelled) {
+            hosts_uploading.emplace(host, running.id);
+            lock.unlock();
+            try {
+                perform_job(running, std::move(job));
+            } catch (const std::exception &e) {
+                emit_error(running.id, e.what());
             }
-
-            remove_source();
-            job_id++;
+            lock.lock();
+            hosts_uploading.erase(host);
+            cancels.erase(running.id);
+            // The jobs waiting for this host may be picked up now.
+            condition.notify_all();
         }
-    } catch (const std::exception &e) {
-        emit_error(e.what());
+
+        remove_source(running.source_to_remove);
     }
 
     // Cleanup leftover files, if any
-    remove_source();
-    auto jobs = channel_jobs.lock_rw();
-    for (const PrintHostJob &job : *jobs) {
-        remove_source(job.upload_data.source_path);
-    }
+    for (const QueuedJob &job : jobs)
+        remove_source(job.job.upload_data.source_path);
+    jobs.clear();
 }
 
-void PrintHostJobQueue::priv::progress_fn(Http::Progress progress, bool &cancel)
+bool PrintHostJobQueue::priv::consume_cancel(size_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return cancels.erase(id) > 0;
+}
+
+void PrintHostJobQueue::priv::progress_fn(RunningJob &running, Http::Progress progress, bool &cancel)
 {
     if (cancel) {
         // When cancel is true from the start, Http indicates request has been cancelled
-        emit_cancel(job_id);
+        emit_cancel(running.id);
         return;
     }
 
-    if (bg_exit) {
+    if (bg_exit || consume_cancel(running.id)) {
         cancel = true;
         return;
     }
 
-    if (channel_cancels.size_hint() > 0) {
-        // Lock both queues
-        auto cancels = channel_cancels.lock_rw();
-        auto jobs = channel_jobs.lock_rw();
-
-        for (size_t cancel_id : *cancels) {
-            if (cancel_id == job_id) {
-                cancel = true;
-            } else if (cancel_id > job_id) {
-                const size_t idx = cancel_id - job_id - 1;
-                if (idx < jobs->size()) {
-                    jobs->at(idx).cancelled = true;
-                    BOOST_LOG_TRIVIAL(debug) << boost::format("PrintHostJobQueue: Job id %1% cancelled") % cancel_id;
-                    emit_cancel(cancel_id);
-                }
-            }
-        }
-
-        cancels->clear();
-    }
-
-    if (! cancel) {
-        int gui_progress = progress.ultotal > 0 ? 100*progress.ulnow / progress.ultotal : 0;
-        if (gui_progress != prev_progress) {
-            emit_progress(gui_progress);
-            prev_progress = gui_progress;
-        }
+    int gui_progress = progress.ultotal > 0 ? 100*progress.ulnow / progress.ultotal : 0;
+    if (gui_progress != running.prev_progress) {
+        emit_progress(running.id, gui_progress);
+        running.prev_progress = gui_progress;
     }
 }
 
-void PrintHostJobQueue::priv::error_fn(wxString error)
+void PrintHostJobQueue::priv::error_fn(RunningJob &running, wxString error)
 {
     // check if transfer was not canceled before error occured - than do not show the error
-    bool do_emit_err = true;
-    if (channel_cancels.size_hint() > 0) {
-        // Lock both queues
-        auto cancels = channel_cancels.lock_rw();
-        auto jobs = channel_jobs.lock_rw();
-
-        for (size_t cancel_id : *cancels) {
-            if (cancel_id == job_id) {
-                do_emit_err = false;
-                emit_cancel(job_id);
-            }
-            else if (cancel_id > job_id) {
-                const size_t idx = cancel_id - job_id - 1;
-                if (idx < jobs->size()) {
-                    jobs->at(idx).cancelled = true;
-                    BOOST_LOG_TRIVIAL(debug) << boost::format("PrintHostJobQueue: Job id %1% cancelled") % cancel_id;
-                    emit_cancel(cancel_id);
-                }
-            }
-        }
-        cancels->clear();
-    }
-    if (do_emit_err)
-        emit_error(std::move(error));
+    if (consume_cancel(running.id))
+        emit_cancel(running.id);
+    else
+        emit_error(running.id, std::move(error));
 }
 
-void PrintHostJobQueue::priv::info_fn(wxString tag, wxString status)
+void PrintHostJobQueue::priv::info_fn(RunningJob &running, wxString tag, wxString status)
 {
-    emit_info(tag, status);
+    emit_info(running.id, tag, status);
 }
 
 void PrintHostJobQueue::priv::remove_source(const fs::path &path)
@@ -299,37 +310,45 @@ void PrintHostJobQueue::priv::remove_source(const fs::path &path)
     }
 }
 
-void PrintHostJobQueue::priv::remove_source()
-{
-    remove_source(source_to_remove);
-    source_to_remove.clear();
-}
-
-void PrintHostJobQueue::priv::perform_job(PrintHostJob the_job)
+void PrintHostJobQueue::priv::perform_job(RunningJob &running, PrintHostJob the_job)
 {
-    emit_progress(0);   // Indicate the upload is starting
+    emit_progress(running.id, 0);   // Indicate the upload is starting
 
     bool success = the_job.printhost->upload(std::move(the_job.upload_data),
-        [this](Http::Progress progress, bool &cancel)   { this->progress_fn(std::move(progress), cancel); },
-        [this](wxString error)                          { this->error_fn(std::move(error)); },
-        [this](wxString tag, wxString host)             { this->info_fn(std::move(tag), std::move(host)); }
+        [this, &running](Http::Progress progress, bool &cancel)   { this->progress_fn(running, std::move(progress), cancel); },
+        [this, &running](wxString error)                          { this->error_fn(running, std::move(error)); },
+        [this, &running](wxString tag, wxString host)             { this->info_fn(running, std::move(tag), std::move(host)); }
     );
 
     if (success) {
-        emit_progress(100);
+        emit_progress(running.id, 100);
     }
 }
 
 void PrintHostJobQueue::enqueue(PrintHostJob job)
 {
-    p->start_bg_thread();
     p->queue_dialog->append_job(job);
-    p->channel_jobs.push(std::move(job));
+    std::lock_guard<std::mutex> lock(p->mutex);
+    p->jobs.push_back({ p->next_job_id ++, std::move(job) });
+    p->start_bg_threads();
+    p->condition.notify_all();
 }
 
 void PrintHostJobQueue::cancel(size_t id)
 {
-    p->channel_cancels.push(id);
+    std::lock_guard<std::mutex> lock(p->mutex);
+    if (auto it = std::find_if(p->jobs.begin(), p->jobs.end(), [id](const priv::QueuedJob &job) { return job.id == id; }); it != p->jobs.end()) {
+        // Not being uploaded yet.
+        if (! it->job.cancelled) {
+            it->job.cancelled = true;
+            BOOST_LOG_TRIVIAL(debug) << boost::format("PrintHostJobQueue: Job id %1% cancelled") % id;
+            p->emit_cancel(id);
+            // Let a background thread pick up the cancelled job to remove its source file.
+            p->condition.notify_all();
+        }
+    } else if (std::any_of(p->hosts_uploading.begin(), p->hosts_uploading.end(), [id](const auto &kvp) { return kvp.second == id; }))
+        // Being uploaded, the upload will be cancelled by progress_fn().
+        p->cancels.insert(id);
 }
 
 }
@@ -117,7 +117,8 @@ namespace GUI { class PrintHostQueueDialog; }
 class PrintHostJobQueue
 {
 public:
-    PrintHostJobQueue(GUI::PrintHostQueueDialog *queue_dialog);
+    // Up to max_concurrent_uploads jobs are uploaded concurrently, each of them to a different host.
+    PrintHostJobQueue(GUI::PrintHostQueueDialog *queue_dialog, size_t max_concurrent_uploads = 1);
     PrintHostJobQueue(const PrintHostJobQueue &) = delete;
     PrintHostJobQueue(PrintHostJobQueue &&other) = delete;
     ~PrintHostJobQueue();
@@ -5,9 +5,12 @@
 #include "UndoRedo.hpp"
 
 #include <algorithm>
+#include <array>
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <string_view>
+#include <unordered_map>
 #include <typeinfo> 
 #include <cassert>
 #include <cstddef>
@@ -29,6 +32,8 @@
 
 #include <boost/foreach.hpp>
 
+#include <miniz.h>
+
 #ifndef NDEBUG
 // #define SLIC3R_UNDOREDO_DEBUG
 #endif /* NDEBUG */
@@ -340,33 +345,200 @@ private:
 	std::string 				m_serialized;
 };
 
+// Content addressed storage of the serialized mutable objects, shared by the histories of all mutable objects of the stack.
+// The serialized data is split into chunks at content defined boundaries, so that a local edit of a large object
+// (for example of the painted facets of a ModelVolume) produces just a few new chunks. Chunks with the same content
+// are stored just once, shared by all the snapshots of all the objects.
+// If the Undo / Redo stack grows over its memory limit, the chunks get compressed before the snapshots are released.
+class ChunkStore
+{
+public:
+	struct Chunk
+	{
+		// Number of MutableHistoryInterval::Data referencing this chunk.
+		size_t		refcnt;
+		size_t		hash;
+		// Size of the uncompressed data.
+		size_t		size;
+		bool		compressed { false };
+		// Compression was already tried, successful or not.
+		bool		compression_tried { false };
+		std::string	data;
+
+		size_t 		memsize() const { return sizeof(Chunk) + data.size(); }
+	};
+	using Chunks = std::vector<Chunk*>;
+
+	~ChunkStore() { assert(m_chunks.empty()); }
+
+	// Split data into chunks, reference the chunks already stored or allocate new ones.
+	Chunks 		insert(const std::string &data);
+	// Release references to chunks returned by insert().
+	void 		release(const Chunks &chunks);
+	// Concatenate the uncompressed data of chunks.
+	static std::string load(const Chunks &chunks);
+	// Compress the chunks until at least mem_to_release bytes is released. Return the amount of memory released.
+	size_t 		compress_chunks(size_t mem_to_release);
+
+private:
+	static std::string decompress(const Chunk &chunk);
+
+	std::unordered_multimap<size_t, Chunk*> m_chunks;
+};
+
+// Table of random numbers for the gear rolling hash.
+static const std::array<uint64_t, 256>& gear_table()
+{
+	static const std::array<uint64_t, 256> table = []() {
+		std::array<uint64_t, 256> out;
+		// splitmix64
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (uint64_t &v : out) {
+			uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			v = z ^ (z >> 31);
+		}
+		return out;
+	}();
+	return table;
+}
+
+ChunkStore::Chunks ChunkStore::insert(const std::string &data)
+{
+	// Chunk boundaries are placed where the top 13 bits of the gear hash of the preceding 64 bytes are zero,
+	// producing 8kB chunks on average, limited to <2kB, 64kB>.
+	static constexpr size_t min_chunk_size = 2048;
+	static constexpr size_t max_chunk_size = 65536;
+	static constexpr int    boundary_bits  = 13;
+	const std::array<uint64_t, 256> &gear = gear_table();
+
+	Chunks out;
+	for (size_t begin = 0; begin < data.size();) {
+		size_t end = std::min(begin + min_chunk_size, data.size());
+		const size_t end_max = std::min(begin + max_chunk_size, data.size());
+		for (uint64_t h = 0; end < end_max; ++ end) {
+			h = (h << 1) + gear[(unsigned char)data[end]];
+			if ((h >> (64 - boundary_bits)) == 0)
+				break;
+		}
+		const std::string_view content(data.data() + begin, end - begin);
+		const size_t           hash = std::hash<std::string_view>()(content);
+		Chunk                 *chunk = nullptr;
+		for (auto [it, it_end] = m_chunks.equal_range(hash); it != it_end; ++ it)
+			if (it->second->size == content.size() && (it->second->compressed ? decompress(*it->second) == content : it->second->data == content)) {
+				chunk = it->second;
+				break;
+			}
+		if (chunk == nullptr) {
+			chunk = new Chunk{ 0, hash, content.size() };
+			chunk->data = std::string(content);
+			m_chunks.emplace(hash, chunk);
+		}
+		++ chunk->refcnt;
+		out.emplace_back(chunk);
+		begin = end;
+	}
+	return out;
+}
+
+void ChunkStore::release(const Chunks &chunks)
+{
+	for (Chunk *chunk : chunks)
+		if (-- chunk->refcnt == 0) {
+			for (auto [it, it_end] = m_chunks.equal_range(chunk->hash); it != it_end; ++ it)
+				if (it->second == chunk) {
+					m_chunks.erase(it);
+					break;
+				}
+			delete chunk;
+		}
+}
+
+std::string ChunkStore::load(const Chunks &chunks)
+{
+	std::string out;
+	size_t      size = 0;
+	for (const Chunk *chunk : chunks)
+		size += chunk->size;
+	out.reserve(size);
+	for (const Chunk *chunk : chunks)
+		out += chunk->compressed ? decompress(*chunk) : chunk->data;
+	return out;
+}
+
+size_t ChunkStore::compress_chunks(size_t mem_to_release)
+{
+	size_t mem_released = 0;
+	for (auto it = m_chunks.begin(); mem_released < mem_to_release && it != m_chunks.end(); ++ it) {
+		Chunk &chunk = *it->second;
+		if (chunk.compression_tried)
+			continue;
+		chunk.compression_tried = true;
+		std::string compressed(mz_compressBound(mz_ulong(chunk.size)), '\0');
+		mz_ulong    compressed_size = mz_ulong(compressed.size());
+		if (mz_compress2((unsigned char*)compressed.data(), &compressed_size, (const unsigned char*)chunk.data.data(), mz_ulong(chunk.size), MZ_BEST_SPEED) == MZ_OK &&
+			compressed_size < chunk.size) {
+			compressed.resize(compressed_size);
+			compressed.shrink_to_fit();
+			mem_released += chunk.data.size() - compressed.size();
+			chunk.data = std::move(compressed);
+			chunk.compressed = true;
+		}
+	}
+	return mem_released;
+}
+
+std::string ChunkStore::decompress(const Chunk &chunk)
+{
+	assert(chunk.compressed);
+	std::string out(chunk.size, '\0');
+	mz_ulong    size = mz_ulong(chunk.size);
+	if (mz_uncompress((unsigned char*)out.data(), &size, (const unsigned char*)chunk.data.data(), mz_ulong(chunk.data.size())) != MZ_OK || size != chunk.size)
+		throw Slic3r::RuntimeError("Undo / Redo stack: Failed to decompress snapshot data");
+	return out;
+}
+
 struct MutableHistoryInterval
 {
 private:
 	struct Data
 	{
-		// Reference counter of this data chunk. We may have used shared_ptr, but the shared_ptr is thread safe
+		// Reference counter of this data. We may have used shared_ptr, but the shared_ptr is thread safe
 		// with the associated cost of CPU cache invalidation on refcount change.
-		size_t		refcnt;
-		size_t		size;
-		char 		data[1];
+		size_t				refcnt;
+		// Size of the serialized data.
+		size_t				size;
+		// First 8 bytes of the serialized data, holding the timestamp of the objects serializing their timestamp first.
+		uint64_t			header;
+		ChunkStore		   &store;
+		ChunkStore::Chunks	chunks;
+
+		~Data() { store.release(chunks); }
 
-		// The serialized data matches the data stored here.
-		bool 		matches(const std::string& rhs) { return this->size == rhs.size() && memcmp(this->data, rhs.data(), this->size) == 0; }
+		// The serialized data split into chunks matches the data stored here.
+		bool 		matches(const ChunkStore::Chunks &rhs) const { return this->chunks == rhs; }
 
 		// The timestamp matches the timestamp serialized in the data stored here.
-		bool 		matches_timestamp(uint64_t timestamp) { assert(timestamp > 0);  assert(this->size > 8); return memcmp(this->data, &timestamp, 8) == 0; }
+		bool 		matches_timestamp(uint64_t timestamp) const { assert(timestamp > 0);  assert(this->size > 8); return this->header == timestamp; }
+
+		size_t		memsize() const {
+			size_t memsize = sizeof(Data) + this->chunks.capacity() * sizeof(ChunkStore::Chunk*);
+			// Count the memory of the chunks divided by the number of references, rounded up.
+			for (const ChunkStore::Chunk *chunk : this->chunks)
+				memsize += (chunk->memsize() + chunk->refcnt - 1) / chunk->refcnt;
+			return memsize;
+		}
 	};
 
 	Interval    m_interval;
 	Data	   *m_data;
 
 public:
-	MutableHistoryInterval(const Interval &interval, const std::string &input_data) : m_interval(interval), m_data(nullptr) {
-		m_data = (Data*)new char[offsetof(Data, data) + input_data.size()];
-		m_data->refcnt = 1;
-		m_data->size = input_data.size();
-		memcpy(m_data->data, input_data.data(), input_data.size());
+	MutableHistoryInterval(const Interval &interval, ChunkStore &store, ChunkStore::Chunks &&chunks, const std::string &input_data) : m_interval(interval), m_data(nullptr) {
+		uint64_t header = 0;
+		memcpy(&header, input_data.data(), std::min(input_data.size(), sizeof(header)));
+		m_data = new Data{ 1, input_data.size(), header, store, std::move(chunks) };
 	}
 
 	MutableHistoryInterval(const Interval &interval, MutableHistoryInterval &other) : m_interval(interval), m_data(other.m_data) {
@@ -381,7 +553,7 @@ public:
 
 	~MutableHistoryInterval() {
 		if (m_data != nullptr && -- m_data->refcnt == 0)
-			delete[] (char*)m_data;
+			delete m_data;
 	}
 
 	const Interval& interval() const { return m_interval; }
@@ -395,17 +567,19 @@ public:
 	bool		operator<(const MutableHistoryInterval& rhs) const { return m_interval < rhs.m_interval; }
 	bool 		operator==(const MutableHistoryInterval& rhs) const { return m_interval == rhs.m_interval; }
 
-	const char* data() const { return m_data->data; }
+	// Identity of the data shared by multiple intervals.
+	const void* data_id() const { return m_data; }
+	std::string data() const { return ChunkStore::load(m_data->chunks); }
 	size_t  	size() const { return m_data->size; }
 	size_t		refcnt() const { return m_data->refcnt; }
-	bool		matches(const std::string& data) { return m_data->matches(data); }
+	bool		matches(const ChunkStore::Chunks &chunks) { return m_data->matches(chunks); }
 	bool		matches_timestamp(uint64_t timestamp) { return m_data->matches_timestamp(timestamp); }
 	size_t 		memsize() const {
 		return m_data->refcnt == 1 ?
 			// Count just the size of the snapshot data.
-			m_data->size :
+			m_data->memsize() :
 			// Count the size of the snapshot data divided by the number of references, rounded up.
-			(m_data->size + m_data->refcnt - 1) / m_data->refcnt;
+			(m_data->memsize() + m_data->refcnt - 1) / m_data->refcnt;
 	}
 
 private:
@@ -460,24 +634,27 @@ public:
 		return false;
 	}
 
-	void save(size_t active_snapshot_time, size_t current_time, const std::string &data) {
+	void save(size_t active_snapshot_time, size_t current_time, ChunkStore &store, const std::string &data) {
 		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
+		ChunkStore::Chunks chunks = store.insert(data);
 		if (m_history.empty() || m_history.back().end() < active_snapshot_time) {
-			if (! m_history.empty() && m_history.back().matches(data))
+			if (! m_history.empty() && m_history.back().matches(chunks)) {
 				// Share the previous data by reference counting.
+				store.release(chunks);
 				m_history.emplace_back(Interval(current_time, current_time + 1), m_history.back());
-			else
+			} else
 				// Allocate new data.
-				m_history.emplace_back(Interval(current_time, current_time + 1), data);
+				m_history.emplace_back(Interval(current_time, current_time + 1), store, std::move(chunks), data);
 		} else {
 			assert(! m_history.empty());
 			assert(m_history.back().end() == active_snapshot_time);
-			if (m_history.back().matches(data))
+			if (m_history.back().matches(chunks)) {
 				// Just extend the last interval using the old data.
+				store.release(chunks);
 				m_history.back().extend_end(current_time + 1);
-			else
+			} else
 				// Allocate new data time continuous with the previous data.
-				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
+				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), store, std::move(chunks), data);
 		}
 	}
 
@@ -489,7 +666,7 @@ public:
 			-- it;
 		}
 		assert(timestamp >= it->begin() && timestamp < it->end());
-		return std::string(it->data(), it->data() + it->size());
+		return it->data();
 	}
 
 	// Currently all mutable snapshots are mandatory.
@@ -501,7 +678,7 @@ public:
 	std::string format() override {
 		std::string out = typeid(T).name();
 		for (const MutableHistoryInterval &interval : m_history)
-			out += std::string(", ptr:") + ptr_to_string(interval.data()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
+			out += std::string(", ptr:") + ptr_to_string(interval.data_id()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
 		return out;
 	}
 #endif /* SLIC3R_UNDOREDO_DEBUG */
@@ -531,16 +708,16 @@ bool MutableObjectHistory<T>::valid()
 {
 	// Verify that the history intervals are sorted and do not overlap, and that the data reference counters are correct.
 	if (! m_history.empty()) {
-		std::map<const char*, size_t> refcntrs;
-		assert(m_history.front().data() != nullptr);
-		++ refcntrs[m_history.front().data()];
+		std::map<const void*, size_t> refcntrs;
+		assert(m_history.front().data_id() != nullptr);
+		++ refcntrs[m_history.front().data_id()];
 		for (size_t i = 1; i < m_history.size(); ++ i) {
 			assert(m_history[i - 1].interval().strictly_before(m_history[i].interval()));
-			++ refcntrs[m_history[i].data()];
+			++ refcntrs[m_history[i].data_id()];
 		}
 		for (const auto &hi : m_history) {
-			assert(hi.data() != nullptr);
-			assert(refcntrs[hi.data()] == hi.refcnt());
+			assert(hi.data_id() != nullptr);
+			assert(refcntrs[hi.data_id()] == hi.refcnt());
 		}
 	}
 	return true;
@@ -677,6 +854,8 @@ private:
 	// Maximum memory allowed to be occupied by the Undo / Redo stack. If the limit is exceeded,
 	// least recently used snapshots will be released.
 	size_t 													m_memory_limit;
+	// Serialized data of the mutable objects, referenced from m_objects, thus it has to be destroyed after m_objects.
+	ChunkStore 												m_chunk_store;
 	// Each individual object (Model, ModelObject, ModelInstance, ModelVolume, Selection, TriangleMesh)
 	// is stored with its own history, referenced by the ObjectID. Immutable objects do not provide
 	// their own IDs, therefore there are temporary IDs generated for them and stored to m_shared_ptr_to_object_id.
@@ -846,7 +1025,7 @@ template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 			Slic3r::UndoRedo::OutputArchive archive(*this, oss);
 			archive(object);
 		}
-		object_history->save(m_active_snapshot_time, m_current_time, oss.str());
+		object_history->save(m_active_snapshot_time, m_current_time, m_chunk_store, oss.str());
 	}
 	return object.id();
 }
@@ -1128,7 +1307,12 @@ void StackImpl::release_least_recently_used()
 #ifdef SLIC3R_UNDOREDO_DEBUG
 	bool released = false;
 #endif
-	// First try to release the optional immutable data (for example the convex hulls),
+	// First try to compress the serialized mutable objects.
+	if (current_memsize > m_memory_limit) {
+		size_t mem_released = m_chunk_store.compress_chunks(current_memsize - m_memory_limit);
+		current_memsize = current_memsize > mem_released ? current_memsize - mem_released : 0;
+	}
+	// Then try to release the optional immutable data (for example the convex hulls),
 	// or the shared vertices of triangle meshes.
 	for (auto it = m_objects.begin(); current_memsize > m_memory_limit && it != m_objects.end();) {
 		const void *ptr = it->second->immutable_object_ptr();
@@ -7,6 +7,7 @@
 #include <libslic3r/Arrange/Core/ArrangeFirstFit.hpp>
 #include <libslic3r/Arrange/Core/NFP/PackStrategyNFP.hpp>
 #include <libslic3r/Arrange/Core/NFP/RectangleOverfitPackingStrategy.hpp>
+#include <libslic3r/Arrange/Core/Raster/PackStrategyRaster.hpp>
 
 #include <libslic3r/Arrange/Core/NFP/Kernels/GravityKernel.hpp>
 #include <libslic3r/Arrange/Core/NFP/Kernels/TMArrangeKernel.hpp>
@@ -1066,6 +1067,42 @@ TEMPLATE_TEST_CASE("Test if allowed item rotations are considered", "[arrange2]"
     REQUIRE(get_rotation(itm) == Approx(PI));
 }
 
+TEMPLATE_TEST_CASE("Raster packing strategy test", "[arrange2]",
+                   Slic3r::arr2::SimpleArrangeItem, Slic3r::arr2::ArrangeItem)
+{
+    using ArrItem = TestType;
+
+    namespace firstfit = Slic3r::arr2::firstfit;
+
+    auto bed = Slic3r::arr2::RectangleBed{scaled(100.), scaled(100.)};
+    auto item_blueprint = Slic3r::arr2::to_rectangle(
+        Slic3r::BoundingBox{{0, 0}, {scaled(20.), scaled(20.)}});
+
+    // 4x4 items fit into the bed even with the conservative rasterization
+    auto items = Slic3r::reserve_vector<ArrItem>(20);
+    std::generate_n(std::back_inserter(items), 20,
+                    [&item_blueprint] { return ArrItem{item_blueprint}; });
+
+    Slic3r::arr2::PackStrategyRaster pstrategy;
+    Slic3r::arr2::arrange(firstfit::SelectionStrategy<>{}, pstrategy,
+                          Slic3r::range(items), bed);
+
+    auto bedbb = bounding_box(bed);
+    for (size_t i = 0; i < items.size(); ++i) {
+        int bed_idx = get_bed_index(items[i]);
+        REQUIRE(bed_idx == (i < 16 ? 0 : 1));
+
+        auto itmbb = fixed_bounding_box(items[i]);
+        REQUIRE(bedbb.contains(itmbb.min));
+        REQUIRE(bedbb.contains(itmbb.max));
+
+        for (size_t j = 0; j < i; ++j)
+            if (get_bed_index(items[j]) == bed_idx)
+                REQUIRE(Slic3r::area(Slic3r::intersection(
+                            fixed_outline(items[i]), fixed_outline(items[j]))) == Approx(0.));
+    }
+}
+
 //TEST_CASE("NFP optimizing test", "[arrange2]") {
 //    using namespace Slic3r;
 
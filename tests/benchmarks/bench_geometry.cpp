@@ -0,0 +1,109 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/ExPolygon.hpp"
+#include "libslic3r/Flow.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/Surface.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+#include "libslic3r/Arachne/WallToolPaths.hpp"
+#include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Format/OBJ.hpp"
+
+using namespace Slic3r;
+
+// Grid of overlapping circles, the union of which is a single region full of holes.
+static Polygons overlapping_circles(int num_rows, double radius, double spacing)
+{
+    Polygons out;
+    for (int i = 0; i < num_rows; ++ i)
+        for (int j = 0; j < num_rows; ++ j) {
+            Polygon circle;
+            for (int k = 0; k < 64; ++ k) {
+                double angle = 2. * PI * k / 64.;
+                circle.points.emplace_back(scaled<coord_t>(i * spacing + radius * cos(angle)), scaled<coord_t>(j * spacing + radius * sin(angle)));
+            }
+            out.emplace_back(std::move(circle));
+        }
+    return out;
+}
+
+// Cross section of a mesh from tests/data at the given relative height.
+static ExPolygons test_mesh_section(const char *name, float relative_height)
+{
+    TriangleMesh mesh;
+    REQUIRE(load_obj((std::string(TEST_DATA_DIR) + "/" + name).c_str(), &mesh));
+    BoundingBoxf3 bbox = mesh.bounding_box();
+    MeshSlicingParamsEx params;
+    return slice_mesh_ex(mesh.its, { float(bbox.min.z() + relative_height * bbox.size().z()) }, params).front();
+}
+
+TEST_CASE("ClipperUtils", "[benchmark]")
+{
+    const Polygons   circles = overlapping_circles(40, 3., 4.);
+    const ExPolygons section = test_mesh_section("extruder_idler.obj", 0.5f);
+    const ExPolygons merged  = union_ex(circles);
+
+    BENCHMARK("union_ex of 1600 overlapping circles") {
+        return union_ex(circles);
+    };
+    BENCHMARK("offset_ex of merged circles") {
+        return offset_ex(merged, - float(scale_(0.2)));
+    };
+    BENCHMARK("offset2_ex of merged circles") {
+        return offset2_ex(merged, - float(scale_(0.5)), float(scale_(0.3)));
+    };
+    BENCHMARK("diff_ex of circles and a shifted copy") {
+        ExPolygons shifted = merged;
+        for (ExPolygon &expoly : shifted)
+            expoly.translate(scaled<coord_t>(1.), scaled<coord_t>(1.));
+        return diff_ex(merged, shifted);
+    };
+    BENCHMARK("offset_ex of extruder_idler section") {
+        return offset_ex(section, - float(scale_(0.45)));
+    };
+}
+
+TEST_CASE("Arachne WallToolPaths", "[benchmark]")
+{
+    const coord_t spacing = scaled<coord_t>(0.45);
+    for (const char *name : { "extruder_idler.obj", "ipadstand.obj", "frog_legs.obj" }) {
+        const Polygons polygons = to_polygons(test_mesh_section(name, 0.3f));
+        BENCHMARK(std::string("WallToolPaths ") + name) {
+            Arachne::WallToolPaths wall_tool_paths(polygons, spacing, spacing, 3, 0, 0.2, PrintObjectConfig::defaults(), PrintConfig::defaults());
+            wall_tool_paths.generate();
+            return wall_tool_paths.getToolPaths().size();
+        };
+    }
+    const Polygons circles = to_polygons(union_ex(overlapping_circles(20, 3., 4.)));
+    BENCHMARK("WallToolPaths of merged circles") {
+        Arachne::WallToolPaths wall_tool_paths(circles, spacing, spacing, 3, 0, 0.2, PrintObjectConfig::defaults(), PrintConfig::defaults());
+        wall_tool_paths.generate();
+        return wall_tool_paths.getToolPaths().size();
+    };
+}
+
+TEST_CASE("FillRectilinear", "[benchmark]")
+{
+    // 200x200mm square with a grid of holes.
+    ExPolygon expolygon(Polygon::new_scale({ {0, 0}, {200, 0}, {200, 200}, {0, 200} }));
+    for (Polygon &hole : overlapping_circles(20, 3., 10.)) {
+        hole.translate(scaled<coord_t>(5.), scaled<coord_t>(5.));
+        hole.reverse();
+        expolygon.holes.emplace_back(std::move(hole));
+    }
+    const Flow flow(0.45f, 0.2f, 0.4f);
+    for (const double density : { 0.15, 1. }) {
+        BENCHMARK("rectilinear " + std::to_string(int(density * 100.)) + "%") {
+            std::unique_ptr<Fill> filler(Fill::new_from_type("rectilinear"));
+            filler->bounding_box = get_extents(expolygon);
+            filler->angle        = float(PI / 4.);
+            filler->spacing      = flow.spacing();
+            FillParams fill_params;
+            fill_params.density = float(density);
+            Surface surface(stInternal, expolygon);
+            return filler->fill_surface(&surface, fill_params);
+        };
+    }
+}
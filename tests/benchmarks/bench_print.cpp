@@ -0,0 +1,159 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/Format/3mf.hpp"
+#include "libslic3r/Format/STL.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/Profiler.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+TEST_CASE("Print::process", "[benchmark]")
+{
+    for (const char *style : { "grid", "organic" }) {
+        BENCHMARK(std::string("overhang with ") + style + " supports") {
+            Print print;
+            Model model;
+            init_print({ TestMesh::overhang }, print, model, {
+                { "support_material",       true },
+                { "support_material_style", style },
+                { "layer_height",           0.1 }
+            });
+            print.process();
+            return print.objects().front()->support_layers().size();
+        };
+    }
+    BENCHMARK("ipadstand without supports") {
+        Print print;
+        Model model;
+        init_print({ TestMesh::ipadstand }, print, model, { { "layer_height", 0.1 } });
+        print.process();
+        return print.objects().front()->layers().size();
+    };
+}
+
+TEST_CASE("Print::process memory", "[benchmark]")
+{
+    // Memory accounted for each slicing step. The allocations are only counted if compiled with SLIC3R_PROFILE_ALLOCATIONS,
+    // the counters are process wide, thus the steps of objects processed concurrently account each other's allocations.
+    Print print;
+    Model model;
+    init_print({ TestMesh::ipadstand, TestMesh::overhang }, print, model, {
+        { "support_material", true },
+        { "layer_height",     0.1 }
+    });
+    std::mutex                                 mutex;
+    std::map<std::string, Profiler::StepMemory> steps;
+    print.set_step_callback([&mutex, &steps](const char *step, const PrintObjectBase *, double, const Profiler::StepMemory &memory) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Profiler::StepMemory &dst = steps[step];
+        dst.allocations       += memory.allocations;
+        dst.allocated_bytes   += memory.allocated_bytes;
+        dst.peak_rss           = std::max(dst.peak_rss, memory.peak_rss);
+        dst.peak_rss_increase += memory.peak_rss_increase;
+    });
+    Profiler::set_enabled(true);
+    Profiler::clear();
+    print.process();
+    Profiler::set_enabled(false);
+
+    for (const auto &[step, memory] : steps)
+        WARN(step << ": " << memory.allocations << " allocations, " << (memory.allocated_bytes >> 10) << " kB allocated, peak RSS increase "
+                  << (memory.peak_rss_increase >> 10) << " kB");
+    CHECK(! steps.empty());
+    if (Profiler::allocations_counted())
+        CHECK(steps["Slice"].allocations > 0);
+}
+
+TEST_CASE("Print::cancel latency", "[benchmark]")
+{
+    // Time from Print::cancel() until Print::process() unwinds with CanceledException.
+    // The cancel is issued at various times to hit the different slicing steps.
+    using clock = std::chrono::steady_clock;
+    constexpr auto max_latency = std::chrono::milliseconds(200);
+    for (const char *perimeter_generator : { "classic", "arachne" }) {
+        clock::duration worst_latency = clock::duration::zero();
+        for (int delay_ms : { 10, 50, 100, 200, 400, 800 }) {
+            Print print;
+            Model model;
+            init_print({ TestMesh::ipadstand, TestMesh::overhang }, print, model, {
+                { "support_material",     true },
+                { "layer_height",         0.1 },
+                { "perimeter_generator",  perimeter_generator }
+            });
+            std::atomic<clock::rep> canceled_at { 0 };
+            std::thread canceler([&print, &canceled_at, delay_ms]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+                canceled_at = clock::now().time_since_epoch().count();
+                print.cancel();
+            });
+            bool canceled = false;
+            try {
+                print.process();
+            } catch (const CanceledException &) {
+                canceled = true;
+            }
+            clock::time_point finished = clock::now();
+            canceler.join();
+            if (canceled)
+                worst_latency = std::max(worst_latency, finished - clock::time_point(clock::duration(canceled_at.load())));
+        }
+        auto worst_ms = std::chrono::duration_cast<std::chrono::milliseconds>(worst_latency);
+        WARN(perimeter_generator << " perimeters: worst cancel latency " << worst_ms.count() << " ms");
+        CHECK(worst_ms <= max_latency);
+    }
+}
+
+TEST_CASE("GCodeProcessor", "[benchmark]")
+{
+    // Export G-code of a print once, then benchmark parsing of it.
+    Print print;
+    Model model;
+    init_print({ TestMesh::ipadstand, TestMesh::overhang }, print, model, {
+        { "support_material", true },
+        { "layer_height",     0.1 }
+    });
+    print.process();
+    boost::filesystem::path temp = boost::filesystem::unique_path();
+    print.export_gcode(temp.string(), nullptr, nullptr);
+
+    BENCHMARK("process_file") {
+        GCodeProcessor processor;
+        processor.process_file(temp.string());
+        return processor.get_result().moves.size();
+    };
+    boost::filesystem::remove(temp);
+}
+
+TEST_CASE("3MF", "[benchmark]")
+{
+    Model src_model;
+    REQUIRE(load_stl((std::string(TEST_DATA_DIR) + "/test_3mf/Prusa.stl").c_str(), &src_model));
+    src_model.add_default_instances();
+    boost::filesystem::path temp = boost::filesystem::unique_path("%%%%-%%%%-%%%%.3mf");
+    REQUIRE(store_3mf(temp.string().c_str(), &src_model, nullptr, false));
+
+    BENCHMARK("load_3mf") {
+        Model                     model;
+        DynamicPrintConfig        config;
+        ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+        load_3mf(temp.string().c_str(), config, ctxt, &model, false);
+        return model.objects.size();
+    };
+    BENCHMARK("store_3mf") {
+        return store_3mf(temp.string().c_str(), &src_model, nullptr, false);
+    };
+    boost::filesystem::remove(temp);
+}
@@ -0,0 +1,47 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+#include "libslic3r/Format/OBJ.hpp"
+
+using namespace Slic3r;
+
+static TriangleMesh load_test_mesh(const char *name)
+{
+    TriangleMesh mesh;
+    REQUIRE(load_obj((std::string(TEST_DATA_DIR) + "/" + name).c_str(), &mesh));
+    return mesh;
+}
+
+// Slicing planes at the middle of layers of the given height, spanning the whole mesh.
+static std::vector<float> slicing_planes(const indexed_triangle_set &its, float layer_height)
+{
+    BoundingBoxf3 bbox = bounding_box(its);
+    std::vector<float> zs;
+    for (double z = bbox.min.z() + 0.5 * layer_height; z < bbox.max.z(); z += layer_height)
+        zs.emplace_back(float(z));
+    return zs;
+}
+
+TEST_CASE("slice_mesh", "[benchmark]")
+{
+    struct Input {
+        std::string             name;
+        indexed_triangle_set    its;
+    };
+    std::vector<Input> inputs;
+    for (const char *name : { "extruder_idler.obj", "ipadstand.obj", "frog_legs.obj" })
+        inputs.push_back({ name, load_test_mesh(name).its });
+    // Large synthetic meshes: a finely tessellated sphere and a tall cylinder.
+    inputs.push_back({ "sphere_100mm_fine", its_make_sphere(50., PI / 360.) });
+    inputs.push_back({ "cylinder_200mm_tall", its_make_cylinder(20., 200., PI / 720.) });
+
+    MeshSlicingParams params;
+    for (const Input &input : inputs)
+        for (const float layer_height : { 0.2f, 0.05f }) {
+            std::vector<float> zs = slicing_planes(input.its, layer_height);
+            BENCHMARK(input.name + " @ " + std::to_string(layer_height) + "mm") {
+                return slice_mesh(input.its, zs, params);
+            };
+        }
+}
@@ -13,4 +13,12 @@ SCENARIO("Avoid crossing perimeters", "[AvoidCrossingPerimeters]") {
             REQUIRE(! gcode.empty());
         }
     }
+	WHEN("Two 20mm cubes printed sequentially") {
+        std::string gcode = Slic3r::Test::slice(
+    	    { Slic3r::Test::TestMesh::cube_20x20x20, Slic3r::Test::TestMesh::cube_20x20x20 },
+            { { "avoid_crossing_perimeters", true }, { "complete_objects", true } });
+        THEN("gcode not empty") {
+            REQUIRE(! gcode.empty());
+        }
+    }
 }
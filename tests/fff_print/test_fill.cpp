@@ -7,6 +7,8 @@
 
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Fill/FillPlanePath.hpp"
+#include "libslic3r/Fill/FillRectilinear.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Layer.hpp"
 #include "libslic3r/Geometry.hpp"
@@ -198,6 +200,79 @@ TEST_CASE("Fill: Pattern Path Length", "[Fill]") {
     }
 }
 
+TEST_CASE("Fill: rectilinear fills shared by layers", "[Fill]") {
+    ExPolygon expolygon;
+    expolygon.contour = Polygon::new_scale({ {0, 0}, {60, 0}, {60, 10}, {10, 10}, {10, 60}, {0, 60} });
+    const Surface surface(stInternal, expolygon);
+
+    // The grid based patterns are not used for solid infill.
+    for (auto [pattern, density] : std::initializer_list<std::pair<const char*, float>>{
+            { "rectilinear", 0.2f }, { "rectilinear", 1.f }, { "monotonic", 1.f }, { "grid", 0.2f }, { "cubic", 0.2f } }) {
+        FillLinesCache cache;
+        auto fill = [&surface, pattern = pattern, density = density](size_t layer_id, FillLinesCache *cache) {
+            std::unique_ptr<Fill> filler(Fill::new_from_type(pattern));
+            filler->angle    = float(M_PI / 4.);
+            filler->spacing  = 0.45;
+            filler->layer_id = layer_id;
+            filler->z        = 0.2 * double(layer_id + 1);
+            dynamic_cast<FillRectilinear*>(filler.get())->fill_lines_cache = cache;
+            FillParams params;
+            params.density     = density;
+            params.dont_adjust = false;
+            Polylines polylines = filler->fill_surface(&surface, params);
+            return std::make_pair(polylines, filler->spacing);
+        };
+        // The second pass is served from the cache, the layers alternate the infill direction.
+        for (int pass = 0; pass < 2; ++ pass)
+            for (size_t layer_id = 0; layer_id < 5; ++ layer_id) {
+                INFO("Pattern " << pattern << ", density " << density << ", pass " << pass << ", layer " << layer_id);
+                auto uncached = fill(layer_id, nullptr);
+                auto cached   = fill(layer_id, &cache);
+                REQUIRE(! uncached.first.empty());
+                REQUIRE(cached.first == uncached.first);
+                REQUIRE(cached.second == uncached.second);
+            }
+    }
+}
+
+TEST_CASE("Fill: plane path curves shared by layers", "[Fill]") {
+    ExPolygon expolygon;
+    expolygon.contour = Polygon::new_scale({ {0, 0}, {60, 0}, {60, 10}, {10, 10}, {10, 60}, {0, 60} });
+    expolygon.holes.emplace_back(Polygon::new_scale({ {3, 3}, {3, 7}, {7, 7}, {7, 3} }));
+    const Surface surface(stInternal, expolygon);
+
+    for (const char *pattern : { "hilbertcurve", "archimedeanchords", "octagramspiral" })
+        for (float density : { 0.2f, 1.f }) {
+            FillLinesCache cache;
+            auto fill = [&surface, pattern, density](size_t layer_id, FillLinesCache *cache) {
+                std::unique_ptr<Fill> filler(Fill::new_from_type(pattern));
+                filler->spacing      = 0.45;
+                filler->layer_id     = layer_id;
+                filler->z            = 0.2 * double(layer_id + 1);
+                // The sparse infill is aligned to the object bounding box.
+                filler->bounding_box = BoundingBox(Point::new_scale(-10, -10), Point::new_scale(100, 80));
+                dynamic_cast<FillPlanePath*>(filler.get())->fill_lines_cache = cache;
+                FillParams params;
+                params.density     = density;
+                params.dont_adjust = false;
+                return filler->fill_surface(&surface, params);
+            };
+            const double spacing = scaled<double>(0.45) / density;
+            const Polygons grown = offset(expolygon, float(SCALED_EPSILON));
+            for (int pass = 0; pass < 2; ++ pass)
+                for (size_t layer_id = 0; layer_id < 3; ++ layer_id) {
+                    INFO("Pattern " << pattern << ", density " << density << ", pass " << pass << ", layer " << layer_id);
+                    Polylines uncached = fill(layer_id, nullptr);
+                    Polylines cached   = fill(layer_id, &cache);
+                    REQUIRE(! uncached.empty());
+                    REQUIRE(cached == uncached);
+                    // The curve is clipped by the surface and it covers the surface.
+                    REQUIRE(diff_pl(cached, grown).empty());
+                    REQUIRE(total_length(cached) == Approx(expolygon.area() / spacing).epsilon(0.15));
+                }
+        }
+}
+
 SCENARIO("Infill does not exceed perimeters", "[Fill]") 
 {
     auto test = [](const std::string_view pattern) {
@@ -548,6 +623,36 @@ SCENARIO("Infill density zero", "[Fill]")
     }
 }
 
+SCENARIO("Adaptive and support cubic infill", "[Fill]")
+{
+    for (const char *pattern : { "adaptivecubic", "supportcubic" }) {
+        WHEN("20mm cube is sliced with "s + pattern + " infill") {
+            DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+            config.set_deserialize_strict({
+                { "skirts",                         0 },
+                { "fill_pattern",                   pattern },
+                { "fill_density",                   "20%" },
+                { "infill_extruder",                2 },
+                { "nozzle_diameter",                "0.4,0.4" }
+            });
+
+            std::string gcode = Slic3r::Test::slice({ Slic3r::Test::TestMesh::cube_20x20x20 }, config);
+            THEN("sparse infill is extruded") {
+                GCodeReader parser;
+                int         tool = -1;
+                size_t      infill_moves = 0;
+                parser.parse_buffer(gcode, [&tool, &infill_moves](Slic3r::GCodeReader &self, const Slic3r::GCodeReader::GCodeLine &line) {
+                    if (boost::starts_with(line.cmd(), "T"))
+                        tool = atoi(line.cmd().data() + 1) + 1;
+                    else if (tool == 2 && line.cmd() == "G1" && line.extruding(self) && line.dist_XY(self) > 0)
+                        ++ infill_moves;
+                });
+                REQUIRE(infill_moves > 0);
+            }
+        }
+    }
+}
+
 /*
 {
     # GH: #2697
@@ -2,7 +2,11 @@
 
 #include <memory>
 
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCodeReader.hpp"
 
 using namespace Slic3r;
 
@@ -20,3 +24,66 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+TEST_CASE("Parallel G-code file parsing matches serial parsing", "[GCodeReader]") {
+    // Enough lines to span multiple blocks of the parallel reader, with various line endings.
+    std::string gcode;
+    for (int i = 0; i < 400000; ++ i) {
+        gcode += "G1 X" + std::to_string(i % 200) + ".5 Y" + std::to_string(i % 97) + " E0.0" + std::to_string(i % 10) + " ; line " + std::to_string(i);
+        gcode += (i % 3 == 0) ? "\r\n" : "\n";
+        if (i % 1000 == 0)
+            gcode += "\n";
+    }
+    gcode += "G92 E0";
+    boost::filesystem::path path = boost::filesystem::unique_path();
+    {
+        FILE *f = boost::nowide::fopen(path.string().c_str(), "wb");
+        REQUIRE(f != nullptr);
+        fwrite(gcode.data(), 1, gcode.size(), f);
+        fclose(f);
+    }
+    auto collect = [](std::vector<std::string> &lines, std::vector<float> &xs) {
+        return [&lines, &xs](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+            lines.emplace_back(line.raw());
+            xs.emplace_back(reader.x());
+        };
+    };
+    std::vector<std::string>         lines_serial, lines_parallel;
+    std::vector<float>               xs_serial, xs_parallel;
+    std::vector<std::vector<size_t>> lines_ends_serial;
+    std::vector<size_t>              lines_ends_parallel;
+    GCodeReader reader_serial, reader_parallel;
+    REQUIRE(reader_serial.parse_file(path.string(), collect(lines_serial, xs_serial), lines_ends_serial));
+    REQUIRE(reader_parallel.parse_file_parallel(path.string(), collect(lines_parallel, xs_parallel), &lines_ends_parallel));
+    boost::filesystem::remove(path);
+
+    REQUIRE(lines_serial.size() == lines_parallel.size());
+    CHECK(lines_serial == lines_parallel);
+    CHECK(xs_serial == xs_parallel);
+    CHECK(lines_ends_serial.front() == lines_ends_parallel);
+}
+
+TEST_CASE("Tokenized G-code lines reference the source buffer", "[GCodeReader]") {
+    const std::string gcode = "G1 X1 Y2 ; move\nG1 Z0.3\n\nM104 S200\n";
+    GCodeReader reader;
+    std::vector<GCodeReader::GCodeLine> lines;
+    reader.tokenize_buffer(gcode, lines);
+    REQUIRE(lines.size() == 4);
+    for (const GCodeReader::GCodeLine &line : lines)
+        CHECK((line.raw().data() >= gcode.data() && line.raw().data() + line.raw().size() <= gcode.data() + gcode.size()));
+    CHECK(lines[0].raw() == "G1 X1 Y2 ; move");
+    CHECK(lines[0].comment() == " move");
+    CHECK(lines[1].cmd() == "G1");
+    CHECK(lines[2].raw().empty());
+    CHECK(lines[3].cmd_is("M104"));
+
+    GCodeReader::GCodeLine modified = lines[1];
+    modified.set(reader, Z, 0.5f);
+    // The modified line owns its text, the source line is left intact.
+    CHECK(modified.raw() == "G1 Z0.500");
+    CHECK(lines[1].raw() == "G1 Z0.3");
+    GCodeReader::GCodeLine copy = modified;
+    modified.set(reader, X, 1.f);
+    CHECK(copy.raw() == "G1 Z0.500");
+    CHECK(copy.value(Z) == 0.5f);
+}
@@ -48,6 +48,29 @@ SCENARIO("Find/Replace with plain text", "[GCodeFindReplace]") {
             GCodeFindReplace find_replace({ "move UP", "move down", "", "" });
             REQUIRE(find_replace.process_layer(gcode) == gcode);
         }
+        WHEN("Multiple plain substitutions") {
+            GCodeFindReplace find_replace({ "move up", "move down", "", "", "WIPE", "retract", "i", "", "X13 ", "X14 ", "", "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "G1 Z0; home\n"
+                // substituted
+                "G1 Z1; move down\n"
+                "G1 X0 Y1 Z1; perimeter\n"
+                // substituted
+                "G1 X14 Y32 Z1; infill\n"
+                // substituted
+                "G1 X14 Y32 Z1; retract\n");
+        }
+        WHEN("Plain substitution replacing the output of the preceding one") {
+            GCodeFindReplace find_replace({ "move up", "move down", "", "", "down", "home", "", "", "home", "park", "", "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                // substituted
+                "G1 Z0; park\n"
+                // substituted
+                "G1 Z1; move park\n"
+                "G1 X0 Y1 Z1; perimeter\n"
+                "G1 X13 Y32 Z1; infill\n"
+                "G1 X13 Y32 Z1; wipe\n");
+        }
 
         // Whole word
         WHEN("Replace \"move up\" with \"move down\", whole word") {
@@ -94,3 +94,30 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+SCENARIO("GCodeFormatter emits fixed-point values without redundant zeros.", "[GCodeWriter]") {
+    auto format = [](const char axis, double v, size_t digits) {
+        GCodeG1Formatter w;
+        w.emit_axis(axis, v, digits);
+        return w.string();
+    };
+    THEN("Integer part is omitted if zero") {
+        REQUIRE_THAT(format('E', 0.00512, GCodeFormatter::E_EXPORT_DIGITS), Catch::Equals("G1 E.00512\n"));
+        REQUIRE_THAT(format('E', -0.8, GCodeFormatter::E_EXPORT_DIGITS), Catch::Equals("G1 E-.8\n"));
+    }
+    THEN("Trailing zeros are omitted") {
+        REQUIRE_THAT(format('X', 120.5, GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 X120.5\n"));
+        REQUIRE_THAT(format('Y', -120.0004, GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 Y-120\n"));
+    }
+    THEN("Zero is emitted as 0") {
+        REQUIRE_THAT(format('Z', 0., GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 Z0\n"));
+        REQUIRE_THAT(format('Z', -0.0001, GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 Z0\n"));
+    }
+    THEN("Line is appended to a string") {
+        std::string out = "G1 F1200\n";
+        GCodeG1Formatter w;
+        w.emit_xy(Vec2d(1.25, 2.));
+        w.append_to(out);
+        REQUIRE_THAT(out, Catch::Equals("G1 F1200\nG1 X1.25 Y2\n"));
+    }
+}
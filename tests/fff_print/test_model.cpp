@@ -63,3 +63,27 @@ SCENARIO("Model construction", "[Model]") {
         }
     }
 }
+
+SCENARIO("Model shares identical meshes", "[Model]") {
+    GIVEN("A Model with two objects of the same geometry and one of a different geometry") {
+        Slic3r::Model model;
+        model.add_object()->add_volume(Slic3r::make_cube(20, 20, 20));
+        model.add_object()->add_volume(Slic3r::make_cube(20, 20, 20));
+        model.add_object()->add_volume(Slic3r::make_cube(10, 20, 20));
+        const ModelVolume &v1 = *model.objects[0]->volumes.front();
+        const ModelVolume &v2 = *model.objects[1]->volumes.front();
+        const ModelVolume &v3 = *model.objects[2]->volumes.front();
+        REQUIRE(v1.mesh_ptr() != v2.mesh_ptr());
+        WHEN("Identical meshes are shared") {
+            size_t num_shared = model.share_identical_meshes();
+            THEN("Only the volume of the same geometry is re-pointed") {
+                REQUIRE(num_shared == 1);
+                REQUIRE(v1.mesh_ptr() == v2.mesh_ptr());
+                REQUIRE(v1.mesh_ptr() != v3.mesh_ptr());
+            }
+            THEN("Sharing again does not change anything") {
+                REQUIRE(model.share_identical_meshes() == 0);
+            }
+        }
+    }
+}
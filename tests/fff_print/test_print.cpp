@@ -1,7 +1,10 @@
 #include <catch2/catch.hpp>
 
+#include <boost/filesystem.hpp>
+
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
+#include "libslic3r/PrintObjectCache.hpp"
 #include "libslic3r/Layer.hpp"
 
 #include "test_data.hpp"
@@ -30,6 +33,61 @@ SCENARIO("PrintObject: Perimeter generation", "[PrintObject]") {
     }
 }
 
+SCENARIO("PrintObject: Layers restored from the slicing cache", "[PrintObject]") {
+    GIVEN("20mm cube sliced with a slicing cache") {
+        boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        PrintObjectCache::set_directory(dir.string());
+        Slic3r::Print print1;
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print1, { { "fill_density", "20%" } });
+        WHEN("the cube is sliced again with different custom G-code") {
+            Slic3r::Print print2;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print2, { { "fill_density", "20%" }, { "start_gcode", ";START" } });
+            PrintObjectCache::set_directory(std::string());
+            boost::filesystem::remove_all(dir);
+            const PrintObject &object1 = *print1.objects().front();
+            const PrintObject &object2 = *print2.objects().front();
+            THEN("the same layers are produced") {
+                REQUIRE(object1.layers().size() == object2.layers().size());
+                for (size_t i = 0; i < object1.layers().size(); ++ i) {
+                    const Layer &layer1 = *object1.layers()[i];
+                    const Layer &layer2 = *object2.layers()[i];
+                    REQUIRE(layer1.print_z == layer2.print_z);
+                    REQUIRE(layer1.lslices == layer2.lslices);
+                    REQUIRE(layer1.lslices_ex.size() == layer2.lslices_ex.size());
+                    REQUIRE(layer1.regions().front()->perimeters().items_count() == layer2.regions().front()->perimeters().items_count());
+                    REQUIRE(layer1.regions().front()->fills().items_count() == layer2.regions().front()->fills().items_count());
+                }
+            }
+            THEN("G-code is generated") {
+                REQUIRE(! Slic3r::Test::gcode(print2).empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Print: Changing supports of one object keeps supports of the others", "[Print]") {
+    GIVEN("Two objects with organic supports") {
+        auto config = Slic3r::DynamicPrintConfig::full_print_config_with({
+            { "support_material",       true },
+            { "support_material_style", "organic" }
+        });
+        Print print;
+        Model model;
+        Slic3r::Test::init_print({ TestMesh::overhang, TestMesh::overhang }, print, model, config);
+        print.process();
+        REQUIRE(print.objects().size() == 2);
+        WHEN("support settings of the second object change") {
+            Model model2(model);
+            model2.objects.back()->config.set_deserialize_strict("support_tree_branch_diameter", "3");
+            print.apply(model2, config);
+            THEN("only supports of the second object are invalidated") {
+                REQUIRE(print.objects().front()->is_step_done(posSupportMaterial));
+                REQUIRE(! print.objects().back()->is_step_done(posSupportMaterial));
+            }
+        }
+    }
+}
+
 SCENARIO("Print: Skirt generation", "[Print]") {
     GIVEN("20mm cube and default config") {
         WHEN("Skirts is set to 2 loops")  {
@@ -2,6 +2,7 @@
 
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCode/SeamPlacer.hpp"
 
 #include "test_data.hpp"
 
@@ -269,3 +270,70 @@ SCENARIO( "PrintGCode basic functionality", "[PrintGCode]") {
         }
     }
 }
+
+SCENARIO("PrintGCode reuses the layers of the previous export", "[PrintGCode]") {
+    GIVEN("A sliced cube exported with an end G-code") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config_with({
+            { "gcode_comments",     true },
+            { "end_gcode",          "; END OF PRINT A" }
+        });
+        Slic3r::Test::init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+        std::string gcode_a = Slic3r::Test::gcode(print);
+        WHEN("only the end G-code is changed and the print is exported again") {
+            config.set_deserialize_strict({ { "end_gcode", "; END OF PRINT B" } });
+            print.apply(model, config);
+            std::string gcode_b = Slic3r::Test::gcode(print);
+            THEN("the G-code up to the end G-code is the same") {
+                // Skip the first line, which contains the time stamp.
+                auto layers = [](const std::string &gcode, const std::string &end_gcode) {
+                    size_t begin = gcode.find('\n');
+                    size_t end   = gcode.find(end_gcode);
+                    REQUIRE(end != std::string::npos);
+                    return gcode.substr(begin, end - begin);
+                };
+                REQUIRE(layers(gcode_a, "; END OF PRINT A") == layers(gcode_b, "; END OF PRINT B"));
+            }
+        }
+    }
+}
+
+SCENARIO("PrintGCode reuses the seam data of the previous export", "[PrintGCode]") {
+    GIVEN("A sliced cube exported with aligned seams") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config_with({
+            { "seam_position",      "aligned" }
+        });
+        Slic3r::Test::init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+        Slic3r::Test::gcode(print);
+        std::shared_ptr<PrintObjectSeamData> seam_data = print.objects().front()->seam_data();
+        REQUIRE(seam_data);
+        WHEN("the travel speed is changed and the print is exported again") {
+            config.set_deserialize_strict({ { "travel_speed", "123" } });
+            print.apply(model, config);
+            Slic3r::Test::gcode(print);
+            THEN("the seam data is reused") {
+                REQUIRE(print.objects().front()->seam_data() == seam_data);
+            }
+        }
+        WHEN("the seam position is changed and the print is exported again") {
+            config.set_deserialize_strict({ { "seam_position", "rear" } });
+            print.apply(model, config);
+            Slic3r::Test::gcode(print);
+            THEN("the seam data is recalculated") {
+                REQUIRE(print.objects().front()->seam_data() != seam_data);
+                REQUIRE(print.objects().front()->seam_data()->seam_position == spRear);
+            }
+        }
+        WHEN("the perimeters are changed and the print is exported again") {
+            config.set_deserialize_strict({ { "perimeters", "4" } });
+            print.apply(model, config);
+            Slic3r::Test::gcode(print);
+            THEN("the seam data is recalculated") {
+                REQUIRE(print.objects().front()->seam_data() != seam_data);
+            }
+        }
+    }
+}
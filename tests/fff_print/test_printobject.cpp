@@ -87,3 +87,84 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject]") {
 #endif
     }
 }
+
+SCENARIO("PrintObject: re-slicing with changed layer height", "[PrintObject]") {
+    GIVEN("A pyramid sliced with 0.3mm layers") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config_with({
+            { "first_layer_height", 0.3 },
+            { "layer_height",       0.3 }
+        });
+        Slic3r::Test::init_print({ TestMesh::pyramid }, print, model, config);
+        print.process();
+        WHEN("the layer height is changed to 0.15mm and the object is sliced again") {
+            config.set_deserialize_strict({ { "layer_height", 0.15 } });
+            print.apply(model, config);
+            print.process();
+            Slic3r::Print print_ref;
+            Slic3r::Model model_ref;
+            Slic3r::Test::init_print({ TestMesh::pyramid }, print_ref, model_ref, config);
+            print_ref.process();
+            THEN("the slices match the slices of a freshly sliced object") {
+                SpanOfConstPtrs<Layer> layers     = print.objects().front()->layers();
+                SpanOfConstPtrs<Layer> layers_ref = print_ref.objects().front()->layers();
+                REQUIRE(layers.size() == layers_ref.size());
+                for (size_t i = 0; i < layers.size(); ++ i) {
+                    REQUIRE(layers[i]->slice_z == Approx(layers_ref[i]->slice_z));
+                    REQUIRE(layers[i]->lslices == layers_ref[i]->lslices);
+                }
+            }
+        }
+    }
+}
+
+// Number of the ironing paths over all layers and the number of the ironing fill ranges of the layer islands.
+static std::pair<size_t, size_t> count_ironing(const PrintObject &object)
+{
+    size_t num_paths  = 0;
+    size_t num_ranges = 0;
+    for (const Layer *layer : object.layers()) {
+        for (const LayerRegion *layerm : layer->regions())
+            for (const ExtrusionEntity *ee : layerm->fills().entities)
+                if (ee->role() == ExtrusionRole::Ironing)
+                    num_paths += static_cast<const ExtrusionEntityCollection*>(ee)->entities.size();
+        for (const LayerSlice &lslice : layer->lslices_ex)
+            for (const LayerIsland &island : lslice.islands)
+                num_ranges += island.fills.size();
+    }
+    return { num_paths, num_ranges };
+}
+
+SCENARIO("PrintObject: re-ironing with changed ironing spacing", "[PrintObject]") {
+    GIVEN("A 20mm cube ironed with 0.1mm spacing") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config_with({
+            { "ironing",         true },
+            { "ironing_spacing", 0.1 }
+        });
+        Slic3r::Test::init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+        print.process();
+        WHEN("the ironing spacing is changed to 0.2mm") {
+            config.set_deserialize_strict({ { "ironing_spacing", 0.2 } });
+            print.apply(model, config);
+            const PrintObject &object = *print.objects().front();
+            THEN("the infill is kept") {
+                REQUIRE(object.is_step_done(posInfill));
+                REQUIRE(! object.is_step_done(posIroning));
+            }
+            print.process();
+            Slic3r::Print print_ref;
+            Slic3r::Model model_ref;
+            Slic3r::Test::init_print({ TestMesh::cube_20x20x20 }, print_ref, model_ref, config);
+            print_ref.process();
+            THEN("the ironing matches the ironing of a freshly sliced object") {
+                std::pair<size_t, size_t> ironing     = count_ironing(object);
+                std::pair<size_t, size_t> ironing_ref = count_ironing(*print_ref.objects().front());
+                REQUIRE(ironing.first > 0);
+                REQUIRE(ironing == ironing_ref);
+            }
+        }
+    }
+}
@@ -1,7 +1,10 @@
 #include <catch2/catch.hpp>
 
+#include <boost/filesystem.hpp>
+
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Support/SupportCache.hpp"
 
 #include "test_data.hpp" // get access to init_print, etc
 
@@ -18,6 +21,35 @@ TEST_CASE("SupportMaterial: Three raft layers created", "[SupportMaterial]")
     REQUIRE(print.objects().front()->support_layers().size() == 3);
 }
 
+TEST_CASE("SupportMaterial: Support layers are restored from the support cache", "[SupportMaterial]")
+{
+    boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(dir);
+    FFFSupport::SupportCache::set_directory(dir.string());
+    auto slice = [](Slic3r::Print &print) {
+        Slic3r::Test::init_and_process_print({ TestMesh::overhang }, print, {
+            { "support_material", 1 },
+            { "raft_layers",      2 }
+            });
+    };
+    Slic3r::Print print1, print2;
+    slice(print1);
+    std::string key = FFFSupport::SupportCache::key(*print1.objects().front());
+    REQUIRE(boost::filesystem::exists(dir / (key + ".supports")));
+    slice(print2);
+    FFFSupport::SupportCache::set_directory(std::string());
+    boost::filesystem::remove_all(dir);
+
+    SpanOfConstPtrs<SupportLayer> layers1 = print1.objects().front()->support_layers();
+    SpanOfConstPtrs<SupportLayer> layers2 = print2.objects().front()->support_layers();
+    REQUIRE(layers1.size() == layers2.size());
+    for (size_t i = 0; i < layers1.size(); ++ i) {
+        REQUIRE(layers1[i]->print_z == layers2[i]->print_z);
+        REQUIRE(layers1[i]->support_islands == layers2[i]->support_islands);
+        REQUIRE(layers1[i]->support_fills.entities.size() == layers2[i]->support_fills.entities.size());
+    }
+}
+
 SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMaterial]")
 {
     // Box h = 20mm, hole bottom at 5mm, hole height 10mm (top edge at 15mm).
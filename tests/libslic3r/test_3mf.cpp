@@ -77,6 +77,28 @@ SCENARIO("Export+Import geometry to/from 3mf file cycle", "[3mf]") {
                 REQUIRE(res);
             }
         }
+
+        WHEN("model is saved+loaded to/from 3mf file with binary meshes") {
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/prusa_binary.3mf";
+            store_3mf(test_file.c_str(), &src_model, nullptr, false, nullptr, true, false, true);
+
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            {
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false);
+            }
+            boost::filesystem::remove(test_file);
+
+            TriangleMesh src_mesh = src_model.mesh();
+            TriangleMesh dst_mesh = dst_model.mesh();
+            THEN("meshes after load match") {
+                REQUIRE(src_mesh.its.indices.size() == dst_mesh.its.indices.size());
+                REQUIRE(src_mesh.its.vertices.size() == dst_mesh.its.vertices.size());
+                for (size_t i = 0; i < dst_mesh.its.vertices.size(); ++i)
+                    REQUIRE(dst_mesh.its.vertices[i].isApprox(src_mesh.its.vertices[i]));
+            }
+        }
     }
 }
 
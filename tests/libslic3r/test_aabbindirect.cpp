@@ -61,6 +61,38 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.z() == Approx(1.));
 }
 
+TEST_CASE("Batched ray casting matches the single ray caster", "[AABBIndirect]")
+{
+    TriangleMesh tmesh(its_make_sphere(1., PI / 32.));
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+
+    // Rays from a common origin inside the sphere, more of them than fits into a single packet.
+    const Vec3d origin(0.1, 0.2, 0.3);
+    std::vector<Vec3d> dirs;
+    for (int i = 0; i < 150; ++ i) {
+        double theta = 2. * PI * i / 150.;
+        double z     = 1. - 2. * (i + 0.5) / 150.;
+        double r     = std::sqrt(1. - z * z);
+        dirs.emplace_back(r * std::cos(theta * 7.), r * std::sin(theta * 7.), z);
+    }
+
+    std::vector<igl::Hit> hits;
+    size_t num_hits = AABBTreeIndirect::intersect_rays_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origin, dirs, hits);
+    REQUIRE(hits.size() == dirs.size());
+    REQUIRE(num_hits == dirs.size());
+    for (size_t i = 0; i < dirs.size(); ++ i) {
+        igl::Hit hit;
+        REQUIRE(AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origin, dirs[i], hit));
+        // Ids may differ for rays passing through a shared triangle edge, the distances may not.
+        REQUIRE(hits[i].t == Approx(hit.t));
+    }
+
+    // Rays pointing away from the mesh miss.
+    size_t num_missed = AABBTreeIndirect::intersect_rays_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, Vec3d(0., 0., 5.), { Vec3d(0., 0., 1.) }, hits);
+    REQUIRE(num_missed == 0);
+    REQUIRE(hits.front().id == -1);
+}
+
 TEST_CASE("Creating a several 2d lines, testing closest point query", "[AABBIndirect]")
 {
     std::vector<Linef> lines { };
@@ -382,3 +382,43 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+SCENARIO("Intersection and difference with clipping polygons far from the subject", "[ClipperUtils]") {
+    // A row of 10x10 squares, only the first three of them overlap the subject.
+    Polygons clip;
+    for (int i = 0; i < 20; ++ i)
+        clip.push_back({ { i * 200, 0 }, { i * 200 + 100, 0 }, { i * 200 + 100, 100 }, { i * 200, 100 } });
+    Polygon  subject { { 50, 50 }, { 550, 50 }, { 550, 150 }, { 50, 150 } };
+    // A subject island disjoint from all the clipping polygons.
+    Polygon  island  { { 0, 1000 }, { 100, 1000 }, { 100, 1100 }, { 0, 1100 } };
+    Polygons subjects { subject, island };
+    ClipperUtils::IndexedPolygons clip_indexed(clip);
+    // Overlaps of the subject with the first three clipping squares.
+    const double overlap = 50 * 50 + 100 * 50 + 100 * 50;
+    GIVEN("intersection") {
+        THEN("only the overlapping clipping polygons contribute") {
+            REQUIRE(area(intersection(subjects, clip)) == Approx(overlap));
+            REQUIRE(area(intersection_ex(subjects, clip)) == Approx(overlap));
+        }
+        THEN("indexed clipping polygons produce the same result") {
+            REQUIRE(area(intersection(subjects, clip_indexed)) == Approx(overlap));
+            REQUIRE(area(intersection_ex(subjects, clip_indexed)) == Approx(overlap));
+        }
+        THEN("intersection with an island far from all clipping polygons is empty") {
+            REQUIRE(intersection_ex(Polygons{ island }, clip).empty());
+            REQUIRE(intersection_ex(Polygons{ island }, clip_indexed).empty());
+        }
+    }
+    GIVEN("difference") {
+        const double expected = subject.area() + island.area() - overlap;
+        THEN("the subject island is preserved") {
+            REQUIRE(area(diff(subjects, clip)) == Approx(expected));
+            REQUIRE(area(diff_ex(subjects, clip)) == Approx(expected));
+            REQUIRE(diff_ex(subjects, clip).size() == 2);
+        }
+        THEN("indexed clipping polygons produce the same result") {
+            REQUIRE(area(diff(subjects, clip_indexed)) == Approx(expected));
+            REQUIRE(area(diff_ex(subjects, clip_indexed)) == Approx(expected));
+        }
+    }
+}
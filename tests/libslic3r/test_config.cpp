@@ -245,3 +245,28 @@ SCENARIO("DynamicPrintConfig serialization", "[Config]") {
         }
     }
 }
+
+SCENARIO("Static config diff", "[Config]") {
+    GIVEN("Two PrintObjectConfigs differing in two options") {
+        PrintObjectConfig config1;
+        PrintObjectConfig config2;
+        config2.layer_height.value      = config1.layer_height.value + 0.05;
+        config2.support_material.value  = ! config1.support_material.value;
+        const ConfigBase &base1 = config1;
+        const ConfigBase &base2 = config2;
+        WHEN("The configs are compared") {
+            THEN("The static diff reports the same keys as the generic diff") {
+                t_config_option_keys diff = config1.diff(config2);
+                REQUIRE(diff == base1.diff(base2));
+                REQUIRE(diff.size() == 2);
+                REQUIRE(std::find(diff.begin(), diff.end(), "layer_height") != diff.end());
+                REQUIRE(std::find(diff.begin(), diff.end(), "support_material") != diff.end());
+            }
+            THEN("The configs are not equal") {
+                REQUIRE(! config1.equals(config2));
+                REQUIRE(! base1.equals(base2));
+                REQUIRE(config1.equals(config1));
+            }
+        }
+    }
+}
@@ -49,3 +49,41 @@ TEST_CASE("Add TriangleMeshes", "[MeshBoolean]")
     //its_write_obj(tm1.its, "test_add.obj");
     CHECK(tm1.its.indices.size() > init_size);
 }
+
+TEST_CASE("Fast booleans of meshes with non intersecting surfaces", "[MeshBoolean]")
+{
+    indexed_triangle_set cube = its_make_cube(10., 10., 10.);
+    indexed_triangle_set inner = its_make_cube(2., 2., 2.);
+    its_translate(inner, Vec3f(4.f, 4.f, 4.f));
+
+    indexed_triangle_set hollow = cube;
+    REQUIRE(MeshBoolean::fast::minus(hollow, inner));
+    CHECK(hollow.indices.size() == 2 * cube.indices.size());
+    CHECK(its_volume(hollow) == Approx(1000. - 8.));
+
+    // Subtracting from the cavity does nothing.
+    indexed_triangle_set in_cavity = its_make_cube(1., 1., 1.);
+    its_translate(in_cavity, Vec3f(4.5f, 4.5f, 4.5f));
+    indexed_triangle_set mesh = hollow;
+    REQUIRE(MeshBoolean::fast::minus(mesh, in_cavity));
+    CHECK(mesh.indices.size() == hollow.indices.size());
+
+    indexed_triangle_set outside = its_make_cube(3., 3., 3.);
+    its_translate(outside, Vec3f(20.f, 0.f, 0.f));
+    mesh = hollow;
+    REQUIRE(MeshBoolean::fast::plus(mesh, outside));
+    CHECK(its_volume(mesh) == Approx(1000. - 8. + 27.));
+    mesh = hollow;
+    REQUIRE(MeshBoolean::fast::intersect(mesh, outside));
+    CHECK(mesh.empty());
+
+    // Intersecting or touching surfaces are left to CGAL.
+    indexed_triangle_set crossing = its_make_cube(3., 3., 3.);
+    its_translate(crossing, Vec3f(9.f, 9.f, 9.f));
+    mesh = cube;
+    CHECK(! MeshBoolean::fast::minus(mesh, crossing));
+    CHECK(mesh.indices.size() == cube.indices.size());
+    indexed_triangle_set touching = its_make_cube(3., 3., 3.);
+    its_translate(touching, Vec3f(10.f, 0.f, 0.f));
+    CHECK(! MeshBoolean::fast::plus(mesh, touching));
+}
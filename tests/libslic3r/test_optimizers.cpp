@@ -5,6 +5,8 @@
 
 #include <libslic3r/Optimize/NLoptOptimizer.hpp>
 
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+
 void check_opt_result(double score, double ref, double abs_err, double rel_err)
 {
     double abs_diff = std::abs(score - ref);
@@ -57,3 +59,50 @@ TEST_CASE("Test brute force optimzer for basic 1D and 2D functions", "[Opt]") {
     test_sin(opt);
     test_sphere_func(opt);
 }
+
+TEST_CASE("Test parallel brute force optimzer for basic 1D and 2D functions", "[Opt]") {
+    using namespace Slic3r::opt;
+
+    Optimizer<AlgBruteForceEP<Slic3r::ExecutionTBB>> opt;
+
+    test_sin(opt);
+    test_sphere_func(opt);
+}
+
+TEST_CASE("Parallel brute force optimizer matches the sequential one", "[Opt]") {
+    using namespace Slic3r::opt;
+
+    // Multiple global minima, the first one in the grid order has to win.
+    auto optfunc = [](const auto &in) {
+        auto [x, y] = in;
+        return std::round(10. * std::sin(x) * std::cos(y));
+    };
+    auto optbounds = bounds({ {-PI, PI}, {-PI, PI} });
+    auto stc = StopCriteria{}.max_iterations(900);
+
+    Result seq = Optimizer<AlgBruteForce>{stc, 31}.to_min().optimize(optfunc, initvals({0., 0.}), optbounds);
+    Result par = Optimizer<AlgBruteForceEP<Slic3r::ExecutionTBB>>{stc, 31}.to_min().optimize(optfunc, initvals({0., 0.}), optbounds);
+
+    REQUIRE(par.score == Approx(seq.score));
+    REQUIRE(par.optimum[0] == Approx(seq.optimum[0]));
+    REQUIRE(par.optimum[1] == Approx(seq.optimum[1]));
+}
+
+TEST_CASE("Parallel multistart of a local NLopt optimizer finds the global minimum", "[Opt]") {
+    using namespace Slic3r::opt;
+
+    // Local minima at x = 3PI/2 + 2kPI, the global one is the last one.
+    auto optfunc = [](const auto &in) {
+        auto [x] = in;
+        return std::sin(x) - 0.01 * x;
+    };
+
+    std::vector<Input<1>> starts;
+    for (int i = 0; i < 8; ++i)
+        starts.emplace_back(initvals({i * 6 * PI / 8}));
+
+    Optimizer<AlgNLoptSubplex> opt(StopCriteria{}.rel_score_diff(1e-8).max_iterations(1000));
+    Result result = opt.to_min().optimize(Slic3r::ex_tbb, optfunc, starts, bounds({ {0., 6 * PI} }));
+
+    REQUIRE(result.optimum[0] == Approx(5.5 * PI).epsilon(1e-2));
+}
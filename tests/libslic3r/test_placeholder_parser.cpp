@@ -36,6 +36,7 @@ SCENARIO("Placeholder parser scripting", "[PlaceholderParser]") {
     SECTION("nested config options (legacy syntax)") { REQUIRE(parser.process("[temperature_[foo]]") == "357"); }
     SECTION("array reference") { REQUIRE(parser.process("{temperature[foo]}") == "357"); }
     SECTION("whitespaces and newlines are maintained") { REQUIRE(parser.process("test [ temperature_ [foo] ] \n hu") == "test 357 \n hu"); }
+    SECTION("plain text is returned verbatim") { REQUIRE(parser.process("G1 X10 Y20 ; move\nM104 S200\n") == "G1 X10 Y20 ; move\nM104 S200\n"); }
     SECTION("nullable is not null") { REQUIRE(parser.process("{is_nil(filament_retract_length[0])}") == "false"); }
     SECTION("nullable is null") { REQUIRE(parser.process("{is_nil(filament_retract_length[1])}") == "true"); }
     SECTION("nullable is not null 2") { REQUIRE(parser.process("{is_nil(filament_retract_length[2])}") == "false"); }
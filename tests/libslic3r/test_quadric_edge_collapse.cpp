@@ -302,3 +302,16 @@ TEST_CASE("Simplified cube should not be empty.", "[its]")
     its_quadric_edge_collapse(its, wanted_count, &max_error);
     CHECK(!its.indices.empty());
 }
+
+TEST_CASE("Simplify large sphere by clusters in parallel", "[its][quadric_edge_collapse]")
+{
+    indexed_triangle_set its = its_make_sphere(10., 2. * PI / 1000.);
+    REQUIRE(its.indices.size() >= 500000);
+    double   original_volume = its_volume(its);
+    uint32_t wanted_count    = its.indices.size() * 0.05;
+    its_quadric_edge_collapse_parallel(its, wanted_count);
+    CHECK(its.indices.size() <= wanted_count);
+    CHECK(its_num_open_edges(its) == 0);
+    CHECK(!Private::exist_triangle_with_twice_vertices(its.indices));
+    CHECK(std::abs(its_volume(its) - original_volume) < 0.01 * original_volume);
+}
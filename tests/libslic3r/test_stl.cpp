@@ -2,6 +2,7 @@
 
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/TriangleMesh.hpp"
 
 using namespace Slic3r;
 
@@ -55,3 +56,27 @@ SCENARIO("Reading an STL file", "[stl]") {
 		}
 	}
 }
+
+SCENARIO("Reading a binary STL file through a memory mapped file", "[stl]") {
+	GIVEN("binary STL file of a box") {
+		WHEN("STL file is read") {
+			indexed_triangle_set its;
+			THEN("vertices are welded") {
+				REQUIRE(its_read_stl_binary(stl_path("Geräte/20mmbox-čřšřěá.stl").c_str(), its));
+				REQUIRE(its.vertices.size() == 8);
+				REQUIRE(its.indices.size() == 12);
+				REQUIRE(its_num_open_edges(its) == 0);
+				REQUIRE(is_approx(its_volume(its), 8000.f, 0.01f));
+			}
+		}
+	}
+	GIVEN("ASCII STL file") {
+		WHEN("STL file is read") {
+			indexed_triangle_set its;
+			THEN("the file is rejected to be loaded by admesh") {
+				REQUIRE(! its_read_stl_binary(stl_path("ASCII/20mmbox-LF.stl").c_str(), its));
+				REQUIRE(its.empty());
+			}
+		}
+	}
+}
@@ -2233,3 +2233,32 @@ TEST_CASE("Non-planar voronoi diagram", "[VoronoiNonPlanar]")
 
 //    REQUIRE(Geometry::VoronoiUtilsCgal::is_voronoi_diagram_planar_intersection(vd));
 }
+
+TEST_CASE("Reused Voronoi diagram matches a new one", "[Voronoi]")
+{
+    const Polygon square { { -1000000, -1000000 }, { 1000000, -1000000 }, { 1000000, 1000000 }, { -1000000, 1000000 } };
+    const Polygon triangle { { 0, 0 }, { 3000000, 500000 }, { 500000, 2000000 } };
+    const Lines   lines_square   = to_lines(square);
+    const Lines   lines_triangle = to_lines(triangle);
+
+    Geometry::ThreadLocalVoronoiDiagram vd_tls;
+    VD &vd = *vd_tls;
+    // Construct a different diagram first to leave its data in the reused diagram.
+    vd.construct(lines_square.begin(), lines_square.end());
+    vd.construct(lines_triangle.begin(), lines_triangle.end());
+
+    VD vd_new;
+    construct_voronoi(lines_triangle.begin(), lines_triangle.end(), &vd_new);
+
+    REQUIRE(vd.num_cells() == vd_new.num_cells());
+    REQUIRE(vd.num_edges() == vd_new.num_edges());
+    REQUIRE(vd.num_vertices() == vd_new.num_vertices());
+    for (size_t i = 0; i < vd.num_vertices(); ++ i) {
+        REQUIRE(vd.vertices()[i].x() == vd_new.vertices()[i].x());
+        REQUIRE(vd.vertices()[i].y() == vd_new.vertices()[i].y());
+    }
+
+    // A nested diagram of the same thread must not share the data with the first one.
+    Geometry::ThreadLocalVoronoiDiagram vd_nested;
+    REQUIRE(&*vd_nested != &vd);
+}
@@ -252,6 +252,92 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
 }
 
 
+TEST_CASE("RunRasterShouldMatchPixelRaster", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::Resolution res{2560, 1440};
+    sla::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+    sla::RasterBase::Trafo trafo{sla::RasterBase::roPortrait, sla::RasterBase::MirrorX};
+
+    auto pxraster  = sla::create_raster_grayscale_aa(res, pixdim, 1., trafo);
+    auto runraster = sla::create_raster_grayscale_aa_runs(res, pixdim, 1., trafo);
+
+    auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+    ExPolygon poly = square_with_hole(10.);
+    poly.translate(bb.center().x(), bb.center().y());
+    pxraster->draw(poly);
+    runraster->draw(poly);
+
+    // Overlapping with the first one, to blend the anti-aliased edges.
+    poly.translate(scaled(3.3), scaled(4.7));
+    pxraster->draw(poly);
+    runraster->draw(poly);
+
+    auto to_pixels = [](const sla::RasterBase &rst) {
+        std::vector<uint8_t> pixels;
+        rst.encode([&pixels](const void *ptr, size_t w, size_t h, size_t) {
+            pixels.assign(static_cast<const uint8_t *>(ptr), static_cast<const uint8_t *>(ptr) + w * h);
+            return sla::EncodedRaster{};
+        });
+        return pixels;
+    };
+    auto runs_to_pixels = [](const sla::RasterBase &rst) {
+        std::vector<uint8_t> pixels;
+        rst.encode_runs([&pixels](const sla::RasterRuns &runs, size_t, size_t) {
+            runs.for_each_run([&pixels](uint8_t value, size_t len) { pixels.insert(pixels.end(), len, value); });
+            return sla::EncodedRaster{};
+        });
+        return pixels;
+    };
+
+    std::vector<uint8_t> pixels = to_pixels(*pxraster);
+    REQUIRE(pixels.size() == res.pixels());
+    REQUIRE(to_pixels(*runraster) == pixels);
+    REQUIRE(runs_to_pixels(*runraster) == pixels);
+    REQUIRE(runs_to_pixels(*pxraster) == pixels);
+}
+
+
+TEST_CASE("StampedCopiesShouldMatchDrawnCopies", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::Resolution res{2400, 1360};
+    sla::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+    sla::RasterBase::Trafo trafo{sla::RasterBase::roPortrait, sla::RasterBase::MirrorX};
+
+    auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+    ExPolygon poly = square_with_hole(10.);
+    poly.translate(bb.center().x(), bb.center().y());
+    poly.rotate(0.3);
+
+    // Whole pixel offsets, the last copy is partially outside of the display.
+    std::vector<Point> offsets = {Point::Zero(), Point{scaled(-20.), scaled(-10.)},
+                                  Point{scaled(-30.5), scaled(12.)}, Point{scaled(5.), scaled(25.)}};
+
+    SECTION("whole pixel offsets") {}
+    SECTION("subpixel offsets") { offsets[1] += Point{scaled(0.013), 0}; }
+
+    auto to_pixels = [](const sla::RasterBase &rst) {
+        std::vector<uint8_t> pixels;
+        rst.encode([&pixels](const void *ptr, size_t w, size_t h, size_t) {
+            pixels.assign(static_cast<const uint8_t *>(ptr), static_cast<const uint8_t *>(ptr) + w * h);
+            return sla::EncodedRaster{};
+        });
+        return pixels;
+    };
+
+    auto drawn = sla::create_raster_grayscale_aa(res, pixdim, 1., trafo);
+    drawn->RasterBase::draw_copies({poly}, offsets);
+    std::vector<uint8_t> pixels = to_pixels(*drawn);
+
+    auto pxraster  = sla::create_raster_grayscale_aa(res, pixdim, 1., trafo);
+    auto runraster = sla::create_raster_grayscale_aa_runs(res, pixdim, 1., trafo);
+    pxraster->draw_copies({poly}, offsets);
+    runraster->draw_copies({poly}, offsets);
+
+    REQUIRE(to_pixels(*pxraster) == pixels);
+    REQUIRE(to_pixels(*runraster) == pixels);
+}
+
+
 TEST_CASE("halfcone test", "[halfcone]") {
     sla::DiffBridge br{Vec3d{1., 1., 1.}, Vec3d{10., 10., 10.}, 0.25, 0.5};
 
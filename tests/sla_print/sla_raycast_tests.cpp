@@ -39,6 +39,43 @@ TEST_CASE("Raycaster - find intersections of a line and cylinder")
     REQUIRE(std::abs(out[1].first - std::sqrt(72.f)) < 0.001f);
 }
 
+TEST_CASE("Raycaster - batched ray casting matches single rays", "[sla_raycast]")
+{
+    TriangleMesh sphere{its_make_sphere(10., PI / 32.)};
+    AABBMesh emesh{sphere};
+
+    // A ring of nearly parallel rays, as cast by the support tree beam tests,
+    // some of them missing the sphere.
+    std::vector<Vec3d> sources, dirs;
+    for (size_t i = 0; i < 100; ++i) {
+        double a = 2. * PI * i / 100.;
+        sources.emplace_back(12. * std::cos(a), 12. * std::sin(a), -20. + 0.3 * i);
+        dirs.emplace_back(Vec3d(-0.3 * std::cos(a), -0.3 * std::sin(a), 1.).normalized());
+    }
+
+    std::vector<AABBMesh::hit_result> hits = emesh.query_ray_hit(sources, dirs);
+    REQUIRE(hits.size() == dirs.size());
+    size_t num_hits = 0;
+    for (size_t i = 0; i < dirs.size(); ++i) {
+        AABBMesh::hit_result hit = emesh.query_ray_hit(sources[i], dirs[i]);
+        REQUIRE(hits[i].is_hit() == hit.is_hit());
+        if (hit.is_hit()) {
+            ++num_hits;
+            REQUIRE(hits[i].distance() == Approx(hit.distance()));
+            REQUIRE(hits[i].is_inside() == hit.is_inside());
+        }
+    }
+    REQUIRE(num_hits > 0);
+    REQUIRE(num_hits < dirs.size());
+
+    // Rays from a common source.
+    hits = emesh.query_ray_hit(std::vector<Vec3d>{ Vec3d::Zero() }, dirs);
+    for (size_t i = 0; i < dirs.size(); ++i) {
+        REQUIRE(hits[i].is_inside());
+        REQUIRE(hits[i].distance() == Approx(emesh.query_ray_hit(Vec3d::Zero(), dirs[i]).distance()));
+    }
+}
+
 #ifdef SLIC3R_HOLE_RAYCASTER
 // Create a simple scene with a 20mm cube and a big hole in the front wall 
 // with 5mm radius. Then shoot rays from interesting positions and see where